@@ -39,4 +39,19 @@
 #define ITTI_QUEUE_MAX_ELEMENTS  (64 * 1024)
 #define ITTI_DUMP_MAX_CON        (5)    /* Max connections in parallel */
 
+/* Default geometry of the message memory pools ({items number, item size in bytes}, cf. memory_pools_config_t),
+ * used when the configuration file has none */
+#define ITTI_MEMORY_POOLS_DEFAULT_MAGAZINE_SIZE  (32)
+#define ITTI_MEMORY_POOLS_DEFAULT_CONFIG         {                       \
+    .pools_number = 5,                                                   \
+    .pools = {                                                           \
+      {1000 + ITTI_QUEUE_MAX_ELEMENTS, 50},                              \
+      {1000 + (2 * ITTI_QUEUE_MAX_ELEMENTS), 100},                       \
+      {10000, 1000},                                                     \
+      {400, 20050},                                                      \
+      {100, 30050},                                                      \
+    },                                                                   \
+    .magazine_size = ITTI_MEMORY_POOLS_DEFAULT_MAGAZINE_SIZE,            \
+  }
+
 #endif /* FILE_INTERTASK_INTERFACE_CONF_SEEN */
@@ -31,6 +31,7 @@
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <malloc.h>
+#include <sched.h>
 
 #include "liblfds710.h"
 #include "bstrlib.h"
@@ -137,13 +138,84 @@ typedef struct thread_desc_s {
   //#endif
 } thread_desc_t;
 
+#if ITTI_SPSC_RINGS
+/* Max number of messages moved from the rings to the task on each wakeup */
+#define ITTI_RECEIVE_BATCH_MAX 32
+#define ITTI_CACHE_LINE_SIZE   64
+
+typedef struct itti_ring_slot_s {
+  MessageDef                             *msg;
+  uint64_t                                ticket;       ///< Order of the message in the destination task queue
+} itti_ring_slot_t;
+
+/*
+ * Single producer, single consumer ring, one per (producer thread, destination task).
+ * Rings are freed by itti_wait_tasks_end(), threads of the process are not expected to come and go.
+ */
+typedef struct itti_ring_s {
+  struct itti_ring_s                     *next_ring;    ///< Next ring of the same destination task
+  uint32_t                                mask;
+  itti_ring_slot_t                       *slots;
+
+  /*
+   * Producer side
+   */
+  volatile uint64_t                       head __attribute__ ((aligned (ITTI_CACHE_LINE_SIZE)));
+  uint64_t                                cached_tail;
+
+  /*
+   * Consumer side
+   */
+  volatile uint64_t                       tail __attribute__ ((aligned (ITTI_CACHE_LINE_SIZE)));
+} itti_ring_t;
+
+/*
+ * Message that did not fit in the ring of its producer, kept in the overflow list of the task
+ */
+typedef struct itti_overflow_msg_s {
+  struct itti_overflow_msg_s             *next;
+  MessageDef                             *msg;
+  uint64_t                                ticket;
+} itti_overflow_msg_t;
+#endif
+
 typedef struct task_desc_s {
+#if ITTI_SPSC_RINGS
+  /*
+   * Rings of all threads that have sent a message to the task
+   */
+  itti_ring_t * volatile                  rings __attribute__ ((aligned (ITTI_CACHE_LINE_SIZE)));
+  uint32_t                                ring_size;
+
+  /*
+   * Messages sent while the ring of their producer was full, in ticket order
+   */
+  pthread_mutex_t                         overflow_mutex;
+  itti_overflow_msg_t * volatile          overflow_head;
+  itti_overflow_msg_t                    *overflow_tail;
+
+  /*
+   * Number of messages enqueued for the task, also used as ticket
+   */
+  volatile uint64_t                       enqueued __attribute__ ((aligned (ITTI_CACHE_LINE_SIZE)));
+
+  /*
+   * Consumer side: number of messages dequeued and batch of messages
+   * * * already removed from the rings but not yet returned to the task.
+   */
+  volatile uint64_t                       dequeued __attribute__ ((aligned (ITTI_CACHE_LINE_SIZE)));
+  itti_ring_t                            *last_ring;
+  uint32_t                                nb_received;
+  uint32_t                                next_received;
+  MessageDef                             *received[ITTI_RECEIVE_BATCH_MAX];
+#else
   /*
    * Queue of messages belonging to the task
    */
   struct lfds710_queue_bmm_state         message_queue
           __attribute__ ((aligned (LFDS710_PAL_ATOMIC_ISOLATION_IN_BYTES)));
   struct lfds710_queue_bmm_element      *qbmme;
+#endif
 } task_desc_t;
 
 typedef struct itti_desc_s {
@@ -182,6 +254,13 @@ typedef struct itti_desc_s {
 
 static itti_desc_t                      itti_desc;
 
+#if ITTI_SPSC_RINGS
+/* Rings of the calling thread, indexed by destination task id */
+static __thread itti_ring_t           **itti_thread_rings = NULL;
+/* Releases the ring index of a thread when it exits, rings belong to their destination task */
+static pthread_key_t                    itti_thread_rings_key;
+#endif
+
 void                                   *
 itti_malloc (
   task_id_t origin_task_id,
@@ -257,6 +336,14 @@ itti_get_task_name (
   return (itti_desc.tasks_info[task_id].name);
 }
 
+// memory pools statistics are per origin task (info_0)
+static const char                      *
+itti_get_task_name_info (
+  uint16_t task_id)
+{
+  return itti_get_task_name ((task_id_t) task_id);
+}
+
 static                                  task_id_t
 itti_get_current_task_id (
   void)
@@ -371,20 +458,322 @@ itti_alloc_new_message (
   return itti_alloc_new_message_sized (origin_task_id, message_id, itti_desc.messages_info[message_id].size);
 }
 
-int
-itti_send_msg_to_task (
+#if ITTI_SPSC_RINGS
+//------------------------------------------------------------------------------
+static inline void
+itti_signal_thread (
+  thread_id_t thread_id)
+{
+  ssize_t                                 write_ret;
+  eventfd_t                               sem_counter = 1;
+
+  /*
+   * Call to write for an event fd must be of 8 bytes
+   */
+  write_ret = write (itti_desc.threads[thread_id].task_event_fd, &sem_counter, sizeof (sem_counter));
+  AssertFatal (write_ret == sizeof (sem_counter), "Write to task message FD (%d) failed (%d/%d)\n", thread_id, (int)write_ret, (int)sizeof (sem_counter));
+}
+
+//------------------------------------------------------------------------------
+static itti_ring_t                     *
+itti_get_thread_ring (
+  task_id_t destination_task_id)
+{
+  task_desc_t                            *task = &itti_desc.tasks[destination_task_id];
+  itti_ring_t                            *ring = NULL;
+
+  if (itti_thread_rings == NULL) {
+    itti_thread_rings = calloc (itti_desc.task_max, sizeof (itti_ring_t *));
+    AssertFatal (itti_thread_rings != NULL, "Failed to allocate ITTI rings of thread\n");
+    pthread_setspecific (itti_thread_rings_key, itti_thread_rings);
+  }
+
+  ring = itti_thread_rings[destination_task_id];
+  if (ring == NULL) {
+    ring = memalign (ITTI_CACHE_LINE_SIZE, sizeof (itti_ring_t));
+    AssertFatal (ring != NULL, "Failed to allocate ITTI ring for task %s\n", itti_get_task_name (destination_task_id));
+    memset (ring, 0, sizeof (itti_ring_t));
+    ring->mask = task->ring_size - 1;
+    ring->slots = calloc (task->ring_size, sizeof (itti_ring_slot_t));
+    AssertFatal (ring->slots != NULL, "Failed to allocate ITTI ring slots for task %s\n", itti_get_task_name (destination_task_id));
+    /*
+     * Publish the ring to the consumer
+     */
+    do {
+      ring->next_ring = task->rings;
+    } while (!__sync_bool_compare_and_swap (&task->rings, ring->next_ring, ring));
+    itti_thread_rings[destination_task_id] = ring;
+  }
+  return ring;
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of free slots in the ring.
+static inline uint32_t
+itti_ring_free_slots (
+  itti_ring_t * ring)
+{
+  uint64_t                                head = ring->head;
+
+  if ((head - ring->cached_tail) > ring->mask) {
+    ring->cached_tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+  }
+  return (uint32_t)(ring->mask + 1 - (head - ring->cached_tail));
+}
+
+//------------------------------------------------------------------------------
+// Append messages to the overflow list of the task, returns the ticket of the first one.
+static uint64_t
+itti_overflow_append (
+  task_id_t destination_task_id,
+  MessageDef ** messages,
+  uint32_t nb_messages)
+{
+  task_desc_t                            *task = &itti_desc.tasks[destination_task_id];
+  itti_overflow_msg_t                    *first = NULL;
+  itti_overflow_msg_t                    *last = NULL;
+  uint64_t                                ticket = 0;
+
+  for (uint32_t i = 0; i < nb_messages; i++) {
+    itti_overflow_msg_t                    *new = (itti_overflow_msg_t *) itti_malloc (ITTI_MSG_ORIGIN_ID (messages[i]), destination_task_id, sizeof (itti_overflow_msg_t));
+
+    new->next = NULL;
+    new->msg = messages[i];
+    if (last) {
+      last->next = new;
+    } else {
+      first = new;
+    }
+    last = new;
+  }
+  /*
+   * Tickets are taken under the lock so that the list stays in ticket order
+   */
+  pthread_mutex_lock (&task->overflow_mutex);
+  ticket = __sync_fetch_and_add (&task->enqueued, nb_messages);
+  for (itti_overflow_msg_t * m = first; m; m = m->next) {
+    m->ticket = ticket++;
+  }
+  if (task->overflow_head) {
+    task->overflow_tail->next = first;
+  } else {
+    __atomic_store_n (&task->overflow_head, first, __ATOMIC_RELEASE);
+  }
+  task->overflow_tail = last;
+  pthread_mutex_unlock (&task->overflow_mutex);
+  return ticket - nb_messages;
+}
+
+//------------------------------------------------------------------------------
+static void
+itti_enqueue_messages (
+  task_id_t destination_task_id,
+  MessageDef ** messages,
+  uint32_t nb_messages)
+{
+  thread_id_t                             destination_thread_id = TASK_GET_THREAD_ID (destination_task_id);
+  task_desc_t                            *task = &itti_desc.tasks[destination_task_id];
+  itti_ring_t                            *ring = itti_get_thread_ring (destination_task_id);
+
+  while (nb_messages > 0) {
+    uint32_t                                nb = itti_ring_free_slots (ring);
+    uint64_t                                head = ring->head;
+    uint64_t                                ticket = 0;
+
+    if (nb == 0) {
+      /*
+       * Never wait for the consumer: it may be the calling thread or be sending to us
+       */
+      nb = nb_messages;
+      ticket = itti_overflow_append (destination_task_id, messages, nb);
+    } else {
+      if (nb > nb_messages) {
+        nb = nb_messages;
+      }
+      /*
+       * Tickets give the order of messages over all the rings of the destination task
+       */
+      ticket = __sync_fetch_and_add (&task->enqueued, nb);
+      for (uint32_t i = 0; i < nb; i++) {
+        ring->slots[(head + i) & ring->mask].msg = messages[i];
+        ring->slots[(head + i) & ring->mask].ticket = ticket + i;
+      }
+      __atomic_store_n (&ring->head, head + nb, __ATOMIC_RELEASE);
+    }
+
+    /*
+     * Only signal the empty to non-empty transition: the destination task had consumed
+     * * * all messages and may be blocked in epoll_wait.
+     * * * Subtasks will pool the queue.
+     */
+    if ((__atomic_load_n (&task->dequeued, __ATOMIC_SEQ_CST) == ticket) && (TASK_GET_PARENT_TASK_ID (destination_task_id) == TASK_UNKNOWN)) {
+      itti_signal_thread (destination_thread_id);
+    }
+    messages += nb;
+    nb_messages -= nb;
+  }
+}
+
+//------------------------------------------------------------------------------
+static inline bool
+itti_ring_front_is (
+  itti_ring_t * ring,
+  uint64_t ticket)
+{
+  uint64_t                                tail = ring->tail;
+
+  return ((tail != __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE)) && (ring->slots[tail & ring->mask].ticket == ticket));
+}
+
+//------------------------------------------------------------------------------
+// Remove the head of the overflow list of the task if it holds the ticket.
+static MessageDef                      *
+itti_overflow_pop_ticket (
+  task_id_t task_id,
+  uint64_t ticket)
+{
+  task_desc_t                            *task = &itti_desc.tasks[task_id];
+  itti_overflow_msg_t                    *head = NULL;
+  MessageDef                             *msg = NULL;
+
+  if (__atomic_load_n (&task->overflow_head, __ATOMIC_ACQUIRE) == NULL) {
+    return NULL;
+  }
+  pthread_mutex_lock (&task->overflow_mutex);
+  head = task->overflow_head;
+  if ((head) && (head->ticket == ticket)) {
+    __atomic_store_n (&task->overflow_head, head->next, __ATOMIC_RELEASE);
+  } else {
+    head = NULL;
+  }
+  pthread_mutex_unlock (&task->overflow_mutex);
+  if (head) {
+    msg = head->msg;
+    itti_free (ITTI_MSG_ORIGIN_ID (msg), head);
+  }
+  return msg;
+}
+
+//------------------------------------------------------------------------------
+static inline MessageDef               *
+itti_ring_pop_ticket (
+  task_id_t task_id,
+  uint64_t ticket)
+{
+  task_desc_t                            *task = &itti_desc.tasks[task_id];
+  itti_ring_t                            *ring = task->last_ring;
+  MessageDef                             *msg = NULL;
+
+  if ((ring == NULL) || (!itti_ring_front_is (ring, ticket))) {
+    while (1) {
+      for (ring = __atomic_load_n (&task->rings, __ATOMIC_ACQUIRE); ring; ring = ring->next_ring) {
+        if (itti_ring_front_is (ring, ticket)) {
+          break;
+        }
+      }
+      if (ring) {
+        break;
+      }
+      if ((msg = itti_overflow_pop_ticket (task_id, ticket))) {
+        return msg;
+      }
+      /*
+       * The producer owning the ticket did not store its message yet
+       */
+      sched_yield ();
+    }
+  }
+  msg = ring->slots[ring->tail & ring->mask].msg;
+  __atomic_store_n (&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+  task->last_ring = ring;
+  return msg;
+}
+
+//------------------------------------------------------------------------------
+// Move up to ITTI_RECEIVE_BATCH_MAX messages from the rings to the task batch, in sending order.
+static uint32_t
+itti_dequeue_messages (
+  task_id_t task_id)
+{
+  task_desc_t                            *task = &itti_desc.tasks[task_id];
+  uint64_t                                dequeued = task->dequeued;
+  uint64_t                                enqueued = __atomic_load_n (&task->enqueued, __ATOMIC_SEQ_CST);
+  uint32_t                                nb = 0;
+
+  while ((nb < ITTI_RECEIVE_BATCH_MAX) && ((dequeued + nb) != enqueued)) {
+    task->received[nb] = itti_ring_pop_ticket (task_id, dequeued + nb);
+    nb++;
+  }
+  task->nb_received = nb;
+  task->next_received = 0;
+  if (nb) {
+    __atomic_store_n (&task->dequeued, dequeued + nb, __ATOMIC_SEQ_CST);
+  }
+  return nb;
+}
+
+//------------------------------------------------------------------------------
+// Release the rings and the overflow list of all tasks with the messages left in them, once all tasks have ended.
+static void
+itti_free_rings (
+  void)
+{
+  free_wrapper ((void**)&itti_thread_rings);
+  pthread_setspecific (itti_thread_rings_key, NULL);
+
+  for (task_id_t task_id = TASK_FIRST; task_id < itti_desc.task_max; task_id++) {
+    task_desc_t                            *task = &itti_desc.tasks[task_id];
+    itti_ring_t                            *ring = task->rings;
+    itti_overflow_msg_t                    *overflow = task->overflow_head;
+
+    while (task->next_received < task->nb_received) {
+      MessageDef                             *msg = task->received[task->next_received++];
+
+      itti_free (ITTI_MSG_ORIGIN_ID (msg), msg);
+    }
+    while (ring) {
+      itti_ring_t                            *next_ring = ring->next_ring;
+
+      for (; ring->tail != ring->head; ring->tail++) {
+        MessageDef                             *msg = ring->slots[ring->tail & ring->mask].msg;
+
+        itti_free (ITTI_MSG_ORIGIN_ID (msg), msg);
+      }
+      free_wrapper ((void**)&ring->slots);
+      free_wrapper ((void**)&ring);
+      ring = next_ring;
+    }
+    task->rings = NULL;
+    task->last_ring = NULL;
+    while (overflow) {
+      itti_overflow_msg_t                    *next = overflow->next;
+
+      itti_free (ITTI_MSG_ORIGIN_ID (overflow->msg), overflow->msg);
+      itti_free (ITTI_MSG_ORIGIN_ID (overflow->msg), overflow);
+      overflow = next;
+    }
+    task->overflow_head = NULL;
+    task->overflow_tail = NULL;
+    pthread_mutex_destroy (&task->overflow_mutex);
+  }
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Fill the message header, returns false if the destination task has ended.
+static inline bool
+itti_prepare_msg (
   task_id_t destination_task_id,
   instance_t instance,
-  MessageDef * message)
+  MessageDef * message,
+  message_number_t * message_number_p)
 {
   thread_id_t                             destination_thread_id;
   task_id_t                               origin_task_id;
-  message_list_t                         *new;
   uint32_t                                priority;
   message_number_t                        message_number;
   uint32_t                                message_id;
 
-  VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_SEND_MSG, __sync_or_and_fetch (&itti_desc.vcd_send_msg, 1L << destination_task_id));
   AssertFatal (message != NULL, "Message is NULL!\n");
   AssertFatal (destination_task_id < itti_desc.task_max, "Destination task id (%d) is out of range (%d)\n", destination_task_id, itti_desc.task_max);
   destination_thread_id = TASK_GET_THREAD_ID (destination_task_id);
@@ -400,22 +789,52 @@ itti_send_msg_to_task (
    * Increment the global message number
    */
   message_number = itti_increment_message_number ();
+  if (message_number_p) {
+    *message_number_p = message_number;
+  }
+  memory_pools_set_info (itti_desc.memory_pools_handle, message, 1, destination_task_id);
+
+  if (itti_desc.threads[destination_thread_id].task_state == TASK_STATE_ENDED) {
+    ITTI_DEBUG (ITTI_DEBUG_ISSUES, " Message %s, number %lu with priority %d can not be sent from %s to queue (%u:%s), ended destination task!\n",
+                itti_desc.messages_info[message_id].name, message_number, priority, itti_get_task_name (origin_task_id), destination_task_id, itti_get_task_name (destination_task_id));
+    return false;
+  }
+  /*
+   * We cannot send a message if the task is not running
+   */
+  AssertFatal (itti_desc.threads[destination_thread_id].task_state == TASK_STATE_READY,
+               "Task %s Cannot send message %s (%d) to thread %d, it is not in ready state (%d)!\n",
+               itti_get_task_name (origin_task_id), itti_desc.messages_info[message_id].name, message_id, destination_thread_id, itti_desc.threads[destination_thread_id].task_state);
+  ITTI_DEBUG (ITTI_DEBUG_SEND, " Message %s, number %lu with priority %d sent from %s to queue (%u:%s)\n",
+              itti_desc.messages_info[message_id].name, message_number, priority, itti_get_task_name (origin_task_id), destination_task_id, itti_get_task_name (destination_task_id));
+  return true;
+}
+
+int
+itti_send_msg_to_task (
+  task_id_t destination_task_id,
+  instance_t instance,
+  MessageDef * message)
+{
+  task_id_t                               origin_task_id;
+  message_number_t                        message_number = 0;
+
+  VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_SEND_MSG, __sync_or_and_fetch (&itti_desc.vcd_send_msg, 1L << destination_task_id));
+  AssertFatal (message != NULL, "Message is NULL!\n");
+  origin_task_id = ITTI_MSG_ORIGIN_ID (message);
 
   if (destination_task_id != TASK_UNKNOWN) {
     VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME (VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_ENQUEUE_MESSAGE, VCD_FUNCTION_IN);
-    memory_pools_set_info (itti_desc.memory_pools_handle, message, 1, destination_task_id);
 
-    if (itti_desc.threads[destination_thread_id].task_state == TASK_STATE_ENDED) {
-      ITTI_DEBUG (ITTI_DEBUG_ISSUES, " Message %s, number %lu with priority %d can not be sent from %s to queue (%u:%s), ended destination task!\n",
-                  itti_desc.messages_info[message_id].name, message_number, priority, itti_get_task_name (origin_task_id), destination_task_id, itti_get_task_name (destination_task_id));
+    if (!itti_prepare_msg (destination_task_id, instance, message, &message_number)) {
       itti_free (origin_task_id, message); // In case of issues free the memory allocated for message
     } else {
-      /*
-       * We cannot send a message if the task is not running
-       */
-      AssertFatal (itti_desc.threads[destination_thread_id].task_state == TASK_STATE_READY,
-                   "Task %s Cannot send message %s (%d) to thread %d, it is not in ready state (%d)!\n",
-                   itti_get_task_name (origin_task_id), itti_desc.messages_info[message_id].name, message_id, destination_thread_id, itti_desc.threads[destination_thread_id].task_state);
+#if ITTI_SPSC_RINGS
+      itti_enqueue_messages (destination_task_id, &message, 1);
+#else
+      thread_id_t                             destination_thread_id = TASK_GET_THREAD_ID (destination_task_id);
+      message_list_t                         *new;
+
       /*
        * Allocate new list element
        */
@@ -425,12 +844,11 @@ itti_send_msg_to_task (
        */
       new->msg = message;
       new->message_number = message_number;
-      new->message_priority = priority;
+      new->message_priority = itti_get_message_priority (ITTI_MSG_ID (message));
       /*
        * Enqueue message in destination task queue
        */
       lfds710_queue_bmm_enqueue (&itti_desc.tasks[destination_task_id].message_queue, NULL, new);
-      VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME (VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_ENQUEUE_MESSAGE, VCD_FUNCTION_OUT);
       {
         /*
          * Only use event fd for tasks, subtasks will pool the queue
@@ -446,9 +864,8 @@ itti_send_msg_to_task (
           AssertFatal (write_ret == sizeof (sem_counter), "Write to task message FD (%d) failed (%d/%d)\n", destination_thread_id, (int)write_ret, (int)sizeof (sem_counter));
         }
       }
-
-      ITTI_DEBUG (ITTI_DEBUG_SEND, " Message %s, number %lu with priority %d successfully sent from %s to queue (%u:%s)\n",
-                  itti_desc.messages_info[message_id].name, message_number, priority, itti_get_task_name (origin_task_id), destination_task_id, itti_get_task_name (destination_task_id));
+#endif
+      VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME (VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_ENQUEUE_MESSAGE, VCD_FUNCTION_OUT);
     }
   } else {
     /*
@@ -463,6 +880,43 @@ itti_send_msg_to_task (
   return 0;
 }
 
+int
+itti_send_msg_batch (
+  task_id_t destination_task_id,
+  instance_t instance,
+  MessageDef ** messages,
+  uint32_t nb_messages)
+{
+#if ITTI_SPSC_RINGS
+  uint32_t                                i = 0;
+
+  AssertFatal (messages != NULL, "Messages is NULL!\n");
+  if (destination_task_id == TASK_UNKNOWN) {
+    for (i = 0; i < nb_messages; i++) {
+      itti_send_msg_to_task (destination_task_id, instance, messages[i]);
+    }
+    return 0;
+  }
+  for (i = 0; i < nb_messages; i++) {
+    if (!itti_prepare_msg (destination_task_id, instance, messages[i], NULL)) {
+      /*
+       * Destination task has ended, release the whole batch
+       */
+      for (i = 0; i < nb_messages; i++) {
+        itti_free (ITTI_MSG_ORIGIN_ID (messages[i]), messages[i]);
+      }
+      return 0;
+    }
+  }
+  itti_enqueue_messages (destination_task_id, messages, nb_messages);
+#else
+  for (uint32_t i = 0; i < nb_messages; i++) {
+    itti_send_msg_to_task (destination_task_id, instance, messages[i]);
+  }
+#endif
+  return 0;
+}
+
 void
 itti_subscribe_event_fd (
   task_id_t task_id,
@@ -549,6 +1003,68 @@ itti_receive_msg_internal_event_fd (
   thread_id = TASK_GET_THREAD_ID (task_id);
   *received_msg = NULL;
 
+#if ITTI_SPSC_RINGS
+  task_desc_t                            *task = &itti_desc.tasks[task_id];
+  int                                     nb_other_events = 0;
+
+  /*
+   * Messages of the last wakeup are returned first, without any system call
+   */
+  if (task->next_received < task->nb_received) {
+    *received_msg = task->received[task->next_received++];
+    itti_desc.threads[thread_id].epoll_nb_events = 0;
+    return;
+  }
+
+  do {
+    /*
+     * Do not block if some messages are still in the rings, the event fd is only
+     * * * signalled on the empty to non-empty transition.
+     */
+    if ((polling) || (task->dequeued != __atomic_load_n (&task->enqueued, __ATOMIC_SEQ_CST))) {
+      epoll_timeout = 0;
+    } else {
+      epoll_timeout = -1;
+    }
+
+    do {
+      epoll_ret = epoll_wait (itti_desc.threads[thread_id].epoll_fd, itti_desc.threads[thread_id].events, itti_desc.threads[thread_id].nb_events, epoll_timeout);
+    } while (epoll_ret < 0 && errno == EINTR);
+
+    if (epoll_ret < 0) {
+      AssertFatal (0, "epoll_wait failed for task %s: %s!\n", itti_get_task_name (task_id), strerror (errno));
+    }
+
+    itti_desc.threads[thread_id].epoll_nb_events = epoll_ret;
+    nb_other_events = epoll_ret;
+
+    for (i = 0; i < epoll_ret; i++) {
+      if ((itti_desc.threads[thread_id].events[i].events & EPOLLIN) && (itti_desc.threads[thread_id].events[i].data.fd == itti_desc.threads[thread_id].task_event_fd)) {
+        eventfd_t                               sem_counter;
+        ssize_t                                 read_ret;
+
+        /*
+         * Reset the event fd counter, messages are counted by the rings
+         */
+        read_ret = read (itti_desc.threads[thread_id].task_event_fd, &sem_counter, sizeof (sem_counter));
+        AssertFatal (read_ret == sizeof (sem_counter), "Read from task message FD (%d) failed (%d/%d)!\n", thread_id, (int)read_ret, (int)sizeof (sem_counter));
+        /*
+         * Mark that the event has been processed
+         */
+        itti_desc.threads[thread_id].events[i].events &= ~EPOLLIN;
+        nb_other_events--;
+      }
+    }
+
+    if (itti_dequeue_messages (task_id) > 0) {
+      *received_msg = task->received[task->next_received++];
+      return;
+    }
+    /*
+     * Nothing for ITTI (spurious wakeup), wait again unless there are events for other fds
+     */
+  } while ((!polling) && (nb_other_events == 0));
+#else
   if (polling) {
     /*
      * In polling mode we set the timeout to 0 causing epoll_wait to return
@@ -613,6 +1129,7 @@ itti_receive_msg_internal_event_fd (
       return;
     }
   }
+#endif
 }
 
 void
@@ -633,6 +1150,15 @@ itti_poll_msg (
   AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
   *received_msg = NULL;
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_POLL_MSG, __sync_or_and_fetch (&itti_desc.vcd_poll_msg, 1L << task_id));
+#if ITTI_SPSC_RINGS
+  {
+    task_desc_t                            *task = &itti_desc.tasks[task_id];
+
+    if ((task->next_received < task->nb_received) || (itti_dequeue_messages (task_id) > 0)) {
+      *received_msg = task->received[task->next_received++];
+    }
+  }
+#else
   {
     struct message_list_s                  *message;
 
@@ -644,6 +1170,7 @@ itti_poll_msg (
       AssertFatal (result == EXIT_SUCCESS, "Failed to free memory (%d)!\n", result);
     }
   }
+#endif
 
   if (*received_msg == NULL) {
     ITTI_DEBUG (ITTI_DEBUG_POLL, " No message in queue[(%u:%s)]\n", task_id, itti_get_task_name (task_id));
@@ -770,10 +1297,13 @@ itti_init (
   const task_info_t * tasks_info,
   const message_info_t * messages_info,
   const char *const messages_definition_xml,
-  const char *const dump_file_name)
+  const char *const dump_file_name,
+  const memory_pools_config_t * const memory_pools_config)
 {
   task_id_t                               task_id;
   thread_id_t                             thread_id;
+  const memory_pools_config_t             default_memory_pools_config = ITTI_MEMORY_POOLS_DEFAULT_CONFIG;
+  const memory_pools_config_t            *pools_config = &default_memory_pools_config;
 
   itti_desc.message_number = 1;
   ITTI_DEBUG (ITTI_DEBUG_INIT, " Init: %d tasks, %d threads, %d messages\n", task_max, thread_max, messages_id_max);
@@ -796,6 +1326,9 @@ itti_init (
    * Allocates memory for threads info
    */
   itti_desc.threads = calloc (itti_desc.thread_max, sizeof (thread_desc_t));
+#if ITTI_SPSC_RINGS
+  pthread_key_create (&itti_thread_rings_key, free);
+#endif
 
   /*
    * Initializing each queue and related stuff
@@ -808,8 +1341,19 @@ itti_init (
     ITTI_DEBUG (ITTI_DEBUG_INIT, " Creating queue of message of size %u\n", itti_desc.tasks_info[task_id].queue_size);
     printf (" Creating queue of message of size %u\n", itti_desc.tasks_info[task_id].queue_size);
 
+#if ITTI_SPSC_RINGS
+    /*
+     * Each thread sending to the task gets its own ring of queue_size (rounded to a power of 2) messages
+     */
+    itti_desc.tasks[task_id].ring_size = 1;
+    while (itti_desc.tasks[task_id].ring_size < itti_desc.tasks_info[task_id].queue_size) {
+      itti_desc.tasks[task_id].ring_size <<= 1;
+    }
+    pthread_mutex_init (&itti_desc.tasks[task_id].overflow_mutex, NULL);
+#else
     itti_desc.tasks[task_id].qbmme = calloc(itti_desc.tasks_info[task_id].queue_size, sizeof(struct lfds710_queue_bmm_element));
     lfds710_queue_bmm_init_valid_on_current_logical_core( &itti_desc.tasks[task_id].message_queue, itti_desc.tasks[task_id].qbmme, itti_desc.tasks_info[task_id].queue_size, NULL );
+#endif
   }
 
   /*
@@ -826,7 +1370,11 @@ itti_init (
       AssertFatal (0, "Failed to create new epoll fd: %s!\n", strerror (errno));
     }
 
+#if ITTI_SPSC_RINGS
+    itti_desc.threads[thread_id].task_event_fd = eventfd (0, 0);
+#else
     itti_desc.threads[thread_id].task_event_fd = eventfd (0, EFD_SEMAPHORE);
+#endif
 
     if (itti_desc.threads[thread_id].task_event_fd == -1) {
       /*
@@ -858,12 +1406,22 @@ itti_init (
   itti_desc.created_tasks = 0;
   itti_desc.ready_tasks = 0;
 
-  itti_desc.memory_pools_handle = memory_pools_create (5);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 1000 + ITTI_QUEUE_MAX_ELEMENTS, 50);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 1000 + (2 * ITTI_QUEUE_MAX_ELEMENTS), 100);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 10000, 1000);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 400, 20050);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 100, 30050);
+  /*
+   * Pools geometry of the configuration file if any, magazines of the per thread caches in front of them
+   */
+  if ((memory_pools_config) && (memory_pools_config->pools_number)) {
+    pools_config = memory_pools_config;
+  }
+
+  itti_desc.memory_pools_handle = memory_pools_create (pools_config->pools_number);
+
+  for (uint32_t pool = 0; pool < pools_config->pools_number; pool++) {
+    memory_pools_add_pool (itti_desc.memory_pools_handle, pools_config->pools[pool].items_number, pools_config->pools[pool].item_size);
+  }
+
+  memory_pools_set_magazine_size (itti_desc.memory_pools_handle, (memory_pools_config) ? memory_pools_config->magazine_size : pools_config->magazine_size,
+                                  itti_desc.thread_max);
+  memory_pools_set_info_statistics (itti_desc.memory_pools_handle, itti_desc.task_max, itti_get_task_name_info);
   {
     char                                   *statistics = memory_pools_statistics (itti_desc.memory_pools_handle);
 
@@ -953,6 +1511,10 @@ itti_wait_tasks_end (
     ITTI_DEBUG (ITTI_DEBUG_ISSUES, " Some threads are still running, force exit\n");
     exit (0);
   }
+  timer_exit ();
+#if ITTI_SPSC_RINGS
+  itti_free_rings ();
+#endif
 }
 
 void
@@ -109,6 +109,15 @@ int itti_send_broadcast_message(MessageDef *message_p);
  **/
 int itti_send_msg_to_task(task_id_t task_id, instance_t instance, MessageDef *message);
 
+/** \brief Send several messages to the same task, the destination is woken up at most once
+ \param task_id Task ID
+ \param instance Instance of the task used for virtualization
+ \param messages Array of pointers to the messages to send
+ \param nb_messages Number of messages in array
+ @returns -1 on failure, 0 otherwise
+ **/
+int itti_send_msg_batch(task_id_t task_id, instance_t instance, MessageDef **messages, uint32_t nb_messages);
+
 /** \brief Add a new fd to monitor.
  * NOTE: it is up to the user to read data associated with the fd
  *  \param task_id Task ID of the receiving task
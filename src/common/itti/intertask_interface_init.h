@@ -38,6 +38,7 @@
 #define INTERTASK_INTERFACE_INIT_H_
 
 #include "intertask_interface.h"
+#include "memory_pools.h"
 
 #ifndef CHECK_PROTOTYPE_ONLY
 
@@ -65,10 +66,11 @@ const message_info_t messages_info[] = {
  * \param messages_id_max Maximum message id
  * \param threads_name Pointer on the threads name information as created by this include file
  * \param messages_info Pointer on messages information as created by this include file
+ * \param memory_pools_config Message memory pools geometry and thread caches, NULL or no pools for the defaults
  **/
 int itti_init(task_id_t task_max, thread_id_t thread_max, MessagesIds messages_id_max, const task_info_t *tasks_info,
               const message_info_t *messages_info, const char * const messages_definition_xml,
-              const char * const dump_file_name);
+              const char * const dump_file_name, const memory_pools_config_t * const memory_pools_config);
 
 #endif /* INTERTASK_INTERFACE_INIT_H_ */
 /* @} */
@@ -19,6 +19,12 @@
  *      contact@openairinterface.org
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
 #include "assertions.h"
 #include "memory_pools.h"
 #include "dynamic_memory_check.h"
@@ -96,16 +102,42 @@ typedef struct memory_pool_item_s {
   memory_pool_item_end_t                  end;
 } memory_pool_item_t;
 
+/*
+ * Magazine of free item indexes. A thread holds two per pool (loaded and previous) and allocates from or frees to them
+ * under the spin lock of its cache, only contended by a thread flushing the caches of an exhausted pool. Whole magazines
+ * are exchanged with the depot of the pool under the pool mutex.
+ */
+typedef struct memory_pool_magazine_s {
+  struct memory_pool_magazine_s          *next;
+  uint32_t                                rounds;
+  items_group_index_t                     indexes[0];
+} memory_pool_magazine_t;
+
+typedef struct memory_pool_depot_s {
+  memory_pool_magazine_t                 *full;
+  memory_pool_magazine_t                 *empty;
+  uint32_t                                full_number;
+  uint32_t                                empty_number;
+} memory_pool_depot_t;
+
 typedef struct memory_pool_s {
   pool_start_mark_t                       start_mark;
 
   pool_id_t                               pool_id;
   uint32_t                                item_data_number;
   uint32_t                                pool_item_size;
+  pthread_mutex_t                         mutex;              // items_group_free and depot
   items_group_t                           items_group_free;
   memory_pool_item_t                     *items;
+  uint32_t                                magazine_size;      // 0: not cached
+  memory_pool_depot_t                     depot;
 } memory_pool_t;
 
+typedef struct memory_pool_info_statistics_s {
+  volatile uint32_t                       in_use;
+  volatile uint32_t                       high_water;
+  volatile uint64_t                       allocated;
+} memory_pool_info_statistics_t;
 
 typedef struct memory_pools_s {
   pools_start_mark_t                      start_mark;
@@ -113,10 +145,32 @@ typedef struct memory_pools_s {
   uint32_t                                pools_number;
   uint32_t                                pools_defined;
   memory_pool_t                          *pools;
+
+  uint32_t                                magazine_size;
+  uint32_t                                thread_caches_number;
+  pthread_key_t                           thread_cache_key;
+  pthread_mutex_t                         thread_caches_mutex;
+  struct memory_pools_thread_cache_s     *thread_caches;
+
+  uint16_t                                info_number;
+  uint32_t                                info_stride;        // statistics of an info_0 on whole cache lines
+  const char                           *(*info_name) (uint16_t info_0);
+  memory_pool_info_statistics_t          *info_statistics;
 } memory_pools_t;
 
+typedef struct memory_pools_thread_cache_s {
+  memory_pools_t                         *memory_pools;
+  struct memory_pools_thread_cache_s     *next;               // thread caches of the memory pools
+  pthread_spinlock_t                      lock;               // magazines
+  struct {
+    memory_pool_magazine_t                 *loaded;
+    memory_pool_magazine_t                 *previous;
+  } magazines[0];
+} memory_pools_thread_cache_t;
+
 //------------------------------------------------------------------------------
-static const uint32_t                   MAX_POOLS_NUMBER = 20;
+static const uint32_t                   MAX_POOLS_NUMBER = MEMORY_POOLS_MAX_POOLS;
+static const uint32_t                   CACHE_LINE_SIZE = 64;
 static const uint32_t                   MAX_POOL_ITEMS_NUMBER = 200 * 1000;
 static const uint32_t                   MAX_POOL_ITEM_SIZE = 100 * 1000;
 
@@ -246,6 +300,344 @@ items_group_put_free_item (
   return (EXIT_SUCCESS);
 }
 
+//------------------------------------------------------------------------------
+// The free items group is only accessed under the pool mutex: concurrent gets and puts of its lock-free positions
+// could skip an index being put (an allocation then failing or falling through to the next pool) and later put over it.
+static inline                           uint32_t
+memory_pool_get_free_items (
+  memory_pool_t * memory_pool,
+  items_group_index_t * indexes,
+  uint32_t number)
+{
+  uint32_t                                got = 0;
+
+  pthread_mutex_lock (&memory_pool->mutex);
+
+  while (got < number) {
+    indexes[got] = items_group_get_free_item (&memory_pool->items_group_free);
+
+    if (indexes[got] <= ITEMS_GROUP_INDEX_INVALID) {
+      break;
+    }
+
+    got++;
+  }
+
+  pthread_mutex_unlock (&memory_pool->mutex);
+  return (got);
+}
+
+//------------------------------------------------------------------------------
+static inline int
+memory_pool_put_free_items (
+  memory_pool_t * memory_pool,
+  items_group_index_t * indexes,
+  uint32_t number)
+{
+  int                                     result = EXIT_SUCCESS;
+
+  pthread_mutex_lock (&memory_pool->mutex);
+
+  for (uint32_t i = 0; (i < number) && (result == EXIT_SUCCESS); i++) {
+    result = items_group_put_free_item (&memory_pool->items_group_free, indexes[i]);
+  }
+
+  pthread_mutex_unlock (&memory_pool->mutex);
+  return (result);
+}
+
+//------------------------------------------------------------------------------
+static memory_pool_magazine_t          *
+memory_pool_magazine_new (
+  memory_pool_t * memory_pool)
+{
+  memory_pool_magazine_t                 *magazine;
+
+  magazine = calloc (1, sizeof (memory_pool_magazine_t) + memory_pool->magazine_size * sizeof (items_group_index_t));
+  AssertFatal (magazine != NULL, "Memory pool magazine allocation failed!\n");
+  return (magazine);
+}
+
+//------------------------------------------------------------------------------
+// Under the pool mutex: the depot keeps at most one empty magazine per thread cache, the others are freed
+static inline void
+memory_pool_depot_put_empty_magazine (
+  memory_pools_t * memory_pools,
+  memory_pool_t * memory_pool,
+  memory_pool_magazine_t * magazine)
+{
+  if (memory_pool->depot.empty_number >= memory_pools->thread_caches_number) {
+    free (magazine);
+    return;
+  }
+
+  magazine->next = memory_pool->depot.empty;
+  memory_pool->depot.empty = magazine;
+  memory_pool->depot.empty_number++;
+}
+
+//------------------------------------------------------------------------------
+// Under the cache lock
+static inline                           items_group_index_t
+memory_pool_magazines_get_free_item (
+  memory_pools_t * memory_pools,
+  memory_pool_t * memory_pool,
+  memory_pools_thread_cache_t * cache)
+{
+  memory_pool_magazine_t                **loaded = &cache->magazines[memory_pool->pool_id].loaded;
+  memory_pool_magazine_t                **previous = &cache->magazines[memory_pool->pool_id].previous;
+  memory_pool_magazine_t                 *magazine;
+
+  if (*loaded == NULL) {
+    *loaded = memory_pool_magazine_new (memory_pool);
+    *previous = memory_pool_magazine_new (memory_pool);
+  }
+
+  if ((*loaded)->rounds == 0) {
+    if ((*previous)->rounds > 0) {
+      magazine = *loaded;
+      *loaded = *previous;
+      *previous = magazine;
+    } else {
+      /*
+       * Both empty: exchange the previous one for a full one of the depot
+       */
+      pthread_mutex_lock (&memory_pool->mutex);
+      magazine = memory_pool->depot.full;
+
+      if (magazine) {
+        memory_pool->depot.full = magazine->next;
+        memory_pool->depot.full_number--;
+        memory_pool_depot_put_empty_magazine (memory_pools, memory_pool, *previous);
+        *previous = *loaded;
+        *loaded = magazine;
+      }
+
+      pthread_mutex_unlock (&memory_pool->mutex);
+
+      if (magazine == NULL) {
+        /*
+         * Depot empty too: load from the pool free items
+         */
+        (*loaded)->rounds = memory_pool_get_free_items (memory_pool, (*loaded)->indexes, memory_pool->magazine_size);
+
+        if ((*loaded)->rounds == 0) {
+          return (ITEMS_GROUP_INDEX_INVALID);
+        }
+      }
+    }
+  }
+
+  return ((*loaded)->indexes[--(*loaded)->rounds]);
+}
+
+//------------------------------------------------------------------------------
+// Gives back to the pool the free items cached by the threads other than the one of cache, returns their number
+static uint32_t
+memory_pool_flush_thread_caches (
+  memory_pools_t * memory_pools,
+  memory_pool_t * memory_pool,
+  memory_pools_thread_cache_t * cache)
+{
+  memory_pools_thread_cache_t            *other;
+  memory_pool_magazine_t                 *magazines[2];
+  uint32_t                                flushed = 0;
+
+  pthread_mutex_lock (&memory_pools->thread_caches_mutex);
+
+  for (other = memory_pools->thread_caches; other; other = other->next) {
+    if (other == cache) {
+      continue;
+    }
+
+    pthread_spin_lock (&other->lock);
+    magazines[0] = other->magazines[memory_pool->pool_id].loaded;
+    magazines[1] = other->magazines[memory_pool->pool_id].previous;
+
+    for (int i = 0; i < 2; i++) {
+      if ((magazines[i]) && (magazines[i]->rounds)) {
+        memory_pool_put_free_items (memory_pool, magazines[i]->indexes, magazines[i]->rounds);
+        flushed += magazines[i]->rounds;
+        magazines[i]->rounds = 0;
+      }
+    }
+
+    pthread_spin_unlock (&other->lock);
+  }
+
+  pthread_mutex_unlock (&memory_pools->thread_caches_mutex);
+  return (flushed);
+}
+
+//------------------------------------------------------------------------------
+static inline                           items_group_index_t
+memory_pool_cache_get_free_item (
+  memory_pools_t * memory_pools,
+  memory_pool_t * memory_pool,
+  memory_pools_thread_cache_t * cache)
+{
+  items_group_index_t                     index;
+
+  pthread_spin_lock (&cache->lock);
+  index = memory_pool_magazines_get_free_item (memory_pools, memory_pool, cache);
+  pthread_spin_unlock (&cache->lock);
+
+  /*
+   * Pool and depot exhausted: the free items may be in the caches of the other threads, the cache lock is not held
+   * while flushing them so that two threads doing it at the same time do not wait for each other
+   */
+  if ((index <= ITEMS_GROUP_INDEX_INVALID) && (memory_pool_flush_thread_caches (memory_pools, memory_pool, cache))) {
+    pthread_spin_lock (&cache->lock);
+    index = memory_pool_magazines_get_free_item (memory_pools, memory_pool, cache);
+    pthread_spin_unlock (&cache->lock);
+  }
+
+  return (index);
+}
+
+//------------------------------------------------------------------------------
+static inline void
+memory_pool_cache_put_free_item (
+  memory_pool_t * memory_pool,
+  memory_pools_thread_cache_t * cache,
+  items_group_index_t index)
+{
+  memory_pool_magazine_t                **loaded = &cache->magazines[memory_pool->pool_id].loaded;
+  memory_pool_magazine_t                **previous = &cache->magazines[memory_pool->pool_id].previous;
+  memory_pool_magazine_t                 *magazine;
+
+  pthread_spin_lock (&cache->lock);
+
+  if (*loaded == NULL) {
+    *loaded = memory_pool_magazine_new (memory_pool);
+    *previous = memory_pool_magazine_new (memory_pool);
+  }
+
+  if ((*loaded)->rounds == memory_pool->magazine_size) {
+    if ((*previous)->rounds == 0) {
+      magazine = *loaded;
+      *loaded = *previous;
+      *previous = magazine;
+    } else {
+      /*
+       * Both full: give the previous one to the depot for an empty one
+       */
+      pthread_mutex_lock (&memory_pool->mutex);
+      magazine = memory_pool->depot.empty;
+
+      if (magazine) {
+        memory_pool->depot.empty = magazine->next;
+        memory_pool->depot.empty_number--;
+      }
+
+      (*previous)->next = memory_pool->depot.full;
+      memory_pool->depot.full = *previous;
+      memory_pool->depot.full_number++;
+      pthread_mutex_unlock (&memory_pool->mutex);
+
+      if (magazine == NULL) {
+        magazine = memory_pool_magazine_new (memory_pool);
+      }
+
+      magazine->rounds = 0;
+      *previous = *loaded;
+      *loaded = magazine;
+    }
+  }
+
+  (*loaded)->indexes[(*loaded)->rounds++] = index;
+  pthread_spin_unlock (&cache->lock);
+}
+
+//------------------------------------------------------------------------------
+// pthread key destructor: the items cached by an exiting thread go back to the pools, the depots keep one empty
+// magazine less
+static void
+memory_pools_thread_cache_free (
+  void *arg)
+{
+  memory_pools_thread_cache_t            *cache = (memory_pools_thread_cache_t *) arg;
+  memory_pools_t                         *memory_pools = cache->memory_pools;
+  memory_pools_thread_cache_t           **link;
+  memory_pool_magazine_t                 *magazines[2];
+  memory_pool_t                          *memory_pool;
+  pool_id_t                               pool;
+
+  pthread_mutex_lock (&memory_pools->thread_caches_mutex);
+
+  for (link = &memory_pools->thread_caches; *link != cache; link = &(*link)->next);
+
+  *link = cache->next;
+  memory_pools->thread_caches_number--;
+
+  for (pool = 0; pool < memory_pools->pools_defined; pool++) {
+    memory_pool = &memory_pools->pools[pool];
+    magazines[0] = cache->magazines[pool].loaded;
+    magazines[1] = cache->magazines[pool].previous;
+
+    for (int i = 0; i < 2; i++) {
+      if (magazines[i]) {
+        memory_pool_put_free_items (memory_pool, magazines[i]->indexes, magazines[i]->rounds);
+        free (magazines[i]);
+      }
+    }
+
+    pthread_mutex_lock (&memory_pool->mutex);
+
+    while (memory_pool->depot.empty_number > memory_pools->thread_caches_number) {
+      magazines[0] = memory_pool->depot.empty;
+      memory_pool->depot.empty = magazines[0]->next;
+      memory_pool->depot.empty_number--;
+      free (magazines[0]);
+    }
+
+    pthread_mutex_unlock (&memory_pool->mutex);
+  }
+
+  pthread_mutex_unlock (&memory_pools->thread_caches_mutex);
+  pthread_spin_destroy (&cache->lock);
+  free (cache);
+}
+
+//------------------------------------------------------------------------------
+static inline memory_pools_thread_cache_t *
+memory_pools_thread_cache (
+  memory_pools_t * memory_pools)
+{
+  memory_pools_thread_cache_t            *cache;
+
+  cache = pthread_getspecific (memory_pools->thread_cache_key);
+
+  if (cache == NULL) {
+    cache = calloc (1, sizeof (memory_pools_thread_cache_t) + memory_pools->pools_defined * sizeof (cache->magazines[0]));
+    AssertFatal (cache != NULL, "Memory pools thread cache allocation failed!\n");
+    cache->memory_pools = memory_pools;
+    pthread_spin_init (&cache->lock, PTHREAD_PROCESS_PRIVATE);
+    pthread_mutex_lock (&memory_pools->thread_caches_mutex);
+    cache->next = memory_pools->thread_caches;
+    memory_pools->thread_caches = cache;
+    memory_pools->thread_caches_number++;
+    pthread_mutex_unlock (&memory_pools->thread_caches_mutex);
+    pthread_setspecific (memory_pools->thread_cache_key, cache);
+  }
+
+  return (cache);
+}
+
+//------------------------------------------------------------------------------
+static inline memory_pool_info_statistics_t *
+memory_pools_info_statistics (
+  memory_pools_t * memory_pools,
+  pool_id_t pool,
+  uint16_t info_0)
+{
+  if ((memory_pools->info_statistics == NULL) || (info_0 >= memory_pools->info_number)) {
+    return (NULL);
+  }
+
+  return (&memory_pools->info_statistics[(info_0 * memory_pools->info_stride) + pool]);
+}
+
 //------------------------------------------------------------------------------
 static inline memory_pools_t           *
 memory_pools_from_handler (
@@ -317,6 +709,12 @@ memory_pools_handle_t memory_pools_create (uint32_t pools_number)
     memory_pools->start_mark = POOLS_START_MARK;
     memory_pools->pools_number = pools_number;
     memory_pools->pools_defined = 0;
+    memory_pools->magazine_size = 0;
+    memory_pools->thread_caches = NULL;
+    memory_pools->thread_caches_number = 0;
+    pthread_mutex_init (&memory_pools->thread_caches_mutex, NULL);
+    memory_pools->info_number = 0;
+    memory_pools->info_statistics = NULL;
     /*
      * Allocate pools
      */
@@ -346,27 +744,53 @@ memory_pools_statistics (
   uint32_t                                allocated_pools_memory = 0;
   items_group_t                          *items_group;
   uint32_t                                pool_items_size;
+  uint32_t                                depot_items;
+  uint16_t                                info_0;
+  memory_pool_info_statistics_t          *info_statistics;
 
   /*
    * Recover memory_pools
    */
   memory_pools = memory_pools_from_handler (memory_pools_handle);
   AssertFatal (memory_pools != NULL, "Failed to retrieve memory pool for handle %p!\n", memory_pools_handle);
-  statistics = malloc (memory_pools->pools_defined * 200);
-  printed_chars = sprintf (&statistics[0], "Pool:   size, number, minimum,   free, address space and memory used in Kbytes\n");
+  statistics = malloc ((memory_pools->pools_defined * 200) + 100 + (memory_pools->info_number * memory_pools->pools_defined * 100));
+  printed_chars = sprintf (&statistics[0], "Pool:   size, number, minimum,   free, magazine, depot, address space and memory used in Kbytes\n");
 
   for (pool = 0; pool < memory_pools->pools_defined; pool++) {
     items_group = &memory_pools->pools[pool].items_group_free;
     allocated_pool_memory = items_group_number_items (items_group) * memory_pools->pools[pool].pool_item_size;
     allocated_pools_memory += allocated_pool_memory;
     pool_items_size = memory_pools->pools[pool].item_data_number * sizeof (memory_pool_data_t);
-    printed_chars += sprintf (&statistics[printed_chars], "  %2u: %6u, %6u,  %6u, %6u, [%p-%p] %6u\n",
+    /*
+     * Items cached by the threads are neither free nor in use, only the full magazines of the depot are counted
+     */
+    pthread_mutex_lock (&memory_pools->pools[pool].mutex);
+    depot_items = memory_pools->pools[pool].depot.full_number * memory_pools->pools[pool].magazine_size;
+    pthread_mutex_unlock (&memory_pools->pools[pool].mutex);
+    printed_chars += sprintf (&statistics[printed_chars], "  %2u: %6u, %6u,  %6u, %6u,   %6u, %5u, [%p-%p] %6u\n",
                               pool, pool_items_size,
                               items_group_number_items (items_group),
-                              items_group->minimum, items_group_free_items (items_group), memory_pools->pools[pool].items, ((void *)memory_pools->pools[pool].items) + allocated_pool_memory, allocated_pool_memory / (1024));
+                              items_group->minimum, items_group_free_items (items_group), memory_pools->pools[pool].magazine_size, depot_items,
+                              memory_pools->pools[pool].items, ((void *)memory_pools->pools[pool].items) + allocated_pool_memory, allocated_pool_memory / (1024));
   }
 
-  printed_chars = sprintf (&statistics[printed_chars], "Pools memory %u Kbytes\n", allocated_pools_memory / (1024));
+  printed_chars += sprintf (&statistics[printed_chars], "Pools memory %u Kbytes\n", allocated_pools_memory / (1024));
+
+  if (memory_pools->info_statistics) {
+    printed_chars += sprintf (&statistics[printed_chars], "Info:                             pool, allocated,  in use, high water\n");
+
+    for (info_0 = 0; info_0 < memory_pools->info_number; info_0++) {
+      for (pool = 0; pool < memory_pools->pools_defined; pool++) {
+        info_statistics = memory_pools_info_statistics (memory_pools, pool, info_0);
+
+        if (info_statistics->allocated) {
+          printed_chars += sprintf (&statistics[printed_chars], "  %-32.32s %2u, %9lu, %7u, %7u\n",
+                                    memory_pools->info_name ? memory_pools->info_name (info_0) : "", pool,
+                                    (unsigned long)info_statistics->allocated, info_statistics->in_use, info_statistics->high_water);
+        }
+      }
+    }
+  }
   return (statistics);
 }
 
@@ -413,6 +837,12 @@ memory_pools_add_pool (
     memory_pool->items_group_free.minimum = pool_items_number;
     memory_pool->items_group_free.positions.ind.put = pool_items_number;
     memory_pool->items_group_free.positions.ind.get = 0;
+    memory_pool->magazine_size = 0;
+    pthread_mutex_init (&memory_pool->mutex, NULL);
+    memory_pool->depot.full = NULL;
+    memory_pool->depot.empty = NULL;
+    memory_pool->depot.full_number = 0;
+    memory_pool->depot.empty_number = 0;
     /*
      * Allocate free indexes
      */
@@ -451,6 +881,72 @@ memory_pools_add_pool (
   return (0);
 }
 
+//------------------------------------------------------------------------------
+int
+memory_pools_set_magazine_size (
+  memory_pools_handle_t memory_pools_handle,
+  uint32_t magazine_size,
+  uint32_t threads_number)
+{
+  memory_pools_t                         *memory_pools;
+  memory_pool_t                          *memory_pool;
+  pool_id_t                               pool;
+  uint32_t                                pool_magazine_size;
+
+  memory_pools = memory_pools_from_handler (memory_pools_handle);
+  AssertFatal (memory_pools != NULL, "Failed to retrieve memory pool for handle %p!\n", memory_pools_handle);
+  AssertFatal (memory_pools->magazine_size == 0, "Memory pools magazine size already set (%u)!\n", memory_pools->magazine_size);
+
+  if ((magazine_size == 0) || (threads_number == 0)) {
+    return (0);
+  }
+
+  AssertFatal (pthread_key_create (&memory_pools->thread_cache_key, memory_pools_thread_cache_free) == 0, "Memory pools thread cache key creation failed!\n");
+  memory_pools->magazine_size = magazine_size;
+
+  for (pool = 0; pool < memory_pools->pools_defined; pool++) {
+    memory_pool = &memory_pools->pools[pool];
+    /*
+     * The two magazines of every thread must not hold more than the pool
+     */
+    pool_magazine_size = items_group_number_items (&memory_pool->items_group_free) / (2 * threads_number);
+
+    if (pool_magazine_size > magazine_size) {
+      pool_magazine_size = magazine_size;
+    }
+
+    memory_pool->magazine_size = (pool_magazine_size >= 2) ? pool_magazine_size : 0;
+  }
+
+  return (0);
+}
+
+//------------------------------------------------------------------------------
+int
+memory_pools_set_info_statistics (
+  memory_pools_handle_t memory_pools_handle,
+  uint16_t info_0_number,
+  const char *(*info_0_name) (uint16_t info_0))
+{
+  memory_pools_t                         *memory_pools;
+  uint32_t                                per_line = CACHE_LINE_SIZE / sizeof (memory_pool_info_statistics_t);
+
+  memory_pools = memory_pools_from_handler (memory_pools_handle);
+  AssertFatal (memory_pools != NULL, "Failed to retrieve memory pool for handle %p!\n", memory_pools_handle);
+  AssertFatal (memory_pools->info_statistics == NULL, "Memory pools info statistics already set!\n");
+  memory_pools->info_stride = ((memory_pools->pools_defined + per_line - 1) / per_line) * per_line;
+  memory_pools->info_name = info_0_name;
+
+  if (posix_memalign ((void **)&memory_pools->info_statistics, CACHE_LINE_SIZE, info_0_number * memory_pools->info_stride * sizeof (memory_pool_info_statistics_t))) {
+    memory_pools->info_statistics = NULL;
+    return (EXIT_FAILURE);
+  }
+
+  memset (memory_pools->info_statistics, 0, info_0_number * memory_pools->info_stride * sizeof (memory_pool_info_statistics_t));
+  memory_pools->info_number = info_0_number;
+  return (0);
+}
+
 //------------------------------------------------------------------------------
 memory_pool_item_handle_t
 memory_pools_allocate (
@@ -464,6 +960,10 @@ memory_pools_allocate (
   memory_pool_item_handle_t               memory_pool_item_handle = NULL;
   pool_id_t                               pool;
   items_group_index_t                     item_index = ITEMS_GROUP_INDEX_INVALID;
+  memory_pools_thread_cache_t            *cache = NULL;
+  memory_pool_info_statistics_t          *info_statistics;
+  uint32_t                                in_use;
+  uint32_t                                high_water;
 
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_MP_ALLOC, __sync_or_and_fetch (&vcd_mp_alloc, 1L << info_0));
   /*
@@ -482,11 +982,19 @@ memory_pools_allocate (
       continue;
     }
 
-    item_index = items_group_get_free_item (&memory_pools->pools[pool].items_group_free);
+    if (memory_pools->pools[pool].magazine_size) {
+      if (cache == NULL) {
+        cache = memory_pools_thread_cache (memory_pools);
+      }
+
+      item_index = memory_pool_cache_get_free_item (memory_pools, &memory_pools->pools[pool], cache);
+    } else {
+      memory_pool_get_free_items (&memory_pools->pools[pool], &item_index, 1);
+    }
 
     if (item_index <= ITEMS_GROUP_INDEX_INVALID) {
       /*
-       * Allocation failed, skip this pool
+       * Pool exhausted, skip this pool
        */
       continue;
     } else {
@@ -510,6 +1018,21 @@ memory_pools_allocate (
     memory_pool_item->start.info[0] = info_0;
     memory_pool_item->start.info[1] = info_1;
     memory_pool_item_handle = memory_pool_item->data;
+    info_statistics = memory_pools_info_statistics (memory_pools, pool, info_0);
+
+    if (info_statistics) {
+      __sync_fetch_and_add (&info_statistics->allocated, 1);
+      in_use = __sync_add_and_fetch (&info_statistics->in_use, 1);
+
+      /*
+       * Updates high-water if needed
+       */
+      high_water = __atomic_load_n (&info_statistics->high_water, __ATOMIC_RELAXED);
+
+      while ((high_water < in_use) &&
+             (!__atomic_compare_exchange_n (&info_statistics->high_water, &high_water, in_use, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)));
+    }
+
     MP_DEBUG (" Alloc [%2u][%6d]{%6d}, %3u %3u, %6u, %p, %p, %p\n",
               pool, item_index, items_group_free_items (&memory_pools->pools[pool].items_group_free), info_0, info_1, item_size, memory_pools->pools[pool].items, memory_pool_item, memory_pool_item_handle);
   } else {
@@ -534,7 +1057,8 @@ memory_pools_free (
   uint32_t                                item_size;
   uint32_t                                pool_item_size;
   uint16_t                                info_1;
-  int                                     result;
+  int                                     result = EXIT_SUCCESS;
+  memory_pool_info_statistics_t          *info_statistics;
 
   /*
    * Recover memory_pools
@@ -574,7 +1098,17 @@ memory_pools_free (
    */
   AssertFatal (memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED, "Trying to free a non allocated (%x) memory pool item (pool %u, item %d)!\n", memory_pool_item->start.item_status, pool, item_index);
   memory_pool_item->start.item_status = ITEM_STATUS_FREE;
-  result = items_group_put_free_item (&memory_pools->pools[pool].items_group_free, item_index);
+  info_statistics = memory_pools_info_statistics (memory_pools, pool, memory_pool_item->start.info[0]);
+
+  if (info_statistics) {
+    __sync_fetch_and_sub (&info_statistics->in_use, 1);
+  }
+
+  if (memory_pools->pools[pool].magazine_size) {
+    memory_pool_cache_put_free_item (&memory_pools->pools[pool], memory_pools_thread_cache (memory_pools), item_index);
+  } else {
+    result = memory_pool_put_free_items (&memory_pools->pools[pool], &item_index, 1);
+  }
   AssertError (result == EXIT_SUCCESS, {
                }
                , "Failed to free memory pool item (pool %u, item %d)!\n", pool, item_index);
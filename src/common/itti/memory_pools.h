@@ -24,15 +24,40 @@
 
 #include <stdint.h>
 
+#define MEMORY_POOLS_MAX_POOLS            20
+
 typedef void * memory_pools_handle_t;
 typedef void * memory_pool_item_handle_t;
 
+/* Pools geometry, as read from the configuration file */
+typedef struct memory_pool_config_s {
+  uint32_t                        items_number;
+  uint32_t                        item_size;          /* bytes */
+} memory_pool_config_t;
+
+typedef struct memory_pools_config_s {
+  uint32_t                        pools_number;       /* 0: default geometry of the user */
+  memory_pool_config_t            pools[MEMORY_POOLS_MAX_POOLS];
+  uint32_t                        magazine_size;      /* items per magazine of the thread caches, 0: no thread cache */
+} memory_pools_config_t;
+
 memory_pools_handle_t memory_pools_create (uint32_t pools_number);
 
 char *memory_pools_statistics(memory_pools_handle_t memory_pools_handle);
 
 int memory_pools_add_pool (memory_pools_handle_t memory_pools_handle, uint32_t pool_items_number, uint32_t pool_item_size);
 
+/* Puts per thread caches of magazine_size free items (two magazines per pool) in front of the pools, refilled and
+ * drained by whole magazines through a per pool depot. The magazines of a pool are cut down so that those of
+ * threads_number threads do not hold more than the pool, pools too small for that are not cached. An allocation
+ * finding its pool exhausted takes back the items cached by the other threads.
+ * Must be called after the pools are added and before the first allocation. */
+int memory_pools_set_magazine_size (memory_pools_handle_t memory_pools_handle, uint32_t magazine_size, uint32_t threads_number);
+
+/* Counts the allocations, the items in use and their high-water per info_0 (ITTI: origin task) and per pool,
+ * reported by memory_pools_statistics() with the names given by info_0_name. */
+int memory_pools_set_info_statistics (memory_pools_handle_t memory_pools_handle, uint16_t info_0_number, const char *(*info_0_name) (uint16_t info_0));
+
 memory_pool_item_handle_t memory_pools_allocate (memory_pools_handle_t memory_pools_handle, uint32_t item_size, uint16_t info_0, uint16_t info_1);
 
 int memory_pools_free (memory_pools_handle_t memory_pools_handle, memory_pool_item_handle_t memory_pool_item_handle, uint16_t info_0);
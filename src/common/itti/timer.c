@@ -19,6 +19,7 @@
  *      contact@openairinterface.org
  */
 
+#define _GNU_SOURCE             // required for pthread_setname_np()
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -29,101 +30,193 @@
 #include <signal.h>
 #include <time.h>
 #include <errno.h>
+#include <sys/timerfd.h>
 
 #include "bstrlib.h"
 
 #include "intertask_interface.h"
 #include "timer.h"
+#include "timer_wheel.h"
 #include "log.h"
-#include "queue.h"
 #include "dynamic_memory_check.h"
 #include "assertions.h"
 
+/*
+ * All ITTI timers are kept in a single hierarchical timing wheel, driven by one
+ * timerfd that ticks every ITTI_TIMER_TICK_US while at least one timer is armed.
+ * A dedicated thread reads the timerfd, advances the wheel and sends the
+ * TIMER_HAS_EXPIRED messages of a tick, batched per task, once the timer lock
+ * has been released.
+ */
 
-int                                     timer_handle_signal (
-  siginfo_t * info);
-
-struct timer_elm_s {
+typedef struct timer_expired_s {
   task_id_t                               task_id;      ///< Task ID which has requested the timer
   int32_t                                 instance;     ///< Instance of the task which has requested the timer
-  timer_t                                 timer;        ///< Unique timer id
-  timer_type_t                            type; ///< Timer type
+  long                                    timer_id;     ///< Unique timer id
   void                                   *timer_arg;    ///< Optional argument that will be passed when timer expires
-                                          STAILQ_ENTRY (
-  timer_elm_s)                            entries;      ///< Pointer to next element
-};
+  bool                                    notified;
+} timer_expired_t;
 
 typedef struct timer_desc_s {
-  STAILQ_HEAD (
-  timer_list_head,
-  timer_elm_s) timer_queue;
+  timer_wheel_t                           wheel;
   pthread_mutex_t                         timer_list_mutex;
-  struct timespec                         timeout;
+  int                                     timer_fd;
+  bool                                    ticking;      ///< timer_fd is armed
+  bool                                    exiting;      ///< set by timer_exit(), ends the timer thread
+  pthread_t                               thread;
+
+  // Used by timer thread only
+  timer_expired_t                        *expired;
+  uint32_t                                expired_size;
+  uint32_t                                num_expired;
 } timer_desc_t;
 
 static timer_desc_t                     timer_desc;
 
-#define TIMER_SEARCH(vAR, tIMERfIELD, tIMERvALUE, tIMERqUEUE)   \
-  do {                                                            \
-    STAILQ_FOREACH(vAR, tIMERqUEUE, entries) {                  \
-      if (((vAR)->tIMERfIELD == tIMERvALUE))                  \
-        break;                                              \
-    }                                                           \
-  } while(0)
+// Max number of TIMER_HAS_EXPIRED messages sent to a task in one ITTI batch
+#define TIMER_NOTIFY_BATCH_MAX               64
 
-int
-timer_handle_signal (
-  siginfo_t * info)
+#define TIMER_USER_DATA(tASKiD, iNSTANCE)    ((((uint64_t)(tASKiD)) << 32) | (uint32_t)(iNSTANCE))
+#define TIMER_USER_DATA_TASK_ID(uSERdATA)    ((task_id_t)((uSERdATA) >> 32))
+#define TIMER_USER_DATA_INSTANCE(uSERdATA)   ((int32_t)((uSERdATA) & 0xFFFFFFFF))
+
+//------------------------------------------------------------------------------
+static uint64_t timer_interval_to_ticks (
+  uint32_t interval_sec,
+  uint32_t interval_us)
+{
+  uint64_t                                us = ((uint64_t)interval_sec * 1000000) + interval_us;
+  uint64_t                                ticks = (us + ITTI_TIMER_TICK_US - 1) / ITTI_TIMER_TICK_US;
+
+  return (ticks) ? ticks : 1;
+}
+
+//------------------------------------------------------------------------------
+// timer_list_mutex must be held
+static int timer_fd_set_ticking (
+  bool ticking)
+{
+  struct itimerspec                       its;
+
+  memset (&its, 0, sizeof (its));
+  if (ticking) {
+    its.it_value.tv_sec = ITTI_TIMER_TICK_US / 1000000;
+    its.it_value.tv_nsec = (ITTI_TIMER_TICK_US % 1000000) * 1000;
+    its.it_interval = its.it_value;
+  }
+  if (timerfd_settime (timer_desc.timer_fd, 0, &its, NULL) < 0) {
+    OAILOG_ERROR (LOG_ITTI, "Failed to %s timer fd: (%s:%d)\n", (ticking) ? "arm":"disarm", strerror (errno), errno);
+    return -1;
+  }
+  timer_desc.ticking = ticking;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Called with timer_list_mutex held, only record the expiry, messages are sent later.
+static void timer_collect_expired (
+  timer_wheel_id_t id,
+  uint64_t user_data,
+  void *arg,
+  void *cb_arg)
+{
+  timer_expired_t                        *expired = NULL;
+
+  if (timer_desc.num_expired == timer_desc.expired_size) {
+    uint32_t                                size = (timer_desc.expired_size) ? 2 * timer_desc.expired_size : 64;
+
+    expired = realloc (timer_desc.expired, size * sizeof (timer_expired_t));
+    AssertFatal (expired != NULL, "Failed to grow timer expiry batch to %u elements\n", size);
+    timer_desc.expired = expired;
+    timer_desc.expired_size = size;
+  }
+  expired = &timer_desc.expired[timer_desc.num_expired++];
+  expired->task_id = TIMER_USER_DATA_TASK_ID (user_data);
+  expired->instance = TIMER_USER_DATA_INSTANCE (user_data);
+  expired->timer_id = (long)id;
+  expired->timer_arg = arg;
+  expired->notified = false;
+}
+
+//------------------------------------------------------------------------------
+static MessageDef *timer_new_expired_message (
+  timer_expired_t * expired)
 {
-  struct timer_elm_s                     *timer_p;
   MessageDef                             *message_p;
   timer_has_expired_t                    *timer_expired_p;
-  task_id_t                               task_id;
-  int32_t                                 instance;
 
-  /*
-   * Get back pointer to timer list element
-   */
-  timer_p = (struct timer_elm_s *)info->si_ptr;
-  // LG: To many traces for msc timer:
-  // TMR_DEBUG("Timer with id 0x%lx has expired", (long)timer_p->timer);
-  task_id = timer_p->task_id;
-  instance = timer_p->instance;
   message_p = itti_alloc_new_message (TASK_TIMER, TIMER_HAS_EXPIRED);
   timer_expired_p = &message_p->ittiMsg.timer_has_expired;
-  timer_expired_p->timer_id = (long)timer_p->timer;
-  timer_expired_p->arg = timer_p->timer_arg;
+  timer_expired_p->timer_id = expired->timer_id;
+  timer_expired_p->arg = expired->timer_arg;
+  return message_p;
+}
 
-  /*
-   * Timer is a one shot timer, remove it
-   */
-  if (timer_p->type == TIMER_ONE_SHOT) {
-    //         if (timer_delete(timer_p->timer) < 0) {
-    //             TMR_DEBUG("Failed to delete timer 0x%lx", (long)timer_p->timer);
-    //         }
-    //         TMR_DEBUG("Removed timer 0x%lx", (long)timer_p->timer);
-    //         pthread_mutex_lock(&timer_desc.timer_list_mutex);
-    //         STAILQ_REMOVE(&timer_desc.timer_queue, timer_p, timer_elm_s, entries);
-    //         pthread_mutex_unlock(&timer_desc.timer_list_mutex);
-    //         free_wrapper(timer_p);
-    //         timer_p = NULL;
-    if (timer_remove ((long)timer_p->timer, NULL) != 0) {
-      OAILOG_DEBUG (LOG_ITTI, "Failed to delete timer 0x%lx\n", (long)timer_p->timer);
+//------------------------------------------------------------------------------
+// Notify tasks of timers expiry, one ITTI batch per task.
+static void timer_notify_expired (
+  void)
+{
+  MessageDef                             *batch[TIMER_NOTIFY_BATCH_MAX];
+  uint32_t                                nb = 0;
+
+  for (uint32_t i = 0; i < timer_desc.num_expired; i++) {
+    task_id_t                               task_id = timer_desc.expired[i].task_id;
+    int32_t                                 instance = timer_desc.expired[i].instance;
+
+    if (timer_desc.expired[i].notified) {
+      continue;
+    }
+    for (uint32_t j = i; j < timer_desc.num_expired; j++) {
+      if ((timer_desc.expired[j].notified) || (timer_desc.expired[j].task_id != task_id) || (timer_desc.expired[j].instance != instance)) {
+        continue;
+      }
+      timer_desc.expired[j].notified = true;
+      batch[nb++] = timer_new_expired_message (&timer_desc.expired[j]);
+      if (TIMER_NOTIFY_BATCH_MAX == nb) {
+        itti_send_msg_batch (task_id, instance, batch, nb);
+        nb = 0;
+      }
+    }
+    if (nb) {
+      itti_send_msg_batch (task_id, instance, batch, nb);
+      nb = 0;
     }
   }
+}
 
-  /*
-   * Notify task of timer expiry
-   */
-  if (itti_send_msg_to_task (task_id, instance, message_p) < 0) {
-    OAILOG_DEBUG (LOG_ITTI, "Failed to send msg TIMER_HAS_EXPIRED to task %u\n", task_id);
-    itti_free (TASK_TIMER, message_p);
-    return -1;
-  }
+//------------------------------------------------------------------------------
+static void *timer_thread (
+  void *args)
+{
+  uint64_t                                expirations = 0;
+  ssize_t                                 read_ret = 0;
+
+  while (1) {
+    read_ret = read (timer_desc.timer_fd, &expirations, sizeof (expirations));
+    if (read_ret != sizeof (expirations)) {
+      AssertFatal ((read_ret < 0) && (errno == EINTR), "Read from timer fd failed (%d/%d): %s\n", (int)read_ret, (int)sizeof (expirations), strerror (errno));
+      continue;
+    }
 
-  return 0;
+    pthread_mutex_lock (&timer_desc.timer_list_mutex);
+    if (timer_desc.exiting) {
+      pthread_mutex_unlock (&timer_desc.timer_list_mutex);
+      break;
+    }
+    timer_desc.num_expired = 0;
+    timer_wheel_advance (&timer_desc.wheel, expirations, timer_collect_expired, NULL);
+    if ((0 == timer_wheel_num_armed (&timer_desc.wheel)) && (timer_desc.ticking)) {
+      timer_fd_set_ticking (false);
+    }
+    pthread_mutex_unlock (&timer_desc.timer_list_mutex);
+
+    timer_notify_expired ();
+  }
+  return NULL;
 }
 
+//------------------------------------------------------------------------------
 int
 timer_setup (
   uint32_t interval_sec,
@@ -134,132 +227,109 @@ timer_setup (
   void *timer_arg,
   long *timer_id)
 {
-  struct sigevent                         se;
-  struct itimerspec                       its;
-  struct timer_elm_s                     *timer_p;
-  timer_t                                 timer;
+  uint64_t                                ticks = 0;
+  timer_wheel_id_t                        id = TIMER_WHEEL_INVALID_ID;
 
   if (timer_id == NULL) {
     return -1;
   }
 
   AssertFatal (type < TIMER_TYPE_MAX, "Invalid timer type (%d/%d)!\n", type, TIMER_TYPE_MAX);
-  /*
-   * Allocate new timer list element
-   */
-  timer_p = malloc (sizeof (struct timer_elm_s));
+  ticks = timer_interval_to_ticks (interval_sec, interval_us);
 
-  if (timer_p == NULL) {
+  pthread_mutex_lock (&timer_desc.timer_list_mutex);
+  id = timer_wheel_arm (&timer_desc.wheel, ticks, (type == TIMER_PERIODIC) ? ticks : 0, TIMER_USER_DATA (task_id, instance), timer_arg);
+  if (TIMER_WHEEL_INVALID_ID == id) {
+    pthread_mutex_unlock (&timer_desc.timer_list_mutex);
     OAILOG_ERROR (LOG_ITTI, "Failed to create new timer element\n");
     return -1;
   }
-
-  memset (&timer, 0, sizeof (timer_t));
-  memset (&se, 0, sizeof (struct sigevent));
-  timer_p->task_id = task_id;
-  timer_p->instance = instance;
-  timer_p->type = type;
-  timer_p->timer_arg = timer_arg;
-  /*
-   * Setting up alarm
-   */
-  /*
-   * Set and enable alarm
-   */
-  se.sigev_notify = SIGEV_SIGNAL;
-  se.sigev_signo = SIGTIMER;
-  se.sigev_value.sival_ptr = timer_p;
-
-  /*
-   * At the timer creation, the timer structure will be filled in with timer_id,
-   * * * which is unique for this process. This id is allocated by kernel and the
-   * * * value might be used to distinguish timers.
-   */
-  if (timer_create (CLOCK_REALTIME, &se, &timer) < 0) {
-    OAILOG_ERROR (LOG_ITTI, "Failed to create timer: (%s:%d)\n", strerror (errno), errno);
-    free_wrapper ((void**)&timer_p);
+  if ((!timer_desc.ticking) && (timer_fd_set_ticking (true) < 0)) {
+    timer_wheel_cancel (&timer_desc.wheel, id, NULL);
+    pthread_mutex_unlock (&timer_desc.timer_list_mutex);
     return -1;
   }
+  pthread_mutex_unlock (&timer_desc.timer_list_mutex);
 
-  /*
-   * Fill in the first expiration value.
-   */
-  its.it_value.tv_sec = interval_sec;
-  its.it_value.tv_nsec = interval_us * 1000;
-
-  if (type == TIMER_PERIODIC) {
-    /*
-     * Asked for periodic timer. We set the interval time
-     */
-    its.it_interval.tv_sec = interval_sec;
-    its.it_interval.tv_nsec = interval_us * 1000;
-  } else {
-    /*
-     * Asked for one-shot timer. Do not set the interval field
-     */
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = 0;
-  }
-
-  timer_settime (timer, 0, &its, NULL);
   /*
    * Simply set the timer_id argument. so it can be used by caller
    */
-  *timer_id = (long)timer;
+  *timer_id = (long)id;
   OAILOG_DEBUG (LOG_ITTI, "Requesting new %s timer with id 0x%lx that expires within " "%d sec and %d usec\n", type == TIMER_PERIODIC ? "periodic" : "single shot", *timer_id, interval_sec, interval_us);
-  timer_p->timer = timer;
-  /*
-   * Lock the queue and insert the timer at the tail
-   */
-  pthread_mutex_lock (&timer_desc.timer_list_mutex);
-  STAILQ_INSERT_TAIL (&timer_desc.timer_queue, timer_p, entries);
-  pthread_mutex_unlock (&timer_desc.timer_list_mutex);
   return 0;
 }
 
+//------------------------------------------------------------------------------
 int timer_remove (long timer_id, void ** arg)
 {
   int                                     rc = 0;
-  struct timer_elm_s                     *timer_p;
 
   OAILOG_DEBUG (LOG_ITTI, "Removing timer 0x%lx\n", timer_id);
   pthread_mutex_lock (&timer_desc.timer_list_mutex);
-  TIMER_SEARCH (timer_p, timer, ((timer_t) timer_id), &timer_desc.timer_queue);
+  // let user of API get back arg that can be an allocated memory (memory leak).
+  rc = timer_wheel_cancel (&timer_desc.wheel, (timer_wheel_id_t)timer_id, arg);
+  pthread_mutex_unlock (&timer_desc.timer_list_mutex);
 
   /*
-   * We didn't find the timer in list
+   * We didn't find the timer in wheel
    */
-  if (timer_p == NULL) {
-    pthread_mutex_unlock (&timer_desc.timer_list_mutex);
-    if (arg) *arg = NULL;
+  if (rc < 0) {
     OAILOG_ERROR (LOG_ITTI, "Didn't find timer 0x%lx in list\n", timer_id);
-    return -1;
   }
-
-  STAILQ_REMOVE (&timer_desc.timer_queue, timer_p, timer_elm_s, entries);
-  pthread_mutex_unlock (&timer_desc.timer_list_mutex);
-
-  // let user of API get back arg that can be an allocated memory (memory leak).
-
-  if (arg) *arg = timer_p->timer_arg;
-  if (timer_delete (timer_p->timer) < 0) {
-    OAILOG_ERROR (LOG_ITTI, "Failed to delete timer 0x%lx\n", (long)timer_p->timer);
-    rc = -1;
-  }
-
-  free_wrapper ((void**)&timer_p);
   return rc;
 }
 
-
+//------------------------------------------------------------------------------
 int
 timer_init (
   void)
 {
+  int                                     rc = 0;
+
   OAILOG_DEBUG (LOG_ITTI, "Initializing TIMER task interface\n");
   memset (&timer_desc, 0, sizeof (timer_desc_t));
-  STAILQ_INIT (&timer_desc.timer_queue);
+  timer_wheel_init (&timer_desc.wheel);
   pthread_mutex_init (&timer_desc.timer_list_mutex, NULL);
+
+  timer_desc.timer_fd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (timer_desc.timer_fd < 0) {
+    OAILOG_ERROR (LOG_ITTI, "Failed to create timer fd: (%s:%d)\n", strerror (errno), errno);
+    return -1;
+  }
+
+  /*
+   * Signals are already masked by itti_init(), the timer thread inherits the mask.
+   */
+  rc = pthread_create (&timer_desc.thread, NULL, timer_thread, NULL);
+  if (rc) {
+    OAILOG_ERROR (LOG_ITTI, "Failed to create timer thread: (%s:%d)\n", strerror (rc), rc);
+    close (timer_desc.timer_fd);
+    return -1;
+  }
+  pthread_setname_np (timer_desc.thread, "ITTI timer");
   OAILOG_DEBUG (LOG_ITTI, "Initializing TIMER task interface: DONE\n");
   return 0;
 }
+
+//------------------------------------------------------------------------------
+void
+timer_exit (
+  void)
+{
+  OAILOG_DEBUG (LOG_ITTI, "Exiting TIMER task interface\n");
+  pthread_mutex_lock (&timer_desc.timer_list_mutex);
+  timer_desc.exiting = true;
+  // wake up the timer thread if the timer fd is not ticking
+  if (!timer_desc.ticking) {
+    timer_fd_set_ticking (true);
+  }
+  pthread_mutex_unlock (&timer_desc.timer_list_mutex);
+  pthread_join (timer_desc.thread, NULL);
+
+  close (timer_desc.timer_fd);
+  timer_wheel_destroy (&timer_desc.wheel);
+  free_wrapper ((void**)&timer_desc.expired);
+  timer_desc.expired_size = 0;
+  timer_desc.num_expired = 0;
+  pthread_mutex_destroy (&timer_desc.timer_list_mutex);
+}
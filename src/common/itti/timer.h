@@ -24,7 +24,10 @@
 
 #include <signal.h>
 
-#define SIGTIMER SIGRTMIN
+// Resolution of ITTI timers: 10 ms
+#ifndef ITTI_TIMER_TICK_US
+#  define ITTI_TIMER_TICK_US 10000
+#endif
 
 typedef enum timer_type_s {
   TIMER_PERIODIC,
@@ -32,15 +35,14 @@ typedef enum timer_type_s {
   TIMER_TYPE_MAX,
 } timer_type_t;
 
-int timer_handle_signal(siginfo_t *info);
-
 /** \brief Request a new timer
  *  \param interval_sec timer interval in seconds
  *  \param interval_us  timer interval in micro seconds
  *  \param task_id      task id of the task requesting the timer
  *  \param instance     instance of the task requesting the timer
  *  \param type         timer type
- *  \param timer_id     unique timer identifier
+ *  \param timer_arg    optional argument given back in TIMER_HAS_EXPIRED
+ *  \param timer_id     unique timer identifier, never reused before the timer is removed
  *  @returns -1 on failure, 0 otherwise
  **/
 int timer_setup(
@@ -54,6 +56,7 @@ int timer_setup(
 
 /** \brief Remove the timer from list
  *  \param timer_id unique timer id
+ *  \param arg      if not NULL, returns the timer_arg given at setup
  *  @returns -1 on failure, 0 otherwise
  **/
 
@@ -66,4 +69,8 @@ int timer_remove (long timer_id, void ** arg);
  **/
 int timer_init(void);
 
+/** \brief Stop the timer thread and release the timers and their resources
+ **/
+void timer_exit(void);
+
 #endif
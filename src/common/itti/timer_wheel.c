@@ -0,0 +1,256 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file timer_wheel.c
+  \brief Hierarchical timing wheel (4 levels of 256 slots), O(1) arm and cancel.
+         Timers of upper levels are cascaded down when the lower level wraps.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "bstrlib.h"
+
+#include "timer_wheel.h"
+#include "dynamic_memory_check.h"
+
+#define TIMER_WHEEL_LEVEL_INDEX(tICK, lEVEL) (((tICK) >> ((lEVEL) * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK)
+
+//------------------------------------------------------------------------------
+static inline timer_wheel_id_t timer_wheel_entry_id(const timer_wheel_entry_t * const entry)
+{
+  // index + 1 so that an id is never 0, generation limited to 31 bits so that a (long) cast stays positive
+  return (((timer_wheel_id_t)(entry->generation & 0x7FFFFFFF)) << 32) | ((timer_wheel_id_t)entry->index + 1);
+}
+
+//------------------------------------------------------------------------------
+static inline timer_wheel_entry_t *timer_wheel_id_to_entry(const timer_wheel_t * const tw, const timer_wheel_id_t id)
+{
+  uint32_t index = (uint32_t)(id & 0xFFFFFFFF);
+
+  if ((0 == index) || (index > tw->num_entries)) {
+    return NULL;
+  }
+  index -= 1;
+  return &tw->chunks[index / TIMER_WHEEL_ENTRIES_PER_CHUNK][index % TIMER_WHEEL_ENTRIES_PER_CHUNK];
+}
+
+//------------------------------------------------------------------------------
+static bool timer_wheel_grow(timer_wheel_t * const tw)
+{
+  timer_wheel_entry_t  **chunks = NULL;
+  timer_wheel_entry_t   *chunk  = NULL;
+
+  if (tw->num_entries > (UINT32_MAX - 1 - TIMER_WHEEL_ENTRIES_PER_CHUNK)) {
+    return false;
+  }
+  chunks = realloc(tw->chunks, (tw->num_chunks + 1) * sizeof(timer_wheel_entry_t *));
+  if (!chunks) {
+    return false;
+  }
+  tw->chunks = chunks;
+  chunk = calloc(TIMER_WHEEL_ENTRIES_PER_CHUNK, sizeof(timer_wheel_entry_t));
+  if (!chunk) {
+    return false;
+  }
+  tw->chunks[tw->num_chunks++] = chunk;
+  // chain in reverse order so that lower indexes are reused first
+  for (int i = TIMER_WHEEL_ENTRIES_PER_CHUNK - 1; i >= 0; i--) {
+    chunk[i].index = tw->num_entries + i;
+    chunk[i].next  = tw->free_list;
+    tw->free_list  = &chunk[i];
+  }
+  tw->num_entries += TIMER_WHEEL_ENTRIES_PER_CHUNK;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static inline void timer_wheel_link(timer_wheel_t * const tw, timer_wheel_entry_t * const entry)
+{
+  timer_wheel_entry_t **head  = NULL;
+  uint64_t              delta = 0;
+
+  if (entry->expires < tw->current_tick) {
+    entry->expires = tw->current_tick;
+  }
+  delta = entry->expires - tw->current_tick;
+
+  if (delta < (UINT64_C(1) << TIMER_WHEEL_SLOT_BITS)) {
+    head = &tw->slots[0][TIMER_WHEEL_LEVEL_INDEX(entry->expires, 0)];
+  } else if (delta < (UINT64_C(1) << (2 * TIMER_WHEEL_SLOT_BITS))) {
+    head = &tw->slots[1][TIMER_WHEEL_LEVEL_INDEX(entry->expires, 1)];
+  } else if (delta < (UINT64_C(1) << (3 * TIMER_WHEEL_SLOT_BITS))) {
+    head = &tw->slots[2][TIMER_WHEEL_LEVEL_INDEX(entry->expires, 2)];
+  } else {
+    if (delta > TIMER_WHEEL_MAX_DELAY_TICKS) {
+      entry->expires = tw->current_tick + TIMER_WHEEL_MAX_DELAY_TICKS;
+    }
+    head = &tw->slots[3][TIMER_WHEEL_LEVEL_INDEX(entry->expires, 3)];
+  }
+  entry->next = *head;
+  if (entry->next) {
+    entry->next->pprev = &entry->next;
+  }
+  entry->pprev = head;
+  *head = entry;
+}
+
+//------------------------------------------------------------------------------
+static inline void timer_wheel_unlink(timer_wheel_entry_t * const entry)
+{
+  *entry->pprev = entry->next;
+  if (entry->next) {
+    entry->next->pprev = entry->pprev;
+  }
+  entry->next  = NULL;
+  entry->pprev = NULL;
+}
+
+//------------------------------------------------------------------------------
+static inline void timer_wheel_release(timer_wheel_t * const tw, timer_wheel_entry_t * const entry)
+{
+  entry->armed = false;
+  entry->generation += 1;
+  entry->arg = NULL;
+  entry->next = tw->free_list;
+  tw->free_list = entry;
+  tw->num_armed -= 1;
+}
+
+//------------------------------------------------------------------------------
+// Move all the timers of a slot of an upper level to lower levels, return the slot index.
+static inline uint32_t timer_wheel_cascade(timer_wheel_t * const tw, const int level)
+{
+  uint32_t              index = TIMER_WHEEL_LEVEL_INDEX(tw->current_tick, level);
+  timer_wheel_entry_t  *entry = tw->slots[level][index];
+
+  tw->slots[level][index] = NULL;
+  while (entry) {
+    timer_wheel_entry_t *next = entry->next;
+
+    timer_wheel_link(tw, entry);
+    entry = next;
+  }
+  return index;
+}
+
+//------------------------------------------------------------------------------
+int timer_wheel_init(timer_wheel_t * const tw)
+{
+  memset(tw, 0, sizeof(*tw));
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void timer_wheel_destroy(timer_wheel_t * const tw)
+{
+  for (uint32_t i = 0; i < tw->num_chunks; i++) {
+    free_wrapper((void**)&tw->chunks[i]);
+  }
+  if (tw->chunks) {
+    free_wrapper((void**)&tw->chunks);
+  }
+  memset(tw, 0, sizeof(*tw));
+}
+
+//------------------------------------------------------------------------------
+timer_wheel_id_t timer_wheel_arm(timer_wheel_t * const tw, uint64_t delay_ticks, uint64_t period_ticks, uint64_t user_data, void *arg)
+{
+  timer_wheel_entry_t *entry = NULL;
+
+  if ((!tw->free_list) && (!timer_wheel_grow(tw))) {
+    return TIMER_WHEEL_INVALID_ID;
+  }
+  entry = tw->free_list;
+  tw->free_list = entry->next;
+
+  entry->expires   = tw->current_tick + delay_ticks;
+  entry->period    = period_ticks;
+  entry->user_data = user_data;
+  entry->arg       = arg;
+  entry->armed     = true;
+  timer_wheel_link(tw, entry);
+  tw->num_armed += 1;
+  return timer_wheel_entry_id(entry);
+}
+
+//------------------------------------------------------------------------------
+int timer_wheel_cancel(timer_wheel_t * const tw, const timer_wheel_id_t id, void **arg)
+{
+  timer_wheel_entry_t *entry = timer_wheel_id_to_entry(tw, id);
+
+  if ((!entry) || (!entry->armed) || (timer_wheel_entry_id(entry) != id)) {
+    if (arg) *arg = NULL;
+    return -1;
+  }
+  if (arg) *arg = entry->arg;
+  timer_wheel_unlink(entry);
+  timer_wheel_release(tw, entry);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+uint32_t timer_wheel_advance(timer_wheel_t * const tw, uint64_t ticks, timer_wheel_expiry_cb_t expiry_cb, void *cb_arg)
+{
+  uint32_t num_expired = 0;
+
+  while (ticks--) {
+    uint32_t             index = TIMER_WHEEL_LEVEL_INDEX(tw->current_tick, 0);
+    timer_wheel_entry_t *entry = NULL;
+
+    if (0 == tw->num_armed) {
+      // nothing to cascade or expire, just skip the remaining ticks
+      tw->current_tick += ticks + 1;
+      break;
+    }
+    if ((0 == index) && (0 == timer_wheel_cascade(tw, 1)) && (0 == timer_wheel_cascade(tw, 2))) {
+      timer_wheel_cascade(tw, 3);
+    }
+
+    entry = tw->slots[0][index];
+    tw->slots[0][index] = NULL;
+    tw->current_tick += 1;
+
+    while (entry) {
+      timer_wheel_entry_t *next      = entry->next;
+      timer_wheel_id_t     id        = timer_wheel_entry_id(entry);
+      uint64_t             user_data = entry->user_data;
+      void                *arg       = entry->arg;
+
+      entry->next  = NULL;
+      entry->pprev = NULL;
+      if (entry->period) {
+        entry->expires += entry->period;
+        timer_wheel_link(tw, entry);
+      } else {
+        timer_wheel_release(tw, entry);
+      }
+      num_expired += 1;
+      if (expiry_cb) {
+        expiry_cb(id, user_data, arg, cb_arg);
+      }
+      entry = next;
+    }
+  }
+  return num_expired;
+}
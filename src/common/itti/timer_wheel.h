@@ -0,0 +1,82 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file timer_wheel.h
+  \brief Hierarchical timing wheel used by the ITTI timer service.
+         The wheel itself is not thread safe, callers serialize access.
+*/
+
+#ifndef FILE_TIMER_WHEEL_SEEN
+#define FILE_TIMER_WHEEL_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMER_WHEEL_LEVELS              4
+#define TIMER_WHEEL_SLOT_BITS           8
+#define TIMER_WHEEL_SLOTS               (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK           (TIMER_WHEEL_SLOTS - 1)
+// Longest delay that can be represented without clamping, in ticks
+#define TIMER_WHEEL_MAX_DELAY_TICKS     ((UINT64_C(1) << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1)
+// Entries are allocated by chunks, so that their address never changes
+#define TIMER_WHEEL_ENTRIES_PER_CHUNK   4096
+
+typedef uint64_t timer_wheel_id_t;
+
+#define TIMER_WHEEL_INVALID_ID          ((timer_wheel_id_t)0)
+
+typedef struct timer_wheel_entry_s {
+  struct timer_wheel_entry_s             *next;
+  struct timer_wheel_entry_s            **pprev;       ///< Address of the pointer referencing this entry (slot head or previous entry)
+  uint64_t                                expires;     ///< Absolute expiry tick
+  uint64_t                                period;      ///< Re-arm period in ticks, 0 for one shot timers
+  uint64_t                                user_data;   ///< Opaque value given back on expiry
+  void                                   *arg;         ///< Opaque pointer given back on expiry or cancel
+  uint32_t                                index;       ///< Index of this entry in the wheel storage
+  uint32_t                                generation;  ///< Incremented each time the entry is released
+  bool                                    armed;
+} timer_wheel_entry_t;
+
+typedef struct timer_wheel_s {
+  struct timer_wheel_entry_s             *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+  uint64_t                                current_tick; ///< Next tick to be processed
+  uint32_t                                num_armed;
+  uint32_t                                num_entries;  ///< Number of entries allocated in chunks
+  uint32_t                                num_chunks;
+  struct timer_wheel_entry_s            **chunks;
+  struct timer_wheel_entry_s             *free_list;
+} timer_wheel_t;
+
+/*
+ * Called for each expired timer during timer_wheel_advance(), periodic timers are already re-armed
+ * when the callback is invoked, one shot timers are already released (id no longer valid).
+ */
+typedef void (*timer_wheel_expiry_cb_t)(timer_wheel_id_t id, uint64_t user_data, void *arg, void *cb_arg);
+
+int              timer_wheel_init    (timer_wheel_t * const tw);
+void             timer_wheel_destroy (timer_wheel_t * const tw);
+timer_wheel_id_t timer_wheel_arm     (timer_wheel_t * const tw, uint64_t delay_ticks, uint64_t period_ticks, uint64_t user_data, void *arg);
+int              timer_wheel_cancel  (timer_wheel_t * const tw, const timer_wheel_id_t id, void **arg);
+uint32_t         timer_wheel_advance (timer_wheel_t * const tw, uint64_t ticks, timer_wheel_expiry_cb_t expiry_cb, void *cb_arg);
+
+static inline uint32_t timer_wheel_num_armed(const timer_wheel_t * const tw) {return tw->num_armed;}
+
+#endif /* FILE_TIMER_WHEEL_SEEN */
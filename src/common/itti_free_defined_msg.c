@@ -47,6 +47,7 @@
 #include "common_defs.h"
 #include "intertask_interface.h"
 #include "itti_free_defined_msg.h"
+#include "udp_buffer_pool.h"
 
 //------------------------------------------------------------------------------
 void itti_free_msg_content (MessageDef * const message_p)
@@ -331,6 +332,14 @@ void itti_free_msg_content (MessageDef * const message_p)
     AssertFatal(NULL == message_p->ittiMsg.sctp_data_req.payload, "TODO clean pointer");
     break;
 
+  case SCTP_DATA_REQ_BATCH:
+    for (int i = 0; i < message_p->ittiMsg.sctp_data_req_batch.nb_payloads; i++) {
+      bdestroy_wrapper (&message_p->ittiMsg.sctp_data_req_batch.payloads[i]);
+    }
+    message_p->ittiMsg.sctp_data_req_batch.nb_payloads = 0;
+    free_wrapper ((void**)&message_p->ittiMsg.sctp_data_req_batch.assoc_ids);
+    break;
+
   case SCTP_DATA_IND:
     bdestroy_wrapper (&message_p->ittiMsg.sctp_data_ind.payload);
     AssertFatal(NULL == message_p->ittiMsg.sctp_data_ind.payload, "TODO clean pointer");
@@ -344,10 +353,13 @@ void itti_free_msg_content (MessageDef * const message_p)
 
   case UDP_INIT:
   case UDP_DATA_REQ:
-  case UDP_DATA_IND:
-    // TODO
+    // DO nothing (buffer owned by the GTPv2-C stack)
    break;
 
+  case UDP_DATA_IND:
+    udp_buffer_free (&message_p->ittiMsg.udp_data_ind.buffer);
+    break;
+
   case S1AP_PATH_SWITCH_REQUEST_ACKNOWLEDGE:
     /** Bearer Contexts to be switched. */
     if(message_p->ittiMsg.s1ap_path_switch_request_ack.bearer_ctx_to_be_switched_list){
@@ -444,15 +444,19 @@ typedef struct itti_s1ap_handover_notify_s {
 
 } itti_s1ap_handover_notify_t;
 
+#define S1AP_PAGING_MAX_TAI 16
+
 typedef struct itti_s1ap_paging_s {
   mme_ue_s1ap_id_t        mme_ue_s1ap_id;
-  sctp_assoc_id_t         sctp_assoc_id_key; // link with eNB id
+  sctp_assoc_id_t         sctp_assoc_id_key; // link with eNB id, used if no eNB serves the TAI list
 
   uint16_t                ue_identity_index;
   tmsi_t                  tmsi;
 
   tai_t                   tai;               /* Indicating the Tracking Area from which the UE has sent the NAS message.                         */
 
+  uint8_t                 nb_tai;            /* TAI list of the UE, the UE is paged by every eNB serving one of these TAIs, tai if empty.   */
+  tai_t                   tai_list[S1AP_PAGING_MAX_TAI];
 } itti_s1ap_paging_t;
 
 #endif /* FILE_S1AP_MESSAGES_TYPES_SEEN */
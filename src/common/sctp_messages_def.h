@@ -30,6 +30,7 @@
 
 MESSAGE_DEF(SCTP_INIT_MSG,          MESSAGE_PRIORITY_MED, SctpInit,                 sctpInit)
 MESSAGE_DEF(SCTP_DATA_REQ,          MESSAGE_PRIORITY_MED, sctp_data_req_t,          sctp_data_req)
+MESSAGE_DEF(SCTP_DATA_REQ_BATCH,    MESSAGE_PRIORITY_MED, sctp_data_req_batch_t,    sctp_data_req_batch)
 MESSAGE_DEF(SCTP_DATA_IND,          MESSAGE_PRIORITY_MED, sctp_data_ind_t,          sctp_data_ind)
 MESSAGE_DEF(SCTP_DATA_CNF,          MESSAGE_PRIORITY_MED, sctp_data_cnf_t,          sctp_data_cnf)
 MESSAGE_DEF(SCTP_NEW_ASSOCIATION,   MESSAGE_PRIORITY_MAX, sctp_new_peer_t,          sctp_new_peer)
@@ -31,11 +31,14 @@
 
 #define SCTP_DATA_IND(mSGpTR)           (mSGpTR)->ittiMsg.sctp_data_ind
 #define SCTP_DATA_REQ(mSGpTR)           (mSGpTR)->ittiMsg.sctp_data_req
+#define SCTP_DATA_REQ_BATCH(mSGpTR)     (mSGpTR)->ittiMsg.sctp_data_req_batch
 #define SCTP_DATA_CNF(mSGpTR)           (mSGpTR)->ittiMsg.sctp_data_cnf
 #define SCTP_INIT_MSG(mSGpTR)           (mSGpTR)->ittiMsg.sctpInit
 #define SCTP_NEW_ASSOCIATION(mSGpTR)    (mSGpTR)->ittiMsg.sctp_new_peer
 #define SCTP_CLOSE_ASSOCIATION(mSGpTR)  (mSGpTR)->ittiMsg.sctp_close_association
 
+#define SCTP_DATA_REQ_BATCH_MAX         (32) ///< payloads of a SCTP_DATA_REQ_BATCH message
+
 
 //typedef struct sctp_data_rej_s {
 //  sctp_assoc_id_t  assoc_id;
@@ -57,6 +60,15 @@ typedef struct sctp_data_req_s {
   uint32_t         mme_ue_s1ap_id; // for helping data_rej
 } sctp_data_req_t;
 
+// Non UE associated payloads sent in order to each association of a list, in one ITTI message.
+typedef struct sctp_data_req_batch_s {
+  bstring          payloads[SCTP_DATA_REQ_BATCH_MAX];
+  uint16_t         nb_payloads;
+  sctp_stream_id_t stream;
+  uint32_t         nb_assoc_ids;
+  sctp_assoc_id_t *assoc_ids;                 ///< allocated, freed with the message
+} sctp_data_req_batch_t;
+
 typedef struct sctp_data_ind_s {
   bstring            payload;          ///< SCTP buffer
   sctp_assoc_id_t    assoc_id;         ///< SCTP physical association ID
@@ -0,0 +1,693 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtp_nft_marking.c
+  \brief Packet marking for the bearers of the GTP kernel device, programmed in process through nftables netlink
+         batches instead of iptables commands.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netfilter/nf_tables.h>
+
+#include "log.h"
+#include "common_defs.h"
+#include "gtp_nft_marking.h"
+
+#define GTP_NFT_BUFFER_SIZE        8192
+#define GTP_NFT_RCVBUF_SIZE        (1 << 20)
+#define GTP_NFT_ACK_TIMEOUT_SEC    2          // kernel reply, a batch the kernel dropped is never acknowledged
+#define GTP_NFT_MANGLE_PRIORITY    (-150)     // NF_IP_PRI_MANGLE
+#define GTP_NFT_BEARER_MAP_ID      1
+#define GTP_NFT_IP_TOS_OFFSET      1
+#define GTP_NFT_IP_PROTOCOL_OFFSET 9
+#define GTP_NFT_IP_SADDR_OFFSET    12
+#define GTP_NFT_IP_DADDR_OFFSET    16
+// nft datatypes, for the listing of the map only
+#define GTP_NFT_TYPE_IPADDR        7
+#define GTP_NFT_TYPE_MARK          19
+#define GTP_NFT_TYPE_BITS          6
+
+static const char * const gtp_nft_chain_name[] = {"postrouting", "output"};
+
+typedef struct gtp_nft_msg_buffer_s {
+  uint8_t                         data[GTP_NFT_BUFFER_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+  size_t                          len;
+  uint32_t                        begin_seq;  // sequence number of NFNL_MSG_BATCH_BEGIN, acknowledged alone if the whole batch is rejected
+  uint32_t                        last_seq;   // sequence number of the last message, the one to be acknowledged
+} gtp_nft_msg_buffer_t;
+
+static struct {
+  pthread_mutex_t                 mutex;
+  int                             sd;
+  uint32_t                        portid;
+  uint32_t                        seq;
+  char                            gtp_devname[IFNAMSIZ];
+  gtp_nft_msg_buffer_t            buffer;
+} gtp_nft = {.mutex = PTHREAD_MUTEX_INITIALIZER, .sd = -1};
+
+//------------------------------------------------------------------------------
+// Netlink message building
+//------------------------------------------------------------------------------
+static void *gtp_nft_put (gtp_nft_msg_buffer_t * const b, const size_t len)
+{
+  void                                   *p = &b->data[b->len];
+
+  memset (p, 0, NLMSG_ALIGN (len));
+  b->len += NLMSG_ALIGN (len);
+  return p;
+}
+
+//------------------------------------------------------------------------------
+static struct nlmsghdr *gtp_nft_msg_begin (gtp_nft_msg_buffer_t * const b, const uint16_t type, const uint16_t flags, const uint8_t family, const uint16_t res_id)
+{
+  struct nlmsghdr                        *nlh = gtp_nft_put (b, NLMSG_HDRLEN);
+  struct nfgenmsg                        *nfg = gtp_nft_put (b, sizeof (struct nfgenmsg));
+
+  nlh->nlmsg_type = type;
+  nlh->nlmsg_flags = NLM_F_REQUEST | flags;
+  nlh->nlmsg_seq = ++gtp_nft.seq;
+  nfg->nfgen_family = family;
+  nfg->version = NFNETLINK_V0;
+  nfg->res_id = htons (res_id);
+  b->last_seq = nlh->nlmsg_seq;
+  return nlh;
+}
+
+//------------------------------------------------------------------------------
+static inline void gtp_nft_msg_end (const gtp_nft_msg_buffer_t * const b, struct nlmsghdr * const nlh)
+{
+  nlh->nlmsg_len = (uint32_t)((const uint8_t *)&b->data[b->len] - (const uint8_t *)nlh);
+}
+
+//------------------------------------------------------------------------------
+static struct nlmsghdr *gtp_nft_nft_msg_begin (gtp_nft_msg_buffer_t * const b, const uint16_t nft_msg, const uint16_t flags)
+{
+  return gtp_nft_msg_begin (b, (NFNL_SUBSYS_NFTABLES << 8) | nft_msg, flags, NFPROTO_IPV4, 0);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_attr_put (gtp_nft_msg_buffer_t * const b, const uint16_t type, const void * const data, const size_t len)
+{
+  struct nlattr                          *nla = gtp_nft_put (b, NLA_HDRLEN + len);
+
+  nla->nla_type = type;
+  nla->nla_len = (uint16_t)(NLA_HDRLEN + len);
+  memcpy ((uint8_t *)nla + NLA_HDRLEN, data, len);
+}
+
+//------------------------------------------------------------------------------
+static inline void gtp_nft_attr_put_u32 (gtp_nft_msg_buffer_t * const b, const uint16_t type, const uint32_t value)
+{
+  const uint32_t                          be = htonl (value);
+
+  gtp_nft_attr_put (b, type, &be, sizeof (be));
+}
+
+//------------------------------------------------------------------------------
+static inline void gtp_nft_attr_put_str (gtp_nft_msg_buffer_t * const b, const uint16_t type, const char * const str)
+{
+  gtp_nft_attr_put (b, type, str, strlen (str) + 1);
+}
+
+//------------------------------------------------------------------------------
+static inline struct nlattr *gtp_nft_nest_begin (gtp_nft_msg_buffer_t * const b, const uint16_t type)
+{
+  struct nlattr                          *nla = gtp_nft_put (b, NLA_HDRLEN);
+
+  nla->nla_type = NLA_F_NESTED | type;
+  return nla;
+}
+
+//------------------------------------------------------------------------------
+static inline void gtp_nft_nest_end (const gtp_nft_msg_buffer_t * const b, struct nlattr * const nla)
+{
+  nla->nla_len = (uint16_t)((const uint8_t *)&b->data[b->len] - (const uint8_t *)nla);
+}
+
+//------------------------------------------------------------------------------
+// NFTA_DATA_VALUE nested in type
+static void gtp_nft_data_put (gtp_nft_msg_buffer_t * const b, const uint16_t type, const void * const data, const size_t len)
+{
+  struct nlattr                          *nest = gtp_nft_nest_begin (b, type);
+
+  gtp_nft_attr_put (b, NFTA_DATA_VALUE, data, len);
+  gtp_nft_nest_end (b, nest);
+}
+
+//------------------------------------------------------------------------------
+// Expressions, in a NFTA_RULE_EXPRESSIONS nest
+//------------------------------------------------------------------------------
+static struct nlattr *gtp_nft_expr_begin (gtp_nft_msg_buffer_t * const b, const char * const name, struct nlattr ** const data)
+{
+  struct nlattr                          *elem = gtp_nft_nest_begin (b, NFTA_LIST_ELEM);
+
+  gtp_nft_attr_put_str (b, NFTA_EXPR_NAME, name);
+  *data = gtp_nft_nest_begin (b, NFTA_EXPR_DATA);
+  return elem;
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_end (gtp_nft_msg_buffer_t * const b, struct nlattr * const elem, struct nlattr * const data)
+{
+  gtp_nft_nest_end (b, data);
+  gtp_nft_nest_end (b, elem);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_payload (gtp_nft_msg_buffer_t * const b, const uint32_t dreg, const uint32_t base, const uint32_t offset, const uint32_t len)
+{
+  struct nlattr                          *data = NULL;
+  struct nlattr                          *elem = gtp_nft_expr_begin (b, "payload", &data);
+
+  gtp_nft_attr_put_u32 (b, NFTA_PAYLOAD_DREG, dreg);
+  gtp_nft_attr_put_u32 (b, NFTA_PAYLOAD_BASE, base);
+  gtp_nft_attr_put_u32 (b, NFTA_PAYLOAD_OFFSET, offset);
+  gtp_nft_attr_put_u32 (b, NFTA_PAYLOAD_LEN, len);
+  gtp_nft_expr_end (b, elem, data);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_meta_load (gtp_nft_msg_buffer_t * const b, const uint32_t dreg, const uint32_t key)
+{
+  struct nlattr                          *data = NULL;
+  struct nlattr                          *elem = gtp_nft_expr_begin (b, "meta", &data);
+
+  gtp_nft_attr_put_u32 (b, NFTA_META_DREG, dreg);
+  gtp_nft_attr_put_u32 (b, NFTA_META_KEY, key);
+  gtp_nft_expr_end (b, elem, data);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_meta_set (gtp_nft_msg_buffer_t * const b, const uint32_t sreg, const uint32_t key)
+{
+  struct nlattr                          *data = NULL;
+  struct nlattr                          *elem = gtp_nft_expr_begin (b, "meta", &data);
+
+  gtp_nft_attr_put_u32 (b, NFTA_META_KEY, key);
+  gtp_nft_attr_put_u32 (b, NFTA_META_SREG, sreg);
+  gtp_nft_expr_end (b, elem, data);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_cmp (gtp_nft_msg_buffer_t * const b, const uint32_t sreg, const uint32_t op, const void * const value, const size_t len)
+{
+  struct nlattr                          *data = NULL;
+  struct nlattr                          *elem = gtp_nft_expr_begin (b, "cmp", &data);
+
+  gtp_nft_attr_put_u32 (b, NFTA_CMP_SREG, sreg);
+  gtp_nft_attr_put_u32 (b, NFTA_CMP_OP, op);
+  gtp_nft_data_put (b, NFTA_CMP_DATA, value, len);
+  gtp_nft_expr_end (b, elem, data);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_bitwise (gtp_nft_msg_buffer_t * const b, const uint32_t reg, const void * const mask, const size_t len)
+{
+  struct nlattr                          *data = NULL;
+  struct nlattr                          *elem = gtp_nft_expr_begin (b, "bitwise", &data);
+  const uint8_t                           xor[16] = {0};
+
+  gtp_nft_attr_put_u32 (b, NFTA_BITWISE_SREG, reg);
+  gtp_nft_attr_put_u32 (b, NFTA_BITWISE_DREG, reg);
+  gtp_nft_attr_put_u32 (b, NFTA_BITWISE_LEN, (uint32_t)len);
+  gtp_nft_data_put (b, NFTA_BITWISE_MASK, mask, len);
+  gtp_nft_data_put (b, NFTA_BITWISE_XOR, xor, len);
+  gtp_nft_expr_end (b, elem, data);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_immediate (gtp_nft_msg_buffer_t * const b, const uint32_t dreg, const void * const value, const size_t len)
+{
+  struct nlattr                          *data = NULL;
+  struct nlattr                          *elem = gtp_nft_expr_begin (b, "immediate", &data);
+
+  gtp_nft_attr_put_u32 (b, NFTA_IMMEDIATE_DREG, dreg);
+  gtp_nft_data_put (b, NFTA_IMMEDIATE_DATA, value, len);
+  gtp_nft_expr_end (b, elem, data);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_expr_lookup (gtp_nft_msg_buffer_t * const b, const char * const set, const uint32_t set_id, const uint32_t sreg, const uint32_t dreg)
+{
+  struct nlattr                          *data = NULL;
+  struct nlattr                          *elem = gtp_nft_expr_begin (b, "lookup", &data);
+
+  gtp_nft_attr_put_str (b, NFTA_LOOKUP_SET, set);
+  gtp_nft_attr_put_u32 (b, NFTA_LOOKUP_SET_ID, set_id);
+  gtp_nft_attr_put_u32 (b, NFTA_LOOKUP_SREG, sreg);
+  gtp_nft_attr_put_u32 (b, NFTA_LOOKUP_DREG, dreg);
+  gtp_nft_expr_end (b, elem, data);
+}
+
+//------------------------------------------------------------------------------
+// Transactions
+//------------------------------------------------------------------------------
+static inline void gtp_nft_batch_begin (gtp_nft_msg_buffer_t * const b)
+{
+  b->len = 0;
+  gtp_nft_msg_end (b, gtp_nft_msg_begin (b, NFNL_MSG_BATCH_BEGIN, 0, AF_UNSPEC, NFNL_SUBSYS_NFTABLES));
+  b->begin_seq = b->last_seq;
+}
+
+//------------------------------------------------------------------------------
+static inline void gtp_nft_batch_end (gtp_nft_msg_buffer_t * const b)
+{
+  const uint32_t                          last_seq = b->last_seq;
+
+  gtp_nft_msg_end (b, gtp_nft_msg_begin (b, NFNL_MSG_BATCH_END, 0, AF_UNSPEC, NFNL_SUBSYS_NFTABLES));
+  b->last_seq = last_seq;
+}
+
+//------------------------------------------------------------------------------
+// Sends the batch, the last message of the batch must request an ack. Returns 0 or the first error (-errno) reported by
+// the kernel, in which case the whole transaction was aborted. If the kernel rejects the batch as a whole (nf_tables not
+// available, no memory) only NFNL_MSG_BATCH_BEGIN is acknowledged, with the error. -ETIMEDOUT if no ack came in time.
+static int gtp_nft_batch_send (gtp_nft_msg_buffer_t * const b)
+{
+  uint8_t                                 rbuf[GTP_NFT_BUFFER_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+  struct sockaddr_nl                      kernel = {.nl_family = AF_NETLINK};
+  int                                     error = 0;
+
+  if (sendto (gtp_nft.sd, b->data, b->len, 0, (struct sockaddr *)&kernel, sizeof (kernel)) < 0) {
+    return -errno;
+  }
+  while (1) {
+    ssize_t                                 len = recv (gtp_nft.sd, rbuf, sizeof (rbuf), 0);
+    struct nlmsghdr                        *nlh = (struct nlmsghdr *)rbuf;
+
+    if (len < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      return ((EAGAIN == errno) || (EWOULDBLOCK == errno)) ? -ETIMEDOUT : -errno;
+    }
+    for (; NLMSG_OK (nlh, (size_t)len); nlh = NLMSG_NEXT (nlh, len)) {
+      if ((nlh->nlmsg_pid != gtp_nft.portid) || (NLMSG_ERROR != nlh->nlmsg_type)) {
+        continue;
+      }
+      // late acks of a former batch that timed out (unsigned differences, the sequence numbers wrap)
+      if ((uint32_t)(nlh->nlmsg_seq - b->begin_seq) > (uint32_t)(b->last_seq - b->begin_seq)) {
+        continue;
+      }
+      const struct nlmsgerr                  *err = (const struct nlmsgerr *)NLMSG_DATA (nlh);
+
+      if ((err->error) && (nlh->nlmsg_seq == b->begin_seq)) {
+        return err->error;
+      }
+      if ((err->error) && (!error)) {
+        error = err->error;
+      }
+      if (nlh->nlmsg_seq == b->last_seq) {
+        return error;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_put_bearer_elem (gtp_nft_msg_buffer_t * const b, const uint16_t nft_msg, const uint16_t flags,
+                                     const struct in_addr ue, const uint32_t sdf_mark, const uint32_t * const bearer_mark)
+{
+  struct nlmsghdr                        *nlh = gtp_nft_nft_msg_begin (b, nft_msg, flags);
+  struct nlattr                          *elems = NULL;
+  struct nlattr                          *elem = NULL;
+  uint8_t                                 key[8];
+
+  // concatenation: ip daddr (network order) . meta mark (host order), each field on a 32 bit register
+  memcpy (&key[0], &ue.s_addr, 4);
+  memcpy (&key[4], &sdf_mark, 4);
+  gtp_nft_attr_put_str (b, NFTA_SET_ELEM_LIST_TABLE, GTP_NFT_TABLE);
+  gtp_nft_attr_put_str (b, NFTA_SET_ELEM_LIST_SET, GTP_NFT_BEARER_MAP);
+  elems = gtp_nft_nest_begin (b, NFTA_SET_ELEM_LIST_ELEMENTS);
+  elem = gtp_nft_nest_begin (b, NFTA_LIST_ELEM);
+  gtp_nft_data_put (b, NFTA_SET_ELEM_KEY, key, sizeof (key));
+  if (bearer_mark) {
+    gtp_nft_data_put (b, NFTA_SET_ELEM_DATA, bearer_mark, sizeof (*bearer_mark));
+  }
+  gtp_nft_nest_end (b, elem);
+  gtp_nft_nest_end (b, elems);
+  gtp_nft_msg_end (b, nlh);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nft_put_chain (gtp_nft_msg_buffer_t * const b, const char * const name, const char * const type, const uint32_t hooknum)
+{
+  struct nlmsghdr                        *nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_NEWCHAIN, NLM_F_CREATE);
+  struct nlattr                          *hook = NULL;
+
+  gtp_nft_attr_put_str (b, NFTA_CHAIN_TABLE, GTP_NFT_TABLE);
+  gtp_nft_attr_put_str (b, NFTA_CHAIN_NAME, name);
+  hook = gtp_nft_nest_begin (b, NFTA_CHAIN_HOOK);
+  gtp_nft_attr_put_u32 (b, NFTA_HOOK_HOOKNUM, hooknum);
+  gtp_nft_attr_put_u32 (b, NFTA_HOOK_PRIORITY, (uint32_t)GTP_NFT_MANGLE_PRIORITY);
+  gtp_nft_nest_end (b, hook);
+  gtp_nft_attr_put_str (b, NFTA_CHAIN_TYPE, type);
+  gtp_nft_msg_end (b, nlh);
+}
+
+//------------------------------------------------------------------------------
+int gtp_nft_marking_init (const char * const gtp_devname)
+{
+  gtp_nft_msg_buffer_t                   *b = &gtp_nft.buffer;
+  struct sockaddr_nl                      local = {.nl_family = AF_NETLINK};
+  socklen_t                               addrlen = sizeof (local);
+  int                                     rcvbuf = GTP_NFT_RCVBUF_SIZE;
+  struct timeval                          rcvtimeo = {.tv_sec = GTP_NFT_ACK_TIMEOUT_SEC, .tv_usec = 0};
+  struct nlmsghdr                        *nlh = NULL;
+  struct nlattr                          *exprs = NULL;
+  char                                    ifname[IFNAMSIZ] = {0};
+  int                                     rc = 0;
+
+  pthread_mutex_lock (&gtp_nft.mutex);
+  if (gtp_nft.sd < 0) {
+    if ((gtp_nft.sd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_NETFILTER)) < 0) {
+      OAILOG_ERROR (LOG_GTPV1U, "Cannot open nftables netlink socket: %s\n", strerror (errno));
+      pthread_mutex_unlock (&gtp_nft.mutex);
+      return RETURNerror;
+    }
+    setsockopt (gtp_nft.sd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof (rcvbuf));
+    // no recv() may block the caller for good, the kernel does not ack a batch it dropped
+    setsockopt (gtp_nft.sd, SOL_SOCKET, SO_RCVTIMEO, &rcvtimeo, sizeof (rcvtimeo));
+    if ((bind (gtp_nft.sd, (struct sockaddr *)&local, sizeof (local)) < 0) ||
+        (getsockname (gtp_nft.sd, (struct sockaddr *)&local, &addrlen) < 0)) {
+      OAILOG_ERROR (LOG_GTPV1U, "Cannot bind nftables netlink socket: %s\n", strerror (errno));
+      close (gtp_nft.sd);
+      gtp_nft.sd = -1;
+      pthread_mutex_unlock (&gtp_nft.mutex);
+      return RETURNerror;
+    }
+    gtp_nft.portid = local.nl_pid;
+  }
+  strncpy (gtp_nft.gtp_devname, gtp_devname, IFNAMSIZ - 1);
+  strncpy (ifname, gtp_devname, IFNAMSIZ - 1);
+
+  gtp_nft_batch_begin (b);
+  // add then delete the table so that the transaction starts from scratch whether the table existed or not
+  nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_NEWTABLE, NLM_F_CREATE);
+  gtp_nft_attr_put_str (b, NFTA_TABLE_NAME, GTP_NFT_TABLE);
+  gtp_nft_msg_end (b, nlh);
+  nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_DELTABLE, 0);
+  gtp_nft_attr_put_str (b, NFTA_TABLE_NAME, GTP_NFT_TABLE);
+  gtp_nft_msg_end (b, nlh);
+  nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_NEWTABLE, NLM_F_CREATE | NLM_F_EXCL);
+  gtp_nft_attr_put_str (b, NFTA_TABLE_NAME, GTP_NFT_TABLE);
+  gtp_nft_msg_end (b, nlh);
+
+  // same hooks as the former iptables mangle POSTROUTING and OUTPUT rules
+  gtp_nft_put_chain (b, gtp_nft_chain_name[GTP_NFT_CHAIN_POSTROUTING], "filter", NF_INET_POST_ROUTING);
+  gtp_nft_put_chain (b, gtp_nft_chain_name[GTP_NFT_CHAIN_OUTPUT], "route", NF_INET_LOCAL_OUT);
+
+  nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_NEWSET, NLM_F_CREATE | NLM_F_EXCL);
+  gtp_nft_attr_put_str (b, NFTA_SET_TABLE, GTP_NFT_TABLE);
+  gtp_nft_attr_put_str (b, NFTA_SET_NAME, GTP_NFT_BEARER_MAP);
+  gtp_nft_attr_put_u32 (b, NFTA_SET_FLAGS, NFT_SET_MAP);
+  gtp_nft_attr_put_u32 (b, NFTA_SET_KEY_TYPE, (GTP_NFT_TYPE_IPADDR << GTP_NFT_TYPE_BITS) | GTP_NFT_TYPE_MARK);
+  gtp_nft_attr_put_u32 (b, NFTA_SET_KEY_LEN, 8);
+  gtp_nft_attr_put_u32 (b, NFTA_SET_DATA_TYPE, GTP_NFT_TYPE_MARK);
+  gtp_nft_attr_put_u32 (b, NFTA_SET_DATA_LEN, 4);
+  gtp_nft_attr_put_u32 (b, NFTA_SET_ID, GTP_NFT_BEARER_MAP_ID);
+  gtp_nft_msg_end (b, nlh);
+
+  // oifname <gtp device> meta mark set ip daddr . meta mark map @bearer_marks
+  nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_NEWRULE, NLM_F_CREATE | NLM_F_APPEND | NLM_F_ACK);
+  gtp_nft_attr_put_str (b, NFTA_RULE_TABLE, GTP_NFT_TABLE);
+  gtp_nft_attr_put_str (b, NFTA_RULE_CHAIN, gtp_nft_chain_name[GTP_NFT_CHAIN_POSTROUTING]);
+  exprs = gtp_nft_nest_begin (b, NFTA_RULE_EXPRESSIONS);
+  gtp_nft_expr_meta_load (b, NFT_REG_1, NFT_META_OIFNAME);
+  gtp_nft_expr_cmp (b, NFT_REG_1, NFT_CMP_EQ, ifname, IFNAMSIZ);
+  gtp_nft_expr_payload (b, NFT_REG32_00, NFT_PAYLOAD_NETWORK_HEADER, GTP_NFT_IP_DADDR_OFFSET, 4);
+  gtp_nft_expr_meta_load (b, NFT_REG32_01, NFT_META_MARK);
+  gtp_nft_expr_lookup (b, GTP_NFT_BEARER_MAP, GTP_NFT_BEARER_MAP_ID, NFT_REG32_00, NFT_REG_1);
+  gtp_nft_expr_meta_set (b, NFT_REG_1, NFT_META_MARK);
+  gtp_nft_nest_end (b, exprs);
+  gtp_nft_msg_end (b, nlh);
+  gtp_nft_batch_end (b);
+
+  rc = gtp_nft_batch_send (b);
+  pthread_mutex_unlock (&gtp_nft.mutex);
+  if (rc) {
+    OAILOG_ERROR (LOG_GTPV1U, "Cannot create nftables table %s: %s\n", GTP_NFT_TABLE, strerror (-rc));
+    return RETURNerror;
+  }
+  OAILOG_DEBUG (LOG_GTPV1U, "nftables table %s created, bearer marks on %s\n", GTP_NFT_TABLE, gtp_nft.gtp_devname);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void gtp_nft_marking_exit (void)
+{
+  gtp_nft_msg_buffer_t                   *b = &gtp_nft.buffer;
+  struct nlmsghdr                        *nlh = NULL;
+
+  pthread_mutex_lock (&gtp_nft.mutex);
+  if (gtp_nft.sd >= 0) {
+    gtp_nft_batch_begin (b);
+    nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_DELTABLE, NLM_F_ACK);
+    gtp_nft_attr_put_str (b, NFTA_TABLE_NAME, GTP_NFT_TABLE);
+    gtp_nft_msg_end (b, nlh);
+    gtp_nft_batch_end (b);
+    gtp_nft_batch_send (b);
+    close (gtp_nft.sd);
+    gtp_nft.sd = -1;
+  }
+  pthread_mutex_unlock (&gtp_nft.mutex);
+}
+
+//------------------------------------------------------------------------------
+// payload load into NFT_REG_1 then compare, with an optional mask
+static void gtp_nft_put_match (gtp_nft_msg_buffer_t * const b, const uint32_t base, const uint32_t offset,
+                               const void * const value, const void * const mask, const uint32_t len)
+{
+  gtp_nft_expr_payload (b, NFT_REG_1, base, offset, len);
+  if (mask) {
+    uint8_t                                 masked[4];
+
+    for (uint32_t i = 0; i < len; i++) {
+      masked[i] = ((const uint8_t *)value)[i] & ((const uint8_t *)mask)[i];
+    }
+    gtp_nft_expr_bitwise (b, NFT_REG_1, mask, len);
+    gtp_nft_expr_cmp (b, NFT_REG_1, NFT_CMP_EQ, masked, len);
+  } else {
+    gtp_nft_expr_cmp (b, NFT_REG_1, NFT_CMP_EQ, value, len);
+  }
+}
+
+//------------------------------------------------------------------------------
+int gtp_nft_marking_add_sdf_rule (const gtp_nft_chain_t chain, const gtp_nft_match_t * const match, const uint32_t sdf_mark)
+{
+  gtp_nft_msg_buffer_t                   *b = &gtp_nft.buffer;
+  struct nlmsghdr                        *nlh = NULL;
+  struct nlattr                          *exprs = NULL;
+  int                                     rc = 0;
+
+  pthread_mutex_lock (&gtp_nft.mutex);
+  if (gtp_nft.sd < 0) {
+    pthread_mutex_unlock (&gtp_nft.mutex);
+    return RETURNerror;
+  }
+  gtp_nft_batch_begin (b);
+  // no NLM_F_APPEND: inserted at the head of the chain, before the bearer map rule
+  nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_NEWRULE, NLM_F_CREATE | NLM_F_ACK);
+  gtp_nft_attr_put_str (b, NFTA_RULE_TABLE, GTP_NFT_TABLE);
+  gtp_nft_attr_put_str (b, NFTA_RULE_CHAIN, gtp_nft_chain_name[chain]);
+  exprs = gtp_nft_nest_begin (b, NFTA_RULE_EXPRESSIONS);
+  if (GTP_NFT_MATCH_DADDR & match->flags) {
+    gtp_nft_put_match (b, NFT_PAYLOAD_NETWORK_HEADER, GTP_NFT_IP_DADDR_OFFSET, &match->daddr, &match->daddr_mask, 4);
+  }
+  if (GTP_NFT_MATCH_SADDR & match->flags) {
+    gtp_nft_put_match (b, NFT_PAYLOAD_NETWORK_HEADER, GTP_NFT_IP_SADDR_OFFSET, &match->saddr, &match->saddr_mask, 4);
+  }
+  if (GTP_NFT_MATCH_DADDR_RANGE & match->flags) {
+    // network byte order compares as memcmp does
+    gtp_nft_expr_payload (b, NFT_REG_1, NFT_PAYLOAD_NETWORK_HEADER, GTP_NFT_IP_DADDR_OFFSET, 4);
+    gtp_nft_expr_cmp (b, NFT_REG_1, NFT_CMP_GTE, &match->daddr_low, 4);
+    gtp_nft_expr_cmp (b, NFT_REG_1, NFT_CMP_LTE, &match->daddr_high, 4);
+  }
+  if (GTP_NFT_MATCH_PROTOCOL & match->flags) {
+    gtp_nft_put_match (b, NFT_PAYLOAD_NETWORK_HEADER, GTP_NFT_IP_PROTOCOL_OFFSET, &match->protocol, NULL, 1);
+  }
+  if (GTP_NFT_MATCH_TOS & match->flags) {
+    gtp_nft_put_match (b, NFT_PAYLOAD_NETWORK_HEADER, GTP_NFT_IP_TOS_OFFSET, &match->tos, NULL, 1);
+  }
+  if (GTP_NFT_MATCH_SPORT & match->flags) {
+    const uint16_t                          port = htons (match->sport);
+
+    gtp_nft_put_match (b, NFT_PAYLOAD_TRANSPORT_HEADER, 0, &port, NULL, 2);
+  }
+  if (GTP_NFT_MATCH_DPORT & match->flags) {
+    const uint16_t                          port = htons (match->dport);
+
+    gtp_nft_put_match (b, NFT_PAYLOAD_TRANSPORT_HEADER, 2, &port, NULL, 2);
+  }
+  if (GTP_NFT_MATCH_SPI & match->flags) {
+    const uint32_t                          spi = htonl (match->spi);
+
+    gtp_nft_put_match (b, NFT_PAYLOAD_TRANSPORT_HEADER, 0, &spi, NULL, 4);
+  }
+  gtp_nft_expr_immediate (b, NFT_REG_1, &sdf_mark, sizeof (sdf_mark));
+  gtp_nft_expr_meta_set (b, NFT_REG_1, NFT_META_MARK);
+  gtp_nft_nest_end (b, exprs);
+  gtp_nft_msg_end (b, nlh);
+  gtp_nft_batch_end (b);
+  rc = gtp_nft_batch_send (b);
+  pthread_mutex_unlock (&gtp_nft.mutex);
+  if (rc) {
+    OAILOG_ERROR (LOG_GTPV1U, "Cannot add nftables rule for mark %u in chain %s: %s\n", sdf_mark, gtp_nft_chain_name[chain], strerror (-rc));
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int gtp_nft_marking_add_bearer (const struct in_addr ue, const uint32_t sdf_mark, const uint32_t bearer_mark)
+{
+  gtp_nft_msg_buffer_t                   *b = &gtp_nft.buffer;
+  int                                     rc = 0;
+
+  pthread_mutex_lock (&gtp_nft.mutex);
+  if (gtp_nft.sd < 0) {
+    pthread_mutex_unlock (&gtp_nft.mutex);
+    return RETURNerror;
+  }
+  gtp_nft_batch_begin (b);
+  gtp_nft_put_bearer_elem (b, NFT_MSG_NEWSETELEM, NLM_F_CREATE | NLM_F_ACK, ue, sdf_mark, &bearer_mark);
+  gtp_nft_batch_end (b);
+  rc = gtp_nft_batch_send (b);
+  if ((-EBUSY == rc) || (-EEXIST == rc)) {
+    // the UE IP address was reused while the element with its former bearer was still there
+    gtp_nft_batch_begin (b);
+    gtp_nft_put_bearer_elem (b, NFT_MSG_DELSETELEM, 0, ue, sdf_mark, NULL);
+    gtp_nft_put_bearer_elem (b, NFT_MSG_NEWSETELEM, NLM_F_CREATE | NLM_F_ACK, ue, sdf_mark, &bearer_mark);
+    gtp_nft_batch_end (b);
+    rc = gtp_nft_batch_send (b);
+  }
+  pthread_mutex_unlock (&gtp_nft.mutex);
+  if (rc) {
+    OAILOG_ERROR (LOG_GTPV1U, "Cannot add bearer mark %u for UE %s mark %u: %s\n", bearer_mark, inet_ntoa (ue), sdf_mark, strerror (-rc));
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int gtp_nft_marking_del_bearer (const struct in_addr ue, const uint32_t sdf_mark)
+{
+  gtp_nft_msg_buffer_t                   *b = &gtp_nft.buffer;
+  int                                     rc = 0;
+
+  pthread_mutex_lock (&gtp_nft.mutex);
+  if (gtp_nft.sd < 0) {
+    pthread_mutex_unlock (&gtp_nft.mutex);
+    return RETURNerror;
+  }
+  gtp_nft_batch_begin (b);
+  gtp_nft_put_bearer_elem (b, NFT_MSG_DELSETELEM, NLM_F_ACK, ue, sdf_mark, NULL);
+  gtp_nft_batch_end (b);
+  rc = gtp_nft_batch_send (b);
+  pthread_mutex_unlock (&gtp_nft.mutex);
+  if ((rc) && (-ENOENT != rc)) {
+    OAILOG_ERROR (LOG_GTPV1U, "Cannot remove bearer mark for UE %s mark %u: %s\n", inet_ntoa (ue), sdf_mark, strerror (-rc));
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int gtp_nft_marking_bearer_count (void)
+{
+  gtp_nft_msg_buffer_t                   *b = &gtp_nft.buffer;
+  struct sockaddr_nl                      kernel = {.nl_family = AF_NETLINK};
+  uint8_t                                 rbuf[GTP_NFT_BUFFER_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+  struct nlmsghdr                        *nlh = NULL;
+  int                                     count = 0;
+
+  pthread_mutex_lock (&gtp_nft.mutex);
+  if (gtp_nft.sd < 0) {
+    pthread_mutex_unlock (&gtp_nft.mutex);
+    return -1;
+  }
+  b->len = 0;
+  nlh = gtp_nft_nft_msg_begin (b, NFT_MSG_GETSETELEM, NLM_F_DUMP);
+  gtp_nft_attr_put_str (b, NFTA_SET_ELEM_LIST_TABLE, GTP_NFT_TABLE);
+  gtp_nft_attr_put_str (b, NFTA_SET_ELEM_LIST_SET, GTP_NFT_BEARER_MAP);
+  gtp_nft_msg_end (b, nlh);
+  if (sendto (gtp_nft.sd, b->data, b->len, 0, (struct sockaddr *)&kernel, sizeof (kernel)) < 0) {
+    pthread_mutex_unlock (&gtp_nft.mutex);
+    return -1;
+  }
+  while (count >= 0) {
+    ssize_t                                 len = recv (gtp_nft.sd, rbuf, sizeof (rbuf), 0);
+
+    if (len < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      count = -1;
+      break;
+    }
+    for (nlh = (struct nlmsghdr *)rbuf; NLMSG_OK (nlh, (size_t)len); nlh = NLMSG_NEXT (nlh, len)) {
+      if (nlh->nlmsg_seq != b->last_seq) {
+        continue;
+      }
+      if (NLMSG_DONE == nlh->nlmsg_type) {
+        pthread_mutex_unlock (&gtp_nft.mutex);
+        return count;
+      }
+      if (NLMSG_ERROR == nlh->nlmsg_type) {
+        count = -1;
+        break;
+      }
+      // one message per batch of elements: count the NFTA_LIST_ELEM of NFTA_SET_ELEM_LIST_ELEMENTS
+      int                                     attrlen = (int)nlh->nlmsg_len - NLMSG_LENGTH (sizeof (struct nfgenmsg));
+      struct nlattr                          *nla = (struct nlattr *)((uint8_t *)NLMSG_DATA (nlh) + NLMSG_ALIGN (sizeof (struct nfgenmsg)));
+
+      for (; (attrlen >= NLA_HDRLEN) && (nla->nla_len >= NLA_HDRLEN) && (nla->nla_len <= attrlen);
+           attrlen -= NLA_ALIGN (nla->nla_len), nla = (struct nlattr *)((uint8_t *)nla + NLA_ALIGN (nla->nla_len))) {
+        if (NFTA_SET_ELEM_LIST_ELEMENTS == (nla->nla_type & NLA_TYPE_MASK)) {
+          int                                     elemslen = nla->nla_len - NLA_HDRLEN;
+          struct nlattr                          *elem = (struct nlattr *)((uint8_t *)nla + NLA_HDRLEN);
+
+          for (; (elemslen >= NLA_HDRLEN) && (elem->nla_len >= NLA_HDRLEN) && (elem->nla_len <= elemslen);
+               elemslen -= NLA_ALIGN (elem->nla_len), elem = (struct nlattr *)((uint8_t *)elem + NLA_ALIGN (elem->nla_len))) {
+            count++;
+          }
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock (&gtp_nft.mutex);
+  return count;
+}
@@ -0,0 +1,99 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtp_nft_marking.h
+  \brief Packet marking for the bearers of the GTP kernel device, programmed in process through nftables netlink
+         batches instead of iptables commands. The table GTP_NFT_TABLE holds:
+           - chain postrouting (mangle priority): PCC rules (SDF filter -> SDF mark), then
+             oifname <gtp device> meta mark set ip daddr . meta mark map @bearer_marks
+           - chain output (mangle priority): PCC rules for the UE <-> PGW traffic
+           - map bearer_marks: UE IPv4 address . SDF mark -> EPS bearer id mark
+         Adding or removing a bearer is one set element in one netlink message.
+*/
+
+#ifndef FILE_GTP_NFT_MARKING_SEEN
+#define FILE_GTP_NFT_MARKING_SEEN
+
+#include <stdint.h>
+#include <netinet/in.h>
+
+#define GTP_NFT_TABLE               "oai_spgw"
+#define GTP_NFT_BEARER_MAP          "bearer_marks"
+
+typedef enum gtp_nft_chain_e {
+  GTP_NFT_CHAIN_POSTROUTING = 0,
+  GTP_NFT_CHAIN_OUTPUT,
+} gtp_nft_chain_t;
+
+#define GTP_NFT_MATCH_DADDR          (1 << 0)   /*!< \brief ip daddr & daddr_mask == daddr */
+#define GTP_NFT_MATCH_SADDR          (1 << 1)   /*!< \brief ip saddr & saddr_mask == saddr */
+#define GTP_NFT_MATCH_DADDR_RANGE    (1 << 2)   /*!< \brief daddr_low <= ip daddr <= daddr_high */
+#define GTP_NFT_MATCH_PROTOCOL       (1 << 3)
+#define GTP_NFT_MATCH_DPORT          (1 << 4)
+#define GTP_NFT_MATCH_SPORT          (1 << 5)
+#define GTP_NFT_MATCH_SPI            (1 << 6)
+#define GTP_NFT_MATCH_TOS            (1 << 7)
+
+/*! \struct  gtp_nft_match_t
+* \brief IPv4 packet filter of a PCC rule, addresses in network byte order, the other fields in host byte order.
+*/
+typedef struct gtp_nft_match_s {
+  uint32_t                        flags;              /*!< \brief GTP_NFT_MATCH_* */
+  struct in_addr                  daddr;
+  struct in_addr                  daddr_mask;
+  struct in_addr                  saddr;
+  struct in_addr                  saddr_mask;
+  struct in_addr                  daddr_low;
+  struct in_addr                  daddr_high;
+  uint8_t                         protocol;
+  uint16_t                        dport;
+  uint16_t                        sport;
+  uint32_t                        spi;
+  uint8_t                         tos;
+} gtp_nft_match_t;
+
+/** \brief (Re)creates the table, its chains and the bearer map in one transaction, any previous content is dropped.
+ * \param gtp_devname Name of the GTP device the bearer marks apply to.
+ * @returns RETURNok or RETURNerror.
+ **/
+int  gtp_nft_marking_init (const char * const gtp_devname);
+
+/** \brief Deletes the table and closes the netlink socket.
+ **/
+void gtp_nft_marking_exit (void);
+
+/** \brief Inserts a PCC rule at the head of the chain, marking the matching packets with sdf_mark (iptables -I ... -j MARK).
+ **/
+int  gtp_nft_marking_add_sdf_rule (const gtp_nft_chain_t chain, const gtp_nft_match_t * const match, const uint32_t sdf_mark);
+
+/** \brief Packets to ue marked sdf_mark by the PCC rules leave the GTP device marked bearer_mark.
+ **/
+int  gtp_nft_marking_add_bearer (const struct in_addr ue, const uint32_t sdf_mark, const uint32_t bearer_mark);
+
+/** \brief Removes the bearer mark, a missing one is not an error.
+ **/
+int  gtp_nft_marking_del_bearer (const struct in_addr ue, const uint32_t sdf_mark);
+
+/** \brief Number of elements in the bearer map, -1 on error.
+ **/
+int  gtp_nft_marking_bearer_count (void);
+
+#endif /* FILE_GTP_NFT_MARKING_SEEN */
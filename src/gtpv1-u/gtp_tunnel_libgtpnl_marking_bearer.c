@@ -29,6 +29,8 @@
 #include <libgtpnl/gtp.h>
 #include <libgtpnl/gtpnl.h>
 #include <libmnl/libmnl.h>
+#include <linux/genetlink.h>
+#include <linux/gtp.h>
 #include <errno.h>
 
 #include "log.h"
@@ -46,11 +48,22 @@ static struct {
   int                 genl_id;
   struct mnl_socket  *nl;
   bool                is_enabled;
+  uint32_t            ifindex;   // of GTP_DEVNAME, resolved once
+  uint32_t            portid;
+  uint32_t            seq;
 } gtp_nl;
 
 
 #define GTP_DEVNAME "gtp0"
 
+// Attribute added by build/tools/kernel4.7-GTPv1U-LTE-dedicated-bearer.v0.patch right after GTPA_O_TEI
+#define GTPA_BEARER_ID                  (GTPA_O_TEI + 1)
+
+// PDP operations sent in one netlink write, sized so that the acks fit in the socket receive buffer
+#define GTP_NL_BATCH_MAX_PDPS           256
+#define GTP_NL_PDP_MSG_MAX_SIZE         128
+#define GTP_NL_RCVBUF_SIZE              (1 << 20)
+
 int libgtpnl_init(struct in_addr *ue_net, struct in_addr *ue_netmask, int mtu, int *fd0, int *fd1u)
 {
   // we don't need GTP v0, but interface with kernel requires 2 file descriptors
@@ -98,6 +111,17 @@ int libgtpnl_init(struct in_addr *ue_net, struct in_addr *ue_netmask, int mtu, i
     OAILOG_ERROR (LOG_GTPV1U, "Cannot lookup GTP genetlink ID\n");
     return RETURNerror;
   }
+  gtp_nl.portid = mnl_socket_get_portid(gtp_nl.nl);
+  // acks without the copy of the request
+  int on = 1;
+  mnl_socket_setsockopt(gtp_nl.nl, NETLINK_CAP_ACK, &on, sizeof(on));
+  int rcvbuf = GTP_NL_RCVBUF_SIZE;
+  setsockopt(mnl_socket_get_fd(gtp_nl.nl), SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  gtp_nl.ifindex = if_nametoindex(GTP_DEVNAME);
+  if (!gtp_nl.ifindex) {
+    OAILOG_ERROR (LOG_GTPV1U, "Cannot get ifindex of %s: %s\n", GTP_DEVNAME, strerror(errno));
+    return RETURNerror;
+  }
   OAILOG_NOTICE (LOG_GTPV1U, "Using the GTP kernel mode (genl ID is %d)\n", gtp_nl.genl_id);
 
   bstring system_cmd = bformat ("ip link set dev %s mtu %u", GTP_DEVNAME, mtu);
@@ -110,6 +134,7 @@ int libgtpnl_init(struct in_addr *ue_net, struct in_addr *ue_netmask, int mtu, i
   bdestroy(system_cmd);
 
   struct in_addr ue_gw;
+  uint32_t mask = __builtin_popcount(ue_netmask->s_addr);
   ue_gw.s_addr = ue_net->s_addr | htonl(1);
   system_cmd = bformat ("ip addr add %s/%u dev %s", inet_ntoa(ue_gw), mask, GTP_DEVNAME);
   ret = system ((const char *)system_cmd->data);
@@ -138,6 +163,12 @@ int libgtpnl_uninit(void)
   if (!gtp_nl.is_enabled)
     return -1;
 
+  gtp_nl.is_enabled = false;
+  gtp_nl.ifindex = 0;
+  if (gtp_nl.nl) {
+    mnl_socket_close(gtp_nl.nl);
+    gtp_nl.nl = NULL;
+  }
   return gtp_dev_destroy(GTP_DEVNAME);
 }
 
@@ -149,55 +180,264 @@ int libgtpnl_reset(void)
   return rv;
 }
 
-int libgtpnl_add_tunnel(struct in_addr ue, struct in_addr enb, uint32_t i_tei, uint32_t o_tei, uint8_t bearer_id){
-  struct gtp_tunnel *t;
-  int ret;
+//------------------------------------------------------------------------------
+static void libgtpnl_build_pdp(struct nlmsghdr *nlh, const gtp_tunnel_pdp_t * const pdp, const bool add)
+{
+  mnl_attr_put_u32(nlh, GTPA_LINK, gtp_nl.ifindex);
+  mnl_attr_put_u32(nlh, GTPA_VERSION, GTP_V1);
+  if (add) {
+    mnl_attr_put_u32(nlh, GTPA_MS_ADDRESS, pdp->ue.s_addr);
+    mnl_attr_put_u32(nlh, GTPA_PEER_ADDRESS, pdp->enb.s_addr);
+    mnl_attr_put_u32(nlh, GTPA_I_TEI, pdp->i_tei);
+    mnl_attr_put_u32(nlh, GTPA_O_TEI, pdp->o_tei);
+    mnl_attr_put_u32(nlh, GTPA_BEARER_ID, pdp->bearer_id);
+  } else if (INVALID_TEID != pdp->i_tei) {
+    // looking at kernel/drivers/net/gtp.c: i_tei is enough
+    mnl_attr_put_u32(nlh, GTPA_I_TEI, pdp->i_tei);
+  } else {
+    mnl_attr_put_u32(nlh, GTPA_MS_ADDRESS, pdp->ue.s_addr);
+    mnl_attr_put_u32(nlh, GTPA_BEARER_ID, pdp->bearer_id);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Sends up to GTP_NL_BATCH_MAX_PDPS requests in one write, then collects their acks in any order (matched by sequence number).
+static int libgtpnl_talk_pdps(gtp_tunnel_pdp_t * const pdps, const int nb_pdps, const uint8_t cmd)
+{
+  char                     buf[GTP_NL_BATCH_MAX_PDPS * GTP_NL_PDP_MSG_MAX_SIZE];
+  char                     rbuf[MNL_SOCKET_BUFFER_SIZE];
+  struct mnl_nlmsg_batch  *batch = mnl_nlmsg_batch_start(buf, sizeof(buf));
+  const uint32_t           first_seq = gtp_nl.seq + 1;
+  int                      pending = nb_pdps;
+  int                      rc = RETURNok;
+
+  for (int i = 0; i < nb_pdps; i++) {
+    struct nlmsghdr *nlh = genl_nlmsg_build_hdr(mnl_nlmsg_batch_current(batch), gtp_nl.genl_id,
+        ((GTP_CMD_NEWPDP == cmd) ? NLM_F_EXCL : 0) | NLM_F_ACK, ++gtp_nl.seq, cmd);
+
+    libgtpnl_build_pdp(nlh, &pdps[i], GTP_CMD_NEWPDP == cmd);
+    pdps[i].rc = -ETIMEDOUT;
+    mnl_nlmsg_batch_next(batch);
+  }
+  if (mnl_socket_sendto(gtp_nl.nl, mnl_nlmsg_batch_head(batch), mnl_nlmsg_batch_size(batch)) < 0) {
+    rc = -errno;
+    mnl_nlmsg_batch_stop(batch);
+    for (int i = 0; i < nb_pdps; i++) {
+      pdps[i].rc = rc;
+    }
+    return RETURNerror;
+  }
+  mnl_nlmsg_batch_stop(batch);
+
+  while (pending > 0) {
+    int len = mnl_socket_recvfrom(gtp_nl.nl, rbuf, sizeof(rbuf));
+
+    if (len < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      OAILOG_ERROR (LOG_GTPV1U, "Lost %d GTP tunnel acks: %s\n", pending, strerror(errno));
+      return RETURNerror;
+    }
+    for (const struct nlmsghdr *nlh = (const struct nlmsghdr *)rbuf; mnl_nlmsg_ok(nlh, len); nlh = mnl_nlmsg_next(nlh, &len)) {
+      const uint32_t i = nlh->nlmsg_seq - first_seq;
+
+      if ((NLMSG_ERROR != nlh->nlmsg_type) || (nlh->nlmsg_pid != gtp_nl.portid) || (i >= (uint32_t)nb_pdps)) {
+        continue;
+      }
+      const struct nlmsgerr *err = mnl_nlmsg_get_payload(nlh);
+
+      pdps[i].rc = err->error;
+      if (err->error) {
+        rc = RETURNerror;
+      }
+      pending--;
+    }
+  }
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static int libgtpnl_pdps(gtp_tunnel_pdp_t * const pdps, const int nb_pdps, const uint8_t cmd)
+{
+  int rc = RETURNok;
 
   if (!gtp_nl.is_enabled)
     return RETURNok;
 
-  t = gtp_tunnel_alloc();
-  if (t == NULL)
-    return RETURNerror;
+  for (int i = 0; i < nb_pdps; i += GTP_NL_BATCH_MAX_PDPS) {
+    const int n = ((nb_pdps - i) < GTP_NL_BATCH_MAX_PDPS) ? (nb_pdps - i) : GTP_NL_BATCH_MAX_PDPS;
+
+    if (RETURNok != libgtpnl_talk_pdps(&pdps[i], n, cmd)) {
+      rc = RETURNerror;
+    }
+  }
+  return rc;
+}
 
+//------------------------------------------------------------------------------
+int libgtpnl_add_tunnels(gtp_tunnel_pdp_t * const pdps, const int nb_pdps)
+{
+  return libgtpnl_pdps(pdps, nb_pdps, GTP_CMD_NEWPDP);
+}
 
-  gtp_tunnel_set_ifidx(t, if_nametoindex(GTP_DEVNAME));
-  gtp_tunnel_set_version(t, 1);
-  gtp_tunnel_set_ms_ip4(t, &ue);
-  gtp_tunnel_set_sgsn_ip4(t, &enb);
-  gtp_tunnel_set_i_tei(t, i_tei);
-  gtp_tunnel_set_o_tei(t, o_tei);
-  gtp_tunnel_set_bearer_id(t, bearer_id);
+//------------------------------------------------------------------------------
+int libgtpnl_del_tunnels(gtp_tunnel_pdp_t * const pdps, const int nb_pdps)
+{
+  return libgtpnl_pdps(pdps, nb_pdps, GTP_CMD_DELPDP);
+}
 
-  ret = gtp_add_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
-  gtp_tunnel_free(t);
+//------------------------------------------------------------------------------
+int libgtpnl_add_tunnel(struct in_addr ue, struct in_addr enb, uint32_t i_tei, uint32_t o_tei, uint8_t bearer_id)
+{
+  gtp_tunnel_pdp_t pdp = {.ue = ue, .enb = enb, .i_tei = i_tei, .o_tei = o_tei, .bearer_id = bearer_id};
 
-  return ret;
+  libgtpnl_pdps(&pdp, 1, GTP_CMD_NEWPDP);
+  return pdp.rc;
 }
 
+//------------------------------------------------------------------------------
 int libgtpnl_del_tunnel(struct in_addr ue, uint32_t i_tei, uint32_t o_tei)
 {
-  struct gtp_tunnel *t;
-  int ret;
+  gtp_tunnel_pdp_t pdp = {.ue = ue, .i_tei = i_tei, .o_tei = o_tei};
 
-  if (!gtp_nl.is_enabled)
-    return RETURNok;
+  libgtpnl_pdps(&pdp, 1, GTP_CMD_DELPDP);
+  return pdp.rc;
+}
+
+//------------------------------------------------------------------------------
+typedef struct libgtpnl_dump_s {
+  gtp_tunnel_pdp_t *pdps;
+  int               nb_pdps;
+  int               size;
+} libgtpnl_dump_t;
+
+static int libgtpnl_dump_pdp_cb(const struct nlmsghdr *nlh, void *data)
+{
+  libgtpnl_dump_t    *dump = (libgtpnl_dump_t *)data;
+  gtp_tunnel_pdp_t    pdp = {.rc = 0};
+  uint32_t            link = gtp_nl.ifindex;
+  struct nlattr      *attr = NULL;
+
+  mnl_attr_for_each(attr, nlh, sizeof(struct genlmsghdr)) {
+    switch (mnl_attr_get_type(attr)) {
+      case GTPA_LINK:         link = mnl_attr_get_u32(attr); break;
+      case GTPA_MS_ADDRESS:   pdp.ue.s_addr = mnl_attr_get_u32(attr); break;
+      case GTPA_PEER_ADDRESS: pdp.enb.s_addr = mnl_attr_get_u32(attr); break;
+      case GTPA_I_TEI:        pdp.i_tei = mnl_attr_get_u32(attr); break;
+      case GTPA_O_TEI:        pdp.o_tei = mnl_attr_get_u32(attr); break;
+      case GTPA_BEARER_ID:    pdp.bearer_id = mnl_attr_get_u8(attr); break;
+      default:;
+    }
+  }
+  if (link != gtp_nl.ifindex) {
+    return MNL_CB_OK;
+  }
+  if (dump->nb_pdps == dump->size) {
+    dump->size = (dump->size) ? 2 * dump->size : 1024;
+    dump->pdps = realloc(dump->pdps, dump->size * sizeof(gtp_tunnel_pdp_t));
+    if (!dump->pdps) {
+      return MNL_CB_ERROR;
+    }
+  }
+  dump->pdps[dump->nb_pdps++] = pdp;
+  return MNL_CB_OK;
+}
+
+//------------------------------------------------------------------------------
+static int libgtpnl_dump_pdps(libgtpnl_dump_t * const dump)
+{
+  char             buf[MNL_SOCKET_BUFFER_SIZE];
+  struct nlmsghdr *nlh = genl_nlmsg_build_hdr(buf, gtp_nl.genl_id, NLM_F_DUMP, ++gtp_nl.seq, GTP_CMD_GETPDP);
+  const uint32_t   seq = gtp_nl.seq;
+  int              ret = 0;
 
-  t = gtp_tunnel_alloc();
-  if (t == NULL)
+  mnl_attr_put_u32(nlh, GTPA_VERSION, GTP_V1);
+  if (mnl_socket_sendto(gtp_nl.nl, nlh, nlh->nlmsg_len) < 0) {
     return RETURNerror;
+  }
+  do {
+    ret = mnl_socket_recvfrom(gtp_nl.nl, buf, sizeof(buf));
+    if (ret > 0) {
+      ret = mnl_cb_run(buf, ret, seq, gtp_nl.portid, libgtpnl_dump_pdp_cb, dump);
+    }
+  } while (ret > MNL_CB_STOP);
+  return (ret < 0) ? RETURNerror : RETURNok;
+}
 
-  gtp_tunnel_set_ifidx(t, if_nametoindex(GTP_DEVNAME));
-  gtp_tunnel_set_version(t, 1);
-  // looking at kernel/drivers/net/gtp.c: not needed gtp_tunnel_set_ms_ip4(t, &ue);
-  // looking at kernel/drivers/net/gtp.c: not needed gtp_tunnel_set_sgsn_ip4(t, &enb);
-  gtp_tunnel_set_i_tei(t, i_tei);
-  gtp_tunnel_set_o_tei(t, o_tei);
+//------------------------------------------------------------------------------
+static int libgtpnl_pdp_cmp_i_tei(const void *a, const void *b)
+{
+  const uint32_t ta = ((const gtp_tunnel_pdp_t *)a)->i_tei;
+  const uint32_t tb = ((const gtp_tunnel_pdp_t *)b)->i_tei;
 
-  ret = gtp_del_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
-  gtp_tunnel_free(t);
+  return (ta > tb) - (ta < tb);
+}
 
-  return ret;
+//------------------------------------------------------------------------------
+int libgtpnl_reconcile_tunnels(gtp_tunnel_pdp_t * const pdps, const int nb_pdps)
+{
+  libgtpnl_dump_t    dump = {.pdps = NULL};
+  gtp_tunnel_pdp_t  *stale = NULL;
+  gtp_tunnel_pdp_t  *missing = NULL;
+  int                nb_stale = 0;
+  int                nb_missing = 0;
+  int                rc = RETURNok;
+
+  if (!gtp_nl.is_enabled)
+    return RETURNok;
+
+  if (RETURNok != libgtpnl_dump_pdps(&dump)) {
+    OAILOG_ERROR (LOG_GTPV1U, "Cannot dump GTP tunnels\n");
+    free(dump.pdps);
+    return RETURNerror;
+  }
+  qsort(pdps, nb_pdps, sizeof(gtp_tunnel_pdp_t), libgtpnl_pdp_cmp_i_tei);
+  qsort(dump.pdps, dump.nb_pdps, sizeof(gtp_tunnel_pdp_t), libgtpnl_pdp_cmp_i_tei);
+  stale = calloc(dump.nb_pdps + 1, sizeof(gtp_tunnel_pdp_t));
+  missing = calloc(nb_pdps + 1, sizeof(gtp_tunnel_pdp_t));
+  if ((!stale) || (!missing)) {
+    free(dump.pdps);
+    free(stale);
+    free(missing);
+    return RETURNerror;
+  }
+  // merge of the two sorted lists: a kernel tunnel differing from the expected one is deleted then added
+  for (int i = 0, k = 0; (i < nb_pdps) || (k < dump.nb_pdps);) {
+    if ((k < dump.nb_pdps) && ((i == nb_pdps) || (dump.pdps[k].i_tei < pdps[i].i_tei))) {
+      stale[nb_stale++] = dump.pdps[k++];
+    } else if ((k == dump.nb_pdps) || (pdps[i].i_tei < dump.pdps[k].i_tei)) {
+      missing[nb_missing++] = pdps[i++];
+    } else {
+      if ((dump.pdps[k].ue.s_addr != pdps[i].ue.s_addr) || (dump.pdps[k].enb.s_addr != pdps[i].enb.s_addr) ||
+          (dump.pdps[k].o_tei != pdps[i].o_tei) || (dump.pdps[k].bearer_id != pdps[i].bearer_id)) {
+        stale[nb_stale++] = dump.pdps[k];
+        missing[nb_missing++] = pdps[i];
+      }
+      pdps[i].rc = 0;
+      i++;
+      k++;
+    }
+  }
+  OAILOG_NOTICE (LOG_GTPV1U, "Reconciling GTP tunnels: %d in kernel, %d expected, %d stale, %d missing\n",
+      dump.nb_pdps, nb_pdps, nb_stale, nb_missing);
+  if (RETURNok != libgtpnl_pdps(stale, nb_stale, GTP_CMD_DELPDP)) {
+    rc = RETURNerror;
+  }
+  if (RETURNok != libgtpnl_pdps(missing, nb_missing, GTP_CMD_NEWPDP)) {
+    rc = RETURNerror;
+  }
+  // report the results of the additions in the caller array (still sorted by i_tei)
+  for (int m = 0; m < nb_missing; m++) {
+    gtp_tunnel_pdp_t *pdp = bsearch(&missing[m], pdps, nb_pdps, sizeof(gtp_tunnel_pdp_t), libgtpnl_pdp_cmp_i_tei);
+    if (pdp) {
+      pdp->rc = missing[m].rc;
+    }
+  }
+  free(dump.pdps);
+  free(stale);
+  free(missing);
+  return rc;
 }
 
 static const struct gtp_tunnel_ops libgtpnl_ops = {
@@ -206,6 +446,9 @@ static const struct gtp_tunnel_ops libgtpnl_ops = {
   .reset        = libgtpnl_reset,
   .add_tunnel   = libgtpnl_add_tunnel,
   .del_tunnel   = libgtpnl_del_tunnel,
+  .add_tunnels  = libgtpnl_add_tunnels,
+  .del_tunnels  = libgtpnl_del_tunnels,
+  .reconcile_tunnels = libgtpnl_reconcile_tunnels,
 };
 
 const struct gtp_tunnel_ops *gtp_tunnel_ops_init(void) {
@@ -76,7 +76,28 @@ extern "C" {
  *         @ue: UE IP address
  *         @i_tei: RX GTP Tunnel ID
  *         @o_tei: TX GTP Tunnel ID.
+ *
+ * int (*add_tunnels)(gtp_tunnel_pdp_t *pdps, int nb_pdps);
+ * int (*del_tunnels)(gtp_tunnel_pdp_t *pdps, int nb_pdps);
+ *     Add or delete many gtp tunnels with as few kernel round trips as possible, the
+ *     result of each tunnel is set in pdps[i].rc. Delete uses i_tei, or ue and
+ *     bearer_id if i_tei is INVALID_TEID. Return RETURNok if every tunnel succeeded.
+ *
+ * int (*reconcile_tunnels)(gtp_tunnel_pdp_t *pdps, int nb_pdps);
+ *     Makes the kernel tunnels match pdps: dumps the kernel tunnels, deletes the
+ *     ones not in pdps (or differing), adds the missing ones. pdps is sorted by i_tei.
  */
+
+#if ENABLE_LIBGTPNL
+typedef struct gtp_tunnel_pdp_s {
+  struct in_addr ue;
+  struct in_addr enb;
+  uint32_t       i_tei;
+  uint32_t       o_tei;
+  uint8_t        bearer_id;
+  int            rc;          // result of the operation on this tunnel, 0 or -errno
+} gtp_tunnel_pdp_t;
+#endif
 struct gtp_tunnel_ops {
   int  (*init)(struct in_addr *ue_net, struct in_addr *ue_netmask, int mtu, int *fd0, int *fd1u);
   int  (*uninit)(void);
@@ -84,6 +105,9 @@ struct gtp_tunnel_ops {
 #if ENABLE_LIBGTPNL
   int  (*add_tunnel)(struct in_addr ue, struct in_addr enb, uint32_t i_tei, uint32_t o_tei, uint8_t bearer_id);
   int  (*del_tunnel)(struct in_addr ue, uint32_t i_tei, uint32_t o_tei);
+  int  (*add_tunnels)(gtp_tunnel_pdp_t * const pdps, const int nb_pdps);
+  int  (*del_tunnels)(gtp_tunnel_pdp_t * const pdps, const int nb_pdps);
+  int  (*reconcile_tunnels)(gtp_tunnel_pdp_t * const pdps, const int nb_pdps);
 #endif
 #if ENABLE_OPENFLOW
   int  (*add_tunnel)(struct in_addr ue, struct in_addr enb, uint32_t i_tei, uint32_t o_tei, ebi_t ebi, imsi_t imsi, const pcc_rule_t *const rule);
@@ -95,7 +119,13 @@ struct gtp_tunnel_ops {
 #endif
 };
 
+/** \brief S1-U TEID pool, see teid_pool_create(). */
+int      gtpv1u_teid_pool_init(const int num_shards, const uint32_t node_id, const int node_id_bits, const uint32_t quarantine_ms);
+void     gtpv1u_teid_pool_exit(void);
+/** \brief Unique TEID, 0 if none is available. */
 uint32_t gtpv1u_new_teid(void);
+/** \brief The TEID is reused only after the quarantine. */
+int      gtpv1u_release_teid(const uint32_t teid);
 
 const struct gtp_tunnel_ops *gtp_tunnel_ops_init(void);
 
@@ -18,40 +18,65 @@
  * For more information about the OpenAirInterface (OAI) Software Alliance:
  *      contact@openairinterface.org
  */
-/*! \file gtpv1u_task.c
-  \brief
+/*! \file gtpv1u_teid_pool.c
+  \brief S1-U TEID allocation
   \author Lionel Gauthier
   \company Eurecom
   \email: lionel.gauthier@eurecom.fr
 */
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 
+#include "common_defs.h"
+#include "teid_pool.h"
 #include "gtpv1u.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-//#define GTPV1U_LINEAR_TEID_ALLOCATION 1
+// S1-U S-GW TEIDs, unique, reused only after quarantine
+static teid_pool_t                     *g_gtpv1u_teid_pool = NULL;
 
-#if GTPV1U_LINEAR_TEID_ALLOCATION
-static uint32_t                         g_gtpv1u_teid = 0;
-#endif
+//------------------------------------------------------------------------------
+int
+gtpv1u_teid_pool_init (
+  const int num_shards,
+  const uint32_t node_id,
+  const int node_id_bits,
+  const uint32_t quarantine_ms)
+{
+  teid_pool_destroy (g_gtpv1u_teid_pool);
+  g_gtpv1u_teid_pool = teid_pool_create (num_shards, node_id, node_id_bits, quarantine_ms);
+  return (g_gtpv1u_teid_pool) ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+void
+gtpv1u_teid_pool_exit (
+  void)
+{
+  teid_pool_destroy (g_gtpv1u_teid_pool);
+  g_gtpv1u_teid_pool = NULL;
+}
 
+//------------------------------------------------------------------------------
 uint32_t
 gtpv1u_new_teid (
   void)
 {
-#if GTPV1U_LINEAR_TEID_ALLOCATION
-  g_gtpv1u_teid = g_gtpv1u_teid + 1;
-  return g_gtpv1u_teid;
-#else
-  return random () + random () % (RAND_MAX - 1) + 1;
-#endif
+  return teid_pool_alloc (g_gtpv1u_teid_pool, TEID_POOL_ANY_SHARD);
+}
+
+//------------------------------------------------------------------------------
+int
+gtpv1u_release_teid (
+  const uint32_t teid)
+{
+  return teid_pool_release (g_gtpv1u_teid_pool, teid);
 }
 
 #ifdef __cplusplus
 }
 #endif
-
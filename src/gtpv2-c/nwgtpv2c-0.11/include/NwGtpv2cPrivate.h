@@ -34,6 +34,7 @@
 #ifndef __NW_GTPV2C_PRIVATE_H__
 #define __NW_GTPV2C_PRIVATE_H__
 
+#include <stdbool.h>
 #include <sys/time.h>
 
 #include "assertions.h"
@@ -84,6 +85,56 @@ extern "C" {
     }                                                                   \
   } while (0)
 
+/*--------------------------------------------------------------------------*
+ *  O B J E C T   M A P   T Y P E    D E F I N I T I O N                    *
+ *--------------------------------------------------------------------------*/
+
+#define NW_GTPV2C_OBJ_MAP_INITIAL_SIZE                           (1024)  /**< Initial slot count, power of two   */
+
+/**
+ * Slot of an open addressed object map. The key of the object is kept in the
+ * slot, so that probing never touches the objects skipped on the way.
+ */
+typedef struct nw_gtpv2c_obj_map_entry_s {
+  uint64_t                      key;
+  uint32_t                      keyExt;
+  void*                         pObj;                                   /**< NULL for an empty slot             */
+} nw_gtpv2c_obj_map_entry_t;
+
+/**
+ * Linear probing map of tunnels and transactions, kept at most half full and
+ * doubled when needed. Removal shifts the following entries of the cluster
+ * back instead of leaving tombstones.
+ */
+typedef struct nw_gtpv2c_obj_map_s {
+  nw_gtpv2c_obj_map_entry_t*    pEntry;
+  uint32_t                      mask;                                   /**< Slot count - 1                     */
+  uint32_t                      count;
+} nw_gtpv2c_obj_map_t;
+
+/*--------------------------------------------------------------------------*
+ *  T I M E R   W H E E L   T Y P E    D E F I N I T I O N                  *
+ *--------------------------------------------------------------------------*/
+
+#define NW_GTPV2C_TMR_WHEEL_TICK_USEC                            (1000)  /**< Wheel resolution                   */
+#define NW_GTPV2C_TMR_WHEEL_SLOT_BITS                            (12)
+#define NW_GTPV2C_TMR_WHEEL_SLOTS                                (1 << NW_GTPV2C_TMR_WHEEL_SLOT_BITS)
+#define NW_GTPV2C_TMR_WHEEL_SLOT_MASK                            (NW_GTPV2C_TMR_WHEEL_SLOTS - 1)
+
+/**
+ * Hashed timing wheel of the stack timers: a timer sits in the slot of its
+ * expiry tick modulo the wheel size and fires when the wheel reaches it in the
+ * right turn. A bitmap of the occupied slots gives the next tick to wait for,
+ * for which a single ULP timer is armed.
+ */
+typedef struct nw_gtpv2c_tmr_wheel_s {
+  struct nw_gtpv2c_timeout_info_s* pSlot[NW_GTPV2C_TMR_WHEEL_SLOTS];
+  uint64_t                      slotMap[NW_GTPV2C_TMR_WHEEL_SLOTS / 64]; /**< Non empty slots                   */
+  uint64_t                      currTick;                               /**< Next tick to be processed          */
+  uint32_t                      count;                                  /**< Timers running                     */
+  bool                          processing;                             /**< Expired timers being fired         */
+} nw_gtpv2c_tmr_wheel_t;
+
 /*--------------------------------------------------------------------------*
  *  G T P V 2 C   S T A C K   O B J E C T   T Y P E    D E F I N I T I O N  *
  *--------------------------------------------------------------------------*/
@@ -105,13 +156,12 @@ typedef struct nw_gtpv2c_stack_s {
   uint32_t                        restartCounter;
 
   nw_gtpv2c_msg_ie_parse_info_t       *pGtpv2cMsgIeParseInfo[NW_GTP_MSG_END];
-  struct nw_gtpv2c_timeout_info_s    *activeTimerInfo;
+  struct nw_gtpv2c_timeout_info_s    *activeTimerInfo;                  /**< ULP timer armed for the wheel      */
 
-  RB_HEAD( NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s                ) tunnelMap;
-  RB_HEAD( NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s ) outstandingTxSeqNumMap;
-  RB_HEAD( NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s ) outstandingRxSeqNumMap;
-  RB_HEAD( NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s     ) activeTimerList;
-  NwPtrT                        hTmrMinHeap;
+  nw_gtpv2c_obj_map_t             tunnelMap;                            /**< Keyed by teid and peer IP          */
+  nw_gtpv2c_obj_map_t             outstandingTxSeqNumMap;               /**< Keyed by seq num and peer IP       */
+  nw_gtpv2c_obj_map_t             outstandingRxSeqNumMap;               /**< Keyed by seq num, peer IP and port */
+  nw_gtpv2c_tmr_wheel_t           tmrWheel;
 } nw_gtpv2c_stack_t;
 
 
@@ -120,18 +170,18 @@ typedef struct nw_gtpv2c_stack_s {
  *--------------------------------------------------------------------------*/
 
 /**
- * gtpv2c timeout info
+ * gtpv2c timeout info, either a stack timer in the wheel or the ULP timer
+ * armed for the wheel (no timeoutCallbackFunc).
  */
 
 typedef struct nw_gtpv2c_timeout_info_s {
   nw_gtpv2c_stack_handle_t          hStack;
-  struct timeval                    tvTimeout;
+  uint64_t                          expiryTick;
   uint32_t                          tmrType;
   void*                             timeoutArg;
   nw_rc_t                         (*timeoutCallbackFunc)(void*);
   nw_gtpv2c_timer_handle_t          hTimer;
-  RB_ENTRY (nw_gtpv2c_timeout_info_s)       activeTimerListRbtNode;            /**< RB Tree Data Structure Node        */
-  uint32_t                          timerMinHeapIndex;
+  struct nw_gtpv2c_timeout_info_s **pprev;                              /**< NULL when not in the wheel         */
   struct nw_gtpv2c_timeout_info_s  *next;
 } nw_gtpv2c_timeout_info_t;
 
@@ -141,9 +191,24 @@ typedef struct nw_gtpv2c_timeout_info_s {
  *--------------------------------------------------------------------------*/
 
 #define NW_GTPV2C_MAX_MSG_LEN                                    (4096)  /**< Maximum supported gtpv2c packet length including header */
+#define NW_GTPV2C_MSG_IE_INDEX_MAXIMUM                           (64)    /**< Maximum distinct IE type/instance indexed per message */
+
+/**
+ * Entry of the IE index of a received message. Only the IEs found in the
+ * message are indexed, in the order they are received, with a bitmap of the
+ * IE types present: the types not in the message are rejected without a
+ * lookup and nothing but the bitmap has to be cleared when a message is parsed.
+ */
+typedef struct nw_gtpv2c_msg_ie_index_s {
+  uint8_t                       t;
+  uint8_t                       i;
+  uint16_t                      offset;                                 /**< IE offset in msgBuf                */
+} nw_gtpv2c_msg_ie_index_t;
 
 /**
  * NwGtpv2cMsgT holds gtpv2c messages to/from the peer.
+ * The message buffer trails the structure: received messages are taken from
+ * a slab sized to the datagram, built messages from a NW_GTPV2C_MAX_MSG_LEN one.
  */
 typedef struct nw_gtpv2c_msg_s {
   uint8_t                         version;
@@ -160,11 +225,13 @@ typedef struct nw_gtpv2c_msg_s {
     uint8_t             top;
   } groupedIeEncodeStack;
 
-  bool                          isIeValid[NW_GTPV2C_IE_TYPE_MAXIMUM][NW_GTPV2C_IE_INSTANCE_MAXIMUM];
-  uint8_t                      *pIe[NW_GTPV2C_IE_TYPE_MAXIMUM][NW_GTPV2C_IE_INSTANCE_MAXIMUM];
-  uint8_t                       msgBuf[NW_GTPV2C_MAX_MSG_LEN];
+  uint64_t                      ieTypeMap[NW_GTPV2C_IE_TYPE_MAXIMUM / 64];   /**< IE types in ieIndex  */
+  uint16_t                      ieCount;
+  nw_gtpv2c_msg_ie_index_t      ieIndex[NW_GTPV2C_MSG_IE_INDEX_MAXIMUM];
+  uint8_t                       msgSizeClass;                           /**< Slab size class of the message     */
   nw_gtpv2c_stack_handle_t      hStack;
   struct nw_gtpv2c_msg_s*       next;
+  uint8_t                       msgBuf[];
 } nw_gtpv2c_msg_t;
 
 /**
@@ -183,8 +250,6 @@ typedef struct nw_gtpv2c_trxn_s {
   nw_gtpv2c_timer_handle_t      hRspTmr;                                /**< Handle to reponse timer            */
   nw_gtpv2c_tunnel_handle_t     hTunnel;                                /**< Handle to local tunnel context     */
   nw_gtpv2c_ulp_trxn_handle_t   hUlpTrxn;                               /**< Handle to ULP tunnel context       */
-  RB_ENTRY (nw_gtpv2c_trxn_s)   outstandingTxSeqNumMapRbtNode;          /**< RB Tree Data Structure Node        */
-  RB_ENTRY (nw_gtpv2c_trxn_s)   outstandingRxSeqNumMapRbtNode;          /**< RB Tree Data Structure Node        */
   struct nw_gtpv2c_trxn_s*      next;
 } nw_gtpv2c_trxn_t;
 
@@ -203,10 +268,59 @@ typedef struct NwGtpv2cPathS {
 } NwGtpv2cPathT;
 
 
-RB_PROTOTYPE(NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapRbtNode, nwGtpv2cCompareTunnel)
-RB_PROTOTYPE(NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingTxSeqNumMapRbtNode, nwGtpv2cCompareSeqNum)
-RB_PROTOTYPE(NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingRxSeqNumMapRbtNode, nwGtpv2cCompareSeqNum)
-RB_PROTOTYPE(NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s, activeTimerListRbtNode, nwGtpv2cCompareOutstandingTxRexmitTime)
+/**
+ * Insert a transaction in the outstanding TX (resp. RX) transaction map of
+ * the stack. Returns the transaction already recorded with the same key, in
+ * which case pTrxn is not inserted, NULL otherwise.
+ */
+
+nw_gtpv2c_trxn_t*
+nwGtpv2cOutstandingTxTrxnInsert(nw_gtpv2c_stack_t* thiz,
+                                nw_gtpv2c_trxn_t* pTrxn);
+
+nw_gtpv2c_trxn_t*
+nwGtpv2cOutstandingRxTrxnInsert(nw_gtpv2c_stack_t* thiz,
+                                nw_gtpv2c_trxn_t* pTrxn);
+
+/**
+ * Remove a transaction from the outstanding TX (resp. RX) transaction map of
+ * the stack. Returns pTrxn, or NULL if it was not in the map.
+ */
+
+nw_gtpv2c_trxn_t*
+nwGtpv2cOutstandingTxTrxnRemove(nw_gtpv2c_stack_t* thiz,
+                                nw_gtpv2c_trxn_t* pTrxn);
+
+nw_gtpv2c_trxn_t*
+nwGtpv2cOutstandingRxTrxnRemove(nw_gtpv2c_stack_t* thiz,
+                                nw_gtpv2c_trxn_t* pTrxn);
+
+/**
+ * Empty the IE index of the message.
+ */
+
+void
+nwGtpv2cMsgIeIndexReset(nw_gtpv2c_msg_t* thiz);
+
+/**
+ * Record IE pIe of the message in its IE index, the first occurrence of a
+ * type and instance is kept.
+ */
+
+nw_rc_t
+nwGtpv2cMsgIeIndexAdd(nw_gtpv2c_msg_t* thiz,
+                      uint8_t type,
+                      uint8_t instance,
+                      uint8_t *pIe);
+
+/**
+ * Find an IE in the IE index of the message, NULL if not present.
+ */
+
+uint8_t*
+nwGtpv2cMsgIeIndexFind(nw_gtpv2c_msg_t* thiz,
+                       uint8_t type,
+                       uint8_t instance);
 
 /**
  * Start Timer with ULP Timer Manager
@@ -44,6 +44,8 @@
  * @brief This file defines APIs to parser gtpv2c messages.
 */
 
+#define NW_GTPV2C_MSG_PARSER_IE_MAXIMUM                                 (32)    /**< Maximum IE type/instance added to a parser */
+
 typedef struct nw_gtpv2c_msg_parser_s {
   uint16_t                msgType;
   uint16_t                mandatoryIeCount;
@@ -51,14 +53,17 @@ typedef struct nw_gtpv2c_msg_parser_s {
   nw_rc_t (*ieReadCallback) (uint8_t ieType, uint16_t ieLength, uint8_t ieInstance,  uint8_t* ieValue, void* ieReadCallbackArg);
   void* ieReadCallbackArg;
 
+  uint64_t                ieTypeMap[NW_GTPV2C_IE_TYPE_MAXIMUM / 64];     /**< IE types added to the parser */
+  uint16_t                ieCount;
   struct {
+    uint8_t ieType;
+    uint8_t ieInstance;
     uint8_t iePresence;
     bool firstInstanceOccurred;     /**< If we have multiple bearer contexts, check this flag to increment the mandatory IE count. */
     nw_rc_t (*ieReadCallback) (uint8_t ieType, uint16_t ieLength, uint8_t ieInstance,  uint8_t* ieValue, void* ieReadCallbackArg);
     void* ieReadCallbackArg;
-  } ieParseInfo[NW_GTPV2C_IE_TYPE_MAXIMUM][NW_GTPV2C_IE_INSTANCE_MAXIMUM];
-
-  uint8_t *pIe[NW_GTPV2C_IE_TYPE_MAXIMUM][NW_GTPV2C_IE_INSTANCE_MAXIMUM];
+    uint8_t *pIe;                   /**< Last occurrence of the IE in the message being parsed. */
+  } ieParseInfo[NW_GTPV2C_MSG_PARSER_IE_MAXIMUM];   /**< Only the IEs added to the parser, in the order they are added. */
 } nw_gtpv2c_msg_parser_t;
 
 #ifdef __cplusplus
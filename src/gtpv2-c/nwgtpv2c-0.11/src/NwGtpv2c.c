@@ -51,40 +51,6 @@
 #include "gcc_diag.h"
 #include "log.h"
 
-#ifdef _NWGTPV2C_HAVE_TIMERADD
-#  define NW_GTPV2C_TIMER_ADD(tvp, uvp, vvp) timeradd((tvp), (uvp), (vvp))
-#  define NW_GTPV2C_TIMER_SUB(tvp, uvp, vvp) timersub((tvp), (uvp), (vvp))
-#  define NW_GTPV2C_TIMER_CMP_P(a, b, CMP)   timercmp(a, b, CMP)
-#else
-
-#  define NW_GTPV2C_TIMER_ADD(tvp, uvp, vvp)                               \
-  do {                                                                  \
-    (vvp)->tv_sec = (tvp)->tv_sec + (uvp)->tv_sec;                      \
-    (vvp)->tv_usec = (tvp)->tv_usec + (uvp)->tv_usec;                   \
-    if ((vvp)->tv_usec >= 1000000) {                                    \
-      (vvp)->tv_sec++;                                                  \
-      (vvp)->tv_usec -= 1000000;                                        \
-    }                                                                   \
-  } while (0)
-
-#  define NW_GTPV2C_TIMER_SUB(tvp, uvp, vvp)                               \
-  do {                                                                  \
-    (vvp)->tv_sec = (tvp)->tv_sec - (uvp)->tv_sec;                      \
-    (vvp)->tv_usec = (tvp)->tv_usec - (uvp)->tv_usec;                   \
-    if ((vvp)->tv_usec < 0) {                                           \
-      (vvp)->tv_sec--;                                                  \
-      (vvp)->tv_usec += 1000000;                                        \
-    }                                                                   \
-  } while (0)
-
-#  define NW_GTPV2C_TIMER_CMP_P(a, b, CMP)                                \
-  (((a)->tv_sec == (b)->tv_sec) ?                                       \
-   ((a)->tv_usec CMP (b)->tv_usec) :                                    \
-   ((a)->tv_sec CMP (b)->tv_sec))
-
-#endif
-
-
 #define NW_GTPV2C_INIT_MSG_IE_PARSE_INFO(__thiz, __msgType)             \
   do {                                                                \
     __thiz->pGtpv2cMsgIeParseInfo[__msgType] =                        \
@@ -99,118 +65,6 @@ extern                                  "C" {
 
   static nw_gtpv2c_timeout_info_t            *gpGtpv2cTimeoutInfoPool = NULL;
 
-  typedef struct {
-    int                                     currSize;
-    int                                     maxSize;
-    nw_gtpv2c_timeout_info_t                  **pHeap;
-  } NwGtpv2cTmrMinHeapT;
-
-#define NW_HEAP_PARENT_INDEX(__child)           ( ( (__child) - 1 ) / 2 )
-
-
-  NwGtpv2cTmrMinHeapT                    *nwGtpv2cTmrMinHeapNew (
-  int maxSize) {
-    NwGtpv2cTmrMinHeapT                    *thiz = (NwGtpv2cTmrMinHeapT *) malloc (sizeof (NwGtpv2cTmrMinHeapT));
-
-    if (thiz) {
-      thiz->currSize = 0;
-      thiz->maxSize = maxSize;
-      thiz->pHeap = (nw_gtpv2c_timeout_info_t **) malloc (maxSize * sizeof (nw_gtpv2c_timeout_info_t *));
-    }
-
-    return                                  thiz;
-  }
-
-  void
-                                          nwGtpv2cTmrMinHeapDelete (
-  NwGtpv2cTmrMinHeapT * thiz) {
-    free_wrapper ((void**)&thiz->pHeap);
-    free_wrapper ((void**)&thiz);
-  }
-
-  static nw_rc_t                            nwGtpv2cTmrMinHeapInsert (
-  NwGtpv2cTmrMinHeapT * thiz,
-  nw_gtpv2c_timeout_info_t * pTimerEvent) {
-    int                                     holeIndex = thiz->currSize++;
-
-    NW_ASSERT (thiz->currSize < thiz->maxSize);
-
-    while ((holeIndex > 0) && NW_GTPV2C_TIMER_CMP_P (&(thiz->pHeap[NW_HEAP_PARENT_INDEX (holeIndex)])->tvTimeout, &(pTimerEvent->tvTimeout), >)) {
-      thiz->pHeap[holeIndex] = thiz->pHeap[NW_HEAP_PARENT_INDEX (holeIndex)];
-      thiz->pHeap[holeIndex]->timerMinHeapIndex = holeIndex;
-      holeIndex = NW_HEAP_PARENT_INDEX (holeIndex);
-    }
-
-    thiz->pHeap[holeIndex] = pTimerEvent;
-    pTimerEvent->timerMinHeapIndex = holeIndex;
-    return holeIndex;
-  }
-
-#define NW_MIN_HEAP_INDEX_INVALID                       (0xFFFFFFFF)
-  static nw_rc_t                            nwGtpv2cTmrMinHeapRemove (
-  NwGtpv2cTmrMinHeapT * thiz,
-  int minHeapIndex) {
-    nw_gtpv2c_timeout_info_t                   *pTimerEvent = NULL;
-    int                                     holeIndex = minHeapIndex;
-    int                                     minChild = 0,
-                                            maxChild = 0;
-
-    //printf("- Trying Removing %p from index %u, currSize %u, minChild %u, maxChild %u\n", thiz->pHeap[minHeapIndex], minHeapIndex, thiz->currSize, minChild, maxChild);
-    if (minHeapIndex == NW_MIN_HEAP_INDEX_INVALID)
-      return NW_FAILURE;
-
-    if (minHeapIndex < thiz->currSize) {
-      thiz->pHeap[minHeapIndex]->timerMinHeapIndex = NW_MIN_HEAP_INDEX_INVALID;
-      thiz->currSize--;
-      pTimerEvent = thiz->pHeap[thiz->currSize];
-      holeIndex = minHeapIndex;
-      minChild = (2 * holeIndex) + 1;
-      maxChild = minChild + 1;
-
-      //printf("- Removing %p from index %u, currSize %u, minChild %u, maxChild %u\n", thiz->pHeap[minHeapIndex], minHeapIndex, thiz->currSize, minChild, maxChild);
-
-      while ((maxChild) <= thiz->currSize) {
-        if (NW_GTPV2C_TIMER_CMP_P (&(thiz->pHeap[minChild]->tvTimeout), &(thiz->pHeap[maxChild]->tvTimeout), >))
-          minChild = maxChild;
-
-        if (NW_GTPV2C_TIMER_CMP_P (&(pTimerEvent->tvTimeout), &(thiz->pHeap[minChild]->tvTimeout), <)) {
-          break;
-        }
-
-        thiz->pHeap[holeIndex] = thiz->pHeap[minChild];
-        thiz->pHeap[holeIndex]->timerMinHeapIndex = holeIndex;
-        holeIndex = minChild;
-        minChild = (2 * holeIndex) + 1;
-        maxChild = minChild + 1;
-      }
-
-      while ((holeIndex > 0) && NW_GTPV2C_TIMER_CMP_P (&((thiz->pHeap[NW_HEAP_PARENT_INDEX (holeIndex)])->tvTimeout), &(pTimerEvent->tvTimeout), >)) {
-        thiz->pHeap[holeIndex] = thiz->pHeap[NW_HEAP_PARENT_INDEX (holeIndex)];
-        thiz->pHeap[holeIndex]->timerMinHeapIndex = holeIndex;
-        holeIndex = NW_HEAP_PARENT_INDEX (holeIndex);
-      }
-
-      if (holeIndex < thiz->currSize) {
-        thiz->pHeap[holeIndex] = pTimerEvent;
-        pTimerEvent->timerMinHeapIndex = holeIndex;
-      }
-
-      thiz->pHeap[thiz->currSize] = NULL;
-      return NW_OK;
-    }
-
-    return NW_FAILURE;
-  }
-
-  static nw_gtpv2c_timeout_info_t            *nwGtpv2cTmrMinHeapPeek (
-  NwGtpv2cTmrMinHeapT * thiz) {
-    if (thiz->currSize) {
-      //printf("- Peek Returning %p at index %u(%u)\n", thiz->pHeap[0], thiz->pHeap[0]->timerMinHeapIndex, thiz->currSize);
-      return thiz->pHeap[0];
-    }
-
-    return NULL;
-  }
 /*--------------------------------------------------------------------------*
                       P R I V A T E    F U N C T I O N S
   --------------------------------------------------------------------------*/
@@ -255,128 +109,386 @@ extern                                  "C" {
   }
 
 /*---------------------------------------------------------------------------
-   Tunnel RBTree Search Data Structure
+   Tunnel and Transaction Map Data Structure
   --------------------------------------------------------------------------*/
 
-/**
-  Comparator funtion for comparing two sequence number transactions.
+#define NW_GTPV2C_OBJ_MAP_KEY(__hi, __addr)     ((((uint64_t) (__hi)) << 32) | (uint32_t) (__addr).s_addr)
+
+  static inline uint32_t                  nwGtpv2cObjMapHash (
+  uint64_t key,
+  uint32_t keyExt) {
+    key ^= ((uint64_t) keyExt) << 40;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (uint32_t) key;
+  }
 
-  @param[in] a: Pointer to session a.
-  @param[in] b: Pointer to session b.
-  @return  An integer greater than, equal to or less than zero according to whether the
-  object pointed to by a is greater than, equal to or less than the object pointed to by b.
-*/
+  static nw_rc_t                            nwGtpv2cObjMapInit (
+  nw_gtpv2c_obj_map_t * thiz,
+  uint32_t size) {
+    thiz->pEntry = (nw_gtpv2c_obj_map_entry_t *) calloc (size, sizeof (nw_gtpv2c_obj_map_entry_t));
+
+    if (!thiz->pEntry)
+      return NW_FAILURE;
+
+    thiz->mask = size - 1;
+    thiz->count = 0;
+    return NW_OK;
+  }
+
+  static void                             nwGtpv2cObjMapDestroy (
+  nw_gtpv2c_obj_map_t * thiz) {
+    free_wrapper ((void**)&thiz->pEntry);
+    thiz->mask = 0;
+    thiz->count = 0;
+  }
 
-  static inline int32_t                    nwGtpv2cCompareTunnel (
-  struct nw_gtpv2c_tunnel_s *a,
-  struct nw_gtpv2c_tunnel_s *b) {
-    if (a->teid > b->teid)
-      return 1;
+  static nw_rc_t                            nwGtpv2cObjMapGrow (
+  nw_gtpv2c_obj_map_t * thiz) {
+    nw_gtpv2c_obj_map_t                       newMap;
+    uint32_t                                i,
+                                            j;
+
+    if (nwGtpv2cObjMapInit (&newMap, (thiz->mask + 1) << 1) != NW_OK)
+      return NW_FAILURE;
 
-    if (a->teid < b->teid)
-      return -1;
+    for (i = 0; i <= thiz->mask; i++) {
+      if (thiz->pEntry[i].pObj) {
+        j = nwGtpv2cObjMapHash (thiz->pEntry[i].key, thiz->pEntry[i].keyExt) & newMap.mask;
 
-    if (a->ipv4AddrRemote.s_addr > b->ipv4AddrRemote.s_addr)
-      return 1;
+        while (newMap.pEntry[j].pObj)
+          j = (j + 1) & newMap.mask;
 
-    if (a->ipv4AddrRemote.s_addr < b->ipv4AddrRemote.s_addr)
-      return -1;
+        newMap.pEntry[j] = thiz->pEntry[i];
+      }
+    }
 
-    return 0;
+    newMap.count = thiz->count;
+    free_wrapper ((void**)&thiz->pEntry);
+    *thiz = newMap;
+    return NW_OK;
   }
 
-  RB_GENERATE (NwGtpv2cTunnelMap, nw_gtpv2c_tunnel_s, tunnelMapRbtNode, nwGtpv2cCompareTunnel)
+/**
+  Find the object recorded with a key.
+
+  @return The object, NULL if none.
+*/
+  static inline void                     *nwGtpv2cObjMapFind (
+  nw_gtpv2c_obj_map_t * thiz,
+  uint64_t key,
+  uint32_t keyExt) {
+    uint32_t                                i = nwGtpv2cObjMapHash (key, keyExt) & thiz->mask;
+
+    while (thiz->pEntry[i].pObj) {
+      if ((thiz->pEntry[i].key == key) && (thiz->pEntry[i].keyExt == keyExt))
+        return thiz->pEntry[i].pObj;
+
+      i = (i + 1) & thiz->mask;
+    }
+
+    return NULL;
+  }
 
-/*---------------------------------------------------------------------------
-   Transaction RBTree Search Data Structure
-  --------------------------------------------------------------------------*/
 /**
-  Comparator funtion for comparing two outstancing TX transactions.
+  Record an object with a key, unless the key is already used.
 
-  @param[in] a: Pointer to session a.
-  @param[in] b: Pointer to session b.
-  @return  An integer greater than, equal to or less than zero according to whether the
-  object pointed to by a is greater than, equal to or less than the object pointed to by b.
+  @return The object already recorded with the key, NULL if pObj was inserted.
 */
-  static inline int32_t                    nwGtpv2cCompareOutstandingTxSeqNumTrxn (
-  struct nw_gtpv2c_trxn_s *a,
-  struct nw_gtpv2c_trxn_s *b) {
-    if (a->seqNum > b->seqNum)
-      return 1;
+  static void                            *nwGtpv2cObjMapInsert (
+  nw_gtpv2c_obj_map_t * thiz,
+  uint64_t key,
+  uint32_t keyExt,
+  void *pObj) {
+    uint32_t                                i;
+
+    if (((thiz->count + 1) << 1) > (thiz->mask + 1)) {
+      if (nwGtpv2cObjMapGrow (thiz) != NW_OK) {
+        AssertFatal (thiz->count + 1 < thiz->mask + 1, "Cannot grow gtpv2c map of %u objects\n", thiz->count);
+        OAILOG_WARNING (LOG_GTPV2C, "Cannot grow gtpv2c map of %u objects\n", thiz->count);
+      }
+    }
 
-    if (a->seqNum < b->seqNum)
-      return -1;
+    i = nwGtpv2cObjMapHash (key, keyExt) & thiz->mask;
 
-    if (a->peerIp.s_addr > b->peerIp.s_addr)
-      return 1;
+    while (thiz->pEntry[i].pObj) {
+      if ((thiz->pEntry[i].key == key) && (thiz->pEntry[i].keyExt == keyExt))
+        return thiz->pEntry[i].pObj;
 
-    if (a->peerIp.s_addr < b->peerIp.s_addr)
-      return -1;
+      i = (i + 1) & thiz->mask;
+    }
 
-    return 0;
+    thiz->pEntry[i].key = key;
+    thiz->pEntry[i].keyExt = keyExt;
+    thiz->pEntry[i].pObj = pObj;
+    thiz->count++;
+    return NULL;
   }
 
-  RB_GENERATE (NwGtpv2cOutstandingTxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingTxSeqNumMapRbtNode, nwGtpv2cCompareOutstandingTxSeqNumTrxn)
-
 /**
-  Comparator funtion for comparing outstanding RX transactions.
+  Remove an object recorded with a key. The entries following it in the
+  cluster are moved back to the hole when this does not take them before
+  their home slot.
 
-  @param[in] a: Pointer to session a.
-  @param[in] b: Pointer to session b.
-  @return  An integer greater than, equal to or less than zero according to whether the
-  object pointed to by a is greater than, equal to or less than the object pointed to by b.
+  @return pObj, NULL if it was not recorded with this key.
 */
-  static inline int32_t                    nwGtpv2cCompareOutstandingRxSeqNumTrxn (
-  struct nw_gtpv2c_trxn_s *a,
-  struct nw_gtpv2c_trxn_s *b) {
-    if (a->seqNum > b->seqNum)
-      return 1;
+  static void                            *nwGtpv2cObjMapRemove (
+  nw_gtpv2c_obj_map_t * thiz,
+  uint64_t key,
+  uint32_t keyExt,
+  void *pObj) {
+    uint32_t                                i = nwGtpv2cObjMapHash (key, keyExt) & thiz->mask,
+                                            j,
+                                            home;
+
+    while (thiz->pEntry[i].pObj != pObj) {
+      if (!thiz->pEntry[i].pObj)
+        return NULL;
+
+      i = (i + 1) & thiz->mask;
+    }
 
-    if (a->seqNum < b->seqNum)
-      return -1;
+    for (j = (i + 1) & thiz->mask; thiz->pEntry[j].pObj; j = (j + 1) & thiz->mask) {
+      home = nwGtpv2cObjMapHash (thiz->pEntry[j].key, thiz->pEntry[j].keyExt) & thiz->mask;
 
-    if (a->peerIp.s_addr > b->peerIp.s_addr)
-      return 1;
+      if (((j - home) & thiz->mask) >= ((j - i) & thiz->mask)) {
+        thiz->pEntry[i] = thiz->pEntry[j];
+        i = j;
+      }
+    }
+
+    thiz->pEntry[i].pObj = NULL;
+    thiz->count--;
+    return pObj;
+  }
 
-    if (a->peerIp.s_addr < b->peerIp.s_addr)
-      return -1;
+  static inline nw_gtpv2c_tunnel_t        *nwGtpv2cTunnelMapInsert (
+  nw_gtpv2c_stack_t * thiz,
+  nw_gtpv2c_tunnel_t * pTunnel) {
+    return (nw_gtpv2c_tunnel_t *) nwGtpv2cObjMapInsert (&thiz->tunnelMap, NW_GTPV2C_OBJ_MAP_KEY (pTunnel->teid, pTunnel->ipv4AddrRemote), 0, pTunnel);
+  }
 
-    if (a->peerPort > b->peerPort)
-      return 1;
+  static inline nw_gtpv2c_tunnel_t        *nwGtpv2cTunnelMapFind (
+  nw_gtpv2c_stack_t * thiz,
+  uint32_t teid,
+  struct in_addr *ipv4Remote) {
+    return (nw_gtpv2c_tunnel_t *) nwGtpv2cObjMapFind (&thiz->tunnelMap, NW_GTPV2C_OBJ_MAP_KEY (teid, *ipv4Remote), 0);
+  }
 
-    if (a->peerPort < b->peerPort)
-      return -1;
+  static inline nw_gtpv2c_tunnel_t        *nwGtpv2cTunnelMapRemove (
+  nw_gtpv2c_stack_t * thiz,
+  nw_gtpv2c_tunnel_t * pTunnel) {
+    return (nw_gtpv2c_tunnel_t *) nwGtpv2cObjMapRemove (&thiz->tunnelMap, NW_GTPV2C_OBJ_MAP_KEY (pTunnel->teid, pTunnel->ipv4AddrRemote), 0, pTunnel);
+  }
 
-    return 0;
+  static inline nw_gtpv2c_trxn_t          *nwGtpv2cOutstandingTxTrxnFind (
+  nw_gtpv2c_stack_t * thiz,
+  uint32_t seqNum,
+  struct in_addr *peerIp) {
+    return (nw_gtpv2c_trxn_t *) nwGtpv2cObjMapFind (&thiz->outstandingTxSeqNumMap, NW_GTPV2C_OBJ_MAP_KEY (seqNum, *peerIp), 0);
   }
 
-  RB_GENERATE (NwGtpv2cOutstandingRxSeqNumTrxnMap, nw_gtpv2c_trxn_s, outstandingRxSeqNumMapRbtNode, nwGtpv2cCompareOutstandingRxSeqNumTrxn)
+  static inline nw_gtpv2c_trxn_t          *nwGtpv2cOutstandingRxTrxnFind (
+  nw_gtpv2c_stack_t * thiz,
+  uint32_t seqNum,
+  struct in_addr *peerIp,
+  uint32_t peerPort) {
+    return (nw_gtpv2c_trxn_t *) nwGtpv2cObjMapFind (&thiz->outstandingRxSeqNumMap, NW_GTPV2C_OBJ_MAP_KEY (seqNum, *peerIp), peerPort);
+  }
 
 /*---------------------------------------------------------------------------
-   Timer RB-tree data structure.
+   Timer Wheel Data Structure
   --------------------------------------------------------------------------*/
+
+  static inline uint64_t                  nwGtpv2cTmrNowUsec (
+  void) {
+    struct timeval                          tv = {0};
+
+    gettimeofday (&tv, NULL);
+    return ((uint64_t) tv.tv_sec * 1000000) + tv.tv_usec;
+  }
+
 /**
-  Comparator funtion for comparing two outstancing TX transactions.
+  Offset from the current tick of the first non empty slot within span slots,
+  span if there is none.
+*/
+  static uint32_t                         nwGtpv2cTmrWheelNextSlot (
+  nw_gtpv2c_tmr_wheel_t * thiz,
+  uint32_t span) {
+    uint32_t                                slot = thiz->currTick & NW_GTPV2C_TMR_WHEEL_SLOT_MASK;
+    uint32_t                                offset = 0;
+    uint64_t                                bits;
+
+    while (offset < span) {
+      bits = thiz->slotMap[slot >> 6] >> (slot & 63);
+
+      if (bits) {
+        offset += __builtin_ctzll (bits);
+        return (offset < span) ? offset : span;
+      }
+
+      offset += 64 - (slot & 63);
+      slot = (slot + 64 - (slot & 63)) & NW_GTPV2C_TMR_WHEEL_SLOT_MASK;
+    }
+
+    return span;
+  }
 
-  @param[in] a: Pointer to session a.
-  @param[in] b: Pointer to session b.
-  @return  An integer greater than, equal to or less than zero according to whether the
-  object pointed to by a is greater than, equal to or less than the object pointed to by b.
+  static inline void                      nwGtpv2cTmrWheelLink (
+  nw_gtpv2c_tmr_wheel_t * thiz,
+  nw_gtpv2c_timeout_info_t * timeoutInfo) {
+    uint32_t                                slot = timeoutInfo->expiryTick & NW_GTPV2C_TMR_WHEEL_SLOT_MASK;
+
+    timeoutInfo->next = thiz->pSlot[slot];
+
+    if (timeoutInfo->next)
+      timeoutInfo->next->pprev = &timeoutInfo->next;
+
+    timeoutInfo->pprev = &thiz->pSlot[slot];
+    thiz->pSlot[slot] = timeoutInfo;
+    thiz->slotMap[slot >> 6] |= (UINT64_C(1) << (slot & 63));
+  }
+
+/**
+  Unlink a timer from its slot, or from the list of expired timers being fired.
 */
-  static inline int32_t                    nwGtpv2cCompareOutstandingTxRexmitTime (
-  struct nw_gtpv2c_timeout_info_s *a,
-  struct nw_gtpv2c_timeout_info_s *b) {
-    if (NW_GTPV2C_TIMER_CMP_P (&a->tvTimeout, &b->tvTimeout, >))
-      return 1;
+  static inline void                      nwGtpv2cTmrWheelUnlink (
+  nw_gtpv2c_tmr_wheel_t * thiz,
+  nw_gtpv2c_timeout_info_t * timeoutInfo) {
+    uint32_t                                slot = timeoutInfo->expiryTick & NW_GTPV2C_TMR_WHEEL_SLOT_MASK;
+
+    if (timeoutInfo->next)
+      timeoutInfo->next->pprev = timeoutInfo->pprev;
 
-    if (NW_GTPV2C_TIMER_CMP_P (&a->tvTimeout, &b->tvTimeout, <))
-      return -1;
+    *timeoutInfo->pprev = timeoutInfo->next;
+    timeoutInfo->pprev = NULL;
 
-    return 0;
+    if (!thiz->pSlot[slot])
+      thiz->slotMap[slot >> 6] &= ~(UINT64_C(1) << (slot & 63));
   }
 
-  RB_GENERATE (NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s, activeTimerListRbtNode, nwGtpv2cCompareOutstandingTxRexmitTime)
+/**
+  Fire the timers of the wheel expired at nowTick.
+
+  @return The return code of the last timeout callback.
+*/
+  static nw_rc_t                            nwGtpv2cTmrWheelExpire (
+  nw_gtpv2c_stack_t * thiz,
+  uint64_t nowTick) {
+    nw_rc_t                                   rc = NW_OK;
+    nw_gtpv2c_tmr_wheel_t                     *pWheel = &thiz->tmrWheel;
+    nw_gtpv2c_timeout_info_t                   *timeoutInfo = NULL,
+                                           *pNext = NULL,
+                                           *pExpired = NULL;
+    uint64_t                                tick = 0;
+    uint32_t                                span = 0,
+                                            offset = 0;
+
+    pWheel->processing = true;
+
+    while (pWheel->count && (pWheel->currTick <= nowTick)) {
+      span = ((nowTick - pWheel->currTick) < NW_GTPV2C_TMR_WHEEL_SLOTS) ? (uint32_t) (nowTick - pWheel->currTick) + 1 : NW_GTPV2C_TMR_WHEEL_SLOTS;
+      offset = nwGtpv2cTmrWheelNextSlot (pWheel, span);
+
+      if (offset == span)
+        break;
+
+      tick = pWheel->currTick + offset;
+      pWheel->currTick = tick + 1;
+
+      /*
+       * Timers of a later turn stay in the slot, the expired ones are moved to
+       * a list where they can still be stopped by the callbacks fired before them.
+       */
+      for (timeoutInfo = pWheel->pSlot[tick & NW_GTPV2C_TMR_WHEEL_SLOT_MASK]; timeoutInfo; timeoutInfo = pNext) {
+        pNext = timeoutInfo->next;
 
+        if (timeoutInfo->expiryTick <= nowTick) {
+          nwGtpv2cTmrWheelUnlink (pWheel, timeoutInfo);
+          timeoutInfo->next = pExpired;
+
+          if (pExpired)
+            pExpired->pprev = &timeoutInfo->next;
+
+          timeoutInfo->pprev = &pExpired;
+          pExpired = timeoutInfo;
+        }
+      }
+
+      while ((timeoutInfo = pExpired) != NULL) {
+        nwGtpv2cTmrWheelUnlink (pWheel, timeoutInfo);
+        pWheel->count--;
+        timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
+        gpGtpv2cTimeoutInfoPool = timeoutInfo;
+        rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
+      }
+    }
+
+    if (pWheel->currTick <= nowTick)
+      pWheel->currTick = nowTick + 1;
+
+    pWheel->processing = false;
+    return rc;
+  }
+
+/**
+  Start the ULP timer for the first non empty slot of the wheel.
+*/
+  static nw_rc_t                            nwGtpv2cTmrWheelArm (
+  nw_gtpv2c_stack_t * thiz,
+  uint64_t nowUsec) {
+    nw_rc_t                                   rc = NW_OK;
+    nw_gtpv2c_tmr_wheel_t                     *pWheel = &thiz->tmrWheel;
+    nw_gtpv2c_timeout_info_t                   *timeoutInfo = NULL;
+    uint64_t                                expiryUsec = 0,
+                                            delayUsec = 0;
+
+    if (!pWheel->count)
+      return NW_OK;
+
+    if (gpGtpv2cTimeoutInfoPool) {
+      timeoutInfo = gpGtpv2cTimeoutInfoPool;
+      gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
+    } else {
+      NW_GTPV2C_MALLOC (thiz, sizeof (nw_gtpv2c_timeout_info_t), timeoutInfo, nw_gtpv2c_timeout_info_t *);
+    }
+
+    if (!timeoutInfo)
+      return NW_FAILURE;
+
+    timeoutInfo->hStack = (nw_gtpv2c_stack_handle_t) thiz;
+    timeoutInfo->tmrType = NW_GTPV2C_TMR_TYPE_ONE_SHOT;
+    timeoutInfo->timeoutArg = NULL;
+    timeoutInfo->timeoutCallbackFunc = NULL;
+    timeoutInfo->pprev = NULL;
+    timeoutInfo->expiryTick = pWheel->currTick + nwGtpv2cTmrWheelNextSlot (pWheel, NW_GTPV2C_TMR_WHEEL_SLOTS);
+    expiryUsec = timeoutInfo->expiryTick * NW_GTPV2C_TMR_WHEEL_TICK_USEC;
+    delayUsec = (expiryUsec > nowUsec) ? expiryUsec - nowUsec : 0;
+    rc = thiz->tmrMgr.tmrStartCallback (thiz->tmrMgr.tmrMgrHandle, delayUsec / 1000000, delayUsec % 1000000, timeoutInfo->tmrType, (void *)timeoutInfo, &timeoutInfo->hTimer);
+    NW_ASSERT (NW_OK == rc);
+    OAILOG_DEBUG (LOG_GTPV2C, "Started timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
+    thiz->activeTimerInfo = timeoutInfo;
+    return rc;
+  }
+
+/**
+  Stop the ULP timer of the wheel.
+*/
+  static nw_rc_t                            nwGtpv2cTmrWheelDisarm (
+  nw_gtpv2c_stack_t * thiz) {
+    nw_rc_t                                   rc = NW_OK;
+    nw_gtpv2c_timeout_info_t                   *timeoutInfo = thiz->activeTimerInfo;
+
+    OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
+    rc = thiz->tmrMgr.tmrStopCallback (thiz->tmrMgr.tmrMgrHandle, timeoutInfo->hTimer);
+    thiz->activeTimerInfo = NULL;
+    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
+    gpGtpv2cTimeoutInfoPool = timeoutInfo;
+    return rc;
+  }
 
 
 /**
@@ -484,7 +596,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
     pTunnel = nwGtpv2cTunnelNew (thiz, teid, ipv4Remote, hUlpTunnel);
 
     if (pTunnel) {
-      pCollision = RB_INSERT (NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
+      pCollision = nwGtpv2cTunnelMapInsert (thiz, pTunnel);
 
       if (pCollision) {
         rc = nwGtpv2cTunnelDelete (thiz, pTunnel);
@@ -517,16 +629,13 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
     char                                    ipv4[INET_ADDRSTRLEN];
 
     OAILOG_FUNC_IN (LOG_GTPV2C);
-    pTunnel = RB_REMOVE (NwGtpv2cTunnelMap, &(thiz->tunnelMap), (nw_gtpv2c_tunnel_t *) hTunnel);
+    pTunnel = nwGtpv2cTunnelMapRemove (thiz, (nw_gtpv2c_tunnel_t *) hTunnel);
     NW_ASSERT (pTunnel == (nw_gtpv2c_tunnel_t *) hTunnel);
     inet_ntop (AF_INET, (void*)&pTunnel->ipv4AddrRemote, ipv4, INET_ADDRSTRLEN);
     OAILOG_DEBUG (LOG_GTPV2C, "Deleting local tunnel with teid '0x%x' and peer IP %s\n", pTunnel->teid, ipv4);
     rc = nwGtpv2cTunnelDelete (thiz, pTunnel);
     NW_ASSERT (NW_OK == rc);
 
-    nw_gtpv2c_tunnel_t *pLocalTunnel_test = RB_MIN (NwGtpv2cTunnelMap, &(thiz->tunnelMap));
-//    DevAssert(!pLocalTunnel_test);
-
     OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
   }
 
@@ -547,8 +656,7 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
   NW_IN nw_gtpv2c_ulp_api_t * pUlpReq) {
     nw_rc_t                                   rc = NW_FAILURE;
     nw_gtpv2c_trxn_t                          *pTrxn = NULL;
-    nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL,
-                                            keyTunnel = {0};
+    nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL;
 
     OAILOG_FUNC_IN (LOG_GTPV2C);
     /*
@@ -560,16 +668,9 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
     if (pTrxn) {
       if (!pUlpReq->u_api_info.initialReqInfo.hTunnel) {
         /** Check if a tunnel already exists depending on the flag. */
-        keyTunnel.teid = pUlpReq->u_api_info.initialReqInfo.teidLocal;
-        keyTunnel.ipv4AddrRemote = pUlpReq->u_api_info.initialReqInfo.peerIp;
-        pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
-
+        pLocalTunnel = nwGtpv2cTunnelMapFind (thiz, pUlpReq->u_api_info.initialReqInfo.teidLocal, &pUlpReq->u_api_info.initialReqInfo.peerIp);
 
         if (!pLocalTunnel) {
-
-          pLocalTunnel = RB_MIN (NwGtpv2cTunnelMap, &(thiz->tunnelMap));
-//          DevAssert(!pLocalTunnel);
-
           OAILOG_WARNING (LOG_GTPV2C,  "Request message received on non-existent teid 0x%x from peer 0x%x received! Discarding.\n", ntohl (pUlpReq->u_api_info.initialReqInfo.teidLocal), htonl (pUlpReq->u_api_info.initialReqInfo.peerIp.s_addr));
           rc = nwGtpv2cCreateLocalTunnel (thiz, pUlpReq->u_api_info.initialReqInfo.teidLocal, &pUlpReq->u_api_info.initialReqInfo.peerIp, pUlpReq->u_api_info.initialReqInfo.hUlpTunnel, &pUlpReq->u_api_info.initialReqInfo.hTunnel);
           NW_ASSERT (NW_OK == rc);
@@ -599,9 +700,9 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
         rc = nwGtpv2cTrxnStartPeerRspWaitTimer (pTrxn);
         NW_ASSERT (NW_OK == rc);
         /*
-         * Insert into search tree
+         * Insert into outstanding transaction map
          */
-        pTrxn = RB_INSERT (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), pTrxn);
+        pTrxn = nwGtpv2cOutstandingTxTrxnInsert (thiz, pTrxn);
         NW_ASSERT (pTrxn == NULL);
       } else {
         rc = nwGtpv2cTrxnDelete (&pTrxn);
@@ -650,9 +751,9 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
         rc = nwGtpv2cTrxnStartPeerRspWaitTimer (pTrxn);
         NW_ASSERT (NW_OK == rc);
         /*
-         * Insert into search tree
+         * Insert into outstanding transaction map
          */
-        RB_INSERT (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), pTrxn);
+        nwGtpv2cOutstandingTxTrxnInsert (thiz, pTrxn);
 
         if (!pUlpReq->u_api_info.triggeredReqInfo.hTunnel) {
           rc = nwGtpv2cCreateLocalTunnel (thiz, pUlpReq->u_api_info.triggeredReqInfo.teidLocal, &pReqTrxn->peerIp,
@@ -699,11 +800,8 @@ static nw_rc_t nwGtpv2cCreateLocalTunnel (
     /** Creating a local tunnel if flag is set. */
     if ((pUlpRsp->apiType & 0xFF000000) == NW_GTPV2C_ULP_API_FLAG_CREATE_LOCAL_TUNNEL) {
       /** Check if there is a local tunnel already existing, if not create a local S10 tunnel. */
-      nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL,
-                                                 keyTunnel = {0};
-      keyTunnel.teid = pUlpRsp->u_api_info.triggeredRspInfo.teidLocal;
-      keyTunnel.ipv4AddrRemote = pReqTrxn->peerIp;
-      pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+      nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL;
+      pLocalTunnel = nwGtpv2cTunnelMapFind (thiz, pUlpRsp->u_api_info.triggeredRspInfo.teidLocal, &pReqTrxn->peerIp);
       if (!pLocalTunnel) {
         OAILOG_WARNING (LOG_GTPV2C,  "Triggered response not containing a tunnel. Creating one for local_teid 0x%x and peer 0x%x!\n", ntohl (pUlpRsp->u_api_info.triggeredRspInfo.teidLocal), htonl (pReqTrxn->peerIp.s_addr));
         rc = nwGtpv2cCreateLocalTunnel (thiz, pUlpRsp->u_api_info.triggeredRspInfo.teidLocal, &pReqTrxn->peerIp, pUlpRsp->u_api_info.triggeredRspInfo.hUlpTunnel, &pUlpRsp->u_api_info.triggeredRspInfo.hTunnel);
@@ -763,7 +861,7 @@ static nw_rc_t nwGtpv2cHandleUlpCreateLocalTunnel (NW_IN nw_gtpv2c_stack_t * thi
                               &pUlpReq->u_api_info.createLocalTunnelInfo.peerIp,
                               pUlpReq->u_api_info.triggeredRspInfo.hUlpTunnel);
   NW_ASSERT (pTunnel);
-  pCollision = RB_INSERT (NwGtpv2cTunnelMap, &(thiz->tunnelMap), pTunnel);
+  pCollision = nwGtpv2cTunnelMapInsert (thiz, pTunnel);
 
   if (pCollision) {
     rc = nwGtpv2cTunnelDelete (thiz, pTunnel);
@@ -900,7 +998,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
         keyTunnel = {0};
     keyTunnel.teid = pUlpReq->u_api_info.findLocalTunnelInfo.teidLocal;
     keyTunnel.ipv4AddrRemote = pUlpReq->u_api_info.findLocalTunnelInfo.peerIp;
-    pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+    pLocalTunnel = nwGtpv2cTunnelMapFind (thiz, keyTunnel.teid, &keyTunnel.ipv4AddrRemote);
     pUlpReq->u_api_info.findLocalTunnelInfo.hTunnel = (nw_gtpv2c_tunnel_handle_t) pLocalTunnel;
 
     if(pLocalTunnel){
@@ -969,8 +1067,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     uint32_t                                seqNum = 0;
     uint32_t                                teidLocal = 0;
     nw_gtpv2c_trxn_t                          *pTrxn = NULL;
-    nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL,
-                                            keyTunnel = {0};
+    nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL;
     nw_gtpv2c_msg_handle_t                      hMsg = 0;
     nw_gtpv2c_ulp_tunnel_handle_t                hUlpTunnel = 0;
     nw_gtpv2c_error_t                          error = {0};
@@ -980,9 +1077,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
     inet_ntop (AF_INET, (void*)peerIp, ipv4, INET_ADDRSTRLEN);
 
     if (teidLocal) {
-      keyTunnel.teid = ntohl (teidLocal);
-      keyTunnel.ipv4AddrRemote.s_addr = peerIp->s_addr;
-      pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+      pLocalTunnel = nwGtpv2cTunnelMapFind (thiz, ntohl (teidLocal), peerIp);
 
       if (!pLocalTunnel) {
         OAILOG_WARNING (LOG_GTPV2C,  "Request message received on non-existent teid 0x%x from peer %s received! Discarding.\n", ntohl (teidLocal), ipv4);
@@ -1036,7 +1131,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
 
     keyTrxn.seqNum = ntohl (*((uint32_t *) (msgBuf + (((*msgBuf) & 0x08) ? 8 : 4)))) >> 8;;
     keyTrxn.peerIp.s_addr = peerIp->s_addr;
-    pTrxn = RB_FIND (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), &keyTrxn);
+    pTrxn = nwGtpv2cOutstandingTxTrxnFind (thiz, keyTrxn.seqNum, &keyTrxn.peerIp);
 
     if (pTrxn) {
       uint32_t                                hUlpTrxn;
@@ -1045,7 +1140,7 @@ static nw_rc_t                            nwGtpv2cHandleUlpFindLocalTunnel (
       hUlpTrxn = pTrxn->hUlpTrxn;
       noDelete = pTrxn->noDelete;
       hUlpTunnel = (pTrxn->hTunnel ? ((nw_gtpv2c_tunnel_t *) (pTrxn->hTunnel))->hUlpTunnel : 0);
-      RB_REMOVE (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(thiz->outstandingTxSeqNumMap), pTrxn);
+      nwGtpv2cOutstandingTxTrxnRemove (thiz, pTrxn);
       rc = nwGtpv2cTrxnDelete (&pTrxn);
       NW_ASSERT (NW_OK == rc);
       NW_ASSERT (msgBuf && msgBufLen);
@@ -1087,8 +1182,7 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
   uint32_t                                seqNum = 0;
   uint32_t                                teidLocal = 0;
   nw_gtpv2c_trxn_t                          *pTrxn = NULL, keyTrxn;
-  nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL,
-      keyTunnel = {0};
+  nw_gtpv2c_tunnel_t                        *pLocalTunnel = NULL;
   nw_gtpv2c_msg_handle_t                      hMsg = 0;
   nw_gtpv2c_ulp_tunnel_handle_t                hUlpTunnel = 0;
   nw_gtpv2c_error_t                          error = {0};
@@ -1098,9 +1192,7 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
   inet_ntop (AF_INET, (void*)peerIp, ipv4, INET_ADDRSTRLEN);
 
   if (teidLocal) {
-    keyTunnel.teid = ntohl (teidLocal);
-    keyTunnel.ipv4AddrRemote.s_addr = peerIp->s_addr;
-    pLocalTunnel = RB_FIND (NwGtpv2cTunnelMap, &(thiz->tunnelMap), &keyTunnel);
+    pLocalTunnel = nwGtpv2cTunnelMapFind (thiz, ntohl (teidLocal), peerIp);
 
     if (!pLocalTunnel) {
       OAILOG_WARNING (LOG_GTPV2C,  "Request message received on non-existent teid 0x%x from peer %s received! Discarding.\n", ntohl (teidLocal), ipv4);
@@ -1116,10 +1208,10 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
   keyTrxn.seqNum = ntohl (*((uint32_t *) (msgBuf + (((*msgBuf) & 0x08) ? 8 : 4)))) >> 8;;
   keyTrxn.peerIp.s_addr = peerIp->s_addr;
   keyTrxn.peerPort = peerPort;
-  pTrxn = RB_FIND (NwGtpv2cOutstandingRxSeqNumTrxnMap, &(thiz->outstandingRxSeqNumMap), &keyTrxn);
+  pTrxn = nwGtpv2cOutstandingRxTrxnFind (thiz, keyTrxn.seqNum, &keyTrxn.peerIp, keyTrxn.peerPort);
 
   if(pTrxn){
-    RB_REMOVE (NwGtpv2cOutstandingRxSeqNumTrxnMap, &(thiz->outstandingRxSeqNumMap), pTrxn); /**< Remove the transaction for the Request. */
+    nwGtpv2cOutstandingRxTrxnRemove (thiz, pTrxn); /**< Remove the transaction for the Request. */
     rc = nwGtpv2cTrxnDelete (&pTrxn);
     NW_ASSERT (NW_OK == rc);
     /** Parse the message. */
@@ -1173,13 +1265,18 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
       thiz->id = (uint32_t) thiz;
       thiz->seqNum = ((uint32_t) thiz) & 0x0000FFFF;
       OAI_GCC_DIAG_ON(pointer-to-int-cast);
-      RB_INIT (&(thiz->tunnelMap));
-      RB_INIT (&(thiz->outstandingTxSeqNumMap));
-      RB_INIT (&(thiz->outstandingRxSeqNumMap));
-      RB_INIT (&(thiz->activeTimerList));
-      OAI_GCC_DIAG_OFF(pointer-to-int-cast);
-      thiz->hTmrMinHeap = (NwPtrT) nwGtpv2cTmrMinHeapNew (10000);
-      OAI_GCC_DIAG_ON(pointer-to-int-cast);
+      if ((nwGtpv2cObjMapInit (&thiz->tunnelMap, NW_GTPV2C_OBJ_MAP_INITIAL_SIZE) != NW_OK)
+          || (nwGtpv2cObjMapInit (&thiz->outstandingTxSeqNumMap, NW_GTPV2C_OBJ_MAP_INITIAL_SIZE) != NW_OK)
+          || (nwGtpv2cObjMapInit (&thiz->outstandingRxSeqNumMap, NW_GTPV2C_OBJ_MAP_INITIAL_SIZE) != NW_OK)) {
+        nwGtpv2cObjMapDestroy (&thiz->tunnelMap);
+        nwGtpv2cObjMapDestroy (&thiz->outstandingTxSeqNumMap);
+        nwGtpv2cObjMapDestroy (&thiz->outstandingRxSeqNumMap);
+        free_wrapper ((void**)&thiz);
+        *hGtpcStackHandle = (nw_gtpv2c_stack_handle_t) 0;
+        return NW_FAILURE;
+      }
+
+      thiz->tmrWheel.currTick = nwGtpv2cTmrNowUsec () / NW_GTPV2C_TMR_WHEEL_TICK_USEC;
       NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_ECHO_RSP);
       /*
        * For S11 interface
@@ -1263,9 +1360,9 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
 //    nwGtpv2cMsgIeParseInfoDelete(((NwGtpv2cStackT*)hGtpcStackHandle)->pGtpv2cMsgIeParseInfo[NW_GTP_IDENTIFICATION_REQ]);
 //    nwGtpv2cMsgIeParseInfoDelete(((NwGtpv2cStackT*)hGtpcStackHandle)->pGtpv2cMsgIeParseInfo[NW_GTP_IDENTIFICATION_RSP]);
 
-    OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-    nwGtpv2cTmrMinHeapDelete((NwGtpv2cTmrMinHeapT*)((nw_gtpv2c_stack_t*)hGtpcStackHandle)->hTmrMinHeap);
-    OAI_GCC_DIAG_ON(int-to-pointer-cast);
+    nwGtpv2cObjMapDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->tunnelMap);
+    nwGtpv2cObjMapDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->outstandingTxSeqNumMap);
+    nwGtpv2cObjMapDestroy (&((nw_gtpv2c_stack_t*)hGtpcStackHandle)->outstandingRxSeqNumMap);
 
     free_wrapper ((void**)&hGtpcStackHandle);
     return NW_OK;
@@ -1395,6 +1492,11 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
       OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
     }
 
+    if (udpDataLen > NW_GTPV2C_MAX_MSG_LEN) {
+      OAILOG_WARNING (LOG_GTPV2C,  "Received message of %u bytes larger than %u! Discarding.\n", udpDataLen, NW_GTPV2C_MAX_MSG_LEN);
+      OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
+    }
+
     if ((ntohs (*((uint16_t *) ((uint8_t *) udpData + 2)))      /* Length */
          +((*((uint8_t *) (udpData)) & 0x08) ? 4 : 0) /* Extra Header length if TEID present */ ) > udpDataLen) {
       OAILOG_WARNING (LOG_GTPV2C,  "Received message with erroneous length of %u against expected length of %u! Discarding\n", udpDataLen, ntohs (*((uint16_t *) ((uint8_t *) udpData + 2))) + ((*((uint8_t *) (udpData)) & 0x08) ? 4 : 0));
@@ -1544,70 +1646,54 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
   }
 
 /**
-   Process Timer timeout Request from Timer ULP Manager
+   Insert a transaction in the outstanding TX transaction map
 */
 
-  nw_rc_t                                   nwGtpv2cProcessTimeoutOld (
-  void *arg) {
-    nw_rc_t                                   rc = NW_FAILURE;
-    nw_gtpv2c_stack_t                         *thiz = NULL;
-    nw_gtpv2c_timeout_info_t                   *timeoutInfo = (nw_gtpv2c_timeout_info_t *) arg;
-    nw_gtpv2c_timeout_info_t                   *pNextTimeoutInfo = NULL;
-    struct timeval                          tv = {0};
-
-    NW_ASSERT (timeoutInfo != NULL);
-    thiz = (nw_gtpv2c_stack_t *) (((nw_gtpv2c_timeout_info_t *) timeoutInfo)->hStack);
-    NW_ASSERT (thiz != NULL);
-    OAILOG_FUNC_IN (LOG_GTPV2C);
-
-    if (thiz->activeTimerInfo == timeoutInfo) {
-      thiz->activeTimerInfo = NULL;
-      RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
-      rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
-    } else {
-      OAILOG_WARNING (LOG_GTPV2C,  "Received timeout event from ULP for non-existent timeoutInfo 0x%p and activeTimer 0x%p!\n", timeoutInfo, thiz->activeTimerInfo);
-      OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
-    }
+  nw_gtpv2c_trxn_t                          *nwGtpv2cOutstandingTxTrxnInsert (
+  nw_gtpv2c_stack_t * thiz,
+  nw_gtpv2c_trxn_t * pTrxn) {
+    return (nw_gtpv2c_trxn_t *) nwGtpv2cObjMapInsert (&thiz->outstandingTxSeqNumMap, NW_GTPV2C_OBJ_MAP_KEY (pTrxn->seqNum, pTrxn->peerIp), 0, pTrxn);
+  }
 
-    NW_ASSERT (gettimeofday (&tv, NULL) == 0);
+/**
+   Insert a transaction in the outstanding RX transaction map
+*/
 
-    for ((timeoutInfo) = RB_MIN (NwGtpv2cActiveTimerList, &(thiz->activeTimerList)); (timeoutInfo) != NULL;) {
-      if (NW_GTPV2C_TIMER_CMP_P (&timeoutInfo->tvTimeout, &tv, >))
-        break;
+  nw_gtpv2c_trxn_t                          *nwGtpv2cOutstandingRxTrxnInsert (
+  nw_gtpv2c_stack_t * thiz,
+  nw_gtpv2c_trxn_t * pTrxn) {
+    return (nw_gtpv2c_trxn_t *) nwGtpv2cObjMapInsert (&thiz->outstandingRxSeqNumMap, NW_GTPV2C_OBJ_MAP_KEY (pTrxn->seqNum, pTrxn->peerIp), pTrxn->peerPort, pTrxn);
+  }
 
-      pNextTimeoutInfo = RB_NEXT (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-      RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
-      rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
-      timeoutInfo = pNextTimeoutInfo;
-    }
+/**
+   Remove a transaction from the outstanding TX transaction map
+*/
 
-    /*
-     * activeTimerInfo may be reset by the timeoutCallbackFunc call above
-     */
-    if (thiz->activeTimerInfo == NULL) {
-      timeoutInfo = RB_MIN (NwGtpv2cActiveTimerList, &(thiz->activeTimerList));
+  nw_gtpv2c_trxn_t                          *nwGtpv2cOutstandingTxTrxnRemove (
+  nw_gtpv2c_stack_t * thiz,
+  nw_gtpv2c_trxn_t * pTrxn) {
+    return (nw_gtpv2c_trxn_t *) nwGtpv2cObjMapRemove (&thiz->outstandingTxSeqNumMap, NW_GTPV2C_OBJ_MAP_KEY (pTrxn->seqNum, pTrxn->peerIp), 0, pTrxn);
+  }
 
-      if (timeoutInfo) {
-        NW_GTPV2C_TIMER_SUB (&timeoutInfo->tvTimeout, &tv, &tv);
-        rc = thiz->tmrMgr.tmrStartCallback (thiz->tmrMgr.tmrMgrHandle, tv.tv_sec, tv.tv_usec, timeoutInfo->tmrType, (void *)timeoutInfo, &timeoutInfo->hTimer);
-        NW_ASSERT (NW_OK == rc);
-        thiz->activeTimerInfo = timeoutInfo;
-      }
-    }
+/**
+   Remove a transaction from the outstanding RX transaction map
+*/
 
-    OAILOG_FUNC_RETURN (LOG_GTPV2C, rc);
+  nw_gtpv2c_trxn_t                          *nwGtpv2cOutstandingRxTrxnRemove (
+  nw_gtpv2c_stack_t * thiz,
+  nw_gtpv2c_trxn_t * pTrxn) {
+    return (nw_gtpv2c_trxn_t *) nwGtpv2cObjMapRemove (&thiz->outstandingRxSeqNumMap, NW_GTPV2C_OBJ_MAP_KEY (pTrxn->seqNum, pTrxn->peerIp), pTrxn->peerPort, pTrxn);
   }
 
+/**
+   Process Timer timeout Request from Timer ULP Manager
+*/
+
   nw_rc_t                                   nwGtpv2cProcessTimeout (
   void *arg) {
     nw_rc_t                                   rc = NW_FAILURE;
     nw_gtpv2c_stack_t                         *thiz = NULL;
     nw_gtpv2c_timeout_info_t                   *timeoutInfo = (nw_gtpv2c_timeout_info_t *) arg;
-    struct timeval                          tv = {0};
 
     NW_ASSERT (timeoutInfo != NULL);
     thiz = (nw_gtpv2c_stack_t *) (timeoutInfo->hStack);
@@ -1616,52 +1702,20 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
 
     if (thiz->activeTimerInfo == timeoutInfo) {
       thiz->activeTimerInfo = NULL;
-      OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-      rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT*)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
-      OAI_GCC_DIAG_ON(int-to-pointer-cast);
       timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
       gpGtpv2cTimeoutInfoPool = timeoutInfo;
-      rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
     } else {
       OAILOG_WARNING (LOG_GTPV2C,  "Received timeout event from ULP for " "non-existent timeoutInfo 0x%p and activeTimer 0x%p!\n", timeoutInfo, thiz->activeTimerInfo);
       OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
     }
 
-    NW_ASSERT (gettimeofday (&tv, NULL) == 0);
-    //printf("------ Start -------\n");
-    OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-    timeoutInfo = nwGtpv2cTmrMinHeapPeek ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap);
-    OAI_GCC_DIAG_ON(int-to-pointer-cast);
-
-    while ((timeoutInfo) != NULL) {
-      if (NW_GTPV2C_TIMER_CMP_P (&timeoutInfo->tvTimeout, &tv, >))
-        break;
-
-      OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-      rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
-      OAI_GCC_DIAG_ON(int-to-pointer-cast);
-      timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = timeoutInfo;
-      rc = ((timeoutInfo)->timeoutCallbackFunc) (timeoutInfo->timeoutArg);
-      OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-      timeoutInfo = nwGtpv2cTmrMinHeapPeek ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap);
-      OAI_GCC_DIAG_ON(int-to-pointer-cast);
-    }
+    rc = nwGtpv2cTmrWheelExpire (thiz, nwGtpv2cTmrNowUsec () / NW_GTPV2C_TMR_WHEEL_TICK_USEC);
 
     /*
-     * activeTimerInfo may be reset by the timeoutCallbackFunc call above
+     * Timers started by the timeout callbacks above are armed here, once
      */
-    if (thiz->activeTimerInfo == NULL) {
-      OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-      timeoutInfo = nwGtpv2cTmrMinHeapPeek ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap);
-      OAI_GCC_DIAG_ON(int-to-pointer-cast);
-
-      if (timeoutInfo) {
-        NW_GTPV2C_TIMER_SUB (&timeoutInfo->tvTimeout, &tv, &tv);
-        rc = thiz->tmrMgr.tmrStartCallback (thiz->tmrMgr.tmrMgrHandle, tv.tv_sec, tv.tv_usec, timeoutInfo->tmrType, (void *)timeoutInfo, &timeoutInfo->hTimer);
-        NW_ASSERT (NW_OK == rc);
-        thiz->activeTimerInfo = timeoutInfo;
-      }
+    if (thiz->tmrWheel.count) {
+      rc = nwGtpv2cTmrWheelArm (thiz, nwGtpv2cTmrNowUsec ());
     }
 
     OAILOG_FUNC_RETURN (LOG_GTPV2C, rc);
@@ -1681,8 +1735,9 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
   void *timeoutCallbackArg,
   nw_gtpv2c_timer_handle_t * phTimer) {
     nw_rc_t                                   rc = NW_OK;
-    struct timeval                          tv = { 0 };
+    nw_gtpv2c_tmr_wheel_t                     *pWheel = &thiz->tmrWheel;
     nw_gtpv2c_timeout_info_t                   *timeoutInfo = NULL;
+    uint64_t                                nowUsec = 0;
 
     OAILOG_FUNC_IN (LOG_GTPV2C);
 
@@ -1698,120 +1753,38 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
       timeoutInfo->timeoutArg = timeoutCallbackArg;
       timeoutInfo->timeoutCallbackFunc = timeoutCallbackFunc;
       timeoutInfo->hStack = (nw_gtpv2c_stack_handle_t) thiz;
-      NW_ASSERT (gettimeofday (&tv, NULL) == 0);
-      NW_ASSERT (gettimeofday (&timeoutInfo->tvTimeout, NULL) == 0);
-      timeoutInfo->tvTimeout.tv_sec = timeoutSec;
-      timeoutInfo->tvTimeout.tv_usec = timeoutUsec;
-      NW_GTPV2C_TIMER_ADD (&tv, &timeoutInfo->tvTimeout, &timeoutInfo->tvTimeout);
-      OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-      rc = nwGtpv2cTmrMinHeapInsert ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap, timeoutInfo);
-      OAI_GCC_DIAG_ON(int-to-pointer-cast);
-#if 0
-
-      do {
-        collision = RB_INSERT (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-
-        if (!collision)
-          break;
-
-        OAILOG_WARNING (LOG_GTPV2C,  "timer collision!\n");
-        timeoutInfo->tvTimeout.tv_usec++;       /* HACK: In case there is a collision, schedule this event 1 usec later */
-
-        if (timeoutInfo->tvTimeout.tv_usec > (999999 /*1000000 - 1 */ )) {
-          timeoutInfo->tvTimeout.tv_usec = 0;
-          timeoutInfo->tvTimeout.tv_sec++;
-        }
-      } while (1);
+      nowUsec = nwGtpv2cTmrNowUsec ();
 
-#endif
-
-      if (thiz->activeTimerInfo) {
-        if (NW_GTPV2C_TIMER_CMP_P (&(thiz->activeTimerInfo->tvTimeout), &(timeoutInfo->tvTimeout), >)) {
-//          OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", thiz->activeTimerInfo->hTimer, thiz->activeTimerInfo);
-          rc = thiz->tmrMgr.tmrStopCallback (thiz->tmrMgr.tmrMgrHandle, thiz->activeTimerInfo->hTimer);
-          NW_ASSERT (NW_OK == rc);
-        } else {
-          OAILOG_DEBUG (LOG_GTPV2C, "Already Started timer 0x%" PRIxPTR " for info 0x%p!\n", thiz->activeTimerInfo->hTimer, thiz->activeTimerInfo);
-          *phTimer = (nw_gtpv2c_timer_handle_t) timeoutInfo;
-          OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
-        }
+      /*
+       * An empty wheel may not have turned for a while
+       */
+      if (!pWheel->count && !pWheel->processing && (pWheel->currTick < nowUsec / NW_GTPV2C_TMR_WHEEL_TICK_USEC)) {
+        pWheel->currTick = nowUsec / NW_GTPV2C_TMR_WHEEL_TICK_USEC;
       }
 
-      rc = thiz->tmrMgr.tmrStartCallback (thiz->tmrMgr.tmrMgrHandle, timeoutSec, timeoutUsec, tmrType, (void *)timeoutInfo, &timeoutInfo->hTimer);
-      OAILOG_DEBUG (LOG_GTPV2C, "Started timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-      NW_ASSERT (NW_OK == rc);
-      thiz->activeTimerInfo = timeoutInfo;
-    }
-
-    *phTimer = (nw_gtpv2c_timer_handle_t) timeoutInfo;
-    OAILOG_FUNC_RETURN (LOG_GTPV2C, rc);
-  }
-
-  nw_rc_t                                   nwGtpv2cStartTimerOld (
-  nw_gtpv2c_stack_t * thiz,
-  uint32_t timeoutSec,
-  uint32_t timeoutUsec,
-  uint32_t tmrType,
-  nw_rc_t                                   (*timeoutCallbackFunc) (void *),
-  void *timeoutCallbackArg,
-  nw_gtpv2c_timer_handle_t * phTimer) {
-    nw_rc_t                                   rc = NW_OK;
-    struct timeval                          tv;
-    nw_gtpv2c_timeout_info_t                   *timeoutInfo;
-    nw_gtpv2c_timeout_info_t                   *collision;
-
-    NW_ASSERT (thiz != NULL);
-    OAILOG_FUNC_IN (LOG_GTPV2C);
+      timeoutInfo->expiryTick = (nowUsec + ((uint64_t) timeoutSec * 1000000) + timeoutUsec + NW_GTPV2C_TMR_WHEEL_TICK_USEC - 1) / NW_GTPV2C_TMR_WHEEL_TICK_USEC;
 
-    if (gpGtpv2cTimeoutInfoPool) {
-      timeoutInfo = gpGtpv2cTimeoutInfoPool;
-      gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (thiz, sizeof (nw_gtpv2c_timeout_info_t), timeoutInfo, nw_gtpv2c_timeout_info_t *);
-    }
-
-    if (timeoutInfo) {
-      timeoutInfo->tmrType = tmrType;
-      timeoutInfo->timeoutArg = timeoutCallbackArg;
-      timeoutInfo->timeoutCallbackFunc = timeoutCallbackFunc;
-      timeoutInfo->hStack = (nw_gtpv2c_stack_handle_t) thiz;
-      NW_ASSERT (gettimeofday (&tv, NULL) == 0);
-      NW_ASSERT (gettimeofday (&timeoutInfo->tvTimeout, NULL) == 0);
-      timeoutInfo->tvTimeout.tv_sec = timeoutSec;
-      timeoutInfo->tvTimeout.tv_usec = timeoutUsec;
-      NW_GTPV2C_TIMER_ADD (&tv, &timeoutInfo->tvTimeout, &timeoutInfo->tvTimeout);
-
-      do {
-        collision = RB_INSERT (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-
-        if (!collision)
-          break;
-
-        OAILOG_WARNING (LOG_GTPV2C,  "timer collision!\n");
-        timeoutInfo->tvTimeout.tv_usec++;       /* HACK: In case there is a collision, schedule this event 1 usec later */
+      if (timeoutInfo->expiryTick < pWheel->currTick) {
+        timeoutInfo->expiryTick = pWheel->currTick;
+      }
 
-        if (timeoutInfo->tvTimeout.tv_usec > (999999 /*1000000 - 1 */ )) {
-          timeoutInfo->tvTimeout.tv_usec = 0;
-          timeoutInfo->tvTimeout.tv_sec++;
-        }
-      } while (1);
+      nwGtpv2cTmrWheelLink (pWheel, timeoutInfo);
+      pWheel->count++;
 
-      if (thiz->activeTimerInfo) {
-        if (NW_GTPV2C_TIMER_CMP_P (&(thiz->activeTimerInfo->tvTimeout), &(timeoutInfo->tvTimeout), >)) {
-          OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", thiz->activeTimerInfo->hTimer, thiz->activeTimerInfo);
-          rc = thiz->tmrMgr.tmrStopCallback (thiz->tmrMgr.tmrMgrHandle, thiz->activeTimerInfo->hTimer);
+      /*
+       * While expired timers are fired, the ULP timer is armed afterwards by nwGtpv2cProcessTimeout
+       */
+      if (!pWheel->processing) {
+        if (!thiz->activeTimerInfo) {
+          rc = nwGtpv2cTmrWheelArm (thiz, nowUsec);
+        } else if (thiz->activeTimerInfo->expiryTick > timeoutInfo->expiryTick) {
+          rc = nwGtpv2cTmrWheelDisarm (thiz);
           NW_ASSERT (NW_OK == rc);
+          rc = nwGtpv2cTmrWheelArm (thiz, nowUsec);
         } else {
           OAILOG_DEBUG (LOG_GTPV2C, "Already Started timer 0x%" PRIxPTR " for info 0x%p!\n", thiz->activeTimerInfo->hTimer, thiz->activeTimerInfo);
-          *phTimer = (nw_gtpv2c_timer_handle_t) timeoutInfo;
-          OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
         }
       }
-
-      rc = thiz->tmrMgr.tmrStartCallback (thiz->tmrMgr.tmrMgrHandle, timeoutSec, timeoutUsec, tmrType, (void *)timeoutInfo, &timeoutInfo->hTimer);
-      OAILOG_DEBUG (LOG_GTPV2C, "Started timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-      NW_ASSERT (NW_OK == rc);
-      thiz->activeTimerInfo = timeoutInfo;
     }
 
     *phTimer = (nw_gtpv2c_timer_handle_t) timeoutInfo;
@@ -1825,86 +1798,32 @@ static nw_rc_t                            nwGtpv2cHandleTriggeredAck(
   nw_gtpv2c_stack_t * thiz,
   nw_gtpv2c_timer_handle_t hTimer) {
     nw_rc_t                                   rc = NW_OK;
-    struct timeval                          tv;
+    nw_gtpv2c_tmr_wheel_t                     *pWheel = &thiz->tmrWheel;
     nw_gtpv2c_timeout_info_t                   *timeoutInfo;
 
     NW_ASSERT (thiz != NULL);
     OAILOG_FUNC_IN (LOG_GTPV2C);
     timeoutInfo = (nw_gtpv2c_timeout_info_t *) hTimer;
-    OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-    rc = nwGtpv2cTmrMinHeapRemove ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
-    OAI_GCC_DIAG_ON(int-to-pointer-cast);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-
-    if (thiz->activeTimerInfo == timeoutInfo) {
-      OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-      rc = thiz->tmrMgr.tmrStopCallback (thiz->tmrMgr.tmrMgrHandle, timeoutInfo->hTimer);
-      thiz->activeTimerInfo = NULL;
-      if (NW_OK != rc) {
-        OAILOG_INFO (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p failed!\n", timeoutInfo->hTimer, timeoutInfo);
-      }
-      OAI_GCC_DIAG_OFF(int-to-pointer-cast);
-      timeoutInfo = nwGtpv2cTmrMinHeapPeek ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap);
-      OAI_GCC_DIAG_ON(int-to-pointer-cast);
 
-      if (timeoutInfo) {
-        NW_ASSERT (gettimeofday (&tv, NULL) == 0);
-
-        if (NW_GTPV2C_TIMER_CMP_P (&timeoutInfo->tvTimeout, &tv, <)) {
-          thiz->activeTimerInfo = timeoutInfo;
-          rc = nwGtpv2cProcessTimeout (timeoutInfo);
-          NW_ASSERT (NW_OK == rc);
-        } else {
-          NW_GTPV2C_TIMER_SUB (&timeoutInfo->tvTimeout, &tv, &tv);
-          rc = thiz->tmrMgr.tmrStartCallback (thiz->tmrMgr.tmrMgrHandle, tv.tv_sec, tv.tv_usec, timeoutInfo->tmrType, (void *)timeoutInfo, &timeoutInfo->hTimer);
-          NW_ASSERT (NW_OK == rc);
-          OAILOG_DEBUG (LOG_GTPV2C, "Started timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-          thiz->activeTimerInfo = timeoutInfo;
-        }
-      }
+    if (!timeoutInfo || !timeoutInfo->pprev) {
+      OAILOG_WARNING (LOG_GTPV2C, "Stopping timer for info 0x%p not running!\n", timeoutInfo);
+      OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_FAILURE);
     }
 
-    OAILOG_FUNC_RETURN (LOG_GTPV2C, rc);
-  }
-
-  nw_rc_t                                   nwGtpv2cStopTimerOld (
-  nw_gtpv2c_stack_t * thiz,
-  nw_gtpv2c_timer_handle_t hTimer) {
-    nw_rc_t                                   rc = NW_OK;
-    struct timeval                          tv;
-    nw_gtpv2c_timeout_info_t                   *timeoutInfo;
-
-    NW_ASSERT (thiz != NULL);
-    OAILOG_FUNC_IN (LOG_GTPV2C);
-    timeoutInfo = (nw_gtpv2c_timeout_info_t *) hTimer;
-    RB_REMOVE (NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
+    nwGtpv2cTmrWheelUnlink (pWheel, timeoutInfo);
+    pWheel->count--;
     timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
     gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
 
-    if (thiz->activeTimerInfo == timeoutInfo) {
-      OAILOG_DEBUG (LOG_GTPV2C, "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-      rc = thiz->tmrMgr.tmrStopCallback (thiz->tmrMgr.tmrMgrHandle, timeoutInfo->hTimer);
-      thiz->activeTimerInfo = NULL;
-      NW_ASSERT (NW_OK == rc);
-      timeoutInfo = RB_MIN (NwGtpv2cActiveTimerList, &(thiz->activeTimerList));
-
-      if (timeoutInfo) {
-        NW_ASSERT (gettimeofday (&tv, NULL) == 0);
+    /*
+     * The ULP timer is left running for the remaining timers: it expires at
+     * the latest on the first of them and is then armed for the next one.
+     */
+    if (!pWheel->count && thiz->activeTimerInfo && !pWheel->processing) {
+      rc = nwGtpv2cTmrWheelDisarm (thiz);
 
-        if (NW_GTPV2C_TIMER_CMP_P (&timeoutInfo->tvTimeout, &tv, <)) {
-          thiz->activeTimerInfo = timeoutInfo;
-          rc = nwGtpv2cProcessTimeout (timeoutInfo);
-          NW_ASSERT (NW_OK == rc);
-        } else {
-          NW_GTPV2C_TIMER_SUB (&timeoutInfo->tvTimeout, &tv, &tv);
-          rc = thiz->tmrMgr.tmrStartCallback (thiz->tmrMgr.tmrMgrHandle, tv.tv_sec, tv.tv_usec, timeoutInfo->tmrType, (void *)timeoutInfo, &timeoutInfo->hTimer);
-          NW_ASSERT (NW_OK == rc);
-          OAILOG_DEBUG (LOG_GTPV2C, "Started timer 0x%" PRIxPTR " for info 0x%p!\n", timeoutInfo->hTimer, timeoutInfo);
-          thiz->activeTimerInfo = timeoutInfo;
-        }
+      if (NW_OK != rc) {
+        OAILOG_INFO (LOG_GTPV2C, "Stopping active timer for the timer wheel failed!\n");
       }
     }
 
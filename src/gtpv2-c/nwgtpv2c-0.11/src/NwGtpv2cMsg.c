@@ -58,7 +58,129 @@ extern                                  "C" {
                        P R I V A T E     F U N C T I O N S
   ----------------------------------------------------------------------------*/
 
-  static nw_gtpv2c_msg_t                    *gpGtpv2cMsgPool = NULL;
+#define NW_GTPV2C_MSG_SIZE_CLASSES                              (3)
+#define NW_GTPV2C_MSG_SLAB_OBJECTS                              (32)
+
+/*
+   Message buffer size of the slab size classes. A received message is taken
+   from the smallest class holding the datagram, a built message from the
+   last one as its final length is not known when it is created.
+*/
+  static const uint16_t                   gGtpv2cMsgBufSize[NW_GTPV2C_MSG_SIZE_CLASSES] = { 256, 1024, NW_GTPV2C_MAX_MSG_LEN };
+
+/*
+   Free messages per size class, per thread: the S11 and S10 stacks run in
+   their own task and do not share messages.
+*/
+  static __thread nw_gtpv2c_msg_t          *gpGtpv2cMsgPool[NW_GTPV2C_MSG_SIZE_CLASSES] = { NULL };
+
+  static nw_gtpv2c_msg_t                    *nwGtpv2cMsgAlloc (
+  NW_IN nw_gtpv2c_stack_t * pStack,
+  NW_IN uint32_t msgLen) {
+    nw_gtpv2c_msg_t                           *pMsg = NULL;
+    uint8_t                                 sizeClass = 0;
+
+    while ((sizeClass < NW_GTPV2C_MSG_SIZE_CLASSES) && (msgLen > gGtpv2cMsgBufSize[sizeClass])) {
+      sizeClass++;
+    }
+
+    if (sizeClass == NW_GTPV2C_MSG_SIZE_CLASSES) {
+      OAILOG_ERROR (LOG_GTPV2C, "Cannot create message of %u bytes, maximum is %u!\n", msgLen, NW_GTPV2C_MAX_MSG_LEN);
+      return NULL;
+    }
+
+    if (!gpGtpv2cMsgPool[sizeClass]) {
+      size_t                                  objSize = (sizeof (nw_gtpv2c_msg_t) + gGtpv2cMsgBufSize[sizeClass] + 63) & ~((size_t) 63);
+      uint8_t                                *pSlab = NULL;
+      int                                     i;
+
+      NW_GTPV2C_MALLOC (pStack, objSize * NW_GTPV2C_MSG_SLAB_OBJECTS, pSlab, uint8_t *);
+
+      if (!pSlab) {
+        return NULL;
+      }
+
+      for (i = NW_GTPV2C_MSG_SLAB_OBJECTS - 1; i >= 0; i--) {
+        pMsg = (nw_gtpv2c_msg_t *) (pSlab + i * objSize);
+        pMsg->msgSizeClass = sizeClass;
+        pMsg->next = gpGtpv2cMsgPool[sizeClass];
+        gpGtpv2cMsgPool[sizeClass] = pMsg;
+      }
+    }
+
+    pMsg = gpGtpv2cMsgPool[sizeClass];
+    gpGtpv2cMsgPool[sizeClass] = pMsg->next;
+    nwGtpv2cMsgIeIndexReset (pMsg);
+    return pMsg;
+  }
+
+/*
+   Position of IE type/instance in the IE index of the message, -1 if the
+   message does not hold it.
+*/
+  static int                                nwGtpv2cMsgIeIndexPos (
+  NW_IN nw_gtpv2c_msg_t * thiz,
+  NW_IN uint8_t type,
+  NW_IN uint8_t instance) {
+    int                                     pos;
+
+    if (!(thiz->ieTypeMap[type >> 6] & (1ULL << (type & 63)))) {
+      return -1;
+    }
+
+    for (pos = 0; pos < thiz->ieCount; pos++) {
+      if ((thiz->ieIndex[pos].t == type) && (thiz->ieIndex[pos].i == instance)) {
+        return pos;
+      }
+    }
+
+    return -1;
+  }
+
+/*----------------------------------------------------------------------------*
+                       P R O T E C T E D   F U N C T I O N S
+  ----------------------------------------------------------------------------*/
+
+  void                                      nwGtpv2cMsgIeIndexReset (
+  NW_IN nw_gtpv2c_msg_t * thiz) {
+    memset (thiz->ieTypeMap, 0, sizeof (thiz->ieTypeMap));
+    thiz->ieCount = 0;
+  }
+
+  nw_rc_t                                   nwGtpv2cMsgIeIndexAdd (
+  NW_IN nw_gtpv2c_msg_t * thiz,
+  NW_IN uint8_t type,
+  NW_IN uint8_t instance,
+  NW_IN uint8_t * pIe) {
+    if (nwGtpv2cMsgIeIndexPos (thiz, type, instance) >= 0) {
+      return NW_OK;
+    }
+
+    if (thiz->ieCount == NW_GTPV2C_MSG_IE_INDEX_MAXIMUM) {
+      OAILOG_ERROR (LOG_GTPV2C, "Cannot index IE %u with instance %u, more than %u IEs in msg %u!\n", type, instance, NW_GTPV2C_MSG_IE_INDEX_MAXIMUM, thiz->msgType);
+      return NW_FAILURE;
+    }
+
+    thiz->ieIndex[thiz->ieCount].t = type;
+    thiz->ieIndex[thiz->ieCount].i = instance;
+    thiz->ieIndex[thiz->ieCount].offset = (uint16_t) (pIe - thiz->msgBuf);
+    thiz->ieCount++;
+    thiz->ieTypeMap[type >> 6] |= (1ULL << (type & 63));
+    return NW_OK;
+  }
+
+  uint8_t                                *nwGtpv2cMsgIeIndexFind (
+  NW_IN nw_gtpv2c_msg_t * thiz,
+  NW_IN uint8_t type,
+  NW_IN uint8_t instance) {
+    int                                     pos = nwGtpv2cMsgIeIndexPos (thiz, type, instance);
+
+    if (pos >= 0) {
+      return thiz->msgBuf + thiz->ieIndex[pos].offset;
+    }
+
+    return NULL;
+  }
 
 /*----------------------------------------------------------------------------*
                          P U B L I C   F U N C T I O N S
@@ -76,12 +198,7 @@ extern                                  "C" {
                                             NW_ASSERT (
   pStack);
 
-    if (gpGtpv2cMsgPool) {
-      pMsg = gpGtpv2cMsgPool;
-      gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (pStack, sizeof (nw_gtpv2c_msg_t), pMsg, nw_gtpv2c_msg_t *);
-    }
+    pMsg = nwGtpv2cMsgAlloc (pStack, NW_GTPV2C_MAX_MSG_LEN);
 
     if (pMsg) {
       pMsg->version = NW_GTP_VERSION;
@@ -110,12 +227,7 @@ extern                                  "C" {
 
     NW_ASSERT (pStack);
 
-    if (gpGtpv2cMsgPool) {
-      pMsg = gpGtpv2cMsgPool;
-      gpGtpv2cMsgPool = gpGtpv2cMsgPool->next;
-    } else {
-      NW_GTPV2C_MALLOC (pStack, sizeof (nw_gtpv2c_msg_t), pMsg, nw_gtpv2c_msg_t *);
-    }
+    pMsg = nwGtpv2cMsgAlloc (pStack, bufLen);
 
     if (pMsg) {
       *phMsg = (nw_gtpv2c_msg_handle_t) pMsg;
@@ -148,8 +260,8 @@ extern                                  "C" {
     // warning: unused variable ‘pStack’ [-Wunused-variable]: NwGtpv2cStackT                         *pStack = (NwGtpv2cStackT *) hGtpcStackHandle;
 
     OAILOG_DEBUG (LOG_GTPV2C, "Purging message %" PRIxPTR "!\n", hMsg);
-    ((nw_gtpv2c_msg_t *) hMsg)->next = gpGtpv2cMsgPool;
-    gpGtpv2cMsgPool = (nw_gtpv2c_msg_t *) hMsg;
+    ((nw_gtpv2c_msg_t *) hMsg)->next = gpGtpv2cMsgPool[((nw_gtpv2c_msg_t *) hMsg)->msgSizeClass];
+    gpGtpv2cMsgPool[((nw_gtpv2c_msg_t *) hMsg)->msgSizeClass] = (nw_gtpv2c_msg_t *) hMsg;
     return NW_OK;
   }
 
@@ -466,7 +578,7 @@ extern                                  "C" {
   NW_IN uint8_t instance) {
     nw_gtpv2c_msg_t                           *thiz = (nw_gtpv2c_msg_t *) hMsg;
 
-    if ((nw_gtpv2c_ie_tv1_t *) thiz->pIe[type][instance])
+    if (nwGtpv2cMsgIeIndexFind (thiz, type, instance))
       return true;
 
     return false;
@@ -482,8 +594,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[type][instance]) {
-      pIe = (nw_gtpv2c_ie_tv1_t *) thiz->pIe[type][instance];
+    pIe = (nw_gtpv2c_ie_tv1_t *) nwGtpv2cMsgIeIndexFind (thiz, type, instance);
+
+    if (pIe) {
 
       if (ntohs (pIe->l) != 0x01)
         return NW_GTPV2C_IE_INCORRECT;
@@ -507,8 +620,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[type][instance]) {
-      pIe = (nw_gtpv2c_ie_tv2_t *) thiz->pIe[type][instance];
+    pIe = (nw_gtpv2c_ie_tv2_t *) nwGtpv2cMsgIeIndexFind (thiz, type, instance);
+
+    if (pIe) {
 
       if (ntohs (pIe->l) != 0x02)
         return NW_GTPV2C_IE_INCORRECT;
@@ -532,8 +646,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[type][instance]) {
-      pIe = (nw_gtpv2c_ie_tv4_t *) thiz->pIe[type][instance];
+    pIe = (nw_gtpv2c_ie_tv4_t *) nwGtpv2cMsgIeIndexFind (thiz, type, instance);
+
+    if (pIe) {
 
       if (ntohs (pIe->l) != 0x04)
         return NW_GTPV2C_IE_INCORRECT;
@@ -557,8 +672,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[type][instance]) {
-      pIe = (nw_gtpv2c_ie_tv8_t *) thiz->pIe[type][instance];
+    pIe = (nw_gtpv2c_ie_tv8_t *) nwGtpv2cMsgIeIndexFind (thiz, type, instance);
+
+    if (pIe) {
 
       if (ntohs (pIe->l) != 0x08)
         return NW_GTPV2C_IE_INCORRECT;
@@ -585,8 +701,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[type][instance]) {
-      pIe = (nw_gtpv2c_ie_tlv_t *) thiz->pIe[type][instance];
+    pIe = (nw_gtpv2c_ie_tlv_t *) nwGtpv2cMsgIeIndexFind (thiz, type, instance);
+
+    if (pIe) {
 
       if (ntohs (pIe->l) <= maxLen) {
         if (pVal)
@@ -613,8 +730,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[type][instance]) {
-      pIe = (nw_gtpv2c_ie_tlv_t *) thiz->pIe[type][instance];
+    pIe = (nw_gtpv2c_ie_tlv_t *) nwGtpv2cMsgIeIndexFind (thiz, type, instance);
+
+    if (pIe) {
 
       if (ppVal)
         *ppVal = ((uint8_t *) pIe) + 4;
@@ -640,8 +758,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[NW_GTPV2C_IE_CAUSE][instance]) {
-      pIe = (nw_gtpv2c_ie_tlv_t *) thiz->pIe[NW_GTPV2C_IE_CAUSE][instance];
+    pIe = (nw_gtpv2c_ie_tlv_t *) nwGtpv2cMsgIeIndexFind (thiz, NW_GTPV2C_IE_CAUSE, instance);
+
+    if (pIe) {
       *causeValue = *((uint8_t *) (((uint8_t *) pIe) + 4));
       *flags = *((uint8_t *) (((uint8_t *) pIe) + 5));
 
@@ -668,8 +787,9 @@ extern                                  "C" {
 
     NW_ASSERT (instance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->isIeValid[NW_GTPV2C_IE_FTEID][instance]) {
-      pIe = (nw_gtpv2c_ie_tlv_t *) thiz->pIe[NW_GTPV2C_IE_FTEID][instance];
+    pIe = (nw_gtpv2c_ie_tlv_t *) nwGtpv2cMsgIeIndexFind (thiz, NW_GTPV2C_IE_FTEID, instance);
+
+    if (pIe) {
       uint8_t                                 flags;
       uint8_t                                *pIeValue = ((uint8_t *) pIe) + 4;
 
@@ -902,15 +902,13 @@ extern                                  "C" {
 
     pIeBufStart = (uint8_t *) (pMsg->msgBuf + (flags & 0x08 ? 12 : 8));
     pIeBufEnd = (uint8_t *) (pMsg->msgBuf + pMsg->msgLen);
-    //memset(pMsg->pIe, 0, sizeof(uint8_t*) * (NW_GTPV2C_IE_TYPE_MAXIMUM) * (NW_GTPV2C_IE_INSTANCE_MAXIMUM));
-    memset (pMsg->isIeValid, (false), sizeof (uint8_t) * (NW_GTPV2C_IE_TYPE_MAXIMUM) * (NW_GTPV2C_IE_INSTANCE_MAXIMUM));
+    nwGtpv2cMsgIeIndexReset (pMsg);
 
     while (pIeBufStart < pIeBufEnd) {
       pIe = (nw_gtpv2c_ie_tlv_t *) pIeBufStart;
       ieType = pIe->t;
       ieLength = ntohs (pIe->l);
       ieInstance = pIe->i & 0x0F;
-      NW_ASSERT (NW_GTPV2C_IE_INSTANCE_MAXIMUM >= ieInstance);
       OAILOG_DEBUG (LOG_GTPV2C,  "Received IE %u with instance %u of length %u in msg-type %u!\n", ieType, ieInstance, ieLength, thiz->msgType);
 
       if (pIeBufStart + 4 + ieLength > pIeBufEnd) {
@@ -921,7 +919,7 @@ extern                                  "C" {
         return NW_FAILURE;
       }
 
-      if ((thiz->ieParseInfo[ieType][ieInstance].iePresence)) {
+      if ((NW_GTPV2C_IE_INSTANCE_MAXIMUM >= ieInstance) && (thiz->ieParseInfo[ieType][ieInstance].iePresence)) {
         if ((ieLength < (thiz->ieParseInfo[ieType][ieInstance].ieMinLength))) {
           if (thiz->ieParseInfo[ieType][ieInstance].iePresence == NW_GTPV2C_IE_PRESENCE_OPTIONAL) {
             /*
@@ -938,7 +936,7 @@ extern                                  "C" {
           }
         }
 
-        if (pMsg->isIeValid[ieType][ieInstance] == true) {
+        if (nwGtpv2cMsgIeIndexFind (pMsg, ieType, ieInstance)) {
           /*
            * If an information element is repeated in a GTP signalling
            * message in which repetition of the information element is
@@ -951,8 +949,12 @@ extern                                  "C" {
           continue;
         }
 
-        pMsg->pIe[ieType][ieInstance] = (uint8_t *) pIeBufStart;
-        pMsg->isIeValid[ieType][ieInstance] = true;
+        if (NW_OK != nwGtpv2cMsgIeIndexAdd (pMsg, ieType, ieInstance, pIeBufStart)) {
+          pError->cause = NW_GTPV2C_CAUSE_SYSTEM_FAILURE;
+          pError->offendingIe.type = ieType;
+          pError->offendingIe.instance = ieInstance;
+          return NW_FAILURE;
+        }
 
         if (thiz->ieParseInfo[ieType][ieInstance].pGroupedIeInfo) {
           /*
@@ -981,9 +983,9 @@ extern                                  "C" {
 
     if ((NW_OK == rc) && (mandatoryIeCount != thiz->mandatoryIeCount)) {
       for (ieType = 0; ieType < NW_GTPV2C_IE_TYPE_MAXIMUM; ieType++) {
-        for (ieInstance = 0; ieInstance < NW_GTPV2C_IE_INSTANCE_MAXIMUM; ieInstance++) {
+        for (ieInstance = 0; ieInstance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM; ieInstance++) {
           if (thiz->ieParseInfo[ieType][ieInstance].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY) {
-            if (pMsg->isIeValid[ieType][ieInstance] == false) {
+            if (!nwGtpv2cMsgIeIndexFind (pMsg, ieType, ieInstance)) {
               OAILOG_ERROR (LOG_GTPV2C, "Mandatory IE of type %u and instance %u missing in msg type %u\n", ieType, ieInstance, pMsg->msgType);
               pError->cause = NW_GTPV2C_CAUSE_MANDATORY_IE_MISSING;
               pError->offendingIe.type = ieType;
@@ -31,6 +31,7 @@
    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
   ----------------------------------------------------------------------------*/
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "bstrlib.h"
 
@@ -49,6 +50,37 @@
 extern                                  "C" {
 #endif
 
+/*----------------------------------------------------------------------------*
+                       P R I V A T E     F U N C T I O N S
+  ----------------------------------------------------------------------------*/
+
+/*
+   Position of IE type/instance in the parse info of the parser, -1 if it was
+   not added to the parser.
+*/
+  static int                                nwGtpv2cMsgParserFindIe (
+  NW_IN nw_gtpv2c_msg_parser_t * thiz,
+  NW_IN uint8_t ieType,
+  NW_IN uint8_t ieInstance) {
+    int                                     pos;
+
+    if (!(thiz->ieTypeMap[ieType >> 6] & (1ULL << (ieType & 63)))) {
+      return -1;
+    }
+
+    for (pos = 0; pos < thiz->ieCount; pos++) {
+      if ((thiz->ieParseInfo[pos].ieType == ieType) && (thiz->ieParseInfo[pos].ieInstance == ieInstance)) {
+        return pos;
+      }
+    }
+
+    return -1;
+  }
+
+/*----------------------------------------------------------------------------*
+                         P U B L I C   F U N C T I O N S
+  ----------------------------------------------------------------------------*/
+
 /**
    Allocate a gtpv2c message Parser.
 
@@ -73,7 +105,10 @@ extern                                  "C" {
 
     if                                      (
   thiz) {
-      memset (thiz, 0, sizeof (nw_gtpv2c_msg_parser_t));
+      /*
+       * IE parse info entries are set when the IEs are added
+       */
+      memset (thiz, 0, offsetof (nw_gtpv2c_msg_parser_t, ieParseInfo));
       thiz->msgType = msgType;
       thiz->hStack = hGtpcStackHandle;
       *pthiz = thiz;
@@ -130,19 +165,30 @@ extern                                  "C" {
                             NW_IN uint8_t ieType,
                             NW_IN uint8_t ieInstance,
                             NW_IN uint8_t iePresence, NW_IN nw_rc_t (*ieReadCallback) (uint8_t ieType, uint16_t ieLength, uint8_t ieInstance, uint8_t * ieValue, void *ieReadCallbackArg), NW_IN void *ieReadCallbackArg) {
+    int                                     pos;
+
     NW_ASSERT (thiz);
+    NW_ASSERT (ieInstance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
 
-    if (thiz->ieParseInfo[ieType][ieInstance].iePresence == 0) {
-      NW_ASSERT (ieInstance <= NW_GTPV2C_IE_INSTANCE_MAXIMUM);
-      thiz->ieParseInfo[ieType][ieInstance].ieReadCallback = ieReadCallback;
-      thiz->ieParseInfo[ieType][ieInstance].ieReadCallbackArg = ieReadCallbackArg;
-      thiz->ieParseInfo[ieType][ieInstance].iePresence = iePresence;
+    if (nwGtpv2cMsgParserFindIe (thiz, ieType, ieInstance) >= 0) {
+      OAILOG_ERROR (LOG_GTPV2C, "Cannot add IE to parser for type %u and instance %u. IE info already exists!\n", ieType, ieInstance);
+    } else if (thiz->ieCount == NW_GTPV2C_MSG_PARSER_IE_MAXIMUM) {
+      OAILOG_ERROR (LOG_GTPV2C, "Cannot add IE to parser for type %u and instance %u. More than %u IEs!\n", ieType, ieInstance, NW_GTPV2C_MSG_PARSER_IE_MAXIMUM);
+      return NW_FAILURE;
+    } else {
+      pos = thiz->ieCount++;
+      thiz->ieTypeMap[ieType >> 6] |= (1ULL << (ieType & 63));
+      thiz->ieParseInfo[pos].ieType = ieType;
+      thiz->ieParseInfo[pos].ieInstance = ieInstance;
+      thiz->ieParseInfo[pos].ieReadCallback = ieReadCallback;
+      thiz->ieParseInfo[pos].ieReadCallbackArg = ieReadCallbackArg;
+      thiz->ieParseInfo[pos].iePresence = iePresence;
+      thiz->ieParseInfo[pos].firstInstanceOccurred = false;
+      thiz->ieParseInfo[pos].pIe = NULL;
 
       if (iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY) {
         thiz->mandatoryIeCount++;
       }
-    } else {
-      OAILOG_ERROR (LOG_GTPV2C, "Cannot add IE to parser for type %u and instance %u. IE info already exists!\n", ieType, ieInstance);
     }
 
     return NW_OK;
@@ -153,12 +199,15 @@ extern                                  "C" {
                                NW_IN uint8_t ieType,
                                NW_IN uint8_t ieInstance,
                                NW_IN uint8_t iePresence, NW_IN nw_rc_t (*ieReadCallback) (uint8_t ieType, uint16_t ieLength, uint8_t ieInstance, uint8_t * ieValue, void *ieReadCallbackArg), NW_IN void *ieReadCallbackArg) {
+    int                                     pos;
+
     NW_ASSERT (thiz);
+    pos = nwGtpv2cMsgParserFindIe (thiz, ieType, ieInstance);
 
-    if (thiz->ieParseInfo[ieType][ieInstance].iePresence) {
-      thiz->ieParseInfo[ieType][ieInstance].ieReadCallback = ieReadCallback;
-      thiz->ieParseInfo[ieType][ieInstance].ieReadCallbackArg = ieReadCallbackArg;
-      thiz->ieParseInfo[ieType][ieInstance].iePresence = iePresence;
+    if (pos >= 0) {
+      thiz->ieParseInfo[pos].ieReadCallback = ieReadCallback;
+      thiz->ieParseInfo[pos].ieReadCallbackArg = ieReadCallbackArg;
+      thiz->ieParseInfo[pos].iePresence = iePresence;
     } else {
       OAILOG_ERROR (LOG_GTPV2C, "Cannot update IE info for type %u and instance %u. IE info does not exist!\n", ieType, ieInstance);
     }
@@ -181,18 +230,29 @@ extern                                  "C" {
     uint8_t                                *pIeStart;
     uint8_t                                *pIeEnd;
     uint16_t                                ieLength;
+    uint8_t                                 ieInstance;
+    int                                     pos;
     nw_gtpv2c_msg_t                           *pMsg = (nw_gtpv2c_msg_t *) hMsg;
 
     NW_ASSERT (pMsg);
     flags = *((uint8_t *) (pMsg->msgBuf));
     pIeStart = (uint8_t *) (pMsg->msgBuf + (flags & 0x08 ? 12 : 8));
     pIeEnd = (uint8_t *) (pMsg->msgBuf + pMsg->msgLen);
-    memset (thiz->pIe, 0, sizeof (uint8_t *) * (NW_GTPV2C_IE_TYPE_MAXIMUM) * (NW_GTPV2C_IE_INSTANCE_MAXIMUM));
-    memset (pMsg->pIe, 0, sizeof (uint8_t *) * (NW_GTPV2C_IE_TYPE_MAXIMUM) * (NW_GTPV2C_IE_INSTANCE_MAXIMUM));
+
+    /*
+     * Reset only the IEs of the parser and the IE index of the message
+     */
+    for (pos = 0; pos < thiz->ieCount; pos++) {
+      thiz->ieParseInfo[pos].pIe = NULL;
+      thiz->ieParseInfo[pos].firstInstanceOccurred = false;
+    }
+
+    nwGtpv2cMsgIeIndexReset (pMsg);
 
     while (pIeStart < pIeEnd) {
       pIe = (nw_gtpv2c_ie_tlv_t *) pIeStart;
       ieLength = ntohs (pIe->l);
+      ieInstance = pIe->i & 0x0F;
 
       if (pIeStart + 4 + ieLength > pIeEnd) {
         *pOffendingIeType = pIe->t;
@@ -201,35 +261,37 @@ extern                                  "C" {
         return NW_GTPV2C_MSG_MALFORMED;
       }
 
-      if ((thiz->ieParseInfo[pIe->t][pIe->i].iePresence)) {
-        thiz->pIe[pIe->t][pIe->i] = (uint8_t *) pIeStart;
-        pMsg->pIe[pIe->t][pIe->i] = (uint8_t *) pIeStart;
+      pos = nwGtpv2cMsgParserFindIe (thiz, pIe->t, ieInstance);
+
+      if (pos >= 0) {
+        thiz->ieParseInfo[pos].pIe = (uint8_t *) pIeStart;
+        nwGtpv2cMsgIeIndexAdd (pMsg, pIe->t, ieInstance, pIeStart);
         OAILOG_DEBUG (LOG_GTPV2C,  "Received IE %u of length %u!\n", pIe->t, ieLength);
 
-        if ((thiz->ieParseInfo[pIe->t][pIe->i].ieReadCallback) != NULL) {
-          rc = thiz->ieParseInfo[pIe->t][pIe->i].ieReadCallback (pIe->t, ieLength, pIe->i, pIeStart + 4, thiz->ieParseInfo[pIe->t][pIe->i].ieReadCallbackArg);
+        if ((thiz->ieParseInfo[pos].ieReadCallback) != NULL) {
+          rc = thiz->ieParseInfo[pos].ieReadCallback (pIe->t, ieLength, ieInstance, pIeStart + 4, thiz->ieParseInfo[pos].ieReadCallbackArg);
 
           if (NW_OK == rc) {
-            if (thiz->ieParseInfo[pIe->t][pIe->i].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
-              if(!thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred){
+            if (thiz->ieParseInfo[pos].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
+              if(!thiz->ieParseInfo[pos].firstInstanceOccurred){
                 mandatoryIeCount++;
-                thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred = true;
+                thiz->ieParseInfo[pos].firstInstanceOccurred = true;
               }
             }
           } else {
-            OAILOG_ERROR (LOG_GTPV2C, "Error while parsing IE %u with instance %u and length %u!\n", pIe->t, pIe->i, ieLength);
+            OAILOG_ERROR (LOG_GTPV2C, "Error while parsing IE %u with instance %u and length %u!\n", pIe->t, ieInstance, ieLength);
             break;
           }
         } else {
           if ((thiz->ieReadCallback) != NULL) {
             OAILOG_DEBUG (LOG_GTPV2C,  "Received IE %u of length %u!\n", pIe->t, ieLength);
-            rc = thiz->ieReadCallback (pIe->t, ieLength, pIe->i, pIeStart + 4, thiz->ieReadCallbackArg);
+            rc = thiz->ieReadCallback (pIe->t, ieLength, ieInstance, pIeStart + 4, thiz->ieReadCallbackArg);
 
             if (NW_OK == rc) {
-              if (thiz->ieParseInfo[pIe->t][pIe->i].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
-                if(!thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred){
+              if (thiz->ieParseInfo[pos].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY){
+                if(!thiz->ieParseInfo[pos].firstInstanceOccurred){
                   mandatoryIeCount++;
-                  thiz->ieParseInfo[pIe->t][pIe->i].firstInstanceOccurred = true;
+                  thiz->ieParseInfo[pos].firstInstanceOccurred = true;
                 }
               }
             } else {
@@ -248,21 +310,16 @@ extern                                  "C" {
     }
 
     if ((NW_OK == rc) && (mandatoryIeCount != thiz->mandatoryIeCount)) {
-      uint16_t                                t,
-                                              i;
-
       *pOffendingIeType = 0;
       *pOffendingIeInstance = 0;
       *pOffendingIeLength = 0;
 
-      for (t = 0; t < NW_GTPV2C_IE_TYPE_MAXIMUM; t++) {
-        for (i = 0; i < NW_GTPV2C_IE_INSTANCE_MAXIMUM; i++) {
-          if (thiz->ieParseInfo[t][i].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY) {
-            if (thiz->pIe[t][i] == NULL) {
-              *pOffendingIeType = t;
-              *pOffendingIeInstance = i;
-              return NW_GTPV2C_MANDATORY_IE_MISSING;
-            }
+      for (pos = 0; pos < thiz->ieCount; pos++) {
+        if (thiz->ieParseInfo[pos].iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY) {
+          if (thiz->ieParseInfo[pos].pIe == NULL) {
+            *pOffendingIeType = thiz->ieParseInfo[pos].ieType;
+            *pOffendingIeInstance = thiz->ieParseInfo[pos].ieInstance;
+            return NW_GTPV2C_MANDATORY_IE_MISSING;
           }
         }
       }
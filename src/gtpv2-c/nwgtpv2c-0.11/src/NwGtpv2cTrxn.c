@@ -100,7 +100,7 @@ extern                                  "C" {
       ulpApi.u_api_info.rspFailureInfo.hUlpTunnel = ((thiz->hTunnel) ? ((nw_gtpv2c_tunnel_t *) (thiz->hTunnel))->hUlpTunnel : 0);
       ulpApi.u_api_info.rspFailureInfo.teidLocal = (thiz->hTunnel) ? ((nw_gtpv2c_tunnel_t*)(thiz->hTunnel))->teid: 0;
       OAILOG_ERROR (LOG_GTPV2C, "N3 retries expired for transaction 0x%p\n", thiz);
-      RB_REMOVE (NwGtpv2cOutstandingTxSeqNumTrxnMap, &(pStack->outstandingTxSeqNumMap), thiz);
+      nwGtpv2cOutstandingTxTrxnRemove (pStack, thiz);
       rc = nwGtpv2cTrxnDelete (&thiz);
       rc = pStack->ulp.ulpReqCallback (pStack->ulp.hUlp, &ulpApi);
     }
@@ -120,7 +120,7 @@ extern                                  "C" {
     NW_ASSERT (pStack);
     OAILOG_DEBUG (LOG_GTPV2C,  "Duplicate request hold timer expired for transaction 0x%p\n", thiz);
     thiz->hRspTmr = 0;
-    RB_REMOVE (NwGtpv2cOutstandingRxSeqNumTrxnMap, &(pStack->outstandingRxSeqNumMap), thiz);
+    nwGtpv2cOutstandingRxTrxnRemove (pStack, thiz);
     rc = nwGtpv2cTrxnDelete (&thiz);
     NW_ASSERT (NW_OK == rc);
     return rc;
@@ -285,7 +285,7 @@ extern                                  "C" {
       pTrxn->peerPort = peerPort;
       pTrxn->pMsg = NULL;
       pTrxn->hRspTmr = 0;
-      pCollision = RB_INSERT (NwGtpv2cOutstandingRxSeqNumTrxnMap, &(thiz->outstandingRxSeqNumMap), pTrxn);
+      pCollision = nwGtpv2cOutstandingRxTrxnInsert (thiz, pTrxn);
 
       if (pCollision) {
         OAILOG_WARNING (LOG_GTPV2C,  "Duplicate request message received for seq num 0x%x!\n", (uint32_t) seqNum);
@@ -20,6 +20,7 @@
 #include <stdexcept>
 #include <list>
 #include <string>
+#include <functional>
 
 #include "scassandra.h"
 
@@ -131,6 +132,20 @@ struct DAImsiSec {
    uint8_t opc[KEY_LENGTH];
 };
 
+// completion status of the asynchronous DataAccess methods
+enum DAResult
+{
+   DA_OK,
+   DA_NOT_FOUND,
+   DA_ERROR
+};
+
+// the callbacks are invoked from a Cassandra driver I/O thread, they must not
+// block and must not call the synchronous DataAccess methods
+typedef std::function<void( DAResult rc )> DACallback;
+typedef std::function<void( DAResult rc, std::string &value )> DAStringCallback;
+typedef std::function<void( DAResult rc, DAImsiInfo &info )> DAImsiInfoCallback;
+typedef std::function<void( DAResult rc, DAImsiSec &imsisec )> DAImsiSecCallback;
 
 class DataAccess
 {
@@ -218,7 +233,8 @@ public:
 
    bool getImsiSec ( const std::string &imsi, DAImsiSec &imsisec );
 
-   bool updateRandSqn ( const std::string &imsi, uint8_t * rand_p, uint8_t * sqn );
+   // when incsqn is set, the stored SQN is sqn + 32 as with a following incSqn()
+   bool updateRandSqn ( const std::string &imsi, uint8_t * rand_p, uint8_t * sqn, bool incsqn = false );
 
    bool incSqn ( std::string &imsi, uint8_t * sqn );
 
@@ -241,6 +257,18 @@ public:
    }
 
 
+   //
+   // asynchronous versions of the lookups used by the S6a/S6t/S6c handlers,
+   // they return once the query is sent and report through the callback
+   //
+   void checkImsiExistsAsync( const std::string &imsi, DACallback cb );
+   void getImsiFromMsisdnAsync( int64_t msisdn, DAStringCallback cb );
+   void getMsisdnFromImsiAsync( const std::string &imsi, DAStringCallback cb );
+   void getSubDataFromImsiAsync( const std::string &imsi, DAStringCallback cb );
+   void getImsiInfoAsync( const std::string &imsi, DAImsiInfoCallback cb );
+   void getImsiSecAsync( const std::string &imsi, DAImsiSecCallback cb );
+   void updateRandSqnAsync( const std::string &imsi, uint8_t * rand_p, uint8_t * sqn, bool incsqn, DACallback cb );
+
 //	bool getImsiFromScefIdScefRefId( char *scef_id, uint32_t scef_ref_id, std::string &imsi );
 
 //	bool getScefIdScefRefIdFromImsi( char *imsi, std::string &scef_id, uint32_t &scef_ref_id );
@@ -253,6 +281,8 @@ public:
 // bool isImsiAttached ( const std::string &imsi ) { return isImsiAttached( imsi.c_str() ); }
 
 private:
+   void prepare( const char *query, SCassStatement &stmt );
+   void getStringAsync( const char *column, SCassStatement &stmt, DAStringCallback cb );
 
 	SCassandra m_db;
 };
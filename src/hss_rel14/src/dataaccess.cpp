@@ -55,6 +55,57 @@ void convert_ascii_to_binary(unsigned char *dest, unsigned char *src, int length
 		); \
 }
 
+//
+// queries shared by the synchronous and asynchronous methods, prepared once
+// per session by SCassandra::prepare()
+//
+static const char *CQL_CHECK_IMSI       = "SELECT imsi FROM users_imsi WHERE imsi=?";
+static const char *CQL_IMSI_FROM_MSISDN = "SELECT imsi FROM msisdn_imsi WHERE msisdn = ?";
+static const char *CQL_MSISDN_FROM_IMSI = "SELECT msisdn FROM users_imsi where imsi = ?";
+static const char *CQL_SUB_DATA         = "SELECT subscription_data FROM users_imsi where imsi = ?";
+static const char *CQL_IMSI_INFO        = "SELECT imsi, mmehost, mmerealm, ms_ps_status, subscription_data, msisdn, visited_plmnid, access_restriction, mmeidentity_idmmeidentity FROM users_imsi where imsi = ?";
+static const char *CQL_IMSI_SEC         = "SELECT key,sqn,rand,OPc FROM vhss.users_imsi WHERE imsi=?";
+static const char *CQL_UPDATE_RAND_SQN  = "UPDATE vhss.users_imsi SET rand=?, sqn=? WHERE imsi=?";
+static const char *CQL_UPDATE_SQN       = "UPDATE vhss.users_imsi SET sqn=? WHERE imsi=?";
+
+static void decodeImsiInfo( SCassFuture &future, SCassRow &row, DAImsiInfo &info )
+{
+   GET_EVENT_DATA( row, imsi, info.imsi );
+   GET_EVENT_DATA( row, mmehost, info.mmehost );
+   GET_EVENT_DATA( row, mmerealm, info.mmerealm );
+   GET_EVENT_DATA( row, ms_ps_status, info.ms_ps_status );
+   GET_EVENT_DATA( row, subscription_data, info.subscription_data );
+   GET_EVENT_DATA( row, msisdn, info.msisdn );
+   info.str_msisdn = std::to_string( info.msisdn );
+   GET_EVENT_DATA( row, visited_plmnid, info.visited_plmnid );
+   GET_EVENT_DATA( row, access_restriction, info.access_restriction );
+   GET_EVENT_DATA( row, mmeidentity_idmmeidentity, info.mme_id );
+}
+
+static void decodeImsiSec( SCassFuture &future, SCassRow &row, DAImsiSec &imsisec )
+{
+   std::string key_str;
+   int64_t     sqn_nb;
+   std::string rand_str;
+   std::string OPc_str;
+
+   GET_EVENT_DATA( row, key, key_str );
+   GET_EVENT_DATA( row, sqn, sqn_nb );
+   GET_EVENT_DATA( row, rand, rand_str );
+   GET_EVENT_DATA( row, OPc, OPc_str );
+
+   convert_ascii_to_binary(imsisec.key, (uint8_t *)key_str.c_str(), KEY_LENGTH);
+   convert_ascii_to_binary(imsisec.rand,(uint8_t *)rand_str.c_str(), RAND_LENGTH);
+   convert_ascii_to_binary(imsisec.opc, (uint8_t *)OPc_str.c_str(), KEY_LENGTH);
+
+   imsisec.sqn[0] = (sqn_nb & (255UL << 40)) >> 40;
+   imsisec.sqn[1] = (sqn_nb & (255UL << 32)) >> 32;
+   imsisec.sqn[2] = (sqn_nb & (255UL << 24)) >> 24;
+   imsisec.sqn[3] = (sqn_nb & (255UL << 16)) >> 16;
+   imsisec.sqn[4] = (sqn_nb & (255UL << 8)) >> 8;
+   imsisec.sqn[5] = (sqn_nb & 0xFF);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -134,6 +185,17 @@ void DataAccess::connect()
 						__func__, m_db.host().c_str(), connect_future.errorCode() )
 		);
 	}
+
+	// prepare the queries issued from the asynchronous completions up front,
+	// preparing on a cache miss waits and must not happen on a driver thread
+	const char *queries[] = { CQL_CHECK_IMSI, CQL_IMSI_FROM_MSISDN, CQL_MSISDN_FROM_IMSI,
+		CQL_SUB_DATA, CQL_IMSI_INFO, CQL_IMSI_SEC, CQL_UPDATE_RAND_SQN, CQL_UPDATE_SQN };
+
+	for ( size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++ )
+	{
+		SCassStatement stmt;
+		prepare( queries[i], stmt );
+	}
 }
 
 void DataAccess::disconnect()
@@ -141,6 +203,17 @@ void DataAccess::disconnect()
 	m_db.disconnect();
 }
 
+void DataAccess::prepare( const char *query, SCassStatement &stmt )
+{
+	CassError rc = m_db.prepare( query, stmt );
+
+	if ( rc != CASS_OK )
+		throw DAException(
+				SUtility::string_format( "DataAccess::%s - Error %d preparing [%s]",
+						__func__, rc, query )
+		);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -349,11 +422,10 @@ void DataAccess::deleteEvent( const char *scef_id, uint32_t scef_ref_id )
 
 bool DataAccess::checkMSISDNExists( int64_t msisdn )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT * FROM msisdn_imsi WHERE msisdn=" << msisdn << ";" ;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT * FROM msisdn_imsi WHERE msisdn=?", stmt );
+   stmt.bind( 0, msisdn );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -361,7 +433,7 @@ bool DataAccess::checkMSISDNExists( int64_t msisdn )
    {
       throw DAException(
          SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-         __func__, future.errorCode(), ss.str().c_str() )
+         __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -380,11 +452,10 @@ bool DataAccess::checkMSISDNExists( int64_t msisdn )
 
 bool DataAccess::checkImsiExists( const char *imsi )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT imsi FROM users_imsi WHERE imsi='" << imsi << "';";
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_CHECK_IMSI, stmt );
+   stmt.bind( 0, imsi );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -392,7 +463,7 @@ bool DataAccess::checkImsiExists( const char *imsi )
    {
       throw DAException(
          SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-         __func__, future.errorCode(), ss.str().c_str() )
+         __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -411,11 +482,10 @@ bool DataAccess::checkImsiExists( const char *imsi )
 
 bool DataAccess::checkExtIdExists( const char *extid )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT extid FROM extid WHERE extid = '" << extid << "';" ;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT extid FROM extid WHERE extid = ?", stmt );
+   stmt.bind( 0, extid );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -423,7 +493,7 @@ bool DataAccess::checkExtIdExists( const char *extid )
    {
       throw DAException(
          SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-         __func__, future.errorCode(), ss.str().c_str() )
+         __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -442,11 +512,10 @@ bool DataAccess::checkExtIdExists( const char *extid )
 
 bool DataAccess::getImsiListFromExtId( const char *extid, DAImsiList &imsilst)
 {
-   std::stringstream ss;
-
-   ss << "SELECT imsi FROM extid_imsi WHERE extid ='" << extid << "'";
+   SCassStatement stmt;
 
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT imsi FROM extid_imsi WHERE extid = ?", stmt );
+   stmt.bind( 0, extid );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -454,7 +523,7 @@ bool DataAccess::getImsiListFromExtId( const char *extid, DAImsiList &imsilst)
    {
       throw DAException(
          SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-         __func__, future.errorCode(), ss.str().c_str() )
+         __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -479,11 +548,10 @@ bool DataAccess::getImsiListFromExtId( const char *extid, DAImsiList &imsilst)
 
 bool DataAccess::getExtIdsFromImsi( const char *imsi, DAExtIdList &extids )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT extid FROM extid_imsi_xref WHERE imsi = '" << imsi << "'";
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT extid FROM extid_imsi_xref WHERE imsi = ?", stmt );
+   stmt.bind( 0, imsi );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -491,7 +559,7 @@ bool DataAccess::getExtIdsFromImsi( const char *imsi, DAExtIdList &extids )
    {
       throw DAException(
          SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-         __func__, future.errorCode(), ss.str().c_str() )
+         __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -516,18 +584,17 @@ bool DataAccess::getExtIdsFromImsi( const char *imsi, DAExtIdList &extids )
 
 bool DataAccess::getImsiFromMsisdn( int64_t msisdn, std::string &imsi )
 {
-   std::stringstream ss;
-
-   ss << "SELECT imsi FROM msisdn_imsi WHERE msisdn = " << msisdn;
+   SCassStatement stmt;
 
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_IMSI_FROM_MSISDN, stmt );
+   stmt.bind( 0, msisdn );
 
    SCassFuture future = m_db.execute( stmt );
 
    if ( future.errorCode() != CASS_OK ) {
       throw DAException(
             SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-                  __func__, future.errorCode(), ss.str().c_str() )
+                  __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -545,18 +612,17 @@ bool DataAccess::getImsiFromMsisdn( int64_t msisdn, std::string &imsi )
 
 bool DataAccess::getImsiFromMsisdn( const char *msisdn, std::string &imsi )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT imsi FROM msisdn_imsi WHERE msisdn = " << msisdn;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_IMSI_FROM_MSISDN, stmt );
+   stmt.bind( 0, (int64_t)strtoll( msisdn, NULL, 10 ) );
 
    SCassFuture future = m_db.execute( stmt );
 
    if ( future.errorCode() != CASS_OK ) {
       throw DAException(
             SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-                  __func__, future.errorCode(), ss.str().c_str() )
+                  __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -577,19 +643,17 @@ bool DataAccess::getImsiFromMsisdn( const char *msisdn, std::string &imsi )
 
 bool DataAccess::getMsisdnFromImsi( const char *imsi, std::string &msisdn )
 {
-	std::stringstream ss;
+	SCassStatement stmt;
 
-	ss << "SELECT msisdn FROM users_imsi where imsi = '"
-	   << imsi << "' ;" ;
-
-	SCassStatement stmt( ss.str().c_str() );
+	prepare( CQL_MSISDN_FROM_IMSI, stmt );
+	stmt.bind( 0, imsi );
 
 	SCassFuture future = m_db.execute( stmt );
 
 	if ( future.errorCode() != CASS_OK ){
 		throw DAException(
 			  SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-					  __func__, future.errorCode(), ss.str().c_str() )
+					  __func__, future.errorCode(), stmt.query().c_str() )
 		);
 	}
 
@@ -609,19 +673,17 @@ bool DataAccess::getMsisdnFromImsi( const char *imsi, std::string &msisdn )
 
 bool DataAccess::getMsisdnFromImsi( const char *imsi, int64_t &msisdn )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT msisdn FROM users_imsi where imsi = '"
-      << imsi << "' ;" ;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_MSISDN_FROM_IMSI, stmt );
+   stmt.bind( 0, imsi );
 
    SCassFuture future = m_db.execute( stmt );
 
    if ( future.errorCode() != CASS_OK ){
       throw DAException(
            SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-                 __func__, future.errorCode(), ss.str().c_str() )
+                 __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -644,19 +706,17 @@ bool DataAccess::getMsisdnFromImsi( const char *imsi, int64_t &msisdn )
 
 bool DataAccess::getImsiInfo ( const char *imsi, DAImsiInfo &info )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT imsi, mmehost, mmerealm, ms_ps_status, subscription_data, msisdn, visited_plmnid, access_restriction, mmeidentity_idmmeidentity FROM users_imsi where imsi = '"
-      << imsi << "' ;" ;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_IMSI_INFO, stmt );
+   stmt.bind( 0, imsi );
 
    SCassFuture future = m_db.execute( stmt );
 
    if ( future.errorCode() != CASS_OK ) {
       throw DAException(
             SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-                  __func__, future.errorCode(), ss.str().c_str() )
+                  __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -666,16 +726,7 @@ bool DataAccess::getImsiInfo ( const char *imsi, DAImsiInfo &info )
 
    if ( row.valid() )
    {
-      GET_EVENT_DATA( row, imsi, info.imsi );
-      GET_EVENT_DATA( row, mmehost, info.mmehost );
-      GET_EVENT_DATA( row, mmerealm, info.mmerealm );
-      GET_EVENT_DATA( row, ms_ps_status, info.ms_ps_status );
-      GET_EVENT_DATA( row, subscription_data, info.subscription_data );
-      GET_EVENT_DATA( row, msisdn, info.msisdn );
-      info.str_msisdn = std::to_string( info.msisdn );
-      GET_EVENT_DATA( row, visited_plmnid, info.visited_plmnid );
-      GET_EVENT_DATA( row, access_restriction, info.access_restriction );
-      GET_EVENT_DATA( row, mmeidentity_idmmeidentity, info.mme_id );
+      decodeImsiInfo( future, row, info );
       return true;
    }
 
@@ -688,11 +739,10 @@ bool DataAccess::getImsiInfo ( const char *imsi, DAImsiInfo &info )
 
 void DataAccess::getEventIdsFromMsisdn( int64_t msisdn, DAEventIdList &eil )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT scef_id, scef_ref_id FROM events_msisdn WHERE msisdn = " << msisdn;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT scef_id, scef_ref_id FROM events_msisdn WHERE msisdn = ?", stmt );
+   stmt.bind( 0, msisdn );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -700,7 +750,7 @@ void DataAccess::getEventIdsFromMsisdn( int64_t msisdn, DAEventIdList &eil )
    {
       throw DAException(
          SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-         __func__, future.errorCode(), ss.str().c_str() )
+         __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -725,11 +775,10 @@ void DataAccess::getEventIdsFromMsisdn( int64_t msisdn, DAEventIdList &eil )
 
 void DataAccess::getEventIdsFromExtId( const char *extid, DAEventIdList &eil )
 {
-   std::stringstream ss;
-
-   ss << "SELECT scef_id, scef_ref_id FROM events_extid WHERE extid = '" << extid << "'";
+   SCassStatement stmt;
 
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT scef_id, scef_ref_id FROM events_extid WHERE extid = ?", stmt );
+   stmt.bind( 0, extid );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -737,7 +786,7 @@ void DataAccess::getEventIdsFromExtId( const char *extid, DAEventIdList &eil )
    {
       throw DAException(
          SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-         __func__, future.errorCode(), ss.str().c_str() )
+         __func__, future.errorCode(), stmt.query().c_str() )
       );
    }
 
@@ -876,18 +925,18 @@ bool DataAccess::purgeUE ( std::string &imsi )
    if (imsi.empty())
       return false;
 
-   std::stringstream ss;
-   ss << "UPDATE vhss.users_imsi SET ms_ps_status='PURGED' WHERE imsi='" << imsi << "';";
-   std::cout  << ss.str() << std::endl;
+   SCassStatement stmt;
 
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "UPDATE vhss.users_imsi SET ms_ps_status='PURGED' WHERE imsi=?", stmt );
+   stmt.bind( 0, imsi );
+   std::cout << stmt.query() << " imsi=" << imsi << std::endl;
 
    SCassFuture future = m_db.execute( stmt );
 
    if ( future.errorCode() != CASS_OK )
       throw DAException(
          SUtility::string_format( "DataAcces::%s - Error %d executing [%s]",
-               __func__, future.errorCode(), ss.str().c_str() )
+               __func__, future.errorCode(), stmt.query().c_str() )
       );
 
    return true;
@@ -896,13 +945,11 @@ bool DataAccess::purgeUE ( std::string &imsi )
 
 bool DataAccess::getMmeIdentityFromImsi ( std::string &imsi, DAMmeIdentity& mmeid)
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT mmeidentity_idmmeidentity FROM vhss.users_imsi WHERE imsi = '"
-      << imsi << "';" ;
-   std::cout  << ss.str() << std::endl;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT mmeidentity_idmmeidentity FROM vhss.users_imsi WHERE imsi = ?", stmt );
+   stmt.bind( 0, imsi );
+   std::cout << stmt.query() << " imsi=" << imsi << std::endl;
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -910,7 +957,7 @@ bool DataAccess::getMmeIdentityFromImsi ( std::string &imsi, DAMmeIdentity& mmei
    {
        throw DAException(
            SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-           __func__, future.errorCode(), ss.str().c_str() )
+           __func__, future.errorCode(), stmt.query().c_str() )
        );
    }
 
@@ -966,13 +1013,11 @@ bool DataAccess::getMmeIdentity ( std::string &mme_id, DAMmeIdentity& mmeid )
 
 bool DataAccess::getMmeIdentity ( int32_t mme_id, DAMmeIdentity& mmeid )
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT mmehost,mmerealm,mmeisdn FROM vhss.mmeidentity WHERE idmmeidentity="
-      << mme_id << ";" ;
-   std::cout  << ss.str() << std::endl;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT mmehost,mmerealm,mmeisdn FROM vhss.mmeidentity WHERE idmmeidentity=?", stmt );
+   stmt.bind( 0, mme_id );
+   std::cout << stmt.query() << " idmmeidentity=" << mme_id << std::endl;
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -980,7 +1025,7 @@ bool DataAccess::getMmeIdentity ( int32_t mme_id, DAMmeIdentity& mmeid )
    {
        throw DAException(
            SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-           __func__, future.errorCode(), ss.str().c_str() )
+           __func__, future.errorCode(), stmt.query().c_str() )
        );
    }
 
@@ -1059,13 +1104,11 @@ bool DataAccess::updateLatestIdentity(std::string& table_name)
 
 bool DataAccess::getMmeIdFromHost ( std::string& host, int32_t &mmeid)
 {
-   std::stringstream ss;
+   SCassStatement stmt;
 
-   ss << "SELECT idmmeidentity FROM vhss.mmeidentity_host WHERE mmehost='"
-      << host << "';" ;
-   std::cout  << ss.str() << std::endl;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( "SELECT idmmeidentity FROM vhss.mmeidentity_host WHERE mmehost=?", stmt );
+   stmt.bind( 0, host );
+   std::cout << stmt.query() << " mmehost=" << host << std::endl;
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -1073,7 +1116,7 @@ bool DataAccess::getMmeIdFromHost ( std::string& host, int32_t &mmeid)
    {
        throw DAException(
            SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-           __func__, future.errorCode(), ss.str().c_str() )
+           __func__, future.errorCode(), stmt.query().c_str() )
        );
    }
 
@@ -1211,16 +1254,10 @@ bool DataAccess::updateLocation ( DAImsiInfo &location, uint32_t present_flags )
 
 bool DataAccess::getImsiSec ( const std::string &imsi, DAImsiSec &imsisec )
 {
-   //SELECT key,sqn,rand,OPc FROM vhss.users_imsi WHERE imsi='%s'
-
-   std::stringstream ss;
-
-   ss << "SELECT key,sqn,rand,OPc FROM vhss.users_imsi WHERE imsi='"
-      << imsi << "';" ;
+   SCassStatement stmt;
 
-   std::cout << ss.str() << std::endl;
-
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_IMSI_SEC, stmt );
+   stmt.bind( 0, imsi );
 
    SCassFuture future = m_db.execute( stmt );
 
@@ -1228,7 +1265,7 @@ bool DataAccess::getImsiSec ( const std::string &imsi, DAImsiSec &imsisec )
    {
        throw DAException(
            SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-           __func__, future.errorCode(), ss.str().c_str() )
+           __func__, future.errorCode(), stmt.query().c_str() )
        );
    }
 
@@ -1238,55 +1275,37 @@ bool DataAccess::getImsiSec ( const std::string &imsi, DAImsiSec &imsisec )
 
    if ( row.valid() )
    {
-      std::string key_str;
-      int64_t     sqn_nb;
-      std::string rand_str;
-      std::string OPc_str;
-
-      GET_EVENT_DATA( row, key, key_str );
-      GET_EVENT_DATA( row, sqn, sqn_nb );
-      GET_EVENT_DATA( row, rand, rand_str );
-      GET_EVENT_DATA( row, OPc, OPc_str );
-
-      convert_ascii_to_binary(imsisec.key, (uint8_t *)key_str.c_str(), KEY_LENGTH);
-      convert_ascii_to_binary(imsisec.rand,(uint8_t *)rand_str.c_str(), RAND_LENGTH);
-      convert_ascii_to_binary(imsisec.opc, (uint8_t *)OPc_str.c_str(), KEY_LENGTH);
-
-      imsisec.sqn[0] = (sqn_nb & (255UL << 40)) >> 40;
-      imsisec.sqn[1] = (sqn_nb & (255UL << 32)) >> 32;
-      imsisec.sqn[2] = (sqn_nb & (255UL << 24)) >> 24;
-      imsisec.sqn[3] = (sqn_nb & (255UL << 16)) >> 16;
-      imsisec.sqn[4] = (sqn_nb & (255UL << 8)) >> 8;
-      imsisec.sqn[5] = (sqn_nb & 0xFF);
-
+      decodeImsiSec( future, row, imsisec );
       return true;
    }
 
    return false;
 }
 
-bool DataAccess::updateRandSqn ( const std::string &imsi, uint8_t * rand_p, uint8_t * sqn )
+bool DataAccess::updateRandSqn ( const std::string &imsi, uint8_t * rand_p, uint8_t * sqn, bool incsqn )
 {
    SqnU64Union eu;
 
    SQN_TO_U64(sqn, eu);
 
+   if ( incsqn )
+      eu.u64 += 32;
+
    std::string rand = Utility::bytes2hex(rand_p, RAND_LENGTH);
 
    std::cout << "sqn=" << Utility::bytes2hex(sqn,6,'.') << " eu.u8[]=" << Utility::bytes2hex(eu.u8,8,'.') << " eu.u64=" << eu.u64 << " rand=[" << rand << "]" << std::endl;
 
-   std::stringstream ss;
-   ss << "UPDATE vhss.users_imsi SET rand='" << rand << "', sqn=" << eu.u64 << " WHERE imsi='" << imsi << "';";
-   std::cout << ss.str() << std::endl;
+   SCassStatement stmt;
 
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_UPDATE_RAND_SQN, stmt );
+   stmt.bind( 0, rand ).bind( 1, (int64_t)eu.u64 ).bind( 2, imsi );
 
    SCassFuture future = m_db.execute( stmt );
 
    if ( future.errorCode() != CASS_OK )
       throw DAException(
          SUtility::string_format( "DataAcces::%s - Error %d executing [%s]",
-               __func__, future.errorCode(), ss.str().c_str() )
+               __func__, future.errorCode(), stmt.query().c_str() )
       );
 
    return true;
@@ -1300,18 +1319,18 @@ bool DataAccess::incSqn ( std::string &imsi, uint8_t * sqn )
 
    eu.u64 += 32;
 
-   std::stringstream ss;
-   ss << "UPDATE vhss.users_imsi SET sqn =" << eu.u64 << " WHERE imsi='" << imsi << "';";
-   std::cout << ss.str() << std::endl;
+   SCassStatement stmt;
 
-   SCassStatement stmt( ss.str().c_str() );
+   prepare( CQL_UPDATE_SQN, stmt );
+   stmt.bind( 0, (int64_t)eu.u64 ).bind( 1, imsi );
+   std::cout << stmt.query() << " sqn=" << eu.u64 << " imsi=" << imsi << std::endl;
 
    SCassFuture future = m_db.execute( stmt );
 
    if ( future.errorCode() != CASS_OK )
       throw DAException(
          SUtility::string_format( "DataAcces::%s - Error %d executing [%s]",
-               __func__, future.errorCode(), ss.str().c_str() )
+               __func__, future.errorCode(), stmt.query().c_str() )
       );
 
    return true;
@@ -1319,12 +1338,10 @@ bool DataAccess::incSqn ( std::string &imsi, uint8_t * sqn )
 
 bool DataAccess::getSubDataFromImsi( const char *imsi, std::string &sub_data )
 {
-    std::stringstream ss;
+    SCassStatement stmt;
 
-    ss << "SELECT subscription_data FROM users_imsi where imsi = '"
-       << imsi << "' ;" ;
-
-    SCassStatement stmt( ss.str().c_str() );
+    prepare( CQL_SUB_DATA, stmt );
+    stmt.bind( 0, imsi );
 
     SCassFuture future = m_db.execute( stmt );
 
@@ -1332,7 +1349,7 @@ bool DataAccess::getSubDataFromImsi( const char *imsi, std::string &sub_data )
     {
         throw DAException(
             SUtility::string_format( "DataAccess::%s - Error %d executing [%s]",
-            __func__, future.errorCode(), ss.str().c_str() )
+            __func__, future.errorCode(), stmt.query().c_str() )
         );
     }
 
@@ -1628,3 +1645,221 @@ DAMonitoringConfEventList::~DAMonitoringConfEventList()
 }
 
 #endif
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// The asynchronous methods bind the same prepared statements as their
+// synchronous counterparts and decode the result on the driver I/O thread.
+// Errors preparing the statement are thrown to the caller, errors executing
+// it are reported to the callback as DA_ERROR.
+//
+
+void DataAccess::checkImsiExistsAsync( const std::string &imsi, DACallback cb )
+{
+   SCassStatement stmt;
+
+   prepare( CQL_CHECK_IMSI, stmt );
+   stmt.bind( 0, imsi );
+
+   m_db.executeAsync( stmt, [cb]( SCassFuture &future )
+   {
+      if ( future.errorCode() != CASS_OK )
+      {
+         cb( DA_ERROR );
+         return;
+      }
+
+      SCassResult res = future.result();
+      SCassRow row = res.firstRow();
+
+      cb( row.valid() ? DA_OK : DA_NOT_FOUND );
+   });
+}
+
+void DataAccess::getStringAsync( const char *column, SCassStatement &stmt, DAStringCallback cb )
+{
+   std::string col( column );
+
+   m_db.executeAsync( stmt, [cb,col]( SCassFuture &future )
+   {
+      std::string value;
+      DAResult rc = DA_ERROR;
+
+      if ( future.errorCode() == CASS_OK )
+      {
+         SCassResult res = future.result();
+         SCassRow row = res.firstRow();
+
+         if ( !row.valid() )
+         {
+            rc = DA_NOT_FOUND;
+         }
+         else
+         {
+            SCassValue val = row.getColumn( col.c_str() );
+            if ( val.isNull() || val.get( value ) )
+               rc = DA_OK;
+         }
+      }
+
+      cb( rc, value );
+   });
+}
+
+void DataAccess::getImsiFromMsisdnAsync( int64_t msisdn, DAStringCallback cb )
+{
+   SCassStatement stmt;
+
+   prepare( CQL_IMSI_FROM_MSISDN, stmt );
+   stmt.bind( 0, msisdn );
+
+   getStringAsync( "imsi", stmt, cb );
+}
+
+void DataAccess::getMsisdnFromImsiAsync( const std::string &imsi, DAStringCallback cb )
+{
+   SCassStatement stmt;
+
+   prepare( CQL_MSISDN_FROM_IMSI, stmt );
+   stmt.bind( 0, imsi );
+
+   // msisdn is a bigint, report it as a string like getMsisdnFromImsi()
+   m_db.executeAsync( stmt, [cb]( SCassFuture &future )
+   {
+      std::string value;
+      DAResult rc = DA_ERROR;
+
+      if ( future.errorCode() == CASS_OK )
+      {
+         SCassResult res = future.result();
+         SCassRow row = res.firstRow();
+
+         if ( !row.valid() )
+         {
+            rc = DA_NOT_FOUND;
+         }
+         else
+         {
+            int64_t msisdn = 0;
+            SCassValue val = row.getColumn( "msisdn" );
+            if ( val.isNull() || val.get( msisdn ) )
+            {
+               value = std::to_string( msisdn );
+               rc = DA_OK;
+            }
+         }
+      }
+
+      cb( rc, value );
+   });
+}
+
+void DataAccess::getSubDataFromImsiAsync( const std::string &imsi, DAStringCallback cb )
+{
+   SCassStatement stmt;
+
+   prepare( CQL_SUB_DATA, stmt );
+   stmt.bind( 0, imsi );
+
+   getStringAsync( "subscription_data", stmt, cb );
+}
+
+void DataAccess::getImsiInfoAsync( const std::string &imsi, DAImsiInfoCallback cb )
+{
+   SCassStatement stmt;
+
+   prepare( CQL_IMSI_INFO, stmt );
+   stmt.bind( 0, imsi );
+
+   m_db.executeAsync( stmt, [cb]( SCassFuture &future )
+   {
+      DAImsiInfo info;
+      DAResult rc = DA_ERROR;
+
+      if ( future.errorCode() == CASS_OK )
+      {
+         SCassResult res = future.result();
+         SCassRow row = res.firstRow();
+
+         try
+         {
+            if ( row.valid() )
+            {
+               decodeImsiInfo( future, row, info );
+               rc = DA_OK;
+            }
+            else
+            {
+               rc = DA_NOT_FOUND;
+            }
+         }
+         catch ( DAException &ex )
+         {
+            std::cout << ex.what() << std::endl;
+         }
+      }
+
+      cb( rc, info );
+   });
+}
+
+void DataAccess::getImsiSecAsync( const std::string &imsi, DAImsiSecCallback cb )
+{
+   SCassStatement stmt;
+
+   prepare( CQL_IMSI_SEC, stmt );
+   stmt.bind( 0, imsi );
+
+   m_db.executeAsync( stmt, [cb]( SCassFuture &future )
+   {
+      DAImsiSec imsisec;
+      DAResult rc = DA_ERROR;
+
+      if ( future.errorCode() == CASS_OK )
+      {
+         SCassResult res = future.result();
+         SCassRow row = res.firstRow();
+
+         try
+         {
+            if ( row.valid() )
+            {
+               decodeImsiSec( future, row, imsisec );
+               rc = DA_OK;
+            }
+            else
+            {
+               rc = DA_NOT_FOUND;
+            }
+         }
+         catch ( DAException &ex )
+         {
+            std::cout << ex.what() << std::endl;
+         }
+      }
+
+      cb( rc, imsisec );
+   });
+}
+
+void DataAccess::updateRandSqnAsync( const std::string &imsi, uint8_t * rand_p, uint8_t * sqn, bool incsqn, DACallback cb )
+{
+   SqnU64Union eu;
+
+   SQN_TO_U64(sqn, eu);
+
+   if ( incsqn )
+      eu.u64 += 32;
+
+   SCassStatement stmt;
+
+   prepare( CQL_UPDATE_RAND_SQN, stmt );
+   stmt.bind( 0, Utility::bytes2hex(rand_p, RAND_LENGTH) ).bind( 1, (int64_t)eu.u64 ).bind( 2, imsi );
+
+   m_db.executeAsync( stmt, [cb]( SCassFuture &future )
+   {
+      cb( future.errorCode() == CASS_OK ? DA_OK : DA_ERROR );
+   });
+}
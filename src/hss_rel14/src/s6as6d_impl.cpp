@@ -17,6 +17,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <memory>
 #include "s6as6d_impl.h"
 #include "fdjson.h"
 #include "options.h"
@@ -24,6 +25,7 @@
 #include "s6t.h"
 #include "s6t_impl.h"
 #include "dataaccess.h"
+#include "util.h"
 #include "fdhss.h"
 #include "rapidjson/document.h"
 #include <iomanip>
@@ -553,83 +555,133 @@ void AUIRreq::processAnswer( FDMessageAnswer &ans )
 
 // AUIR Command (cmd) member function
 
+// state of an AUIR while its subscriber lookup and SQN update are in flight
+struct AUIRContext
+{
+    FDMessageRequest                *req;
+    uint32_t                        auth_session_state;
+    std::string                     imsi_str;
+    uint64_t                        imsi;
+    uint32_t                        num_vectors;
+    uint8_t                         plmn_id[4];
+    uint8_t                         auts[31];
+    bool                            auts_set;
+    auc_vector_t                    vector[AUTH_MAX_EUTRAN_VECTORS];
+};
+
+// builds the AIA for req, the vectors are added only on success
+static void sendAUIRAnswer( Application &app, FDMessageRequest *req, uint32_t auth_session_state,
+                            auc_vector_t *vector, uint32_t num_vectors, int result_code, bool experimental )
+{
+    FDMessageAnswer ans( req );
+    ans.addOrigin();
+
+    ans.add( app.getDict().avpAuthSessionState(), auth_session_state );
+
+    if (result_code == ER_DIAMETER_SUCCESS) {
+        for (uint32_t i = 0; i < num_vectors; i++) {
+            FDAvp authentication_info ( app.getDict().avpAuthenticationInfo() );
+            FDAvp eurtran_vector ( app.getDict().avpEUtranVector() );
+
+            eurtran_vector.add(app.getDict().avpRand(),  vector[i].rand,  sizeof(vector[i].rand) );
+            eurtran_vector.add(app.getDict().avpXres(),  vector[i].xres,  sizeof(vector[i].xres) );
+            eurtran_vector.add(app.getDict().avpAutn(),  vector[i].autn,  sizeof(vector[i].autn) );
+            eurtran_vector.add(app.getDict().avpKasme(), vector[i].kasme, sizeof(vector[i].kasme));
+
+            authentication_info.add(eurtran_vector);
+            ans.add(authentication_info);
+        }
+    }
+
+    //Handle errors
+    if (DIAMETER_ERROR_IS_VENDOR (result_code) && experimental) {
+        FDAvp experimental_result ( app.getDict().avpExperimentalResult() );
+        experimental_result.add( app.getDict().avpVendorId(),  VENDOR_3GPP);
+        experimental_result.add( app.getDict().avpExperimentalResultCode(),  result_code);
+        ans.add(experimental_result);
+    }
+    else{
+        ans.add( app.getDict().avpResultCode(), result_code);
+    }
+
+    ans.send();
+}
+
 // Function invoked when a AUIR Command is received
+//
+// The request is validated here, the subscriber keys are then read and the
+// new SQN written asynchronously so the freeDiameter thread is not held for
+// the Cassandra round trips. The answer is sent from the completion of the
+// SQN update.
 int AUIRcmd::process( FDMessageRequest *req )
 {
 
     std::string                     s;
-    std::string                     imsi_str;
-    uint32_t                        u32;
+    uint32_t                        u32 = 0;
 
-    DAImsiSec                       imsisec;
-
-    auc_vector_t                    vector[AUTH_MAX_EUTRAN_VECTORS];
     int                             result_code = ER_DIAMETER_SUCCESS;
     int                             experimental = 0;
-    uint64_t                        imsi = 0;
 
-    uint8_t                         *sqn = NULL;
-    uint32_t                        num_vectors = 0;
+    size_t                          plmn_len;
+    size_t                          auts_len;
 
-    uint8_t                         plmn_id[4];
-    size_t                          plmn_len = sizeof(plmn_id);
-
-    uint8_t                         auts[31];
-    size_t                          auts_len = sizeof(auts);
-    bool                            auts_set = false;
+    std::shared_ptr<AUIRContext>    ctx = std::make_shared<AUIRContext>();
 
+    ctx->req = req;
+    ctx->imsi = 0;
+    ctx->num_vectors = 0;
+    ctx->auts_set = false;
+    plmn_len = sizeof(ctx->plmn_id);
+    auts_len = sizeof(ctx->auts);
 
 req->dump();
 
-    FDMessageAnswer ans( req );
-    ans.addOrigin();
-
     s6as6d::AuthenticationInformationRequestExtractor air( *req, m_app.getDict() );
 
     do{
         air.auth_session_state.get(u32);
-        ans.add( m_app.getDict().avpAuthSessionState(), u32 );
+        ctx->auth_session_state = u32;
 
-        air.user_name.get(imsi_str);
-        if(strlen(imsi_str.c_str()) > IMSI_LENGTH){
+        air.user_name.get(ctx->imsi_str);
+        if(strlen(ctx->imsi_str.c_str()) > IMSI_LENGTH){
             result_code = ER_DIAMETER_INVALID_AVP_VALUE;
             break;
         }
 
-        sscanf (imsi_str.c_str(), "%" SCNu64, &imsi);
+        sscanf (ctx->imsi_str.c_str(), "%" SCNu64, &ctx->imsi);
 
         bool eutran_avp_found = false;
 
-        if(air.requested_eutran_authentication_info.number_of_requested_vectors.get(num_vectors)){
+        if(air.requested_eutran_authentication_info.number_of_requested_vectors.get(ctx->num_vectors)){
             eutran_avp_found = true;
-            if ( num_vectors > AUTH_MAX_EUTRAN_VECTORS ) {
+            if ( ctx->num_vectors > AUTH_MAX_EUTRAN_VECTORS ) {
                 result_code = ER_DIAMETER_INVALID_AVP_VALUE;
                 break;
             }
         }
 
-        if(air.requested_eutran_authentication_info.re_synchronization_info.get(auts, auts_len)){
+        if(air.requested_eutran_authentication_info.re_synchronization_info.get(ctx->auts, auts_len)){
             eutran_avp_found = true;
-            auts_set = true;
+            ctx->auts_set = true;
         }
         if(!eutran_avp_found) {
 
-            if(air.requested_utran_geran_authentication_info.number_of_requested_vectors.get(num_vectors)){
+            if(air.requested_utran_geran_authentication_info.number_of_requested_vectors.get(ctx->num_vectors)){
                 result_code = DIAMETER_ERROR_RAT_NOT_ALLOWED;
                 experimental = true;
                 break;
             }
-            if(air.requested_utran_geran_authentication_info.re_synchronization_info.get(auts, auts_len)){
+            if(air.requested_utran_geran_authentication_info.re_synchronization_info.get(ctx->auts, auts_len)){
                 result_code = DIAMETER_ERROR_RAT_NOT_ALLOWED;
                 experimental = true;
                 break;
             }
         }
 
-        if(air.visited_plmn_id.get(plmn_id, plmn_len)){
+        if(air.visited_plmn_id.get(ctx->plmn_id, plmn_len)){
             if(plmn_len == 3 ){
                 if (! Options::getroamallow()) {
-                  if (apply_access_restriction ((char*)imsi_str.c_str(), plmn_id) != 0) {
+                  if (apply_access_restriction ((char*)ctx->imsi_str.c_str(), ctx->plmn_id) != 0) {
                     result_code = DIAMETER_ERROR_ROAMING_NOT_ALLOWED;
                     experimental = true;
                     break;
@@ -646,72 +698,74 @@ req->dump();
             break;
         }
 
-        if (! m_app.dataaccess().getImsiSec (imsi_str, imsisec) ) {
-          result_code = DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE;
-          experimental = true;
-          break;
-        }
-
-        if (auts_set) {
-            sqn = sqn_ms_derive_cpp (imsisec.opc, imsisec.key, auts, imsisec.rand);
-            if (sqn != NULL) {
-
-              //We succeeded to verify SQN_MS...
-              //Pick a new RAND and store SQN_MS + RAND in the HSS
-              generate_random_cpp (vector[0].rand, RAND_LENGTH);
+    }while(false);
 
-              m_app.dataaccess().updateRandSqn(imsi_str, vector[0].rand, sqn);
-              m_app.dataaccess().incSqn( imsi_str, sqn );
+    if (result_code != ER_DIAMETER_SUCCESS) {
+        sendAUIRAnswer( m_app, req, ctx->auth_session_state, NULL, 0, result_code, experimental );
+        return 0;
+    }
 
-              free (sqn);
+    try {
+        m_app.dataaccess().getImsiSecAsync( ctx->imsi_str, [this,ctx]( DAResult rc, DAImsiSec &imsisec )
+        {
+            if (rc != DA_OK) {
+                sendAUIRAnswer( m_app, ctx->req, ctx->auth_session_state, NULL, 0,
+                                DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE, true );
+                return;
             }
 
-             //Fetch new user data
-            if (! m_app.dataaccess().getImsiSec (imsi_str, imsisec) ) {
-              result_code = DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE;
-              experimental = true;
-              break;
-            }
-        }
+            if (ctx->auts_set) {
+                uint8_t *sqn_ms = sqn_ms_derive_cpp (imsisec.opc, imsisec.key, ctx->auts, imsisec.rand);
+                if (sqn_ms != NULL) {
 
-        sqn = imsisec.sqn;
-        for (int i = 0; i < num_vectors; i++) {
-            generate_random_cpp (vector[i].rand, RAND_LENGTH);
-            generate_vector_cpp (imsisec.opc, imsi, imsisec.key, plmn_id, sqn, &vector[i]);
-        }
-        m_app.dataaccess().updateRandSqn (imsi_str, vector[num_vectors-1].rand, sqn);
-        m_app.dataaccess().incSqn( imsi_str, sqn );
+                  //We succeeded to verify SQN_MS...
+                  //Pick a new RAND and continue from SQN_MS + 32, which is
+                  //what storing SQN_MS + RAND and fetching them back gave
+                  SqnU64Union eu;
 
-        for (int i = 0; i < num_vectors; i++) {
-            FDAvp authentication_info ( m_app.getDict().avpAuthenticationInfo() );
-            FDAvp eurtran_vector ( m_app.getDict().avpEUtranVector() );
+                  generate_random_cpp (ctx->vector[0].rand, RAND_LENGTH);
+                  memcpy (imsisec.rand, ctx->vector[0].rand, RAND_LENGTH);
 
-            eurtran_vector.add(m_app.getDict().avpRand(),  vector[i].rand,  sizeof(vector[i].rand) );
-            eurtran_vector.add(m_app.getDict().avpXres(),  vector[i].xres,  sizeof(vector[i].xres) );
-            eurtran_vector.add(m_app.getDict().avpAutn(),  vector[i].autn,  sizeof(vector[i].autn) );
-            eurtran_vector.add(m_app.getDict().avpKasme(), vector[i].kasme, sizeof(vector[i].kasme));
+                  SQN_TO_U64(sqn_ms, eu);
+                  eu.u64 += 32;
+                  U64_TO_SQN(eu, imsisec.sqn);
 
-            authentication_info.add(eurtran_vector);
-            ans.add(authentication_info);
-        }
+                  free (sqn_ms);
+                }
+            }
 
-    }while(false);
+            uint8_t *sqn = imsisec.sqn;
+            for (uint32_t i = 0; i < ctx->num_vectors; i++) {
+                generate_random_cpp (ctx->vector[i].rand, RAND_LENGTH);
+                generate_vector_cpp (imsisec.opc, ctx->imsi, imsisec.key, ctx->plmn_id, sqn, &ctx->vector[i]);
+            }
 
-    //Handle errors
-    if (DIAMETER_ERROR_IS_VENDOR (result_code) && experimental) {
-        FDAvp experimental_result ( m_app.getDict().avpExperimentalResult() );
-        experimental_result.add( m_app.getDict().avpVendorId(),  VENDOR_3GPP);
-        experimental_result.add( m_app.getDict().avpExperimentalResultCode(),  result_code);
-        ans.add(experimental_result);
+            // stores the last RAND and SQN + 32 in one statement
+            try {
+                m_app.dataaccess().updateRandSqnAsync( ctx->imsi_str, ctx->vector[ctx->num_vectors-1].rand, sqn, true,
+                    [this,ctx]( DAResult rc )
+                {
+                    if (rc != DA_OK)
+                        sendAUIRAnswer( m_app, ctx->req, ctx->auth_session_state, NULL, 0,
+                                        DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE, true );
+                    else
+                        sendAUIRAnswer( m_app, ctx->req, ctx->auth_session_state, ctx->vector, ctx->num_vectors,
+                                        ER_DIAMETER_SUCCESS, false );
+                });
+            }
+            catch ( DAException &ex ) {
+                std::cout << ex.what() << std::endl;
+                sendAUIRAnswer( m_app, ctx->req, ctx->auth_session_state, NULL, 0,
+                                DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE, true );
+            }
+        });
     }
-    else{
-        ans.add( m_app.getDict().avpResultCode(), result_code);
+    catch ( DAException &ex ) {
+        std::cout << ex.what() << std::endl;
+        sendAUIRAnswer( m_app, req, ctx->auth_session_state, NULL, 0,
+                        DIAMETER_AUTHENTICATION_DATA_UNAVAILABLE, true );
     }
 
-
-ans.dump();
-    ans.send();
-
     return 0;
 }
  
@@ -0,0 +1,209 @@
+/*
+* Copyright (c) 2017 Sprint
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*    http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+//
+// Measures the query rate of the users_imsi key lookup used by the AIR
+// against a Cassandra node with a provisioned vhss keyspace:
+//
+//   literal   - concatenated CQL executed synchronously, as before the
+//               prepared statement cache
+//   prepared  - DataAccess::getImsiSec() from several threads
+//   async     - DataAccess::getImsiSecAsync() with a window of queries
+//               in flight
+//
+//   bin/dataaccess_qps [-h host] [-k keyspace] [-i imsi] [-n queries]
+//                      [-t threads] [-w window]
+//
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "dataaccess.h"
+#include "ssync.h"
+
+static std::string g_host = "127.0.0.1";
+static std::string g_keyspace = "vhss";
+static std::string g_imsi = "001014567891234";
+static int g_queries = 100000;
+static int g_threads = 4;
+static int g_window = 256;
+
+static double elapsed( std::chrono::steady_clock::time_point start )
+{
+   return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+static void report( const char *mode, int queries, int errors, double secs )
+{
+   std::cout << mode << ": " << queries << " queries " << errors << " errors in "
+             << secs << "s - " << (uint64_t)( queries / secs ) << " qps" << std::endl;
+}
+
+static void runLiteral()
+{
+   SCassandra db;
+
+   db.host( g_host );
+   db.keyspace( g_keyspace );
+
+   SCassFuture f = db.connect();
+   f.wait();
+   if ( f.errorCode() != CASS_OK )
+   {
+      std::cout << "unable to connect to " << g_host << " error " << f.errorCode() << std::endl;
+      return;
+   }
+
+   std::atomic<int> errors( 0 );
+   std::vector<std::thread> threads;
+   auto start = std::chrono::steady_clock::now();
+
+   for ( int t = 0; t < g_threads; t++ )
+   {
+      threads.push_back( std::thread( [&db,&errors]()
+      {
+         for ( int i = 0; i < g_queries / g_threads; i++ )
+         {
+            std::stringstream ss;
+
+            ss << "SELECT key,sqn,rand,OPc FROM vhss.users_imsi WHERE imsi='" << g_imsi << "';";
+
+            SCassStatement stmt( ss.str().c_str() );
+            SCassFuture future = db.execute( stmt );
+
+            if ( future.errorCode() != CASS_OK )
+               errors++;
+         }
+      }));
+   }
+
+   for ( auto &th : threads )
+      th.join();
+
+   report( "literal", g_queries / g_threads * g_threads, errors, elapsed( start ) );
+}
+
+static void runPrepared( DataAccess &da )
+{
+   std::atomic<int> errors( 0 );
+   std::vector<std::thread> threads;
+   auto start = std::chrono::steady_clock::now();
+
+   for ( int t = 0; t < g_threads; t++ )
+   {
+      threads.push_back( std::thread( [&da,&errors]()
+      {
+         DAImsiSec sec;
+
+         for ( int i = 0; i < g_queries / g_threads; i++ )
+         {
+            try
+            {
+               if ( !da.getImsiSec( g_imsi, sec ) )
+                  errors++;
+            }
+            catch ( DAException &ex )
+            {
+               errors++;
+            }
+         }
+      }));
+   }
+
+   for ( auto &th : threads )
+      th.join();
+
+   report( "prepared", g_queries / g_threads * g_threads, errors, elapsed( start ) );
+}
+
+static void runAsync( DataAccess &da )
+{
+   SSemaphore window( g_window, g_window );
+   std::atomic<int> errors( 0 );
+   auto start = std::chrono::steady_clock::now();
+
+   for ( int i = 0; i < g_queries; i++ )
+   {
+      window.decrement();
+
+      da.getImsiSecAsync( g_imsi, [&window,&errors]( DAResult rc, DAImsiSec &sec )
+      {
+         if ( rc != DA_OK )
+            errors++;
+         window.increment();
+      });
+   }
+
+   // wait for the queries still in flight
+   for ( int i = 0; i < g_window; i++ )
+      window.decrement();
+
+   report( "async", g_queries, errors, elapsed( start ) );
+}
+
+int main( int argc, char **argv )
+{
+   int c;
+
+   while ( (c = getopt( argc, argv, "h:k:i:n:t:w:" )) != -1 )
+   {
+      switch ( c )
+      {
+         case 'h': g_host = optarg; break;
+         case 'k': g_keyspace = optarg; break;
+         case 'i': g_imsi = optarg; break;
+         case 'n': g_queries = atoi( optarg ); break;
+         case 't': g_threads = atoi( optarg ); break;
+         case 'w': g_window = atoi( optarg ); break;
+         default:
+            std::cout << "usage: " << argv[0]
+                      << " [-h host] [-k keyspace] [-i imsi] [-n queries] [-t threads] [-w window]" << std::endl;
+            return 1;
+      }
+   }
+
+   if ( g_threads < 1 || g_window < 1 || g_queries < g_threads )
+   {
+      std::cout << "invalid parameters" << std::endl;
+      return 1;
+   }
+
+   runLiteral();
+
+   try
+   {
+      DataAccess da;
+
+      da.connect( g_host, g_keyspace );
+
+      runPrepared( da );
+      runAsync( da );
+   }
+   catch ( DAException &ex )
+   {
+      std::cout << ex.what() << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
@@ -19,10 +19,13 @@
 
 #include <stdint.h>
 #include <string>
+#include <map>
+#include <functional>
 
 #include <cassandra.h>
 
 #include "stime.h"
+#include "ssync.h"
 
 class SCassValue
 {
@@ -141,6 +144,7 @@ public:
 
    CassError errorCode();
    SCassResult result();
+   const CassPrepared *prepared();
 
 private:
    SCassFuture();
@@ -163,9 +167,19 @@ public:
 
    SCassStatement &query( const char *query );
    SCassStatement &query( std::string &query );
+   const std::string &query() { return m_query; }
+
+   // bind the parameters of a statement created by SCassandra::prepare(),
+   // index is the position of the ? marker in the query
+   SCassStatement &bind( size_t index, const char *v );
+   SCassStatement &bind( size_t index, const std::string &v ) { return bind( index, v.c_str() ); }
+   SCassStatement &bind( size_t index, int32_t v );
+   SCassStatement &bind( size_t index, int64_t v );
+   SCassStatement &bind( size_t index, const uint8_t *v, size_t len );
 
 protected:
    void release();
+   void bound( const CassPrepared *prepared, const char *query );
    SCassFuture execute( CassSession *session );
 
 private:
@@ -176,10 +190,18 @@ private:
 class SCassandra
 {
 public:
+   // invoked from a driver I/O thread when an asynchronous execution completes
+   typedef std::function<void( SCassFuture &future )> AsyncCallback;
+
    SCassandra();
    ~SCassandra();
 
    SCassFuture execute( SCassStatement &statement ) { return statement.execute( m_session ); }
+   void executeAsync( SCassStatement &statement, AsyncCallback callback );
+
+   // creates in statement a bound statement of query, the query is prepared
+   // on the server the first time and then reused from the cache
+   CassError prepare( const char *query, SCassStatement &statement );
 
    SCassFuture connect();
    void disconnect();
@@ -197,9 +219,12 @@ public:
 
 private:
    void release();
+   static void onAsyncComplete( CassFuture *future, void *data );
 
    CassCluster *m_cluster;
    CassSession *m_session;
+   std::map<std::string,const CassPrepared*> m_prepared;
+   SMutex m_preparedmtx;
    std::string m_host;
    std::string m_keyspace;
    int m_protver;
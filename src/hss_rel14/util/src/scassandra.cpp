@@ -371,6 +371,11 @@ SCassResult SCassFuture::result()
    return SCassResult( cass_future_get_result( m_future ) );
 }
 
+const CassPrepared *SCassFuture::prepared()
+{
+   return cass_future_get_prepared( m_future );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -419,9 +424,42 @@ void SCassStatement::release()
    }
 }
 
+void SCassStatement::bound( const CassPrepared *prepared, const char *query )
+{
+   release();
+   m_query = query;
+   m_statement = cass_prepared_bind( prepared );
+}
+
+SCassStatement &SCassStatement::bind( size_t index, const char *v )
+{
+   cass_statement_bind_string( m_statement, index, v );
+   return *this;
+}
+
+SCassStatement &SCassStatement::bind( size_t index, int32_t v )
+{
+   cass_statement_bind_int32( m_statement, index, v );
+   return *this;
+}
+
+SCassStatement &SCassStatement::bind( size_t index, int64_t v )
+{
+   cass_statement_bind_int64( m_statement, index, v );
+   return *this;
+}
+
+SCassStatement &SCassStatement::bind( size_t index, const uint8_t *v, size_t len )
+{
+   cass_statement_bind_bytes( m_statement, index, v, len );
+   return *this;
+}
+
 SCassFuture SCassStatement::execute( CassSession *session )
 {
-   m_statement = cass_statement_new( m_query.c_str(), 0 );
+   // a prepared statement is already bound, a simple one is built from the query
+   if ( !m_statement )
+      m_statement = cass_statement_new( m_query.c_str(), 0 );
 
    return SCassFuture( cass_session_execute( session, m_statement ) );
 }
@@ -443,6 +481,14 @@ SCassandra::~SCassandra()
 
 void SCassandra::release()
 {
+   {
+      SMutexLock l( m_preparedmtx );
+
+      for ( auto it = m_prepared.begin(); it != m_prepared.end(); ++it )
+         cass_prepared_free( it->second );
+      m_prepared.clear();
+   }
+
    if ( m_cluster )
    {
       cass_cluster_free( m_cluster );
@@ -484,3 +530,51 @@ void SCassandra::disconnect()
    release();
 }
 
+CassError SCassandra::prepare( const char *query, SCassStatement &statement )
+{
+   SMutexLock l( m_preparedmtx );
+
+   auto it = m_prepared.find( query );
+
+   if ( it == m_prepared.end() )
+   {
+      SCassFuture future( cass_session_prepare( m_session, query ) );
+
+      if ( future.errorCode() != CASS_OK )
+         return future.errorCode();
+
+      it = m_prepared.insert( std::make_pair( std::string( query ), future.prepared() ) ).first;
+   }
+
+   statement.bound( it->second, query );
+
+   return CASS_OK;
+}
+
+void SCassandra::executeAsync( SCassStatement &statement, AsyncCallback callback )
+{
+   if ( !statement.m_statement )
+      statement.m_statement = cass_statement_new( statement.m_query.c_str(), 0 );
+
+   CassFuture *future = cass_session_execute( m_session, statement.m_statement );
+
+   // the future is released by onAsyncComplete once the callback has run
+   cass_future_set_callback( future, onAsyncComplete, new AsyncCallback( callback ) );
+}
+
+void SCassandra::onAsyncComplete( CassFuture *future, void *data )
+{
+   AsyncCallback *callback = (AsyncCallback*)data;
+   SCassFuture f( future );
+
+   try
+   {
+      (*callback)( f );
+   }
+   catch ( ... )
+   {
+      // nothing may escape into the driver I/O thread
+   }
+
+   delete callback;
+}
@@ -80,7 +80,7 @@ extern void mme_app_set_pdn_connections(struct mme_ue_eps_pdn_connections_s * pd
 extern pdn_context_t * mme_app_handle_pdn_connectivity_from_s10(ue_context_t *ue_context, pdn_connection_t * pdn_connection);
 
 //------------------------------------------------------------------------------
-static bool mme_app_construct_guti(const plmn_t * const plmn_p, const s_tmsi_t * const s_tmsi_p,  guti_t * const guti_p)
+bool mme_app_construct_guti(const plmn_t * const plmn_p, const s_tmsi_t * const s_tmsi_p,  guti_t * const guti_p)
 {
   /*
    * This is a helper function to construct GUTI from S-TMSI. It uses PLMN id and MME Group Id of the serving MME for
@@ -474,7 +474,6 @@ mme_app_handle_initial_ue_message (
   bool                                    is_guti_valid = false;
   emm_data_context_t                     *ue_nas_ctx = NULL;
   enb_s1ap_id_key_t                       enb_s1ap_id_key = 0;
-  void                                   *id = NULL;
 
   OAILOG_DEBUG (LOG_MME_APP, "Received MME_APP_INITIAL_UE_MESSAGE from S1AP\n");
 
@@ -557,8 +556,8 @@ mme_app_handle_initial_ue_message (
                  * Error during ue context malloc.
                  * todo: removing the UE reference?!
                  */
-                hashtable_rc_t result_deletion = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl,
-                    (const hash_key_t)enb_s1ap_id_key, (void **)&id);
+                hashtable_rc_t result_deletion = multikey_index_remove (mme_app_desc.mme_ue_contexts.ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID,
+                    (const hash_key_t)enb_s1ap_id_key, 0, NULL);
                 OAILOG_ERROR (LOG_MME_APP, "MME_APP_INITAIL_UE_MESSAGE. ERROR***** enb_s1ap_id_key %ld has valid value %ld. Result of deletion %d.\n" ,
                     enb_s1ap_id_key,
                     initial_pP->enb_ue_s1ap_id,
@@ -589,8 +588,8 @@ mme_app_handle_initial_ue_message (
              * connection.
              * However if this key is valid, remove the key from the hashtable.
              */
-            hashtable_rc_t result_deletion = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl,
-                (const hash_key_t)ue_context->enb_s1ap_id_key, (void **)&id);
+            hashtable_rc_t result_deletion = multikey_index_remove (mme_app_desc.mme_ue_contexts.ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID,
+                (const hash_key_t)ue_context->enb_s1ap_id_key, 0, NULL);
             OAILOG_ERROR (LOG_MME_APP, "MME_APP_INITAIL_UE_MESSAGE. ERROR***** enb_s1ap_id_key %ld has valid value %ld. Result of deletion %d.\n" ,
                 ue_context->enb_s1ap_id_key,
                 ue_context->enb_ue_s1ap_id,
@@ -645,8 +644,8 @@ mme_app_handle_initial_ue_message (
        * Error during UE context malloc.
        * todo: removing the UE reference?!
        */
-      hashtable_rc_t result_deletion = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl,
-          (const hash_key_t)ue_context->enb_s1ap_id_key, (void **)&id);
+      hashtable_rc_t result_deletion = multikey_index_remove (mme_app_desc.mme_ue_contexts.ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID,
+          (const hash_key_t)ue_context->enb_s1ap_id_key, 0, NULL);
       OAILOG_ERROR (LOG_MME_APP, "MME_APP_INITAIL_UE_MESSAGE. ERROR***** enb_s1ap_id_key %ld has valid value %ld. Result of deletion %d.\n" ,
           ue_context->enb_s1ap_id_key,
           ue_context->enb_ue_s1ap_id,
@@ -843,8 +842,8 @@ mme_app_handle_delete_session_rsp (
   /*
    * Updating statistics
    */
-  mme_app_desc.mme_ue_contexts.nb_bearers_managed--;
-  mme_app_desc.mme_ue_contexts.nb_bearers_since_last_stat--;
+  __sync_fetch_and_sub (&mme_app_desc.mme_ue_contexts.nb_bearers_managed, 1);
+  __sync_fetch_and_sub (&mme_app_desc.mme_ue_contexts.nb_bearers_since_last_stat, 1);
 
   /**
    * Object is later removed, not here. For unused keys, this is no problem, just deregistrate the tunnel ids for the MME_APP
@@ -854,8 +853,8 @@ mme_app_handle_delete_session_rsp (
   // todo: handle this! where to remove the S11 Tunnel?
 //  if(ue_context->num_pdns == 1){
 //    /** This was the last PDN, removing the S11 TEID. */
-//    hashtable_ts_remove(mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl,
-//        (const hash_key_t) ue_context->mme_teid_s11, &id);
+//    multikey_index_remove(mme_app_desc.mme_ue_contexts.ue_context_index, MME_APP_UE_KEY_S11_TEID,
+//        (const hash_key_t) ue_context->mme_teid_s11, 0, NULL);
 //    ue_context->mme_teid_s11 = INVALID_TEID;
 //    /** SAE-GW TEID will be initialized when PDN context is purged. */
 //  }
@@ -1017,8 +1016,8 @@ mme_app_handle_create_sess_resp (
     /*
      * Updating statistics
      */
-    mme_app_desc.mme_ue_contexts.nb_bearers_managed++;
-    mme_app_desc.mme_ue_contexts.nb_bearers_since_last_stat++;
+    __sync_fetch_and_add (&mme_app_desc.mme_ue_contexts.nb_bearers_managed, 1);
+    __sync_fetch_and_add (&mme_app_desc.mme_ue_contexts.nb_bearers_since_last_stat, 1);
     current_bearer_p->s_gw_fteid_s1u = create_sess_resp_pP->bearer_contexts_created.bearer_contexts[i].s1u_sgw_fteid; /**< Also copying the IPv4/V6 address. */
     current_bearer_p->p_gw_fteid_s5_s8_up = create_sess_resp_pP->bearer_contexts_created.bearer_contexts[i].s5_s8_u_pgw_fteid;
 
@@ -1383,6 +1382,31 @@ mme_app_handle_downlink_data_notification(const itti_s11_downlink_data_notificat
   // todo: these ones may differ from GUTI?
   s1ap_paging_p->tai.plmn = ue_context->guti.gummei.plmn;
   s1ap_paging_p->tai.tac  = *mme_config.served_tai.tac;
+  /*
+   * TAI list of the UE: the one given in the Attach/TAU Accept is built from the served TAIs (mme_api_get_emm_config),
+   * S1AP pages the UE on every eNB serving one of them.
+   */
+  mme_config_read_lock (&mme_config);
+  s1ap_paging_p->nb_tai = (TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_CONSECUTIVE_TACS == mme_config.served_tai.list_type) ? 1 :
+      ((mme_config.served_tai.nb_tai < S1AP_PAGING_MAX_TAI) ? mme_config.served_tai.nb_tai : S1AP_PAGING_MAX_TAI);
+  for (int i = 0; i < s1ap_paging_p->nb_tai; i++) {
+    plmn_t *plmn = &s1ap_paging_p->tai_list[i].plmn;
+
+    plmn->mcc_digit1 = (mme_config.served_tai.plmn_mcc[i] / 100) % 10;
+    plmn->mcc_digit2 = (mme_config.served_tai.plmn_mcc[i] / 10) % 10;
+    plmn->mcc_digit3 = mme_config.served_tai.plmn_mcc[i] % 10;
+    if (mme_config.served_tai.plmn_mnc_len[i] == 2) {
+      plmn->mnc_digit1 = (mme_config.served_tai.plmn_mnc[i] / 10) % 10;
+      plmn->mnc_digit2 = mme_config.served_tai.plmn_mnc[i] % 10;
+      plmn->mnc_digit3 = 0xf;
+    } else {
+      plmn->mnc_digit1 = (mme_config.served_tai.plmn_mnc[i] / 100) % 10;
+      plmn->mnc_digit2 = (mme_config.served_tai.plmn_mnc[i] / 10) % 10;
+      plmn->mnc_digit3 = mme_config.served_tai.plmn_mnc[i] % 10;
+    }
+    s1ap_paging_p->tai_list[i].tac = mme_config.served_tai.tac[i];
+  }
+  mme_config_unlock (&mme_config);
   OAILOG_INFO(LOG_MME_APP, "Calculated ue_identity index value for UE with imsi " IMSI_64_FMT " and ueId " MME_UE_S1AP_ID_FMT" is %d. \n", ue_context->imsi, ue_context->mme_ue_s1ap_id, s1ap_paging_p->ue_identity_index);
 
   /** S1AP Paging. */
@@ -51,9 +51,10 @@
 
 /**
  * Create a bearer context pool, not to reallocate for each new UE.
+ * One pool per MME_APP shard thread, the shards do not share it.
  * todo: remove the pool with shutdown?
  */
-static bearer_context_t                 *bearerContextPool = NULL;
+static __thread bearer_context_t        *bearerContextPool = NULL;
 
 //------------------------------------------------------------------------------
 bstring bearer_state2string(const mme_app_bearer_state_t bearer_state)
@@ -256,40 +256,46 @@ void mme_app_ue_context_free_content (ue_context_t * const ue_context)
   memset(ue_context, 0, sizeof(*ue_context));
 }
 
-////------------------------------------------------------------------------------
-//ue_context_t                           *
-//mme_ue_context_exists_enb_ue_s1ap_id (
-//  mme_ue_context_t * const mme_ue_context_p,
-//  const enb_s1ap_id_key_t enb_key)
-//{
-//  struct ue_context_s                    *ue_context = NULL;
-//
-//  hashtable_ts_get (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)enb_key, (void **)&ue_context);
-//  if (ue_context) {
-//    OAILOG_TRACE (LOG_MME_APP, "Fetched ue_context (key " MME_APP_ENB_S1AP_ID_KEY_FORMAT ") MME_UE_S1AP_ID=" MME_UE_S1AP_ID_FMT " ENB_UE_S1AP_ID=" ENB_UE_S1AP_ID_FMT " @%p\n",
-//        enb_key, ue_context->mme_ue_s1ap_id, ue_context->enb_ue_s1ap_id, ue_context);
-//  }
-//  return ue_context;
-//}
 
-////------------------------------------------------------------------------------
-//ue_context_t                           *
-//mme_ue_context_exists_mme_ue_s1ap_id (
-//  mme_ue_context_t * const mme_ue_context_p,
-//  const mme_ue_s1ap_id_t mme_ue_s1ap_id)
-//{
-//  hashtable_rc_t                          h_rc = HASH_TABLE_OK;
-//  uint64_t                                enb_s1ap_id_key64 = 0;
-//
-//  h_rc = hashtable_uint64_ts_get (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, &enb_s1ap_id_key64);
-//
-//  if (HASH_TABLE_OK == h_rc) {
-//    return mme_ue_context_exists_enb_ue_s1ap_id (mme_ue_context_p, (enb_s1ap_id_key_t) enb_s1ap_id_key64);
-//  }
-//
-//  return NULL;
-//}
+//------------------------------------------------------------------------------
+static inline void
+mme_app_guti_to_index_key (
+  const guti_t * const guti_p,
+  uint64_t     * const key,
+  uint32_t     * const key_ext)
+{
+  const uint8_t                          *plmn = (const uint8_t *)&guti_p->gummei.plmn;
+
+  *key = ((uint64_t)guti_p->gummei.mme_gid << 40) | ((uint64_t)guti_p->gummei.mme_code << 32) | (uint64_t)guti_p->m_tmsi;
+  *key_ext = ((uint32_t)plmn[0] << 16) | ((uint32_t)plmn[1] << 8) | (uint32_t)plmn[2];
+}
 
+//------------------------------------------------------------------------------
+static hashtable_rc_t
+mme_app_guti_index_insert (
+  mme_ue_context_t * const mme_ue_context_p,
+  const guti_t     * const guti_p,
+  ue_context_t     * const ue_context)
+{
+  uint64_t                                key = 0;
+  uint32_t                                key_ext = 0;
+
+  mme_app_guti_to_index_key (guti_p, &key, &key_ext);
+  return multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_GUTI, key, key_ext, (void *)ue_context);
+}
+
+//------------------------------------------------------------------------------
+static hashtable_rc_t
+mme_app_guti_index_remove (
+  mme_ue_context_t * const mme_ue_context_p,
+  const guti_t     * const guti_p)
+{
+  uint64_t                                key = 0;
+  uint32_t                                key_ext = 0;
+
+  mme_app_guti_to_index_key (guti_p, &key, &key_ext);
+  return multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_GUTI, key, key_ext, NULL);
+}
 
 //------------------------------------------------------------------------------
 ue_context_t                           *
@@ -297,15 +303,10 @@ mme_ue_context_exists_enb_ue_s1ap_id (
   mme_ue_context_t * const mme_ue_context_p,
   const enb_s1ap_id_key_t enb_key)
 {
-  hashtable_rc_t                          h_rc = HASH_TABLE_OK;
-  uint64_t                                mme_ue_s1ap_id64 = 0;
-
-  hashtable_uint64_ts_get (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)enb_key, &mme_ue_s1ap_id64);
+  struct ue_context_s                    *ue_context = NULL;
 
-  if (HASH_TABLE_OK == h_rc) {
-    return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t) mme_ue_s1ap_id64);
-  }
-  return NULL;
+  multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID, (const hash_key_t)enb_key, 0, (void **)&ue_context);
+  return ue_context;
 }
 
 //------------------------------------------------------------------------------
@@ -316,15 +317,8 @@ mme_ue_context_exists_mme_ue_s1ap_id (
 {
   struct ue_context_s                    *ue_context = NULL;
 
-  hashtable_ts_get (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void **)&ue_context);
-  if (ue_context) {
-//    lock_ue_contexts(ue_context);
-//    OAILOG_TRACE (LOG_MME_APP, "UE  " MME_UE_S1AP_ID_FMT " fetched MM state %s, ECM state %s\n ",mme_ue_s1ap_id,
-//        (ue_context->mm_state == UE_UNREGISTERED) ? "UE_UNREGISTERED":(ue_context->mm_state == UE_REGISTERED) ? "UE_REGISTERED":"UNKNOWN",
-//        (ue_context->ecm_state == ECM_IDLE) ? "ECM_IDLE":(ue_context->ecm_state == ECM_CONNECTED) ? "ECM_CONNECTED":"UNKNOWN");
-  }
+  multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, (const hash_key_t)mme_ue_s1ap_id, 0, (void **)&ue_context);
   return ue_context;
-
 }
 
 //------------------------------------------------------------------------------
@@ -333,16 +327,10 @@ mme_ue_context_exists_imsi (
   mme_ue_context_t * const mme_ue_context_p,
   const imsi64_t imsi)
 {
-  hashtable_rc_t                          h_rc = HASH_TABLE_OK;
-  uint64_t                                mme_ue_s1ap_id64 = 0;
-
-  h_rc = hashtable_uint64_ts_get (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)imsi, &mme_ue_s1ap_id64);
-
-  if (HASH_TABLE_OK == h_rc) {
-    return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t)mme_ue_s1ap_id64);
-  }
+  struct ue_context_s                    *ue_context = NULL;
 
-  return NULL;
+  multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_IMSI, (const hash_key_t)imsi, 0, (void **)&ue_context);
+  return ue_context;
 }
 
 //------------------------------------------------------------------------------
@@ -351,15 +339,10 @@ mme_ue_context_exists_s11_teid (
   mme_ue_context_t * const mme_ue_context_p,
   const s11_teid_t teid)
 {
-  hashtable_rc_t                          h_rc = HASH_TABLE_OK;
-  uint64_t                                mme_ue_s1ap_id64 = 0;
-
-  h_rc = hashtable_uint64_ts_get (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)teid, &mme_ue_s1ap_id64);
+  struct ue_context_s                    *ue_context = NULL;
 
-  if (HASH_TABLE_OK == h_rc) {
-    return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t) mme_ue_s1ap_id64);
-  }
-  return NULL;
+  multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S11_TEID, (const hash_key_t)teid, 0, (void **)&ue_context);
+  return ue_context;
 }
 
 //------------------------------------------------------------------------------
@@ -368,15 +351,10 @@ mme_ue_context_exists_s10_teid (
   mme_ue_context_t * const mme_ue_context_p,
   const s10_teid_t teid)
 {
-  hashtable_rc_t                          h_rc = HASH_TABLE_OK;
-  uint64_t                                mme_ue_s1ap_id64 = 0;
-
-  h_rc = hashtable_uint64_ts_get (mme_ue_context_p->tun10_ue_context_htbl, (const hash_key_t)teid, &mme_ue_s1ap_id64);
+  struct ue_context_s                    *ue_context = NULL;
 
-  if (HASH_TABLE_OK == h_rc) {
-    return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t) mme_ue_s1ap_id64);
-  }
-  return NULL;
+  multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S10_TEID, (const hash_key_t)teid, 0, (void **)&ue_context);
+  return ue_context;
 }
 
 //------------------------------------------------------------------------------
@@ -385,16 +363,13 @@ mme_ue_context_exists_guti (
   mme_ue_context_t * const mme_ue_context_p,
   const guti_t * const guti_p)
 {
-  hashtable_rc_t                          h_rc = HASH_TABLE_OK;
-  uint64_t                                mme_ue_s1ap_id64 = 0;
-
-  h_rc = obj_hashtable_uint64_ts_get (mme_ue_context_p->guti_ue_context_htbl, (const void *)guti_p, sizeof (*guti_p), &mme_ue_s1ap_id64);
-
-  if (HASH_TABLE_OK == h_rc) {
-    return mme_ue_context_exists_mme_ue_s1ap_id (mme_ue_context_p, (mme_ue_s1ap_id_t)mme_ue_s1ap_id64);
-  }
+  struct ue_context_s                    *ue_context = NULL;
+  uint64_t                                key = 0;
+  uint32_t                                key_ext = 0;
 
-  return NULL;
+  mme_app_guti_to_index_key (guti_p, &key, &key_ext);
+  multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_GUTI, key, key_ext, (void **)&ue_context);
+  return ue_context;
 }
 
 //------------------------------------------------------------------------------
@@ -422,9 +397,7 @@ mme_ue_context_notified_new_ue_s1ap_id_association (
     if (ue_context->enb_s1ap_id_key == enb_key) { // useless
       if (INVALID_MME_UE_S1AP_ID == ue_context->mme_ue_s1ap_id) {
         // new insertion of mme_ue_s1ap_id, not a change in the id
-        h_rc = hashtable_uint64_ts_insert (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (uint64_t)enb_key);
-        // todo: insert via mme_app_ue_s1ap_id
-//                h_rc = hashtable_ts_insert (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void *)ue_context);
+        h_rc = multikey_index_insert (mme_app_desc.mme_ue_contexts.ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, (const hash_key_t)mme_ue_s1ap_id, 0, (void *)ue_context);
         if (HASH_TABLE_OK == h_rc) {
           ue_context->mme_ue_s1ap_id = mme_ue_s1ap_id;
           OAILOG_DEBUG (LOG_MME_APP,
@@ -462,7 +435,6 @@ mme_ue_context_update_coll_keys (
   const guti_t     * const guti_p)  //  never NULL, if none put &ue_context->guti
 {
   hashtable_rc_t                          h_rc = HASH_TABLE_OK;
-  void                                   *id = NULL;
 
   OAILOG_FUNC_IN(LOG_MME_APP);
 
@@ -487,8 +459,8 @@ mme_ue_context_update_coll_keys (
 
   if ((INVALID_ENB_UE_S1AP_ID_KEY != enb_s1ap_id_key) && (ue_context->enb_s1ap_id_key != enb_s1ap_id_key)) {
     // new insertion of enb_ue_s1ap_id_key,
-    h_rc = hashtable_ts_remove (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context->enb_s1ap_id_key, (void **)&id);
-    h_rc = hashtable_ts_insert (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)enb_s1ap_id_key, (void *)(uintptr_t)mme_ue_s1ap_id);
+    h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID, (const hash_key_t)ue_context->enb_s1ap_id_key, 0, NULL);
+    h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID, (const hash_key_t)enb_s1ap_id_key, 0, (void *)ue_context);
 
     if (HASH_TABLE_OK != h_rc) {
       OAILOG_ERROR (LOG_MME_APP,
@@ -501,8 +473,8 @@ mme_ue_context_update_coll_keys (
 
   if ((INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) && (ue_context->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
     // new insertion of mme_ue_s1ap_id, not a change in the id
-    h_rc = hashtable_ts_remove (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context->mme_ue_s1ap_id,  (void **)&ue_context);
-    h_rc = hashtable_ts_insert (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void *)ue_context);
+    h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, (const hash_key_t)ue_context->mme_ue_s1ap_id, 0, NULL);
+    h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, (const hash_key_t)mme_ue_s1ap_id, 0, (void *)ue_context);
 
     if (HASH_TABLE_OK != h_rc) {
       OAILOG_ERROR (LOG_MME_APP,
@@ -512,8 +484,8 @@ mme_ue_context_update_coll_keys (
     ue_context->mme_ue_s1ap_id = mme_ue_s1ap_id;
 
     if (INVALID_IMSI64 != imsi) {
-      h_rc = hashtable_ts_remove (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)ue_context->imsi, (void **)&id);
-      h_rc = hashtable_ts_insert (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)imsi, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_IMSI, (const hash_key_t)ue_context->imsi, 0, NULL);
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_IMSI, (const hash_key_t)imsi, 0, (void *)ue_context);
       if (HASH_TABLE_OK != h_rc) {
         OAILOG_ERROR (LOG_MME_APP,
             "Error could not update this ue context %p enb_ue_s1ap_ue_id " ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " imsi " IMSI_64_FMT ": %s\n",
@@ -522,8 +494,8 @@ mme_ue_context_update_coll_keys (
         ue_context->imsi = imsi;
       }
       /** S11 Key. */
-      h_rc = hashtable_ts_remove (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)ue_context->mme_teid_s11, (void **)&id);
-      h_rc = hashtable_ts_insert (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)mme_teid_s11, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S11_TEID, (const hash_key_t)ue_context->mme_teid_s11, 0, NULL);
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S11_TEID, (const hash_key_t)mme_teid_s11, 0, (void *)ue_context);
       if (HASH_TABLE_OK != h_rc) {
         OAILOG_TRACE (LOG_MME_APP,
             "Error could not update this ue context %p enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " mme_teid_s11 " TEID_FMT " : %s\n",
@@ -532,8 +504,8 @@ mme_ue_context_update_coll_keys (
       ue_context->mme_teid_s11= mme_teid_s11;
 
       /** S10 Key. */
-      h_rc = hashtable_ts_remove (mme_ue_context_p->tun10_ue_context_htbl, (const hash_key_t)ue_context->local_mme_teid_s10, (void **)&id);
-      h_rc = hashtable_ts_insert (mme_ue_context_p->tun10_ue_context_htbl, (const hash_key_t)local_mme_teid_s10, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S10_TEID, (const hash_key_t)ue_context->local_mme_teid_s10, 0, NULL);
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S10_TEID, (const hash_key_t)local_mme_teid_s10, 0, (void *)ue_context);
       if (HASH_TABLE_OK != h_rc) {
         OAILOG_TRACE (LOG_MME_APP,
             "Error could not update this ue context %p enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " local_mme_teid_s10 " TEID_FMT " : %s\n",
@@ -544,8 +516,8 @@ mme_ue_context_update_coll_keys (
 
       if (guti_p)
       {
-        h_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, (const void *const)&ue_context->guti, sizeof (ue_context->guti), (void **)&id);
-        h_rc = obj_hashtable_ts_insert (mme_ue_context_p->guti_ue_context_htbl, (const void *const)guti_p, sizeof (*guti_p), (void *)(uintptr_t)mme_ue_s1ap_id);
+        h_rc = mme_app_guti_index_remove (mme_ue_context_p, &ue_context->guti);
+        h_rc = mme_app_guti_index_insert (mme_ue_context_p, guti_p, ue_context);
         if (HASH_TABLE_OK != h_rc) {
           OAILOG_TRACE (LOG_MME_APP, "Error could not update this ue context %p enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " guti " GUTI_FMT " %s\n",
               ue_context, ue_context->enb_ue_s1ap_id, ue_context->mme_ue_s1ap_id, GUTI_ARG(guti_p), hashtable_rc_code2string(h_rc));
@@ -556,9 +528,9 @@ mme_ue_context_update_coll_keys (
 
   if ((ue_context->imsi != imsi)
       || (ue_context->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
-    h_rc = hashtable_ts_remove (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)ue_context->imsi, (void **)&id);
+    h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_IMSI, (const hash_key_t)ue_context->imsi, 0, NULL);
     if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
-      h_rc = hashtable_ts_insert (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)imsi, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_IMSI, (const hash_key_t)imsi, 0, (void *)ue_context);
     } else {
       h_rc = HASH_TABLE_KEY_NOT_EXISTS;
     }
@@ -573,9 +545,9 @@ mme_ue_context_update_coll_keys (
   /** S11. */
   if ((ue_context->mme_teid_s11 != mme_teid_s11)
       || (ue_context->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
-    h_rc = hashtable_ts_remove (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)ue_context->mme_teid_s11, (void **)&id);
+    h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S11_TEID, (const hash_key_t)ue_context->mme_teid_s11, 0, NULL);
     if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id && INVALID_TEID != mme_teid_s11) {
-      h_rc = hashtable_ts_insert (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)mme_teid_s11, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S11_TEID, (const hash_key_t)mme_teid_s11, 0, (void *)ue_context);
     } else {
       h_rc = HASH_TABLE_KEY_NOT_EXISTS;
     }
@@ -591,9 +563,9 @@ mme_ue_context_update_coll_keys (
   /** S10. */
   if ((ue_context->local_mme_teid_s10 != local_mme_teid_s10)
       || (ue_context->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
-    h_rc = hashtable_ts_remove (mme_ue_context_p->tun10_ue_context_htbl, (const hash_key_t)ue_context->local_mme_teid_s10, (void **)&id);
+    h_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S10_TEID, (const hash_key_t)ue_context->local_mme_teid_s10, 0, NULL);
     if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id && INVALID_TEID != local_mme_teid_s10) {
-      h_rc = hashtable_ts_insert (mme_ue_context_p->tun10_ue_context_htbl, (const hash_key_t)local_mme_teid_s10, (void *)(uintptr_t)mme_ue_s1ap_id);
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S10_TEID, (const hash_key_t)local_mme_teid_s10, 0, (void *)ue_context);
     } else {
       h_rc = HASH_TABLE_KEY_NOT_EXISTS;
     }
@@ -617,9 +589,9 @@ mme_ue_context_update_coll_keys (
         || (ue_context->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
 
         // may check guti_p with a kind of instanceof()?
-        h_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, &ue_context->guti, sizeof (*guti_p), (void **)&id);
+        h_rc = mme_app_guti_index_remove (mme_ue_context_p, &ue_context->guti);
         if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
-          h_rc = obj_hashtable_ts_insert (mme_ue_context_p->guti_ue_context_htbl, (const void *const)guti_p, sizeof (*guti_p), (void *)(uintptr_t)mme_ue_s1ap_id);
+          h_rc = mme_app_guti_index_insert (mme_ue_context_p, guti_p, ue_context);
         } else {
           h_rc = HASH_TABLE_KEY_NOT_EXISTS;
         }
@@ -641,28 +613,9 @@ void mme_ue_context_dump_coll_keys(void)
   bstring tmp = bfromcstr(" ");
   btrunc(tmp, 0);
 
-  hashtable_uint64_ts_dump_content (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"imsi_ue_context_htbl %s\n", bdata(tmp));
-
-  btrunc(tmp, 0);
-  hashtable_uint64_ts_dump_content (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"tun11_ue_context_htbl %s\n", bdata(tmp));
-
-  btrunc(tmp, 0);
-  hashtable_uint64_ts_dump_content (mme_app_desc.mme_ue_contexts.tun10_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"tun10_ue_context_htbl %s\n", bdata(tmp));
-
-  btrunc(tmp, 0);
-  hashtable_uint64_ts_dump_content (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"mme_ue_s1ap_id_ue_context_htbl %s\n", bdata(tmp));
-
-  btrunc(tmp, 0);
-  hashtable_ts_dump_content (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"enb_ue_s1ap_id_ue_context_htbl %s\n", bdata(tmp));
-
-  btrunc(tmp, 0);
-  obj_hashtable_uint64_ts_dump_content (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl, tmp);
-  OAILOG_TRACE (LOG_MME_APP,"guti_ue_context_htbl %s", bdata(tmp));
+  multikey_index_dump_content (mme_app_desc.mme_ue_contexts.ue_context_index, tmp);
+  OAILOG_TRACE (LOG_MME_APP,"ue_context_index %s\n", bdata(tmp));
+  bdestroy_wrapper(&tmp);
 }
 
 // todo: check the locks here
@@ -682,15 +635,13 @@ mme_insert_ue_context (
     // filled ENB UE S1AP ID
     /** Check that the eNB_S1AP_ID_KEY exists. */
     if(ue_context->enb_s1ap_id_key != INVALID_ENB_UE_S1AP_ID_KEY){
-      h_rc = hashtable_ts_is_key_exists (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context->enb_s1ap_id_key);
+      h_rc = multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID, (const hash_key_t)ue_context->enb_s1ap_id_key, 0, NULL);
       if (HASH_TABLE_OK == h_rc) {
         OAILOG_DEBUG (LOG_MME_APP, "This ue context %p already exists enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT "\n",
             ue_context, ue_context->enb_ue_s1ap_id);
         OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
       }
-      h_rc = hashtable_ts_insert (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl,
-                                 (const hash_key_t)ue_context->enb_s1ap_id_key,
-                                  (void *)((uintptr_t)ue_context->mme_ue_s1ap_id));
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID, (const hash_key_t)ue_context->enb_s1ap_id_key, 0, (void *)ue_context);
     }else{
       OAILOG_DEBUG (LOG_MME_APP, "The received enb_ue_s1ap_id_key is invalid " ENB_UE_S1AP_ID_FMT ". Skipping. \n",
           ue_context, ue_context->enb_ue_s1ap_id);
@@ -703,7 +654,7 @@ mme_insert_ue_context (
     }
 
     if (INVALID_MME_UE_S1AP_ID != ue_context->mme_ue_s1ap_id) {
-      h_rc = hashtable_ts_is_key_exists (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context->mme_ue_s1ap_id);
+      h_rc = multikey_index_get (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, (const hash_key_t)ue_context->mme_ue_s1ap_id, 0, NULL);
 
       if (HASH_TABLE_OK == h_rc) {
         OAILOG_DEBUG (LOG_MME_APP, "This ue context %p already exists mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT "\n",
@@ -711,9 +662,7 @@ mme_insert_ue_context (
         OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
       }
 
-      h_rc = hashtable_ts_insert (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl,
-                                  (const hash_key_t)ue_context->mme_ue_s1ap_id,
-                                  (void *)ue_context);
+      h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, (const hash_key_t)ue_context->mme_ue_s1ap_id, 0, (void *)ue_context);
 
       if (HASH_TABLE_OK != h_rc) {
         OAILOG_DEBUG (LOG_MME_APP, "Error could not register this ue context %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT "\n",
@@ -723,9 +672,7 @@ mme_insert_ue_context (
 
       // filled IMSI
       if (ue_context->imsi) {
-        h_rc = hashtable_ts_insert (mme_ue_context_p->imsi_ue_context_htbl,
-                                    (const hash_key_t)ue_context->imsi,
-                                    (void *)((uintptr_t)ue_context->mme_ue_s1ap_id));
+        h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_IMSI, (const hash_key_t)ue_context->imsi, 0, (void *)ue_context);
 
         if (HASH_TABLE_OK != h_rc) {
           OAILOG_DEBUG (LOG_MME_APP, "Error could not register this ue context %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " imsi %" SCNu64 "\n",
@@ -736,9 +683,7 @@ mme_insert_ue_context (
 
       // filled S11 tun id
       if (ue_context->mme_teid_s11) {
-        h_rc = hashtable_ts_insert (mme_ue_context_p->tun11_ue_context_htbl,
-                                   (const hash_key_t)ue_context->mme_teid_s11,
-                                   (void *)((uintptr_t)ue_context->mme_ue_s1ap_id));
+        h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S11_TEID, (const hash_key_t)ue_context->mme_teid_s11, 0, (void *)ue_context);
 
         if (HASH_TABLE_OK != h_rc) {
           OAILOG_DEBUG (LOG_MME_APP, "Error could not register this ue context %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " mme_teid_s11 " TEID_FMT "\n",
@@ -749,9 +694,7 @@ mme_insert_ue_context (
 
       // filled S10 tun id
       if (ue_context->local_mme_teid_s10) {
-        h_rc = hashtable_ts_insert (mme_ue_context_p->tun10_ue_context_htbl,
-            (const hash_key_t)ue_context->local_mme_teid_s10,
-            (void *)((uintptr_t)ue_context->mme_ue_s1ap_id));
+        h_rc = multikey_index_insert (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S10_TEID, (const hash_key_t)ue_context->local_mme_teid_s10, 0, (void *)ue_context);
 
         if (HASH_TABLE_OK != h_rc) {
           OAILOG_DEBUG (LOG_MME_APP, "Error could not register this ue context %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " local_mme_teid_s10 " TEID_FMT "\n",
@@ -765,10 +708,7 @@ mme_insert_ue_context (
           (0 != ue_context->guti.gummei.plmn.mcc_digit2)
           || (0 != ue_context->guti.gummei.plmn.mcc_digit3)) {
 
-        h_rc = obj_hashtable_ts_insert (mme_ue_context_p->guti_ue_context_htbl,
-                                       (const void *const)&ue_context->guti,
-                                       sizeof (ue_context->guti),
-                                       (void *)((uintptr_t)ue_context->mme_ue_s1ap_id));
+        h_rc = mme_app_guti_index_insert (mme_ue_context_p, &ue_context->guti, (ue_context_t *)ue_context);
 
         if (HASH_TABLE_OK != h_rc) {
           OAILOG_DEBUG (LOG_MME_APP, "Error could not register this ue context %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " guti "GUTI_FMT"\n",
@@ -817,7 +757,6 @@ void mme_remove_ue_context (
   mme_ue_context_t * const mme_ue_context_p,
   struct ue_context_s *ue_context)
 {
-  unsigned int                           *id = NULL;
   hashtable_rc_t                          hash_rc = HASH_TABLE_OK;
 
   OAILOG_FUNC_IN (LOG_MME_APP);
@@ -826,21 +765,21 @@ void mme_remove_ue_context (
 
   // IMSI
   if (ue_context->imsi) {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->imsi_ue_context_htbl, (const hash_key_t)ue_context->imsi, (void **)&id);
+    hash_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_IMSI, (const hash_key_t)ue_context->imsi, 0, NULL);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", IMSI %" SCNu64 "  not in IMSI collection",
           ue_context->enb_ue_s1ap_id, ue_context->mme_ue_s1ap_id, ue_context->imsi);
   }
 
   // eNB UE S1P UE ID
-  hash_rc = hashtable_ts_remove (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context->enb_s1ap_id_key, (void **)&id);
+  hash_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID, (const hash_key_t)ue_context->enb_s1ap_id_key, 0, NULL);
   if (HASH_TABLE_OK != hash_rc)
     OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", ENB_UE_S1AP_ID not ENB_UE_S1AP_ID collection",
       ue_context->enb_ue_s1ap_id, ue_context->mme_ue_s1ap_id);
 
   // filled S11 tun id
   if (ue_context->mme_teid_s11) {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)ue_context->mme_teid_s11, (void **)&id);
+    hash_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S11_TEID, (const hash_key_t)ue_context->mme_teid_s11, 0, NULL);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", MME TEID_S11 " TEID_FMT "  not in S11 collection",
           ue_context->enb_ue_s1ap_id, ue_context->mme_ue_s1ap_id, ue_context->mme_teid_s11);
@@ -848,7 +787,7 @@ void mme_remove_ue_context (
 
   // filled S10 tun id
   if (ue_context->local_mme_teid_s10) {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->tun11_ue_context_htbl, (const hash_key_t)ue_context->local_mme_teid_s10, (void **)&id);
+    hash_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_S10_TEID, (const hash_key_t)ue_context->local_mme_teid_s10, 0, NULL);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", LOCAL MME TEID S10 " TEID_FMT "  not in S10 collection",
           ue_context->enb_ue_s1ap_id, ue_context->mme_ue_s1ap_id, ue_context->local_mme_teid_s10);
@@ -857,7 +796,7 @@ void mme_remove_ue_context (
   // filled guti
   if ((ue_context->guti.gummei.mme_code) || (ue_context->guti.gummei.mme_gid) || (ue_context->guti.m_tmsi) ||
       (ue_context->guti.gummei.plmn.mcc_digit1) || (ue_context->guti.gummei.plmn.mcc_digit2) || (ue_context->guti.gummei.plmn.mcc_digit3)) { // MCC 000 does not exist in ITU table
-    hash_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, (const void *const)&ue_context->guti, sizeof (ue_context->guti), (void **)&id);
+    hash_rc = mme_app_guti_index_remove (mme_ue_context_p, &ue_context->guti);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", GUTI  not in GUTI collection",
           ue_context->enb_ue_s1ap_id, ue_context->mme_ue_s1ap_id);
@@ -865,7 +804,7 @@ void mme_remove_ue_context (
 
   // filled NAS UE ID/ MME UE S1AP ID
   if (INVALID_MME_UE_S1AP_ID != ue_context->mme_ue_s1ap_id) {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context->mme_ue_s1ap_id, (void **)&ue_context);
+    hash_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, (const hash_key_t)ue_context->mme_ue_s1ap_id, 0, NULL);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT ", mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " not in MME UE S1AP ID collection",
           ue_context->enb_ue_s1ap_id, ue_context->mme_ue_s1ap_id);
@@ -1257,7 +1196,7 @@ mme_app_dump_ue_contexts (
   const mme_ue_context_t * const mme_ue_context_p)
 //------------------------------------------------------------------------------
 {
-  hashtable_ts_apply_callback_on_elements (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, mme_app_dump_ue_context, NULL, NULL);
+  multikey_index_apply_callback_on_elements (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_MME_UE_S1AP_ID, mme_app_dump_ue_context, NULL, NULL);
 }
 
 //------------------------------------------------------------------------------
@@ -1567,14 +1506,13 @@ void mme_ue_context_update_ue_sig_connection_state (
 {
   // Function is used to update UE's Signaling Connection State
   hashtable_rc_t                          hash_rc = HASH_TABLE_OK;
-  unsigned int                           *id = NULL;
 
   OAILOG_FUNC_IN (LOG_MME_APP);
   DevAssert (mme_ue_context_p);
   DevAssert (ue_context);
   if (new_ecm_state == ECM_IDLE)
   {
-    hash_rc = hashtable_ts_remove (mme_ue_context_p->enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context->enb_s1ap_id_key, (void **)&id);
+    hash_rc = multikey_index_remove (mme_ue_context_p->ue_context_index, MME_APP_UE_KEY_ENB_S1AP_ID, (const hash_key_t)ue_context->enb_s1ap_id_key, 0, NULL);
     if (HASH_TABLE_OK != hash_rc)
     {
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id_key %ld mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", ENB_UE_S1AP_ID_KEY could not be found",
@@ -2254,8 +2192,8 @@ pdn_context_t * mme_app_handle_pdn_connectivity_from_s10(ue_context_t *ue_contex
     /*
      * Set the bearer level QoS parameters and update the statistics.
      */
-    mme_app_desc.mme_ue_contexts.nb_bearers_managed++;
-    mme_app_desc.mme_ue_contexts.nb_bearers_since_last_stat++;
+    __sync_fetch_and_add (&mme_app_desc.mme_ue_contexts.nb_bearers_managed, 1);
+    __sync_fetch_and_add (&mme_app_desc.mme_ue_contexts.nb_bearers_since_last_stat, 1);
     /* Received an initialized bearer context, set the QoS values from the pdn_connections IE. */
     mme_app_bearer_context_update_handover(bearer_context_registered, bearer_context_to_be_created_s10);
   }
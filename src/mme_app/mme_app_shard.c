@@ -0,0 +1,473 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_shard.c
+  \brief MME_APP worker shards: the UE related messages received by TASK_MME_APP are handled by one of N worker
+         threads, always the same one for a given UE, the other messages by the TASK_MME_APP thread (coordinator)
+         once the shards have handled every message received before.
+*/
+
+#define _GNU_SOURCE             // required for pthread_setname_np()
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+#include "bstrlib.h"
+
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "assertions.h"
+#include "conversions.h"
+#include "common_defs.h"
+#include "intertask_interface.h"
+#include "itti_free_defined_msg.h"
+#include "mme_config.h"
+#include "mme_default_values.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+#include "mme_app_shard.h"
+
+/*
+ * A UE is owned by the shard mme_ue_s1ap_id % nb_shards: its mme_ue_s1ap_id is allocated by the shard
+ * that creates its context, and only this shard modifies or removes the context. The UE context index
+ * is shared, any thread may look a context up without lock. A message keyed by IMSI, TEID or GUTI is
+ * routed by the mme_ue_s1ap_id of the context found with the key; if there is none, the message is
+ * handled by the coordinator while the shards are idle, and a context it creates belongs to shard 0.
+ */
+typedef struct mme_app_shard_s {
+  int                                     index;
+  pthread_t                               thread;
+  pthread_mutex_t                         mutex;
+  pthread_cond_t                          not_empty;    ///< Signaled by the coordinator when it queues a message
+  pthread_cond_t                          idle;         ///< Signaled by the shard when its queue is empty
+  // Messages queued by the coordinator, ring growing by doubling
+  MessageDef                            **queue;
+  uint32_t                                queue_mask;
+  uint64_t                                head;
+  uint64_t                                tail;
+  bool                                    busy;         ///< A message is being handled
+  bool                                    terminate;
+  uint32_t                                next_ue_id_rank;      ///< mme_ue_s1ap_id = rank * nb_shards + index
+  uint64_t                                messages_handled;
+} __attribute__((aligned(64))) mme_app_shard_t;
+
+typedef struct mme_app_shards_s {
+  uint16_t                                nb_shards;
+  mme_app_shard_t                        *shards;
+} mme_app_shards_t;
+
+static mme_app_shards_t                 g_mme_app_shards = {0};
+static __thread int                     g_mme_app_shard_self = MME_APP_SHARD_COORDINATOR;
+
+//------------------------------------------------------------------------------
+static void *mme_app_shard_thread (void *args)
+{
+  mme_app_shard_t                        *shard = (mme_app_shard_t *)args;
+
+  g_mme_app_shard_self = shard->index;
+  pthread_mutex_lock (&shard->mutex);
+  while (1) {
+    MessageDef                             *received_message_p = NULL;
+
+    while ((shard->head == shard->tail) && (!shard->terminate)) {
+      pthread_cond_wait (&shard->not_empty, &shard->mutex);
+    }
+    if (shard->head == shard->tail) {
+      break;
+    }
+    received_message_p = shard->queue[shard->tail & shard->queue_mask];
+    shard->tail += 1;
+    shard->busy = true;
+    pthread_mutex_unlock (&shard->mutex);
+
+    mme_app_handle_message (received_message_p);
+    itti_free_msg_content (received_message_p);
+    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+
+    pthread_mutex_lock (&shard->mutex);
+    shard->busy = false;
+    shard->messages_handled += 1;
+    if (shard->head == shard->tail) {
+      pthread_cond_broadcast (&shard->idle);
+    }
+  }
+  pthread_mutex_unlock (&shard->mutex);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+int mme_app_shards_init (const uint16_t nb_shards)
+{
+  AssertFatal (NULL == g_mme_app_shards.shards, "MME_APP shards already initialized");
+  memset (&g_mme_app_shards, 0, sizeof (g_mme_app_shards));
+  if (!nb_shards) {
+    OAILOG_DEBUG (LOG_MME_APP, "MME_APP without worker shards\n");
+    return RETURNok;
+  }
+  g_mme_app_shards.nb_shards = (nb_shards > MME_APP_MAX_SHARDS) ? MME_APP_MAX_SHARDS : nb_shards;
+  if (posix_memalign ((void **)&g_mme_app_shards.shards, 64, g_mme_app_shards.nb_shards * sizeof (mme_app_shard_t))) {
+    g_mme_app_shards.nb_shards = 0;
+    return RETURNerror;
+  }
+  memset (g_mme_app_shards.shards, 0, g_mme_app_shards.nb_shards * sizeof (mme_app_shard_t));
+  for (int i = 0; i < g_mme_app_shards.nb_shards; i++) {
+    mme_app_shard_t                        *shard = &g_mme_app_shards.shards[i];
+    char                                    name[16];
+
+    shard->index = i;
+    // mme_ue_s1ap_id 0 is never allocated
+    shard->next_ue_id_rank = (i) ? 0 : 1;
+    shard->queue_mask = MME_APP_SHARD_QUEUE_INITIAL_SIZE - 1;
+    shard->queue = calloc (MME_APP_SHARD_QUEUE_INITIAL_SIZE, sizeof (MessageDef *));
+    AssertFatal (shard->queue != NULL, "Failed to allocate queue of MME_APP shard %d\n", i);
+    pthread_mutex_init (&shard->mutex, NULL);
+    pthread_cond_init (&shard->not_empty, NULL);
+    pthread_cond_init (&shard->idle, NULL);
+    if (pthread_create (&shard->thread, NULL, &mme_app_shard_thread, (void *)shard)) {
+      OAILOG_ERROR (LOG_MME_APP, "pthread_create: %s:%d\n", strerror (errno), errno);
+      return RETURNerror;
+    }
+    snprintf (name, sizeof (name), "MME_APP_S%d", i);
+    pthread_setname_np (shard->thread, name);
+  }
+  OAILOG_DEBUG (LOG_MME_APP, "MME_APP started with %u worker shards\n", g_mme_app_shards.nb_shards);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_shards_exit (void)
+{
+  if (!g_mme_app_shards.shards) {
+    return;
+  }
+  for (int i = 0; i < g_mme_app_shards.nb_shards; i++) {
+    mme_app_shard_t                        *shard = &g_mme_app_shards.shards[i];
+
+    pthread_mutex_lock (&shard->mutex);
+    shard->terminate = true;
+    pthread_cond_signal (&shard->not_empty);
+    pthread_mutex_unlock (&shard->mutex);
+  }
+  for (int i = 0; i < g_mme_app_shards.nb_shards; i++) {
+    mme_app_shard_t                        *shard = &g_mme_app_shards.shards[i];
+
+    pthread_join (shard->thread, NULL);
+    OAILOG_DEBUG (LOG_MME_APP, "MME_APP shard %d handled %" PRIu64 " messages\n", i, shard->messages_handled);
+    pthread_cond_destroy (&shard->idle);
+    pthread_cond_destroy (&shard->not_empty);
+    pthread_mutex_destroy (&shard->mutex);
+    free_wrapper ((void**)&shard->queue);
+  }
+  free_wrapper ((void**)&g_mme_app_shards.shards);
+  g_mme_app_shards.nb_shards = 0;
+}
+
+//------------------------------------------------------------------------------
+uint16_t mme_app_nb_shards (void)
+{
+  return g_mme_app_shards.nb_shards;
+}
+
+//------------------------------------------------------------------------------
+int mme_app_shard_self (void)
+{
+  return g_mme_app_shard_self;
+}
+
+//------------------------------------------------------------------------------
+int mme_app_shard_of_ue_id (const mme_ue_s1ap_id_t mme_ue_s1ap_id)
+{
+  if ((!g_mme_app_shards.nb_shards) || (INVALID_MME_UE_S1AP_ID == mme_ue_s1ap_id)) {
+    return MME_APP_SHARD_COORDINATOR;
+  }
+  return (int)(mme_ue_s1ap_id % g_mme_app_shards.nb_shards);
+}
+
+//------------------------------------------------------------------------------
+mme_ue_s1ap_id_t mme_app_shard_new_ue_id (void)
+{
+  const int                               self = (MME_APP_SHARD_COORDINATOR == g_mme_app_shard_self) ? 0 : g_mme_app_shard_self;
+  mme_app_shard_t                        *shard = NULL;
+  uint32_t                                max_rank = 0;
+  uint32_t                                rank = 0;
+
+  DevAssert (g_mme_app_shards.nb_shards);
+  shard = &g_mme_app_shards.shards[self];
+  max_rank = (INVALID_MME_UE_S1AP_ID - 1 - self) / g_mme_app_shards.nb_shards;
+  // the coordinator may allocate for shard 0
+  uint32_t                                next_rank = __atomic_load_n (&shard->next_ue_id_rank, __ATOMIC_RELAXED);
+
+  do {
+    // wrap around, keeping mme_ue_s1ap_id % nb_shards
+    rank = (next_rank > max_rank) ? 1 : next_rank;
+  } while (!__atomic_compare_exchange_n (&shard->next_ue_id_rank, &next_rank, rank + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  return (mme_ue_s1ap_id_t)(rank * g_mme_app_shards.nb_shards + self);
+}
+
+//------------------------------------------------------------------------------
+// Shard owning the UE context, the coordinator if there is no context: a message is never handled by
+// another shard than the one of the mme_ue_s1ap_id of its UE
+static int mme_app_shard_of_ue_context (const ue_context_t * const ue_context)
+{
+  if (ue_context) {
+    // the context is only removed by its shard, the id is read like any lock-free reader of the index does
+    return mme_app_shard_of_ue_id (__atomic_load_n (&ue_context->mme_ue_s1ap_id, __ATOMIC_RELAXED));
+  }
+  return MME_APP_SHARD_COORDINATOR;
+}
+
+//------------------------------------------------------------------------------
+static int mme_app_shard_of_imsi (const imsi64_t imsi64)
+{
+  return mme_app_shard_of_ue_context (mme_ue_context_exists_imsi (&mme_app_desc.mme_ue_contexts, imsi64));
+}
+
+//------------------------------------------------------------------------------
+static int mme_app_shard_of_s11_teid (const s11_teid_t teid)
+{
+  return mme_app_shard_of_ue_context (mme_ue_context_exists_s11_teid (&mme_app_desc.mme_ue_contexts, teid));
+}
+
+//------------------------------------------------------------------------------
+static int mme_app_shard_of_s10_teid (const s10_teid_t teid)
+{
+  return mme_app_shard_of_ue_context (mme_ue_context_exists_s10_teid (&mme_app_desc.mme_ue_contexts, teid));
+}
+
+//------------------------------------------------------------------------------
+static int mme_app_shard_of_initial_ue_message (const itti_s1ap_initial_ue_message_t * const initial_pP)
+{
+  ue_context_t                           *ue_context = NULL;
+  enb_s1ap_id_key_t                       enb_s1ap_id_key = 0;
+  guti_t                                  guti = {.gummei.plmn = {0}, .gummei.mme_gid = 0, .gummei.mme_code = 0, .m_tmsi = INVALID_M_TMSI};
+
+  if (INVALID_MME_UE_S1AP_ID != initial_pP->mme_ue_s1ap_id) {
+    return mme_app_shard_of_ue_id (initial_pP->mme_ue_s1ap_id);
+  }
+  // same lookups as mme_app_handle_initial_ue_message()
+  MME_APP_ENB_S1AP_ID_KEY(enb_s1ap_id_key, initial_pP->ecgi.cell_identity.enb_id, initial_pP->enb_ue_s1ap_id);
+  if ((initial_pP->is_s_tmsi_valid) && (mme_app_construct_guti (&initial_pP->tai.plmn, &initial_pP->opt_s_tmsi, &guti))) {
+    ue_context = mme_ue_context_exists_guti (&mme_app_desc.mme_ue_contexts, &guti);
+  }
+  if (!ue_context) {
+    ue_context = mme_ue_context_exists_enb_ue_s1ap_id (&mme_app_desc.mme_ue_contexts, enb_s1ap_id_key);
+  }
+  if (!ue_context) {
+    // new UE: its context and mme_ue_s1ap_id are allocated by the shard handling this message
+    return (int)(((enb_s1ap_id_key * 0x9E3779B97F4A7C15ULL) >> 32) % g_mme_app_shards.nb_shards);
+  }
+  return mme_app_shard_of_ue_context (ue_context);
+}
+
+//------------------------------------------------------------------------------
+int mme_app_shard_of_message (const MessageDef * const message_p)
+{
+  imsi64_t                                imsi64 = INVALID_IMSI64;
+
+  if (!g_mme_app_shards.nb_shards) {
+    return MME_APP_SHARD_COORDINATOR;
+  }
+
+  switch (ITTI_MSG_ID (message_p)) {
+  /*
+   * mme_ue_s1ap_id
+   */
+  case MME_APP_INITIAL_CONTEXT_SETUP_RSP:
+    return mme_app_shard_of_ue_id (MME_APP_INITIAL_CONTEXT_SETUP_RSP (message_p).ue_id);
+  case MME_APP_INITIAL_CONTEXT_SETUP_FAILURE:
+    return mme_app_shard_of_ue_id (MME_APP_INITIAL_CONTEXT_SETUP_FAILURE (message_p).mme_ue_s1ap_id);
+  case MME_APP_ACTIVATE_BEARER_CNF:
+    return mme_app_shard_of_ue_id (MME_APP_ACTIVATE_BEARER_CNF (message_p).ue_id);
+  case MME_APP_ACTIVATE_BEARER_REJ:
+    return mme_app_shard_of_ue_id (MME_APP_ACTIVATE_BEARER_REJ (message_p).ue_id);
+  case MME_APP_DEACTIVATE_BEARER_CNF:
+    return mme_app_shard_of_ue_id (MME_APP_DEACTIVATE_BEARER_CNF (message_p).ue_id);
+  case NAS_CONNECTION_ESTABLISHMENT_CNF:
+    return mme_app_shard_of_ue_id (NAS_CONNECTION_ESTABLISHMENT_CNF (message_p).ue_id);
+  case NAS_DETACH_REQ:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.nas_detach_req.ue_id);
+  case NAS_DOWNLINK_DATA_REQ:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.nas_dl_data_req.ue_id);
+  case NAS_ERAB_SETUP_REQ:
+    return mme_app_shard_of_ue_id (NAS_ERAB_SETUP_REQ (message_p).ue_id);
+  case NAS_ERAB_RELEASE_REQ:
+    return mme_app_shard_of_ue_id (NAS_ERAB_RELEASE_REQ (message_p).ue_id);
+  case NAS_PDN_CONFIG_REQ:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.nas_pdn_config_req.ue_id);
+  case NAS_PDN_DISCONNECT_REQ:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.nas_pdn_disconnect_req.ue_id);
+  case NAS_CONTEXT_REQ:
+    return mme_app_shard_of_ue_id (NAS_CONTEXT_REQ (message_p).ue_id);
+  case NAS_PDN_CONNECTIVITY_REQ:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.nas_pdn_connectivity_req.ue_id);
+  case S1AP_E_RAB_SETUP_RSP:
+    return mme_app_shard_of_ue_id (S1AP_E_RAB_SETUP_RSP (message_p).mme_ue_s1ap_id);
+  case S1AP_UE_CAPABILITIES_IND:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.s1ap_ue_cap_ind.mme_ue_s1ap_id);
+  case S1AP_UE_CONTEXT_RELEASE_COMPLETE:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.s1ap_ue_context_release_complete.mme_ue_s1ap_id);
+  case S1AP_UE_CONTEXT_RELEASE_REQ:
+    return mme_app_shard_of_ue_id (message_p->ittiMsg.s1ap_ue_context_release_req.mme_ue_s1ap_id);
+  case S1AP_PATH_SWITCH_REQUEST:
+    return mme_app_shard_of_ue_id (S1AP_PATH_SWITCH_REQUEST (message_p).mme_ue_s1ap_id);
+  case S1AP_HANDOVER_REQUIRED:
+    return mme_app_shard_of_ue_id (S1AP_HANDOVER_REQUIRED (message_p).mme_ue_s1ap_id);
+  case S1AP_HANDOVER_CANCEL:
+    return mme_app_shard_of_ue_id (S1AP_HANDOVER_CANCEL (message_p).mme_ue_s1ap_id);
+  case S1AP_HANDOVER_REQUEST_ACKNOWLEDGE:
+    return mme_app_shard_of_ue_id (S1AP_HANDOVER_REQUEST_ACKNOWLEDGE (message_p).mme_ue_s1ap_id);
+  case S1AP_HANDOVER_FAILURE:
+    return mme_app_shard_of_ue_id (S1AP_HANDOVER_FAILURE (message_p).mme_ue_s1ap_id);
+  case S1AP_HANDOVER_NOTIFY:
+    return mme_app_shard_of_ue_id (S1AP_HANDOVER_NOTIFY (message_p).mme_ue_s1ap_id);
+  case S1AP_ENB_STATUS_TRANSFER:
+    return mme_app_shard_of_ue_id (S1AP_ENB_STATUS_TRANSFER (message_p).mme_ue_s1ap_id);
+  case S1AP_ERROR_INDICATION:
+    return mme_app_shard_of_ue_id (S1AP_ERROR_INDICATION (message_p).mme_ue_s1ap_id);
+  case S1AP_INITIAL_UE_MESSAGE:
+    return mme_app_shard_of_initial_ue_message (&S1AP_INITIAL_UE_MESSAGE (message_p));
+
+  /*
+   * IMSI
+   */
+  case S6A_UPDATE_LOCATION_ANS:
+    IMSI_STRING_TO_IMSI64 ((char *)message_p->ittiMsg.s6a_update_location_ans.imsi, &imsi64);
+    return mme_app_shard_of_imsi (imsi64);
+  case S6A_CANCEL_LOCATION_REQ:
+    IMSI_STRING_TO_IMSI64 ((char *)message_p->ittiMsg.s6a_cancel_location_req.imsi, &imsi64);
+    return mme_app_shard_of_imsi (imsi64);
+  case S10_FORWARD_RELOCATION_REQUEST:
+    return mme_app_shard_of_imsi (imsi_to_imsi64 (&S10_FORWARD_RELOCATION_REQUEST (message_p).imsi));
+
+  /*
+   * S11 TEID
+   */
+  case S11_CREATE_SESSION_RESPONSE:
+    return mme_app_shard_of_s11_teid (message_p->ittiMsg.s11_create_session_response.teid);
+  case S11_MODIFY_BEARER_RESPONSE:
+    return mme_app_shard_of_s11_teid (message_p->ittiMsg.s11_modify_bearer_response.teid);
+  case S11_DELETE_SESSION_RESPONSE:
+    return mme_app_shard_of_s11_teid (message_p->ittiMsg.s11_delete_session_response.teid);
+  case S11_RELEASE_ACCESS_BEARERS_RESPONSE:
+    return mme_app_shard_of_s11_teid (message_p->ittiMsg.s11_release_access_bearers_response.teid);
+  case S11_CREATE_BEARER_REQUEST:
+    return mme_app_shard_of_s11_teid (message_p->ittiMsg.s11_create_bearer_request.teid);
+  case S11_DELETE_BEARER_REQUEST:
+    return mme_app_shard_of_s11_teid (message_p->ittiMsg.s11_delete_bearer_request.teid);
+  case S11_DOWNLINK_DATA_NOTIFICATION:
+    return mme_app_shard_of_s11_teid (message_p->ittiMsg.s11_downlink_data_notification.teid);
+
+  /*
+   * S10 TEID
+   */
+  case S10_FORWARD_RELOCATION_RESPONSE:
+    return mme_app_shard_of_s10_teid (S10_FORWARD_RELOCATION_RESPONSE (message_p).teid);
+  case S10_FORWARD_ACCESS_CONTEXT_NOTIFICATION:
+    return mme_app_shard_of_s10_teid (S10_FORWARD_ACCESS_CONTEXT_NOTIFICATION (message_p).teid);
+  case S10_FORWARD_ACCESS_CONTEXT_ACKNOWLEDGE:
+    return mme_app_shard_of_s10_teid (S10_FORWARD_ACCESS_CONTEXT_ACKNOWLEDGE (message_p).teid);
+  case S10_FORWARD_RELOCATION_COMPLETE_NOTIFICATION:
+    return mme_app_shard_of_s10_teid (S10_FORWARD_RELOCATION_COMPLETE_NOTIFICATION (message_p).teid);
+  case S10_FORWARD_RELOCATION_COMPLETE_ACKNOWLEDGE:
+    return mme_app_shard_of_s10_teid (S10_FORWARD_RELOCATION_COMPLETE_ACKNOWLEDGE (message_p).teid);
+  case S10_RELOCATION_CANCEL_RESPONSE:
+    return mme_app_shard_of_s10_teid (S10_RELOCATION_CANCEL_RESPONSE (message_p).teid);
+  case S10_CONTEXT_RESPONSE:
+    return mme_app_shard_of_s10_teid (S10_CONTEXT_RESPONSE (message_p).teid);
+  case S10_CONTEXT_ACKNOWLEDGE:
+    return mme_app_shard_of_s10_teid (S10_CONTEXT_ACKNOWLEDGE (message_p).teid);
+  case S10_RELOCATION_CANCEL_REQUEST:{
+      // the handler looks the UE up by IMSI if the TEID is not known
+      ue_context_t                           *ue_context = mme_ue_context_exists_s10_teid (&mme_app_desc.mme_ue_contexts, S10_RELOCATION_CANCEL_REQUEST (message_p).teid);
+
+      imsi64 = imsi_to_imsi64 (&S10_RELOCATION_CANCEL_REQUEST (message_p).imsi);
+      if (!ue_context) {
+        ue_context = mme_ue_context_exists_imsi (&mme_app_desc.mme_ue_contexts, imsi64);
+      }
+      return mme_app_shard_of_ue_context (ue_context);
+    }
+  case S10_CONTEXT_REQUEST:
+    return mme_app_shard_of_ue_context (mme_ue_context_exists_guti (&mme_app_desc.mme_ue_contexts, &S10_CONTEXT_REQUEST (message_p).old_guti));
+
+  /*
+   * UE timers, the argument is the mme_ue_s1ap_id
+   */
+  case TIMER_HAS_EXPIRED:
+    if ((message_p->ittiMsg.timer_has_expired.timer_id != mme_app_desc.statistic_timer_id) && (message_p->ittiMsg.timer_has_expired.arg)) {
+      return mme_app_shard_of_ue_id (*((mme_ue_s1ap_id_t *)(message_p->ittiMsg.timer_has_expired.arg)));
+    }
+    return MME_APP_SHARD_COORDINATOR;
+
+  /*
+   * eNB reset and deregistration, HSS reset, statistics, termination
+   */
+  default:
+    return MME_APP_SHARD_COORDINATOR;
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_app_shard_dispatch (const int shard_index, MessageDef * const message_p)
+{
+  mme_app_shard_t                        *shard = NULL;
+
+  DevAssert ((shard_index >= 0) && (shard_index < g_mme_app_shards.nb_shards));
+  shard = &g_mme_app_shards.shards[shard_index];
+  pthread_mutex_lock (&shard->mutex);
+  if ((shard->head - shard->tail) > shard->queue_mask) {
+    const uint32_t                          size = (shard->queue_mask + 1) << 1;
+    MessageDef                            **queue = calloc (size, sizeof (MessageDef *));
+
+    AssertFatal (queue != NULL, "Failed to grow queue of MME_APP shard %d to %u messages\n", shard_index, size);
+    for (uint64_t i = shard->tail; i != shard->head; i++) {
+      queue[i & (size - 1)] = shard->queue[i & shard->queue_mask];
+    }
+    free_wrapper ((void**)&shard->queue);
+    shard->queue = queue;
+    shard->queue_mask = size - 1;
+  }
+  shard->queue[shard->head & shard->queue_mask] = message_p;
+  shard->head += 1;
+  if ((shard->head - shard->tail) == 1) {
+    pthread_cond_signal (&shard->not_empty);
+  }
+  pthread_mutex_unlock (&shard->mutex);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_shards_quiesce (void)
+{
+  // the coordinator is the only producer, a drained shard stays idle until it dispatches again
+  for (int i = 0; i < g_mme_app_shards.nb_shards; i++) {
+    mme_app_shard_t                        *shard = &g_mme_app_shards.shards[i];
+
+    pthread_mutex_lock (&shard->mutex);
+    while ((shard->head != shard->tail) || (shard->busy)) {
+      pthread_cond_wait (&shard->idle, &shard->mutex);
+    }
+    pthread_mutex_unlock (&shard->mutex);
+  }
+}
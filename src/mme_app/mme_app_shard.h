@@ -0,0 +1,75 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_shard.h
+  \brief MME_APP worker shards: the UE related messages received by TASK_MME_APP are handled by one of N worker
+         threads, always the same one for a given UE, the other messages by the TASK_MME_APP thread (coordinator)
+         once the shards have handled every message received before.
+*/
+
+#ifndef FILE_MME_APP_SHARD_SEEN
+#define FILE_MME_APP_SHARD_SEEN
+
+#include <stdint.h>
+
+#include "common_types.h"
+#include "intertask_interface.h"
+
+#define MME_APP_SHARD_COORDINATOR    (-1)    /*!< \brief message handled by the TASK_MME_APP thread */
+
+/** \brief Starts the worker shards, 0 shards: every message is handled by the TASK_MME_APP thread.
+ * @returns RETURNok or RETURNerror.
+ **/
+int mme_app_shards_init (const uint16_t nb_shards);
+
+/** \brief Stops the worker shards once they have handled their pending messages.
+ **/
+void mme_app_shards_exit (void);
+
+uint16_t mme_app_nb_shards (void);
+
+/** \brief Shard of the calling thread, MME_APP_SHARD_COORDINATOR if it is not a worker shard.
+ **/
+int mme_app_shard_self (void);
+
+/** \brief Shard owning the UE, MME_APP_SHARD_COORDINATOR if there is no shard or the id is invalid.
+ **/
+int mme_app_shard_of_ue_id (const mme_ue_s1ap_id_t mme_ue_s1ap_id);
+
+/** \brief New mme_ue_s1ap_id owned by the shard of the calling thread (by shard 0 outside of the shards).
+ **/
+mme_ue_s1ap_id_t mme_app_shard_new_ue_id (void);
+
+/** \brief Shard handling the message: the shard owning the mme_ue_s1ap_id of the message, or of the UE found by
+ *  IMSI, S11 or S10 TEID or GUTI. An initial UE message of a new UE goes to a shard given by its eNB UE id, the
+ *  other messages without UE context and the non UE messages go to MME_APP_SHARD_COORDINATOR.
+ **/
+int mme_app_shard_of_message (const MessageDef * const message_p);
+
+/** \brief Queues the message to the shard, the shard frees it.
+ **/
+void mme_app_shard_dispatch (const int shard, MessageDef * const message_p);
+
+/** \brief Returns when every shard has handled all the messages dispatched to it, called by the coordinator.
+ **/
+void mme_app_shards_quiesce (void);
+
+#endif /* FILE_MME_APP_SHARD_SEEN */
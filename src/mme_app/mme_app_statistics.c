@@ -42,6 +42,9 @@
 int mme_app_statistics_display (
   void)
 {
+  // the counters are updated by the MME_APP shards and S1AP, read and reset them in one go
+  mme_stats_write_lock (&mme_app_desc);
+
   OAILOG_DEBUG (LOG_MME_APP, "======================================= STATISTICS ============================================\n\n");
   OAILOG_DEBUG (LOG_MME_APP, "               |   Current Status| Added since last display|  Removed since last display |\n");
   OAILOG_DEBUG (LOG_MME_APP, "Connected eNBs | %10u      |     %10u              |    %10u               |\n",mme_app_desc.nb_enb_connected,
@@ -56,8 +59,6 @@ int mme_app_statistics_display (
                                           mme_app_desc.nb_s1u_bearers_established_since_last_stat,mme_app_desc.nb_s1u_bearers_released_since_last_stat);
   OAILOG_DEBUG (LOG_MME_APP, "======================================= STATISTICS ============================================\n\n");
 
-  mme_stats_write_lock (&mme_app_desc);
-
   // resetting stats for next display
   mme_app_desc.nb_enb_connected_since_last_stat = 0;
   mme_app_desc.nb_enb_released_since_last_stat  = 0;
@@ -91,7 +92,7 @@ void update_mme_app_stats_connected_enb_sub(void)
   mme_stats_write_lock (&mme_app_desc);
   if (mme_app_desc.nb_enb_connected !=0)
     (mme_app_desc.nb_enb_connected)--;
-  (mme_app_desc.nb_enb_released_since_last_stat)--;
+  (mme_app_desc.nb_enb_released_since_last_stat)++;
   mme_stats_unlock(&mme_app_desc);
   return;
 }
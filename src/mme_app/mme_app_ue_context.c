@@ -46,6 +46,7 @@
 #include "3gpp_29.274.h"
 #include "mme_app_ue_context.h"
 #include "mme_app_bearer_context.h"
+#include "mme_app_shard.h"
 
 static mme_ue_s1ap_id_t mme_app_ue_s1ap_id_generator = 1;
 
@@ -269,6 +270,10 @@ void mme_app_ue_context_s1_release_enb_informations(ue_context_t *ue_context)
 mme_ue_s1ap_id_t mme_app_ctx_get_new_ue_id(void)
 {
   mme_ue_s1ap_id_t tmp = 0;
+  if (mme_app_nb_shards ()) {
+    // the id tells which shard owns the UE
+    return mme_app_shard_new_ue_id ();
+  }
   tmp = __sync_fetch_and_add (&mme_app_ue_s1ap_id_generator, 1);
   return tmp;
 }
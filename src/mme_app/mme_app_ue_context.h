@@ -42,6 +42,7 @@
 #include "queue.h"
 #include "hashtable.h"
 #include "obj_hashtable.h"
+#include "multikey_index.h"
 #include "bstrlib.h"
 #include "common_types.h"
 #include "mme_app_messages_types.h"
@@ -510,6 +511,18 @@ typedef struct ue_context_s {
 } ue_context_t;
 
 
+/*! \enum mme_app_ue_key_space_t
+ * \brief Key spaces of the UE context index, all of them map to the ue_context_t.
+ */
+typedef enum mme_app_ue_key_space_e {
+  MME_APP_UE_KEY_MME_UE_S1AP_ID = 1,
+  MME_APP_UE_KEY_ENB_S1AP_ID,      /*!< \brief enb_s1ap_id_key_t                      */
+  MME_APP_UE_KEY_IMSI,
+  MME_APP_UE_KEY_S11_TEID,
+  MME_APP_UE_KEY_S10_TEID,
+  MME_APP_UE_KEY_GUTI,             /*!< \brief M-TMSI, MME code and group, PLMN as extra key bits */
+} mme_app_ue_key_space_t;
+
 typedef struct mme_ue_context_s {
   uint32_t               nb_ue_managed;
   uint32_t               nb_ue_idle;
@@ -519,12 +532,7 @@ typedef struct mme_ue_context_s {
   uint32_t               nb_ue_since_last_stat;
   uint32_t               nb_bearers_since_last_stat;
 
-  hash_table_uint64_ts_t  *imsi_ue_context_htbl; // data is mme_ue_s1ap_id_t
-  hash_table_uint64_ts_t  *tun10_ue_context_htbl;// data is mme_ue_s1ap_id_t
-  hash_table_uint64_ts_t  *tun11_ue_context_htbl;// data is mme_ue_s1ap_id_t
-  hash_table_uint64_ts_t  *mme_ue_s1ap_id_ue_context_htbl; // data is enb_s1ap_id_key_t
-  hash_table_ts_t         *enb_ue_s1ap_id_ue_context_htbl;
-  obj_hash_table_uint64_t *guti_ue_context_htbl;// data is mme_ue_s1ap_id_t
+  multikey_index_t       *ue_context_index; // keys of mme_app_ue_key_space_t, data is ue_context_t*
 } mme_ue_context_t;
 
 
@@ -97,6 +97,8 @@ static void mme_config_init (mme_config_t * config_pP)
   config_pP->log_config.output             = NULL;
   config_pP->log_config.is_output_thread_safe = false;
   config_pP->log_config.color              = false;
+  config_pP->log_config.is_binary          = false;
+  config_pP->log_config.binary_output      = NULL;
   config_pP->log_config.udp_log_level      = MAX_LOG_LEVEL; // Means invalid
   config_pP->log_config.gtpv1u_log_level   = MAX_LOG_LEVEL; // will not overwrite existing log levels if MME and S-GW bundled in same executable
   config_pP->log_config.gtpv2c_log_level   = MAX_LOG_LEVEL;
@@ -119,6 +121,7 @@ static void mme_config_init (mme_config_t * config_pP)
   config_pP->config_file = NULL;
   config_pP->max_enbs    = 2;
   config_pP->max_ues     = 2;
+  config_pP->mme_app_shards = MME_APP_SHARDS;
   config_pP->unauthenticated_imsi_supported = 0;
   config_pP->dummy_handover_forwarding_enabled = 1;
   config_pP->run_mode    = RUN_MODE_BASIC;
@@ -145,8 +148,11 @@ static void mme_config_init (mme_config_t * config_pP)
   config_pP->s6a_config.conf_file = bfromcstr(S6A_CONF_FILE);
   config_pP->itti_config.queue_size = ITTI_QUEUE_MAX_ELEMENTS;
   config_pP->itti_config.log_file = NULL;
+  config_pP->itti_config.memory_pools.pools_number = 0;
+  config_pP->itti_config.memory_pools.magazine_size = ITTI_MEMORY_POOLS_DEFAULT_MAGAZINE_SIZE;
   config_pP->sctp_config.in_streams = SCTP_IN_STREAMS;
   config_pP->sctp_config.out_streams = SCTP_OUT_STREAMS;
+  config_pP->sctp_config.nb_workers = SCTP_WORKERS;
   config_pP->relative_capacity = RELATIVE_CAPACITY;
   config_pP->mme_statistic_timer = MME_STATISTIC_TIMER_S;
 
@@ -203,6 +209,7 @@ void mme_config_exit (void)
 {
   pthread_rwlock_destroy (&mme_config.rw_lock);
   bdestroy_wrapper(&mme_config.log_config.output);
+  bdestroy_wrapper(&mme_config.log_config.binary_output);
   bdestroy_wrapper(&mme_config.realm);
   bdestroy_wrapper(&mme_config.config_file);
 
@@ -314,6 +321,21 @@ static int mme_config_parse_file (mme_config_t * config_pP)
         else config_pP->log_config.color = false;
       }
 
+      if (config_setting_lookup_string (setting, LOG_CONFIG_STRING_BINARY, (const char **)&astring)) {
+        if (0 == strcasecmp("yes", astring)) config_pP->log_config.is_binary = true;
+        else config_pP->log_config.is_binary = false;
+      }
+
+      if (config_setting_lookup_string (setting, LOG_CONFIG_STRING_BINARY_FILE, (const char **)&astring)) {
+        if ((astring != NULL) && (astring[0])) {
+          if (config_pP->log_config.binary_output) {
+            bassigncstr(config_pP->log_config.binary_output , astring);
+          } else {
+            config_pP->log_config.binary_output = bfromcstr(astring);
+          }
+        }
+      }
+
       if (config_setting_lookup_string (setting, LOG_CONFIG_STRING_SCTP_LOG_LEVEL, (const char **)&astring))
         config_pP->log_config.sctp_log_level = OAILOG_LEVEL_STR2INT (astring);
 
@@ -402,6 +424,10 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       config_pP->max_ues = (uint32_t) aint;
     }
 
+    if ((config_setting_lookup_int (setting_mme, MME_CONFIG_STRING_MME_APP_SHARDS, &aint))) {
+      config_pP->mme_app_shards = (uint16_t) aint;
+    }
+
     if ((config_setting_lookup_int (setting_mme, MME_CONFIG_STRING_RELATIVE_CAPACITY, &aint))) {
       config_pP->relative_capacity = (uint8_t) aint;
     }
@@ -464,6 +490,28 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE, &aint))) {
         config_pP->itti_config.queue_size = (uint32_t) aint;
       }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_MAGAZINE_SIZE, &aint))) {
+        config_pP->itti_config.memory_pools.magazine_size = (uint32_t) aint;
+      }
+      subsetting = config_setting_get_member (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_MEMORY_POOLS);
+      if (subsetting != NULL) {
+        num = config_setting_length (subsetting);
+        AssertFatal(MEMORY_POOLS_MAX_POOLS >= num , "Too many ITTI memory pools configured %d", num);
+        config_pP->itti_config.memory_pools.pools_number = num;
+
+        for (i = 0; i < num; i++) {
+          sub2setting = config_setting_get_elem (subsetting, i);
+
+          if (sub2setting != NULL) {
+            AssertFatal ((config_setting_lookup_int (sub2setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEMS, &aint)) && (aint > 0),
+                "Missing or bad %s in ITTI memory pool %d", MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEMS, i);
+            config_pP->itti_config.memory_pools.pools[i].items_number = (uint32_t) aint;
+            AssertFatal ((config_setting_lookup_int (sub2setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEM_SIZE, &aint)) && (aint > 0),
+                "Missing or bad %s in ITTI memory pool %d", MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEM_SIZE, i);
+            config_pP->itti_config.memory_pools.pools[i].item_size = (uint32_t) aint;
+          }
+        }
+      }
     }
     // S6A SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_S6A_CONFIG);
@@ -513,6 +561,10 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_SCTP_OUTSTREAMS, &aint))) {
         config_pP->sctp_config.out_streams = (uint16_t) aint;
       }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_SCTP_WORKERS, &aint))) {
+        config_pP->sctp_config.nb_workers = (uint16_t) aint;
+      }
     }
     // S1AP SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_S1AP_CONFIG);
@@ -969,6 +1021,7 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- Run mode .............................: %s\n", (RUN_MODE_BASIC == config_pP->run_mode) ? "BASIC":(RUN_MODE_SCENARIO_PLAYER == config_pP->run_mode) ? "SCENARIO_PLAYER":"UNKNOWN");
   OAILOG_INFO (LOG_CONFIG, "- Max eNBs .............................: %u\n", config_pP->max_enbs);
   OAILOG_INFO (LOG_CONFIG, "- Max UEs ..............................: %u\n", config_pP->max_ues);
+  OAILOG_INFO (LOG_CONFIG, "- MME_APP shards .......................: %u\n", config_pP->mme_app_shards);
   OAILOG_INFO (LOG_CONFIG, "- IMS voice over PS session in S1 ......: %s\n", config_pP->eps_network_feature_support.ims_voice_over_ps_session_in_s1 == 0 ? "false" : "true");
   OAILOG_INFO (LOG_CONFIG, "- Emergency bearer services in S1 mode .: %s\n", config_pP->eps_network_feature_support.emergency_bearer_services_in_s1_mode == 0 ? "false" : "true");
   OAILOG_INFO (LOG_CONFIG, "- Location services via epc ............: %s\n", config_pP->eps_network_feature_support.location_services_via_epc == 0 ? "false" : "true");
@@ -990,9 +1043,19 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- ITTI:\n");
   OAILOG_INFO (LOG_CONFIG, "    queue size .......: %u (bytes)\n", config_pP->itti_config.queue_size);
   OAILOG_INFO (LOG_CONFIG, "    log file .........: %s\n", bdata(config_pP->itti_config.log_file));
+  OAILOG_INFO (LOG_CONFIG, "    magazine size ....: %u (items per thread cache magazine)\n", config_pP->itti_config.memory_pools.magazine_size);
+  if (config_pP->itti_config.memory_pools.pools_number) {
+    for (j = 0; j < config_pP->itti_config.memory_pools.pools_number; j++) {
+      OAILOG_INFO (LOG_CONFIG, "    memory pool %d ....: %u items of %u bytes\n", j,
+          config_pP->itti_config.memory_pools.pools[j].items_number, config_pP->itti_config.memory_pools.pools[j].item_size);
+    }
+  } else {
+    OAILOG_INFO (LOG_CONFIG, "    memory pools .....: default\n");
+  }
   OAILOG_INFO (LOG_CONFIG, "- SCTP:\n");
   OAILOG_INFO (LOG_CONFIG, "    in streams .......: %u\n", config_pP->sctp_config.in_streams);
   OAILOG_INFO (LOG_CONFIG, "    out streams ......: %u\n", config_pP->sctp_config.out_streams);
+  OAILOG_INFO (LOG_CONFIG, "    workers ..........: %u\n", config_pP->sctp_config.nb_workers);
   OAILOG_INFO (LOG_CONFIG, "- GUMMEIs (PLMN|MMEGI|MMEC):\n");
   for (j = 0; j < config_pP->gummei.nb; j++) {
     OAILOG_INFO (LOG_CONFIG, "            " PLMN_FMT "|%u|%u \n",
@@ -1054,6 +1117,8 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "    Output ..............: %s\n", bdata(config_pP->log_config.output));
   OAILOG_INFO (LOG_CONFIG, "    Output thread safe ..: %s\n", (config_pP->log_config.is_output_thread_safe) ? "true":"false");
   OAILOG_INFO (LOG_CONFIG, "    Output with color ...: %s\n", (config_pP->log_config.color) ? "true":"false");
+  OAILOG_INFO (LOG_CONFIG, "    Binary records ......: %s\n", (config_pP->log_config.is_binary) ? "true":"false");
+  OAILOG_INFO (LOG_CONFIG, "    Binary records file .: %s\n", (config_pP->log_config.binary_output) ? bdata(config_pP->log_config.binary_output) : "none");
   OAILOG_INFO (LOG_CONFIG, "    UDP log level........: %s\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.udp_log_level));
   OAILOG_INFO (LOG_CONFIG, "    GTPV2-C log level....: %s\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.gtpv2c_log_level));
   OAILOG_INFO (LOG_CONFIG, "    SCTP log level.......: %s\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.sctp_log_level));
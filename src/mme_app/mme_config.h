@@ -36,6 +36,7 @@
 #include "common_types.h"
 #include "bstrlib.h"
 #include "log.h"
+#include "memory_pools.h"
 
 #define MAX_GUMMEI                2
 
@@ -50,6 +51,7 @@
 #define MME_CONFIG_STRING_REALM                          "REALM"
 #define MME_CONFIG_STRING_MAXENB                         "MAXENB"
 #define MME_CONFIG_STRING_MAXUE                          "MAXUE"
+#define MME_CONFIG_STRING_MME_APP_SHARDS                 "MME_APP_SHARDS"
 #define MME_CONFIG_STRING_RELATIVE_CAPACITY              "RELATIVE_CAPACITY"
 #define MME_CONFIG_STRING_STATISTIC_TIMER                "MME_STATISTIC_TIMER"
 #define MME_CONFIG_STRING_MME_MOBILITY_COMPLETION_TIMER  "MME_MOBILITY_COMPLETION_TIMER"
@@ -67,6 +69,10 @@
 
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG     "INTERTASK_INTERFACE"
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE "ITTI_QUEUE_SIZE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_MEMORY_POOLS "MEMORY_POOLS"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEMS "ITEMS"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEM_SIZE "ITEM_SIZE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_MAGAZINE_SIZE "MAGAZINE_SIZE"
 
 #define MME_CONFIG_STRING_S6A_CONFIG                     "S6A"
 #define MME_CONFIG_STRING_S6A_CONF_FILE_PATH             "S6A_CONF"
@@ -76,6 +82,7 @@
 #define MME_CONFIG_STRING_SCTP_CONFIG                    "SCTP"
 #define MME_CONFIG_STRING_SCTP_INSTREAMS                 "SCTP_INSTREAMS"
 #define MME_CONFIG_STRING_SCTP_OUTSTREAMS                "SCTP_OUTSTREAMS"
+#define MME_CONFIG_STRING_SCTP_WORKERS                   "SCTP_WORKERS"
 
 
 #define MME_CONFIG_STRING_S1AP_CONFIG                    "S1AP"
@@ -162,6 +169,7 @@ typedef struct mme_config_s {
 
   uint32_t max_enbs;
   uint32_t max_ues;
+  uint16_t mme_app_shards;    // MME_APP worker threads, a UE is always handled by the same one
 
   uint8_t relative_capacity;
 
@@ -200,6 +208,7 @@ typedef struct mme_config_s {
   struct {
     uint16_t in_streams;
     uint16_t out_streams;
+    uint16_t nb_workers;    // reactor threads serving the associations
   } sctp_config;
 
   struct {
@@ -236,6 +245,7 @@ typedef struct mme_config_s {
   struct {
     uint32_t  queue_size;
     bstring   log_file;
+    memory_pools_config_t memory_pools;
   } itti_config;
 
   struct {
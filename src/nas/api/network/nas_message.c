@@ -1109,7 +1109,8 @@ static int _nas_message_decrypt (
            * length in bits
            */
           stream_cipher.blength = length << 3;
-          nas_stream_encrypt_eea1 (&stream_cipher, (uint8_t*)dest);
+          nas_stream_encrypt_eea1_with_context (nas_stream_cipher_context_for_key (&emm_security_context->knas_enc_context,
+              emm_security_context->knas_enc, AUTH_KNAS_ENC_SIZE), &stream_cipher, (uint8_t*)dest);
           /*
            * Decode the first octet (security header type or EPS bearer identity,
            * * * * and protocol discriminator)
@@ -1144,7 +1145,8 @@ static int _nas_message_decrypt (
            * length in bits
            */
           stream_cipher.blength = length << 3;
-          nas_stream_encrypt_eea2 (&stream_cipher, (uint8_t*)dest);
+          nas_stream_encrypt_eea2_with_context (nas_stream_cipher_context_for_key (&emm_security_context->knas_enc_context,
+              emm_security_context->knas_enc, AUTH_KNAS_ENC_SIZE), &stream_cipher, (uint8_t*)dest);
           /*
            * Decode the first octet (security header type or EPS bearer identity,
            * * * * and protocol discriminator)
@@ -1263,7 +1265,8 @@ static int _nas_message_encrypt (
          * length in bits
          */
         stream_cipher.blength = length << 3;
-        nas_stream_encrypt_eea1 (&stream_cipher, (uint8_t*)dest);
+        nas_stream_encrypt_eea1_with_context (nas_stream_cipher_context_for_key (&emm_security_context->knas_enc_context,
+              emm_security_context->knas_enc, AUTH_KNAS_ENC_SIZE), &stream_cipher, (uint8_t*)dest);
         OAILOG_FUNC_RETURN (LOG_NAS, length);
       }
       break;
@@ -1288,7 +1291,8 @@ static int _nas_message_encrypt (
          * length in bits
          */
         stream_cipher.blength = length << 3;
-        nas_stream_encrypt_eea2 (&stream_cipher, (uint8_t*)dest);
+        nas_stream_encrypt_eea2_with_context (nas_stream_cipher_context_for_key (&emm_security_context->knas_enc_context,
+              emm_security_context->knas_enc, AUTH_KNAS_ENC_SIZE), &stream_cipher, (uint8_t*)dest);
         OAILOG_FUNC_RETURN (LOG_NAS, length);
       }
       break;
@@ -1380,7 +1384,8 @@ static uint32_t _nas_message_get_mac (
        * length in bits
        */
       stream_cipher.blength = length << 3;
-      nas_stream_encrypt_eia1 (&stream_cipher, mac);
+      nas_stream_encrypt_eia1_with_context (nas_stream_cipher_context_for_key (&emm_security_context->knas_int_context,
+          emm_security_context->knas_int, AUTH_KNAS_INT_SIZE), &stream_cipher, mac);
       OAILOG_DEBUG (LOG_NAS, "NAS_SECURITY_ALGORITHMS_EIA1 returned MAC %x.%x.%x.%x(%u) for length %lu direction %d, count %d\n",
           mac[0], mac[1], mac[2], mac[3], *((uint32_t *) & mac), length, direction, count);
       mac32 = (uint32_t *) & mac;
@@ -1415,7 +1420,8 @@ static uint32_t _nas_message_get_mac (
        * length in bits
        */
       stream_cipher.blength = length << 3;
-      nas_stream_encrypt_eia2 (&stream_cipher, mac);
+      nas_stream_encrypt_eia2_with_context (nas_stream_cipher_context_for_key (&emm_security_context->knas_int_context,
+          emm_security_context->knas_int, AUTH_KNAS_INT_SIZE), &stream_cipher, mac);
       OAILOG_DEBUG (LOG_NAS, "NAS_SECURITY_ALGORITHMS_EIA2 returned MAC %x.%x.%x.%x(%u) for length %lu direction %d, count %d\n",
           mac[0], mac[1], mac[2], mac[3], *((uint32_t *) & mac), length, direction, count);
       mac32 = (uint32_t *) & mac;
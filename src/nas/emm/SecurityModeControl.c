@@ -232,8 +232,11 @@ emm_proc_security_mode_control (
 
       emm_ctx_set_security_type(emm_ctx, SECURITY_CTX_TYPE_FULL_NATIVE);
       AssertFatal(KSI_NO_KEY_AVAILABLE > emm_ctx->_security.eksi, "eksi not valid");
-      derive_key_nas (NAS_INT_ALG, emm_ctx->_security.selected_algorithms.integrity,  emm_ctx->_vector[emm_ctx->_security.eksi%MAX_EPS_AUTH_VECTORS].kasme, emm_ctx->_security.knas_int);
-      derive_key_nas (NAS_ENC_ALG, emm_ctx->_security.selected_algorithms.encryption, emm_ctx->_vector[emm_ctx->_security.eksi%MAX_EPS_AUTH_VECTORS].kasme, emm_ctx->_security.knas_enc);
+      derive_keys_nas_enb_with_context (kdf_context_for_key (&emm_ctx->_security.kasme_kdf_context, emm_ctx->_vector[emm_ctx->_security.eksi%MAX_EPS_AUTH_VECTORS].kasme, KASME_LENGTH_OCTETS),
+          emm_ctx->_security.selected_algorithms.integrity, emm_ctx->_security.selected_algorithms.encryption, 0,
+          emm_ctx->_security.knas_int, emm_ctx->_security.knas_enc, NULL);
+      nas_stream_cipher_context_init (&emm_ctx->_security.knas_int_context, emm_ctx->_security.knas_int, AUTH_KNAS_INT_SIZE);
+      nas_stream_cipher_context_init (&emm_ctx->_security.knas_enc_context, emm_ctx->_security.knas_enc, AUTH_KNAS_ENC_SIZE);
       /*
        * Set new security context indicator
        */
@@ -44,6 +44,7 @@ Description Defines internal private data handled by EPS Mobility
 #include "hashtable.h"
 #include "obj_hashtable.h"
 #include "securityDef.h"
+#include "secu_defs.h"
 #include "TrackingAreaIdentityList.h"
 #include "emm_fsm.h"
 #include "nas_timer.h"
@@ -84,6 +85,9 @@ typedef struct emm_security_context_s {
   int vector_index;   /* Pointer on vector */
   uint8_t knas_enc[AUTH_KNAS_ENC_SIZE];/* NAS cyphering key               */
   uint8_t knas_int[AUTH_KNAS_INT_SIZE];/* NAS integrity key               */
+  nas_stream_cipher_context_t knas_enc_context; /* knas_enc key schedules, set up with knas_enc */
+  nas_stream_cipher_context_t knas_int_context; /* knas_int key schedules, set up with knas_int */
+  kdf_context_t kasme_kdf_context; /* HMAC states of the kasme of the current vector, for the KDF */
   uint8_t ncc:3; /* next hop chaining counter for handover. */
   uint8_t nh_conj[AUTH_NH_SIZE];      /* nh */
 
@@ -617,8 +617,11 @@ inline void emm_ctx_update_from_mm_eps_context(emm_data_context_t * const emm_ct
   /** Derive the KNAS integrity and ciphering keys. */
   AssertFatal(EMM_SECURITY_VECTOR_INDEX_INVALID != emm_ctx_p->_security.vector_index, "Vector index not initialized");
   AssertFatal(MAX_EPS_AUTH_VECTORS >  emm_ctx_p->_security.vector_index, "Vector index outbound value %d/%d", emm_ctx_p->_security.vector_index, MAX_EPS_AUTH_VECTORS);
-  derive_key_nas (NAS_INT_ALG, emm_ctx_p->_security.selected_algorithms.integrity,  emm_ctx_p->_vector[emm_ctx_p->_security.vector_index].kasme, emm_ctx_p->_security.knas_int);
-  derive_key_nas (NAS_ENC_ALG, emm_ctx_p->_security.selected_algorithms.encryption, emm_ctx_p->_vector[emm_ctx_p->_security.vector_index].kasme, emm_ctx_p->_security.knas_enc);
+  derive_keys_nas_enb_with_context (kdf_context_for_key (&emm_ctx_p->_security.kasme_kdf_context, emm_ctx_p->_vector[emm_ctx_p->_security.vector_index].kasme, KASME_LENGTH_OCTETS),
+      emm_ctx_p->_security.selected_algorithms.integrity, emm_ctx_p->_security.selected_algorithms.encryption, 0,
+      emm_ctx_p->_security.knas_int, emm_ctx_p->_security.knas_enc, NULL);
+  nas_stream_cipher_context_init (&emm_ctx_p->_security.knas_int_context, emm_ctx_p->_security.knas_int, AUTH_KNAS_INT_SIZE);
+  nas_stream_cipher_context_init (&emm_ctx_p->_security.knas_enc_context, emm_ctx_p->_security.knas_enc, AUTH_KNAS_ENC_SIZE);
 
   memcpy(emm_ctx_p->_vector[emm_ctx_p->_security.vector_index].kasme, mm_eps_ctxt->k_asme, 32);
 
@@ -888,7 +891,8 @@ int emm_data_context_update_security_parameters(const mme_ue_s1ap_id_t ue_id,
   *integrity_algorithm_capabilities = ((uint16_t)emm_ctx->_ue_network_capability.eia & ~(1 << 7)) << 1;
 
   /** Derive the next hop. */
-  derive_nh(emm_ctx->_vector[emm_ctx->_security.vector_index].kasme, emm_ctx->_vector[emm_ctx->_security.vector_index].nh_conj);
+  derive_nh_with_context (kdf_context_for_key (&emm_ctx->_security.kasme_kdf_context, emm_ctx->_vector[emm_ctx->_security.vector_index].kasme, KASME_LENGTH_OCTETS),
+      emm_ctx->_vector[emm_ctx->_security.vector_index].nh_conj);
 
   /** Increase the next hop counter. */
   emm_ctx->_security.ncc++;
@@ -492,7 +492,7 @@ void nas_itti_establish_cnf(
 
   OAILOG_DEBUG (LOG_NAS_EMM, "EMM-PROC  - KeNB with UL Count %d for UE " MME_UE_S1AP_ID_FMT ". \n", nas_count, emm_ctx->ue_id);
 
-  derive_keNB (emm_ctx->_vector[emm_ctx->_security.vector_index].kasme,
+  derive_keNB_with_context (kdf_context_for_key (&emm_ctx->_security.kasme_kdf_context, emm_ctx->_vector[emm_ctx->_security.vector_index].kasme, KASME_LENGTH_OCTETS),
       nas_count, NAS_CONNECTION_ESTABLISHMENT_CNF(message_p).kenb);
 
   uint8_t                                 zero[32];
@@ -56,6 +56,34 @@ typedef struct {
 void RijndaelKeySchedule(const uint8_t key[16]);
 void RijndaelEncrypt(const uint8_t in[16], uint8_t out[16]);
 
+/* Milenage engine, see milenage.c */
+typedef enum {
+  MILENAGE_AES_AUTO = 0,     /* best kernel supported by the CPU */
+  MILENAGE_AES_TTABLE,
+  MILENAGE_AES_NI,
+} milenage_aes_t;
+
+typedef struct milenage_ctx_s {
+  union {
+    uint32_t w[44];
+    uint8_t  b[176];
+  } rk __attribute__ ((aligned (16)));   /* AES-128 round keys of K */
+  uint8_t        opc[16];
+  milenage_aes_t aes;
+  void         (*encrypt)(const struct milenage_ctx_s * const ctx, const uint8_t (*in)[16], uint8_t (*out)[16], int n);
+} milenage_ctx_t;
+
+milenage_aes_t milenage_aes_available(void);
+const char *milenage_aes_name(milenage_aes_t aes);
+int  milenage_init(milenage_ctx_t * const ctx, const uint8_t k[16], const uint8_t opc[16], milenage_aes_t aes);
+void milenage_encrypt(const milenage_ctx_t * const ctx, const uint8_t in[16], uint8_t out[16]);
+void milenage_f1(const milenage_ctx_t * const ctx, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2], uint8_t mac_a[8]);
+void milenage_f1star(const milenage_ctx_t * const ctx, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2], uint8_t mac_s[8]);
+void milenage_f2345(const milenage_ctx_t * const ctx, const uint8_t rand[16], uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6]);
+void milenage_f5star(const milenage_ctx_t * const ctx, const uint8_t rand[16], uint8_t ak[6]);
+void milenage_vector(const milenage_ctx_t * const ctx, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2],
+                     uint8_t mac_a[8], uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6]);
+
 /* Sequence number functions */
 struct sqn_ue_s;
 struct sqn_ue_s *sqn_exists(uint64_t imsi);
@@ -86,6 +114,8 @@ void f5star( const uint8_t kP[16],const uint8_t k[16], const uint8_t rand[16],
 void generate_autn(const uint8_t sqn[6], const uint8_t ak[6], const uint8_t amf[2], const uint8_t mac_a[8], uint8_t autn[16]);
 int generate_vector(const uint8_t opc[16], uint64_t imsi, uint8_t key[16], uint8_t plmn[3],
                     uint8_t sqn[6], auc_vector_t *vector);
+int generate_vectors(const uint8_t opc[16], const uint8_t key[16], uint8_t plmn[3],
+                     uint8_t sqn[6], auc_vector_t *vectors, int num_vectors);
 
 void kdf(uint8_t *key, uint16_t key_len, uint8_t *s, uint16_t s_len, uint8_t *out,
          uint16_t out_len);
@@ -24,15 +24,13 @@
   -------------------------------------------------------------------
 
    A sample implementation of the example 3GPP authentication and
-   key agreement functions f1, f1*, f2, f3, f4, f5 and f5*. This is
-   a byte-oriented implementation of the functions, and of the block
-   cipher kernel function Rijndael.
+   key agreement functions f1, f1*, f2, f3, f4, f5 and f5*. This is a
+   thin wrapper on the Milenage engine of milenage.c.
 
-   This has been coded for clarity, not necessarily for efficiency.
-
-   The functions f2, f3, f4 and f5 share the same inputs and have
-   been coded together as a single function. f1, f1* and f5* are
-   all coded separately.
+   These entry points keep the historical one-shot interface, each
+   call expands K into a context of its own so they are reentrant.
+   Callers computing several functions or vectors for the same K
+   should use the milenage_ctx_t API of milenage.c directly.
 
   -----------------------------------------------------------------*/
 
@@ -93,51 +91,10 @@ f1 (
   const uint8_t amf[2],
   uint8_t mac_a[8])
 {
-  uint8_t                                 temp[16];
-  uint8_t                                 in1[16];
-  uint8_t                                 out1[16];
-  uint8_t                                 rijndaelInput[16];
-  uint8_t                                 i;
-
-  RijndaelKeySchedule (k);
-
-  for (i = 0; i < 16; i++)
-    rijndaelInput[i] = _rand[i] ^ opc[i];
-
-  RijndaelEncrypt (rijndaelInput, temp);
-
-  for (i = 0; i < 6; i++) {
-    in1[i] = sqn[i];
-    in1[i + 8] = sqn[i];
-  }
-
-  for (i = 0; i < 2; i++) {
-    in1[i + 6] = amf[i];
-    in1[i + 14] = amf[i];
-  }
-
-  /*
-   * XOR op_c and in1, rotate by r1=64, and XOR
-   * * * * on the constant c1 (which is all zeroes)
-   */
-  for (i = 0; i < 16; i++)
-    rijndaelInput[(i + 8) % 16] = in1[i] ^ opc[i];
-
-  /*
-   * XOR on the value temp computed before
-   */
-  for (i = 0; i < 16; i++)
-    rijndaelInput[i] ^= temp[i];
+  milenage_ctx_t                          ctx;
 
-  RijndaelEncrypt (rijndaelInput, out1);
-
-  for (i = 0; i < 16; i++)
-    out1[i] ^= opc[i];
-
-  for (i = 0; i < 8; i++)
-    mac_a[i] = out1[i];
-
-  return;
+  milenage_init (&ctx, k, opc, MILENAGE_AES_AUTO);
+  milenage_f1 (&ctx, _rand, sqn, amf, mac_a);
 }                               /* end of function f1 */
 
 /*-------------------------------------------------------------------
@@ -158,74 +115,10 @@ f2345 (
   uint8_t ik[16],
   uint8_t ak[6])
 {
-  uint8_t                                 temp[16];
-  uint8_t                                 out[16];
-  uint8_t                                 rijndaelInput[16];
-  uint8_t                                 i;
-
-  RijndaelKeySchedule (k);
-
-  for (i = 0; i < 16; i++)
-    rijndaelInput[i] = _rand[i] ^ opc[i];
-
-  RijndaelEncrypt (rijndaelInput, temp);
-
-  /*
-   * To obtain output block OUT2: XOR OPc and TEMP,
-   * * * * rotate by r2=0, and XOR on the constant c2 (which *
-   * * * * is all zeroes except that the last bit is 1).
-   */
-  for (i = 0; i < 16; i++)
-    rijndaelInput[i] = temp[i] ^ opc[i];
-
-  rijndaelInput[15] ^= 1;
-  RijndaelEncrypt (rijndaelInput, out);
-
-  for (i = 0; i < 16; i++)
-    out[i] ^= opc[i];
-
-  for (i = 0; i < 8; i++)
-    res[i] = out[i + 8];
-
-  for (i = 0; i < 6; i++)
-    ak[i] = out[i];
-
-  /*
-   * To obtain output block OUT3: XOR OPc and TEMP,
-   * * * * rotate by r3=32, and XOR on the constant c3 (which *
-   * * * * is all zeroes except that the next to last bit is 1).
-   */
-
-  for (i = 0; i < 16; i++)
-    rijndaelInput[(i + 12) % 16] = temp[i] ^ opc[i];
-
-  rijndaelInput[15] ^= 2;
-  RijndaelEncrypt (rijndaelInput, out);
-
-  for (i = 0; i < 16; i++)
-    out[i] ^= opc[i];
-
-  for (i = 0; i < 16; i++)
-    ck[i] = out[i];
+  milenage_ctx_t                          ctx;
 
-  /*
-   * To obtain output block OUT4: XOR OPc and TEMP,
-   * * * * rotate by r4=64, and XOR on the constant c4 (which *
-   * * * * is all zeroes except that the 2nd from last bit is 1).
-   */
-  for (i = 0; i < 16; i++)
-    rijndaelInput[(i + 8) % 16] = temp[i] ^ opc[i];
-
-  rijndaelInput[15] ^= 4;
-  RijndaelEncrypt (rijndaelInput, out);
-
-  for (i = 0; i < 16; i++)
-    out[i] ^= opc[i];
-
-  for (i = 0; i < 16; i++)
-    ik[i] = out[i];
-
-  return;
+  milenage_init (&ctx, k, opc, MILENAGE_AES_AUTO);
+  milenage_f2345 (&ctx, _rand, res, ck, ik, ak);
 }                               /* end of function f2345 */
 
 /*-------------------------------------------------------------------
@@ -246,51 +139,10 @@ f1star (
   const uint8_t amf[2],
   uint8_t mac_s[8])
 {
-  uint8_t                                 temp[16];
-  uint8_t                                 in1[16];
-  uint8_t                                 out1[16];
-  uint8_t                                 rijndaelInput[16];
-  uint8_t                                 i;
-
-  RijndaelKeySchedule (k);
-
-  for (i = 0; i < 16; i++)
-    rijndaelInput[i] = _rand[i] ^ opc[i];
-
-  RijndaelEncrypt (rijndaelInput, temp);
-
-  for (i = 0; i < 6; i++) {
-    in1[i] = sqn[i];
-    in1[i + 8] = sqn[i];
-  }
-
-  for (i = 0; i < 2; i++) {
-    in1[i + 6] = amf[i];
-    in1[i + 14] = amf[i];
-  }
-
-  /*
-   * XOR op_c and in1, rotate by r1=64, and XOR
-   * * * * on the constant c1 (which is all zeroes)
-   */
-  for (i = 0; i < 16; i++)
-    rijndaelInput[(i + 8) % 16] = in1[i] ^ opc[i];
+  milenage_ctx_t                          ctx;
 
-  /*
-   * XOR on the value temp computed before
-   */
-  for (i = 0; i < 16; i++)
-    rijndaelInput[i] ^= temp[i];
-
-  RijndaelEncrypt (rijndaelInput, out1);
-
-  for (i = 0; i < 16; i++)
-    out1[i] ^= opc[i];
-
-  for (i = 0; i < 8; i++)
-    mac_s[i] = out1[i + 8];
-
-  return;
+  milenage_init (&ctx, k, opc, MILENAGE_AES_AUTO);
+  milenage_f1star (&ctx, _rand, sqn, amf, mac_s);
 }                               /* end of function f1star */
 
 /*-------------------------------------------------------------------
@@ -308,36 +160,10 @@ f5star (
   const uint8_t _rand[16],
   uint8_t ak[6])
 {
-  uint8_t                                 temp[16];
-  uint8_t                                 out[16];
-  uint8_t                                 rijndaelInput[16];
-  uint8_t                                 i;
+  milenage_ctx_t                          ctx;
 
-  RijndaelKeySchedule (k);
-
-  for (i = 0; i < 16; i++)
-    rijndaelInput[i] = _rand[i] ^ opc[i];
-
-  RijndaelEncrypt (rijndaelInput, temp);
-
-  /*
-   * To obtain output block OUT5: XOR OPc and TEMP,
-   * * * * rotate by r5=96, and XOR on the constant c5 (which *
-   * * * * is all zeroes except that the 3rd from last bit is 1).
-   */
-  for (i = 0; i < 16; i++)
-    rijndaelInput[(i + 4) % 16] = temp[i] ^ opc[i];
-
-  rijndaelInput[15] ^= 8;
-  RijndaelEncrypt (rijndaelInput, out);
-
-  for (i = 0; i < 16; i++)
-    out[i] ^= opc[i];
-
-  for (i = 0; i < 6; i++)
-    ak[i] = out[i];
-
-  return;
+  milenage_init (&ctx, k, opc, MILENAGE_AES_AUTO);
+  milenage_f5star (&ctx, _rand, ak);
 }                               /* end of function f5star */
 
 /*-------------------------------------------------------------------
@@ -349,11 +175,12 @@ ComputeOPc (
   const uint8_t opP[16],
   uint8_t opcP[16])
 {
+  milenage_ctx_t                          ctx;
   uint8_t                                 i;
 
-  RijndaelKeySchedule (kP);
+  milenage_init (&ctx, kP, opP, MILENAGE_AES_AUTO);
   FPRINTF_DEBUG ("Compute opc:\n\tK:\t%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X\n", kP[0], kP[1], kP[2], kP[3], kP[4], kP[5], kP[6], kP[7], kP[8], kP[9], kP[10], kP[11], kP[12], kP[13], kP[14], kP[15]);
-  RijndaelEncrypt (opP, opcP);
+  milenage_encrypt (&ctx, opP, opcP);
   FPRINTF_DEBUG ("\tIn:\t%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X\n\tRinj:\t%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X\n",
           opP[0], opP[1], opP[2], opP[3], opP[4], opP[5], opP[6], opP[7],
           opP[8], opP[9], opP[10], opP[11], opP[12], opP[13], opP[14], opP[15], opcP[0], opcP[1], opcP[2], opcP[3], opcP[4], opcP[5], opcP[6], opcP[7], opcP[8], opcP[9], opcP[10], opcP[11], opcP[12], opcP[13], opcP[14], opcP[15]);
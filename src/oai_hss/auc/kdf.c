@@ -158,22 +158,20 @@ generate_vector (
   uint8_t                                 ck[16];
   uint8_t                                 ik[16];
   uint8_t                                 ak[6];
+  milenage_ctx_t                          ctx;
 
   if (vector == NULL) {
     return EINVAL;
   }
 
   /*
-   * Compute MAC
+   * Compute MAC, XRES, CK, IK, AK
    */
-  f1 (opc, key, vector->rand, sqn, amf, mac_a);
+  milenage_init (&ctx, key, opc, MILENAGE_AES_AUTO);
+  milenage_vector (&ctx, vector->rand, sqn, amf, mac_a, vector->xres, ck, ik, ak);
   print_buffer ("MAC_A   : ", mac_a, 8);
   print_buffer ("SQN     : ", sqn, 6);
   print_buffer ("RAND    : ", vector->rand, 16);
-  /*
-   * Compute XRES, CK, IK, AK
-   */
-  f2345 (opc, key, vector->rand, vector->xres, ck, ik, ak);
   print_buffer ("AK      : ", ak, 6);
   print_buffer ("CK      : ", ck, 16);
   print_buffer ("IK      : ", ik, 16);
@@ -187,3 +185,39 @@ generate_vector (
   print_buffer ("KASME   : ", vector->kasme, 32);
   return 0;
 }
+
+/*
+   Batch version of generate_vector() for multi-vector AIRs: K is expanded
+   once for all the vectors and nothing is traced. The RAND of each vector
+   must be set by the caller, all the vectors use the same SQN.
+*/
+int
+generate_vectors (
+  const uint8_t opc[16],
+  const uint8_t key[16],
+  uint8_t plmn[3],
+  uint8_t sqn[6],
+  auc_vector_t * vectors,
+  int num_vectors)
+{
+  uint8_t                                 amf[] = { 0x80, 0x00 };
+  uint8_t                                 mac_a[8];
+  uint8_t                                 ck[16];
+  uint8_t                                 ik[16];
+  uint8_t                                 ak[6];
+  milenage_ctx_t                          ctx;
+
+  if ((vectors == NULL) || (num_vectors < 0)) {
+    return EINVAL;
+  }
+
+  milenage_init (&ctx, key, opc, MILENAGE_AES_AUTO);
+
+  for (int i = 0; i < num_vectors; i++) {
+    milenage_vector (&ctx, vectors[i].rand, sqn, amf, mac_a, vectors[i].xres, ck, ik, ak);
+    generate_autn (sqn, ak, amf, mac_a, vectors[i].autn);
+    derive_kasme (ck, ik, plmn, sqn, ak, vectors[i].kasme);
+  }
+
+  return 0;
+}
@@ -0,0 +1,424 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*-------------------------------------------------------------------
+   Milenage engine (3GPP TS 35.206)
+  -------------------------------------------------------------------
+
+   Reentrant implementation of f1, f1*, f2, f3, f4, f5 and f5* on top
+   of an AES-128 kernel selected at run time: AES-NI when the CPU
+   reports it (CPUID.1:ECX.AES), a 32-bit T-table implementation
+   otherwise. All the state derived from K and OPc lives in a
+   milenage_ctx_t so one context per thread (or per request) can be
+   used without locking.
+
+   TEMP = E[RAND ^ OPc]K is shared by all the functions, so computing
+   a whole vector costs 5 AES blocks and one key schedule, against 7
+   blocks and 2 key schedules with separate f1() and f2345() calls.
+   The 4 output blocks of a vector do not depend on each other and
+   the AES-NI kernel runs them interleaved.
+
+  -----------------------------------------------------------------*/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <cpuid.h>
+#  include <wmmintrin.h>
+#  define MILENAGE_HAVE_AESNI 1
+#endif
+
+#include "auc.h"
+
+#define GETU32(pt) (((uint32_t)(pt)[0] << 24) ^ ((uint32_t)(pt)[1] << 16) ^ ((uint32_t)(pt)[2] <<  8) ^ ((uint32_t)(pt)[3]))
+#define PUTU32(ct, st) { (ct)[0] = (uint8_t)((st) >> 24); (ct)[1] = (uint8_t)((st) >> 16); (ct)[2] = (uint8_t)((st) >>  8); (ct)[3] = (uint8_t)(st); }
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint8_t                    aes_sbox[256] = {
+  0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+  0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+  0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+  0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+  0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+  0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+  0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+  0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+  0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+  0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+  0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+  0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+  0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+  0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+  0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+  0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+/* Round tables of the T-table kernel, filled once from the S box */
+static uint32_t                         Te0[256], Te1[256], Te2[256], Te3[256];
+
+static milenage_aes_t                   milenage_aes_default = MILENAGE_AES_TTABLE;
+static pthread_once_t                   milenage_once = PTHREAD_ONCE_INIT;
+
+//------------------------------------------------------------------------------
+static void milenage_global_init (void)
+{
+  for (int i = 0; i < 256; i++) {
+    uint32_t                                s = aes_sbox[i];
+    uint32_t                                s2 = (s << 1) ^ ((s & 0x80) ? 0x1b : 0x00);
+    uint32_t                                s3 = s2 ^ s;
+
+    Te0[i] = ((s2 & 0xff) << 24) | (s << 16) | (s << 8) | (s3 & 0xff);
+    Te1[i] = ROTR32 (Te0[i], 8);
+    Te2[i] = ROTR32 (Te0[i], 16);
+    Te3[i] = ROTR32 (Te0[i], 24);
+  }
+
+#if MILENAGE_HAVE_AESNI
+  unsigned int                            eax, ebx, ecx, edx;
+
+  if (__get_cpuid (1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES)) {
+    milenage_aes_default = MILENAGE_AES_NI;
+  }
+#endif
+}
+
+//------------------------------------------------------------------------------
+static void aes_ttable_encrypt (const milenage_ctx_t * const ctx, const uint8_t (*in)[16], uint8_t (*out)[16], int n)
+{
+  const uint32_t                         *rk;
+  uint32_t                                s0, s1, s2, s3, t0, t1, t2, t3;
+
+  for (int b = 0; b < n; b++) {
+    rk = ctx->rk.w;
+    s0 = GETU32 (in[b]) ^ rk[0];
+    s1 = GETU32 (in[b] + 4) ^ rk[1];
+    s2 = GETU32 (in[b] + 8) ^ rk[2];
+    s3 = GETU32 (in[b] + 12) ^ rk[3];
+
+    for (int r = 1; r < 10; r++) {
+      rk += 4;
+      t0 = Te0[s0 >> 24] ^ Te1[(s1 >> 16) & 0xff] ^ Te2[(s2 >> 8) & 0xff] ^ Te3[s3 & 0xff] ^ rk[0];
+      t1 = Te0[s1 >> 24] ^ Te1[(s2 >> 16) & 0xff] ^ Te2[(s3 >> 8) & 0xff] ^ Te3[s0 & 0xff] ^ rk[1];
+      t2 = Te0[s2 >> 24] ^ Te1[(s3 >> 16) & 0xff] ^ Te2[(s0 >> 8) & 0xff] ^ Te3[s1 & 0xff] ^ rk[2];
+      t3 = Te0[s3 >> 24] ^ Te1[(s0 >> 16) & 0xff] ^ Te2[(s1 >> 8) & 0xff] ^ Te3[s2 & 0xff] ^ rk[3];
+      s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    rk += 4;
+    t0 = ((uint32_t)aes_sbox[s0 >> 24] << 24) ^ ((uint32_t)aes_sbox[(s1 >> 16) & 0xff] << 16) ^
+         ((uint32_t)aes_sbox[(s2 >> 8) & 0xff] << 8) ^ (uint32_t)aes_sbox[s3 & 0xff] ^ rk[0];
+    t1 = ((uint32_t)aes_sbox[s1 >> 24] << 24) ^ ((uint32_t)aes_sbox[(s2 >> 16) & 0xff] << 16) ^
+         ((uint32_t)aes_sbox[(s3 >> 8) & 0xff] << 8) ^ (uint32_t)aes_sbox[s0 & 0xff] ^ rk[1];
+    t2 = ((uint32_t)aes_sbox[s2 >> 24] << 24) ^ ((uint32_t)aes_sbox[(s3 >> 16) & 0xff] << 16) ^
+         ((uint32_t)aes_sbox[(s0 >> 8) & 0xff] << 8) ^ (uint32_t)aes_sbox[s1 & 0xff] ^ rk[2];
+    t3 = ((uint32_t)aes_sbox[s3 >> 24] << 24) ^ ((uint32_t)aes_sbox[(s0 >> 16) & 0xff] << 16) ^
+         ((uint32_t)aes_sbox[(s1 >> 8) & 0xff] << 8) ^ (uint32_t)aes_sbox[s2 & 0xff] ^ rk[3];
+    PUTU32 (out[b], t0);
+    PUTU32 (out[b] + 4, t1);
+    PUTU32 (out[b] + 8, t2);
+    PUTU32 (out[b] + 12, t3);
+  }
+}
+
+#if MILENAGE_HAVE_AESNI
+//------------------------------------------------------------------------------
+__attribute__ ((target ("aes,sse2")))
+static void aes_ni_encrypt (const milenage_ctx_t * const ctx, const uint8_t (*in)[16], uint8_t (*out)[16], int n)
+{
+  __m128i                                 k[11];
+  __m128i                                 b0, b1, b2, b3;
+  int                                     b = 0;
+
+  for (int r = 0; r < 11; r++) {
+    k[r] = _mm_loadu_si128 ((const __m128i *)&ctx->rk.b[16 * r]);
+  }
+
+  /*
+   * 4 blocks at a time to hide the latency of AESENC
+   */
+  for (; b + 4 <= n; b += 4) {
+    b0 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)in[b]), k[0]);
+    b1 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)in[b + 1]), k[0]);
+    b2 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)in[b + 2]), k[0]);
+    b3 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)in[b + 3]), k[0]);
+
+    for (int r = 1; r < 10; r++) {
+      b0 = _mm_aesenc_si128 (b0, k[r]);
+      b1 = _mm_aesenc_si128 (b1, k[r]);
+      b2 = _mm_aesenc_si128 (b2, k[r]);
+      b3 = _mm_aesenc_si128 (b3, k[r]);
+    }
+
+    _mm_storeu_si128 ((__m128i *)out[b], _mm_aesenclast_si128 (b0, k[10]));
+    _mm_storeu_si128 ((__m128i *)out[b + 1], _mm_aesenclast_si128 (b1, k[10]));
+    _mm_storeu_si128 ((__m128i *)out[b + 2], _mm_aesenclast_si128 (b2, k[10]));
+    _mm_storeu_si128 ((__m128i *)out[b + 3], _mm_aesenclast_si128 (b3, k[10]));
+  }
+
+  for (; b < n; b++) {
+    b0 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)in[b]), k[0]);
+
+    for (int r = 1; r < 10; r++) {
+      b0 = _mm_aesenc_si128 (b0, k[r]);
+    }
+
+    _mm_storeu_si128 ((__m128i *)out[b], _mm_aesenclast_si128 (b0, k[10]));
+  }
+}
+#endif
+
+//------------------------------------------------------------------------------
+milenage_aes_t milenage_aes_available (void)
+{
+  pthread_once (&milenage_once, milenage_global_init);
+  return milenage_aes_default;
+}
+
+//------------------------------------------------------------------------------
+const char *milenage_aes_name (milenage_aes_t aes)
+{
+  switch (aes) {
+  case MILENAGE_AES_TTABLE:
+    return "T-table";
+  case MILENAGE_AES_NI:
+    return "AES-NI";
+  default:
+    return "auto";
+  }
+}
+
+//------------------------------------------------------------------------------
+int milenage_init (milenage_ctx_t * const ctx, const uint8_t k[16], const uint8_t opc[16], milenage_aes_t aes)
+{
+  uint32_t                               *w = ctx->rk.w;
+  uint32_t                                rcon = 0x01;
+
+  pthread_once (&milenage_once, milenage_global_init);
+
+  if (aes == MILENAGE_AES_AUTO) {
+    aes = milenage_aes_default;
+  } else if ((aes == MILENAGE_AES_NI) && (milenage_aes_default != MILENAGE_AES_NI)) {
+    return EINVAL;
+  }
+
+  /*
+   * FIPS-197 key expansion, words in big endian order
+   */
+  for (int i = 0; i < 4; i++) {
+    w[i] = GETU32 (k + 4 * i);
+  }
+
+  for (int i = 4; i < 44; i++) {
+    uint32_t                                t = w[i - 1];
+
+    if ((i & 3) == 0) {
+      t = ((uint32_t)aes_sbox[(t >> 16) & 0xff] << 24) ^ ((uint32_t)aes_sbox[(t >> 8) & 0xff] << 16) ^
+          ((uint32_t)aes_sbox[t & 0xff] << 8) ^ (uint32_t)aes_sbox[t >> 24] ^ (rcon << 24);
+      rcon = (rcon << 1) ^ ((rcon & 0x80) ? 0x1b : 0x00);
+    }
+
+    w[i] = w[i - 4] ^ t;
+  }
+
+  if (aes == MILENAGE_AES_NI) {
+#if MILENAGE_HAVE_AESNI
+    /*
+     * AESENC takes the round keys as byte strings
+     */
+    for (int i = 0; i < 44; i++) {
+      uint32_t                                t = w[i];
+
+      PUTU32 (&ctx->rk.b[4 * i], t);
+    }
+
+    ctx->encrypt = aes_ni_encrypt;
+#endif
+  } else {
+    ctx->encrypt = aes_ttable_encrypt;
+  }
+
+  ctx->aes = aes;
+  memcpy (ctx->opc, opc, 16);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void milenage_encrypt (const milenage_ctx_t * const ctx, const uint8_t in[16], uint8_t out[16])
+{
+  ctx->encrypt (ctx, (const uint8_t (*)[16])in, (uint8_t (*)[16])out, 1);
+}
+
+/*
+   OUTx = E[ROT(TEMP ^ OPc, rx) ^ cx]K ^ OPc for the blocks 2 to 5 of
+   TS 35.206, the rotation is given in bytes and cx is all zeroes but
+   the last byte.
+*/
+//------------------------------------------------------------------------------
+static inline void milenage_out_input (const milenage_ctx_t * const ctx, const uint8_t temp[16], int rot, uint8_t c, uint8_t input[16])
+{
+  for (int i = 0; i < 16; i++) {
+    input[(i + rot) & 15] = temp[i] ^ ctx->opc[i];
+  }
+
+  input[15] ^= c;
+}
+
+/*
+   OUT1 input: ROT(IN1 ^ OPc, r1 = 64) ^ TEMP, IN1 = SQN || AMF || SQN || AMF
+*/
+//------------------------------------------------------------------------------
+static inline void milenage_out1_input (const milenage_ctx_t * const ctx, const uint8_t temp[16], const uint8_t sqn[6], const uint8_t amf[2], uint8_t input[16])
+{
+  uint8_t                                 in1[16];
+
+  memcpy (&in1[0], sqn, 6);
+  memcpy (&in1[6], amf, 2);
+  memcpy (&in1[8], sqn, 6);
+  memcpy (&in1[14], amf, 2);
+
+  for (int i = 0; i < 16; i++) {
+    input[(i + 8) & 15] = in1[i] ^ ctx->opc[i];
+  }
+
+  for (int i = 0; i < 16; i++) {
+    input[i] ^= temp[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+static inline void milenage_temp (const milenage_ctx_t * const ctx, const uint8_t rand[16], uint8_t temp[16])
+{
+  uint8_t                                 input[16];
+
+  for (int i = 0; i < 16; i++) {
+    input[i] = rand[i] ^ ctx->opc[i];
+  }
+
+  ctx->encrypt (ctx, (const uint8_t (*)[16])input, (uint8_t (*)[16])temp, 1);
+}
+
+//------------------------------------------------------------------------------
+void milenage_f1 (const milenage_ctx_t * const ctx, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2], uint8_t mac_a[8])
+{
+  uint8_t                                 temp[16];
+  uint8_t                                 input[16];
+  uint8_t                                 out[16];
+
+  milenage_temp (ctx, rand, temp);
+  milenage_out1_input (ctx, temp, sqn, amf, input);
+  ctx->encrypt (ctx, (const uint8_t (*)[16])input, (uint8_t (*)[16])out, 1);
+
+  for (int i = 0; i < 8; i++) {
+    mac_a[i] = out[i] ^ ctx->opc[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+void milenage_f1star (const milenage_ctx_t * const ctx, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2], uint8_t mac_s[8])
+{
+  uint8_t                                 temp[16];
+  uint8_t                                 input[16];
+  uint8_t                                 out[16];
+
+  milenage_temp (ctx, rand, temp);
+  milenage_out1_input (ctx, temp, sqn, amf, input);
+  ctx->encrypt (ctx, (const uint8_t (*)[16])input, (uint8_t (*)[16])out, 1);
+
+  for (int i = 0; i < 8; i++) {
+    mac_s[i] = out[i + 8] ^ ctx->opc[i + 8];
+  }
+}
+
+//------------------------------------------------------------------------------
+void milenage_f2345 (const milenage_ctx_t * const ctx, const uint8_t rand[16], uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6])
+{
+  uint8_t                                 temp[16];
+  uint8_t                                 input[3][16];
+  uint8_t                                 out[3][16];
+
+  milenage_temp (ctx, rand, temp);
+  milenage_out_input (ctx, temp, 0, 1, input[0]);
+  milenage_out_input (ctx, temp, 12, 2, input[1]);
+  milenage_out_input (ctx, temp, 8, 4, input[2]);
+  ctx->encrypt (ctx, (const uint8_t (*)[16])input, out, 3);
+
+  for (int i = 0; i < 8; i++) {
+    res[i] = out[0][i + 8] ^ ctx->opc[i + 8];
+  }
+
+  for (int i = 0; i < 6; i++) {
+    ak[i] = out[0][i] ^ ctx->opc[i];
+  }
+
+  for (int i = 0; i < 16; i++) {
+    ck[i] = out[1][i] ^ ctx->opc[i];
+    ik[i] = out[2][i] ^ ctx->opc[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+void milenage_f5star (const milenage_ctx_t * const ctx, const uint8_t rand[16], uint8_t ak[6])
+{
+  uint8_t                                 temp[16];
+  uint8_t                                 input[16];
+  uint8_t                                 out[16];
+
+  milenage_temp (ctx, rand, temp);
+  milenage_out_input (ctx, temp, 4, 8, input);
+  ctx->encrypt (ctx, (const uint8_t (*)[16])input, (uint8_t (*)[16])out, 1);
+
+  for (int i = 0; i < 6; i++) {
+    ak[i] = out[i] ^ ctx->opc[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+void milenage_vector (const milenage_ctx_t * const ctx, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2],
+                      uint8_t mac_a[8], uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6])
+{
+  uint8_t                                 temp[16];
+  uint8_t                                 input[4][16];
+  uint8_t                                 out[4][16];
+
+  milenage_temp (ctx, rand, temp);
+  milenage_out1_input (ctx, temp, sqn, amf, input[0]);
+  milenage_out_input (ctx, temp, 0, 1, input[1]);
+  milenage_out_input (ctx, temp, 12, 2, input[2]);
+  milenage_out_input (ctx, temp, 8, 4, input[3]);
+  ctx->encrypt (ctx, (const uint8_t (*)[16])input, out, 4);
+
+  for (int i = 0; i < 8; i++) {
+    mac_a[i] = out[0][i] ^ ctx->opc[i];
+    res[i] = out[1][i + 8] ^ ctx->opc[i + 8];
+  }
+
+  for (int i = 0; i < 6; i++) {
+    ak[i] = out[1][i] ^ ctx->opc[i];
+  }
+
+  for (int i = 0; i < 16; i++) {
+    ck[i] = out[2][i] ^ ctx->opc[i];
+    ik[i] = out[3][i] ^ ctx->opc[i];
+  }
+}
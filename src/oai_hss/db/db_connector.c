@@ -20,6 +20,7 @@
  */
 
 
+
 #include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -31,6 +32,8 @@
 #include <inttypes.h>
 
 #include <mysql/mysql.h>
+#include <mysql/errmsg.h>
+#include <mysql/mysqld_error.h>
 
 #include "hss_config.h"
 #include "db_proto.h"
@@ -45,6 +48,26 @@ extern void                             ComputeOPc (
 
 database_t                             *db_desc;
 
+/*
+ * + 32 = 2 ^ sizeof(IND) (see 3GPP TS. 33.102)
+ */
+static const char                      *db_stmt_queries[DB_STMT_MAX] = {
+  [DB_STMT_AUTH_INFO] =
+    "SELECT `key`,`sqn`,`rand`,`OPc` FROM `users` WHERE `users`.`imsi`=?",
+  [DB_STMT_UPDATE_LOC] =
+    "SELECT `access_restriction`,`mmeidentity_idmmeidentity`," "`msisdn`,`ue_ambr_ul`,`ue_ambr_dl`,`rau_tau_timer` " "FROM `users` WHERE `users`.`imsi`=?",
+  [DB_STMT_GET_USER] =
+    "SELECT `imsi` FROM `users` WHERE `users`.`imsi`=?",
+  [DB_STMT_QUERY_MMEIDENTITY] =
+    "SELECT mmehost,mmerealm FROM mmeidentity WHERE " "mmeidentity.idmmeidentity=?",
+  [DB_STMT_PUSH_RAND_SQN] =
+    "UPDATE `users` SET `rand`=?,`sqn`=? WHERE `users`.`imsi`=?",
+  [DB_STMT_PUSH_RAND_SQN_INCREMENT] =
+    "UPDATE `users` SET `rand`=?,`sqn`=? + 32 WHERE `users`.`imsi`=?",
+  [DB_STMT_INCREMENT_SQN] =
+    "UPDATE `users` SET `sqn` = `sqn` + 32 WHERE `users`.`imsi`=?",
+};
+
 static void
 print_buffer (
   const char *prefix,
@@ -62,26 +85,218 @@ print_buffer (
   fprintf (stdout, "\n");
 }
 
+//------------------------------------------------------------------------------
+static void
+db_conn_close_stmts (
+  db_conn_t * conn)
+{
+  for (int i = 0; i < DB_STMT_MAX; i++) {
+    if (conn->stmt[i]) {
+      mysql_stmt_close (conn->stmt[i]);
+      conn->stmt[i] = NULL;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static int
+db_conn_prepare_stmts (
+  db_conn_t * conn)
+{
+  db_conn_close_stmts (conn);
+
+  for (int i = 0; i < DB_STMT_MAX; i++) {
+    conn->stmt[i] = mysql_stmt_init (conn->db_conn);
+
+    if (conn->stmt[i] == NULL) {
+      FPRINTF_ERROR ("An error occured while allocating statement: %s\n", mysql_error (conn->db_conn));
+      return ENOMEM;
+    }
+
+    if (mysql_stmt_prepare (conn->stmt[i], db_stmt_queries[i], strlen (db_stmt_queries[i]))) {
+      FPRINTF_ERROR ("An error occured while preparing \"%s\": %s\n", db_stmt_queries[i], mysql_stmt_error (conn->stmt[i]));
+      return EINVAL;
+    }
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int
+db_conn_open (
+  db_conn_t * conn)
+{
+  const int                               mysql_reconnect_val = 1;
+
+  conn->db_conn = mysql_init (NULL);
+
+  if (conn->db_conn == NULL) {
+    return ENOMEM;
+  }
+
+  mysql_options (conn->db_conn, MYSQL_OPT_RECONNECT, &mysql_reconnect_val);
+
+  /*
+   * Try to connect to database
+   */
+  if (!mysql_real_connect (conn->db_conn, db_desc->server, db_desc->user, db_desc->password, db_desc->database, 0, NULL, 0)) {
+    FPRINTF_ERROR ("An error occured while connecting to db: %s\n", mysql_error (conn->db_conn));
+    return -1;
+  }
+
+  /*
+   * Set the multi statement ON
+   */
+  mysql_set_server_option (conn->db_conn, MYSQL_OPTION_MULTI_STATEMENTS_ON);
+  return db_conn_prepare_stmts (conn);
+}
+
+//------------------------------------------------------------------------------
+static void
+db_conn_drain (
+  db_conn_t * conn)
+{
+  MYSQL_RES                              *res;
+
+  /*
+   * Discard pending results of multi statements so that the next user of the
+   * connection is not out of sync.
+   */
+  while (mysql_more_results (conn->db_conn)) {
+    if (mysql_next_result (conn->db_conn) > 0)
+      break;
+
+    if ((res = mysql_store_result (conn->db_conn)) != NULL)
+      mysql_free_result (res);
+  }
+}
+
+//------------------------------------------------------------------------------
+int
+hss_mysql_stmt_execute (
+  db_conn_t * conn,
+  db_stmt_id_t id,
+  MYSQL_BIND * params)
+{
+  unsigned int                            err;
+
+  for (int retry = 0; retry < 2; retry++) {
+    MYSQL_STMT                             *stmt = conn->stmt[id];
+
+    if (stmt == NULL) {
+      err = CR_SERVER_LOST;
+    } else if (mysql_stmt_bind_param (stmt, params) == 0 && mysql_stmt_execute (stmt) == 0) {
+      return 0;
+    } else {
+      err = mysql_stmt_errno (stmt);
+      FPRINTF_ERROR ("Statement execution failed: %s\n", mysql_stmt_error (stmt));
+    }
+
+    /*
+     * An automatic reconnection drops every statement prepared on the
+     * connection, prepare them again and retry once.
+     */
+    if ((err != CR_SERVER_GONE_ERROR) && (err != CR_SERVER_LOST) && (err != ER_UNKNOWN_STMT_HANDLER)) {
+      break;
+    }
+
+    if (mysql_ping (conn->db_conn) || db_conn_prepare_stmts (conn)) {
+      break;
+    }
+  }
+
+  return EINVAL;
+}
+
+//------------------------------------------------------------------------------
+static void
+db_bind_string (
+  MYSQL_BIND * bind,
+  const char *string,
+  unsigned long *length)
+{
+  memset (bind, 0, sizeof (MYSQL_BIND));
+  *length = strlen (string);
+  bind->buffer_type = MYSQL_TYPE_STRING;
+  bind->buffer = (void *)string;
+  bind->buffer_length = *length;
+  bind->length = length;
+}
+
+//------------------------------------------------------------------------------
+db_conn_t *
+hss_mysql_acquire_conn (
+  void)
+{
+  db_conn_t                              *conn = NULL;
+
+  if (db_desc == NULL) {
+    return NULL;
+  }
+
+  pthread_mutex_lock (&db_desc->db_cs_mutex);
+
+  while (db_desc->free_conns == NULL) {
+    pthread_cond_wait (&db_desc->db_cs_cond, &db_desc->db_cs_mutex);
+  }
+
+  conn = db_desc->free_conns;
+  db_desc->free_conns = conn->next;
+  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  conn->next = NULL;
+  return conn;
+}
+
+//------------------------------------------------------------------------------
+void
+hss_mysql_release_conn (
+  db_conn_t * conn)
+{
+  if (conn == NULL) {
+    return;
+  }
+
+  db_conn_drain (conn);
+  pthread_mutex_lock (&db_desc->db_cs_mutex);
+  conn->next = db_desc->free_conns;
+  db_desc->free_conns = conn;
+  pthread_cond_signal (&db_desc->db_cs_cond);
+  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+}
+
 int
 hss_mysql_connect (
   const hss_config_t * hss_config_p)
 {
-  const int                               mysql_reconnect_val = 1;
+  int                                     nb_conns = hss_config_p->mysql_pool_size;
 
   if ((hss_config_p->mysql_server == NULL) || (hss_config_p->mysql_user == NULL) || (hss_config_p->mysql_password == NULL) || (hss_config_p->mysql_database == NULL)) {
     FPRINTF_ERROR ( "An empty name is not allowed\n");
     return EINVAL;
   }
 
+  if (nb_conns <= 0) {
+    nb_conns = HSS_CONFIG_MYSQL_POOL_SIZE_DEFAULT;
+  }
+
   FPRINTF_DEBUG ("Initializing db layer\n");
-  db_desc = malloc (sizeof (database_t));
+  db_desc = calloc (1, sizeof (database_t));
 
   if (db_desc == NULL) {
     FPRINTF_DEBUG ("An error occured on MALLOC\n");
     return errno;
   }
 
+  db_desc->conns = calloc (nb_conns, sizeof (db_conn_t));
+
+  if (db_desc->conns == NULL) {
+    FPRINTF_DEBUG ("An error occured on MALLOC\n");
+    return errno;
+  }
+
   pthread_mutex_init (&db_desc->db_cs_mutex, NULL);
+  pthread_cond_init (&db_desc->db_cs_cond, NULL);
   /*
    * Copy database configuration from static hss config
    */
@@ -90,25 +305,27 @@ hss_mysql_connect (
   db_desc->password = strdup (hss_config_p->mysql_password);
   db_desc->database = strdup (hss_config_p->mysql_database);
   /*
-   * Init mySQL client
-   */
-  db_desc->db_conn = mysql_init (NULL);
-  mysql_options (db_desc->db_conn, MYSQL_OPT_RECONNECT, &mysql_reconnect_val);
-
-  /*
-   * Try to connect to database
+   * Init mySQL client, must be done before any thread uses the library
    */
-  if (!mysql_real_connect (db_desc->db_conn, db_desc->server, db_desc->user, db_desc->password, db_desc->database, 0, NULL, 0)) {
-    FPRINTF_ERROR ("An error occured while connecting to db: %s\n", mysql_error (db_desc->db_conn));
-    mysql_thread_end();
+  if (mysql_library_init (0, NULL, NULL)) {
+    FPRINTF_ERROR ("An error occured while initializing mysql library\n");
     return -1;
   }
 
-  /*
-   * Set the multi statement ON
-   */
-  mysql_set_server_option (db_desc->db_conn, MYSQL_OPTION_MULTI_STATEMENTS_ON);
-  FPRINTF_DEBUG ("Initializing db layer: DONE\n");
+  for (db_desc->nb_conns = 0; db_desc->nb_conns < nb_conns; db_desc->nb_conns++) {
+    db_conn_t                              *conn = &db_desc->conns[db_desc->nb_conns];
+
+    if (db_conn_open (conn) != 0) {
+      db_desc->nb_conns++;
+      hss_mysql_disconnect ();
+      return -1;
+    }
+
+    conn->next = db_desc->free_conns;
+    db_desc->free_conns = conn;
+  }
+
+  FPRINTF_DEBUG ("Initializing db layer: DONE (%d connections)\n", db_desc->nb_conns);
   return 0;
 }
 
@@ -116,7 +333,28 @@ void
 hss_mysql_disconnect (
   void)
 {
-  mysql_close (db_desc->db_conn);
+  if (db_desc == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < db_desc->nb_conns; i++) {
+    db_conn_close_stmts (&db_desc->conns[i]);
+
+    if (db_desc->conns[i].db_conn) {
+      mysql_close (db_desc->conns[i].db_conn);
+      db_desc->conns[i].db_conn = NULL;
+    }
+  }
+
+  free (db_desc->conns);
+  free (db_desc->server);
+  free (db_desc->user);
+  free (db_desc->password);
+  free (db_desc->database);
+  pthread_cond_destroy (&db_desc->db_cs_cond);
+  pthread_mutex_destroy (&db_desc->db_cs_mutex);
+  free (db_desc);
+  db_desc = NULL;
   mysql_thread_end();
 }
 
@@ -125,12 +363,22 @@ hss_mysql_update_loc (
   const char *imsi,
   mysql_ul_ans_t * mysql_ul_ans)
 {
-  MYSQL_RES                              *res;
-  MYSQL_ROW                               row;
-  char                                    query[1000];
+  db_conn_t                              *conn;
+  MYSQL_STMT                             *stmt;
+  MYSQL_BIND                              param[1];
+  MYSQL_BIND                              result[6];
+  unsigned long                           imsi_len;
+  unsigned long                           msisdn_len = 0;
+  my_bool                                 msisdn_is_null = 0;
+  char                                    msisdn[64];
+  int32_t                                 access_restriction = 0;
+  int32_t                                 mme_id = 0;
+  uint64_t                                aggr_ul = 0;
+  uint64_t                                aggr_dl = 0;
+  uint32_t                                rau_tau = 0;
   int                                     ret = 0;
 
-  if ((db_desc->db_conn == NULL) || (mysql_ul_ans == NULL)) {
+  if ((db_desc == NULL) || (mysql_ul_ans == NULL)) {
     return EINVAL;
   }
 
@@ -138,48 +386,82 @@ hss_mysql_update_loc (
     return EINVAL;
   }
 
-  sprintf (query, "SELECT `access_restriction`,`mmeidentity_idmmeidentity`," "`msisdn`,`ue_ambr_ul`,`ue_ambr_dl`,`rau_tau_timer` " "FROM `users` WHERE `users`.`imsi`='%s' ", imsi);
   memcpy (mysql_ul_ans->imsi, imsi, strlen (imsi) + 1);
-  FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
+  db_bind_string (&param[0], imsi, &imsi_len);
+  memset (result, 0, sizeof (result));
+  result[0].buffer_type = MYSQL_TYPE_LONG;
+  result[0].buffer = &access_restriction;
+  result[1].buffer_type = MYSQL_TYPE_LONG;
+  result[1].buffer = &mme_id;
+  result[2].buffer_type = MYSQL_TYPE_STRING;
+  result[2].buffer = msisdn;
+  result[2].buffer_length = sizeof (msisdn);
+  result[2].length = &msisdn_len;
+  result[2].is_null = &msisdn_is_null;
+  result[3].buffer_type = MYSQL_TYPE_LONGLONG;
+  result[3].buffer = &aggr_ul;
+  result[3].is_unsigned = 1;
+  result[4].buffer_type = MYSQL_TYPE_LONGLONG;
+  result[4].buffer = &aggr_dl;
+  result[4].is_unsigned = 1;
+  result[5].buffer_type = MYSQL_TYPE_LONG;
+  result[5].buffer = &rau_tau;
+  result[5].is_unsigned = 1;
+
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
+    return EINVAL;
+  }
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if (hss_mysql_stmt_execute (conn, DB_STMT_UPDATE_LOC, param) != 0) {
+    hss_mysql_release_conn (conn);
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  stmt = conn->stmt[DB_STMT_UPDATE_LOC];
 
-  if ( res == NULL )
+  if (mysql_stmt_bind_result (stmt, result)) {
+    FPRINTF_ERROR ("Binding result failed: %s\n", mysql_stmt_error (stmt));
+    mysql_stmt_free_result (stmt);
+    hss_mysql_release_conn (conn);
     return EINVAL;
+  }
 
-  if ((row = mysql_fetch_row (res)) != NULL) {
-    int                                     mme_id;
+  ret = mysql_stmt_fetch (stmt);
+  mysql_stmt_free_result (stmt);
+  /*
+   * The connection is released before looking up the MME identity which
+   * needs one from the pool too.
+   */
+  hss_mysql_release_conn (conn);
 
-    /*
-     * MSISDN may be NULL
-     */
-    mysql_ul_ans->access_restriction = atoi (row[0]);
+  if ((ret != 0) && (ret != MYSQL_DATA_TRUNCATED)) {
+    return 0;
+  }
 
-    if ((mme_id = atoi (row[1])) > 0) {
-      ret = hss_mysql_query_mmeidentity (mme_id, &mysql_ul_ans->mme_identity);
-    } else {
-      mysql_ul_ans->mme_identity.mme_host[0] = '\0';
-      mysql_ul_ans->mme_identity.mme_realm[0] = '\0';
-    }
+  ret = 0;
+  mysql_ul_ans->access_restriction = access_restriction;
 
-    if (row[2] != 0) {
-      memcpy (mysql_ul_ans->msisdn, row[2], strlen (row[2]));
+  if (mme_id > 0) {
+    ret = hss_mysql_query_mmeidentity (mme_id, &mysql_ul_ans->mme_identity);
+  } else {
+    mysql_ul_ans->mme_identity.mme_host[0] = '\0';
+    mysql_ul_ans->mme_identity.mme_realm[0] = '\0';
+  }
+
+  /*
+   * MSISDN may be NULL
+   */
+  if (!msisdn_is_null) {
+    if (msisdn_len >= sizeof (mysql_ul_ans->msisdn)) {
+      msisdn_len = sizeof (mysql_ul_ans->msisdn) - 1;
     }
 
-    mysql_ul_ans->aggr_ul = atoi (row[3]);
-    mysql_ul_ans->aggr_dl = atoi (row[4]);
-    mysql_ul_ans->rau_tau = atoi (row[5]);
+    memcpy (mysql_ul_ans->msisdn, msisdn, msisdn_len);
   }
 
-  mysql_free_result (res);
+  mysql_ul_ans->aggr_ul = aggr_ul;
+  mysql_ul_ans->aggr_dl = aggr_dl;
+  mysql_ul_ans->rau_tau = rau_tau;
   return ret;
 }
 
@@ -188,12 +470,13 @@ hss_mysql_purge_ue (
   mysql_pu_req_t * mysql_pu_req,
   mysql_pu_ans_t * mysql_pu_ans)
 {
+  db_conn_t                              *conn;
   MYSQL_RES                              *res;
   MYSQL_ROW                               row;
   char                                    query[1000];
   int                                     ret = 0;
 
-  if ((db_desc->db_conn == NULL) || (mysql_pu_req == NULL) || (mysql_pu_ans == NULL)) {
+  if ((db_desc == NULL) || (mysql_pu_req == NULL) || (mysql_pu_ans == NULL)) {
     return EINVAL;
   }
 
@@ -204,16 +487,19 @@ hss_mysql_purge_ue (
 
   sprintf (query, "UPDATE `users` SET `users`.`ms_ps_status`=\"PURGED\" " "WHERE `users`.`imsi`='%s'; " "SELECT `users`.`mmeidentity_idmmeidentity` FROM `users` " "WHERE `users`.`imsi`='%s' ", mysql_pu_req->imsi, mysql_pu_req->imsi);
   FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  if (mysql_query (conn->db_conn, query)) {
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (conn->db_conn));
+    hss_mysql_release_conn (conn);
+    return EINVAL;
+  }
+
+  res = mysql_store_result (conn->db_conn);
+  hss_mysql_release_conn (conn);
 
   if ( res == NULL )
     return EINVAL;
@@ -240,37 +526,36 @@ int
 hss_mysql_get_user (
   const char *imsi)
 {
-  MYSQL_RES                              *res;
-  MYSQL_ROW                               row;
-  char                                    query[1000];
+  db_conn_t                              *conn;
+  MYSQL_STMT                             *stmt;
+  MYSQL_BIND                              param[1];
+  unsigned long                           imsi_len;
+  int                                     ret;
 
-  if (db_desc->db_conn == NULL) {
+  if (db_desc == NULL) {
     return EINVAL;
   }
 
+  db_bind_string (&param[0], imsi, &imsi_len);
 
-  sprintf (query, "SELECT `imsi` FROM `users` WHERE `users`.`imsi`='%s' ", imsi);
-  FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
-
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
-
-  if ( res == NULL )
+  if (hss_mysql_stmt_execute (conn, DB_STMT_GET_USER, param) != 0) {
+    hss_mysql_release_conn (conn);
     return EINVAL;
+  }
 
-  if ((row = mysql_fetch_row (res)) != NULL) {
-    mysql_free_result (res);
+  stmt = conn->stmt[DB_STMT_GET_USER];
+  ret = mysql_stmt_fetch (stmt);
+  mysql_stmt_free_result (stmt);
+  hss_mysql_release_conn (conn);
+
+  if ((ret == 0) || (ret == MYSQL_DATA_TRUNCATED)) {
     return 0;
   }
 
-  mysql_free_result (res);
   return EINVAL;
 }
 
@@ -278,12 +563,13 @@ int
 mysql_push_up_loc (
   mysql_ul_push_t * ul_push_p)
 {
+  db_conn_t                              *conn;
   MYSQL_RES                              *res;
   char                                    query[1000];
   int                                     query_length = 0;
   int                                     status;
 
-  if ((db_desc->db_conn == NULL) || (ul_push_p == NULL)) {
+  if ((db_desc == NULL) || (ul_push_p == NULL)) {
     return EINVAL;
   }
   // TODO: multi-statement check results
@@ -316,11 +602,14 @@ mysql_push_up_loc (
   }
 
   FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    fprintf (stderr, "Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
+    return EINVAL;
+  }
+
+  if (mysql_query (conn->db_conn, query)) {
+    fprintf (stderr, "Query execution failed: %s\n", mysql_error (conn->db_conn));
+    hss_mysql_release_conn (conn);
     return EINVAL;
   }
 
@@ -331,7 +620,7 @@ mysql_push_up_loc (
     /*
      * did current statement return data?
      */
-    res = mysql_store_result (db_desc->db_conn);
+    res = mysql_store_result (conn->db_conn);
 
     if (res) {
       /*
@@ -339,8 +628,8 @@ mysql_push_up_loc (
        */
       mysql_free_result (res);
     } else {                    /* no result set or error */
-      if (mysql_field_count (db_desc->db_conn) == 0) {
-        FPRINTF_ERROR ( "%lld rows affected\n", mysql_affected_rows (db_desc->db_conn));
+      if (mysql_field_count (conn->db_conn) == 0) {
+        FPRINTF_ERROR ( "%lld rows affected\n", mysql_affected_rows (conn->db_conn));
       } else {                  /* some error occurred */
         FPRINTF_ERROR ( "Could not retrieve result set\n");
         break;
@@ -350,96 +639,85 @@ mysql_push_up_loc (
     /*
      * more results? -1 = no, >0 = error, 0 = yes (keep looping)
      */
-    if ((status = mysql_next_result (db_desc->db_conn)) > 0)
+    if ((status = mysql_next_result (conn->db_conn)) > 0)
       FPRINTF_ERROR ( "Could not execute statement\n");
   } while (status == 0);
 
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  hss_mysql_release_conn (conn);
   return 0;
 }
 
-int
-hss_mysql_push_rand_sqn (
+//------------------------------------------------------------------------------
+static int
+hss_mysql_execute_rand_sqn (
+  db_stmt_id_t id,
   const char *imsi,
   uint8_t * rand_p,
   uint8_t * sqn)
 {
-  int                                     status = 0,
-    i;
-  MYSQL_RES                              *res;
-  char                                    query[1000];
-  int                                     query_length = 0;
+  db_conn_t                              *conn;
+  MYSQL_BIND                              param[3];
+  unsigned long                           rand_len = RAND_LENGTH;
+  unsigned long                           imsi_len;
   uint64_t                                sqn_decimal = 0;
+  int                                     ret;
 
-  if (db_desc->db_conn == NULL) {
+  if (db_desc == NULL) {
     return EINVAL;
   }
 
-  if (rand_p == NULL || sqn == NULL) {
+  if (imsi == NULL || rand_p == NULL || sqn == NULL) {
     return EINVAL;
   }
 
   sqn_decimal = ((uint64_t) sqn[0] << 40) | ((uint64_t) sqn[1] << 32) | ((uint64_t) sqn[2] << 24) | (sqn[3] << 16) | (sqn[4] << 8) | sqn[5];
-  query_length = sprintf (query, "UPDATE `users` SET `rand`=UNHEX('");
-
-  for (i = 0; i < RAND_LENGTH; i++) {
-    query_length += sprintf (&query[query_length], "%02x", rand_p[i]);
-  }
-
-  query_length += sprintf (&query[query_length], "'),`sqn`=%" PRIu64, sqn_decimal);
-  query_length += sprintf (&query[query_length], " WHERE `users`.`imsi`='%s'", imsi);
-  FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
-
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  memset (param, 0, sizeof (param));
+  param[0].buffer_type = MYSQL_TYPE_BLOB;
+  param[0].buffer = rand_p;
+  param[0].buffer_length = RAND_LENGTH;
+  param[0].length = &rand_len;
+  param[1].buffer_type = MYSQL_TYPE_LONGLONG;
+  param[1].buffer = &sqn_decimal;
+  param[1].is_unsigned = 1;
+  db_bind_string (&param[2], imsi, &imsi_len);
+
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
     return EINVAL;
   }
 
-  /*
-   * process each statement result
-   */
-  do {
-    /*
-     * did current statement return data?
-     */
-    res = mysql_store_result (db_desc->db_conn);
-
-    if (res) {
-      /*
-       * yes; process rows and free the result set
-       */
-      mysql_free_result (res);
-    } else {                    /* no result set or error */
-      if (mysql_field_count (db_desc->db_conn) == 0) {
-        FPRINTF_ERROR ( "%lld rows affected\n", mysql_affected_rows (db_desc->db_conn));
-      } else {                  /* some error occurred */
-        FPRINTF_ERROR ( "Could not retrieve result set\n");
-        break;
-      }
-    }
+  ret = hss_mysql_stmt_execute (conn, id, param);
+  hss_mysql_release_conn (conn);
+  return ret;
+}
 
-    /*
-     * more results? -1 = no, >0 = error, 0 = yes (keep looping)
-     */
-    if ((status = mysql_next_result (db_desc->db_conn)) > 0)
-      FPRINTF_ERROR ( "Could not execute statement\n");
-  } while (status == 0);
+int
+hss_mysql_push_rand_sqn (
+  const char *imsi,
+  uint8_t * rand_p,
+  uint8_t * sqn)
+{
+  return hss_mysql_execute_rand_sqn (DB_STMT_PUSH_RAND_SQN, imsi, rand_p, sqn);
+}
 
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
-  return 0;
+int
+hss_mysql_push_rand_sqn_increment (
+  const char *imsi,
+  uint8_t * rand_p,
+  uint8_t * sqn)
+{
+  return hss_mysql_execute_rand_sqn (DB_STMT_PUSH_RAND_SQN_INCREMENT, imsi, rand_p, sqn);
 }
 
 int
 hss_mysql_increment_sqn (
   const char *imsi)
 {
-  int                                     status;
-  MYSQL_RES                              *res;
-  char                                    query[1000];
+  db_conn_t                              *conn;
+  MYSQL_BIND                              param[1];
+  unsigned long                           imsi_len;
+  int                                     ret;
 
-  if (db_desc->db_conn == NULL) {
+  if (db_desc == NULL) {
     return EINVAL;
   }
 
@@ -447,52 +725,15 @@ hss_mysql_increment_sqn (
     return EINVAL;
   }
 
-  /*
-   * + 32 = 2 ^ sizeof(IND) (see 3GPP TS. 33.102)
-   */
-  sprintf (query, "UPDATE `users` SET `sqn` = `sqn` + 32 WHERE `users`.`imsi`='%s'", imsi);
-  FPRINTF_DEBUG ("Query: %s\n", query);
+  db_bind_string (&param[0], imsi, &imsi_len);
 
-  pthread_mutex_lock(&db_desc->db_cs_mutex);
-
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
     return EINVAL;
   }
 
-  /*
-   * process each statement result
-   */
-  do {
-    /*
-     * did current statement return data?
-     */
-    res = mysql_store_result (db_desc->db_conn);
-
-    if (res) {
-      /*
-       * yes; process rows and free the result set
-       */
-      mysql_free_result (res);
-    } else {                    /* no result set or error */
-      if (mysql_field_count (db_desc->db_conn) == 0) {
-        FPRINTF_ERROR ( "%lld rows affected\n", mysql_affected_rows (db_desc->db_conn));
-      } else {                  /* some error occurred */
-        FPRINTF_ERROR ( "Could not retrieve result set\n");
-        break;
-      }
-    }
-
-    /*
-     * more results? -1 = no, >0 = error, 0 = yes (keep looping)
-     */
-    if ((status = mysql_next_result (db_desc->db_conn)) > 0)
-      FPRINTF_ERROR ( "Could not execute statement\n");
-  } while (status == 0);
-
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
-  return 0;
+  ret = hss_mysql_stmt_execute (conn, DB_STMT_INCREMENT_SQN, param);
+  hss_mysql_release_conn (conn);
+  return ret;
 }
 
 int
@@ -501,11 +742,16 @@ hss_mysql_auth_info (
   mysql_auth_info_resp_t * auth_info_resp)
 {
   int                                     ret = 0;
-  MYSQL_RES                              *res;
-  MYSQL_ROW                               row;
-  char                                    query[1000];
+  db_conn_t                              *conn;
+  MYSQL_STMT                             *stmt;
+  MYSQL_BIND                              param[1];
+  MYSQL_BIND                              result[4];
+  unsigned long                           imsi_len;
+  unsigned long                           lengths[4];
+  my_bool                                 is_null[4];
+  uint64_t                                sqn = 0;
 
-  if (db_desc->db_conn == NULL) {
+  if (db_desc == NULL) {
     return EINVAL;
   }
 
@@ -513,39 +759,61 @@ hss_mysql_auth_info (
     return EINVAL;
   }
 
-  sprintf (query, "SELECT `key`,`sqn`,`rand`,`OPc` FROM `users` WHERE `users`.`imsi`='%s' ", auth_info_req->imsi);
-  FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
+  db_bind_string (&param[0], auth_info_req->imsi, &imsi_len);
+  memset (result, 0, sizeof (result));
+  result[0].buffer_type = MYSQL_TYPE_BLOB;
+  result[0].buffer = auth_info_resp->key;
+  result[0].buffer_length = KEY_LENGTH;
+  result[1].buffer_type = MYSQL_TYPE_LONGLONG;
+  result[1].buffer = &sqn;
+  result[1].is_unsigned = 1;
+  result[2].buffer_type = MYSQL_TYPE_BLOB;
+  result[2].buffer = auth_info_resp->rand;
+  result[2].buffer_length = RAND_LENGTH;
+  result[3].buffer_type = MYSQL_TYPE_BLOB;
+  result[3].buffer = auth_info_resp->opc;
+  result[3].buffer_length = KEY_LENGTH;
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  for (int i = 0; i < 4; i++) {
+    result[i].length = &lengths[i];
+    result[i].is_null = &is_null[i];
+  }
+
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  if (hss_mysql_stmt_execute (conn, DB_STMT_AUTH_INFO, param) != 0) {
+    hss_mysql_release_conn (conn);
+    return EINVAL;
+  }
 
-  if ( res == NULL )
+  stmt = conn->stmt[DB_STMT_AUTH_INFO];
+
+  if (mysql_stmt_bind_result (stmt, result)) {
+    FPRINTF_ERROR ("Binding result failed: %s\n", mysql_stmt_error (stmt));
+    mysql_stmt_free_result (stmt);
+    hss_mysql_release_conn (conn);
     return EINVAL;
+  }
 
-  ret = 0;
+  ret = mysql_stmt_fetch (stmt);
+  mysql_stmt_free_result (stmt);
+  hss_mysql_release_conn (conn);
 
-  if ((row = mysql_fetch_row (res)) != NULL) {
-    if (row[0] == NULL || row[1] == NULL || row[2] == NULL || row[3] == NULL) {
+  if ((ret == 0) || (ret == MYSQL_DATA_TRUNCATED)) {
+    ret = 0;
+
+    if (is_null[0] || is_null[1] || is_null[2] || is_null[3]) {
       ret = EINVAL;
     }
 
-    if (row[0] != NULL) {
-      print_buffer ("Key: ", (uint8_t *) row[0], KEY_LENGTH);
-      memcpy (auth_info_resp->key, row[0], KEY_LENGTH);
+    if (!is_null[0]) {
+      print_buffer ("Key: ", auth_info_resp->key, KEY_LENGTH);
     }
 
-    if (row[1] != NULL) {
-      uint64_t                                sqn = 0;
-
-      sqn = atoll (row[1]);
-      printf ("Received SQN %s converted to %" PRIu64 "\n", row[1], sqn);
+    if (!is_null[1]) {
+      printf ("Received SQN converted to %" PRIu64 "\n", sqn);
       auth_info_resp->sqn[0] = (sqn & (255UL << 40)) >> 40;
       auth_info_resp->sqn[1] = (sqn & (255UL << 32)) >> 32;
       auth_info_resp->sqn[2] = (sqn & (255UL << 24)) >> 24;
@@ -555,21 +823,20 @@ hss_mysql_auth_info (
       print_buffer ("SQN: ", auth_info_resp->sqn, SQN_LENGTH);
     }
 
-    if (row[2] != NULL) {
-      print_buffer ("RAND: ", (uint8_t *) row[2], RAND_LENGTH);
-      memcpy (auth_info_resp->rand, row[2], RAND_LENGTH);
+    if (!is_null[2]) {
+      print_buffer ("RAND: ", auth_info_resp->rand, RAND_LENGTH);
     }
 
-    if (row[3] != NULL) {
-      print_buffer ("OPc: ", (uint8_t *) row[3], KEY_LENGTH);
-      memcpy (auth_info_resp->opc, row[3], KEY_LENGTH);
+    if (!is_null[3]) {
+      print_buffer ("OPc: ", auth_info_resp->opc, KEY_LENGTH);
     }
 
-  } else {
+  } else if (ret == MYSQL_NO_DATA) {
     ret =  DIAMETER_ERROR_USER_UNKNOWN;
+  } else {
+    ret = EINVAL;
   }
 
-  mysql_free_result (res);
   return ret;
 }
 
@@ -578,6 +845,7 @@ hss_mysql_check_opc_keys (
   const uint8_t opP[16])
 {
   int                                     ret = 0;
+  db_conn_t                              *conn;
   MYSQL_RES                              *res = NULL;
   MYSQL_RES                              *res2 = NULL;
   MYSQL_ROW                               row;
@@ -589,27 +857,29 @@ hss_mysql_check_opc_keys (
   int                                     status = 0;
   int                                     i;
 
-  if (db_desc->db_conn == NULL) {
+  if (db_desc == NULL) {
     return EINVAL;
   }
 
   sprintf (query, "SELECT `imsi`,`key`,`OPc` FROM `users` ");
   FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ( "Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
+    return EINVAL;
+  }
+
+  if (mysql_query (conn->db_conn, query)) {
+    FPRINTF_ERROR ( "Query execution failed: %s\n", mysql_error (conn->db_conn));
+    hss_mysql_release_conn (conn);
     mysql_thread_end ();
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  res = mysql_store_result (conn->db_conn);
 
   while ((row = mysql_fetch_row (res))) {
     if (row[0] == NULL || row[1] == NULL) {
-      FPRINTF_ERROR ( "Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+      FPRINTF_ERROR ( "Query execution failed: %s\n", mysql_error (conn->db_conn));
       ret = EINVAL;
     } else {
       if (row[0] != NULL) {
@@ -634,8 +904,8 @@ hss_mysql_check_opc_keys (
         update_length += sprintf (&update[update_length], "') WHERE `users`.`imsi`='%s'", (uint8_t *) row[0]);
         FPRINTF_DEBUG ("Query: %s\n", update);
 
-        if (mysql_query (db_desc->db_conn, update)) {
-          FPRINTF_ERROR ( "Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+        if (mysql_query (conn->db_conn, update)) {
+          FPRINTF_ERROR ( "Query execution failed: %s\n", mysql_error (conn->db_conn));
         } else {
           printf ("IMSI %s Updated OPc ", (uint8_t *) row[0]);
 
@@ -658,7 +928,7 @@ hss_mysql_check_opc_keys (
             /*
              * did current statement return data?
              */
-            res2 = mysql_store_result (db_desc->db_conn);
+            res2 = mysql_store_result (conn->db_conn);
 
             if (res2) {
               /*
@@ -666,8 +936,8 @@ hss_mysql_check_opc_keys (
                */
               mysql_free_result (res2);
             } else {            /* no result set or error */
-              if (mysql_field_count (db_desc->db_conn) == 0) {
-                FPRINTF_ERROR ( "%lld rows affected\n", mysql_affected_rows (db_desc->db_conn));
+              if (mysql_field_count (conn->db_conn) == 0) {
+                FPRINTF_ERROR ( "%lld rows affected\n", mysql_affected_rows (conn->db_conn));
               } else {          /* some error occurred */
                 FPRINTF_ERROR ( "Could not retrieve result set\n");
                 break;
@@ -677,7 +947,7 @@ hss_mysql_check_opc_keys (
             /*
              * more results? -1 = no, >0 = error, 0 = yes (keep looping)
              */
-            if ((status = mysql_next_result (db_desc->db_conn)) > 0)
+            if ((status = mysql_next_result (conn->db_conn)) > 0)
               FPRINTF_ERROR ( "Could not execute statement\n");
           } while (status == 0);
         }
@@ -686,6 +956,7 @@ hss_mysql_check_opc_keys (
   }
 
   mysql_free_result (res);
+  hss_mysql_release_conn (conn);
   mysql_thread_end ();
   return ret;
 }
@@ -39,49 +39,67 @@ hss_mysql_query_mmeidentity (
   const int id_mme_identity,
   mysql_mme_identity_t * mme_identity_p)
 {
-  MYSQL_RES                              *res;
-  MYSQL_ROW                               row;
-  char                                    query[1000];
-
-  if ((db_desc->db_conn == NULL) || (mme_identity_p == NULL)) {
+  db_conn_t                              *conn;
+  MYSQL_STMT                             *stmt;
+  MYSQL_BIND                              param[1];
+  MYSQL_BIND                              result[2];
+  unsigned long                           lengths[2] = {0, 0};
+  my_bool                                 is_null[2] = {0, 0};
+  int32_t                                 id = id_mme_identity;
+  int                                     ret;
+
+  if ((db_desc == NULL) || (mme_identity_p == NULL)) {
     return EINVAL;
   }
 
   memset (mme_identity_p, 0, sizeof (mysql_mme_identity_t));
-  sprintf (query, "SELECT mmehost,mmerealm FROM mmeidentity WHERE " "mmeidentity.idmmeidentity='%d' ", id_mme_identity);
-  FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
+  memset (param, 0, sizeof (param));
+  param[0].buffer_type = MYSQL_TYPE_LONG;
+  param[0].buffer = &id;
+  memset (result, 0, sizeof (result));
+  result[0].buffer_type = MYSQL_TYPE_STRING;
+  result[0].buffer = mme_identity_p->mme_host;
+  result[0].buffer_length = sizeof (mme_identity_p->mme_host);
+  result[0].length = &lengths[0];
+  result[0].is_null = &is_null[0];
+  result[1].buffer_type = MYSQL_TYPE_STRING;
+  result[1].buffer = mme_identity_p->mme_realm;
+  result[1].buffer_length = sizeof (mme_identity_p->mme_realm);
+  result[1].length = &lengths[1];
+  result[1].is_null = &is_null[1];
+
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
+    return EINVAL;
+  }
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if (hss_mysql_stmt_execute (conn, DB_STMT_QUERY_MMEIDENTITY, param) != 0) {
+    hss_mysql_release_conn (conn);
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  stmt = conn->stmt[DB_STMT_QUERY_MMEIDENTITY];
 
-  if ( res == NULL )
+  if (mysql_stmt_bind_result (stmt, result)) {
+    FPRINTF_ERROR ("Binding result failed: %s\n", mysql_stmt_error (stmt));
+    mysql_stmt_free_result (stmt);
+    hss_mysql_release_conn (conn);
     return EINVAL;
+  }
 
-  if ((row = mysql_fetch_row (res)) != NULL) {
-    if (row[0] != NULL) {
-      memcpy (mme_identity_p->mme_host, row[0], strlen (row[0]));
-    } else {
-      mme_identity_p->mme_host[0] = '\0';
-    }
-
-    if (row[1] != NULL) {
-      memcpy (mme_identity_p->mme_realm, row[1], strlen (row[1]));
-    } else {
-      mme_identity_p->mme_realm[0] = '\0';
-    }
-
-    mysql_free_result (res);
+  ret = mysql_stmt_fetch (stmt);
+  mysql_stmt_free_result (stmt);
+  hss_mysql_release_conn (conn);
+
+  if ((ret == 0) || (ret == MYSQL_DATA_TRUNCATED)) {
+    /*
+     * Strings are NUL terminated by the client library when there is room
+     * left, make sure of it when they have been truncated.
+     */
+    mme_identity_p->mme_host[is_null[0] ? 0 : sizeof (mme_identity_p->mme_host) - 1] = '\0';
+    mme_identity_p->mme_realm[is_null[1] ? 0 : sizeof (mme_identity_p->mme_realm) - 1] = '\0';
     return 0;
   }
 
-  mysql_free_result (res);
   return EINVAL;
 }
 
@@ -89,26 +107,30 @@ int
 hss_mysql_check_epc_equipment (
   mysql_mme_identity_t * mme_identity_p)
 {
+  db_conn_t                              *conn;
   MYSQL_RES                              *res;
   MYSQL_ROW                               row;
   char                                    query[1000];
 
-  if ((db_desc->db_conn == NULL) || (mme_identity_p == NULL)) {
+  if ((db_desc == NULL) || (mme_identity_p == NULL)) {
     return EINVAL;
   }
 
   sprintf (query, "SELECT idmmeidentity FROM mmeidentity WHERE mmeidentity.mmehost='%s' ", mme_identity_p->mme_host);
   FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
+    return EINVAL;
+  }
+
+  if (mysql_query (conn->db_conn, query)) {
+    FPRINTF_ERROR ("Query execution failed: %s\n", mysql_error (conn->db_conn));
+    hss_mysql_release_conn (conn);
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  res = mysql_store_result (conn->db_conn);
+  hss_mysql_release_conn (conn);
 
   if ( res == NULL )
     return EINVAL;
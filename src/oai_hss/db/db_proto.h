@@ -30,15 +30,40 @@
 #ifndef DB_PROTO_H_
 #define DB_PROTO_H_
 
-typedef struct {
+/* Server side prepared statements, prepared once on every pooled connection */
+typedef enum {
+  DB_STMT_AUTH_INFO = 0,
+  DB_STMT_UPDATE_LOC,
+  DB_STMT_GET_USER,
+  DB_STMT_QUERY_MMEIDENTITY,
+  DB_STMT_PUSH_RAND_SQN,
+  DB_STMT_PUSH_RAND_SQN_INCREMENT,
+  DB_STMT_INCREMENT_SQN,
+  DB_STMT_MAX,
+} db_stmt_id_t;
+
+typedef struct db_conn_s {
   /* The mysql reference connector object */
-  MYSQL *db_conn;
+  MYSQL      *db_conn;
+  MYSQL_STMT *stmt[DB_STMT_MAX];
+
+  /* Link in the free list of the pool */
+  struct db_conn_s *next;
+} db_conn_t;
+
+typedef struct {
+  /* Pool of connections, a connection is used by one thread at a time */
+  db_conn_t *conns;
+  int        nb_conns;
+  db_conn_t *free_conns;
+
   char  *server;
   char  *user;
   char  *password;
   char  *database;
 
   pthread_mutex_t db_cs_mutex;
+  pthread_cond_t  db_cs_cond;
 } database_t;
 
 extern database_t *db_desc;
@@ -166,6 +191,19 @@ int hss_mysql_connect(const hss_config_t *hss_config_p);
 
 void hss_mysql_disconnect(void);
 
+/* Take a connection out of the pool, waits until one is released if all of
+ * them are in use. Every acquired connection must be given back with
+ * hss_mysql_release_conn().
+ */
+db_conn_t *hss_mysql_acquire_conn(void);
+
+void hss_mysql_release_conn(db_conn_t *conn);
+
+/* Bind params to a prepared statement of an acquired connection and execute
+ * it, statements are prepared again if the connection was reestablished.
+ */
+int hss_mysql_stmt_execute(db_conn_t *conn, db_stmt_id_t id, MYSQL_BIND *params);
+
 int hss_mysql_get_user(const char *imsi);
 
 int hss_mysql_update_loc(const char *imsi, mysql_ul_ans_t *mysql_ul_ans);
@@ -191,6 +229,11 @@ int hss_mysql_push_rand_sqn(const char *imsi, uint8_t *rand_p, uint8_t *sqn);
 
 int hss_mysql_increment_sqn(const char *imsi);
 
+/* Same as hss_mysql_push_rand_sqn() followed by hss_mysql_increment_sqn()
+ * but in a single round trip to the database.
+ */
+int hss_mysql_push_rand_sqn_increment(const char *imsi, uint8_t *rand_p, uint8_t *sqn);
+
 int hss_mysql_check_opc_keys(const uint8_t opP[16]);
 
 
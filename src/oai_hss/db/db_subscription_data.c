@@ -44,8 +44,9 @@ hss_mysql_query_pdns (
   MYSQL_ROW                               row;
   char                                    query[1000];
   mysql_pdn_t                            *pdn_array = NULL;
+  db_conn_t                              *conn;
 
-  if (db_desc->db_conn == NULL) {
+  if (db_desc == NULL) {
     return EINVAL;
   }
 
@@ -55,16 +56,19 @@ hss_mysql_query_pdns (
 
   sprintf (query, "SELECT * FROM `pdn` WHERE " "`pdn`.`users_imsi`=%s LIMIT 10; ", imsi);
   FPRINTF_DEBUG ("Query: %s\n", query);
-  pthread_mutex_lock (&db_desc->db_cs_mutex);
 
-  if (mysql_query (db_desc->db_conn, query)) {
-    pthread_mutex_unlock (&db_desc->db_cs_mutex);
-    fprintf (stderr, "Query execution failed: %s\n", mysql_error (db_desc->db_conn));
+  if ((conn = hss_mysql_acquire_conn ()) == NULL) {
     return EINVAL;
   }
 
-  res = mysql_store_result (db_desc->db_conn);
-  pthread_mutex_unlock (&db_desc->db_cs_mutex);
+  if (mysql_query (conn->db_conn, query)) {
+    fprintf (stderr, "Query execution failed: %s\n", mysql_error (conn->db_conn));
+    hss_mysql_release_conn (conn);
+    return EINVAL;
+  }
+
+  res = mysql_store_result (conn->db_conn);
+  hss_mysql_release_conn (conn);
 
   if ( res == NULL )
     return EINVAL;
@@ -265,8 +265,7 @@ s6a_auth_info_cb (
        * Pick a new RAND and store SQN_MS + RAND in the HSS
        */
       generate_random (vector[0].rand, RAND_LENGTH);
-      hss_mysql_push_rand_sqn (auth_info_req.imsi, vector[0].rand, sqn);
-      hss_mysql_increment_sqn (auth_info_req.imsi);
+      hss_mysql_push_rand_sqn_increment (auth_info_req.imsi, vector[0].rand, sqn);
       free (sqn);
     }
 
@@ -285,27 +284,26 @@ s6a_auth_info_cb (
     sqn = auth_info_resp.sqn;
     for (int i = 0; i < num_vectors; i++) {
       generate_random (vector[i].rand, RAND_LENGTH);
-      generate_vector (auth_info_resp.opc, imsi, auth_info_resp.key, hdr->avp_value->os.data, sqn, &vector[i]);
     }
-    hss_mysql_push_rand_sqn (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
+    generate_vectors (auth_info_resp.opc, auth_info_resp.key, hdr->avp_value->os.data, sqn, vector, num_vectors);
+    hss_mysql_push_rand_sqn_increment (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
   } else {
     /*
      * Pick a new RAND and store SQN_MS + RAND in the HSS
      */
+    sqn = auth_info_resp.sqn;
+    ComputeOPc (auth_info_resp.key, hss_config.operator_key_bin, auth_info_resp.opc);
+    print_buffer ("opc      : ", auth_info_resp.opc, 16);
     for (int i = 0; i < num_vectors; i++) {
       generate_random (vector[i].rand, RAND_LENGTH);
-      sqn = auth_info_resp.sqn;
-      /*
-       * Generate authentication vector
-       */
-      ComputeOPc (auth_info_resp.key, hss_config.operator_key_bin, auth_info_resp.opc);
-      print_buffer ("opc      : ", auth_info_resp.opc, 16);
-      generate_vector (auth_info_resp.opc, imsi, auth_info_resp.key, hdr->avp_value->os.data, sqn, &vector[i]);
     }
-    hss_mysql_push_rand_sqn (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
+    /*
+     * Generate authentication vectors
+     */
+    generate_vectors (auth_info_resp.opc, auth_info_resp.key, hdr->avp_value->os.data, sqn, vector, num_vectors);
+    hss_mysql_push_rand_sqn_increment (auth_info_req.imsi, vector[num_vectors-1].rand, sqn);
   }
 
-  hss_mysql_increment_sqn (auth_info_req.imsi);
   /*
    * We add the vector
    */
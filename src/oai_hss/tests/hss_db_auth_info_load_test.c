@@ -0,0 +1,287 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Authentication-Information-Request load on the HSS MySQL backend: worker
+ * threads, standing for the freeDiameter application server threads, loop on
+ * the database part of an AIR (hss_mysql_auth_info() then
+ * hss_mysql_push_rand_sqn_increment()) on their own test subscriber.
+ * The load is run once with a single pooled connection (former single
+ * connection behaviour) and once with the requested pool size, the AIR per
+ * second of both runs are reported and the SQN of every subscriber is checked
+ * to have moved by 32 per request.
+ * Test subscribers 0010199000000xx are created and removed by the test.
+ *
+ * usage: hss_db_auth_info_load_test -s server -u user -p password -d database
+ *                                   [-t nb_threads] [-n nb_requests] [-c pool_size]
+ *
+ * Needs a local MySQL/MariaDB server with the oai_db.sql schema. The database
+ * layer traces every request on stdout, results are reported on stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <mysql/mysql.h>
+
+#include "hss_config.h"
+#include "db_proto.h"
+
+#define TEST_IMSI_FORMAT "0010199000000%02d"
+#define TEST_MAX_THREADS (100)
+
+typedef struct load_thread_s {
+  pthread_t                               thread;
+  int                                     index;
+  int                                     nb_requests;
+  int                                     nb_errors;
+  uint64_t                                sqn_start;
+  uint64_t                                sqn_end;
+} load_thread_t;
+
+//------------------------------------------------------------------------------
+static uint64_t
+sqn_to_u64 (
+  const uint8_t sqn[SQN_LENGTH])
+{
+  uint64_t                                sqn_decimal = 0;
+
+  for (int i = 0; i < SQN_LENGTH; i++) {
+    sqn_decimal = (sqn_decimal << 8) | sqn[i];
+  }
+
+  return sqn_decimal;
+}
+
+//------------------------------------------------------------------------------
+static int
+read_sqn (
+  int index,
+  uint64_t *sqn)
+{
+  mysql_auth_info_req_t                   req;
+  mysql_auth_info_resp_t                  resp;
+
+  snprintf (req.imsi, sizeof (req.imsi), TEST_IMSI_FORMAT, index);
+
+  if (hss_mysql_auth_info (&req, &resp) != 0) {
+    return -1;
+  }
+
+  *sqn = sqn_to_u64 (resp.sqn);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int
+run_query (
+  const char *query)
+{
+  db_conn_t                              *conn = hss_mysql_acquire_conn ();
+  int                                     ret = 0;
+
+  if (mysql_query (conn->db_conn, query)) {
+    fprintf (stderr, "%s: %s\n", query, mysql_error (conn->db_conn));
+    ret = -1;
+  }
+
+  hss_mysql_release_conn (conn);
+  return ret;
+}
+
+//------------------------------------------------------------------------------
+static void *
+load_thread (
+  void *arg)
+{
+  load_thread_t                          *lt = (load_thread_t *) arg;
+  mysql_auth_info_req_t                   req;
+  mysql_auth_info_resp_t                  resp;
+
+  snprintf (req.imsi, sizeof (req.imsi), TEST_IMSI_FORMAT, lt->index);
+
+  for (int i = 0; i < lt->nb_requests; i++) {
+    if (hss_mysql_auth_info (&req, &resp) != 0) {
+      lt->nb_errors++;
+      continue;
+    }
+
+    /*
+     * Next RAND, any value does it here
+     */
+    resp.rand[0] ^= (uint8_t) i;
+
+    if (hss_mysql_push_rand_sqn_increment (req.imsi, resp.rand, resp.sqn) != 0) {
+      lt->nb_errors++;
+    }
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int
+run_load (
+  hss_config_t * config,
+  load_thread_t * threads,
+  int nb_threads,
+  int nb_requests,
+  double *air_per_sec)
+{
+  struct timespec                         start,
+                                          stop;
+  int                                     nb_errors = 0;
+
+  if (hss_mysql_connect (config) != 0) {
+    fprintf (stderr, "Cannot connect to the database\n");
+    return -1;
+  }
+
+  for (int i = 0; i < nb_threads; i++) {
+    threads[i].index = i;
+    threads[i].nb_requests = nb_requests;
+    threads[i].nb_errors = 0;
+
+    if (read_sqn (i, &threads[i].sqn_start) != 0) {
+      fprintf (stderr, "Test subscriber %d not found\n", i);
+      hss_mysql_disconnect ();
+      return -1;
+    }
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < nb_threads; i++) {
+    pthread_create (&threads[i].thread, NULL, load_thread, &threads[i]);
+  }
+
+  for (int i = 0; i < nb_threads; i++) {
+    pthread_join (threads[i].thread, NULL);
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  *air_per_sec = (double)nb_threads * nb_requests / ((stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9);
+
+  for (int i = 0; i < nb_threads; i++) {
+    nb_errors += threads[i].nb_errors;
+
+    if ((read_sqn (i, &threads[i].sqn_end) != 0) || (threads[i].sqn_end != threads[i].sqn_start + 32 * (uint64_t) nb_requests)) {
+      fprintf (stderr, "Subscriber %d SQN %" PRIu64 " -> %" PRIu64 ", expected +%d\n",
+               i, threads[i].sqn_start, threads[i].sqn_end, 32 * nb_requests);
+      nb_errors++;
+    }
+  }
+
+  hss_mysql_disconnect ();
+  return nb_errors;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  hss_config_t                            config;
+  load_thread_t                           threads[TEST_MAX_THREADS];
+  char                                    query[512];
+  int                                     nb_threads = 4;
+  int                                     nb_requests = 2000;
+  int                                     pool_size = 0;
+  double                                  air_single = 0,
+                                          air_pool = 0;
+  int                                     errors = 0;
+  int                                     c;
+
+  memset (&config, 0, sizeof (config));
+
+  while ((c = getopt (argc, argv, "s:u:p:d:t:n:c:")) != -1) {
+    switch (c) {
+    case 's': config.mysql_server = optarg; break;
+    case 'u': config.mysql_user = optarg; break;
+    case 'p': config.mysql_password = optarg; break;
+    case 'd': config.mysql_database = optarg; break;
+    case 't': nb_threads = atoi (optarg); break;
+    case 'n': nb_requests = atoi (optarg); break;
+    case 'c': pool_size = atoi (optarg); break;
+    default:
+      fprintf (stderr, "usage: %s -s server -u user -p password -d database [-t nb_threads] [-n nb_requests] [-c pool_size]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if ((nb_threads <= 0) || (nb_threads > TEST_MAX_THREADS) || (nb_requests <= 0)) {
+    fprintf (stderr, "nb_threads must be in [1..%d], nb_requests > 0\n", TEST_MAX_THREADS);
+    return EXIT_FAILURE;
+  }
+
+  if (pool_size <= 0) {
+    pool_size = nb_threads;
+  }
+
+  /*
+   * Provision the test subscribers
+   */
+  config.mysql_pool_size = 1;
+
+  if (hss_mysql_connect (&config) != 0) {
+    fprintf (stderr, "Cannot connect to the database\n");
+    return EXIT_FAILURE;
+  }
+
+  for (int i = 0; i < nb_threads; i++) {
+    snprintf (query, sizeof (query), "REPLACE INTO `users` (`imsi`,`key`,`sqn`,`rand`,`OPc`) VALUES ('" TEST_IMSI_FORMAT "'," "UNHEX('8baf473f2f8fd09487cccbd7097c6862'),%d,UNHEX('00000000000000000000000000000000')," "UNHEX('8e27b6af0e692e750f32667a3b14605d'))", i, 32 * i);
+    errors += run_query (query) ? 1 : 0;
+  }
+
+  hss_mysql_disconnect ();
+
+  if (errors == 0) {
+    config.mysql_pool_size = 1;
+    errors += run_load (&config, threads, nb_threads, nb_requests, &air_single);
+    fprintf (stderr, "%d threads, 1 connection    : %10.0f AIR/s\n", nb_threads, air_single);
+  }
+
+  if (errors == 0) {
+    config.mysql_pool_size = pool_size;
+    errors += run_load (&config, threads, nb_threads, nb_requests, &air_pool);
+    fprintf (stderr, "%d threads, %d connections%s: %10.0f AIR/s (x%.2f)\n", nb_threads, pool_size, pool_size < 10 ? "   " : "  ", air_pool, air_pool / air_single);
+  }
+
+  /*
+   * Remove the test subscribers
+   */
+  config.mysql_pool_size = 1;
+
+  if (hss_mysql_connect (&config) == 0) {
+    run_query ("DELETE FROM `users` WHERE `imsi` LIKE '0010199000000%'");
+    hss_mysql_disconnect ();
+  }
+
+  fprintf (stderr, "%s: %d error(s)\n", errors ? "FAILED" : "PASSED", errors);
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
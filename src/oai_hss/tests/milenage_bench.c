@@ -0,0 +1,254 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Milenage throughput: authentication vectors (MAC-A, XRES, CK, IK, AK) per
+ * second computed by
+ *   - the former implementation: byte oriented Rijndael of rijndael.c with
+ *     its round keys in globals, f1() then f2345() (2 key schedules and 7
+ *     AES blocks per vector, single thread only),
+ *   - the fx.c one-shot wrappers f1() then f2345() on the new engine,
+ *   - milenage_vector() on a context per subscriber, for each AES kernel
+ *     the CPU supports, on 1 thread and on the requested number of threads.
+ *
+ * usage: milenage_bench [-n nb_vectors] [-t nb_threads] > /dev/null
+ *
+ * The former key schedule traces every call on stdout, results are reported
+ * on stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "auc.h"
+
+#define BENCH_MAX_THREADS (64)
+
+static const uint8_t                    bench_k[16] = {0x46, 0x5b, 0x5c, 0xe8, 0xb1, 0x99, 0xb4, 0x9f, 0xaa, 0x5f, 0x0a, 0x2e, 0xe2, 0x38, 0xa6, 0xbc};
+static const uint8_t                    bench_opc[16] = {0xcd, 0x63, 0xcb, 0x71, 0x95, 0x4a, 0x9f, 0x4e, 0x48, 0xa5, 0x99, 0x4e, 0x37, 0xa0, 0x2b, 0xaf};
+static const uint8_t                    bench_sqn[6] = {0xff, 0x9b, 0xb4, 0xd0, 0xb6, 0x07};
+static const uint8_t                    bench_amf[2] = {0x80, 0x00};
+
+typedef struct bench_thread_s {
+  pthread_t                               thread;
+  milenage_aes_t                          aes;
+  long                                    nb_vectors;
+  uint8_t                                 sink;
+} bench_thread_t;
+
+//------------------------------------------------------------------------------
+static double now (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static void report (const char *what, int nb_threads, long nb_vectors, double elapsed)
+{
+  fprintf (stderr, "%-28s %2d thread(s) %9ld vectors %8.3f s %12.0f vectors/s\n", what, nb_threads, nb_vectors, elapsed, nb_vectors / elapsed);
+}
+
+/*
+   f1 followed by f2345 as the former fx.c computed them
+*/
+//------------------------------------------------------------------------------
+static void legacy_vector (const uint8_t opc[16], const uint8_t k[16], const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2],
+                           uint8_t mac_a[8], uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6])
+{
+  uint8_t                                 temp[16], in1[16], out[16], input[16];
+  int                                     i;
+
+  /*
+   * f1
+   */
+  RijndaelKeySchedule (k);
+  for (i = 0; i < 16; i++)
+    input[i] = rand[i] ^ opc[i];
+  RijndaelEncrypt (input, temp);
+  for (i = 0; i < 6; i++) {
+    in1[i] = sqn[i];
+    in1[i + 8] = sqn[i];
+  }
+  for (i = 0; i < 2; i++) {
+    in1[i + 6] = amf[i];
+    in1[i + 14] = amf[i];
+  }
+  for (i = 0; i < 16; i++)
+    input[(i + 8) % 16] = in1[i] ^ opc[i];
+  for (i = 0; i < 16; i++)
+    input[i] ^= temp[i];
+  RijndaelEncrypt (input, out);
+  for (i = 0; i < 8; i++)
+    mac_a[i] = out[i] ^ opc[i];
+
+  /*
+   * f2345
+   */
+  RijndaelKeySchedule (k);
+  for (i = 0; i < 16; i++)
+    input[i] = rand[i] ^ opc[i];
+  RijndaelEncrypt (input, temp);
+  for (i = 0; i < 16; i++)
+    input[i] = temp[i] ^ opc[i];
+  input[15] ^= 1;
+  RijndaelEncrypt (input, out);
+  for (i = 0; i < 8; i++)
+    res[i] = out[i + 8] ^ opc[i + 8];
+  for (i = 0; i < 6; i++)
+    ak[i] = out[i] ^ opc[i];
+  for (i = 0; i < 16; i++)
+    input[(i + 12) % 16] = temp[i] ^ opc[i];
+  input[15] ^= 2;
+  RijndaelEncrypt (input, out);
+  for (i = 0; i < 16; i++)
+    ck[i] = out[i] ^ opc[i];
+  for (i = 0; i < 16; i++)
+    input[(i + 8) % 16] = temp[i] ^ opc[i];
+  input[15] ^= 4;
+  RijndaelEncrypt (input, out);
+  for (i = 0; i < 16; i++)
+    ik[i] = out[i] ^ opc[i];
+}
+
+//------------------------------------------------------------------------------
+static uint8_t bench_legacy (long nb_vectors)
+{
+  uint8_t                                 rand[16] = {0}, mac[8], res[8], ck[16], ik[16], ak[6];
+  uint8_t                                 sink = 0;
+
+  for (long n = 0; n < nb_vectors; n++) {
+    rand[n & 15] ^= (uint8_t)n;
+    legacy_vector (bench_opc, bench_k, rand, bench_sqn, bench_amf, mac, res, ck, ik, ak);
+    sink ^= mac[0] ^ res[0];
+  }
+
+  return sink;
+}
+
+//------------------------------------------------------------------------------
+static uint8_t bench_wrappers (long nb_vectors)
+{
+  uint8_t                                 rand[16] = {0}, mac[8], res[8], ck[16], ik[16], ak[6];
+  uint8_t                                 sink = 0;
+
+  for (long n = 0; n < nb_vectors; n++) {
+    rand[n & 15] ^= (uint8_t)n;
+    f1 (bench_opc, bench_k, rand, bench_sqn, bench_amf, mac);
+    f2345 (bench_opc, bench_k, rand, res, ck, ik, ak);
+    sink ^= mac[0] ^ res[0];
+  }
+
+  return sink;
+}
+
+//------------------------------------------------------------------------------
+static void *bench_ctx_thread (void *arg)
+{
+  bench_thread_t                         *t = (bench_thread_t *)arg;
+  milenage_ctx_t                          ctx;
+  uint8_t                                 rand[16] = {0}, mac[8], res[8], ck[16], ik[16], ak[6];
+
+  milenage_init (&ctx, bench_k, bench_opc, t->aes);
+
+  for (long n = 0; n < t->nb_vectors; n++) {
+    rand[n & 15] ^= (uint8_t)n;
+    milenage_vector (&ctx, rand, bench_sqn, bench_amf, mac, res, ck, ik, ak);
+    t->sink ^= mac[0] ^ res[0];
+  }
+
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void bench_ctx (milenage_aes_t aes, int nb_threads, long nb_vectors)
+{
+  bench_thread_t                          threads[BENCH_MAX_THREADS];
+  char                                    what[64];
+  double                                  start = now ();
+
+  for (int i = 0; i < nb_threads; i++) {
+    threads[i].aes = aes;
+    threads[i].nb_vectors = nb_vectors / nb_threads;
+    threads[i].sink = 0;
+    pthread_create (&threads[i].thread, NULL, bench_ctx_thread, &threads[i]);
+  }
+
+  for (int i = 0; i < nb_threads; i++) {
+    pthread_join (threads[i].thread, NULL);
+  }
+
+  snprintf (what, sizeof (what), "milenage_vector() %s", milenage_aes_name (aes));
+  report (what, nb_threads, (nb_vectors / nb_threads) * nb_threads, now () - start);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  long                                    nb_vectors = 1000000;
+  int                                     nb_threads = 4;
+  double                                  start;
+  int                                     c;
+
+  while ((c = getopt (argc, argv, "n:t:")) != -1) {
+    switch (c) {
+    case 'n':
+      nb_vectors = atol (optarg);
+      break;
+    case 't':
+      nb_threads = atoi (optarg);
+      break;
+    default:
+      fprintf (stderr, "usage: %s [-n nb_vectors] [-t nb_threads]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if ((nb_vectors <= 0) || (nb_threads < 1) || (nb_threads > BENCH_MAX_THREADS)) {
+    fprintf (stderr, "invalid parameters\n");
+    return 1;
+  }
+
+  start = now ();
+  bench_legacy (nb_vectors);
+  report ("legacy rijndael.c", 1, nb_vectors, now () - start);
+
+  start = now ();
+  bench_wrappers (nb_vectors);
+  report ("f1() + f2345()", 1, nb_vectors, now () - start);
+
+  bench_ctx (MILENAGE_AES_TTABLE, 1, nb_vectors);
+  bench_ctx (MILENAGE_AES_TTABLE, nb_threads, nb_vectors);
+
+  if (milenage_aes_available () == MILENAGE_AES_NI) {
+    bench_ctx (MILENAGE_AES_NI, 1, nb_vectors);
+    bench_ctx (MILENAGE_AES_NI, nb_threads, nb_vectors);
+  }
+
+  return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Milenage engine against the conformance test data of 3GPP TS 35.207
+ * section 4 (test sets 1 to 6), for every AES kernel the CPU supports:
+ * OPc, f1, f1*, f2, f3, f4, f5 and f5* through the milenage_ctx_t API,
+ * the combined milenage_vector() and the one-shot fx.c wrappers.
+ * The test sets are then computed concurrently from several threads
+ * sharing nothing but the engine, to check it is reentrant.
+ *
+ * usage: test_milenage
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "auc.h"
+
+#define TEST_THREADS    (8)
+#define TEST_ITERATIONS (20000)
+
+typedef struct ts_35_207_set_s {
+  const char                             *k;
+  const char                             *rand;
+  const char                             *sqn;
+  const char                             *amf;
+  const char                             *op;
+  const char                             *opc;
+  const char                             *f1;
+  const char                             *f1star;
+  const char                             *f2;
+  const char                             *f5;
+  const char                             *f3;
+  const char                             *f4;
+  const char                             *f5star;
+} ts_35_207_set_t;
+
+static const ts_35_207_set_t            test_sets[] = {
+  /* Test set 1 */
+  {"465b5ce8b199b49faa5f0a2ee238a6bc", "23553cbe9637a89d218ae64dae47bf35", "ff9bb4d0b607", "b9b9",
+   "cdc202d5123e20f62b6d676ac72cb318", "cd63cb71954a9f4e48a5994e37a02baf",
+   "4a9ffac354dfafb3", "01cfaf9ec4e871e9", "a54211d5e3ba50bf", "aa689c648370",
+   "b40ba9a3c58b2a05bbf0d987b21bf8cb", "f769bcd751044604127672711c6d3441", "451e8beca43b"},
+  /* Test set 2 */
+  {"0396eb317b6d1c36f19c1c84cd6ffd16", "c00d603103dcee52c4478119494202e8", "fd8eef40df7d", "af17",
+   "ff53bade17df5d4e793073ce9d7579fa", "53c15671c60a4b731c55b4a441c0bde2",
+   "5df5b31807e258b0", "a8c016e51ef4a343", "d3a628ed988620f0", "c47783995f72",
+   "58c433ff7a7082acd424220f2b67c556", "21a8c1f929702adb3e738488b9f5c5da", "30f1197061c1"},
+  /* Test set 3 */
+  {"fec86ba6eb707ed08905757b1bb44b8f", "9f7c8d021accf4db213ccff0c7f71a6a", "9d0277595ffc", "725c",
+   "dbc59adcb6f9a0ef735477b7fadf8374", "1006020f0a478bf6b699f15c062e42b3",
+   "9cabc3e99baf7281", "95814ba2b3044324", "8011c48c0c214ed2", "33484dc2136b",
+   "5dbdbb2954e8f3cde665b046179a5098", "59a92d3b476a0443487055cf88b2307b", "deacdd848cc6"},
+  /* Test set 4 */
+  {"9e5944aea94b81165c82fbf9f32db751", "ce83dbc54ac0274a157c17f80d017bd6", "0b604a81eca8", "9e09",
+   "223014c5806694c007ca1eeef57f004f", "a64a507ae1a2a98bb88eb4210135dc87",
+   "74a58220cba84c49", "ac2cc74a96871837", "f365cd683cd92e96", "f0b9c08ad02e",
+   "e203edb3971574f5a94b0d61b816345d", "0c4524adeac041c4dd830d20854fc46b", "6085a86c6f63"},
+  /* Test set 5 */
+  {"4ab1deb05ca6ceb051fc98e77d026a84", "74b0cd6031a1c8339b2b6ce2b8c4a186", "e880a1b580b6", "9f07",
+   "2d16c5cd1fdf6b22383584e3bef2a8d8", "dcf07cbd51855290b92a07a9891e523e",
+   "49e785dd12626ef2", "9e85790336bb3fa2", "5860fc1bce351e7e", "31e11a609118",
+   "7657766b373d1c2138f307e3de9242f9", "1c42e960d89b8fa99f2744e0708ccb53", "fe2555e54aa9"},
+  /* Test set 6 */
+  {"6c38a116ac280c454f59332ee35c8c4f", "ee6466bc96202c5a557abbeff8babf63", "414b98222181", "4464",
+   "1ba00a1a7c6700ac8c3ff3e96ad08725", "3803ef5363b947c6aaa225e58fae3934",
+   "078adfb488241a57", "80246b8d0186bcf1", "16c8233f05a0ac28", "45b0f69ab06c",
+   "3f8c7587fe8e4b233af676aede30ba3b", "a7466cc1e6b2a1337d49d3b66e95d7b4", "1f53cd2b1113"},
+};
+
+#define NB_TEST_SETS ((int)(sizeof (test_sets) / sizeof (test_sets[0])))
+
+typedef struct ts_35_207_bin_s {
+  uint8_t                                 k[16];
+  uint8_t                                 rand[16];
+  uint8_t                                 sqn[6];
+  uint8_t                                 amf[2];
+  uint8_t                                 op[16];
+  uint8_t                                 opc[16];
+  uint8_t                                 f1[8];
+  uint8_t                                 f1star[8];
+  uint8_t                                 f2[8];
+  uint8_t                                 f5[6];
+  uint8_t                                 f3[16];
+  uint8_t                                 f4[16];
+  uint8_t                                 f5star[6];
+} ts_35_207_bin_t;
+
+static ts_35_207_bin_t                  sets[NB_TEST_SETS];
+static int                              failures = 0;
+
+//------------------------------------------------------------------------------
+static void hex2bin (const char *hex, uint8_t *bin, size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    unsigned int                            b;
+
+    sscanf (&hex[2 * i], "%2x", &b);
+    bin[i] = (uint8_t)b;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void check (const char *what, milenage_aes_t aes, int set, const uint8_t *got, const uint8_t *exp, size_t len)
+{
+  if (memcmp (got, exp, len) != 0) {
+    fprintf (stderr, "FAIL %-8s %-14s test set %d\n", milenage_aes_name (aes), what, set + 1);
+    failures++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void test_kernel (milenage_aes_t aes)
+{
+  for (int s = 0; s < NB_TEST_SETS; s++) {
+    const ts_35_207_bin_t                  *t = &sets[s];
+    milenage_ctx_t                          ctx;
+    uint8_t                                 opc[16];
+    uint8_t                                 mac[8], res[8], ck[16], ik[16], ak[6];
+
+    /*
+     * OPc = E[OP]K ^ OP
+     */
+    milenage_init (&ctx, t->k, t->opc, aes);
+    milenage_encrypt (&ctx, t->op, opc);
+    for (int i = 0; i < 16; i++)
+      opc[i] ^= t->op[i];
+    check ("OPc", aes, s, opc, t->opc, 16);
+
+    milenage_f1 (&ctx, t->rand, t->sqn, t->amf, mac);
+    check ("f1", aes, s, mac, t->f1, 8);
+    milenage_f1star (&ctx, t->rand, t->sqn, t->amf, mac);
+    check ("f1*", aes, s, mac, t->f1star, 8);
+    milenage_f2345 (&ctx, t->rand, res, ck, ik, ak);
+    check ("f2", aes, s, res, t->f2, 8);
+    check ("f3", aes, s, ck, t->f3, 16);
+    check ("f4", aes, s, ik, t->f4, 16);
+    check ("f5", aes, s, ak, t->f5, 6);
+    milenage_f5star (&ctx, t->rand, ak);
+    check ("f5*", aes, s, ak, t->f5star, 6);
+
+    memset (res, 0, sizeof (res));
+    milenage_vector (&ctx, t->rand, t->sqn, t->amf, mac, res, ck, ik, ak);
+    check ("vector f1", aes, s, mac, t->f1, 8);
+    check ("vector f2", aes, s, res, t->f2, 8);
+    check ("vector f3", aes, s, ck, t->f3, 16);
+    check ("vector f4", aes, s, ik, t->f4, 16);
+    check ("vector f5", aes, s, ak, t->f5, 6);
+  }
+
+  fprintf (stderr, "%s kernel: %d test sets checked\n", milenage_aes_name (aes), NB_TEST_SETS);
+}
+
+//------------------------------------------------------------------------------
+static void test_wrappers (void)
+{
+  for (int s = 0; s < NB_TEST_SETS; s++) {
+    const ts_35_207_bin_t                  *t = &sets[s];
+    uint8_t                                 opc[16];
+    uint8_t                                 mac[8], res[8], ck[16], ik[16], ak[6];
+
+    ComputeOPc (t->k, t->op, opc);
+    check ("ComputeOPc", MILENAGE_AES_AUTO, s, opc, t->opc, 16);
+    f1 (t->opc, t->k, t->rand, t->sqn, t->amf, mac);
+    check ("f1()", MILENAGE_AES_AUTO, s, mac, t->f1, 8);
+    f1star (t->opc, t->k, t->rand, t->sqn, t->amf, mac);
+    check ("f1star()", MILENAGE_AES_AUTO, s, mac, t->f1star, 8);
+    f2345 (t->opc, t->k, t->rand, res, ck, ik, ak);
+    check ("f2345() f2", MILENAGE_AES_AUTO, s, res, t->f2, 8);
+    check ("f2345() f3", MILENAGE_AES_AUTO, s, ck, t->f3, 16);
+    check ("f2345() f4", MILENAGE_AES_AUTO, s, ik, t->f4, 16);
+    check ("f2345() f5", MILENAGE_AES_AUTO, s, ak, t->f5, 6);
+    f5star (t->opc, t->k, t->rand, ak);
+    check ("f5star()", MILENAGE_AES_AUTO, s, ak, t->f5star, 6);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *test_thread (void *arg)
+{
+  intptr_t                                errors = 0;
+
+  for (int n = 0; n < TEST_ITERATIONS; n++) {
+    const ts_35_207_bin_t                  *t = &sets[(n + (intptr_t)arg) % NB_TEST_SETS];
+    uint8_t                                 mac[8], res[8], ck[16], ik[16], ak[6];
+
+    f1 (t->opc, t->k, t->rand, t->sqn, t->amf, mac);
+    f2345 (t->opc, t->k, t->rand, res, ck, ik, ak);
+
+    if (memcmp (mac, t->f1, 8) || memcmp (res, t->f2, 8) || memcmp (ck, t->f3, 16) || memcmp (ik, t->f4, 16) || memcmp (ak, t->f5, 6)) {
+      errors++;
+    }
+  }
+
+  return (void *)errors;
+}
+
+//------------------------------------------------------------------------------
+static void test_threads (void)
+{
+  pthread_t                               threads[TEST_THREADS];
+
+  for (intptr_t i = 0; i < TEST_THREADS; i++) {
+    pthread_create (&threads[i], NULL, test_thread, (void *)i);
+  }
+
+  for (int i = 0; i < TEST_THREADS; i++) {
+    void                                   *errors;
+
+    pthread_join (threads[i], &errors);
+    if ((intptr_t)errors) {
+      fprintf (stderr, "FAIL thread %d: %ld wrong results\n", i, (long)(intptr_t)errors);
+      failures++;
+    }
+  }
+
+  fprintf (stderr, "%d threads x %d concurrent f1/f2345 computations checked\n", TEST_THREADS, TEST_ITERATIONS);
+}
+
+//------------------------------------------------------------------------------
+int main (void)
+{
+  for (int s = 0; s < NB_TEST_SETS; s++) {
+    hex2bin (test_sets[s].k, sets[s].k, 16);
+    hex2bin (test_sets[s].rand, sets[s].rand, 16);
+    hex2bin (test_sets[s].sqn, sets[s].sqn, 6);
+    hex2bin (test_sets[s].amf, sets[s].amf, 2);
+    hex2bin (test_sets[s].op, sets[s].op, 16);
+    hex2bin (test_sets[s].opc, sets[s].opc, 16);
+    hex2bin (test_sets[s].f1, sets[s].f1, 8);
+    hex2bin (test_sets[s].f1star, sets[s].f1star, 8);
+    hex2bin (test_sets[s].f2, sets[s].f2, 8);
+    hex2bin (test_sets[s].f5, sets[s].f5, 6);
+    hex2bin (test_sets[s].f3, sets[s].f3, 16);
+    hex2bin (test_sets[s].f4, sets[s].f4, 16);
+    hex2bin (test_sets[s].f5star, sets[s].f5star, 6);
+  }
+
+  test_kernel (MILENAGE_AES_TTABLE);
+  if (milenage_aes_available () == MILENAGE_AES_NI) {
+    test_kernel (MILENAGE_AES_NI);
+  } else {
+    fprintf (stderr, "AES-NI not supported by this CPU, kernel not tested\n");
+  }
+  test_wrappers ();
+  test_threads ();
+
+  if (failures) {
+    fprintf (stderr, "%d failures\n", failures);
+    return 1;
+  }
+
+  fprintf (stderr, "PASS\n");
+  return 0;
+}
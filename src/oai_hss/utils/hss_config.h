@@ -22,11 +22,17 @@
 #ifndef HSS_CONFIG_H_
 #define HSS_CONFIG_H_
 
+/* Default number of pooled MySQL connections, matches the default number of
+ * freeDiameter application server threads (AppServThreads).
+ */
+#define HSS_CONFIG_MYSQL_POOL_SIZE_DEFAULT (4)
+
 typedef struct hss_config_s {
   char *mysql_server;
   char *mysql_user;
   char *mysql_password;
   char *mysql_database;
+  int   mysql_pool_size;
 
 
   char *operator_key;
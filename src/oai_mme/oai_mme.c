@@ -156,7 +156,7 @@ main (
 #else
           NULL,
 #endif
-          NULL));
+          NULL, &mme_config.itti_config.memory_pools));
   MSC_INIT (MSC_MME, THREAD_MAX + TASK_MAX);
   CHECK_INIT_RETURN (nas_init (&mme_config));
   CHECK_INIT_RETURN (sctp_init (&mme_config));
@@ -82,6 +82,7 @@ ErrorEvent::ErrorEvent(
     fluid_base::OFConnection* ofconn,
     const struct ofp_error_msg* error_msg) :
     error_type_(ntohs(error_msg->type)), error_code_(ntohs(error_msg->code)),
+    xid_(ntohl(error_msg->header.xid)),
     ControllerEvent(ofconn, EVENT_ERROR) {}
 
 const uint16_t ErrorEvent::get_error_type() const {
@@ -92,6 +93,20 @@ const uint16_t ErrorEvent::get_error_code() const {
   return error_code_;
 }
 
+const uint32_t ErrorEvent::get_xid() const {
+  return xid_;
+}
+
+BarrierReplyEvent::BarrierReplyEvent(
+    fluid_base::OFConnection* ofconn,
+    const struct ofp_header* header) :
+    xid_(ntohl(header->xid)),
+    ControllerEvent(ofconn, EVENT_BARRIER_REPLY) {}
+
+const uint32_t BarrierReplyEvent::get_xid() const {
+  return xid_;
+}
+
 ExternalEvent::ExternalEvent(const ControllerEventType type) :
   ControllerEvent(NULL, type) {}
 
@@ -35,6 +35,7 @@ enum ControllerEventType {
   EVENT_SWITCH_DOWN,
   EVENT_SWITCH_UP,
   EVENT_ERROR,
+  EVENT_BARRIER_REPLY,
   EVENT_ADD_GTP_TUNNEL,
   EVENT_DELETE_GTP_TUNNEL,
   EVENT_STOP_DL_DATA_NOTIFICATION,
@@ -131,10 +132,28 @@ public:
 
   const uint16_t get_error_type() const;
   const uint16_t get_error_code() const;
+  const uint32_t get_xid() const;
 
 private:
   const uint16_t error_type_;
   const uint16_t error_code_;
+  const uint32_t xid_;
+};
+
+/**
+ * Event triggered when the switch answers a barrier request: every message
+ * sent before the barrier has been processed
+ */
+class BarrierReplyEvent : public ControllerEvent {
+public:
+  BarrierReplyEvent(
+    fluid_base::OFConnection* ofconn,
+    const struct ofp_header* header);
+
+  const uint32_t get_xid() const;
+
+private:
+  const uint32_t xid_;
 };
 
 /*
@@ -68,6 +68,9 @@ int start_of_controller(void) {
   ctrl.register_for_event(&gtp_app, openflow::EVENT_ADD_GTP_TUNNEL);
   ctrl.register_for_event(&gtp_app, openflow::EVENT_DELETE_GTP_TUNNEL);
   ctrl.register_for_event(&gtp_app, openflow::EVENT_STOP_DL_DATA_NOTIFICATION);
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_ERROR);
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_BARRIER_REPLY);
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_SWITCH_DOWN);
   ctrl.register_for_event(&arp_app, openflow::EVENT_SWITCH_UP);
 
   ctrl.start();
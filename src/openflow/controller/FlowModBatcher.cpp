@@ -0,0 +1,138 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+#include <assert.h>
+#include <string.h>
+
+#include "FlowModBatcher.h"
+
+namespace openflow {
+
+FlowModBatcher::FlowModBatcher() : next_xid_(FIRST_XID) {
+  memset(&current_.ue_ip, 0, sizeof(current_.ue_ip));
+  current_.ofconn = NULL;
+  current_.first_xid = 0;
+  current_.barrier_xid = 0;
+  current_.num_msgs = 0;
+  current_.num_errors = 0;
+}
+
+uint32_t FlowModBatcher::next_xid() {
+  current_.num_msgs++;
+  return next_xid_++;
+}
+
+void FlowModBatcher::begin(
+    fluid_base::OFConnection* ofconn,
+    const struct in_addr ue_ip,
+    const std::string& imsi) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (next_xid_ > LAST_XID) {
+    next_xid_ = FIRST_XID;
+  }
+  buffer_.clear();
+  current_.ofconn = ofconn;
+  current_.ue_ip = ue_ip;
+  current_.imsi = imsi;
+  current_.first_xid = next_xid_;
+  current_.barrier_xid = 0;
+  current_.num_msgs = 0;
+  current_.num_errors = 0;
+}
+
+void FlowModBatcher::add(fluid_msg::OFMsg& of_msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert(current_.num_msgs < MAX_BATCH_MSGS);
+  of_msg.xid(next_xid());
+  uint8_t* buffer = of_msg.pack();
+  buffer_.insert(buffer_.end(), buffer, buffer + of_msg.length());
+  fluid_msg::OFMsg::free_buffer(buffer);
+}
+
+uint32_t FlowModBatcher::commit(const OpenflowMessenger& messenger) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (0 == current_.num_msgs) {
+    return 0;
+  }
+  current_.barrier_xid = next_xid();
+  fluid_msg::of13::BarrierRequest barrier(current_.barrier_xid);
+  uint8_t* buffer = barrier.pack();
+  buffer_.insert(buffer_.end(), buffer, buffer + barrier.length());
+  fluid_msg::OFMsg::free_buffer(buffer);
+
+  pending_[current_.barrier_xid] = current_;
+  messenger.send_of_buffer(buffer_.data(), buffer_.size(), current_.ofconn);
+  current_.num_msgs = 0;
+  return current_.barrier_xid;
+}
+
+bool FlowModBatcher::handle_error(
+    fluid_base::OFConnection* ofconn,
+    const uint32_t xid,
+    FlowModBatch* batch) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // first pending batch whose range ends at or after xid
+  auto it = pending_.lower_bound(xid);
+  if ((it == pending_.end()) || (it->second.first_xid > xid) ||
+      (it->second.ofconn != ofconn)) {
+    return false;
+  }
+  it->second.num_errors++;
+  if (batch) {
+    *batch = it->second;
+  }
+  return true;
+}
+
+bool FlowModBatcher::handle_barrier_reply(
+    fluid_base::OFConnection* ofconn,
+    const uint32_t xid,
+    FlowModBatch* batch) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pending_.find(xid);
+  if ((it == pending_.end()) || (it->second.ofconn != ofconn)) {
+    return false;
+  }
+  if (batch) {
+    *batch = it->second;
+  }
+  pending_.erase(it);
+  return true;
+}
+
+void FlowModBatcher::connection_closed(fluid_base::OFConnection* ofconn) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    if (it->second.ofconn == ofconn) {
+      it = pending_.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+size_t FlowModBatcher::num_pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+}
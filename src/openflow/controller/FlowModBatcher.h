@@ -0,0 +1,151 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+#pragma once
+
+#include <netinet/in.h>
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "OpenflowMessenger.h"
+
+namespace openflow {
+
+/**
+ * Context of a batch of flow mods sent for one UE, reported back when the
+ * switch rejects one of its messages or answers its barrier
+ */
+struct FlowModBatch {
+  fluid_base::OFConnection* ofconn;
+  struct in_addr ue_ip;
+  std::string imsi;
+  uint32_t first_xid;    // xid of the first message of the batch
+  uint32_t barrier_xid;  // xid of the barrier request, last of the batch
+  uint32_t num_msgs;     // messages in the batch, barrier request included
+  uint32_t num_errors;   // error messages received for the batch so far
+};
+
+/**
+ * FlowModBatcher packs the flow mods of one UE event back to back in a single
+ * buffer, terminates them with a barrier request and sends the whole batch
+ * with one write on the connection. Every message of a batch gets its own
+ * transaction id, taken from a range owned by the batch, so that an error
+ * returned by the switch maps back to the UE. The batch is completed when the
+ * barrier reply comes back: by then the switch has processed (installed or
+ * rejected) all its messages.
+ * OpenFlow 1.3 has no bundles, a batch is ordered but not atomic: a rejected
+ * flow mod does not undo the others of the batch.
+ */
+class FlowModBatcher {
+public:
+  FlowModBatcher();
+
+  /**
+   * Starts a batch for the flow mods of a UE
+   *
+   * @param ofconn - the connection the batch will be sent on
+   * @param ue_ip - UE the flow mods are for, used to report errors
+   * @param imsi - IMSI of the UE if known, used to report errors
+   */
+  void begin(
+    fluid_base::OFConnection* ofconn,
+    const struct in_addr ue_ip,
+    const std::string& imsi);
+
+  /**
+   * Assigns the next transaction id of the batch to the message and packs it
+   * at the end of the batch buffer
+   *
+   * @param of_msg - message to add, its xid is overwritten
+   */
+  void add(fluid_msg::OFMsg& of_msg);
+
+  /**
+   * Terminates the batch with a barrier request and sends it. An empty batch
+   * is not sent.
+   *
+   * @param messenger - messenger used to send the batch buffer
+   * @return transaction id of the barrier request, 0 if nothing was sent
+   */
+  uint32_t commit(const OpenflowMessenger& messenger);
+
+  /**
+   * Maps the transaction id of an error message to the batch that sent the
+   * offending message and counts the error in it
+   *
+   * @param ofconn - connection the error came from
+   * @param xid - transaction id of the error message
+   * @param batch (out) - copy of the batch context if found
+   * @return true if the xid belongs to a pending batch
+   */
+  bool handle_error(
+    fluid_base::OFConnection* ofconn,
+    const uint32_t xid,
+    FlowModBatch* batch);
+
+  /**
+   * Completes the batch terminated by the barrier request xid
+   *
+   * @param ofconn - connection the barrier reply came from
+   * @param xid - transaction id of the barrier reply
+   * @param batch (out) - copy of the completed batch if found
+   * @return true if the xid is the barrier of a pending batch
+   */
+  bool handle_barrier_reply(
+    fluid_base::OFConnection* ofconn,
+    const uint32_t xid,
+    FlowModBatch* batch);
+
+  /**
+   * Drops the pending batches of a connection that went down
+   */
+  void connection_closed(fluid_base::OFConnection* ofconn);
+
+  /**
+   * @return number of batches sent and not yet acknowledged by their barrier
+   */
+  size_t num_pending() const;
+
+private:
+  /*
+   * xids 0 and 1 are left to the messages sent outside of batches (see
+   * DefaultMessenger::create_default_flow_mod), a batch never straddles the
+   * wrap around so that pending batches are ordered by xid
+   */
+  static const uint32_t FIRST_XID = 2;
+  static const uint32_t LAST_XID = 0xffff0000;
+  static const uint32_t MAX_BATCH_MSGS = 0x8000;
+
+  uint32_t next_xid();
+
+  mutable std::mutex mutex_;
+  uint32_t next_xid_;
+  FlowModBatch current_;
+  std::vector<uint8_t> buffer_;
+  // pending batches, keyed by barrier xid
+  std::map<uint32_t, FlowModBatch> pending_;
+};
+
+}
@@ -66,18 +66,58 @@ void GTPApplication::event_callback(const ControllerEvent& ev,
     OAILOG_STREAM_HEX(OAILOG_LEVEL_INFO, LOG_GTPV1U, "For Debug", (reinterpret_cast<const char*>(pi.get_data())), size);
   } else if (ev.get_type() == EVENT_ADD_GTP_TUNNEL) {
     auto add_tunnel_event = static_cast<const AddGTPTunnelEvent&>(ev);
+    // All flows of the UE go in one write, terminated by a barrier
+    batcher_.begin(ev.get_connection(), add_tunnel_event.get_ue_ip(),
+        add_tunnel_event.get_imsi());
     add_uplink_tunnel_flow(add_tunnel_event, messenger);
     add_downlink_tunnel_flow(add_tunnel_event, messenger);
+    batcher_.commit(messenger);
   } else if (ev.get_type() == EVENT_DELETE_GTP_TUNNEL) {
     auto del_tunnel_event = static_cast<const DeleteGTPTunnelEvent&>(ev);
+    batcher_.begin(ev.get_connection(), del_tunnel_event.get_ue_ip(),
+        std::string());
     delete_uplink_tunnel_flow(del_tunnel_event, messenger);
     delete_downlink_tunnel_flow(del_tunnel_event, messenger);
+    batcher_.commit(messenger);
+  } else if (ev.get_type() == EVENT_ERROR) {
+    handle_error(static_cast<const ErrorEvent&>(ev));
+  } else if (ev.get_type() == EVENT_BARRIER_REPLY) {
+    handle_barrier_reply(static_cast<const BarrierReplyEvent&>(ev));
+  } else if (ev.get_type() == EVENT_SWITCH_DOWN) {
+    batcher_.connection_closed(ev.get_connection());
   } else if (ev.get_type() == EVENT_SWITCH_UP) {
     install_switch_gtp_flow(ev.get_connection(), messenger);
     install_loop_flow(ev.get_connection(), messenger);
   }
 }
 
+void GTPApplication::handle_error(const ErrorEvent& ev) {
+  FlowModBatch batch;
+  if (batcher_.handle_error(ev.get_connection(), ev.get_xid(), &batch)) {
+    OAILOG_ERROR(LOG_GTPV1U,
+        "UE " IN_ADDR_FMT " IMSI %s flow mod xid %u (%u/%u of batch) rejected by switch, error type %u code %u\n",
+        PRI_IN_ADDR(batch.ue_ip), batch.imsi.c_str(), ev.get_xid(),
+        ev.get_xid() - batch.first_xid + 1, batch.num_msgs - 1,
+        ev.get_error_type(), ev.get_error_code());
+  }
+}
+
+void GTPApplication::handle_barrier_reply(const BarrierReplyEvent& ev) {
+  FlowModBatch batch;
+  if (batcher_.handle_barrier_reply(ev.get_connection(), ev.get_xid(), &batch)) {
+    if (batch.num_errors) {
+      OAILOG_ERROR(LOG_GTPV1U,
+          "UE " IN_ADDR_FMT " IMSI %s %u of %u flow mods rejected by switch\n",
+          PRI_IN_ADDR(batch.ue_ip), batch.imsi.c_str(), batch.num_errors,
+          batch.num_msgs - 1);
+    } else {
+      OAILOG_DEBUG(LOG_GTPV1U,
+          "UE " IN_ADDR_FMT " %u flow mods processed by switch\n",
+          PRI_IN_ADDR(batch.ue_ip), batch.num_msgs - 1);
+    }
+  }
+}
+
 
 
 void GTPApplication::install_switch_gtp_flow(fluid_base::OFConnection* ofconn,
@@ -191,8 +231,8 @@ void GTPApplication::add_uplink_tunnel_flow(
     OAILOG_DEBUG(LOG_GTPV1U, "UE " IN_ADDR_FMT " Create UL flow " TEID_FMT "\n",
         PRI_IN_ADDR(ue_in_addr), ev.get_in_tei());
 
-    // Finally, send flow mod
-    messenger.send_of_msg(uplink_fm, ev.get_connection());
+    // Finally, add flow mod to the batch of the UE
+    batcher_.add(uplink_fm);
   }
 #if DEBUG_IS_ON
   else {
@@ -307,7 +347,7 @@ void GTPApplication::delete_uplink_tunnel_flow(
     OAILOG_DEBUG(LOG_GTPV1U, "UE " IN_ADDR_FMT " Delete UL flow " TEID_FMT "\n",
         PRI_IN_ADDR(ue_in_addr), ev.get_in_tei());
 
-    messenger.send_of_msg(uplink_fm, ev.get_connection());
+    batcher_.add(uplink_fm);
   }
 #if DEBUG_IS_ON
   else {
@@ -455,8 +495,8 @@ void GTPApplication::delete_ue_paging_flow(
   of13::IPv4Dst ip_match(ue_ip.s_addr);
   fm.add_oxm_field(ip_match);
 
-  // Finally, send flow mod
-  messenger.send_of_msg(fm, ev.get_connection());
+  // Finally, add flow mod to the batch of the UE
+  batcher_.add(fm);
   OAILOG_DEBUG(LOG_GTPV1U, "DL clamp flow removed UE " IN_ADDR_FMT "\n", PRI_IN_ADDR(ue_ip));
 }
 
@@ -507,8 +547,8 @@ void GTPApplication::add_downlink_tunnel_flow(
 
       OAILOG_DEBUG(LOG_GTPV1U, "UE " IN_ADDR_FMT " Create DL flow " TEID_FMT " SDF id %d PF id %d\n",
           PRI_IN_ADDR(ue_in_addr), ev.get_out_tei(), rule->sdf_id, rule->sdf_template.sdf_filter[sdff_i].identifier);
-      // Finally, send flow mod
-      messenger.send_of_msg(downlink_fm, ev.get_connection());
+      // Finally, add flow mod to the batch of the UE
+      batcher_.add(downlink_fm);
     }
     //--------------------------------------------------------------------------
     // LOOP table
@@ -538,10 +578,10 @@ void GTPApplication::add_downlink_tunnel_flow(
     of13::GoToTable goto_inst(OF_TABLE_DL_GTPU + pool_id);
     fml.add_instruction(goto_inst);
 
-    // Finally, send flow mod
+    // Finally, add flow mod to the batch of the UE
     OAILOG_DEBUG(LOG_GTPV1U, "UE " IN_ADDR_FMT " Create Loop flow\n",
         PRI_IN_ADDR(ue_in_addr));
-    messenger.send_of_msg(fml, ev.get_connection());
+    batcher_.add(fml);
   }
 #if DEBUG_IS_ON
   else
@@ -571,7 +611,7 @@ void GTPApplication::delete_downlink_tunnel_flow(
 
       OAILOG_DEBUG(LOG_GTPV1U, "UE " IN_ADDR_FMT " Delete DL flow " TEID_FMT " SDF id %d PF id %d\n",
           PRI_IN_ADDR(ue_in_addr), ev.get_out_tei(), rule->sdf_id, rule->sdf_template.sdf_filter[sdff_i].identifier);
-      messenger.send_of_msg(downlink_fm, ev.get_connection());
+      batcher_.add(downlink_fm);
     }
   }
 #if DEBUG_IS_ON
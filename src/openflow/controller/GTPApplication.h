@@ -24,6 +24,7 @@
 #include <gmp.h> // gross but necessary to link spgw_config.h
 
 #include "OpenflowController.h"
+#include "FlowModBatcher.h"
 
 namespace openflow {
 
@@ -52,6 +53,17 @@ private:
   virtual void event_callback(const ControllerEvent& ev,
       const OpenflowMessenger& messenger);
 
+  /*
+   * Map an error from the switch back to the UE whose flow mod was rejected
+   * @param ev - ErrorEvent, its xid identifies the offending flow mod
+   */
+  void handle_error(const ErrorEvent& ev);
+
+  /*
+   * Complete the batch of flow mods of a UE
+   * @param ev - BarrierReplyEvent, its xid identifies the batch
+   */
+  void handle_barrier_reply(const BarrierReplyEvent& ev);
 
   void install_switch_gtp_flow(fluid_base::OFConnection* ofconn,
       const OpenflowMessenger& messenger);
@@ -119,6 +131,8 @@ private:
   const struct in_addr l3_egress_port_;
   const std::string l2_egress_port_;
   const uint32_t egress_port_num_;
+  // flow mods of the UE being handled, sent when the event is done
+  FlowModBatcher batcher_;
 };
 
 }
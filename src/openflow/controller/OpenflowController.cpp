@@ -87,6 +87,10 @@ void OpenflowController::message_callback(
     dispatch_event(ErrorEvent(
       ofconn,
       reinterpret_cast<struct ofp_error_msg*>(data)));
+  } else if (type == OFPT_BARRIER_REPLY_TYPE) {
+    dispatch_event(BarrierReplyEvent(
+      ofconn,
+      reinterpret_cast<struct ofp_header*>(data)));
   }
 }
 
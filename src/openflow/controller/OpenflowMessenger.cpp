@@ -54,4 +54,12 @@ void DefaultMessenger::send_of_msg(
   fluid_msg::OFMsg::free_buffer(buffer);
 }
 
+void DefaultMessenger::send_of_buffer(
+    const uint8_t* buffer,
+    const size_t len,
+    fluid_base::OFConnection* ofconn) const {
+  // the connection copies the data into its output buffer
+  ofconn->send(const_cast<uint8_t*>(buffer), len);
+}
+
 }
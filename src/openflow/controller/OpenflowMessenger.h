@@ -54,6 +54,19 @@ public:
   virtual void send_of_msg(
     fluid_msg::OFMsg& of_msg,
     fluid_base::OFConnection* ofconn) const {}
+
+  /**
+   * Sends already packed openflow messages, laid back to back in one buffer,
+   * with a single write
+   *
+   * @param buffer - packed messages
+   * @param len - total length of the messages
+   * @param ofconn - the connection to send the messages to
+   */
+  virtual void send_of_buffer(
+    const uint8_t* buffer,
+    const size_t len,
+    fluid_base::OFConnection* ofconn) const {}
 };
 
 /**
@@ -69,6 +82,11 @@ public:
   void send_of_msg(
     fluid_msg::OFMsg& of_msg,
     fluid_base::OFConnection* ofconn) const;
+
+  void send_of_buffer(
+    const uint8_t* buffer,
+    const size_t len,
+    fluid_base::OFConnection* ofconn) const;
 };
 
 }
@@ -55,7 +55,10 @@
 #include "s1ap_mme_nas_procedures.h"
 #include "s1ap_mme_retransmission.h"
 #include "s1ap_mme_itti_messaging.h"
+#include "s1ap_mme_paging.h"
+#include "s1ap_mme_ta.h"
 #include "dynamic_memory_check.h"
+#include "obj_slab.h"
 #include "mme_config.h"
 
 
@@ -73,6 +76,9 @@ uint32_t                                nb_enb_associated = 0;
 
 hash_table_ts_t g_s1ap_enb_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains eNB_description_s, key is eNB_description_s.enb_id (uint32_t);
 hash_table_ts_t g_s1ap_mme_id2assoc_id_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains sctp association id, key is mme_ue_s1ap_id;
+hash_table_ts_t g_s1ap_mme_ue_id2ue_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // references ue_description_s owned by eNB ue_coll, key is mme_ue_s1ap_id;
+
+static obj_slab_t                      *g_s1ap_ue_slab = NULL; // ue_description_s of all eNBs
 
 static int                              indent = 0;
 extern struct mme_config_s              mme_config;
@@ -265,6 +271,9 @@ s1ap_mme_thread (
 
       case TIMER_HAS_EXPIRED:{
         ue_description_t                       *ue_ref_p = NULL;
+        if (s1ap_mme_paging_handle_timer_expiry (received_message_p->ittiMsg.timer_has_expired.timer_id)) {
+          break;
+        }
         if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) {
           ue_description_t* ue_ref_p = (ue_description_t *)(received_message_p->ittiMsg.timer_has_expired.arg);
           if (!ue_ref_p) {
@@ -347,6 +356,23 @@ s1ap_mme_init(void)
   bdestroy_wrapper (&bs2);
   if (!h) return RETURNerror;
 
+  bstring bs5 = bfromcstr("s1ap_ue_slab");
+  g_s1ap_ue_slab = obj_slab_create (sizeof (ue_description_t), S1AP_UE_SLAB_CHUNK_UES, bs5);
+  bdestroy_wrapper (&bs5);
+  if (!g_s1ap_ue_slab) return RETURNerror;
+
+  /*
+   * Global mme_ue_s1ap_id UE index, the UE descriptions stay owned by the ue_coll of their eNB,
+   * so removing an entry must not free the data (hash_free_int_func is a no-op).
+   */
+  bstring bs3 = bfromcstr("s1ap_mme_ue_id2ue_coll");
+  h = hashtable_ts_init (&g_s1ap_mme_ue_id2ue_coll, mme_config.max_ues, NULL, hash_free_int_func, bs3);
+  bdestroy_wrapper (&bs3);
+  if (!h) return RETURNerror;
+
+  if (s1ap_mme_tai_index_init (s1ap_mme_tai_index_enb_pageable) != RETURNok) return RETURNerror;
+  if (s1ap_mme_paging_init () != RETURNok) return RETURNerror;
+
   if (itti_create_task (TASK_S1AP, &s1ap_mme_thread, NULL) < 0) {
     OAILOG_ERROR (LOG_S1AP, "Error while creating S1AP task\n");
     return RETURNerror;
@@ -359,12 +385,21 @@ s1ap_mme_init(void)
 void s1ap_mme_exit (void)
 {
   OAILOG_DEBUG (LOG_S1AP, "Cleaning S1AP\n");
+  s1ap_mme_paging_exit ();
   if (hashtable_ts_destroy(&g_s1ap_enb_coll) != HASH_TABLE_OK) {
     OAILOG_ERROR(LOG_S1AP, "An error occured while destroying s1 eNB hash table. \n");
   }
   if (hashtable_ts_destroy(&g_s1ap_mme_id2assoc_id_coll) != HASH_TABLE_OK) {
     OAILOG_ERROR(LOG_S1AP, "An error occured while destroying assoc_id hash table. \n");
   }
+  if (hashtable_ts_destroy(&g_s1ap_mme_ue_id2ue_coll) != HASH_TABLE_OK) {
+    OAILOG_ERROR(LOG_S1AP, "An error occured while destroying mme_ue_s1ap_id UE index. \n");
+  }
+  if (s1ap_mme_tai_index_exit () != HASH_TABLE_OK) {
+    OAILOG_ERROR(LOG_S1AP, "An error occured while destroying TAI eNB index. \n");
+  }
+  obj_slab_destroy (g_s1ap_ue_slab);
+  g_s1ap_ue_slab = NULL;
   OAILOG_DEBUG (LOG_S1AP, "Cleaning S1AP: DONE\n");
 }
 
@@ -525,83 +560,57 @@ s1ap_is_enb_ue_s1ap_id_in_list_per_enb (
 }
 
 //------------------------------------------------------------------------------
-bool s1ap_ue_compare_by_mme_ue_id_cb (__attribute__((unused)) const hash_key_t keyP,
-                                      void * const elementP, void * parameterP, void **resultP)
+ue_description_t                       *
+s1ap_is_ue_mme_id_in_list (
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id)
 {
-  mme_ue_s1ap_id_t                      * mme_ue_s1ap_id_p = (mme_ue_s1ap_id_t*)parameterP;
-  ue_description_t                       *ue_ref           = (ue_description_t*)elementP;
-  if ( *mme_ue_s1ap_id_p == ue_ref->mme_ue_s1ap_id ) {
-    *resultP = elementP;
-    OAILOG_TRACE(LOG_S1AP, "Found ue_ref %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT "\n", ue_ref, ue_ref->mme_ue_s1ap_id);
-    return true;
-  }
-  return false;
+  ue_description_t                       *ue_ref = NULL;
+
+  hashtable_ts_get (&g_s1ap_mme_ue_id2ue_coll, (const hash_key_t) mme_ue_s1ap_id, (void **)&ue_ref);
+  OAILOG_TRACE(LOG_S1AP, "Return ue_ref %p \n", ue_ref);
+  return ue_ref;
 }
 
 //------------------------------------------------------------------------------
-bool s1ap_enb_find_ue_by_mme_ue_id_cb (__attribute__((unused))const hash_key_t keyP,
-                                       void * const elementP, void * parameterP, void **resultP)
+/*
+ * Drop the index entry only if it still references this UE: during a handover the source and
+ * target UE descriptions share the same mme_ue_s1ap_id and the newest association wins.
+ */
+static void s1ap_ue_index_remove (hash_table_ts_t * const index, const hash_key_t key, const ue_description_t * const ue_ref)
 {
-  enb_description_t                      *enb_ref = (enb_description_t*)elementP;
+  ue_description_t                       *indexed_ue_ref = NULL;
 
-  hashtable_ts_apply_callback_on_elements((hash_table_ts_t * const)&enb_ref->ue_coll, s1ap_ue_compare_by_mme_ue_id_cb, parameterP, resultP);
-  if (*resultP) {
-    OAILOG_TRACE(LOG_S1AP, "Found ue_ref %p mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT "\n", *resultP, ((ue_description_t*)(*resultP))->mme_ue_s1ap_id);
-    return true;
+  if ((HASH_TABLE_OK == hashtable_ts_get (index, key, (void **)&indexed_ue_ref)) && (indexed_ue_ref == ue_ref)) {
+    hashtable_ts_remove (index, key, (void **)&indexed_ue_ref);
   }
-  return false;
-}
-//------------------------------------------------------------------------------
-bool s1ap_ue_compare_by_s11_sgw_teid_cb (__attribute__((unused))const hash_key_t keyP,
-                                         void * const elementP,
-                                         void *parameterP, void **resultP)
-{
-  s11_teid_t                       * s11_sgw_teid_p = (s11_teid_t*)parameterP;
-  ue_description_t                  *ue_ref         = (ue_description_t*)elementP;
-  if ( *s11_sgw_teid_p == ue_ref->s11_sgw_teid ) {
-    *resultP = elementP;
-    return true;
-  }
-  return false;
 }
 
 //------------------------------------------------------------------------------
-bool s1ap_enb_find_ue_by_s11_sgw_teid_cb (__attribute((unused)) const hash_key_t keyP,
-                                          void * const elementP, void * parameterP, void **resultP)
+static void s1ap_ue_indexes_remove (const ue_description_t * const ue_ref)
 {
-  enb_description_t                      *enb_ref = (enb_description_t*)elementP;
-
-  hashtable_ts_apply_callback_on_elements((hash_table_ts_t * const)&enb_ref->ue_coll, s1ap_ue_compare_by_s11_sgw_teid_cb, parameterP, resultP);
-  if (*resultP) {
-    return true;
-  }
-  return false;
+  s1ap_ue_index_remove (&g_s1ap_mme_ue_id2ue_coll, (const hash_key_t) ue_ref->mme_ue_s1ap_id, ue_ref);
 }
 
 //------------------------------------------------------------------------------
-ue_description_t                       *
-s1ap_is_ue_mme_id_in_list (
-  const mme_ue_s1ap_id_t mme_ue_s1ap_id)
+static bool s1ap_ue_indexes_remove_cb (__attribute__((unused)) const hash_key_t keyP,
+                                       void * const elementP,
+                                       __attribute__((unused)) void *parameterP,
+                                       __attribute__((unused)) void **resultP)
 {
-  ue_description_t                       *ue_ref = NULL;
-  mme_ue_s1ap_id_t                       *mme_ue_s1ap_id_p = (mme_ue_s1ap_id_t*)&mme_ue_s1ap_id;
-
-  hashtable_ts_apply_callback_on_elements(&g_s1ap_enb_coll, s1ap_enb_find_ue_by_mme_ue_id_cb, (void*)mme_ue_s1ap_id_p, (void**)&ue_ref);
-  OAILOG_TRACE(LOG_S1AP, "Return ue_ref %p \n", ue_ref);
-  return ue_ref;
+  s1ap_ue_indexes_remove ((ue_description_t*)elementP);
+  return false;
 }
 
 //------------------------------------------------------------------------------
-// TODO(amar) unused function check with OAI.
-ue_description_t                       *
-s1ap_is_s11_sgw_teid_in_list (
-  const s11_teid_t teid)
+void s1ap_set_ue_mme_ue_s1ap_id (
+    ue_description_t * const ue_ref,
+    const mme_ue_s1ap_id_t mme_ue_s1ap_id)
 {
-  ue_description_t                       *ue_ref = NULL;
-  s11_teid_t                             *teid_id_p = (s11_teid_t*)&teid;
-
-  hashtable_ts_apply_callback_on_elements(&g_s1ap_enb_coll, s1ap_enb_find_ue_by_s11_sgw_teid_cb, (void *)teid_id_p, (void**)&ue_ref);
-  return ue_ref;
+  s1ap_ue_index_remove (&g_s1ap_mme_ue_id2ue_coll, (const hash_key_t) ue_ref->mme_ue_s1ap_id, ue_ref);
+  ue_ref->mme_ue_s1ap_id = mme_ue_s1ap_id;
+  if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
+    hashtable_ts_insert (&g_s1ap_mme_ue_id2ue_coll, (const hash_key_t) mme_ue_s1ap_id, (void *)ue_ref);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -612,26 +621,29 @@ void s1ap_notified_new_ue_mme_s1ap_id_association (
 {
   enb_description_t   *enb_ref =  s1ap_is_enb_assoc_id_in_list (sctp_assoc_id);
 
-  ue_description_t * ue_ref_test = NULL;
-
   if (enb_ref) {
     ue_description_t   *ue_ref = s1ap_is_ue_enb_id_in_list (enb_ref,enb_ue_s1ap_id);
     if (ue_ref) {
-      ue_ref->mme_ue_s1ap_id = mme_ue_s1ap_id;
+      s1ap_set_ue_mme_ue_s1ap_id (ue_ref, mme_ue_s1ap_id);
       hashtable_rc_t  h_rc = hashtable_ts_insert (&g_s1ap_mme_id2assoc_id_coll, (const hash_key_t) mme_ue_s1ap_id, (void *)(uintptr_t)sctp_assoc_id);
       OAILOG_DEBUG(LOG_S1AP, "Associated  sctp_assoc_id %d, enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT ", mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ":%s \n",
           sctp_assoc_id, enb_ue_s1ap_id, mme_ue_s1ap_id, hashtable_rc_code2string(h_rc));
-
-      ue_ref_test = s1ap_is_ue_mme_id_in_list (mme_ue_s1ap_id);
       return;
     }
     OAILOG_DEBUG(LOG_S1AP, "Could not find  ue  with enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT "\n", enb_ue_s1ap_id);
-    ue_ref_test = s1ap_is_ue_mme_id_in_list (mme_ue_s1ap_id);
     return;
   }
   OAILOG_DEBUG(LOG_S1AP, "Could not find  eNB with sctp_assoc_id %d \n", sctp_assoc_id);
 }
 
+//------------------------------------------------------------------------------
+// free function of the eNB ue_coll
+static void s1ap_free_ue_description (void **ue_ref)
+{
+  obj_slab_free (g_s1ap_ue_slab, *ue_ref);
+  *ue_ref = NULL;
+}
+
 //------------------------------------------------------------------------------
 enb_description_t *s1ap_new_enb (void)
 {
@@ -647,7 +659,8 @@ enb_description_t *s1ap_new_enb (void)
   // Update number of eNB associated
   nb_enb_associated++;
   bstring bs = bfromcstr("s1ap_ue_coll");
-  hashtable_ts_init(&enb_ref->ue_coll, mme_config.max_ues, NULL, free_wrapper, bs);
+  // Start small, the table doubles with the number of UEs of this eNB instead of being sized for the whole MME
+  hashtable_ts_init(&enb_ref->ue_coll, S1AP_ENB_UE_COLL_INITIAL_SIZE, NULL, s1ap_free_ue_description, bs);
   bdestroy_wrapper (&bs);
   enb_ref->nb_ue_associated = 0;
   return enb_ref;
@@ -663,7 +676,7 @@ s1ap_new_ue (
 
   enb_ref = s1ap_is_enb_assoc_id_in_list (sctp_assoc_id);
   DevAssert (enb_ref != NULL);
-  ue_ref = calloc (1, sizeof (ue_description_t));
+  ue_ref = obj_slab_alloc (g_s1ap_ue_slab);
   /*
    * Something bad happened during malloc...
    * * * * May be we are running out of memory.
@@ -672,13 +685,18 @@ s1ap_new_ue (
   DevAssert (ue_ref != NULL);
   ue_ref->enb = enb_ref;
   ue_ref->enb_ue_s1ap_id = enb_ue_s1ap_id;
+  /*
+   * Not reachable through the global index until MME_APP notifies the mme_ue_s1ap_id
+   * (s1ap_set_ue_mme_ue_s1ap_id).
+   */
+  ue_ref->mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
   // Increment number of UE
   enb_ref->nb_ue_associated++;
 
   hashtable_rc_t  hashrc = hashtable_ts_insert (&enb_ref->ue_coll, (const hash_key_t) enb_ue_s1ap_id, (void *)ue_ref);
   if (HASH_TABLE_OK != hashrc) {
     OAILOG_ERROR(LOG_S1AP, "Could not insert UE descr in ue_coll: %s\n", hashtable_rc_code2string(hashrc));
-    free_wrapper((void**)&ue_ref);
+    s1ap_free_ue_description ((void**)&ue_ref);
     return NULL;
   }
   MSC_LOG_EVENT (MSC_S1AP_MME, " Associating ue  (enb_ue_s1ap_id: " ENB_UE_S1AP_ID_FMT ") to eNB %s", ue_ref->mme_ue_s1ap_id, enb_ref->enb_name);
@@ -729,6 +747,7 @@ s1ap_remove_ue (
       ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id, enb_ref->enb_id);
 
   ue_ref->s1_ue_state = S1AP_UE_INVALID_STATE;
+  s1ap_ue_indexes_remove (ue_ref);
   hashtable_ts_free (&enb_ref->ue_coll, ue_ref->enb_ue_s1ap_id);
 
   /** We will try to remove the SCTP association too, but it will anyways be set after the handover is completed. */
@@ -753,6 +772,8 @@ s1ap_remove_enb (
 {
   if (enb_ref == NULL)
     return;
+  hashtable_ts_apply_callback_on_elements(&enb_ref->ue_coll, s1ap_ue_indexes_remove_cb, NULL, NULL);
+  s1ap_mme_tai_index_remove_enb (&enb_ref->tai_index);
   hashtable_ts_destroy(&enb_ref->ue_coll);
   hashtable_ts_free (&g_s1ap_enb_coll, enb_ref->sctp_assoc_id);
   nb_enb_associated--;
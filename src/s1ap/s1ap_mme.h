@@ -35,6 +35,8 @@
 #endif
 
 #include "hashtable.h"
+#include "mme_default_values.h"
+#include "s1ap_mme_tai_index.h"
 
 // Forward declarations
 struct enb_description_s;
@@ -126,6 +128,11 @@ typedef struct enb_description_s {
   sctp_stream_id_t instreams;        ///< Number of streams avalaible on eNB -> MME
   sctp_stream_id_t outstreams;       ///< Number of streams avalaible on MME -> eNB
   /*@}*/
+
+  /** Paging **/
+  /*@{*/
+  s1ap_tai_index_enb_t tai_index;                                 ///< TAIs of the S1 Setup supported TAs, entry of this eNB in the TAI index
+  /*@}*/
 } enb_description_t;
 
 extern bool             hss_associated;
@@ -165,7 +172,11 @@ ue_description_t* s1ap_is_ue_enb_id_in_list(enb_description_t *enb_ref,
  * @returns NULL if no UE matchs the ue_mme_id, or reference to the ue element in list if matches
  **/
 ue_description_t* s1ap_is_ue_mme_id_in_list(const mme_ue_s1ap_id_t ue_mme_id);
-ue_description_t* s1ap_is_s11_sgw_teid_in_list(const s11_teid_t teid);
+
+/** \brief Set the mme_ue_s1ap_id of an UE and keep the global mme_ue_s1ap_id index in sync.
+ * The UE descriptions must never have this field written directly.
+ **/
+void s1ap_set_ue_mme_ue_s1ap_id(ue_description_t * const ue_ref, const mme_ue_s1ap_id_t mme_ue_s1ap_id);
 
 /** \brief Look for given ue enb s1ap id in the list of UEs for a particular enb.
  * \param enb_id The unique ue_enb_id to search in list
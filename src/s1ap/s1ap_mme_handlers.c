@@ -402,6 +402,9 @@ s1ap_mme_handle_s1_setup_request (
        */
     }
 
+    // Paging fan-out: this eNB serves the TAIs of its supported TAs
+    s1ap_mme_tai_index_set_enb (enb_association, &s1SetupRequest_p->supportedTAs);
+
     s1ap_dump_enb (enb_association);
     rc =  s1ap_generate_s1_setup_response (enb_association);
     if (rc == RETURNok) {
@@ -1143,7 +1146,7 @@ s1ap_mme_handle_path_switch_request (
 
     ue_ref_p->enb_ue_s1ap_id = enb_ue_s1ap_id;
     // Will be allocated by NAS
-    ue_ref_p->mme_ue_s1ap_id = mme_ue_s1ap_id;
+    s1ap_set_ue_mme_ue_s1ap_id (ue_ref_p, mme_ue_s1ap_id);
 
     ue_ref_p->s1ap_ue_context_rel_timer.id  = S1AP_TIMER_INACTIVE_ID;
     ue_ref_p->s1ap_ue_context_rel_timer.sec = S1AP_UE_CONTEXT_REL_COMP_TIMER;
@@ -45,6 +45,7 @@
 #include "s1ap_mme_encoder.h"
 #include "s1ap_mme_itti_messaging.h"
 #include "s1ap_mme.h"
+#include "s1ap_mme_paging.h"
 #include "mme_config.h"
 
 /* Every time a new UE is associated, increment this variable.
@@ -119,8 +120,7 @@ s1ap_mme_handle_initial_ue_message (
     ue_ref->s1_ue_state = S1AP_UE_WAITING_CSR;
 
     ue_ref->enb_ue_s1ap_id = enb_ue_s1ap_id;
-    // Will be allocated by NAS
-    ue_ref->mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
+    // mme_ue_s1ap_id will be allocated by NAS, s1ap_new_ue() left it INVALID_MME_UE_S1AP_ID
 
     ue_ref->s1ap_ue_context_rel_timer.id  = S1AP_TIMER_INACTIVE_ID;
     ue_ref->s1ap_ue_context_rel_timer.sec = S1AP_UE_CONTEXT_REL_COMP_TIMER;
@@ -1571,14 +1571,16 @@ s1ap_handle_mme_status_transfer( const itti_s1ap_status_transfer_t * const s1ap_
 void
 s1ap_handle_paging( const itti_s1ap_paging_t * const s1ap_paging_pP){
 
-  uint                                    offset = 0;
   uint8_t                                *buffer_p = NULL;
   uint32_t                                length = 0;
   ue_description_t                       *ue_ref = NULL;
-  enb_description_t                      *eNB_ref = NULL;
   S1ap_PagingIEs_t                       *paging_p = NULL;
+  const tai_t                            *tai_list = NULL;
+  uint8_t                                 nb_tai = 0;
+  uint32_t                                nb_paged_enbs = 0;
 
   s1ap_message                            message = {0}; // yes, alloc on stack
+  S1ap_TAIItemIEs_t                       tai_items[S1AP_PAGING_MAX_TAI]; // yes, alloc on stack
 
   OAILOG_FUNC_IN (LOG_S1AP);
   DevAssert (s1ap_paging_pP != NULL);
@@ -1592,10 +1594,13 @@ s1ap_handle_paging( const itti_s1ap_paging_t * const s1ap_paging_pP){
     OAILOG_FUNC_OUT (LOG_S1AP);
   }
 
-  /** Get the last eNB. */
-  if ((eNB_ref = s1ap_is_enb_assoc_id_in_list (s1ap_paging_pP->sctp_assoc_id_key)) == NULL) {
-    OAILOG_WARNING (LOG_S1AP, "Unknown eNB on assoc_id %d\n", s1ap_paging_pP->sctp_assoc_id_key);
-    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  /** TAI list of the UE, the last TAI if MME_APP did not give one. */
+  if (s1ap_paging_pP->nb_tai) {
+    tai_list = s1ap_paging_pP->tai_list;
+    nb_tai = (s1ap_paging_pP->nb_tai < S1AP_PAGING_MAX_TAI) ? s1ap_paging_pP->nb_tai : S1AP_PAGING_MAX_TAI;
+  } else {
+    tai_list = &s1ap_paging_pP->tai;
+    nb_tai = 1;
   }
 
   /** Just create the message and send it without creating a S1AP UE reference. */
@@ -1604,25 +1609,8 @@ s1ap_handle_paging( const itti_s1ap_paging_t * const s1ap_paging_pP){
   paging_p = &message.msg.s1ap_PagingIEs;
 
   /** Encode and set the UE Identity Index Value. */
-//  paging_p->ueIdentityIndexValue.= (unsigned long)ue_ref->mme_ue_s1ap_id; // todo: encode!
-//  INT32_TO_BIT_STRING(s1ap_paging_pP->ue_identity_index, &paging_p->ueIdentityIndexValue);
-//
-//  if (conn_est_cnf_pP->kenb) {
-//    initialContextSetupRequest_p->securityKey.buf = calloc (AUTH_KENB_SIZE, sizeof(uint8_t));
-//    memcpy (initialContextSetupRequest_p->securityKey.buf, conn_est_cnf_pP->kenb, AUTH_KENB_SIZE);
-//    initialContextSetupRequest_p->securityKey.size = AUTH_KENB_SIZE;
-//  } else {
-//    OAILOG_DEBUG (LOG_S1AP, "No kenb\n");
-//    initialContextSetupRequest_p->securityKey.buf = NULL;
-//    initialContextSetupRequest_p->securityKey.size = 0;
-//  }
-//
-//  initialContextSetupRequest_p->securityKey.bits_unused = 0;
-//
-//
   paging_p->ueIdentityIndexValue.buf = calloc (2, sizeof(uint8_t)); // (uint8_t *) &s1ap_paging_pP->ue_identity_index;
   memcpy(paging_p->ueIdentityIndexValue.buf, (uint8_t*)&(s1ap_paging_pP->ue_identity_index), 2);
-//  * paging_p->ueIdentityIndexValue.buf = *paging_p->ueIdentityIndexValue.buf<<6;
   paging_p->ueIdentityIndexValue.size = 2;
   paging_p->ueIdentityIndexValue.bits_unused = 6;
 
@@ -1635,38 +1623,49 @@ s1ap_handle_paging( const itti_s1ap_paging_t * const s1ap_paging_pP){
   // todo: chose the right gummei or get it from the request!
   INT8_TO_OCTET_STRING(mme_config.gummei.gummei[0].mme_code, &paging_p->uePagingID.choice.s_TMSI.mMEC);
 
-  /** Set the TAI-List. */
-  S1ap_TAIItemIEs_t tai_item = {0}; // yes, alloc on stack
-  INT16_TO_OCTET_STRING(s1ap_paging_pP->tai.tac, &tai_item.taiItem.tAI.tAC);
-  /** Set the PLMN. */
-  uint8_t                                 plmn[3] = { 0x00, 0x00, 0x00 };     //{ 0x02, 0xF8, 0x29 };
-  PLMN_T_TO_TBCD (s1ap_paging_pP->tai.plmn,
-                    plmn,
-                    mme_config_find_mnc_length(
-                        s1ap_paging_pP->tai.plmn.mcc_digit1, s1ap_paging_pP->tai.plmn.mcc_digit2, s1ap_paging_pP->tai.plmn.mcc_digit3,
-                        s1ap_paging_pP->tai.plmn.mnc_digit1, s1ap_paging_pP->tai.plmn.mnc_digit2, s1ap_paging_pP->tai.plmn.mnc_digit3)
-  );
-  OCTET_STRING_fromBuf(&tai_item.taiItem.tAI.pLMNidentity, plmn, 3);
-  /** Set the TAI. */
-  ASN_SEQUENCE_ADD (&paging_p->taiList, &tai_item);
+  /**
+   * Set the TAI-List: the whole TAI list of the UE, the message is encoded once and the same
+   * PDU is sent to every eNB serving one of these TAIs.
+   */
+  memset (tai_items, 0, sizeof (tai_items));
+  for (int i = 0; i < nb_tai; i++) {
+    uint8_t                                 plmn[3] = { 0x00, 0x00, 0x00 };     //{ 0x02, 0xF8, 0x29 };
+
+    INT16_TO_OCTET_STRING(tai_list[i].tac, &tai_items[i].taiItem.tAI.tAC);
+    /** Set the PLMN. */
+    PLMN_T_TO_TBCD (tai_list[i].plmn,
+                      plmn,
+                      mme_config_find_mnc_length(
+                          tai_list[i].plmn.mcc_digit1, tai_list[i].plmn.mcc_digit2, tai_list[i].plmn.mcc_digit3,
+                          tai_list[i].plmn.mnc_digit1, tai_list[i].plmn.mnc_digit2, tai_list[i].plmn.mnc_digit3)
+    );
+    OCTET_STRING_fromBuf(&tai_items[i].taiItem.tAI.pLMNidentity, (const char *)plmn, 3);
+    /** Set the TAI. */
+    ASN_SEQUENCE_ADD (&paging_p->taiList, &tai_items[i]);
+  }
 
   /** Encoding without allocating? */
   if (s1ap_mme_encode_pdu (&message, &buffer_p, &length) < 0) {
     OAILOG_ERROR (LOG_S1AP, "Failed to encode S1AP paging \n");
     // todo: in this case we will ignore this. no UE contex modification should occure
-    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+    OAILOG_FUNC_OUT (LOG_S1AP);
   }
 
-  OAILOG_NOTICE (LOG_S1AP, "Send S1AP_PAGING message MME_UE_S1AP_ID = " MME_UE_S1AP_ID_FMT " \n",
-              (mme_ue_s1ap_id_t)s1ap_paging_pP->mme_ue_s1ap_id);
+  bstring b = blk2bstr(buffer_p, length);
+  free(buffer_p);
+  nb_paged_enbs = s1ap_mme_paging_send (tai_list, nb_tai, s1ap_paging_pP->sctp_assoc_id_key, &b);
+  if (!nb_paged_enbs) {
+    OAILOG_WARNING (LOG_S1AP, "No eNB serving the %u TAIs of UE mme ue s1ap id " MME_UE_S1AP_ID_FMT " nor on assoc_id %d\n",
+        nb_tai, s1ap_paging_pP->mme_ue_s1ap_id, s1ap_paging_pP->sctp_assoc_id_key);
+    OAILOG_FUNC_OUT (LOG_S1AP);
+  }
+  OAILOG_NOTICE (LOG_S1AP, "Send S1AP_PAGING message MME_UE_S1AP_ID = " MME_UE_S1AP_ID_FMT " to %u eNBs\n",
+              (mme_ue_s1ap_id_t)s1ap_paging_pP->mme_ue_s1ap_id, nb_paged_enbs);
   MSC_LOG_TX_MESSAGE (MSC_S1AP_MME,
                       MSC_S1AP_ENB,
                       NULL, 0,
                       "0 S1AP Paging/successfullOutcome mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT,
                       (mme_ue_s1ap_id_t)s1ap_paging_pP->mme_ue_s1ap_id);
-  bstring b = blk2bstr(buffer_p, length);
-  free(buffer_p);
-  s1ap_mme_itti_send_sctp_request (&b, eNB_ref->sctp_assoc_id, eNB_ref->next_sctp_stream, s1ap_paging_pP->mme_ue_s1ap_id);
   OAILOG_FUNC_OUT (LOG_S1AP);
 }
 
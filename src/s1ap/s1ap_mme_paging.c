@@ -0,0 +1,232 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file s1ap_mme_paging.c
+  \brief Paging fan-out: the pagings of a TAI list received within the coalescing window are encoded once each
+         and sent together, in one SCTP_DATA_REQ_BATCH, to every eNB serving one of the TAIs.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "queue.h"
+
+#include "common_defs.h"
+#include "log.h"
+#include "assertions.h"
+#include "hashtable.h"
+#include "intertask_interface.h"
+#include "itti_free_defined_msg.h"
+#include "timer.h"
+#include "dynamic_memory_check.h"
+#include "s1ap_common.h"
+#include "s1ap_mme.h"
+#include "s1ap_mme_tai_index.h"
+#include "s1ap_mme_itti_messaging.h"
+#include "s1ap_mme_paging.h"
+
+/*
+ * Pagings of one TAI list within the coalescing window. The eNBs serving the TAI list are resolved
+ * when the batch goes to SCTP, that is when the window expires or when it is full, so that an eNB
+ * set up or released during the window is taken into account.
+ */
+typedef struct s1ap_paging_group_s {
+  hash_key_t                              key;
+  uint8_t                                 nb_tai;
+  hash_key_t                              tai_keys[S1AP_PAGING_MAX_TAI];      // sorted
+  uint8_t                                 nb_tai_list;
+  tai_t                                   tai_list[S1AP_PAGING_MAX_TAI];
+  uint32_t                                nb_enbs;                            // when the group was created
+  MessageDef                             *batch_p;                            // SCTP_DATA_REQ_BATCH
+  LIST_ENTRY(s1ap_paging_group_s)         entries;
+} s1ap_paging_group_t;
+
+// Only used by the S1AP task
+static LIST_HEAD(s1ap_paging_groups_s, s1ap_paging_group_s) g_s1ap_paging_groups = LIST_HEAD_INITIALIZER(g_s1ap_paging_groups);
+static hash_table_ts_t g_s1ap_paging_group_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // references s1ap_paging_group_s of g_s1ap_paging_groups, key is s1ap_paging_group_s.key;
+static long                             g_s1ap_paging_timer_id = S1AP_TIMER_INACTIVE_ID;
+
+//------------------------------------------------------------------------------
+static void s1ap_mme_paging_flush_group (s1ap_paging_group_t * group)
+{
+  sctp_data_req_batch_t                  *batch = &SCTP_DATA_REQ_BATCH (group->batch_p);
+
+  LIST_REMOVE (group, entries);
+  hashtable_ts_free (&g_s1ap_paging_group_coll, group->key);
+  batch->nb_assoc_ids = s1ap_mme_paging_resolve_enbs (group->tai_list, group->nb_tai_list, &batch->assoc_ids);
+  if (batch->nb_assoc_ids) {
+    OAILOG_DEBUG (LOG_S1AP, "Sending %u pagings to %u eNBs\n", batch->nb_payloads, batch->nb_assoc_ids);
+    itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, group->batch_p);
+  } else {
+    OAILOG_WARNING (LOG_S1AP, "No eNB serves the TAI list any more, dropping %u pagings\n", batch->nb_payloads);
+    itti_free_msg_content (group->batch_p);
+    itti_free (ITTI_MSG_ORIGIN_ID (group->batch_p), group->batch_p);
+  }
+  free_wrapper ((void**)&group);
+}
+
+//------------------------------------------------------------------------------
+// NULL if no eNB serves the TAI list
+static s1ap_paging_group_t *s1ap_mme_paging_new_group (const tai_t * const tai_list, const uint8_t nb_tai)
+{
+  s1ap_paging_group_t                    *group = NULL;
+  uint32_t                                nb_enbs = s1ap_mme_paging_resolve_enbs (tai_list, nb_tai, NULL);
+
+  if (!nb_enbs) {
+    return NULL;
+  }
+  group = calloc (1, sizeof (s1ap_paging_group_t));
+  DevAssert (group != NULL);
+  group->nb_tai_list = nb_tai;
+  memcpy (group->tai_list, tai_list, nb_tai * sizeof (tai_t));
+  group->nb_enbs = nb_enbs;
+  group->batch_p = itti_alloc_new_message (TASK_S1AP, SCTP_DATA_REQ_BATCH);
+  DevAssert (group->batch_p != NULL);
+  // non UE associated signalling
+  SCTP_DATA_REQ_BATCH (group->batch_p).stream = 0;
+  return group;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_paging_init (
+  void)
+{
+  LIST_INIT (&g_s1ap_paging_groups);
+  g_s1ap_paging_timer_id = S1AP_TIMER_INACTIVE_ID;
+  bstring bs = bfromcstr("s1ap_paging_group_coll");
+  hash_table_ts_t* h = hashtable_ts_init (&g_s1ap_paging_group_coll, S1AP_PAGING_GROUP_COLL_SIZE, NULL, hash_free_int_func, bs);
+  bdestroy_wrapper (&bs);
+  return (h) ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_paging_exit (
+  void)
+{
+  while (!LIST_EMPTY (&g_s1ap_paging_groups)) {
+    s1ap_paging_group_t                    *group = LIST_FIRST (&g_s1ap_paging_groups);
+
+    LIST_REMOVE (group, entries);
+    itti_free_msg_content (group->batch_p);
+    itti_free (ITTI_MSG_ORIGIN_ID (group->batch_p), group->batch_p);
+    free_wrapper ((void**)&group);
+  }
+  if (g_s1ap_paging_timer_id != S1AP_TIMER_INACTIVE_ID) {
+    timer_remove (g_s1ap_paging_timer_id, NULL);
+    g_s1ap_paging_timer_id = S1AP_TIMER_INACTIVE_ID;
+  }
+  hashtable_ts_destroy (&g_s1ap_paging_group_coll);
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+s1ap_mme_paging_send (
+  const tai_t * const tai_list,
+  const uint8_t nb_tai,
+  const sctp_assoc_id_t default_assoc_id,
+  STOLEN_REF bstring *payload)
+{
+  s1ap_paging_group_t                    *group = NULL;
+  hash_key_t                              tai_keys[S1AP_PAGING_MAX_TAI];
+  uint8_t                                 nb_keys = 0;
+  hash_key_t                              key = 0;
+  sctp_data_req_batch_t                  *batch = NULL;
+  uint32_t                                nb_paged_enbs = 0;
+
+  DevAssert ((payload != NULL) && (*payload != NULL));
+  DevAssert (nb_tai <= S1AP_PAGING_MAX_TAI);
+  key = s1ap_mme_paging_group_key (tai_list, nb_tai, tai_keys, &nb_keys);
+  if (HASH_TABLE_OK == hashtable_ts_get (&g_s1ap_paging_group_coll, key, (void **)&group)) {
+    if ((group->nb_tai != nb_keys) || (memcmp (group->tai_keys, tai_keys, nb_keys * sizeof (hash_key_t)))) {
+      // another TAI list with the same key
+      s1ap_mme_paging_flush_group (group);
+      group = NULL;
+    }
+  } else {
+    group = NULL;
+  }
+
+  if (!group) {
+    if (!(group = s1ap_mme_paging_new_group (tai_list, nb_tai))) {
+      enb_description_t                    *enb_ref = s1ap_is_enb_assoc_id_in_list (default_assoc_id);
+
+      if (!enb_ref) {
+        bdestroy_wrapper (payload);
+        return 0;
+      }
+      s1ap_mme_itti_send_sctp_request (payload, enb_ref->sctp_assoc_id, 0, INVALID_MME_UE_S1AP_ID);
+      return 1;
+    }
+    group->key = key;
+    group->nb_tai = nb_keys;
+    memcpy (group->tai_keys, tai_keys, nb_keys * sizeof (hash_key_t));
+    LIST_INSERT_HEAD (&g_s1ap_paging_groups, group, entries);
+    hashtable_ts_insert (&g_s1ap_paging_group_coll, key, group);
+  }
+
+  // the same encoded paging goes to every eNB of the group
+  batch = &SCTP_DATA_REQ_BATCH (group->batch_p);
+  batch->payloads[batch->nb_payloads++] = *payload;
+  *payload = NULL;
+  nb_paged_enbs = group->nb_enbs;
+
+  if ((SCTP_DATA_REQ_BATCH_MAX == batch->nb_payloads) || (!S1AP_PAGING_COALESCE_WINDOW_US)) {
+    s1ap_mme_paging_flush_group (group);
+  } else if (S1AP_TIMER_INACTIVE_ID == g_s1ap_paging_timer_id) {
+    if (timer_setup (0, S1AP_PAGING_COALESCE_WINDOW_US, TASK_S1AP, INSTANCE_DEFAULT, TIMER_ONE_SHOT, NULL, &g_s1ap_paging_timer_id) < 0) {
+      OAILOG_WARNING (LOG_S1AP, "Failed to start the paging coalescing timer, sending now\n");
+      g_s1ap_paging_timer_id = S1AP_TIMER_INACTIVE_ID;
+      s1ap_mme_paging_flush ();
+    }
+  }
+  return nb_paged_enbs;
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_paging_flush (
+  void)
+{
+  while (!LIST_EMPTY (&g_s1ap_paging_groups)) {
+    s1ap_mme_paging_flush_group (LIST_FIRST (&g_s1ap_paging_groups));
+  }
+}
+
+//------------------------------------------------------------------------------
+bool
+s1ap_mme_paging_handle_timer_expiry (
+  const long timer_id)
+{
+  if ((S1AP_TIMER_INACTIVE_ID == g_s1ap_paging_timer_id) || (timer_id != g_s1ap_paging_timer_id)) {
+    return false;
+  }
+  g_s1ap_paging_timer_id = S1AP_TIMER_INACTIVE_ID;
+  s1ap_mme_paging_flush ();
+  return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file s1ap_mme_paging.h
+  \brief Paging fan-out: the pagings of a TAI list received within the coalescing window are encoded once each
+         and sent together, in one SCTP_DATA_REQ_BATCH, to every eNB serving one of the TAIs.
+*/
+
+#ifndef FILE_S1AP_MME_PAGING_SEEN
+#define FILE_S1AP_MME_PAGING_SEEN
+
+int  s1ap_mme_paging_init(void);
+void s1ap_mme_paging_exit(void);
+
+/** \brief Queue an encoded S1AP Paging to the eNBs serving the TAI list, or send it to the eNB of
+ * default_assoc_id if none does. The eNBs are resolved again when the queued pagings are sent.
+ * @returns number of eNBs the paging is sent to, as known when it is queued
+ **/
+uint32_t s1ap_mme_paging_send(const tai_t * const tai_list, const uint8_t nb_tai, const sctp_assoc_id_t default_assoc_id,
+                              STOLEN_REF bstring *payload);
+
+/** \brief Send the pagings waiting for the coalescing window. **/
+void s1ap_mme_paging_flush(void);
+
+/** \brief Coalescing window expiry.
+ * @returns false if timer_id is not the paging timer
+ **/
+bool s1ap_mme_paging_handle_timer_expiry(const long timer_id);
+
+#endif /* FILE_S1AP_MME_PAGING_SEEN */
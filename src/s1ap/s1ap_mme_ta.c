@@ -30,15 +30,18 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <pthread.h>
 
 #include "bstrlib.h"
 
+#include "common_defs.h"
 #include "log.h"
 #include "assertions.h"
 #include "conversions.h"
 #include "mme_config.h"
 #include "s1ap_common.h"
+#include "s1ap_mme.h"
 #include "s1ap_mme_ta.h"
 
 
@@ -164,3 +167,39 @@ s1ap_mme_compare_ta_lists (
 
   return TA_LIST_RET_OK;
 }
+
+//------------------------------------------------------------------------------
+bool
+s1ap_mme_tai_index_enb_pageable (
+  const s1ap_tai_index_enb_t * const enb)
+{
+  const enb_description_t                *enb_ref = (const enb_description_t *)((const char *)enb - offsetof (enb_description_t, tai_index));
+
+  return (S1AP_READY == enb_ref->s1_state);
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_tai_index_set_enb (
+  enb_description_t * const enb_ref,
+  const S1ap_SupportedTAs_t * const ta_list)
+{
+  DevAssert (enb_ref != NULL);
+  DevAssert (ta_list != NULL);
+  s1ap_mme_tai_index_remove_enb (&enb_ref->tai_index);
+  enb_ref->tai_index.sctp_assoc_id = enb_ref->sctp_assoc_id;
+
+  for (int i = 0; i < ta_list->list.count; i++) {
+    const S1ap_SupportedTAs_Item_t         *ta = ta_list->list.array[i];
+    tai_t                                   tai = {.plmn = {0}, .tac = 0};
+
+    OCTET_STRING_TO_TAC (&ta->tAC, tai.tac);
+    for (int j = 0; j < ta->broadcastPLMNs.list.count; j++) {
+      TBCD_TO_PLMN_T (ta->broadcastPLMNs.list.array[j], &tai.plmn);
+      if (RETURNok != s1ap_mme_tai_index_add (&enb_ref->tai_index, &tai)) {
+        OAILOG_WARNING (LOG_S1AP, "eNB %u supports more than %d TAIs, TAC %u not paged through this eNB\n",
+            enb_ref->enb_id, S1AP_ENB_MAX_SUPPORTED_TAI, tai.tac);
+      }
+    }
+  }
+}
@@ -38,6 +38,19 @@ enum {
   TA_LIST_COMPLETE_MATCH = 0x3,
 };
 
+#include "hashtable.h"
+#include "s1ap_mme_tai_index.h"
+
+struct enb_description_s;
+
 int s1ap_mme_compare_ta_lists(S1ap_SupportedTAs_t *ta_list);
 
+/** \brief Enter the eNB under every TAI (TAC x broadcast PLMN) of its supported TAs (TAI index, s1ap_mme_tai_index.h),
+ * replacing the TAIs of a previous S1 Setup.
+ **/
+void s1ap_mme_tai_index_set_enb(struct enb_description_s * const enb_ref, const S1ap_SupportedTAs_t * const ta_list);
+
+/** \brief Pageable eNBs of the TAI index: those in S1AP_READY state **/
+bool s1ap_mme_tai_index_enb_pageable(const s1ap_tai_index_enb_t * const enb);
+
 #endif /* FILE_S1AP_MME_TA_SEEN */
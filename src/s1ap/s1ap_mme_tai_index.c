@@ -0,0 +1,235 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_tai_index.c
+  \brief TAI -> eNB index and paging fan-out resolution, without ASN.1 types.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+
+#include "common_defs.h"
+#include "assertions.h"
+#include "hashtable.h"
+#include "dynamic_memory_check.h"
+#include "s1ap_mme_tai_index.h"
+
+// eNBs serving a TAI
+typedef struct s1ap_tai_enbs_s {
+  uint32_t                                nb_enbs;
+  uint32_t                                size;
+  s1ap_tai_index_enb_t                  **enbs;
+} s1ap_tai_enbs_t;
+
+static hash_table_ts_t g_s1ap_tai2enbs_coll = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0}; // contains s1ap_tai_enbs_t, key is s1ap_tai_key(tai);
+static s1ap_tai_index_enb_pageable_t    g_s1ap_enb_pageable = NULL;
+static uint32_t                         g_s1ap_paging_generation = 0;
+
+//------------------------------------------------------------------------------
+static void s1ap_free_tai_enbs (void **tai_enbs)
+{
+  s1ap_tai_enbs_t                        *tai_enbs_p = (s1ap_tai_enbs_t *)*tai_enbs;
+
+  if (tai_enbs_p) {
+    free_wrapper ((void**)&tai_enbs_p->enbs);
+    free_wrapper (tai_enbs);
+  }
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_tai_index_init (
+  const s1ap_tai_index_enb_pageable_t pageable)
+{
+  g_s1ap_enb_pageable = pageable;
+  bstring bs = bfromcstr("s1ap_tai2enbs_coll");
+  hash_table_ts_t* h = hashtable_ts_init (&g_s1ap_tai2enbs_coll, S1AP_TAI_INDEX_INITIAL_SIZE, NULL, s1ap_free_tai_enbs, bs);
+  bdestroy_wrapper (&bs);
+  return (h) ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t
+s1ap_mme_tai_index_exit (
+  void)
+{
+  return hashtable_ts_destroy (&g_s1ap_tai2enbs_coll);
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_tai_index_add (
+  s1ap_tai_index_enb_t * const enb,
+  const tai_t * const tai)
+{
+  s1ap_tai_enbs_t                        *tai_enbs = NULL;
+  const hash_key_t                        key = s1ap_tai_key (tai);
+
+  for (int k = 0; k < enb->nb_supported_tai; k++) {
+    if (s1ap_tai_key (&enb->supported_tai[k]) == key) {
+      return RETURNok;
+    }
+  }
+  if (enb->nb_supported_tai == S1AP_ENB_MAX_SUPPORTED_TAI) {
+    return RETURNerror;
+  }
+  enb->supported_tai[enb->nb_supported_tai++] = *tai;
+
+  if (HASH_TABLE_OK != hashtable_ts_get (&g_s1ap_tai2enbs_coll, key, (void **)&tai_enbs)) {
+    tai_enbs = calloc (1, sizeof (s1ap_tai_enbs_t));
+    DevAssert (tai_enbs != NULL);
+    hashtable_ts_insert (&g_s1ap_tai2enbs_coll, key, tai_enbs);
+  }
+  if (tai_enbs->nb_enbs == tai_enbs->size) {
+    tai_enbs->size = (tai_enbs->size) ? tai_enbs->size << 1 : 8;
+    tai_enbs->enbs = realloc (tai_enbs->enbs, tai_enbs->size * sizeof (s1ap_tai_index_enb_t *));
+    DevAssert (tai_enbs->enbs != NULL);
+  }
+  tai_enbs->enbs[tai_enbs->nb_enbs++] = enb;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_tai_index_remove_enb (
+  s1ap_tai_index_enb_t * const enb)
+{
+  for (int i = 0; i < enb->nb_supported_tai; i++) {
+    s1ap_tai_enbs_t                        *tai_enbs = NULL;
+    const hash_key_t                        key = s1ap_tai_key (&enb->supported_tai[i]);
+
+    if (HASH_TABLE_OK != hashtable_ts_get (&g_s1ap_tai2enbs_coll, key, (void **)&tai_enbs)) {
+      continue;
+    }
+    for (uint32_t e = 0; e < tai_enbs->nb_enbs; e++) {
+      if (tai_enbs->enbs[e] == enb) {
+        tai_enbs->enbs[e] = tai_enbs->enbs[--tai_enbs->nb_enbs];
+        break;
+      }
+    }
+    if (!tai_enbs->nb_enbs) {
+      hashtable_ts_free (&g_s1ap_tai2enbs_coll, key);
+    }
+  }
+  enb->nb_supported_tai = 0;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+s1ap_mme_tai_index_get_enbs (
+  const tai_t * const tai,
+  s1ap_tai_index_enb_t *** const enbs)
+{
+  s1ap_tai_enbs_t                        *tai_enbs = NULL;
+
+  if (HASH_TABLE_OK != hashtable_ts_get (&g_s1ap_tai2enbs_coll, s1ap_tai_key (tai), (void **)&tai_enbs)) {
+    *enbs = NULL;
+    return 0;
+  }
+  *enbs = tai_enbs->enbs;
+  return tai_enbs->nb_enbs;
+}
+
+//------------------------------------------------------------------------------
+hash_key_t
+s1ap_mme_paging_group_key (
+  const tai_t * const tai_list,
+  const uint8_t nb_tai,
+  hash_key_t * const tai_keys,
+  uint8_t * const nb_keys)
+{
+  hash_key_t                              key = 0xcbf29ce484222325ULL;
+
+  *nb_keys = 0;
+  for (int t = 0; t < nb_tai; t++) {
+    const hash_key_t                        tai_key = s1ap_tai_key (&tai_list[t]);
+    int                                     k = *nb_keys;
+
+    while ((k > 0) && (tai_keys[k - 1] > tai_key)) {
+      k--;
+    }
+    if ((k > 0) && (tai_keys[k - 1] == tai_key)) {
+      continue;
+    }
+    memmove (&tai_keys[k + 1], &tai_keys[k], (*nb_keys - k) * sizeof (hash_key_t));
+    tai_keys[k] = tai_key;
+    (*nb_keys)++;
+  }
+  for (int k = 0; k < *nb_keys; k++) {
+    key = (key ^ tai_keys[k]) * 0x100000001b3ULL;
+  }
+  return key;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+s1ap_mme_paging_resolve_enbs (
+  const tai_t * const tai_list,
+  const uint8_t nb_tai,
+  sctp_assoc_id_t ** const assoc_ids)
+{
+  s1ap_tai_index_enb_t                  **enbs[nb_tai];
+  uint32_t                                nb_enbs[nb_tai];
+  uint32_t                                max_enbs = 0;
+  uint32_t                                nb_assoc_ids = 0;
+
+  if (assoc_ids) {
+    *assoc_ids = NULL;
+  }
+  for (int t = 0; t < nb_tai; t++) {
+    nb_enbs[t] = s1ap_mme_tai_index_get_enbs (&tai_list[t], &enbs[t]);
+    max_enbs += nb_enbs[t];
+  }
+  if (!max_enbs) {
+    return 0;
+  }
+  if (assoc_ids) {
+    *assoc_ids = calloc (max_enbs, sizeof (sctp_assoc_id_t));
+    DevAssert (*assoc_ids != NULL);
+  }
+
+  if (!(++g_s1ap_paging_generation)) {
+    g_s1ap_paging_generation = 1;
+  }
+  for (int t = 0; t < nb_tai; t++) {
+    for (uint32_t e = 0; e < nb_enbs[t]; e++) {
+      s1ap_tai_index_enb_t                 *enb = enbs[t][e];
+
+      if ((g_s1ap_paging_generation == enb->paging_generation) || ((g_s1ap_enb_pageable) && (!g_s1ap_enb_pageable (enb)))) {
+        continue;
+      }
+      enb->paging_generation = g_s1ap_paging_generation;
+      if (assoc_ids) {
+        (*assoc_ids)[nb_assoc_ids] = enb->sctp_assoc_id;
+      }
+      nb_assoc_ids++;
+    }
+  }
+  if ((assoc_ids) && (!nb_assoc_ids)) {
+    free_wrapper ((void**)assoc_ids);
+  }
+  return nb_assoc_ids;
+}
@@ -0,0 +1,84 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_tai_index.h
+  \brief TAI -> eNB index and the eNBs a paging of a TAI list goes to. Works on tai_t only, no ASN.1 type, so that
+         it builds without asn1c (oaisim_s1ap_paging_benchmark links it).
+*/
+
+#ifndef FILE_S1AP_MME_TAI_INDEX_SEEN
+#define FILE_S1AP_MME_TAI_INDEX_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "bstrlib.h"
+#include "common_types.h"
+#include "hashtable.h"
+#include "mme_default_values.h"
+
+/** \brief Paging part of an eNB (enb_description_t.tai_index), entry of the TAI index **/
+typedef struct s1ap_tai_index_enb_s {
+  sctp_assoc_id_t  sctp_assoc_id;                                 ///< Association of the eNB
+  uint8_t          nb_supported_tai;                              ///< Entries of supported_tai
+  tai_t            supported_tai[S1AP_ENB_MAX_SUPPORTED_TAI];     ///< TAIs of the S1 Setup supported TAs, keys of this eNB in the TAI index
+  uint32_t         paging_generation;                             ///< Last paging fan-out including this eNB, to count it once per TAI list
+} s1ap_tai_index_enb_t;
+
+/** \brief true if the eNB can be paged (S1 Setup done) **/
+typedef bool (*s1ap_tai_index_enb_pageable_t) (const s1ap_tai_index_enb_t * const enb);
+
+/** \brief Key of a TAI in the TAI indexes: MCC MNC digits (mnc_digit3 is 0xF for 2 digits MNCs) and TAC, packed **/
+static inline hash_key_t s1ap_tai_key(const tai_t * const tai)
+{
+  return ((hash_key_t)tai->plmn.mcc_digit1) | ((hash_key_t)tai->plmn.mcc_digit2 << 4) | ((hash_key_t)tai->plmn.mcc_digit3 << 8) |
+         ((hash_key_t)tai->plmn.mnc_digit1 << 12) | ((hash_key_t)tai->plmn.mnc_digit2 << 16) | ((hash_key_t)tai->plmn.mnc_digit3 << 20) |
+         ((hash_key_t)tai->tac << 24);
+}
+
+/** \brief TAI -> eNB index, maintained from the supported TAs of the S1 Setup Requests.
+ * Only used from the S1AP task.
+ **/
+int  s1ap_mme_tai_index_init(const s1ap_tai_index_enb_pageable_t pageable);
+hashtable_rc_t s1ap_mme_tai_index_exit(void);
+
+/** \brief Enter the eNB under the TAI, nothing done if it is already.
+ * @returns RETURNerror if the eNB has S1AP_ENB_MAX_SUPPORTED_TAI TAIs already
+ **/
+int  s1ap_mme_tai_index_add(s1ap_tai_index_enb_t * const enb, const tai_t * const tai);
+void s1ap_mme_tai_index_remove_enb(s1ap_tai_index_enb_t * const enb);
+
+/** \brief eNBs serving a TAI.
+ * @returns number of eNBs, *enbs is valid until the next change of the index
+ **/
+uint32_t s1ap_mme_tai_index_get_enbs(const tai_t * const tai, s1ap_tai_index_enb_t *** const enbs);
+
+/** \brief Key of the pagings of a TAI list, whatever the order or the duplicates of the TAIs.
+ * tai_keys (nb_tai entries) gets the sorted keys of the TAIs without duplicates, *nb_keys their number.
+ **/
+hash_key_t s1ap_mme_paging_group_key(const tai_t * const tai_list, const uint8_t nb_tai, hash_key_t * const tai_keys, uint8_t * const nb_keys);
+
+/** \brief Number of pageable eNBs serving one of the TAIs, an eNB serving several TAIs of the list is counted once.
+ * Their associations are returned in *assoc_ids (allocated, NULL if none) if assoc_ids is not NULL.
+ **/
+uint32_t s1ap_mme_paging_resolve_enbs(const tai_t * const tai_list, const uint8_t nb_tai, sctp_assoc_id_t ** const assoc_ids);
+
+#endif /* FILE_S1AP_MME_TAI_INDEX_SEEN */
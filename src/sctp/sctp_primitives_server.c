@@ -53,251 +53,30 @@
 #include "conversions.h"
 #include "sctp_common.h"
 #include "sctp_itti_messaging.h"
+#include "sctp_reactor.h"
 
 
-#define SCTP_RC_ERROR       -1
-#define SCTP_RC_NORMAL_READ  0
-#define SCTP_RC_DISCONNECT   1
-
-typedef struct sctp_association_s {
-  struct sctp_association_s              *next_assoc;   ///< Next association in the list
-  struct sctp_association_s              *previous_assoc;       ///< Previous association in the list
-  int                                     sd;   ///< Socket descriptor
-  uint32_t                                ppid; ///< Payload protocol Identifier
-  uint16_t                                instreams;    ///< Number of input streams negociated for this connection
-  uint16_t                                outstreams;   ///< Number of output strams negotiated for this connection
-  sctp_assoc_id_t                         assoc_id;     ///< SCTP association id for the connection
-  uint32_t                                messages_recv;        ///< Number of messages received on this connection
-  uint32_t                                messages_sent;        ///< Number of messages sent on this connection
-
-  struct sockaddr                        *peer_addresses;       ///< A list of peer addresses
-  int                                     nb_peer_addresses;
-} sctp_association_t;
-
 typedef struct sctp_descriptor_s {
-  // List of connected peers
-  struct sctp_association_s              *available_connections_head;
-  struct sctp_association_s              *available_connections_tail;
-
-  uint32_t                                number_of_connections;
   uint16_t                                nb_instreams;
   uint16_t                                nb_outstreams;
+  uint16_t                                nb_workers;
 } sctp_descriptor_t;
 
-typedef struct sctp_arg_s {
-  int                                     sd;
-  uint32_t                                ppid;
-} sctp_arg_t;
-
 static struct sctp_descriptor_s         sctp_desc;
 
-// Thread used to handle sctp messages
-static pthread_t                        assoc_thread;
-
-// LOCAL FUNCTIONS prototypes
-void                                   *sctp_receiver_thread (void *args_p);
-static int sctp_send_msg (
-    sctp_assoc_id_t sctp_assoc_id,
-    uint16_t stream,
-    STOLEN_REF bstring *payload);
-
-// Association list related local functions prototypes
-static struct sctp_association_s       *sctp_is_assoc_in_list (sctp_assoc_id_t assoc_id);
-static struct sctp_association_s       *sctp_add_new_peer (void);
-static int                              sctp_handle_com_down (sctp_assoc_id_t assoc_id);
-static void                             sctp_dump_list (void);
-static void sctp_exit (void);
-
-//------------------------------------------------------------------------------
-static struct sctp_association_s *sctp_add_new_peer (void)
-{
-  struct sctp_association_s              *new_sctp_descriptor = calloc (1, sizeof (struct sctp_association_s));
-
-  if (new_sctp_descriptor == NULL) {
-    OAILOG_ERROR (LOG_SCTP, "Failed to allocate memory for new peer (%s:%d)\n", __FILE__, __LINE__);
-    return NULL;
-  }
-
-  new_sctp_descriptor->next_assoc = NULL;
-  new_sctp_descriptor->previous_assoc = NULL;
+static const sctp_reactor_callbacks_t   sctp_itti_callbacks = {
+  .new_association = sctp_itti_send_new_association,
+  .new_message_ind = sctp_itti_send_new_message_ind,
+  .com_down_ind    = sctp_itti_send_com_down_ind,
+};
 
-  if (sctp_desc.available_connections_tail == NULL) {
-    sctp_desc.available_connections_head = new_sctp_descriptor;
-    sctp_desc.available_connections_tail = sctp_desc.available_connections_head;
-  } else {
-    new_sctp_descriptor->previous_assoc = sctp_desc.available_connections_tail;
-    sctp_desc.available_connections_tail->next_assoc = new_sctp_descriptor;
-    sctp_desc.available_connections_tail = new_sctp_descriptor;
-  }
-
-  sctp_desc.number_of_connections++;
-  sctp_dump_list ();
-  return new_sctp_descriptor;
-}
-
-//------------------------------------------------------------------------------
-static struct sctp_association_s *sctp_is_assoc_in_list (sctp_assoc_id_t assoc_id)
-{
-  struct sctp_association_s              *assoc_desc = NULL;
-
-  if (assoc_id < 0) {
-    return NULL;
-  }
-
-  for (assoc_desc = sctp_desc.available_connections_head; assoc_desc; assoc_desc = assoc_desc->next_assoc) {
-    if (assoc_desc->assoc_id == assoc_id) {
-      break;
-    }
-  }
-
-  return assoc_desc;
-}
-
-//------------------------------------------------------------------------------
-static int sctp_remove_assoc_from_list (sctp_assoc_id_t assoc_id)
-{
-  struct sctp_association_s              *assoc_desc = NULL;
-
-  /*
-   * Association not in the list
-   */
-  if ((assoc_desc = sctp_is_assoc_in_list (assoc_id)) == NULL) {
-    return -1;
-  }
-
-  if (assoc_desc->next_assoc == NULL) {
-    if (assoc_desc->previous_assoc == NULL) {
-      /*
-       * Head and tail
-       */
-      sctp_desc.available_connections_head = sctp_desc.available_connections_tail = NULL;
-    } else {
-      /*
-       * Not head but tail
-       */
-      sctp_desc.available_connections_tail = assoc_desc->previous_assoc;
-      assoc_desc->previous_assoc->next_assoc = NULL;
-    }
-  } else {
-    if (assoc_desc->previous_assoc == NULL) {
-      /*
-       * Head but not tail
-       */
-      sctp_desc.available_connections_head = assoc_desc->next_assoc;
-      assoc_desc->next_assoc->previous_assoc = NULL;
-    } else {
-      /*
-       * Not head and not tail
-       */
-      assoc_desc->previous_assoc->next_assoc = assoc_desc->next_assoc;
-      assoc_desc->next_assoc->previous_assoc = assoc_desc->previous_assoc;
-    }
-  }
-
-  if (assoc_desc->peer_addresses) {
-    int rv = sctp_freepaddrs(assoc_desc->peer_addresses);
-    if (rv) OAILOG_DEBUG (LOG_SCTP, "sctp_freepaddrs(%p) failed\n", assoc_desc->peer_addresses);
-  }
-  free_wrapper ((void**)&assoc_desc);
-  sctp_desc.number_of_connections--;
-  return 0;
-}
-
-//------------------------------------------------------------------------------
-static void sctp_dump_assoc (struct sctp_association_s *sctp_assoc_p)
-{
-#if SCTP_DUMP_LIST
-  int                                     i;
-
-  if (sctp_assoc_p == NULL) {
-    return;
-  }
-
-  OAILOG_DEBUG (LOG_SCTP, "sd           : %d\n", sctp_assoc_p->sd);
-  OAILOG_DEBUG (LOG_SCTP, "input streams: %d\n", sctp_assoc_p->instreams);
-  OAILOG_DEBUG (LOG_SCTP, "out streams  : %d\n", sctp_assoc_p->outstreams);
-  OAILOG_DEBUG (LOG_SCTP, "assoc_id     : %d\n", sctp_assoc_p->assoc_id);
-  OAILOG_DEBUG (LOG_SCTP, "peer address :\n");
-
-  for (i = 0; i < sctp_assoc_p->nb_peer_addresses; i++) {
-    char                                    address[40];
-
-    memset (address, 0, sizeof (address));
-
-    if (inet_ntop (sctp_assoc_p->peer_addresses[i].sa_family, sctp_assoc_p->peer_addresses[i].sa_data, address, sizeof (address)) != NULL) {
-      OAILOG_DEBUG (LOG_SCTP, "    - [%s]\n", address);
-    }
-  }
-
-#else
-  sctp_assoc_p = sctp_assoc_p;
-#endif
-}
-
-//------------------------------------------------------------------------------
-static void sctp_dump_list (void)
-{
-#if SCTP_DUMP_LIST
-  struct sctp_association_s              *sctp_assoc_p = sctp_desc.available_connections_head;
-  OAILOG_DEBUG (LOG_SCTP, "SCTP list contains %d associations\n", sctp_desc.number_of_connections);
-
-  while (sctp_assoc_p != NULL) {
-    sctp_dump_assoc (sctp_assoc_p);
-    sctp_assoc_p = sctp_assoc_p->next_assoc;
-  }
-
-#else
-  sctp_dump_assoc (NULL);
-#endif
-}
-
-//------------------------------------------------------------------------------
-static int sctp_send_msg (
-    sctp_assoc_id_t sctp_assoc_id,
-    uint16_t stream,
-    STOLEN_REF bstring *payload)
-{
-  struct sctp_association_s              *assoc_desc = NULL;
-
-  DevAssert (*payload);
-
-  if ((assoc_desc = sctp_is_assoc_in_list (sctp_assoc_id)) == NULL) {
-    OAILOG_DEBUG (LOG_SCTP, "This assoc id has not been fount in list (%d)\n", sctp_assoc_id);
-    return -1;
-  }
-
-  if (assoc_desc->sd == -1) {
-    /*
-     * The socket is invalid may be closed.
-     */
-    OAILOG_DEBUG (LOG_SCTP, "The socket is invalid may be closed (assoc id %d)\n", sctp_assoc_id);
-    return -1;
-  }
-
-  OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
-      assoc_desc->sd, sctp_assoc_id, bdata(*payload), blength(*payload), stream, assoc_desc->ppid);
-
-  /*
-   * Send message_p on specified stream of the sd association
-   */
-  if (sctp_sendmsg (assoc_desc->sd, (const void *)bdata(*payload), blength(*payload), NULL, 0, htonl(assoc_desc->ppid), 0, stream, 0, 0) < 0) {
-    *payload = NULL;
-    OAILOG_ERROR (LOG_SCTP, "send: %s:%d", strerror (errno), errno);
-    return -1;
-  }
-  OAILOG_DEBUG (LOG_SCTP, "Successfully sent %d bytes on stream %d\n", blength(*payload), stream);
-  *payload = NULL;
-
-  assoc_desc->messages_sent++;
-  return 0;
-}
+static void sctp_exit (void);
 
 //------------------------------------------------------------------------------
 static int sctp_create_new_listener (SctpInit * init_p)
 {
   struct sctp_event_subscribe             event = {0};
   struct sockaddr                        *addr = NULL;
-  struct sctp_arg_s                      *sctp_arg_p = NULL;
   uint16_t                                i = 0,
                                           j = 0;
   int                                     sd = 0;
@@ -374,21 +153,13 @@ static int sctp_create_new_listener (SctpInit * init_p)
     return -1;
   }
 
-  if (listen (sd, 5) < 0) {
+  if (listen (sd, SCTP_LISTEN_BACKLOG) < 0) {
     OAILOG_ERROR (LOG_SCTP, "listen: %s:%d\n", strerror (errno), errno);
     return -1;
   }
 
-  if ((sctp_arg_p = malloc (sizeof (struct sctp_arg_s))) == NULL) {
-    return -1;
-  }
-
-  sctp_arg_p->sd = sd;
-  sctp_arg_p->ppid = init_p->ppid;
-
-  if (pthread_create (&assoc_thread, NULL, &sctp_receiver_thread, (void *)sctp_arg_p) < 0) {
-    OAILOG_ERROR (LOG_SCTP, "pthread_create: %s:%d\n", strerror (errno), errno);
-    return -1;
+  if (sctp_reactor_add_listener (sd, init_p->ppid) < 0) {
+    goto err;
   }
 
   return sd;
@@ -402,227 +173,6 @@ err:
   return -1;
 }
 
-//------------------------------------------------------------------------------
-static inline int sctp_read_from_socket (int sd, int ppid)
-{
-  int                                     flags = 0,
-    n;
-  socklen_t                               from_len = 0;
-  struct sctp_sndrcvinfo                  sinfo = {0};
-  struct sockaddr_in6                     addr = {0};
-  uint8_t                                 buffer[SCTP_RECV_BUFFER_SIZE];
-
-  if (sd < 0) {
-    return -1;
-  }
-
-  memset ((void *)&addr, 0, sizeof (struct sockaddr_in6));
-  from_len = (socklen_t) sizeof (struct sockaddr_in6);
-  memset ((void *)&sinfo, 0, sizeof (struct sctp_sndrcvinfo));
-  n = sctp_recvmsg (sd, (void *)buffer, SCTP_RECV_BUFFER_SIZE, (struct sockaddr *)&addr, &from_len, &sinfo, &flags);
-
-  if (n < 0) {
-    OAILOG_DEBUG (LOG_SCTP, "An error occured during read\n");
-    OAILOG_ERROR (LOG_SCTP, "sctp_recvmsg: %s:%d\n", strerror (errno), errno);
-    return SCTP_RC_ERROR;
-  }
-
-  if (flags & MSG_NOTIFICATION) {
-    union sctp_notification                *snp = (union sctp_notification *)buffer;
-
-    /*
-     * Client deconnection
-     */
-    if (SCTP_SHUTDOWN_EVENT == snp->sn_header.sn_type) {
-      OAILOG_DEBUG (LOG_SCTP, "SCTP_SHUTDOWN_EVENT received\n");
-      return sctp_handle_com_down (snp->sn_shutdown_event.sse_assoc_id);
-    }
-    /*
-     * Association has changed.
-     */
-    else if (SCTP_ASSOC_CHANGE == snp->sn_header.sn_type) {
-      struct sctp_assoc_change               *sctp_assoc_changed;
-
-      sctp_assoc_changed = &snp->sn_assoc_change;
-      OAILOG_DEBUG (LOG_SCTP, "Client association changed: %d\n", sctp_assoc_changed->sac_state);
-
-      /*
-       * New physical association requested by a peer
-       */
-      switch (sctp_assoc_changed->sac_state) {
-      case SCTP_COMM_UP:{
-          struct sctp_association_s              *new_association = NULL;
-
-          sctp_get_sockinfo (sd, NULL, NULL, NULL);
-          OAILOG_DEBUG (LOG_SCTP, "New connection\n");
-
-          if ((new_association = sctp_add_new_peer ()) == NULL) {
-            // TODO: handle this case
-            DevMessage ("Unexpected error...\n");
-            return SCTP_RC_ERROR;
-          } else {
-            new_association->sd = sd;
-            new_association->ppid = ppid;
-            new_association->instreams = sctp_assoc_changed->sac_inbound_streams;
-            new_association->outstreams = sctp_assoc_changed->sac_outbound_streams;
-            new_association->assoc_id = sctp_assoc_changed->sac_assoc_id;
-            sctp_get_localaddresses (sd, NULL, NULL);
-            sctp_get_peeraddresses (sd, &new_association->peer_addresses, &new_association->nb_peer_addresses);
-
-            if (sctp_itti_send_new_association (new_association->assoc_id, new_association->instreams, new_association->outstreams) < 0) {
-              OAILOG_ERROR (LOG_SCTP, "Failed to send message to S1AP\n");
-              return SCTP_RC_ERROR;
-            }
-          }
-        }
-        break;
-
-      default:
-        break;
-      }
-    }
-  } else {
-    /*
-     * Data payload received
-     */
-    struct sctp_association_s              *association;
-
-    if ((association = sctp_is_assoc_in_list (sinfo.sinfo_assoc_id)) == NULL) {
-      // TODO: handle this case
-      return SCTP_RC_ERROR;
-    }
-
-    association->messages_recv++;
-
-    if (ntohl (sinfo.sinfo_ppid) != association->ppid) {
-      /*
-       * Mismatch in Payload Protocol Identifier,
-       * * * * may be we received unsollicited traffic from stack other than S1AP.
-       */
-      OAILOG_ERROR (LOG_SCTP, "Received data from peer with unsollicited PPID %d, expecting %d\n", ntohl (sinfo.sinfo_ppid), association->ppid);
-      return SCTP_RC_ERROR;
-    }
-
-    OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Msg of length %d received from port %u, on stream %d, PPID %d\n", sinfo.sinfo_assoc_id, sd, n, ntohs (addr.sin6_port), sinfo.sinfo_stream, ntohl (sinfo.sinfo_ppid));
-    bstring payload = blk2bstr(buffer, n);
-    sctp_itti_send_new_message_ind (&payload, sinfo.sinfo_assoc_id, sinfo.sinfo_stream, association->instreams, association->outstreams);
-  }
-
-  return SCTP_RC_NORMAL_READ;
-}
-
-//------------------------------------------------------------------------------
-static int sctp_handle_com_down (sctp_assoc_id_t assoc_id)
-{
-  OAILOG_DEBUG (LOG_SCTP, "Sending close connection for assoc_id %u\n", assoc_id);
-
-  if (sctp_itti_send_com_down_ind (assoc_id) < 0) {
-    OAILOG_ERROR (LOG_SCTP, "Failed to send message to TASK_S1AP\n");
-  }
-
-  if (sctp_remove_assoc_from_list (assoc_id) < 0) {
-    OAILOG_ERROR (LOG_SCTP, "Failed to find client in list\n");
-  }
-
-  return SCTP_RC_DISCONNECT;
-}
-
-//------------------------------------------------------------------------------
-void *sctp_receiver_thread (void *args_p)
-{
-  struct sctp_arg_s                      *sctp_arg_p = NULL;
-
-  /*
-   * maximum file descriptor number
-   */
-  int                                     fdmax,
-                                          clientsock,
-                                          i;
-
-  /*
-   * master file descriptor list
-   */
-  fd_set                                  master;
-
-  /*
-   * temp file descriptor list for select()
-   */
-  fd_set                                  read_fds;
-
-  if ((sctp_arg_p = (struct sctp_arg_s *)args_p) == NULL) {
-    pthread_exit (NULL);
-  }
-
-  /*
-   * clear the master and temp sets
-   */
-  FD_ZERO (&master);
-  FD_ZERO (&read_fds);
-  FD_SET (sctp_arg_p->sd, &master);
-  fdmax = sctp_arg_p->sd;       /* so far, it's this one */
-
-  while (1) {
-    memcpy (&read_fds, &master, sizeof (master));
-
-    if (select (fdmax + 1, &read_fds, NULL, NULL, NULL) == -1) {
-      OAILOG_ERROR (LOG_SCTP, "[%d] Select() error: %s", sctp_arg_p->sd, strerror (errno));
-      free_wrapper ((void**)&args_p);
-      pthread_exit (NULL);
-    }
-
-    for (i = 0; i <= fdmax; i++) {
-      if (FD_ISSET (i, &read_fds)) {
-        if (i == sctp_arg_p->sd) {
-          /*
-           * There is data to read on listener socket. This means we have to accept
-           * * * * the connection.
-           */
-          if ((clientsock = accept (sctp_arg_p->sd, NULL, NULL)) < 0) {
-            OAILOG_ERROR (LOG_SCTP, "[%d] accept: %s:%d\n", sctp_arg_p->sd, strerror (errno), errno);
-            free_wrapper ((void**)&args_p);
-            pthread_exit (NULL);
-          } else {
-            FD_SET (clientsock, &master);       /* add to master set */
-
-            if (clientsock > fdmax) {
-              /*
-               * keep track of the maximum
-               */
-              fdmax = clientsock;
-            }
-          }
-        } else {
-          int                                     ret;
-
-          /*
-           * Read from socket
-           */
-          ret = sctp_read_from_socket (i, sctp_arg_p->ppid);
-
-          /*
-           * When the socket is disconnected we have to update
-           * * * * the fd_set.
-           */
-          if (ret == SCTP_RC_DISCONNECT) {
-            /*
-             * Remove the socket from the FD set and update the max sd
-             */
-            FD_CLR (i, &master);
-
-            if (i == fdmax) {
-              while (FD_ISSET (fdmax, &master) == false)
-                fdmax -= 1;
-            }
-          }
-        }
-      }
-    }
-  }
-
-  free_wrapper ((void**)&args_p);
-  return NULL;
-}
-
 //------------------------------------------------------------------------------
 static void * sctp_intertask_interface (void *args_p)
 {
@@ -639,7 +189,7 @@ static void * sctp_intertask_interface (void *args_p)
       break;
 
     case SCTP_DATA_REQ:{
-        if (sctp_send_msg (SCTP_DATA_REQ (received_message_p).assoc_id,
+        if (sctp_reactor_send (SCTP_DATA_REQ (received_message_p).assoc_id,
             SCTP_DATA_REQ (received_message_p).stream,
             &SCTP_DATA_REQ (received_message_p).payload) < 0) {
 
@@ -660,6 +210,20 @@ static void * sctp_intertask_interface (void *args_p)
       }
       break;
 
+    case SCTP_DATA_REQ_BATCH:{
+        // non UE associated signalling, no lower layer confirm expected, payloads freed with the message
+        for (uint32_t a = 0; a < SCTP_DATA_REQ_BATCH (received_message_p).nb_assoc_ids; a++) {
+          for (int i = 0; i < SCTP_DATA_REQ_BATCH (received_message_p).nb_payloads; i++) {
+            if (sctp_reactor_send_shared (SCTP_DATA_REQ_BATCH (received_message_p).assoc_ids[a],
+                SCTP_DATA_REQ_BATCH (received_message_p).stream,
+                SCTP_DATA_REQ_BATCH (received_message_p).payloads[i]) < 0) {
+              break;
+            }
+          }
+        }
+      }
+      break;
+
     case SCTP_INIT_MSG:{
         OAILOG_DEBUG (LOG_SCTP, "Received SCTP_INIT_MSG\n");
 
@@ -712,6 +276,13 @@ int sctp_init (const mme_config_t * mme_config_p)
    */
   sctp_desc.nb_instreams = mme_config_p->sctp_config.in_streams;
   sctp_desc.nb_outstreams = mme_config_p->sctp_config.out_streams;
+  sctp_desc.nb_workers = mme_config_p->sctp_config.nb_workers;
+
+  if (sctp_reactor_init (sctp_desc.nb_workers, &sctp_itti_callbacks) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "SCTP reactor start failed");
+    OAILOG_DEBUG (LOG_SCTP, "Initializing SCTP task interface: FAILED\n");
+    return -1;
+  }
 
   if (itti_create_task (TASK_SCTP, &sctp_intertask_interface, NULL) < 0) {
     OAILOG_ERROR (LOG_SCTP, "create task failed");
@@ -726,21 +297,6 @@ int sctp_init (const mme_config_t * mme_config_p)
 //------------------------------------------------------------------------------
 static void sctp_exit (void)
 {
-
-  int rv = pthread_cancel(assoc_thread);
-  if (rv) OAILOG_DEBUG (LOG_SCTP, "pthread_cancel(%08lX) failed: %d:%s\n", assoc_thread, rv, strerror(rv));
-
-  struct sctp_association_s              *sctp_assoc_p = sctp_desc.available_connections_head;
-  struct sctp_association_s              *next_sctp_assoc_p = sctp_desc.available_connections_head;
-
-  while (next_sctp_assoc_p) {
-    next_sctp_assoc_p = sctp_assoc_p->next_assoc;
-    if (sctp_assoc_p->peer_addresses) {
-      rv = sctp_freepaddrs(sctp_assoc_p->peer_addresses);
-      if (rv) OAILOG_DEBUG (LOG_SCTP, "sctp_freepaddrs(%p) failed\n", sctp_assoc_p->peer_addresses);
-    }
-    free_wrapper ((void**)&sctp_assoc_p);
-    sctp_desc.number_of_connections--;
-  }
+  sctp_reactor_exit ();
   OAI_FPRINTF_INFO("TASK_SCTP terminated\n");
 }
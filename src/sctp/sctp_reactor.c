@@ -0,0 +1,648 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sctp_reactor.c
+ *  \brief epoll based reactor serving all SCTP associations of the listeners.
+ *  @ingroup _sctp
+ */
+
+#define _GNU_SOURCE             // required for recvmmsg(), accept4(), pthread_setname_np()
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/sctp.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+
+#include "dynamic_memory_check.h"
+#include "common_defs.h"
+#include "assertions.h"
+#include "log.h"
+#include "hashtable.h"
+#include "sctp_common.h"
+#include "mme_default_values.h"
+#include "sctp_reactor.h"
+
+#define SCTP_RC_ERROR       -1
+#define SCTP_RC_NORMAL_READ  0
+#define SCTP_RC_DISCONNECT   1
+
+// Batches read on a readable socket before serving the other ready sockets
+#define SCTP_RECV_MAX_BATCHES_PER_EVENT  4
+
+struct sctp_worker_s;
+
+typedef struct sctp_association_s {
+  int                                     sd;   ///< Socket descriptor
+  uint32_t                                ppid; ///< Payload protocol Identifier
+  uint16_t                                instreams;    ///< Number of input streams negociated for this connection
+  uint16_t                                outstreams;   ///< Number of output strams negotiated for this connection
+  sctp_assoc_id_t                         assoc_id;     ///< SCTP association id for the connection
+  bool                                    is_listener;
+  bool                                    is_up;        ///< COMM_UP received, upper layer knows the association
+  uint32_t                                refcount;     ///< Owner (table) + senders in progress, socket closed on last release
+  uint32_t                                messages_recv;        ///< Number of messages received on this connection
+  uint32_t                                messages_sent;        ///< Number of messages sent on this connection
+
+  struct sockaddr                        *peer_addresses;       ///< A list of peer addresses
+  int                                     nb_peer_addresses;
+  struct sctp_worker_s                   *worker;       ///< Worker serving this socket
+  struct sctp_association_s              *next_listener;
+} sctp_association_t;
+
+typedef struct sctp_worker_s {
+  int                                     index;
+  int                                     epoll_fd;
+  int                                     event_fd;     ///< Written to stop the worker
+  pthread_t                               thread;
+  uint64_t                                messages_recv;
+  uint64_t                                recv_calls;
+  // recvmmsg() vectors, reused for every socket served by this worker
+  struct mmsghdr                          msgs[SCTP_RECV_BATCH];
+  struct iovec                            iovs[SCTP_RECV_BATCH];
+  uint8_t                                 cmsgs[SCTP_RECV_BATCH][CMSG_SPACE (sizeof (struct sctp_sndrcvinfo))];
+  uint8_t                                 buffers[SCTP_RECV_BATCH][SCTP_RECV_BUFFER_SIZE];
+} sctp_worker_t;
+
+typedef struct sctp_reactor_s {
+  int                                     nb_workers;
+  sctp_worker_t                          *workers;
+  sctp_reactor_callbacks_t                callbacks;
+  // assoc_id -> association; lookup + reference taken under read lock, removal under write lock
+  hash_table_ts_t                        *associations;
+  pthread_rwlock_t                        rw_lock;
+  pthread_mutex_t                         listeners_mutex;
+  sctp_association_t                     *listeners;
+  bool                                    use_recvmmsg;
+  uint32_t                                number_of_associations;
+  uint64_t                                messages_sent;
+  uint64_t                                accepted;
+  uint64_t                                closed;
+} sctp_reactor_t;
+
+static sctp_reactor_t                   sctp_reactor = {0};
+
+//------------------------------------------------------------------------------
+static void sctp_reactor_release_association (sctp_association_t * association)
+{
+  if (__atomic_sub_fetch (&association->refcount, 1, __ATOMIC_ACQ_REL)) {
+    return;
+  }
+
+  if (association->peer_addresses) {
+    int rv = sctp_freepaddrs (association->peer_addresses);
+    if (rv) OAILOG_DEBUG (LOG_SCTP, "sctp_freepaddrs(%p) failed\n", association->peer_addresses);
+  }
+  close (association->sd);
+  free_wrapper ((void**)&association);
+}
+
+//------------------------------------------------------------------------------
+// Table destructor, only used on exit when no sender is left.
+static void sctp_reactor_free_association (void **association)
+{
+  if ((association) && (*association)) {
+    sctp_reactor_release_association ((sctp_association_t *)*association);
+    *association = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void sctp_reactor_com_down (sctp_association_t * association)
+{
+  sctp_association_t                     *removed = NULL;
+
+  OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Association closed\n", association->assoc_id, association->sd);
+
+  if (__atomic_exchange_n (&association->is_up, false, __ATOMIC_ACQ_REL)) {
+    if (sctp_reactor.callbacks.com_down_ind (association->assoc_id) < 0) {
+      OAILOG_ERROR (LOG_SCTP, "Failed to notify com down of assoc_id %u\n", association->assoc_id);
+    }
+  }
+
+  pthread_rwlock_wrlock (&sctp_reactor.rw_lock);
+  if (HASH_TABLE_OK != hashtable_ts_remove (sctp_reactor.associations, (hash_key_t)association->assoc_id, (void **)&removed)) {
+    OAILOG_ERROR (LOG_SCTP, "Failed to find assoc_id %u in association table\n", association->assoc_id);
+  }
+  pthread_rwlock_unlock (&sctp_reactor.rw_lock);
+
+  if (epoll_ctl (association->worker->epoll_fd, EPOLL_CTL_DEL, association->sd, NULL) < 0) {
+    OAILOG_DEBUG (LOG_SCTP, "[%d] epoll_ctl(DEL): %s:%d\n", association->sd, strerror (errno), errno);
+  }
+  __atomic_sub_fetch (&sctp_reactor.number_of_associations, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch (&sctp_reactor.closed, 1, __ATOMIC_RELAXED);
+  sctp_reactor_release_association (association);
+}
+
+//------------------------------------------------------------------------------
+static void sctp_reactor_accept (sctp_association_t * const listener)
+{
+  while (true) {
+    sctp_association_t                     *association = NULL;
+    sctp_assoc_id_t                         assoc_id = 0;
+    struct epoll_event                      event = {0};
+    // the accepted socket stays blocking for sctp_sendmsg(), reads never block (MSG_DONTWAIT)
+    int                                     sd = accept4 (listener->sd, NULL, NULL, SOCK_CLOEXEC);
+
+    if (sd < 0) {
+      if ((EINTR == errno) || (ECONNABORTED == errno)) {
+        continue;
+      }
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) {
+        OAILOG_ERROR (LOG_SCTP, "[%d] accept: %s:%d\n", listener->sd, strerror (errno), errno);
+      }
+      return;
+    }
+
+    if (sctp_get_sockinfo (sd, NULL, NULL, &assoc_id) < 0) {
+      close (sd);
+      continue;
+    }
+
+    association = calloc (1, sizeof (sctp_association_t));
+    if (association == NULL) {
+      OAILOG_ERROR (LOG_SCTP, "Failed to allocate memory for new peer (%s:%d)\n", __FILE__, __LINE__);
+      close (sd);
+      continue;
+    }
+    association->sd = sd;
+    association->ppid = listener->ppid;
+    association->assoc_id = assoc_id;
+    association->refcount = 1;
+    association->worker = &sctp_reactor.workers[assoc_id % sctp_reactor.nb_workers];
+
+    if (HASH_TABLE_OK != hashtable_ts_insert (sctp_reactor.associations, (hash_key_t)assoc_id, association)) {
+      OAILOG_ERROR (LOG_SCTP, "[%d] assoc_id %u already in association table\n", sd, assoc_id);
+      sctp_reactor_release_association (association);
+      continue;
+    }
+    __atomic_add_fetch (&sctp_reactor.number_of_associations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch (&sctp_reactor.accepted, 1, __ATOMIC_RELAXED);
+
+    event.events = EPOLLIN;
+    event.data.ptr = association;
+    if (epoll_ctl (association->worker->epoll_fd, EPOLL_CTL_ADD, sd, &event) < 0) {
+      OAILOG_ERROR (LOG_SCTP, "[%d] epoll_ctl(ADD): %s:%d\n", sd, strerror (errno), errno);
+      sctp_reactor_com_down (association);
+      continue;
+    }
+    OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Accepted association served by worker %d\n", assoc_id, sd, association->worker->index);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int sctp_reactor_handle_notification (sctp_association_t * const association, const uint8_t * const buffer, const int length)
+{
+  const union sctp_notification          *snp = (const union sctp_notification *)buffer;
+
+  if (length < (int)sizeof (snp->sn_header)) {
+    return SCTP_RC_NORMAL_READ;
+  }
+
+  /*
+   * Client deconnection
+   */
+  if (SCTP_SHUTDOWN_EVENT == snp->sn_header.sn_type) {
+    OAILOG_DEBUG (LOG_SCTP, "SCTP_SHUTDOWN_EVENT received\n");
+    return SCTP_RC_DISCONNECT;
+  }
+  /*
+   * Association has changed.
+   */
+  else if (SCTP_ASSOC_CHANGE == snp->sn_header.sn_type) {
+    const struct sctp_assoc_change         *sctp_assoc_changed = &snp->sn_assoc_change;
+
+    OAILOG_DEBUG (LOG_SCTP, "Client association changed: %d\n", sctp_assoc_changed->sac_state);
+
+    switch (sctp_assoc_changed->sac_state) {
+    case SCTP_COMM_UP:{
+        if (association->is_up) {
+          break;
+        }
+        if ((sctp_assoc_id_t)sctp_assoc_changed->sac_assoc_id != association->assoc_id) {
+          OAILOG_WARNING (LOG_SCTP, "[%d] COMM_UP for assoc_id %u, socket accepted as assoc_id %u\n",
+              association->sd, (sctp_assoc_id_t)sctp_assoc_changed->sac_assoc_id, association->assoc_id);
+        }
+        association->instreams = sctp_assoc_changed->sac_inbound_streams;
+        association->outstreams = sctp_assoc_changed->sac_outbound_streams;
+        sctp_get_peeraddresses (association->sd, &association->peer_addresses, &association->nb_peer_addresses);
+        __atomic_store_n (&association->is_up, true, __ATOMIC_RELEASE);
+        OAILOG_DEBUG (LOG_SCTP, "New connection\n");
+
+        if (sctp_reactor.callbacks.new_association (association->assoc_id, association->instreams, association->outstreams) < 0) {
+          OAILOG_ERROR (LOG_SCTP, "Failed to send message to S1AP\n");
+          return SCTP_RC_ERROR;
+        }
+      }
+      break;
+
+    case SCTP_COMM_LOST:
+    case SCTP_SHUTDOWN_COMP:
+    case SCTP_CANT_STR_ASSOC:
+      return SCTP_RC_DISCONNECT;
+
+    default:
+      break;
+    }
+  }
+  return SCTP_RC_NORMAL_READ;
+}
+
+//------------------------------------------------------------------------------
+static int sctp_reactor_handle_message (sctp_worker_t * const worker, sctp_association_t * const association, const int i)
+{
+  struct msghdr                          *msg = &worker->msgs[i].msg_hdr;
+  const int                               length = (int)worker->msgs[i].msg_len;
+  struct sctp_sndrcvinfo                  sinfo = {0};
+  struct cmsghdr                         *cmsg = NULL;
+
+  if (msg->msg_flags & MSG_NOTIFICATION) {
+    return sctp_reactor_handle_notification (association, worker->buffers[i], length);
+  }
+
+  if (0 == length) {
+    // orderly shutdown of the peer
+    return SCTP_RC_DISCONNECT;
+  }
+
+  /*
+   * Data payload received
+   */
+  for (cmsg = CMSG_FIRSTHDR (msg); cmsg; cmsg = CMSG_NXTHDR (msg, cmsg)) {
+    if ((IPPROTO_SCTP == cmsg->cmsg_level) && (SCTP_SNDRCV == cmsg->cmsg_type)) {
+      memcpy (&sinfo, CMSG_DATA (cmsg), sizeof (sinfo));
+      break;
+    }
+  }
+
+  if (!association->is_up) {
+    // TODO: handle this case
+    return SCTP_RC_ERROR;
+  }
+
+  association->messages_recv++;
+
+  if (ntohl (sinfo.sinfo_ppid) != association->ppid) {
+    /*
+     * Mismatch in Payload Protocol Identifier,
+     * may be we received unsollicited traffic from stack other than S1AP.
+     */
+    OAILOG_ERROR (LOG_SCTP, "Received data from peer with unsollicited PPID %d, expecting %d\n", ntohl (sinfo.sinfo_ppid), association->ppid);
+    return SCTP_RC_ERROR;
+  }
+
+  OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Msg of length %d received on stream %d, PPID %d\n",
+      association->assoc_id, association->sd, length, sinfo.sinfo_stream, ntohl (sinfo.sinfo_ppid));
+  worker->messages_recv++;
+  bstring payload = blk2bstr (worker->buffers[i], length);
+  sctp_reactor.callbacks.new_message_ind (&payload, association->assoc_id, sinfo.sinfo_stream, association->instreams, association->outstreams);
+  return SCTP_RC_NORMAL_READ;
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of messages read in the worker vectors, or -1 (errno set).
+static int sctp_reactor_recv_batch (sctp_worker_t * const worker, const int sd)
+{
+  ssize_t                                 n = 0;
+
+  for (int i = 0; i < SCTP_RECV_BATCH; i++) {
+    worker->msgs[i].msg_hdr.msg_controllen = sizeof (worker->cmsgs[i]);
+    worker->msgs[i].msg_hdr.msg_flags = 0;
+    worker->msgs[i].msg_len = 0;
+  }
+
+  if (__atomic_load_n (&sctp_reactor.use_recvmmsg, __ATOMIC_RELAXED)) {
+    n = recvmmsg (sd, worker->msgs, SCTP_RECV_BATCH, MSG_DONTWAIT, NULL);
+    if ((0 <= n) || ((ENOSYS != errno) && (EOPNOTSUPP != errno))) {
+      return (int)n;
+    }
+    OAILOG_WARNING (LOG_SCTP, "recvmmsg() not supported, reading messages one by one\n");
+    __atomic_store_n (&sctp_reactor.use_recvmmsg, false, __ATOMIC_RELAXED);
+  }
+
+  if ((n = recvmsg (sd, &worker->msgs[0].msg_hdr, MSG_DONTWAIT)) < 0) {
+    return -1;
+  }
+  worker->msgs[0].msg_len = (unsigned int)n;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+static void sctp_reactor_read (sctp_worker_t * const worker, sctp_association_t * const association)
+{
+  for (int batch = 0; batch < SCTP_RECV_MAX_BATCHES_PER_EVENT; batch++) {
+    int                                     n = sctp_reactor_recv_batch (worker, association->sd);
+
+    if (n < 0) {
+      if ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)) {
+        return;
+      }
+      OAILOG_ERROR (LOG_SCTP, "[%d] recvmmsg: %s:%d\n", association->sd, strerror (errno), errno);
+      sctp_reactor_com_down (association);
+      return;
+    }
+
+    worker->recv_calls++;
+
+    for (int i = 0; i < n; i++) {
+      if (SCTP_RC_DISCONNECT == sctp_reactor_handle_message (worker, association, i)) {
+        sctp_reactor_com_down (association);
+        return;
+      }
+    }
+
+    if (n < SCTP_RECV_BATCH) {
+      return;
+    }
+  }
+  // still readable, level triggered epoll will report it again after the other ready sockets
+}
+
+//------------------------------------------------------------------------------
+static void *sctp_reactor_worker_thread (void *args_p)
+{
+  sctp_worker_t                          *worker = (sctp_worker_t *)args_p;
+  struct epoll_event                      events[SCTP_EPOLL_MAX_EVENTS];
+
+  while (true) {
+    int                                     nb_events = epoll_wait (worker->epoll_fd, events, SCTP_EPOLL_MAX_EVENTS, -1);
+
+    if (nb_events < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      OAILOG_ERROR (LOG_SCTP, "[%d] epoll_wait: %s:%d\n", worker->index, strerror (errno), errno);
+      break;
+    }
+
+    for (int i = 0; i < nb_events; i++) {
+      sctp_association_t                     *association = (sctp_association_t *)events[i].data.ptr;
+
+      if (association == NULL) {
+        // stop request on the event fd
+        return NULL;
+      } else if (association->is_listener) {
+        sctp_reactor_accept (association);
+      } else {
+        sctp_reactor_read (worker, association);
+      }
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int sctp_reactor_start_worker (sctp_worker_t * const worker, const int index)
+{
+  struct epoll_event                      event = {0};
+
+  worker->index = index;
+  for (int i = 0; i < SCTP_RECV_BATCH; i++) {
+    worker->iovs[i].iov_base = worker->buffers[i];
+    worker->iovs[i].iov_len = SCTP_RECV_BUFFER_SIZE;
+    worker->msgs[i].msg_hdr.msg_iov = &worker->iovs[i];
+    worker->msgs[i].msg_hdr.msg_iovlen = 1;
+    worker->msgs[i].msg_hdr.msg_control = worker->cmsgs[i];
+    worker->msgs[i].msg_hdr.msg_controllen = sizeof (worker->cmsgs[i]);
+  }
+
+  if ((worker->epoll_fd = epoll_create1 (EPOLL_CLOEXEC)) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "epoll_create1: %s:%d\n", strerror (errno), errno);
+    return -1;
+  }
+  if ((worker->event_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "eventfd: %s:%d\n", strerror (errno), errno);
+    return -1;
+  }
+  event.events = EPOLLIN;
+  event.data.ptr = NULL;
+  if (epoll_ctl (worker->epoll_fd, EPOLL_CTL_ADD, worker->event_fd, &event) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "epoll_ctl: %s:%d\n", strerror (errno), errno);
+    return -1;
+  }
+  if (pthread_create (&worker->thread, NULL, &sctp_reactor_worker_thread, (void *)worker)) {
+    OAILOG_ERROR (LOG_SCTP, "pthread_create: %s:%d\n", strerror (errno), errno);
+    return -1;
+  }
+  char                                    name[16];
+  snprintf (name, sizeof (name), "SCTP_W%d", index);
+  pthread_setname_np (worker->thread, name);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int sctp_reactor_init (const int nb_workers, const sctp_reactor_callbacks_t * const callbacks)
+{
+  DevAssert (callbacks);
+  DevAssert ((callbacks->new_association) && (callbacks->new_message_ind) && (callbacks->com_down_ind));
+  AssertFatal (NULL == sctp_reactor.workers, "SCTP reactor already initialized");
+
+  memset (&sctp_reactor, 0, sizeof (sctp_reactor));
+  sctp_reactor.callbacks = *callbacks;
+  sctp_reactor.use_recvmmsg = true;
+  sctp_reactor.nb_workers = nb_workers;
+  if (sctp_reactor.nb_workers < 1) {
+    sctp_reactor.nb_workers = 1;
+  } else if (sctp_reactor.nb_workers > SCTP_MAX_WORKERS) {
+    sctp_reactor.nb_workers = SCTP_MAX_WORKERS;
+  }
+  pthread_rwlock_init (&sctp_reactor.rw_lock, NULL);
+  pthread_mutex_init (&sctp_reactor.listeners_mutex, NULL);
+
+  bstring b = bfromcstr ("sctp_association_coll");
+  sctp_reactor.associations = hashtable_ts_create (1024, NULL, sctp_reactor_free_association, b);
+  bdestroy_wrapper (&b);
+  if (sctp_reactor.associations == NULL) {
+    return -1;
+  }
+
+  sctp_reactor.workers = calloc (sctp_reactor.nb_workers, sizeof (sctp_worker_t));
+  if (sctp_reactor.workers == NULL) {
+    return -1;
+  }
+  for (int i = 0; i < sctp_reactor.nb_workers; i++) {
+    sctp_reactor.workers[i].epoll_fd = -1;
+    sctp_reactor.workers[i].event_fd = -1;
+  }
+  for (int i = 0; i < sctp_reactor.nb_workers; i++) {
+    if (sctp_reactor_start_worker (&sctp_reactor.workers[i], i) < 0) {
+      return -1;
+    }
+  }
+  OAILOG_DEBUG (LOG_SCTP, "SCTP reactor started with %d workers\n", sctp_reactor.nb_workers);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int sctp_reactor_add_listener (const int sd, const uint32_t ppid)
+{
+  sctp_association_t                     *listener = NULL;
+  struct epoll_event                      event = {0};
+  int                                     flags = fcntl (sd, F_GETFL, 0);
+
+  DevAssert (sctp_reactor.workers);
+
+  // accept() is called until EAGAIN
+  if ((flags < 0) || (fcntl (sd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+    OAILOG_ERROR (LOG_SCTP, "[%d] fcntl: %s:%d\n", sd, strerror (errno), errno);
+    return -1;
+  }
+  if ((listener = calloc (1, sizeof (sctp_association_t))) == NULL) {
+    return -1;
+  }
+  listener->sd = sd;
+  listener->ppid = ppid;
+  listener->is_listener = true;
+  listener->refcount = 1;
+  listener->worker = &sctp_reactor.workers[0];
+
+  event.events = EPOLLIN;
+  event.data.ptr = listener;
+  if (epoll_ctl (listener->worker->epoll_fd, EPOLL_CTL_ADD, sd, &event) < 0) {
+    OAILOG_ERROR (LOG_SCTP, "[%d] epoll_ctl: %s:%d\n", sd, strerror (errno), errno);
+    free_wrapper ((void**)&listener);
+    return -1;
+  }
+
+  pthread_mutex_lock (&sctp_reactor.listeners_mutex);
+  listener->next_listener = sctp_reactor.listeners;
+  sctp_reactor.listeners = listener;
+  pthread_mutex_unlock (&sctp_reactor.listeners_mutex);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int sctp_reactor_send_shared (const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream, const_bstring payload)
+{
+  sctp_association_t                     *association = NULL;
+  int                                     rc = -1;
+
+  DevAssert (payload);
+  pthread_rwlock_rdlock (&sctp_reactor.rw_lock);
+  if (HASH_TABLE_OK == hashtable_ts_get (sctp_reactor.associations, (hash_key_t)assoc_id, (void **)&association)) {
+    __atomic_add_fetch (&association->refcount, 1, __ATOMIC_RELAXED);
+  } else {
+    association = NULL;
+  }
+  pthread_rwlock_unlock (&sctp_reactor.rw_lock);
+
+  if (association == NULL) {
+    OAILOG_DEBUG (LOG_SCTP, "This assoc id has not been fount in list (%d)\n", assoc_id);
+    return -1;
+  }
+
+  if (!__atomic_load_n (&association->is_up, __ATOMIC_ACQUIRE)) {
+    OAILOG_DEBUG (LOG_SCTP, "Association not established (assoc id %d)\n", assoc_id);
+  } else {
+    OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
+        association->sd, assoc_id, bdata(payload), blength(payload), stream, association->ppid);
+
+    /*
+     * Send message on specified stream of the sd association
+     */
+    if (sctp_sendmsg (association->sd, (const void *)bdata(payload), blength(payload), NULL, 0, htonl(association->ppid), 0, stream, 0, 0) < 0) {
+      OAILOG_ERROR (LOG_SCTP, "send: %s:%d\n", strerror (errno), errno);
+    } else {
+      OAILOG_DEBUG (LOG_SCTP, "Successfully sent %d bytes on stream %d\n", blength(payload), stream);
+      __atomic_add_fetch (&association->messages_sent, 1, __ATOMIC_RELAXED);
+      __atomic_add_fetch (&sctp_reactor.messages_sent, 1, __ATOMIC_RELAXED);
+      rc = 0;
+    }
+  }
+  sctp_reactor_release_association (association);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int sctp_reactor_send (const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream, STOLEN_REF bstring *payload)
+{
+  int                                     rc = -1;
+
+  DevAssert (*payload);
+  rc = sctp_reactor_send_shared (assoc_id, stream, *payload);
+  bdestroy_wrapper (payload);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+void sctp_reactor_get_stats (sctp_reactor_stats_t * const stats)
+{
+  memset (stats, 0, sizeof (*stats));
+  stats->number_of_associations = __atomic_load_n (&sctp_reactor.number_of_associations, __ATOMIC_RELAXED);
+  stats->messages_sent = __atomic_load_n (&sctp_reactor.messages_sent, __ATOMIC_RELAXED);
+  stats->accepted = __atomic_load_n (&sctp_reactor.accepted, __ATOMIC_RELAXED);
+  stats->closed = __atomic_load_n (&sctp_reactor.closed, __ATOMIC_RELAXED);
+  for (int i = 0; (sctp_reactor.workers) && (i < sctp_reactor.nb_workers); i++) {
+    stats->messages_recv += __atomic_load_n (&sctp_reactor.workers[i].messages_recv, __ATOMIC_RELAXED);
+    stats->recv_calls += __atomic_load_n (&sctp_reactor.workers[i].recv_calls, __ATOMIC_RELAXED);
+  }
+}
+
+//------------------------------------------------------------------------------
+void sctp_reactor_exit (void)
+{
+  if (sctp_reactor.workers == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < sctp_reactor.nb_workers; i++) {
+    sctp_worker_t                          *worker = &sctp_reactor.workers[i];
+
+    if (worker->event_fd >= 0) {
+      uint64_t                                one = 1;
+
+      if (write (worker->event_fd, &one, sizeof (one)) < 0) {
+        OAILOG_DEBUG (LOG_SCTP, "[%d] eventfd write: %s:%d\n", i, strerror (errno), errno);
+      }
+      if (worker->thread) {
+        pthread_join (worker->thread, NULL);
+      }
+      close (worker->event_fd);
+    }
+    if (worker->epoll_fd >= 0) {
+      close (worker->epoll_fd);
+    }
+  }
+
+  while (sctp_reactor.listeners) {
+    sctp_association_t                     *listener = sctp_reactor.listeners;
+
+    sctp_reactor.listeners = listener->next_listener;
+    close (listener->sd);
+    free_wrapper ((void**)&listener);
+  }
+  hashtable_ts_destroy (sctp_reactor.associations);
+  sctp_reactor.associations = NULL;
+  free_wrapper ((void**)&sctp_reactor.workers);
+  pthread_rwlock_destroy (&sctp_reactor.rw_lock);
+  pthread_mutex_destroy (&sctp_reactor.listeners_mutex);
+}
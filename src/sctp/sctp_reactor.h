@@ -0,0 +1,94 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sctp_reactor.h
+ *  \brief epoll based reactor serving all SCTP associations of the listeners.
+ *
+ *  A fixed pool of worker threads, each one waiting on its own epoll set.
+ *  Listening sockets are served by worker 0, every accepted association is
+ *  pinned to worker (assoc_id % number of workers) for its whole life, so that
+ *  messages of an association are always delivered in order by the same thread.
+ *  Readable sockets are drained by batches of SCTP_RECV_BATCH messages with
+ *  recvmmsg() (falls back on recvmsg() when the kernel does not support it).
+ *  Associations are indexed by assoc_id in a hash table shared by the workers
+ *  and the senders.
+ *  @ingroup _sctp
+ *  @{
+ */
+
+#ifndef FILE_SCTP_REACTOR_SEEN
+#define FILE_SCTP_REACTOR_SEEN
+
+#include "bstrlib.h"
+#include "common_types.h"
+#include "common_defs.h"
+
+/*! \brief Upper layer notifications, called from the worker thread owning the association.
+ *  The signatures are the ones of the sctp_itti_send_xxx() functions.
+ */
+typedef struct sctp_reactor_callbacks_s {
+  int (*new_association)(const sctp_assoc_id_t assoc_id, const sctp_stream_id_t instreams, const sctp_stream_id_t outstreams);
+  int (*new_message_ind)(STOLEN_REF bstring *payload, const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream,
+                         const sctp_stream_id_t instreams, const sctp_stream_id_t outstreams);
+  int (*com_down_ind)(const sctp_assoc_id_t assoc_id);
+} sctp_reactor_callbacks_t;
+
+typedef struct sctp_reactor_stats_s {
+  uint32_t                 number_of_associations;  ///< Accepted associations not yet closed
+  uint64_t                 messages_recv;           ///< Data messages delivered to the upper layer
+  uint64_t                 messages_sent;           ///< Data messages successfully sent
+  uint64_t                 recv_calls;              ///< recvmmsg()/recvmsg() calls that returned something
+  uint64_t                 accepted;                ///< Associations accepted since start
+  uint64_t                 closed;                  ///< Associations closed since start
+} sctp_reactor_stats_t;
+
+/** \brief Starts the worker threads.
+ \param nb_workers Number of worker threads, clamped to [1, SCTP_MAX_WORKERS]
+ \param callbacks  Upper layer notifications, copied
+ @returns -1 on error, 0 otherwise.
+ **/
+int  sctp_reactor_init (const int nb_workers, const sctp_reactor_callbacks_t * const callbacks);
+
+/** \brief Hands a bound and listening socket over to the reactor, the reactor closes it on exit.
+ \param sd   Listening socket descriptor
+ \param ppid Payload Protocol Identifier expected on the associations of this listener
+ @returns -1 on error, 0 otherwise.
+ **/
+int  sctp_reactor_add_listener (const int sd, const uint32_t ppid);
+
+/** \brief Sends a message on an association, may be called from any thread.
+ \param assoc_id Association identifier
+ \param stream   Stream on which the message is sent
+ \param payload  Message, always consumed
+ @returns -1 on error, 0 otherwise.
+ **/
+int  sctp_reactor_send (const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream, STOLEN_REF bstring *payload);
+
+/** \brief Same as sctp_reactor_send() but the payload is not consumed, for a message sent on several associations. **/
+int  sctp_reactor_send_shared (const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream, const_bstring payload);
+
+void sctp_reactor_get_stats (sctp_reactor_stats_t * const stats);
+
+/** \brief Stops the workers, closes all listeners and associations (no com down notification is sent). **/
+void sctp_reactor_exit (void);
+
+/* @} */
+#endif /* FILE_SCTP_REACTOR_SEEN */
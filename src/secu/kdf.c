@@ -28,7 +28,7 @@
 
 #include "security_types.h"
 #include "secu_defs.h"
-#include "dynamic_memory_check.h"
+#include "assertions.h"
 
 void
 kdf (
@@ -39,23 +39,73 @@ kdf (
   uint8_t * out,
   const unsigned out_len)
 {
-  struct hmac_sha256_ctx                  *ctx = calloc(1, sizeof(struct hmac_sha256_ctx));
+  struct hmac_sha256_ctx                  ctx;
 
-  //memset (&ctx, 0, sizeof (ctx));
-  hmac_sha256_set_key (ctx, key_len, key);
-  hmac_sha256_update (ctx, s_len, s);
-  hmac_sha256_digest (ctx, out_len, out);
-  free_wrapper((void**)&ctx);
+  hmac_sha256_set_key (&ctx, key_len, key);
+  hmac_sha256_update (&ctx, s_len, s);
+  hmac_sha256_digest (&ctx, out_len, out);
 }
 
-int
-derive_keNB (
-  const uint8_t *kasme_32,
-  const uint32_t nas_count,
-  uint8_t * keNB)
+//------------------------------------------------------------------------------
+void
+kdf_context_init (
+  kdf_context_t * const context,
+  const uint8_t * const key,
+  const unsigned key_len)
 {
-  uint8_t                                 s[7] = {0};
+  DevAssert (context != NULL);
+  DevAssert (key != NULL);
+  DevAssert (key_len <= KDF_KEY_MAX_SIZE);
+  DevAssert (sizeof (struct hmac_sha256_ctx) <= sizeof (context->hmac));
+  memset (context, 0, sizeof (*context));
+  memcpy (context->key, key, key_len);
+  context->key_length = key_len;
+  hmac_sha256_set_key ((struct hmac_sha256_ctx *)context->hmac, key_len, key);
+  context->initialized = true;
+}
+
+//------------------------------------------------------------------------------
+const kdf_context_t *
+kdf_context_for_key (
+  kdf_context_t * const context,
+  const uint8_t * const key,
+  const unsigned key_len)
+{
+  DevAssert (context != NULL);
+  if ((!context->initialized) || (key_len != context->key_length) || (memcmp (context->key, key, key_len))) {
+    kdf_context_init (context, key, key_len);
+  }
+  return context;
+}
+
+//------------------------------------------------------------------------------
+void
+kdf_with_context (
+  const kdf_context_t * const context,
+  const uint8_t * const s,
+  const unsigned s_len,
+  uint8_t * const out,
+  const unsigned out_len)
+{
+  struct hmac_sha256_ctx                  ctx;
+
+  DevAssert (context != NULL);
+  DevAssert (context->initialized);
+  /*
+   * The inner and outer states already absorbed the key pads: the copy is ready for the message,
+   * S up to 55 bytes is one compression, the digest of the outer hash is another one
+   */
+  memcpy (&ctx, context->hmac, sizeof (ctx));
+  hmac_sha256_update (&ctx, s_len, s);
+  hmac_sha256_digest (&ctx, out_len, out);
+}
 
+//------------------------------------------------------------------------------
+static void
+kdf_s_kenb (
+  const uint32_t nas_count,
+  uint8_t s[7])
+{
   // FC
   s[0] = FC_KENB;
   // P0 = Uplink NAS count
@@ -66,27 +116,68 @@ derive_keNB (
   // Length of NAS count
   s[5] = 0x00;
   s[6] = 0x04;
+}
+
+int
+derive_keNB (
+  const uint8_t *kasme_32,
+  const uint32_t nas_count,
+  uint8_t * keNB)
+{
+  uint8_t                                 s[7] = {0};
+
+  kdf_s_kenb (nas_count, s);
   kdf (kasme_32, 32, s, 7, keNB, 32);
   return 0;
 }
 
 int
-derive_nh (
-  const uint8_t *kasme_32,
-  uint8_t * nh)
+derive_keNB_with_context (
+  const kdf_context_t * const kasme_context,
+  const uint32_t nas_count,
+  uint8_t * keNB)
 {
+  uint8_t                                 s[7] = {0};
 
-  uint8_t                                 s[35];
-  memset(s, 0, 35);
+  kdf_s_kenb (nas_count, s);
+  kdf_with_context (kasme_context, s, 7, keNB, 32);
+  return 0;
+}
 
+//------------------------------------------------------------------------------
+static void
+kdf_s_nh (
+  const uint8_t * const nh,
+  uint8_t s[35])
+{
   s[0] = (FC_NH);
-   // P0
+  // P0 = SYNC-input, previous NH (or KeNB)
   memcpy(s+1, nh, 32);
-    // L0 = len(SN input)
-   s[33] = 0x00;
-   s[34] = 0x20;
+  // L0 = len(SN input)
+  s[33] = 0x00;
+  s[34] = 0x20;
+}
+
+int
+derive_nh (
+  const uint8_t *kasme_32,
+  uint8_t * nh)
+{
+  uint8_t                                 s[35];
 
-   kdf (kasme_32, 32, s, 35, nh, 32);
-   return 0;
+  kdf_s_nh (nh, s);
+  kdf (kasme_32, 32, s, 35, nh, 32);
+  return 0;
 }
 
+int
+derive_nh_with_context (
+  const kdf_context_t * const kasme_context,
+  uint8_t * nh)
+{
+  uint8_t                                 s[35];
+
+  kdf_s_nh (nh, s);
+  kdf_with_context (kasme_context, s, 35, nh, 32);
+  return 0;
+}
@@ -32,30 +32,12 @@
 #include "secu_defs.h"
 #include "log.h"
 
-/*!
-   @brief Derive the kNASenc from kasme and perform truncate on the generated key to
-   reduce his size to 128 bits. Definition of the derivation function can
-   be found in 3GPP TS.33401 #A.7
-   @param[in] nas_alg_type NAS algorithm distinguisher
-   @param[in] nas_enc_alg_id NAS encryption/integrity algorithm identifier.
-   Possible values are:
-        - 0 for EIA0 algorithm (Null Integrity Protection algorithm)
-        - 1 for 128-EIA1 SNOW 3G
-        - 2 for 128-EIA2 AES
-   @param[in] kasme Key for MME as provided by AUC
-   @param[out] knas Pointer to reference where output of KDF will be stored.
-   NOTE: knas is dynamically allocated by the KDF function
-*/
-int
-derive_key_nas (
+static void
+kdf_s_alg_key (
   algorithm_type_dist_t nas_alg_type,
   uint8_t nas_enc_alg_id,
-  const uint8_t *kasme_32,
-  uint8_t * knas)
+  uint8_t s[7])
 {
-  uint8_t                                 s[7] = {0};
-  uint8_t                                 out[32] = {0};
-
   /*
    * FC
    */
@@ -78,6 +60,33 @@ derive_key_nas (
    */
   s[5] = 0x00;
   s[6] = 0x01;
+}
+
+/*!
+   @brief Derive the kNASenc from kasme and perform truncate on the generated key to
+   reduce his size to 128 bits. Definition of the derivation function can
+   be found in 3GPP TS.33401 #A.7
+   @param[in] nas_alg_type NAS algorithm distinguisher
+   @param[in] nas_enc_alg_id NAS encryption/integrity algorithm identifier.
+   Possible values are:
+        - 0 for EIA0 algorithm (Null Integrity Protection algorithm)
+        - 1 for 128-EIA1 SNOW 3G
+        - 2 for 128-EIA2 AES
+   @param[in] kasme Key for MME as provided by AUC
+   @param[out] knas Pointer to reference where output of KDF will be stored.
+   NOTE: knas is dynamically allocated by the KDF function
+*/
+int
+derive_key_nas (
+  algorithm_type_dist_t nas_alg_type,
+  uint8_t nas_enc_alg_id,
+  const uint8_t *kasme_32,
+  uint8_t * knas)
+{
+  uint8_t                                 s[7] = {0};
+  uint8_t                                 out[32] = {0};
+
+  kdf_s_alg_key (nas_alg_type, nas_enc_alg_id, s);
   //OAILOG_TRACE (LOG_NAS, "FC %d nas_alg_type distinguisher %d nas_enc_alg_identity %d\n", FC_ALG_KEY_DER, nas_alg_type, nas_enc_alg_id);
   //OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "s:", s, 7);
   //OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "kasme_32:", kasme_32, 32);
@@ -85,3 +94,50 @@ derive_key_nas (
   memcpy (knas, &out[31 - 16 + 1], 16);
   return 0;
 }
+
+/*!
+   @brief Same as derive_key_nas() with the HMAC states of kasme set up in kasme_context.
+*/
+int
+derive_key_nas_with_context (
+  const kdf_context_t * const kasme_context,
+  algorithm_type_dist_t nas_alg_type,
+  uint8_t nas_enc_alg_id,
+  uint8_t * knas)
+{
+  uint8_t                                 s[7] = {0};
+  uint8_t                                 out[32] = {0};
+
+  kdf_s_alg_key (nas_alg_type, nas_enc_alg_id, s);
+  kdf_with_context (kasme_context, &s[0], 7, &out[0], 32);
+  memcpy (knas, &out[31 - 16 + 1], 16);
+  return 0;
+}
+
+/*!
+   @brief Derive K NASint, K NASenc (TS.33401 #A.7) and, if keNB is not NULL, KeNB (TS.33401 #A.3)
+   with the HMAC states of kasme set up once in kasme_context.
+   @param[in] kasme_context KDF context of kasme
+   @param[in] nas_int_alg_id Selected NAS integrity algorithm identifier
+   @param[in] nas_enc_alg_id Selected NAS encryption algorithm identifier
+   @param[in] nas_count Uplink NAS count for KeNB
+   @param[out] knas_int, knas_enc 128 bits keys
+   @param[out] keNB 256 bits key, may be NULL
+*/
+int
+derive_keys_nas_enb_with_context (
+  const kdf_context_t * const kasme_context,
+  uint8_t nas_int_alg_id,
+  uint8_t nas_enc_alg_id,
+  const uint32_t nas_count,
+  uint8_t * knas_int,
+  uint8_t * knas_enc,
+  uint8_t * keNB)
+{
+  derive_key_nas_with_context (kasme_context, NAS_INT_ALG, nas_int_alg_id, knas_int);
+  derive_key_nas_with_context (kasme_context, NAS_ENC_ALG, nas_enc_alg_id, knas_enc);
+  if (keNB) {
+    derive_keNB_with_context (kasme_context, nas_count, keNB);
+  }
+  return 0;
+}
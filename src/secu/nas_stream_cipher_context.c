@@ -0,0 +1,99 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_stream_cipher_context.c
+  \brief Key dependent state of the NAS stream algorithms EEA1/EIA1 (SNOW 3G) and EEA2/EIA2 (AES-128)
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <nettle/nettle-meta.h>
+#include <nettle/aes.h>
+
+#include "assertions.h"
+#include "conversions.h"
+#include "secu_defs.h"
+
+//------------------------------------------------------------------------------
+// CMAC subkey: left shift of one bit, conditional xor with Rb (RFC 4493 2.3)
+static void nas_stream_cmac_subkey (const uint8_t in[16], uint8_t out[16])
+{
+  const uint8_t                           msb = in[0] & 0x80;
+
+  for (int i = 0; i < 15; i++) {
+    out[i] = (uint8_t)(in[i] << 1) | (in[i + 1] >> 7);
+  }
+  out[15] = (uint8_t)(in[15] << 1);
+  if (msb) {
+    out[15] ^= 0x87;
+  }
+}
+
+//------------------------------------------------------------------------------
+void nas_stream_cipher_context_init (nas_stream_cipher_context_t * const context, const uint8_t * const key, const uint32_t key_length)
+{
+  uint8_t                                 l[16] = {0};
+
+  DevAssert (context != NULL);
+  DevAssert (key != NULL);
+  DevAssert (key_length == NAS_STREAM_CIPHER_KEY_SIZE);
+  DevAssert (nettle_aes128.context_size <= sizeof (context->aes));
+  memset (context, 0, sizeof (*context));
+  memcpy (context->key, key, NAS_STREAM_CIPHER_KEY_SIZE);
+
+  /*
+   * SNOW 3G: K[3] = key[0..31] ... K[0] = key[96..127], see sections 3.4 and 4.4
+   */
+  for (int i = 0; i < 4; i++) {
+    uint32_t                                k = 0;
+
+    memcpy (&k, key + 4 * i, 4);
+    context->snow3g_key[3 - i] = hton_int32 (k);
+  }
+
+  /*
+   * AES-128 key schedule, then CMAC subkeys K1 and K2 from L = AES(K, 0^128)
+   */
+#if NETTLE_VERSION_MAJOR < 3
+  nettle_aes128.set_encrypt_key (context->aes, key_length, key);
+#else
+  nettle_aes128.set_encrypt_key (context->aes, key);
+#endif
+  nettle_aes128.encrypt ((void *)context->aes, sizeof (l), l, l);
+  nas_stream_cmac_subkey (l, context->cmac_k1);
+  nas_stream_cmac_subkey (context->cmac_k1, context->cmac_k2);
+  memset (l, 0, sizeof (l));
+  context->initialized = true;
+}
+
+//------------------------------------------------------------------------------
+const nas_stream_cipher_context_t *nas_stream_cipher_context_for_key (nas_stream_cipher_context_t * const context, const uint8_t * const key, const uint32_t key_length)
+{
+  DevAssert (context != NULL);
+  if ((!context->initialized) || (key_length != NAS_STREAM_CIPHER_KEY_SIZE) || (memcmp (context->key, key, NAS_STREAM_CIPHER_KEY_SIZE))) {
+    nas_stream_cipher_context_init (context, key, key_length);
+  }
+  return context;
+}
@@ -33,20 +33,20 @@
 #include "assertions.h"
 #include "conversions.h"
 #include "secu_defs.h"
-#include "dynamic_memory_check.h"
 
 int
-nas_stream_encrypt_eea2 (
-  nas_stream_cipher_t * const stream_cipher,
+nas_stream_encrypt_eea2_with_context (
+  const nas_stream_cipher_context_t * const context,
+  const nas_stream_cipher_t * const stream_cipher,
   uint8_t * const out)
 {
   uint8_t                                 m[16];
   uint32_t                                local_count;
-  void                                   *ctx;
-  uint8_t                                *data;
   uint32_t                                zero_bit = 0;
   uint32_t                                byte_length;
 
+  DevAssert (context != NULL);
+  DevAssert (context->initialized);
   DevAssert (stream_cipher != NULL);
   DevAssert (out != NULL);
   zero_bit = stream_cipher->blength & 0x7;
@@ -55,29 +55,30 @@ nas_stream_encrypt_eea2 (
   if (zero_bit > 0)
     byte_length += 1;
 
-  ctx = malloc (nettle_aes128.context_size);
-  data = calloc (1, byte_length);
   local_count = hton_int32 (stream_cipher->count);
   memset (m, 0, sizeof (m));
   memcpy (&m[0], &local_count, 4);
   m[4] = ((stream_cipher->bearer & 0x1F) << 3) | ((stream_cipher->direction & 0x01) << 2);
   /*
    * Other bits are 0
+   * The key stream is xored from message to out directly, they may be the same buffer.
    */
-#if NETTLE_VERSION_MAJOR < 3
-  nettle_aes128.set_encrypt_key(ctx, stream_cipher->key_length,
-                                stream_cipher->key);
-#else
-  nettle_aes128.set_encrypt_key(ctx,
-                                stream_cipher->key);
-#endif
-  nettle_ctr_crypt (ctx, nettle_aes128.encrypt, nettle_aes128.block_size, m, byte_length, data, stream_cipher->message);
+  nettle_ctr_crypt ((void *)context->aes, nettle_aes128.encrypt, nettle_aes128.block_size, m, byte_length, out, stream_cipher->message);
 
   if (zero_bit > 0)
-    data[byte_length - 1] = data[byte_length - 1] & (uint8_t) (0xFF << (8 - zero_bit));
+    out[byte_length - 1] = out[byte_length - 1] & (uint8_t) (0xFF << (8 - zero_bit));
 
-  memcpy (out, data, byte_length);
-  free_wrapper ((void**)&data);
-  free_wrapper ((void**)&ctx);
   return 0;
 }
+
+int
+nas_stream_encrypt_eea2 (
+  nas_stream_cipher_t * const stream_cipher,
+  uint8_t * const out)
+{
+  nas_stream_cipher_context_t             context;
+
+  DevAssert (stream_cipher != NULL);
+  nas_stream_cipher_context_init (&context, stream_cipher->key, stream_cipher->key_length);
+  return nas_stream_encrypt_eea2_with_context (&context, stream_cipher, out);
+}
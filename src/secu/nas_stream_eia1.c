@@ -43,6 +43,10 @@ uint64_t                                MUL64 (
   uint64_t V,
   uint64_t P,
   uint64_t c);
+int                                     nas_stream_encrypt_eia1_with_context (
+  const nas_stream_cipher_context_t * const context,
+  const nas_stream_cipher_t * const stream_cipher,
+  uint8_t out[4]);
 int                                     nas_stream_encrypt_eia1 (
   nas_stream_cipher_t * const stream_cipher,
   uint8_t const out[4]);
@@ -98,6 +102,8 @@ MUL64xPOW (
    A 64-bit memory is allocated which is to be free_wrapperd by the calling
    function.
    See section 4.3.4 for details.
+   V.x^i is obtained from V.x^(i-1) instead of MUL64xPOW (V, i, c), with masks instead of
+   branches on the (random) bits of P and V.
 */
 uint64_t
 MUL64 (
@@ -109,8 +115,8 @@ MUL64 (
   int                                     i = 0;
 
   for (i = 0; i < 64; i++) {
-    if ((P >> i) & 0x1)
-      result ^= MUL64xPOW (V, i, c);
+    result ^= V & (0 - ((P >> i) & 0x1));
+    V = (V << 1) ^ (c & (0 - (V >> 63)));
   }
 
   return result;
@@ -138,14 +144,16 @@ mask32bit (
 
 
 /*!
-   @brief Create integrity cmac t for a given message.
+   @brief Create integrity cmac t for a given message, with the SNOW 3G key words of context.
+   @param[in] context Key state of the integrity key
    @param[in] stream_cipher Structure containing various variables to setup encoding
    @param[out] out For EIA1 the output string is 32 bits long
 */
 int
-nas_stream_encrypt_eia1 (
-  nas_stream_cipher_t * const stream_cipher,
-  uint8_t const out[4])
+nas_stream_encrypt_eia1_with_context (
+  const nas_stream_cipher_context_t * const context,
+  const nas_stream_cipher_t * const stream_cipher,
+  uint8_t out[4])
 {
   snow_3g_context_t                       snow_3g_context;
   uint32_t                                K[4],
@@ -164,22 +172,13 @@ nas_stream_encrypt_eia1 (
   uint32_t                                mask = 0;
   uint32_t                               *message;
 
+  DevAssert (context != NULL);
+  DevAssert (context->initialized);
   message = (uint32_t *) stream_cipher->message;        /* To operate 32 bit message internally. */
   /*
-   * Load the Integrity Key for SNOW3G initialization as in section 4.4.
+   * The Integrity Key words for SNOW3G initialization (section 4.4) are in the context.
    */
-  memcpy (K + 3, stream_cipher->key + 0, 4);    /*K[3] = key[0]; we assume
-                                                 * K[3]=key[0]||key[1]||...||key[31] , with key[0] the
-                                                 * * * * most important bit of key */
-  memcpy (K + 2, stream_cipher->key + 4, 4);    /*K[2] = key[1]; */
-  memcpy (K + 1, stream_cipher->key + 8, 4);    /*K[1] = key[2]; */
-  memcpy (K + 0, stream_cipher->key + 12, 4);   /*K[0] = key[3]; we assume
-                                                 * K[0]=key[96]||key[97]||...||key[127] , with key[127] the
-                                                 * * * * least important bit of key */
-  K[3] = hton_int32 (K[3]);
-  K[2] = hton_int32 (K[2]);
-  K[1] = hton_int32 (K[1]);
-  K[0] = hton_int32 (K[0]);
+  memcpy (K, context->snow3g_key, sizeof (K));
   /*
    * Prepare the Initialization Vector (IV) for SNOW3G initialization as in
    * section 4.4.
@@ -264,3 +263,20 @@ nas_stream_encrypt_eia1 (
   memcpy ((void *)out, &MAC_I, 4);
   return 0;
 }
+
+/*!
+   @brief Create integrity cmac t for a given message.
+   @param[in] stream_cipher Structure containing various variables to setup encoding
+   @param[out] out For EIA1 the output string is 32 bits long
+*/
+int
+nas_stream_encrypt_eia1 (
+  nas_stream_cipher_t * const stream_cipher,
+  uint8_t const out[4])
+{
+  nas_stream_cipher_context_t             context;
+
+  DevAssert (stream_cipher != NULL);
+  nas_stream_cipher_context_init (&context, stream_cipher->key, stream_cipher->key_length);
+  return nas_stream_encrypt_eia1_with_context (&context, stream_cipher, (uint8_t *)out);
+}
@@ -25,46 +25,42 @@
 #include <stdbool.h>
 #include <string.h>
 
-#include "secu_defs.h"
-
-#include <openssl/aes.h>
-#include <openssl/cmac.h>
-#include <openssl/evp.h>
-
-// test
-#include <openssl/ssl.h>
-#include <openssl/err.h>
-#include <openssl/bio.h>
+#include <nettle/nettle-meta.h>
+#include <nettle/aes.h>
 #include "bstrlib.h"
 
+#include "secu_defs.h"
+
 #include "assertions.h"
 #include "conversions.h"
-#include "dynamic_memory_check.h"
 #include "log.h"
 #include "gcc_diag.h"
 
 /*!
-   @brief Create integrity cmac t for a given message.
+   @brief Create integrity cmac t for a given message, with the AES key schedule and the CMAC subkeys of context.
+          The 8 bytes header (COUNT, BEARER, DIRECTION) and the message are chained block by block (RFC 4493),
+          the message is neither copied nor modified.
+   @param[in] context Key state of the integrity key
    @param[in] stream_cipher Structure containing various variables to setup encoding
    @param[out] out For EIA2 the output string is 32 bits long
 */
 int
-nas_stream_encrypt_eia2 (
-  nas_stream_cipher_t * const stream_cipher,
-  uint8_t const out[4])
+nas_stream_encrypt_eia2_with_context (
+  const nas_stream_cipher_context_t * const context,
+  const nas_stream_cipher_t * const stream_cipher,
+  uint8_t out[4])
 {
-  uint8_t                                *m = NULL;
+  uint8_t                                 x[16] = {0};
   uint32_t                                local_count = 0;
-  size_t                                  size = 4;
-  uint8_t                                 data[16] = {0};
-  CMAC_CTX                               *cmac_ctx = NULL;
-  const EVP_CIPHER                       *cipher = EVP_aes_128_cbc ();
   uint32_t                                zero_bit = 0;
   uint32_t                                m_length;
+  uint32_t                                offset = 0;
+  uint32_t                                filled = 0;
+  uint32_t                                n = 0;
 
+  DevAssert (context != NULL);
+  DevAssert (context->initialized);
   DevAssert (stream_cipher != NULL);
-  DevAssert (stream_cipher->key != NULL);
-  DevAssert (stream_cipher->key_length > 0);
   DevAssert (out != NULL);
   zero_bit = stream_cipher->blength & 0x7;
   m_length = stream_cipher->blength >> 3;
@@ -72,24 +68,69 @@ nas_stream_encrypt_eia2 (
   if (zero_bit > 0)
     m_length += 1;
 
-  local_count = hton_int32 (stream_cipher->count);
-  m = calloc (1, m_length + 8);
-  memcpy (&m[0], &local_count, 4);
-  m[4] = ((stream_cipher->bearer & 0x1F) << 3) | ((stream_cipher->direction & 0x01) << 2);
-  memcpy (&m[8], stream_cipher->message, m_length);
-
   OAILOG_TRACE (LOG_NAS, "Byte length: %u, Zero bits: %u:\n", m_length + 8, zero_bit);
-  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "m:", m, m_length + 8);
-  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "Key:", stream_cipher->key, stream_cipher->key_length);
   OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "Message:", stream_cipher->message, m_length);
 
-  cmac_ctx = CMAC_CTX_new ();
-  CMAC_Init (cmac_ctx, stream_cipher->key, stream_cipher->key_length, cipher, NULL);
-  CMAC_Update (cmac_ctx, m, m_length + 8);
-  CMAC_Final (cmac_ctx, data, &size);
-  CMAC_CTX_free (cmac_ctx);
-  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "Out:", data, size);
-  memcpy ((void*)out, data, 4);
-  free_wrapper ((void**)&m);
+  /*
+   * First block: COUNT || BEARER || DIRECTION || 0^26 || first 8 bytes of the message
+   */
+  local_count = hton_int32 (stream_cipher->count);
+  memcpy (&x[0], &local_count, 4);
+  x[4] = ((stream_cipher->bearer & 0x1F) << 3) | ((stream_cipher->direction & 0x01) << 2);
+  n = (m_length < 8) ? m_length : 8;
+  for (uint32_t i = 0; i < n; i++) {
+    x[8 + i] ^= stream_cipher->message[i];
+  }
+  offset = n;
+  filled = 8 + n;
+
+  /*
+   * x is the full current block xored with the chaining value, it is not the last block while message bytes remain
+   */
+  while (offset < m_length) {
+    nettle_aes128.encrypt ((void *)context->aes, sizeof (x), x, x);
+    n = ((m_length - offset) < 16) ? (m_length - offset) : 16;
+    for (uint32_t i = 0; i < n; i++) {
+      x[i] ^= stream_cipher->message[offset + i];
+    }
+    offset += n;
+    filled = n;
+  }
+
+  /*
+   * Last block: complete with K1, padded with K2
+   */
+  if (16 == filled) {
+    for (int i = 0; i < 16; i++) {
+      x[i] ^= context->cmac_k1[i];
+    }
+  } else {
+    x[filled] ^= 0x80;
+    for (int i = 0; i < 16; i++) {
+      x[i] ^= context->cmac_k2[i];
+    }
+  }
+  nettle_aes128.encrypt ((void *)context->aes, sizeof (x), x, x);
+  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "Out:", x, sizeof (x));
+  memcpy ((void*)out, x, 4);
   return 0;
 }
+
+/*!
+   @brief Create integrity cmac t for a given message.
+   @param[in] stream_cipher Structure containing various variables to setup encoding
+   @param[out] out For EIA2 the output string is 32 bits long
+*/
+int
+nas_stream_encrypt_eia2 (
+  nas_stream_cipher_t * const stream_cipher,
+  uint8_t const out[4])
+{
+  nas_stream_cipher_context_t             context;
+
+  DevAssert (stream_cipher != NULL);
+  DevAssert (stream_cipher->key != NULL);
+  DevAssert (stream_cipher->key_length > 0);
+  nas_stream_cipher_context_init (&context, stream_cipher->key, stream_cipher->key_length);
+  return nas_stream_encrypt_eia2_with_context (&context, stream_cipher, (uint8_t *)out);
+}
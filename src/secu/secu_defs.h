@@ -22,6 +22,8 @@
 #ifndef FILE_SECU_DEFS_SEEN
 #define FILE_SECU_DEFS_SEEN
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "security_types.h"
 
 
@@ -42,6 +44,39 @@ int derive_key_nas(algorithm_type_dist_t nas_alg_type, uint8_t nas_enc_alg_id,
 
 int derive_nh ( const uint8_t *kasme_32,  uint8_t * nh);
 
+/* HMAC-SHA-256 inner and outer pad states of a KDF key (K ASME), set up once for the lifetime of the
+ * key instead of on every derivation: a derivation then costs two SHA-256 compressions. */
+#define KDF_KEY_MAX_SIZE                  32
+#define KDF_HMAC_CTX_SIZE                 384   /* bytes, >= sizeof (struct hmac_sha256_ctx) */
+typedef struct kdf_context_s {
+  bool      initialized;
+  uint32_t  key_length;
+  uint8_t   key[KDF_KEY_MAX_SIZE];
+  uint64_t  hmac[KDF_HMAC_CTX_SIZE / 8];
+} kdf_context_t;
+
+void kdf_context_init(kdf_context_t * const context, const uint8_t * const key, const unsigned key_len);
+
+/* Returns context, set up again only if it was not set up for this key. */
+const kdf_context_t *kdf_context_for_key(kdf_context_t * const context, const uint8_t * const key, const unsigned key_len);
+
+void kdf_with_context(const kdf_context_t * const context,
+                      const uint8_t * const s,
+                      const unsigned s_len,
+                      uint8_t * const out,
+                      const unsigned out_len);
+
+int derive_keNB_with_context(const kdf_context_t * const kasme_context, const uint32_t nas_count, uint8_t *keNB);
+
+int derive_key_nas_with_context(const kdf_context_t * const kasme_context, algorithm_type_dist_t nas_alg_type, uint8_t nas_enc_alg_id, uint8_t *knas);
+
+int derive_nh_with_context(const kdf_context_t * const kasme_context, uint8_t * nh);
+
+/* K NASint, K NASenc and, if keNB is not NULL, KeNB from the same K ASME. */
+int derive_keys_nas_enb_with_context(const kdf_context_t * const kasme_context,
+                                     uint8_t nas_int_alg_id, uint8_t nas_enc_alg_id, const uint32_t nas_count,
+                                     uint8_t *knas_int, uint8_t *knas_enc, uint8_t *keNB);
+
 #define derive_key_nas_enc(aLGiD, kASME, kNAS)  \
     derive_key_nas(NAS_ENC_ALG, aLGiD, kASME, kNAS)
 
@@ -74,6 +109,34 @@ typedef struct {
   uint32_t  blength;
 } nas_stream_cipher_t;
 
+/* Key dependent state of the NAS stream algorithms, set up once per K NASenc/K NASint derivation
+ * instead of on every NAS message. */
+#define NAS_STREAM_CIPHER_KEY_SIZE        16
+#define NAS_STREAM_CIPHER_AES_CTX_SIZE    256   /* bytes, >= nettle_aes128.context_size */
+typedef struct nas_stream_cipher_context_s {
+  bool      initialized;
+  uint8_t   key[NAS_STREAM_CIPHER_KEY_SIZE];
+  uint32_t  snow3g_key[4];                      /* EEA1/EIA1: key words loaded in SNOW 3G */
+  uint64_t  aes[NAS_STREAM_CIPHER_AES_CTX_SIZE / 8]; /* EEA2/EIA2: AES-128 encryption key schedule */
+  uint8_t   cmac_k1[16];                        /* EIA2: CMAC subkeys */
+  uint8_t   cmac_k2[16];
+} nas_stream_cipher_context_t;
+
+void nas_stream_cipher_context_init(nas_stream_cipher_context_t * const context, const uint8_t * const key, const uint32_t key_length);
+
+/* Returns context, set up again only if it was not set up for this key. */
+const nas_stream_cipher_context_t *nas_stream_cipher_context_for_key(nas_stream_cipher_context_t * const context, const uint8_t * const key, const uint32_t key_length);
+
+/* The *_with_context functions use the key state of context instead of stream_cipher->key, do not allocate
+ * and do not modify stream_cipher->message, out may be stream_cipher->message (in place). */
+int nas_stream_encrypt_eea1_with_context(const nas_stream_cipher_context_t * const context, const nas_stream_cipher_t * const stream_cipher, uint8_t * const out);
+
+int nas_stream_encrypt_eia1_with_context(const nas_stream_cipher_context_t * const context, const nas_stream_cipher_t * const stream_cipher, uint8_t out[4]);
+
+int nas_stream_encrypt_eea2_with_context(const nas_stream_cipher_context_t * const context, const nas_stream_cipher_t * const stream_cipher, uint8_t * const out);
+
+int nas_stream_encrypt_eia2_with_context(const nas_stream_cipher_context_t * const context, const nas_stream_cipher_t * const stream_cipher, uint8_t out[4]);
+
 int nas_stream_encrypt_eea1(nas_stream_cipher_t * const stream_cipher, uint8_t * const out);
 
 int nas_stream_encrypt_eia1(nas_stream_cipher_t * const stream_cipher, uint8_t const out[4]);
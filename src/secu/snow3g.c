@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "rijndael.h"
 #include "snow3g.h"
@@ -53,6 +54,10 @@ void                                    snow3g_initialize (
   uint32_t k[4],
   uint32_t IV[4],
   snow_3g_context_t * snow_3g_context_pP);
+void                                    snow3g_continue_key_stream (
+  uint32_t n,
+  uint32_t * ks,
+  snow_3g_context_t * snow_3g_context_pP);
 void                                    snow3g_generate_key_stream (
   uint32_t n,
   uint32_t * ks,
@@ -125,6 +130,54 @@ _DIValpha (
   return ((((uint32_t) _MULxPOW (c, 16, 0xa9)) << 24) | (((uint32_t) _MULxPOW (c, 39, 0xa9)) << 16) | (((uint32_t) _MULxPOW (c, 6, 0xa9)) << 8) | (((uint32_t) _MULxPOW (c, 64, 0xa9))));
 }
 
+/* MULalpha and DIValpha of every byte, computed once: both are used at each clock of the LFSR,
+   33 clocks per NAS message only for the initialization.
+*/
+static uint32_t                         _MULalpha_table[256];
+static uint32_t                         _DIValpha_table[256];
+static pthread_once_t                   _tables_once = PTHREAD_ONCE_INIT;
+
+/* S1 and S2 of a word are the xor of the contributions of its 4 bytes, one table per byte position:
+   the FSM is clocked once per keystream word and 32 times for the initialization.
+*/
+static uint32_t                         _S1_table[4][256];
+static uint32_t                         _S2_table[4][256];
+
+static void
+_snow3g_init_tables (
+  void)
+{
+  for (int c = 0; c < 256; c++) {
+    _MULalpha_table[c] = _MULalpha ((uint8_t) c);
+    _DIValpha_table[c] = _DIValpha ((uint8_t) c);
+    for (int b = 0; b < 4; b++) {
+      _S1_table[b][c] = _S1 ((uint32_t) c << (24 - 8 * b));
+      _S2_table[b][c] = _S2 ((uint32_t) c << (24 - 8 * b));
+    }
+  }
+  /* _S1(0), _S2(0) are not 0: keep them once, in the table of byte 0 only */
+  for (int c = 0; c < 256; c++) {
+    for (int b = 1; b < 4; b++) {
+      _S1_table[b][c] ^= _S1 (0);
+      _S2_table[b][c] ^= _S2 (0);
+    }
+  }
+}
+
+static inline uint32_t
+_S1_fast (
+  uint32_t w)
+{
+  return _S1_table[0][w >> 24] ^ _S1_table[1][(w >> 16) & 0xff] ^ _S1_table[2][(w >> 8) & 0xff] ^ _S1_table[3][w & 0xff];
+}
+
+static inline uint32_t
+_S2_fast (
+  uint32_t w)
+{
+  return _S2_table[0][w >> 24] ^ _S2_table[1][(w >> 16) & 0xff] ^ _S2_table[2][(w >> 8) & 0xff] ^ _S2_table[3][w & 0xff];
+}
+
 /* The 32x32-bit S-Box S1
   Input: a 32-bit input.
   Output: a 32-bit output of S1 box.
@@ -201,7 +254,7 @@ _snow3g_clock_LFSR_initialization_mode (
   snow_3g_context_t * s3g_ctx_pP)
 {
   uint32_t                                v = (((s3g_ctx_pP->LFSR_S0 << 8) & 0xffffff00) ^
-                                               (_MULalpha ((uint8_t) ((s3g_ctx_pP->LFSR_S0 >> 24) & 0xff))) ^ (s3g_ctx_pP->LFSR_S2) ^ ((s3g_ctx_pP->LFSR_S11 >> 8) & 0x00ffffff) ^ (_DIValpha ((uint8_t) ((s3g_ctx_pP->LFSR_S11) & 0xff))) ^ (F)
+                                               (_MULalpha_table[(uint8_t) ((s3g_ctx_pP->LFSR_S0 >> 24) & 0xff)]) ^ (s3g_ctx_pP->LFSR_S2) ^ ((s3g_ctx_pP->LFSR_S11 >> 8) & 0x00ffffff) ^ (_DIValpha_table[(uint8_t) ((s3g_ctx_pP->LFSR_S11) & 0xff)]) ^ (F)
     );
 
   s3g_ctx_pP->LFSR_S0 = s3g_ctx_pP->LFSR_S1;
@@ -231,8 +284,8 @@ _snow3g_clock_LFSR_key_stream_mode (
   snow_3g_context_t * snow_3g_context_pP)
 {
   uint32_t                                v = (((snow_3g_context_pP->LFSR_S0 << 8) & 0xffffff00) ^
-                                               (_MULalpha ((uint8_t) ((snow_3g_context_pP->LFSR_S0 >> 24) & 0xff))) ^
-                                               (snow_3g_context_pP->LFSR_S2) ^ ((snow_3g_context_pP->LFSR_S11 >> 8) & 0x00ffffff) ^ (_DIValpha ((uint8_t) ((snow_3g_context_pP->LFSR_S11) & 0xff)))
+                                               (_MULalpha_table[(uint8_t) ((snow_3g_context_pP->LFSR_S0 >> 24) & 0xff)]) ^
+                                               (snow_3g_context_pP->LFSR_S2) ^ ((snow_3g_context_pP->LFSR_S11 >> 8) & 0x00ffffff) ^ (_DIValpha_table[(uint8_t) ((snow_3g_context_pP->LFSR_S11) & 0xff)])
     );
 
   snow_3g_context_pP->LFSR_S0 = snow_3g_context_pP->LFSR_S1;
@@ -266,8 +319,8 @@ _snow3g_clock_fsm (
   uint32_t                                F = ((snow_3g_context_pP->LFSR_S15 + snow_3g_context_pP->FSM_R1) & 0xffffffff) ^ snow_3g_context_pP->FSM_R2;
   uint32_t                                r = (snow_3g_context_pP->FSM_R2 + (snow_3g_context_pP->FSM_R3 ^ snow_3g_context_pP->LFSR_S5)) & 0xffffffff;
 
-  snow_3g_context_pP->FSM_R3 = _S2 (snow_3g_context_pP->FSM_R2);
-  snow_3g_context_pP->FSM_R2 = _S1 (snow_3g_context_pP->FSM_R1);
+  snow_3g_context_pP->FSM_R3 = _S2_fast (snow_3g_context_pP->FSM_R2);
+  snow_3g_context_pP->FSM_R2 = _S1_fast (snow_3g_context_pP->FSM_R1);
   snow_3g_context_pP->FSM_R1 = r;
   return F;
 }
@@ -288,6 +341,7 @@ snow3g_initialize (
   uint8_t                                 i = 0;
   uint32_t                                F = 0x0;
 
+  pthread_once (&_tables_once, _snow3g_init_tables);
   snow_3g_context_pP->LFSR_S15 = k[3] ^ IV[0];
   snow_3g_context_pP->LFSR_S14 = k[2];
   snow_3g_context_pP->LFSR_S13 = k[1];
@@ -328,11 +382,24 @@ snow3g_generate_key_stream (
   uint32_t * ks,
   snow_3g_context_t * snow_3g_context_pP)
 {
-  uint32_t                                t = 0;
-  uint32_t                                F = 0x0;
-
   _snow3g_clock_fsm (snow_3g_context_pP);       /* Clock FSM once. Discard the output. */
   _snow3g_clock_LFSR_key_stream_mode (snow_3g_context_pP);      /* Clock LFSR in keystream mode once. */
+  snow3g_continue_key_stream (n, ks, snow_3g_context_pP);
+}
+
+/*  Generation of the next words of Keystream, after snow3g_generate_key_stream().
+    input n: number of 32-bit words of keystream.
+    input z: space for the generated keystream.
+*/
+
+void
+snow3g_continue_key_stream (
+  uint32_t n,
+  uint32_t * ks,
+  snow_3g_context_t * snow_3g_context_pP)
+{
+  uint32_t                                t = 0;
+  uint32_t                                F = 0x0;
 
   for (t = 0; t < n; t++) {
     F = _snow3g_clock_fsm (snow_3g_context_pP); /* STEP 1 */
@@ -74,4 +74,9 @@ void snow3g_initialize(uint32_t k[4], uint32_t IV[4], snow_3g_context_t *snow_3g
 
 void snow3g_generate_key_stream(uint32_t n, uint32_t *z, snow_3g_context_t *snow_3g_context_pP);
 
+/* Generation of the next n words of Keystream, after snow3g_generate_key_stream(), so that a long
+* keystream can be produced in small chunks.
+*/
+void snow3g_continue_key_stream(uint32_t n, uint32_t *z, snow_3g_context_t *snow_3g_context_pP);
+
 #endif
@@ -51,6 +51,9 @@
 #include "async_system.h"
 #include "common_defs.h"
 #include "pgw_pcef_emulation.h"
+#if ENABLE_LIBGTPNL
+#include "gtp_nft_marking.h"
+#endif
 #include "spgw_config.h"
 
 #ifdef __cplusplus
@@ -70,18 +73,19 @@ void pgw_config_init (pgw_config_t * config_pP)
 {
   memset ((char *)config_pP, 0, sizeof (*config_pP));
   pthread_rwlock_init (&config_pP->rw_lock, NULL);
-  STAILQ_INIT (&config_pP->ipv4_pool_list);
 }
 
 //------------------------------------------------------------------------------
 int pgw_config_process (pgw_config_t * config_pP)
 {
   struct in_addr                          addr_cur;
-  conf_ipv4_list_elm_t                   *ip4_ref = NULL;
 
 #if ENABLE_LIBGTPNL
-  async_system_command (TASK_ASYNC_SYSTEM, PGW_ABORT_ON_ERROR, "iptables -t mangle -F OUTPUT");
-  async_system_command (TASK_ASYNC_SYSTEM, PGW_ABORT_ON_ERROR, "iptables -t mangle -F POSTROUTING");
+  // PCC rules and bearer marks, (re)created empty
+  if (RETURNok != gtp_nft_marking_init ("gtp0")) {
+    OAI_FPRINTF_ERR("CRITICAL: Failed to create nftables table %s\n", GTP_NFT_TABLE);
+    return RETURNerror;
+  }
 
   if (config_pP->masquerade_SGI) {
     async_system_command (TASK_ASYNC_SYSTEM, PGW_ABORT_ON_ERROR, "iptables -t nat -F PREROUTING");
@@ -114,19 +118,17 @@ int pgw_config_process (pgw_config_t * config_pP)
     config_pP->ue_pool_network[i].s_addr = htonl(network_hbo);
     config_pP->ue_pool_netmask[i].s_addr = htonl(netmask_hbo);
 
+    // The UE address pool is built from the ranges (pgw_load_pool_ip_addresses()), no per address element here
     //Any math should be applied onto host byte order i.e. ntohl()
     addr_cur.s_addr = config_pP->ue_pool_range_low[i].s_addr;
-    while (htonl(addr_cur.s_addr) <=  htonl(config_pP->ue_pool_range_high[i].s_addr)) {
-      ip4_ref = calloc (1, sizeof (conf_ipv4_list_elm_t));
-      ip4_ref->addr.s_addr = addr_cur.s_addr;
-      STAILQ_INSERT_TAIL (&config_pP->ipv4_pool_list, ip4_ref, ipv4_entries);
-
-      if (config_pP->arp_ue_linux) {
+    while ((config_pP->arp_ue_linux) && (ntohl(addr_cur.s_addr) <=  ntohl(config_pP->ue_pool_range_high[i].s_addr))) {
 #if ENABLE_LIBGTPNL
-         async_system_command (TASK_ASYNC_SYSTEM, PGW_ABORT_ON_ERROR, "arp -nDs %s %s pub", inet_ntoa(ip4_ref->addr), bdata(config_pP->ipv4.if_name_SGI));
+      async_system_command (TASK_ASYNC_SYSTEM, PGW_ABORT_ON_ERROR, "arp -nDs %s %s pub", inet_ntoa(addr_cur), bdata(config_pP->ipv4.if_name_SGI));
 #else
-         async_system_command (TASK_ASYNC_SYSTEM, PGW_ABORT_ON_ERROR, "arp -nDs %s %s pub", inet_ntoa(ip4_ref->addr), bdata(config_pP->ovs_config.bridge_name));
+      async_system_command (TASK_ASYNC_SYSTEM, PGW_ABORT_ON_ERROR, "arp -nDs %s %s pub", inet_ntoa(addr_cur), bdata(config_pP->ovs_config.bridge_name));
 #endif
+      if (0xFFFFFFFF == ntohl(addr_cur.s_addr)) {
+        break;
       }
       addr_cur.s_addr = htonl( ntohl(addr_cur.s_addr) + 1 );
     }
@@ -91,11 +91,6 @@ extern "C" {
 #define PGW_MAX_ALLOCATED_PDN_ADDRESSES 1024
 
 
-typedef struct conf_ipv4_list_elm_s {
-  STAILQ_ENTRY(conf_ipv4_list_elm_s) ipv4_entries;
-  struct in_addr  addr;
-} conf_ipv4_list_elm_t;
-
 typedef struct sgi_arp_boot_cache_s {
 #define PGW_ARP_BOOT_CACHE_NUM_ENTRIES_MAX 16
   struct in_addr   ip[PGW_ARP_BOOT_CACHE_NUM_ENTRIES_MAX];
@@ -175,8 +170,6 @@ typedef struct pgw_config_s {
 #if ENABLE_OPENFLOW
   spgw_ovs_config_t ovs_config;
 #endif
-
-  STAILQ_HEAD(ipv4_pool_head_s, conf_ipv4_list_elm_s) ipv4_pool_list;
 } pgw_config_t;
 
 
@@ -26,6 +26,7 @@
   \email: lionel.gauthier@eurecom.fr
 */
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <errno.h>
 #include <string.h>
@@ -41,6 +42,7 @@
 #include "conversions.h"
 #include "hashtable.h"
 #include "obj_hashtable.h"
+#include "ipv4_pool.h"
 #include "common_defs.h"
 #include "intertask_interface.h"
 #include "msc.h"
@@ -56,8 +58,6 @@
 extern "C" {
 #endif
 
-//#define PGW_LITE_FREE_ADDR_POOL_CONFIG 1
-
 extern pgw_app_t                        pgw_app;
 
 
@@ -66,80 +66,35 @@ void
 pgw_load_pool_ip_addresses (
   void)
 {
-  struct conf_ipv4_list_elm_s   *conf_ipv4_p = NULL;
-  struct ipv4_list_elm_s        *ipv4_p = NULL;
-  //struct conf_ipv6_list_elm_s   *conf_ipv6_p = NULL;
-  //struct ipv6_list_elm_s        *ipv6_p = NULL;
-  //char                           print_buffer[INET6_ADDRSTRLEN];
-
-  STAILQ_INIT (&pgw_app.ipv4_list_free);
-  STAILQ_INIT (&pgw_app.ipv4_list_allocated);
-  STAILQ_FOREACH (conf_ipv4_p, &spgw_config.pgw_config.ipv4_pool_list, ipv4_entries) {
-    ipv4_p = calloc (1, sizeof (struct ipv4_list_elm_s));
-    ipv4_p->addr.s_addr = conf_ipv4_p->addr.s_addr;
-    STAILQ_INSERT_TAIL (&pgw_app.ipv4_list_free, ipv4_p, ipv4_entries);
-    //SPGW_APP_DEBUG("Loaded IPv4 PAA address in pool: %s\n",
-    //        inet_ntoa(conf_ipv4_p->addr));
-  }
-
-//  STAILQ_FOREACH (conf_ipv6_p, &spgw_config.pgw_config.pgw_lite_ipv6_pool_list, ipv6_entries) {
-//    ipv6_p = calloc (1, sizeof (struct pgw_lite_ipv6_list_elm_s));
-//    ipv6_p->addr = conf_ipv6_p->addr;
-//    ipv6_p->prefix_len = conf_ipv6_p->prefix_len;
-//    ipv6_p->num_allocated = 0;
-//    STAILQ_INSERT_TAIL (&pgw_app.pgw_lite_ipv6_list_free, ipv6_p, ipv6_entries);
-//
-//    if (inet_ntop (AF_INET6, &ipv6_p->addr, print_buffer, INET6_ADDRSTRLEN) == NULL) {
-//      OAILOG_ERROR (LOG_SPGW_APP, "Could not Load IPv6 PAA address in pool: %s\n", strerror (errno));
-//    }                           /*else {
-//                                 *
-//                                 * SPGW_APP_DEBUG("Loaded IPv6 PAA prefix in pool: %s\n",print_buffer);
-//                                 * } */
-//  }
-#if PGW_LITE_FREE_ADDR_POOL_CONFIG
-
-  while ((conf_ipv4_p = STAILQ_FIRST (&spgw_config.pgw_config.ipv4_pool_list))) {
-    STAILQ_REMOVE_HEAD (&spgw_config.pgw_config.ipv4_pool_list, ipv4_entries);
-    free_wrapper ((void **) &conf_ipv4_p);
-  }
-
-#endif
+  pgw_app.ipv4_pool = ipv4_pool_create (spgw_config.pgw_config.num_ue_pool,
+      spgw_config.pgw_config.ue_pool_range_low, spgw_config.pgw_config.ue_pool_range_high, true);
+  AssertFatal (pgw_app.ipv4_pool, "Bad UE IPv4 address pools configuration (empty or overlapping ranges)");
+  OAILOG_INFO (LOG_SPGW_APP, "Loaded %"PRIu64" IPv4 PAA addresses in %d pools, %zu bytes\n",
+      pgw_app.ipv4_pool->num_addresses, spgw_config.pgw_config.num_ue_pool, ipv4_pool_memory (pgw_app.ipv4_pool));
 }
 
-
+void
+pgw_unload_pool_ip_addresses (
+  void)
+{
+  ipv4_pool_destroy (pgw_app.ipv4_pool);
+  pgw_app.ipv4_pool = NULL;
+}
 
 int
 pgw_get_free_ipv4_paa_address (
+  const imsi64_t imsi64,
   struct in_addr *const addr_pP)
 {
-  struct ipv4_list_elm_s        *ipv4_p = NULL;
-
-  if (STAILQ_EMPTY (&pgw_app.ipv4_list_free)) {
-    addr_pP->s_addr = INADDR_ANY;
-    return RETURNerror;
-  }
-
-  ipv4_p = STAILQ_FIRST (&pgw_app.ipv4_list_free);
-  STAILQ_REMOVE (&pgw_app.ipv4_list_free, ipv4_p, ipv4_list_elm_s, ipv4_entries);
-  STAILQ_INSERT_TAIL (&pgw_app.ipv4_list_allocated, ipv4_p, ipv4_entries);
-  addr_pP->s_addr = ipv4_p->addr.s_addr;
-  return RETURNok;
+  return ipv4_pool_alloc (pgw_app.ipv4_pool, imsi64, addr_pP);
 }
 
 int
 pgw_release_free_ipv4_paa_address (
+  const imsi64_t imsi64,
   const struct in_addr *const addr_pP)
 {
-  struct ipv4_list_elm_s        *ipv4_p = NULL;
-
-  STAILQ_FOREACH (ipv4_p, &pgw_app.ipv4_list_allocated, ipv4_entries) {
-    if (ipv4_p->addr.s_addr == addr_pP->s_addr) {
-      STAILQ_REMOVE (&pgw_app.ipv4_list_allocated, ipv4_p, ipv4_list_elm_s, ipv4_entries);
-      STAILQ_INSERT_HEAD (&pgw_app.ipv4_list_free, ipv4_p, ipv4_entries);
-      return RETURNok;
-    }
-  }
-  return RETURNerror;
+  return ipv4_pool_release (pgw_app.ipv4_pool, imsi64, *addr_pP);
 }
 
 //int get_assigned_ipv4_block(const int block, struct in_addr * const netaddr, uint32_t * const prefix)
@@ -51,7 +51,9 @@
 #include "sgw_context_manager.h"
 #include "pgw_procedures.h"
 #include "sgw.h"
-#include "async_system.h"
+#if ENABLE_LIBGTPNL
+#include "gtp_nft_marking.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -272,75 +274,37 @@ void pgw_pcef_emulation_apply_rule(const sdf_id_t sdf_id, const pgw_config_t * c
   }
 }
 
+#if ENABLE_LIBGTPNL
 //------------------------------------------------------------------------------
-void pgw_pcef_emulation_apply_sdf_filter(sdf_filter_t   * const sdf_f, const sdf_id_t sdf_id, const pgw_config_t * const pgw_config_p)
-{
-  if ((TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == sdf_f->direction)  || (TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == sdf_f->direction)) {
-    bstring filter = pgw_pcef_emulation_packet_filter_2_iptable_string(&sdf_f->packetfiltercontents, sdf_f->direction);
-
-    bstring marking_command = NULL;
-    if ((TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG | TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) & sdf_f->packetfiltercontents.flags) {
-      marking_command = bformat("iptables -I POSTROUTING -t mangle  %s -j MARK --set-mark %d",  bdata(filter), sdf_id);
-    } else {
-      //marking_command = bformat("iptables -I PREROUTING -t mangle --in-interface %s --dest %"PRIu8".%"PRIu8".%"PRIu8".%"PRIu8"/%"PRIu8" %s -j MARK --set-mark %d",
-      marking_command = bformat("iptables -I POSTROUTING -t mangle  -m iprange --dst-range %s-%s %s -j MARK --set-mark %d",
-          inet_ntoa(pgw_config_p->ue_pool_range_low[0]),
-          inet_ntoa(pgw_config_p->ue_pool_range_high[0]), bdata(filter), sdf_id);
-    }
-    bdestroy_wrapper(&filter);
-    async_system_command (TASK_ASYNC_SYSTEM, false, bdata(marking_command));
-    bdestroy_wrapper(&marking_command);
-
-    // for UE <-> PGW traffic
-    filter = pgw_pcef_emulation_packet_filter_2_iptable_string(&sdf_f->packetfiltercontents, sdf_f->direction);
-
-    marking_command = NULL;
-    if ((TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG | TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) & sdf_f->packetfiltercontents.flags) {
-      marking_command = bformat("iptables -I OUTPUT -t mangle  %s -j MARK --set-mark %d",  bdata(filter), sdf_id);
-    } else {
-      marking_command = bformat("iptables -I OUTPUT -t mangle  -m iprange --dst-range %s-%s %s -j MARK --set-mark %d",
-          inet_ntoa(pgw_config_p->ue_pool_range_low[0]),
-          inet_ntoa(pgw_config_p->ue_pool_range_high[0]), bdata(filter), sdf_id);
-    }
-    bdestroy_wrapper(&filter);
-    async_system_command (TASK_ASYNC_SYSTEM, false, bdata(marking_command));
-    bdestroy_wrapper(&marking_command);
-
-
-  }
-}
-
-//------------------------------------------------------------------------------
-bstring pgw_pcef_emulation_packet_filter_2_iptable_string(packet_filter_contents_t * const packetfiltercontents, uint8_t direction)
+static void pgw_pcef_emulation_packet_filter_2_nft_match(const packet_filter_contents_t * const packetfiltercontents, const uint8_t direction, gtp_nft_match_t * const match)
 {
-  bstring bstr = bfromcstralloc(64, " ");
-
+  memset(match, 0, sizeof(*match));
   if ((TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == direction) || (TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == direction)){
     if (TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG & packetfiltercontents->flags) {
-      bformata(bstr, "  --destination %d.%d.%d.%d/%d.%d.%d.%d",
-        packetfiltercontents->ipv4remoteaddr[0].addr, packetfiltercontents->ipv4remoteaddr[1].addr,
-        packetfiltercontents->ipv4remoteaddr[2].addr, packetfiltercontents->ipv4remoteaddr[3].addr,
-        packetfiltercontents->ipv4remoteaddr[0].mask, packetfiltercontents->ipv4remoteaddr[1].mask,
-        packetfiltercontents->ipv4remoteaddr[2].mask, packetfiltercontents->ipv4remoteaddr[3].mask);
-    } else {
-      bformata(bstr, " --source %d.%d.%d.%d/%d.%d.%d.%d",
-        packetfiltercontents->ipv4remoteaddr[0].addr, packetfiltercontents->ipv4remoteaddr[1].addr,
-        packetfiltercontents->ipv4remoteaddr[2].addr, packetfiltercontents->ipv4remoteaddr[3].addr,
-        packetfiltercontents->ipv4remoteaddr[0].mask, packetfiltercontents->ipv4remoteaddr[1].mask,
-        packetfiltercontents->ipv4remoteaddr[2].mask, packetfiltercontents->ipv4remoteaddr[3].mask);
+      uint8_t * const addr = (uint8_t *)&match->daddr.s_addr;
+      uint8_t * const mask = (uint8_t *)&match->daddr_mask.s_addr;
+
+      for (int i = 0; i < 4; i++) {
+        addr[i] = packetfiltercontents->ipv4remoteaddr[i].addr;
+        mask[i] = packetfiltercontents->ipv4remoteaddr[i].mask;
+      }
+      match->flags |= GTP_NFT_MATCH_DADDR;
     }
   }
   if (TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG & packetfiltercontents->flags) {
     AssertFatal(0, "TODO"); // we have time
   }
   if (TRAFFIC_FLOW_TEMPLATE_PROTOCOL_NEXT_HEADER_FLAG & packetfiltercontents->flags) {
-    bformata(bstr, " --protocol %u", packetfiltercontents->protocolidentifier_nextheader);
+    match->protocol = packetfiltercontents->protocolidentifier_nextheader;
+    match->flags |= GTP_NFT_MATCH_PROTOCOL;
   }
   if (TRAFFIC_FLOW_TEMPLATE_SINGLE_LOCAL_PORT_FLAG & packetfiltercontents->flags) {
     if ((TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == direction) || (TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == direction)){
-      bformata(bstr, " --destination-port %" PRIu16" ", packetfiltercontents->singlelocalport);
+      match->dport = packetfiltercontents->singlelocalport;
+      match->flags |= GTP_NFT_MATCH_DPORT;
     } else if (TRAFFIC_FLOW_TEMPLATE_UPLINK_ONLY == direction) {
-      bformata(bstr, " --source-port %" PRIu16" ", packetfiltercontents->singlelocalport);
+      match->sport = packetfiltercontents->singlelocalport;
+      match->flags |= GTP_NFT_MATCH_SPORT;
     }
   }
   if (TRAFFIC_FLOW_TEMPLATE_LOCAL_PORT_RANGE_FLAG & packetfiltercontents->flags) {
@@ -348,25 +312,53 @@ bstring pgw_pcef_emulation_packet_filter_2_iptable_string(packet_filter_contents
   }
   if (TRAFFIC_FLOW_TEMPLATE_SINGLE_REMOTE_PORT_FLAG & packetfiltercontents->flags) {
     if ((TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == direction) || (TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == direction)){
-      bformata(bstr, " --source-port %" PRIu16" ", packetfiltercontents->singleremoteport);
+      match->sport = packetfiltercontents->singleremoteport;
+      match->flags |= GTP_NFT_MATCH_SPORT;
     } else if (TRAFFIC_FLOW_TEMPLATE_UPLINK_ONLY == direction) {
-      bformata(bstr, " --destination-port %" PRIu16" ", packetfiltercontents->singleremoteport);
+      match->dport = packetfiltercontents->singleremoteport;
+      match->flags |= GTP_NFT_MATCH_DPORT;
     }
   }
   if (TRAFFIC_FLOW_TEMPLATE_REMOTE_PORT_RANGE_FLAG & packetfiltercontents->flags) {
     AssertFatal(0, "TODO REMOTE_PORT_RANGE");
   }
   if (TRAFFIC_FLOW_TEMPLATE_SECURITY_PARAMETER_INDEX_FLAG & packetfiltercontents->flags) {
-    bformata(bstr, " -m esp --espspi %" PRIu32" ", packetfiltercontents->securityparameterindex);
+    match->spi = packetfiltercontents->securityparameterindex;
+    match->flags |= GTP_NFT_MATCH_SPI;
   }
   if (TRAFFIC_FLOW_TEMPLATE_TYPE_OF_SERVICE_TRAFFIC_CLASS_FLAG & packetfiltercontents->flags) {
     // TODO mask
-    bformata(bstr, " -m tos --tos 0x%02X", packetfiltercontents->typdeofservice_trafficclass.value);
+    match->tos = packetfiltercontents->typdeofservice_trafficclass.value;
+    match->flags |= GTP_NFT_MATCH_TOS;
   }
   if (TRAFFIC_FLOW_TEMPLATE_FLOW_LABEL_FLAG & packetfiltercontents->flags) {
     AssertFatal(0, "TODO"); // we have time
   }
-  return bstr;
+}
+#endif
+
+//------------------------------------------------------------------------------
+void pgw_pcef_emulation_apply_sdf_filter(sdf_filter_t   * const sdf_f, const sdf_id_t sdf_id, const pgw_config_t * const pgw_config_p)
+{
+#if ENABLE_LIBGTPNL
+  if ((TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == sdf_f->direction)  || (TRAFFIC_FLOW_TEMPLATE_DOWNLINK_ONLY == sdf_f->direction)) {
+    gtp_nft_match_t match = {0};
+
+    pgw_pcef_emulation_packet_filter_2_nft_match(&sdf_f->packetfiltercontents, sdf_f->direction, &match);
+    if (!((TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG | TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) & sdf_f->packetfiltercontents.flags)) {
+      match.flags |= GTP_NFT_MATCH_DADDR_RANGE;
+      match.daddr_low = pgw_config_p->ue_pool_range_low[0];
+      match.daddr_high = pgw_config_p->ue_pool_range_high[0];
+    }
+    if (RETURNok != gtp_nft_marking_add_sdf_rule (GTP_NFT_CHAIN_POSTROUTING, &match, sdf_id)) {
+      OAILOG_ERROR (LOG_SPGW_APP, "Cannot apply SDF filter %u of SDF %u\n", sdf_f->identifier, sdf_id);
+    }
+    // for UE <-> PGW traffic
+    if (RETURNok != gtp_nft_marking_add_sdf_rule (GTP_NFT_CHAIN_OUTPUT, &match, sdf_id)) {
+      OAILOG_ERROR (LOG_SPGW_APP, "Cannot apply SDF filter %u of SDF %u for UE <-> PGW traffic\n", sdf_f->identifier, sdf_id);
+    }
+  }
+#endif
 }
 
 //------------------------------------------------------------------------------
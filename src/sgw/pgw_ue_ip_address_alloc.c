@@ -31,20 +31,31 @@
 #include <stdbool.h>
 #include <string.h>
 #include <netinet/in.h>
+#include "common_types.h"
+#include "conversions.h"
 #include "pgw_lite_paa.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static imsi64_t imsi_to_imsi64(const char *imsi) {
+  imsi64_t imsi64 = INVALID_IMSI64;
+
+  if ((imsi) && (1 != IMSI_STRING_TO_IMSI64(imsi, &imsi64))) {
+    imsi64 = INVALID_IMSI64;
+  }
+  return imsi64;
+}
+
 int allocate_ue_ipv4_address(const char *imsi, struct in_addr *addr) {
-  // Call PGW IP Address allocator 
-  return pgw_get_free_ipv4_paa_address (addr); 
+  // Call PGW IP Address allocator, an IMSI gets back its previous address if still free
+  return pgw_get_free_ipv4_paa_address (imsi_to_imsi64(imsi), addr);
 }
 
 int release_ue_ipv4_address(const char *imsi, struct in_addr *addr) {
   // Release IP address back to PGW IP Address allocator 
-  return pgw_release_free_ipv4_paa_address (addr); 
+  return pgw_release_free_ipv4_paa_address (imsi_to_imsi64(imsi), addr);
 }
 
 void pgw_ip_address_pool_init(void) {
@@ -52,6 +63,10 @@ void pgw_ip_address_pool_init(void) {
   return;
 }
 
+void pgw_ip_address_pool_exit(void) {
+  pgw_unload_pool_ip_addresses ();
+}
+
 #ifdef __cplusplus
 }
 #endif
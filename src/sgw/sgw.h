@@ -35,6 +35,8 @@
 #include "queue.h"
 #include "hashtable.h"
 #include "obj_hashtable.h"
+#include "ipv4_pool.h"
+#include "teid_pool.h"
 
 #include "commonDef.h"
 #include "common_types.h"
@@ -46,6 +48,8 @@
 extern "C" {
 #endif
 
+#define SGW_UE_IP_HTBL_SIZE_MAX           (1 << 20)     // initial buckets of the UE IP address indexes, they grow beyond
+
 typedef struct sgw_app_s {
 
   bstring        sgw_if_name_S1u_S12_S4_up;
@@ -56,11 +60,17 @@ typedef struct sgw_app_s {
 
   struct in_addr sgw_ip_address_S5_S8_up; // unused now
 
+  // S11 S-GW local teids, unique, reused only after quarantine
+  teid_pool_t     *s11_teid_pool;
+
   // key is S11 S-GW local teid, value is S11 tunnel id pair
   hash_table_ts_t *s11teid2mme_hashtable;
 
-  // key is paa, value is S11 s-gw local teid
-  obj_hash_table_uint64_t *ip2s11teid;
+  // key is the paa IPv4 address, value is S11 s-gw local teid
+  hash_table_ts_t *ue_ipv4_to_s11teid;
+
+  // key is the /64 prefix of the paa IPv6 address, value is S11 s-gw local teid
+  hash_table_ts_t *ue_ipv6_prefix_to_s11teid;
 
   // key is S1-U S-GW local teid
   //hash_table_t *s1uteid2enb_hashtable;
@@ -73,8 +83,8 @@ typedef struct sgw_app_s {
 
 
 typedef struct pgw_app_s {
-  STAILQ_HEAD(ipv4_list_free_head_s,     ipv4_list_elm_s)  ipv4_list_free;
-  STAILQ_HEAD(ipv4_list_allocated_head_s, ipv4_list_elm_s) ipv4_list_allocated;
+  // UE IPv4 addresses of all configured pools, one bit per address
+  ipv4_pool_t                                             *ipv4_pool;
   // TODO clarify deactivated_predefined_pcc_rules versus predefined_pcc_rules
   hash_table_ts_t                                         *deactivated_predefined_pcc_rules;
   hash_table_ts_t                                         *predefined_pcc_rules;
@@ -48,6 +48,7 @@
 #include "log.h"
 #include "intertask_interface.h"
 #include "common_defs.h"
+#include "teid_pool.h"
 #include "sgw_config.h"
 
 #ifdef __cplusplus
@@ -71,6 +72,10 @@ void sgw_config_init (sgw_config_t * config_pP)
 {
   memset(config_pP, 0, sizeof(*config_pP));
   pthread_rwlock_init (&config_pP->rw_lock, NULL);
+  config_pP->teid_config.quarantine_ms = SGW_TEID_DEFAULT_QUARANTINE_MS;
+  config_pP->teid_config.num_shards    = SGW_TEID_DEFAULT_NUM_SHARDS;
+  config_pP->itti_config.queue_size    = ITTI_QUEUE_MAX_ELEMENTS;
+  config_pP->itti_config.memory_pools.magazine_size = ITTI_MEMORY_POOLS_DEFAULT_MAGAZINE_SIZE;
 }
 //------------------------------------------------------------------------------
 int sgw_config_process (sgw_config_t * config_pP)
@@ -93,7 +98,9 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
   char                                   *S11 = NULL;
   libconfig_int                           sgw_udp_port_S1u_S12_S4_up = 2152;
   libconfig_int                           sgw_udp_port_S11 = 2123;
+  libconfig_int                           aint = 0;
   config_setting_t                       *subsetting = NULL;
+  config_setting_t                       *sub2setting = NULL;
   const char                             *astring = NULL;
   bstring                                 address = NULL;
   bstring                                 cidr = NULL;
@@ -161,6 +168,21 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
         if (!strcasecmp("yes", astring)) config_pP->log_config.color = true;
         else config_pP->log_config.color = false;
       }
+
+      if (config_setting_lookup_string (subsetting, LOG_CONFIG_STRING_BINARY, (const char **)&astring)) {
+        if (!strcasecmp("yes", astring)) config_pP->log_config.is_binary = true;
+        else config_pP->log_config.is_binary = false;
+      }
+
+      if (config_setting_lookup_string (subsetting, LOG_CONFIG_STRING_BINARY_FILE, (const char **)&astring)) {
+        if ((astring != NULL) && (astring[0])) {
+          if (config_pP->log_config.binary_output) {
+            bassigncstr(config_pP->log_config.binary_output , astring);
+          } else {
+            config_pP->log_config.binary_output = bfromcstr(astring);
+          }
+        }
+      }
       if (config_setting_lookup_string (subsetting, LOG_CONFIG_STRING_UDP_LOG_LEVEL, (const char **)&astring)) {
         config_pP->log_config.udp_log_level = OAILOG_LEVEL_STR2INT (astring);
       }
@@ -265,6 +287,56 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
         config_pP->udp_port_S1u_S12_S4_up = sgw_udp_port_S1u_S12_S4_up;
       }
     }
+
+    // TEID setting
+    subsetting = config_setting_get_member (setting_sgw, SGW_CONFIG_STRING_TEID_CONFIG);
+
+    if (subsetting) {
+      if (config_setting_lookup_int (subsetting, SGW_CONFIG_STRING_TEID_NODE_ID, &aint)) {
+        config_pP->teid_config.node_id = (uint32_t) aint;
+      }
+      if (config_setting_lookup_int (subsetting, SGW_CONFIG_STRING_TEID_NODE_ID_BITS, &aint)) {
+        config_pP->teid_config.node_id_bits = (int) aint;
+      }
+      if (config_setting_lookup_int (subsetting, SGW_CONFIG_STRING_TEID_QUARANTINE_MS, &aint)) {
+        config_pP->teid_config.quarantine_ms = (uint32_t) aint;
+      }
+      if (config_setting_lookup_int (subsetting, SGW_CONFIG_STRING_TEID_NUM_SHARDS, &aint)) {
+        config_pP->teid_config.num_shards = (int) aint;
+      }
+      AssertFatal ((config_pP->teid_config.node_id_bits >= 0) && (config_pP->teid_config.node_id_bits <= TEID_POOL_MAX_NODE_ID_BITS) &&
+          (((uint64_t)config_pP->teid_config.node_id >> config_pP->teid_config.node_id_bits) == 0),
+          "Bad TEID NODE_ID %u / NODE_ID_BITS %d\n", config_pP->teid_config.node_id, config_pP->teid_config.node_id_bits);
+    }
+
+    // ITTI setting
+    subsetting = config_setting_get_member (setting_sgw, SGW_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG);
+
+    if (subsetting) {
+      if (config_setting_lookup_int (subsetting, SGW_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE, &aint)) {
+        config_pP->itti_config.queue_size = (uint32_t) aint;
+      }
+      if (config_setting_lookup_int (subsetting, SGW_CONFIG_STRING_INTERTASK_INTERFACE_MAGAZINE_SIZE, &aint)) {
+        config_pP->itti_config.memory_pools.magazine_size = (uint32_t) aint;
+      }
+      sub2setting = config_setting_get_member (subsetting, SGW_CONFIG_STRING_INTERTASK_INTERFACE_MEMORY_POOLS);
+      if (sub2setting) {
+        int num = config_setting_length (sub2setting);
+
+        AssertFatal (MEMORY_POOLS_MAX_POOLS >= num, "Too many ITTI memory pools configured %d\n", num);
+        config_pP->itti_config.memory_pools.pools_number = num;
+        for (int i = 0; i < num; i++) {
+          config_setting_t *pool_setting = config_setting_get_elem (sub2setting, i);
+
+          AssertFatal ((pool_setting) && (config_setting_lookup_int (pool_setting, SGW_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEMS, &aint)) && (aint > 0),
+              "Missing or bad %s in ITTI memory pool %d\n", SGW_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEMS, i);
+          config_pP->itti_config.memory_pools.pools[i].items_number = (uint32_t) aint;
+          AssertFatal (config_setting_lookup_int (pool_setting, SGW_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEM_SIZE, &aint) && (aint > 0),
+              "Missing or bad %s in ITTI memory pool %d\n", SGW_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEM_SIZE, i);
+          config_pP->itti_config.memory_pools.pools[i].item_size = (uint32_t) aint;
+        }
+      }
+    }
   }
 
   config_destroy (&cfg);
@@ -290,13 +362,28 @@ void sgw_config_display (sgw_config_t * config_p)
   OAILOG_INFO (LOG_SPGW_APP, "    S11 iface ............: %s\n", bdata(config_p->ipv4.if_name_S11));
   OAILOG_INFO (LOG_SPGW_APP, "    S11 ip ...............: %s/%u\n", inet_ntoa (config_p->ipv4.S11), config_p->ipv4.netmask_S11);
   OAILOG_INFO (LOG_SPGW_APP, "    S11 port .............: %u\n", config_p->udp_port_S11);
+  OAILOG_INFO (LOG_SPGW_APP, "- TEID:\n");
+  OAILOG_INFO (LOG_SPGW_APP, "    node id ..............: %u (%d bits)\n", config_p->teid_config.node_id, config_p->teid_config.node_id_bits);
+  OAILOG_INFO (LOG_SPGW_APP, "    quarantine ...........: %u ms\n", config_p->teid_config.quarantine_ms);
+  OAILOG_INFO (LOG_SPGW_APP, "    shards ...............: %d\n", config_p->teid_config.num_shards);
   OAILOG_INFO (LOG_SPGW_APP, "- ITTI:\n");
   OAILOG_INFO (LOG_SPGW_APP, "    queue size .......: %u (bytes)\n", config_p->itti_config.queue_size);
   OAILOG_INFO (LOG_SPGW_APP, "    log file .........: %s\n", bdata(config_p->itti_config.log_file));
+  OAILOG_INFO (LOG_SPGW_APP, "    magazine size ....: %u (items per thread cache magazine)\n", config_p->itti_config.memory_pools.magazine_size);
+  if (config_p->itti_config.memory_pools.pools_number) {
+    for (int i = 0; i < config_p->itti_config.memory_pools.pools_number; i++) {
+      OAILOG_INFO (LOG_SPGW_APP, "    memory pool %d ....: %u items of %u bytes\n", i,
+          config_p->itti_config.memory_pools.pools[i].items_number, config_p->itti_config.memory_pools.pools[i].item_size);
+    }
+  } else {
+    OAILOG_INFO (LOG_SPGW_APP, "    memory pools .....: default\n");
+  }
 
   OAILOG_INFO (LOG_SPGW_APP, "- Logging:\n");
   OAILOG_INFO (LOG_SPGW_APP, "    Output ..............: %s\n", bdata(config_p->log_config.output));
   OAILOG_INFO (LOG_SPGW_APP, "    Output thread-safe...: %s\n", (config_p->log_config.is_output_thread_safe) ? "true":"false");
+  OAILOG_INFO (LOG_SPGW_APP, "    Binary records ......: %s\n", (config_p->log_config.is_binary) ? "true":"false");
+  OAILOG_INFO (LOG_SPGW_APP, "    Binary records file .: %s\n", (config_p->log_config.binary_output) ? bdata(config_p->log_config.binary_output) : "none");
   OAILOG_INFO (LOG_SPGW_APP, "    UDP log level........: %s\n", OAILOG_LEVEL_INT2STR(config_p->log_config.udp_log_level));
   OAILOG_INFO (LOG_SPGW_APP, "    GTPV1-U log level....: %s\n", OAILOG_LEVEL_INT2STR(config_p->log_config.gtpv1u_log_level));
   OAILOG_INFO (LOG_SPGW_APP, "    GTPV2-C log level....: %s\n", OAILOG_LEVEL_INT2STR(config_p->log_config.gtpv2c_log_level));
@@ -33,6 +33,7 @@
 #include "log.h"
 #include "bstrlib.h"
 #include "common_types.h"
+#include "memory_pools.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,6 +49,20 @@ extern "C" {
 #define SGW_CONFIG_STRING_SGW_INTERFACE_NAME_FOR_S11            "SGW_INTERFACE_NAME_FOR_S11"
 #define SGW_CONFIG_STRING_SGW_IPV4_ADDRESS_FOR_S11              "SGW_IPV4_ADDRESS_FOR_S11"
 #define SGW_CONFIG_STRING_SGW_UDP_PORT_FOR_S11                  "SGW_UDP_PORT_FOR_S11"
+#define SGW_CONFIG_STRING_TEID_CONFIG                           "TEID"
+#define SGW_CONFIG_STRING_TEID_NODE_ID                          "NODE_ID"
+#define SGW_CONFIG_STRING_TEID_NODE_ID_BITS                     "NODE_ID_BITS"
+#define SGW_CONFIG_STRING_TEID_QUARANTINE_MS                    "QUARANTINE_MS"
+#define SGW_CONFIG_STRING_TEID_NUM_SHARDS                       "NUM_SHARDS"
+#define SGW_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG            "INTERTASK_INTERFACE"
+#define SGW_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE        "ITTI_QUEUE_SIZE"
+#define SGW_CONFIG_STRING_INTERTASK_INTERFACE_MEMORY_POOLS      "MEMORY_POOLS"
+#define SGW_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEMS        "ITEMS"
+#define SGW_CONFIG_STRING_INTERTASK_INTERFACE_POOL_ITEM_SIZE    "ITEM_SIZE"
+#define SGW_CONFIG_STRING_INTERTASK_INTERFACE_MAGAZINE_SIZE     "MAGAZINE_SIZE"
+
+#define SGW_TEID_DEFAULT_QUARANTINE_MS                          10000
+#define SGW_TEID_DEFAULT_NUM_SHARDS                             4
 
 #define SPGW_ABORT_ON_ERROR true
 #define SPGW_WARN_ON_ERROR false
@@ -60,6 +75,7 @@ typedef struct sgw_config_s {
   struct {
     uint32_t  queue_size;
     bstring   log_file;
+    memory_pools_config_t memory_pools;
   } itti_config;
 
   struct {
@@ -80,6 +96,13 @@ typedef struct sgw_config_s {
   uint16_t     udp_port_S5_S8_cp;
   uint16_t     udp_port_S11;
 
+  struct {
+    uint32_t  node_id;          // in the node_id_bits MSB of the S11 and S1-U TEIDs of this instance
+    int       node_id_bits;
+    uint32_t  quarantine_ms;    // min time before a released TEID is reused
+    int       num_shards;
+  } teid_config;
+
   bool         local_to_eNB;
 #if (!EMBEDDED_SGW)
   log_config_t log_config;
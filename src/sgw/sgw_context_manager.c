@@ -52,6 +52,7 @@
 #include "sgw_defs.h"
 #include "sgw_context_manager.h"
 #include "sgw.h"
+#include "gtpv1u.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -173,11 +174,7 @@ sgw_get_new_S11_tunnel_id (
   void)
 //-----------------------------------------------------------------------------
 {
-  // TO DO: RANDOM
-  static teid_t                           tunnel_id = 100;
-
-  tunnel_id += 1;
-  return tunnel_id;
+  return teid_pool_alloc (sgw_app.s11_teid_pool, TEID_POOL_ANY_SHARD);
 }
 
 //-----------------------------------------------------------------------------
@@ -218,6 +215,9 @@ sgw_cm_remove_s11_tunnel (
   int                                     temp = 0;
 
   temp = hashtable_ts_free (sgw_app.s11teid2mme_hashtable, local_teid);
+  if (HASH_TABLE_OK == temp) {
+    teid_pool_release (sgw_app.s11_teid_pool, local_teid);
+  }
   return temp;
 }
 
@@ -274,58 +274,50 @@ void sgw_cm_free_pdn_connection (sgw_pdn_connection_t * pdn_connectionP)
 void sgw_free_sgw_eps_bearer_context (sgw_eps_bearer_ctxt_t ** sgw_eps_bearer_ctxt)
 {
   if (*sgw_eps_bearer_ctxt) {
-    // nothing to do actually
+    if ((*sgw_eps_bearer_ctxt)->s_gw_teid_S1u_S12_S4_up) {
+      gtpv1u_release_teid ((*sgw_eps_bearer_ctxt)->s_gw_teid_S1u_S12_S4_up);
+    }
     free_wrapper((void**) sgw_eps_bearer_ctxt);
   }
 }
 
 //-----------------------------------------------------------------------------
-int sgw_register_paging_paa(const teid_t local_s11_teid, const paa_t * const paa)
+// UE addresses are indexed as integers: the IPv4 address, the /64 prefix of the IPv6 address (unique per PDN connection)
+static inline hash_key_t sgw_ue_ipv4_key (const struct in_addr * const addr)
 {
-  char str[INET6_ADDRSTRLEN+1] = {0};
+  return (hash_key_t)addr->s_addr;
+}
 
-  switch (paa->pdn_type) {
-  case  IPv4:
-    if (inet_ntop(AF_INET, &paa->ipv4_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv4 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_insert (sgw_app.ip2s11teid, strdup(str), strlen(str), local_s11_teid)) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv4 address\n");
-      return RETURNerror;
-    }
-    OAILOG_DEBUG (LOG_SPGW_APP, "Register PAA IPv4 address for paging in sgw_app.ip2s11teid[" TEID_FMT "]=%s\n", local_s11_teid, str);
+static inline hash_key_t sgw_ue_ipv6_key (const struct in6_addr * const addr)
+{
+  uint64_t                                prefix = 0;
 
-    break;
-  case IPv6:
-    if (inet_ntop(AF_INET6, &paa->ipv6_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv6 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_insert (sgw_app.ip2s11teid, strdup(str), strlen(str), local_s11_teid)) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv6 address\n");
-      return RETURNerror;
-    }
-    break;
-  case IPv4_AND_v6:
-    if (inet_ntop(AF_INET, &paa->ipv4_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv4 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_insert (sgw_app.ip2s11teid, strdup(str), strlen(str), local_s11_teid)) {
+  memcpy (&prefix, addr->s6_addr, sizeof (prefix));
+  return (hash_key_t)prefix;
+}
+
+//-----------------------------------------------------------------------------
+int sgw_register_paging_paa(const teid_t local_s11_teid, const paa_t * const paa)
+{
+  hashtable_rc_t                          hash_rc = HASH_TABLE_OK;
+
+  if ((IPv4 == paa->pdn_type) || (IPv4_AND_v6 == paa->pdn_type)) {
+    hash_rc = hashtable_ts_insert (sgw_app.ue_ipv4_to_s11teid, sgw_ue_ipv4_key (&paa->ipv4_address), (void *)(uintptr_t)local_s11_teid);
+    if ((HASH_TABLE_OK != hash_rc) && (HASH_TABLE_INSERT_OVERWRITTEN_DATA != hash_rc)) {
       OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv4 address\n");
       return RETURNerror;
     }
-    if (inet_ntop(AF_INET6, &paa->ipv6_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv6 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_insert (sgw_app.ip2s11teid, strdup(str), strlen(str), local_s11_teid)) {
+    OAILOG_DEBUG (LOG_SPGW_APP, "Register PAA IPv4 address " IN_ADDR_FMT " for paging -> S11 teid " TEID_FMT "\n",
+        PRI_IN_ADDR (paa->ipv4_address), local_s11_teid);
+  }
+  if ((IPv6 == paa->pdn_type) || (IPv4_AND_v6 == paa->pdn_type)) {
+    hash_rc = hashtable_ts_insert (sgw_app.ue_ipv6_prefix_to_s11teid, sgw_ue_ipv6_key (&paa->ipv6_address), (void *)(uintptr_t)local_s11_teid);
+    if ((HASH_TABLE_OK != hash_rc) && (HASH_TABLE_INSERT_OVERWRITTEN_DATA != hash_rc)) {
       OAILOG_ERROR (LOG_SPGW_APP, "Failed to register PAA IPv6 address\n");
       return RETURNerror;
     }
-    break;
-  default:
+  }
+  if ((IPv4 != paa->pdn_type) && (IPv6 != paa->pdn_type) && (IPv4_AND_v6 != paa->pdn_type)) {
     return RETURNerror;
   }
   return RETURNok;
@@ -334,89 +326,41 @@ int sgw_register_paging_paa(const teid_t local_s11_teid, const paa_t * const paa
 //-----------------------------------------------------------------------------
 int sgw_deregister_paging_paa(const paa_t * const paa)
 {
-  char str[INET6_ADDRSTRLEN+1] = {0};
-
-  switch (paa->pdn_type) {
-  case  IPv4:
-    if (inet_ntop(AF_INET, &paa->ipv4_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv4 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_free (sgw_app.ip2s11teid, str, strlen(str))) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv4 address\n");
-      return RETURNerror;
-    }
-    OAILOG_DEBUG (LOG_SPGW_APP, "Deregistered PAA IPv4 address for paging in sgw_app.ip2s11teid[%s]\n", str);
-    break;
-  case IPv6:
-    if (inet_ntop(AF_INET6, &paa->ipv6_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv6 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_free (sgw_app.ip2s11teid, str, strlen(str))) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv6 address\n");
-      return RETURNerror;
-    }
-    OAILOG_DEBUG (LOG_SPGW_APP, "Deregistered PAA IPv6 address for paging in sgw_app.ip2s11teid[%s]\n", str);
-    break;
-  case IPv4_AND_v6:
-    if (inet_ntop(AF_INET, &paa->ipv4_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv4 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_free (sgw_app.ip2s11teid, str, strlen(str))) {
+  if ((IPv4 == paa->pdn_type) || (IPv4_AND_v6 == paa->pdn_type)) {
+    if (HASH_TABLE_OK != hashtable_ts_free (sgw_app.ue_ipv4_to_s11teid, sgw_ue_ipv4_key (&paa->ipv4_address))) {
       OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv4 address\n");
       return RETURNerror;
     }
-    OAILOG_DEBUG (LOG_SPGW_APP, "Deregistered PAA IPv4 address for paging in sgw_app.ip2s11teid[%s]\n", str);
-    if (inet_ntop(AF_INET6, &paa->ipv6_address, str, INET6_ADDRSTRLEN) == NULL) {
-      OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv6 address\n");
-      return RETURNerror;
-    }
-    if (HASH_TABLE_OK != obj_hashtable_uint64_ts_free (sgw_app.ip2s11teid, str, strlen(str))) {
+    OAILOG_DEBUG (LOG_SPGW_APP, "Deregistered PAA IPv4 address " IN_ADDR_FMT " for paging\n", PRI_IN_ADDR (paa->ipv4_address));
+  }
+  if ((IPv6 == paa->pdn_type) || (IPv4_AND_v6 == paa->pdn_type)) {
+    if (HASH_TABLE_OK != hashtable_ts_free (sgw_app.ue_ipv6_prefix_to_s11teid, sgw_ue_ipv6_key (&paa->ipv6_address))) {
       OAILOG_ERROR (LOG_SPGW_APP, "Failed to deregister PAA IPv6 address\n");
       return RETURNerror;
     }
-    OAILOG_DEBUG (LOG_SPGW_APP, "Deregistered PAA IPv6 address for paging in sgw_app.ip2s11teid[%s]\n", str);
-    break;
-  default:
+    OAILOG_DEBUG (LOG_SPGW_APP, "Deregistered PAA IPv6 address for paging\n");
+  }
+  if ((IPv4 != paa->pdn_type) && (IPv6 != paa->pdn_type) && (IPv4_AND_v6 != paa->pdn_type)) {
     return RETURNerror;
   }
   return RETURNok;
 }
 
 //-----------------------------------------------------------------------------
-int sgw_get_subscriber_id_from_ipv4(const struct in_addr* dest_ip, char** imsi, teid_t * s11_lteid)
+int sgw_get_subscriber_id_from_ipv4(const struct in_addr* dest_ip, teid_t * s11_lteid, s_plus_p_gw_eps_bearer_context_information_t **ctx)
 {
+  void                                   *teid = NULL;
 
-  char str[INET6_ADDRSTRLEN+1] = {0};
-  uint64_t teid = 0;
-
-  if (inet_ntop(AF_INET, dest_ip, str, INET_ADDRSTRLEN) == NULL) {
+  if (HASH_TABLE_OK != hashtable_ts_get (sgw_app.ue_ipv4_to_s11teid, sgw_ue_ipv4_key (dest_ip), &teid)) {
     return RETURNerror;
   }
+  *s11_lteid = (teid_t)(uintptr_t)teid;
+  OAILOG_DEBUG (LOG_SPGW_APP, "sgw_get_subscriber_id_from_ipv4 " IN_ADDR_FMT " -> " TEID_FMT " (local S11 teid)\n", PRI_IN_ADDR (*dest_ip), *s11_lteid);
 
-  sgw_display_s11_bearer_context_information_mapping();
-
-  if (HASH_TABLE_OK != obj_hashtable_uint64_ts_get (sgw_app.ip2s11teid, str, strlen(str), &teid)) {
-    return RETURNerror;
-  }
-  *s11_lteid = (teid_t)teid;
-  OAILOG_DEBUG (LOG_SPGW_APP, "sgw_get_subscriber_id_from_ipv4 %s -> " TEID_FMT " (local S11 teid)\n", str, *s11_lteid);
-
-  s_plus_p_gw_eps_bearer_context_information_t *ctx = NULL;
-  if (sgw_get_s_plus_p_gw_eps_bearer_context_information(*s11_lteid, &ctx)) {
-    OAILOG_DEBUG (LOG_SPGW_APP, "sgw_get_subscriber_id_from_ipv4 %s could not find EPS Bearer Context Information for local S11 teid " TEID_FMT "\n",
-        str, *s11_lteid);
-    return RETURNerror;
-  }
-  if (NULL != ctx) {
-    char imsi_s[IMSI_BCD_DIGITS_MAX+1] = {0};
-    IMSI_TO_STRING(&ctx->sgw_eps_bearer_context_information.imsi, imsi_s, IMSI_BCD_DIGITS_MAX);
-    *imsi = strdup(imsi_s);
-    OAILOG_DEBUG (LOG_SPGW_APP, "sgw_get_subscriber_id_from_ipv4 %s -> IMSI %s\n", str, *imsi);
-  } else {
-    OAILOG_DEBUG (LOG_SPGW_APP, "sgw_get_subscriber_id_from_ipv4 %s found NULL EPS Bearer Context Information for local S11 teid " TEID_FMT "\n", str, *s11_lteid);
+  *ctx = NULL;
+  if ((sgw_get_s_plus_p_gw_eps_bearer_context_information(*s11_lteid, ctx)) || (NULL == *ctx)) {
+    OAILOG_DEBUG (LOG_SPGW_APP, "sgw_get_subscriber_id_from_ipv4 " IN_ADDR_FMT " could not find EPS Bearer Context Information for local S11 teid " TEID_FMT "\n",
+        PRI_IN_ADDR (*dest_ip), *s11_lteid);
     return RETURNerror;
   }
   return RETURNok;
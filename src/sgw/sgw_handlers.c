@@ -58,11 +58,13 @@
 #include "pgw_pco.h"
 #include "spgw_config.h"
 #include "gtpv1u.h"
+#if ENABLE_LIBGTPNL
+#include "gtp_nft_marking.h"
+#endif
 #include "pgw_ue_ip_address_alloc.h"
 #include "pgw_pcef_emulation.h"
 #include "sgw_context_manager.h"
 #include "pgw_procedures.h"
-#include "async_system.h"
 #include "ip_forward_messages_types.h"
 #include "s11_messages_types.h"
 
@@ -73,13 +75,11 @@ extern "C" {
 extern sgw_app_t                        sgw_app;
 extern spgw_config_t                    spgw_config;
 extern struct gtp_tunnel_ops           *gtp_tunnel_ops;
-static uint32_t                         g_gtpv1u_teid = 0;
 
 //------------------------------------------------------------------------------
 uint32_t sgw_get_new_s1u_teid (void)
 {
-  __sync_fetch_and_add(&g_gtpv1u_teid, 1);
-  return g_gtpv1u_teid;
+  return gtpv1u_new_teid ();
 }
 
 
@@ -92,6 +92,7 @@ sgw_handle_create_session_request (
   mme_sgw_tunnel_t                       *new_endpoint_p = NULL;
   s_plus_p_gw_eps_bearer_context_information_t *s_plus_p_gw_eps_bearer_ctxt_info_p = NULL;
   sgw_eps_bearer_ctxt_t                 *eps_bearer_ctxt_p = NULL;
+  teid_t                                  local_s11_teid = 0;
 
   /*
    * Upon reception of create session request from MME,
@@ -118,9 +119,15 @@ sgw_handle_create_session_request (
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
   }
 
-  new_endpoint_p = sgw_cm_create_s11_tunnel (session_req_pP->sender_fteid_for_cp.teid, sgw_get_new_S11_tunnel_id ());
+  local_s11_teid = sgw_get_new_S11_tunnel_id ();
+  if (0 == local_s11_teid) {
+    OAILOG_WARNING (LOG_SPGW_APP, "No S11 S-GW teid available\n");
+    OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
+  }
+  new_endpoint_p = sgw_cm_create_s11_tunnel (session_req_pP->sender_fteid_for_cp.teid, local_s11_teid);
 
   if (new_endpoint_p == NULL) {
+    teid_pool_release (sgw_app.s11_teid_pool, local_s11_teid);
     OAILOG_WARNING (LOG_SPGW_APP, "Could not create new tunnel endpoint between S-GW and MME " "for S11 abstraction\n");
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
   }
@@ -228,6 +235,10 @@ sgw_handle_create_session_request (
       createTunnelResp.eps_bearer_id = session_req_pP->bearer_contexts_to_be_created.bearer_contexts[0].eps_bearer_id;
       createTunnelResp.status = 0x00;
       createTunnelResp.S1u_teid = sgw_get_new_s1u_teid ();
+      if (0 == createTunnelResp.S1u_teid) {
+        // S1-U TEID pool exhausted, the session is rejected with cause NO_RESOURCES_AVAILABLE
+        createTunnelResp.status = 0x01;
+      }
       sgw_handle_gtpv1uCreateTunnelResp (&createTunnelResp);
     }
   } else {
@@ -384,7 +395,11 @@ sgw_handle_gtpv1uCreateTunnelResp (
                   endpoint_created_pP->context_teid, endpoint_created_pP->S1u_teid, endpoint_created_pP->eps_bearer_id, endpoint_created_pP->status);
   hash_rc = hashtable_ts_get (sgw_app.s11_bearer_context_information_hashtable, endpoint_created_pP->context_teid, (void **)&new_bearer_ctxt_info_p);
 
-  if (HASH_TABLE_OK == hash_rc) {
+  if ((HASH_TABLE_OK == hash_rc) && (endpoint_created_pP->status)) {
+    OAILOG_ERROR (LOG_SPGW_APP, "No S1-U teid available for context S11 teid "TEID_FMT" EPS bearer id %u\n",
+                  endpoint_created_pP->context_teid, endpoint_created_pP->eps_bearer_id);
+    sgi_create_endpoint_resp.status = SGI_STATUS_ERROR_NO_RESOURCES_AVAILABLE;
+  } else if (HASH_TABLE_OK == hash_rc) {
     eps_bearer_ctxt_p =
         sgw_cm_get_eps_bearer_entry(&new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.pdn_connection,
             endpoint_created_pP->eps_bearer_id);
@@ -505,6 +520,11 @@ sgw_handle_gtpv1uCreateTunnelResp (
 
     break;
 
+  case SGI_STATUS_ERROR_NO_RESOURCES_AVAILABLE:
+    cause = NO_RESOURCES_AVAILABLE;
+
+    break;
+
     default:
     cause = REQUEST_REJECTED; // Unspecified reason
 
@@ -693,11 +713,7 @@ sgw_handle_sgi_endpoint_updated (
       }
 
 #if ENABLE_LIBGTPNL
-      bstring marking_command = bformat(
-            "iptables -A POSTROUTING -t mangle --out-interface gtp0 --dest %"PRIu8".%"PRIu8".%"PRIu8".%"PRIu8"/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
-            NIPADDR(eps_bearer_ctxt_p->paa.ipv4_address.s_addr), SDF_ID_NGBR_DEFAULT, eps_bearer_ctxt_p->eps_bearer_id);
-      async_system_command (TASK_SPGW_APP, false, bdata(marking_command));
-      bdestroy_wrapper(&marking_command);
+      gtp_nft_marking_add_bearer (ue, SDF_ID_NGBR_DEFAULT, eps_bearer_ctxt_p->eps_bearer_id);
       AssertFatal((TRAFFIC_FLOW_TEMPLATE_NB_PACKET_FILTERS_MAX > eps_bearer_ctxt_p->num_sdf), "Too much flows aggregated in this Bearer (should not happen => see MME)");
 #endif
       // may be removed
@@ -973,11 +989,7 @@ sgw_handle_delete_session_request (
             for (int sdfx = 0; sdfx < eps_bearer_ctxt_p->num_sdf; sdfx++) {
               if (eps_bearer_ctxt_p->sdf_id[sdfx]) {
 #if ENABLE_LIBGTPNL
-                bstring marking_command = bformat(
-                    "iptables -D POSTROUTING -t mangle --out-interface gtp0 --dest %"PRIu8".%"PRIu8".%"PRIu8".%"PRIu8"/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
-                    NIPADDR(eps_bearer_ctxt_p->paa.ipv4_address.s_addr), eps_bearer_ctxt_p->sdf_id[sdfx], eps_bearer_ctxt_p->eps_bearer_id);
-                async_system_command (TASK_SPGW_APP, false, bdata(marking_command));
-                bdestroy_wrapper(&marking_command);
+                gtp_nft_marking_del_bearer (eps_bearer_ctxt_p->paa.ipv4_address, eps_bearer_ctxt_p->sdf_id[sdfx]);
 #elif ENABLE_OPENFLOW
                 rv = gtp_tunnel_ops->del_tunnel(eps_bearer_ctxt_p->paa.ipv4_address, eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up, eps_bearer_ctxt_p->enb_teid_S1u, pgw_pcef_get_rule_by_id(eps_bearer_ctxt_p->sdf_id[sdfx]));
                 if (rv < 0) {
@@ -1005,11 +1017,7 @@ sgw_handle_delete_session_request (
           for (int sdfx = 0; sdfx < eps_bearer_ctxt_p->num_sdf; sdfx++) {
             if (eps_bearer_ctxt_p->sdf_id[sdfx]) {
 #if ENABLE_LIBGTPNL
-              bstring marking_command = bformat(
-                  "iptables -D POSTROUTING -t mangle --out-interface gtp0 --dest %"PRIu8".%"PRIu8".%"PRIu8".%"PRIu8"/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
-                  NIPADDR(eps_bearer_ctxt_p->paa.ipv4_address.s_addr), eps_bearer_ctxt_p->sdf_id[sdfx], eps_bearer_ctxt_p->eps_bearer_id);
-              async_system_command (TASK_SPGW_APP, false, bdata(marking_command));
-              bdestroy_wrapper(&marking_command);
+              gtp_nft_marking_del_bearer (eps_bearer_ctxt_p->paa.ipv4_address, eps_bearer_ctxt_p->sdf_id[sdfx]);
 #elif ENABLE_OPENFLOW
                 rv = gtp_tunnel_ops->del_tunnel(eps_bearer_ctxt_p->paa.ipv4_address, eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up, eps_bearer_ctxt_p->enb_teid_S1u, pgw_pcef_get_rule_by_id(eps_bearer_ctxt_p->sdf_id[sdfx]));
                 if (rv < 0) {
@@ -1119,13 +1127,21 @@ sgw_handle_release_access_bearers_request (
     release_access_bearers_resp_p->teid = ctx_p->sgw_eps_bearer_context_information.mme_teid_S11;
     release_access_bearers_resp_p->trxn = release_access_bearers_req_pP->trxn;
 //#pragma message  "TODO Here the release (sgw_handle_release_access_bearers_request)"
+#if ENABLE_LIBGTPNL
+    // all the tunnels of the UE in one kernel round trip
+    gtp_tunnel_pdp_t pdps[BEARERS_PER_UE];
+    int              nb_pdps = 0;
+#endif
     // TODO iterator
     for (int ebx = 0; ebx < BEARERS_PER_UE; ebx++) {
       sgw_eps_bearer_ctxt_t * eps_bearer_ctxt = ctx_p->sgw_eps_bearer_context_information.pdn_connection.sgw_eps_bearers_array[ebx];
       if (eps_bearer_ctxt) {
 #if ENABLE_LIBGTPNL
-        rv = gtp_tunnel_ops->del_tunnel(ue, enb, INVALID_TEID, eps_bearer_ctxt->enb_teid_S1u,
-            eps_bearer_ctxt->eps_bearer_id);
+        pdps[nb_pdps].ue = eps_bearer_ctxt->paa.ipv4_address;
+        pdps[nb_pdps].i_tei = INVALID_TEID;
+        pdps[nb_pdps].o_tei = eps_bearer_ctxt->enb_teid_S1u;
+        pdps[nb_pdps].bearer_id = eps_bearer_ctxt->eps_bearer_id;
+        nb_pdps++;
 #elif ENABLE_OPENFLOW
         for (int sdfx = 0; sdfx < eps_bearer_ctxt->num_sdf; sdfx++) {
           rv = gtp_tunnel_ops->del_tunnel(eps_bearer_ctxt->paa.ipv4_address, INVALID_TEID,
@@ -1138,6 +1154,14 @@ sgw_handle_release_access_bearers_request (
         sgw_release_all_enb_related_information(eps_bearer_ctxt);
       }
     }
+#if ENABLE_LIBGTPNL
+    if (nb_pdps) {
+      rv = gtp_tunnel_ops->del_tunnels(pdps, nb_pdps);
+      if (rv < 0) {
+        OAILOG_ERROR (LOG_SPGW_APP, "ERROR in deleting TUNNELs of UE S11 teid " TEID_FMT "\n", release_access_bearers_req_pP->teid);
+      }
+    }
+#endif
     // TODO The S-GW starts buffering downlink packets received for the UE
     // (set target on GTPUSP to order the buffering)
     MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_RELEASE_ACCESS_BEARERS_RESPONSE S11 MME teid " TEID_FMT " cause REQUEST_ACCEPTED", release_access_bearers_resp_p->teid);
@@ -1167,6 +1191,13 @@ int sgw_no_pcef_create_dedicated_bearer(s11_teid_t teid)
 
   if (HASH_TABLE_OK == hash_rc) {
 
+    teid_t                                  s1u_teid = sgw_get_new_s1u_teid ();
+
+    if (0 == s1u_teid) {
+      OAILOG_ERROR (LOG_SPGW_APP, "Dedicated bearer for S11 teid " TEID_FMT " rejected, cause NO_RESOURCES_AVAILABLE (no S1-U teid)\n", teid);
+      OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
+    }
+
     MessageDef                             *message_p = itti_alloc_new_message_sized (TASK_SPGW_APP, S11_CREATE_BEARER_REQUEST, sizeof(itti_s11_create_bearer_request_t));
 
     if (message_p) {
@@ -1200,7 +1231,7 @@ int sgw_no_pcef_create_dedicated_bearer(s11_teid_t teid)
       eps_bearer_ctxt_p->tft.ebit = TRAFFIC_FLOW_TEMPLATE_PARAMETER_LIST_IS_NOT_INCLUDED;
       eps_bearer_ctxt_p->tft.numberofpacketfilters = number_of_packet_filters;
 
-      eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up = sgw_get_new_s1u_teid ();
+      eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up = s1u_teid;
       eps_bearer_ctxt_p->s_gw_ip_address_S1u_S12_S4_up.ipv4 = true;
       eps_bearer_ctxt_p->s_gw_ip_address_S1u_S12_S4_up.ipv6 = false;
       eps_bearer_ctxt_p->s_gw_ip_address_S1u_S12_S4_up.address.ipv4_address.s_addr = sgw_app.sgw_ip_address_S1u_S12_S4_up.s_addr;
@@ -1238,6 +1269,7 @@ int sgw_no_pcef_create_dedicated_bearer(s11_teid_t teid)
       rc = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
       OAILOG_FUNC_RETURN(LOG_SPGW_APP, rc);
     }
+    gtpv1u_release_teid (s1u_teid);
   }
   OAILOG_FUNC_RETURN(LOG_SPGW_APP, rc);
 }
@@ -1312,11 +1344,7 @@ sgw_handle_create_bearer_response (
                     } else {
 
 #if ENABLE_LIBGTPNL
-                      bstring marking_command = bformat(
-                          "iptables -A POSTROUTING -t mangle --out-interface gtp0 --dest %"PRIu8".%"PRIu8".%"PRIu8".%"PRIu8"/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
-                          NIPADDR(eps_bearer_ctxt_p->paa.ipv4_address.s_addr), pgw_ni_cbr_proc->sdf_id, eps_bearer_ctxt_p->eps_bearer_id);
-                      async_system_command (TASK_SPGW_APP, false, bdata(marking_command));
-                      bdestroy_wrapper(&marking_command);
+                      gtp_nft_marking_add_bearer (ue, pgw_ni_cbr_proc->sdf_id, eps_bearer_ctxt_p->eps_bearer_id);
 #endif
                       AssertFatal((TRAFFIC_FLOW_TEMPLATE_NB_PACKET_FILTERS_MAX > eps_bearer_ctxt_p->num_sdf), "Too much flows aggregated in this Bearer (should not happen => see MME)");
                       if (TRAFFIC_FLOW_TEMPLATE_NB_PACKET_FILTERS_MAX > eps_bearer_ctxt_p->num_sdf) {
@@ -59,7 +59,11 @@
 #include "spgw_config.h"
 #include "pgw_ue_ip_address_alloc.h"
 #include "pgw_pcef_emulation.h"
+#include "gtpv1u.h"
 #include "gtpv1_u_messages_types.h"
+#if ENABLE_LIBGTPNL
+#include "gtp_nft_marking.h"
+#endif
 #include "s11_messages_types.h"
 #include "async_system.h"
 
@@ -216,6 +220,16 @@ int sgw_init (spgw_config_t *spgw_config_pP)
 
   pgw_ip_address_pool_init (); 
 
+  sgw_app.s11_teid_pool = teid_pool_create (spgw_config_pP->sgw_config.teid_config.num_shards,
+      spgw_config_pP->sgw_config.teid_config.node_id, spgw_config_pP->sgw_config.teid_config.node_id_bits,
+      spgw_config_pP->sgw_config.teid_config.quarantine_ms);
+  if ((!sgw_app.s11_teid_pool) || (RETURNok != gtpv1u_teid_pool_init (spgw_config_pP->sgw_config.teid_config.num_shards,
+      spgw_config_pP->sgw_config.teid_config.node_id, spgw_config_pP->sgw_config.teid_config.node_id_bits,
+      spgw_config_pP->sgw_config.teid_config.quarantine_ms))) {
+    OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: TEID pools ERROR\n");
+    return RETURNerror;
+  }
+
   bstring b = bfromcstr("sgw_s11teid2mme_hashtable");
   sgw_app.s11teid2mme_hashtable = hashtable_ts_create (512, NULL, NULL, b);
   btrunc(b, 0);
@@ -227,12 +241,16 @@ int sgw_init (spgw_config_t *spgw_config_pP)
     return RETURNerror;
   }
 
-  bassigncstr(b, "ip2s11teid_hashtable");
-  sgw_app.ip2s11teid = obj_hashtable_uint64_ts_create (512, NULL, NULL, b);
+  // sized for the UE IPv4 address pool, grows if needed
+  bassigncstr(b, "ue_ipv4_to_s11teid_hashtable");
+  sgw_app.ue_ipv4_to_s11teid = hashtable_ts_create ((pgw_app.ipv4_pool->num_addresses < SGW_UE_IP_HTBL_SIZE_MAX) ?
+      (hash_size_t)pgw_app.ipv4_pool->num_addresses : SGW_UE_IP_HTBL_SIZE_MAX, NULL, hash_free_int_func, b);
+  bassigncstr(b, "ue_ipv6_prefix_to_s11teid_hashtable");
+  sgw_app.ue_ipv6_prefix_to_s11teid = hashtable_ts_create (512, NULL, hash_free_int_func, b);
   btrunc(b, 0);
 
-  if (sgw_app.ip2s11teid == NULL) {
-    perror ("obj_hashtable_uint64_ts_create");
+  if ((sgw_app.ue_ipv4_to_s11teid == NULL) || (sgw_app.ue_ipv6_prefix_to_s11teid == NULL)) {
+    perror ("hashtable_ts_create");
     bdestroy_wrapper (&b);
     OAILOG_ALERT (LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
     return RETURNerror;
@@ -297,8 +315,11 @@ static void sgw_exit(void)
   if (sgw_app.s11teid2mme_hashtable) {
     hashtable_ts_destroy (sgw_app.s11teid2mme_hashtable);
   }
-  if (sgw_app.ip2s11teid) {
-    obj_hashtable_uint64_ts_destroy (sgw_app.ip2s11teid);
+  if (sgw_app.ue_ipv4_to_s11teid) {
+    hashtable_ts_destroy (sgw_app.ue_ipv4_to_s11teid);
+  }
+  if (sgw_app.ue_ipv6_prefix_to_s11teid) {
+    hashtable_ts_destroy (sgw_app.ue_ipv6_prefix_to_s11teid);
   }
   /*if (sgw_app.s1uteid2enb_hashtable) {
     hashtable_destroy (sgw_app.s1uteid2enb_hashtable);
@@ -306,14 +327,15 @@ static void sgw_exit(void)
   if (sgw_app.s11_bearer_context_information_hashtable) {
     hashtable_ts_destroy (sgw_app.s11_bearer_context_information_hashtable);
   }
+  teid_pool_destroy (sgw_app.s11_teid_pool);
+  sgw_app.s11_teid_pool = NULL;
+  gtpv1u_teid_pool_exit ();
 
   //P-GW code
-  struct conf_ipv4_list_elm_s   *conf_ipv4_p = NULL;
-
-  while ((conf_ipv4_p = STAILQ_FIRST (&spgw_config.pgw_config.ipv4_pool_list))) {
-    STAILQ_REMOVE_HEAD (&spgw_config.pgw_config.ipv4_pool_list, ipv4_entries);
-    free_wrapper ((void**)&conf_ipv4_p);
-  }
+  pgw_ip_address_pool_exit ();
+#if ENABLE_LIBGTPNL
+  gtp_nft_marking_exit ();
+#endif
   OAI_FPRINTF_INFO("TASK_SPGW_APP terminated");
 }
 
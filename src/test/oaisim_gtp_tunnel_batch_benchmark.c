@@ -0,0 +1,189 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * GTP kernel tunnel programming (gtp_tunnel_libgtpnl_marking_bearer.c) played in a private network
+ * namespace: creates the gtp0 device, then programs nb_ues default bearers
+ *   - one add_tunnel()/del_tunnel() per bearer, one netlink round trip each,
+ *   - add_tunnels()/del_tunnels() on the whole set (eNB reset then mass re-attach),
+ * and reports tunnels/s for both. It then changes the eNB of one bearer out of ten and removes one
+ * out of ten from the expected set, checks that reconcile_tunnels() fixes exactly these, and that a
+ * second reconciliation has nothing to do.
+ * Needs CAP_SYS_ADMIN (network namespace), the gtp kernel module patched for dedicated bearers
+ * (build/tools) and libgtpnl, prints SKIPPED otherwise.
+ * Returns non zero if a tunnel operation fails.
+ *
+ * usage: oaisim_gtp_tunnel_batch_benchmark [nb_ues]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "common_defs.h"
+#include "gtpv1u.h"
+
+#define NB_OF_UES                 10000
+#define UE_NET                    "10.0.0.0"
+#define UE_NETMASK                "255.0.0.0"
+#define ENB                       "192.168.100.1"
+#define OTHER_ENB                 "192.168.100.2"
+#define GTP_MTU                   1400
+#define DEFAULT_EBI               5
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void init_pdps (gtp_tunnel_pdp_t * const pdps, const int nb_ues)
+{
+  struct in_addr                          ue_net;
+
+  inet_aton (UE_NET, &ue_net);
+  for (int i = 0; i < nb_ues; i++) {
+    pdps[i].ue.s_addr = htonl (ntohl (ue_net.s_addr) + 2 + i);
+    inet_aton (ENB, &pdps[i].enb);
+    pdps[i].i_tei = 0x1000 + i;
+    pdps[i].o_tei = 0x80000000 + i;
+    pdps[i].bearer_id = DEFAULT_EBI;
+    pdps[i].rc = 0;
+  }
+}
+
+static int check_rc (const char * const what, const gtp_tunnel_pdp_t * const pdps, const int nb_pdps)
+{
+  for (int i = 0; i < nb_pdps; i++) {
+    if (pdps[i].rc) {
+      fprintf (stderr, "FAILED %s tunnel %d i_tei 0x%x: %s\n", what, i, pdps[i].i_tei, strerror (-pdps[i].rc));
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main (int argc, char *argv[])
+{
+  const int                               nb_ues = (argc > 1) ? atoi (argv[1]) : NB_OF_UES;
+  const struct gtp_tunnel_ops            *ops = NULL;
+  gtp_tunnel_pdp_t                       *pdps = calloc (nb_ues, sizeof (gtp_tunnel_pdp_t));
+  struct in_addr                          ue_net, ue_netmask;
+  struct timespec                         start;
+  int                                     fd0 = -1, fd1u = -1;
+  int                                     failed = 0;
+  double                                  t = 0;
+
+  if (unshare (CLONE_NEWNET)) {
+    printf ("SKIPPED: no network namespace (%s)\n", strerror (errno));
+    return 0;
+  }
+  if (system ("ip link set lo up")) {
+    printf ("SKIPPED: no ip command\n");
+    return 0;
+  }
+  inet_aton (UE_NET, &ue_net);
+  inet_aton (UE_NETMASK, &ue_netmask);
+  ops = gtp_tunnel_ops_init ();
+  if (RETURNok != ops->init (&ue_net, &ue_netmask, GTP_MTU, &fd0, &fd1u)) {
+    printf ("SKIPPED: no GTP kernel device\n");
+    return 0;
+  }
+
+  // one round trip per tunnel
+  init_pdps (pdps, nb_ues);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; (i < nb_ues) && (!failed); i++) {
+    pdps[i].rc = ops->add_tunnel (pdps[i].ue, pdps[i].enb, pdps[i].i_tei, pdps[i].o_tei, pdps[i].bearer_id);
+    failed |= check_rc ("add_tunnel", &pdps[i], 1);
+  }
+  t = elapsed_sec (&start);
+  printf ("add_tunnel:    %d in %.3f s, %.0f tunnels/s\n", nb_ues, t, nb_ues / t);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; (i < nb_ues) && (!failed); i++) {
+    pdps[i].rc = ops->del_tunnel (pdps[i].ue, pdps[i].i_tei, pdps[i].o_tei);
+    failed |= check_rc ("del_tunnel", &pdps[i], 1);
+  }
+  t = elapsed_sec (&start);
+  printf ("del_tunnel:    %d in %.3f s, %.0f tunnels/s\n", nb_ues, t, nb_ues / t);
+
+  // batched
+  if (!failed) {
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    ops->add_tunnels (pdps, nb_ues);
+    t = elapsed_sec (&start);
+    printf ("add_tunnels:   %d in %.3f s, %.0f tunnels/s\n", nb_ues, t, nb_ues / t);
+    failed |= check_rc ("add_tunnels", pdps, nb_ues);
+  }
+  if (!failed) {
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    ops->del_tunnels (pdps, nb_ues);
+    t = elapsed_sec (&start);
+    printf ("del_tunnels:   %d in %.3f s, %.0f tunnels/s\n", nb_ues, t, nb_ues / t);
+    failed |= check_rc ("del_tunnels", pdps, nb_ues);
+  }
+
+  // reconciliation: 1/10 with another eNB, 1/10 no more expected
+  if (!failed) {
+    int                                     nb_expected = 0;
+
+    ops->add_tunnels (pdps, nb_ues);
+    failed |= check_rc ("add_tunnels", pdps, nb_ues);
+    for (int i = 0; i < nb_ues; i++) {
+      if (5 == (i % 10)) {
+        continue;
+      }
+      pdps[nb_expected] = pdps[i];
+      if (0 == (i % 10)) {
+        inet_aton (OTHER_ENB, &pdps[nb_expected].enb);
+      }
+      nb_expected++;
+    }
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    if (RETURNok != ops->reconcile_tunnels (pdps, nb_expected)) {
+      failed = 1;
+    }
+    t = elapsed_sec (&start);
+    printf ("reconcile:     %d expected in %.3f s\n", nb_expected, t);
+    failed |= check_rc ("reconcile_tunnels", pdps, nb_expected);
+    // nothing left to do: a kernel tunnel deleted twice would fail
+    if ((!failed) && (RETURNok != ops->reconcile_tunnels (pdps, nb_expected))) {
+      failed = 1;
+    }
+    ops->del_tunnels (pdps, nb_expected);
+    failed |= check_rc ("del_tunnels", pdps, nb_expected);
+  }
+
+  ops->uninit ();
+  free (pdps);
+  printf ("%s\n", failed ? "FAILED" : "PASSED");
+  return failed;
+}
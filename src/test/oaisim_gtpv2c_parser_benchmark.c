@@ -0,0 +1,350 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * GTPv2-C decoding (nwgtpv2c) of S11 messages captured on the MME-SGW interface during an attach,
+ * an idle/active cycle and a detach: each datagram is decoded as the stack and the S11 tasks do,
+ * message from the datagram, IE parse of the stack, then a message parser with the IEs and
+ * presences of the S11 handler and a read callback per IE. Reports decoded messages/s per message
+ * type and for the whole mix.
+ * Checks that the stack accepts every message, that every IE reaches its callback and is found in
+ * the message, that an IE overrunning the message is reported as malformed and that a missing
+ * mandatory IE is reported.
+ * Returns non zero on a failed check.
+ *
+ * usage: oaisim_gtpv2c_parser_benchmark [nb_iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "NwTypes.h"
+#include "NwError.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cMsgParser.h"
+#include "NwGtpv2cPrivate.h"
+#include "NwGtpv2cMsgIeParseInfo.h"
+
+#define NB_OF_ITERATIONS          200000
+
+/* Create Session Request, 227 bytes */
+static const uint8_t                      s11_create_session_request[] = {
+  0x48, 0x20, 0x00, 0xdf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1a, 0x2b, 0x00, 0x01, 0x00, 0x08, 0x00,
+  0x00, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x4c, 0x00, 0x06, 0x00, 0x33, 0x66, 0x35, 0x00,
+  0x00, 0x7f, 0x4b, 0x00, 0x08, 0x00, 0x53, 0x00, 0x01, 0x45, 0x89, 0x61, 0x72, 0x10, 0x56, 0x00,
+  0x0d, 0x00, 0x18, 0x00, 0xf1, 0x10, 0x00, 0x01, 0x00, 0xf1, 0x10, 0x00, 0x00, 0x01, 0x01, 0x53,
+  0x00, 0x03, 0x00, 0x00, 0xf1, 0x10, 0x52, 0x00, 0x01, 0x00, 0x06, 0x4d, 0x00, 0x03, 0x00, 0x00,
+  0x00, 0x00, 0x57, 0x00, 0x09, 0x00, 0x8a, 0x00, 0x00, 0x00, 0x01, 0xc0, 0xa8, 0x0b, 0x11, 0x57,
+  0x00, 0x09, 0x01, 0x87, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xa8, 0x0c, 0x01, 0x47, 0x00, 0x09, 0x00,
+  0x03, 0x6f, 0x61, 0x69, 0x04, 0x69, 0x70, 0x76, 0x34, 0x80, 0x00, 0x01, 0x00, 0x00, 0x63, 0x00,
+  0x01, 0x00, 0x01, 0x4f, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x00, 0x01, 0x00,
+  0x00, 0x48, 0x00, 0x08, 0x00, 0x00, 0x00, 0xc3, 0x50, 0x00, 0x01, 0x86, 0xa0, 0x5d, 0x00, 0x1f,
+  0x00, 0x49, 0x00, 0x01, 0x00, 0x05, 0x50, 0x00, 0x16, 0x00, 0x44, 0x09, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x03, 0x00, 0x01, 0x00, 0x01, 0x4e, 0x00, 0x1a, 0x00, 0x80, 0x80, 0x21, 0x10, 0x01, 0x00, 0x00,
+  0x10, 0x81, 0x06, 0x00, 0x00, 0x00, 0x00, 0x83, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0d, 0x00,
+  0x00, 0x0a, 0x00,
+};
+
+/* Create Session Response, 138 bytes */
+static const uint8_t                      s11_create_session_response[] = {
+  0x48, 0x21, 0x00, 0x86, 0x00, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x2b, 0x00, 0x02, 0x00, 0x02, 0x00,
+  0x10, 0x00, 0x57, 0x00, 0x09, 0x00, 0x8b, 0x80, 0x00, 0x00, 0x01, 0xc0, 0xa8, 0x0b, 0x12, 0x57,
+  0x00, 0x09, 0x01, 0x87, 0x00, 0x00, 0x01, 0x01, 0xc0, 0xa8, 0x0c, 0x01, 0x4f, 0x00, 0x05, 0x00,
+  0x01, 0xac, 0x10, 0x00, 0x02, 0x7f, 0x00, 0x01, 0x00, 0x00, 0x5d, 0x00, 0x2d, 0x00, 0x49, 0x00,
+  0x01, 0x00, 0x05, 0x02, 0x00, 0x02, 0x00, 0x10, 0x00, 0x57, 0x00, 0x09, 0x00, 0x81, 0x00, 0x00,
+  0x02, 0x01, 0xc0, 0xa8, 0x0c, 0x02, 0x57, 0x00, 0x09, 0x02, 0x85, 0x00, 0x00, 0x03, 0x01, 0xc0,
+  0xa8, 0x0c, 0x01, 0x5e, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x01, 0x4e, 0x00, 0x1b, 0x00, 0x80,
+  0x80, 0x21, 0x10, 0x03, 0x00, 0x00, 0x10, 0x81, 0x06, 0x08, 0x08, 0x08, 0x08, 0x83, 0x06, 0x08,
+  0x08, 0x04, 0x04, 0x00, 0x0d, 0x04, 0x08, 0x08, 0x08, 0x08,
+};
+
+/* Modify Bearer Request, 34 bytes */
+static const uint8_t                      s11_modify_bearer_request[] = {
+  0x48, 0x22, 0x00, 0x1e, 0x80, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x2c, 0x00, 0x5d, 0x00, 0x12, 0x00,
+  0x49, 0x00, 0x01, 0x00, 0x05, 0x57, 0x00, 0x09, 0x00, 0x80, 0x0a, 0x00, 0x00, 0x01, 0xc0, 0xa8,
+  0x0d, 0x05,
+};
+
+/* Modify Bearer Response, 46 bytes */
+static const uint8_t                      s11_modify_bearer_response[] = {
+  0x48, 0x23, 0x00, 0x2a, 0x00, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x2c, 0x00, 0x02, 0x00, 0x02, 0x00,
+  0x10, 0x00, 0x5d, 0x00, 0x18, 0x00, 0x49, 0x00, 0x01, 0x00, 0x05, 0x02, 0x00, 0x02, 0x00, 0x10,
+  0x00, 0x57, 0x00, 0x09, 0x00, 0x81, 0x00, 0x00, 0x02, 0x01, 0xc0, 0xa8, 0x0c, 0x02,
+};
+
+/* Release Access Bearers Request, 12 bytes */
+static const uint8_t                      s11_release_access_bearers_request[] = {
+  0x48, 0xaa, 0x00, 0x08, 0x80, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x2d, 0x00,
+};
+
+/* Downlink Data Notification, 22 bytes */
+static const uint8_t                      s11_downlink_data_notification[] = {
+  0x48, 0xb0, 0x00, 0x12, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x42, 0x00, 0x49, 0x00, 0x01, 0x00,
+  0x05, 0x9b, 0x00, 0x01, 0x00, 0x24,
+};
+
+/* Delete Session Request, 37 bytes */
+static const uint8_t                      s11_delete_session_request[] = {
+  0x48, 0x24, 0x00, 0x21, 0x80, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x2e, 0x00, 0x57, 0x00, 0x09, 0x00,
+  0x8a, 0x00, 0x00, 0x00, 0x01, 0xc0, 0xa8, 0x0b, 0x11, 0x49, 0x00, 0x01, 0x00, 0x05, 0x4d, 0x00,
+  0x03, 0x00, 0x08, 0x00, 0x00,
+};
+
+/* Delete Session Response, 18 bytes */
+static const uint8_t                      s11_delete_session_response[] = {
+  0x48, 0x25, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x2e, 0x00, 0x02, 0x00, 0x02, 0x00,
+  0x10, 0x00,
+};
+
+typedef struct s11_ie_s {
+  uint8_t                                 type;
+  uint8_t                                 instance;
+  uint8_t                                 presence;
+} s11_ie_t;
+
+/* IEs added to the message parser by the S11 handlers (s11_sgw_*_manager.c, s11_mme_*_manager.c) */
+static const s11_ie_t                     s11_create_session_request_ies[] = {
+  {NW_GTPV2C_IE_IMSI,              NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_MSISDN,            NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_MEI,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_ULI,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_SERVING_NETWORK,   NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_RAT_TYPE,          NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+  {NW_GTPV2C_IE_INDICATION,        NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_APN,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+  {NW_GTPV2C_IE_SELECTION_MODE,    NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_PDN_TYPE,          NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_PAA,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_FTEID,             NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+  {NW_GTPV2C_IE_FTEID,             NW_GTPV2C_IE_INSTANCE_ONE,  NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_APN_RESTRICTION,   NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_BEARER_CONTEXT,    NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+  {NW_GTPV2C_IE_PCO,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_AMBR,              NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_RECOVERY,          NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+};
+
+static const s11_ie_t                     s11_create_session_response_ies[] = {
+  {NW_GTPV2C_IE_CAUSE,             NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+  {NW_GTPV2C_IE_FTEID,             NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_FTEID,             NW_GTPV2C_IE_INSTANCE_ONE,  NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_PAA,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_APN_RESTRICTION,   NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_PCO,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_BEARER_CONTEXT,    NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+};
+
+static const s11_ie_t                     s11_modify_bearer_request_ies[] = {
+  {NW_GTPV2C_IE_INDICATION,        NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_FQ_CSID,           NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_RAT_TYPE,          NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_DELAY_VALUE,       NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {NW_GTPV2C_IE_BEARER_CONTEXT,    NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+};
+
+static const s11_ie_t                     s11_modify_bearer_response_ies[] = {
+  {NW_GTPV2C_IE_CAUSE,             NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+  {NW_GTPV2C_IE_BEARER_CONTEXT,    NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+};
+
+static const s11_ie_t                     s11_release_access_bearers_request_ies[] = {
+  {NW_GTPV2C_IE_NODE_TYPE,         NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+};
+
+static const s11_ie_t                     s11_downlink_data_notification_ies[] = {
+  {NW_GTPV2C_IE_EBI,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+  {155 /* ARP */,                  NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+};
+
+static const s11_ie_t                     s11_delete_session_request_ies[] = {
+  {NW_GTPV2C_IE_FTEID,             NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL},
+  {NW_GTPV2C_IE_EBI,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL},
+  {NW_GTPV2C_IE_INDICATION,        NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+};
+
+static const s11_ie_t                     s11_delete_session_response_ies[] = {
+  {NW_GTPV2C_IE_CAUSE,             NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY},
+  {NW_GTPV2C_IE_PCO,               NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL},
+};
+
+#define S11_CAPTURE(nAmE, tYpE, nB_iEs) {#nAmE, tYpE, s11_##nAmE, sizeof (s11_##nAmE), s11_##nAmE##_ies, sizeof (s11_##nAmE##_ies) / sizeof (s11_ie_t), nB_iEs}
+
+typedef struct s11_capture_s {
+  const char                             *name;
+  uint8_t                                 msg_type;
+  const uint8_t                          *buf;
+  uint32_t                                len;
+  const s11_ie_t                         *ies;
+  int                                     nb_parser_ies;
+  int                                     nb_msg_ies;          /* top level IEs in the message */
+} s11_capture_t;
+
+static const s11_capture_t                s11_captures[] = {
+  S11_CAPTURE (create_session_request,         NW_GTP_CREATE_SESSION_REQ,        18),
+  S11_CAPTURE (create_session_response,        NW_GTP_CREATE_SESSION_RSP,        7),
+  S11_CAPTURE (modify_bearer_request,          NW_GTP_MODIFY_BEARER_REQ,         1),
+  S11_CAPTURE (modify_bearer_response,         NW_GTP_MODIFY_BEARER_RSP,         2),
+  S11_CAPTURE (release_access_bearers_request, NW_GTP_RELEASE_ACCESS_BEARERS_REQ, 0),
+  S11_CAPTURE (downlink_data_notification,     NW_GTP_DOWNLINK_DATA_NOTIFICATION, 2),
+  S11_CAPTURE (delete_session_request,         NW_GTP_DELETE_SESSION_REQ,        3),
+  S11_CAPTURE (delete_session_response,        NW_GTP_DELETE_SESSION_RSP,        1),
+};
+
+#define NB_OF_CAPTURES            (sizeof (s11_captures) / sizeof (s11_capture_t))
+
+typedef struct ie_read_counter_s {
+  uint32_t                                nb_ies;
+  uint32_t                                nb_bytes;
+} ie_read_counter_t;
+
+static nw_rc_t ie_read_count (uint8_t ieType, uint16_t ieLength, uint8_t ieInstance, uint8_t * ieValue, void *arg)
+{
+  ie_read_counter_t                      *counter = (ie_read_counter_t *) arg;
+
+  counter->nb_ies++;
+  counter->nb_bytes += ieLength;
+  return NW_OK;
+}
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * Receive path of a datagram: stack side then S11 task side, as nwGtpv2cHandleInitialReq() and
+ * the S11 handlers do it. The message and the stack side error are left to the caller.
+ */
+static nw_rc_t s11_decode (nw_gtpv2c_stack_handle_t hStack, const s11_capture_t * const capture, const uint8_t * const buf, const uint32_t len,
+    const s11_ie_t * const extra_ie, ie_read_counter_t * const counter, nw_gtpv2c_msg_handle_t * const phMsg, nw_gtpv2c_error_t * const error,
+    uint8_t * const offending_ie_type)
+{
+  nw_gtpv2c_stack_t                      *stack = (nw_gtpv2c_stack_t *) hStack;
+  nw_gtpv2c_msg_parser_t                 *parser = NULL;
+  uint8_t                                 offending_ie_instance = 0;
+  uint16_t                                offending_ie_length = 0;
+  nw_rc_t                                 rc = NW_OK;
+
+  if (NW_OK != nwGtpv2cMsgFromBufferNew (hStack, (uint8_t *) buf, len, phMsg)) {
+    return NW_FAILURE;
+  }
+  memset (error, 0, sizeof (*error));
+  nwGtpv2cMsgIeParse (stack->pGtpv2cMsgIeParseInfo[capture->msg_type], *phMsg, error);
+  nwGtpv2cMsgParserNew (hStack, capture->msg_type, NULL, NULL, &parser);
+  for (int i = 0; i < capture->nb_parser_ies; i++) {
+    nwGtpv2cMsgParserAddIe (parser, capture->ies[i].type, capture->ies[i].instance, capture->ies[i].presence, ie_read_count, counter);
+  }
+  if (extra_ie) {
+    nwGtpv2cMsgParserAddIe (parser, extra_ie->type, extra_ie->instance, extra_ie->presence, ie_read_count, counter);
+  }
+  rc = nwGtpv2cMsgParserRun (parser, *phMsg, offending_ie_type, &offending_ie_instance, &offending_ie_length);
+  nwGtpv2cMsgParserDelete (hStack, parser);
+  return rc;
+}
+
+#define CHECK(cOnD, ...) do { if (!(cOnD)) { fprintf (stderr, "FAILED line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); fprintf (stderr, "\n"); return 1; } } while (0)
+
+int main (int argc, char *argv[])
+{
+  const int                               nb_iterations = (argc > 1) ? atoi (argv[1]) : NB_OF_ITERATIONS;
+  nw_gtpv2c_stack_handle_t                hStack = 0;
+  nw_gtpv2c_msg_handle_t                  hMsg = 0;
+  ie_read_counter_t                       counter = {0};
+  nw_gtpv2c_error_t                       error = {0};
+  uint8_t                                 offending_ie_type = 0;
+  uint8_t                                 buf[NW_GTPV2C_MAX_MSG_LEN];
+  struct timespec                         start;
+  double                                  t = 0, t_all = 0;
+  uint64_t                                nb_msgs = 0;
+  int                                     found = 0;
+  nw_rc_t                                 rc = NW_OK;
+
+  CHECK (NW_OK == nwGtpv2cInitialize (&hStack), "stack init");
+
+  // every IE reaches its callback and is found in the message, absent ones are not
+  for (int c = 0; c < NB_OF_CAPTURES; c++) {
+    const s11_capture_t                  *capture = &s11_captures[c];
+
+    memset (&counter, 0, sizeof (counter));
+    rc = s11_decode (hStack, capture, capture->buf, capture->len, NULL, &counter, &hMsg, &error, &offending_ie_type);
+    CHECK (NW_OK == rc, "%s: rc %d", capture->name, rc);
+    CHECK (NW_GTPV2C_CAUSE_REQUEST_ACCEPTED == error.cause, "%s: stack cause %u on IE %u", capture->name, error.cause, error.offendingIe.type);
+    CHECK (capture->nb_msg_ies == counter.nb_ies, "%s: %u IEs read instead of %d", capture->name, counter.nb_ies, capture->nb_msg_ies);
+    CHECK (capture->msg_type == nwGtpv2cMsgGetMsgType (hMsg), "%s: msg type %u", capture->name, nwGtpv2cMsgGetMsgType (hMsg));
+    found = 0;
+    for (int i = 0; i < capture->nb_parser_ies; i++) {
+      found += nwGtpv2cMsgIsIePresent (hMsg, capture->ies[i].type, capture->ies[i].instance) ? 1 : 0;
+    }
+    CHECK (capture->nb_msg_ies == found, "%s: %d IEs present instead of %d", capture->name, found, capture->nb_msg_ies);
+    CHECK (!nwGtpv2cMsgIsIePresent (hMsg, NW_GTPV2C_IE_PRIVATE_EXTENSION, NW_GTPV2C_IE_INSTANCE_ZERO), "%s: private extension present", capture->name);
+    nwGtpv2cMsgDelete (hStack, hMsg);
+  }
+
+  // bearer context of the Modify Bearer Request overrunning the message
+  {
+    const s11_capture_t                  *capture = &s11_captures[2];
+
+    memcpy (buf, capture->buf, capture->len);
+    buf[12 + 2] += 4;
+    rc = s11_decode (hStack, capture, buf, capture->len, NULL, &counter, &hMsg, &error, &offending_ie_type);
+    CHECK (NW_GTPV2C_MSG_MALFORMED == rc, "malformed: rc %d", rc);
+    CHECK (NW_GTPV2C_IE_BEARER_CONTEXT == offending_ie_type, "malformed: offending IE %u", offending_ie_type);
+    nwGtpv2cMsgDelete (hStack, hMsg);
+  }
+
+  // Create Session Response without the mandatory Recovery IE
+  {
+    const s11_capture_t                  *capture = &s11_captures[1];
+    const s11_ie_t                        recovery = {NW_GTPV2C_IE_RECOVERY, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY};
+
+    rc = s11_decode (hStack, capture, capture->buf, capture->len, &recovery, &counter, &hMsg, &error, &offending_ie_type);
+    CHECK (NW_GTPV2C_MANDATORY_IE_MISSING == rc, "missing IE: rc %d", rc);
+    CHECK (NW_GTPV2C_IE_RECOVERY == offending_ie_type, "missing IE: offending IE %u", offending_ie_type);
+    nwGtpv2cMsgDelete (hStack, hMsg);
+  }
+
+  for (int c = 0; c < NB_OF_CAPTURES; c++) {
+    const s11_capture_t                  *capture = &s11_captures[c];
+
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < nb_iterations; i++) {
+      s11_decode (hStack, capture, capture->buf, capture->len, NULL, &counter, &hMsg, &error, &offending_ie_type);
+      nwGtpv2cMsgDelete (hStack, hMsg);
+    }
+    t = elapsed_sec (&start);
+    t_all += t;
+    nb_msgs += nb_iterations;
+    printf ("%-32s %4u bytes: %.0f msgs/s, %.0f ns/msg\n", capture->name, capture->len, nb_iterations / t, t * 1e9 / nb_iterations);
+  }
+  printf ("%-32s           : %.0f msgs/s, %.0f ns/msg\n", "S11 mix", nb_msgs / t_all, t_all * 1e9 / nb_msgs);
+  printf ("PASSED\n");
+  return 0;
+}
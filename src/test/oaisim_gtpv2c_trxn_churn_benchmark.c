@@ -0,0 +1,417 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * GTPv2-C transaction churn of the nwgtpv2c stack on the MME side of S11, with in-process UDP and
+ * timer manager entities: local tunnels are created and looked up, Modify Bearer Requests are sent
+ * with a window of outstanding transactions, each one answered by the SGW when it leaves the window,
+ * and Downlink Data Notifications of the SGW are acknowledged by the ULP then held by the stack for
+ * duplicate detection. Reports the time per tunnel operation and per transaction.
+ * Then checks in real time (about 6 s) the retransmission of requests left unanswered: sent
+ * N3 + 1 times T3 apart, then a single response failure indication to the ULP; and that a duplicate
+ * request gets the held response again until the hold timer (T3 * N3) expires.
+ * Returns non zero on a failed check.
+ *
+ * usage: oaisim_gtpv2c_trxn_churn_benchmark [nb_tunnels] [nb_transactions] [window]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "NwTypes.h"
+#include "NwError.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+
+#define NB_OF_TUNNELS             100000
+#define NB_OF_TRANSACTIONS        1000000
+// Outstanding transactions, below the 10000 stack timers the former min-heap could hold
+#define WINDOW                    8192
+#define NB_OF_UNANSWERED          64
+// Stack defaults of a transaction
+#define T3_SEC                    2
+#define N3                        2
+#define TIMING_TOLERANCE_SEC      0.05
+
+#define LOCAL_TEID(i)             (0x00010000 + (uint32_t)(i))
+#define REMOTE_TEID(i)            (0x80010000 + (uint32_t)(i))
+#define GTPV2C_PORT               2123
+
+/* Modify Bearer Response, 46 bytes */
+static const uint8_t                      s11_modify_bearer_response[] = {
+  0x48, 0x23, 0x00, 0x2a, 0x00, 0x00, 0x00, 0x01, 0x00, 0x1a, 0x2c, 0x00, 0x02, 0x00, 0x02, 0x00,
+  0x10, 0x00, 0x5d, 0x00, 0x18, 0x00, 0x49, 0x00, 0x01, 0x00, 0x05, 0x02, 0x00, 0x02, 0x00, 0x10,
+  0x00, 0x57, 0x00, 0x09, 0x00, 0x81, 0x00, 0x00, 0x02, 0x01, 0xc0, 0xa8, 0x0c, 0x02,
+};
+
+/* Downlink Data Notification, 22 bytes */
+static const uint8_t                      s11_downlink_data_notification[] = {
+  0x48, 0xb0, 0x00, 0x12, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x42, 0x00, 0x49, 0x00, 0x01, 0x00,
+  0x05, 0x9b, 0x00, 0x01, 0x00, 0x24,
+};
+
+typedef struct stub_timer_s {
+  bool                                    active;
+  struct timespec                         expiry;
+  void                                   *arg;
+} stub_timer_t;
+
+#define NB_OF_STUB_TIMERS         64
+
+typedef struct unanswered_req_s {
+  uint32_t                                seq;
+  int                                     nb_sends;
+  int                                     nb_failures;
+  struct timespec                         first_send;
+  struct timespec                         last_send;
+  double                                  min_gap;
+  double                                  max_gap;
+  double                                  failure_delay;
+} unanswered_req_t;
+
+static nw_gtpv2c_stack_handle_t           hStack = 0;
+static stub_timer_t                       stub_timers[NB_OF_STUB_TIMERS];
+static uint64_t                           nb_tmr_starts = 0;
+static uint64_t                           nb_udp_sends = 0;
+static uint32_t                           last_seq = 0;
+static uint64_t                           nb_req_inds = 0;
+static uint64_t                           nb_rsp_inds = 0;
+static uint64_t                           nb_failure_inds = 0;
+static nw_gtpv2c_trxn_handle_t            last_req_trxn = 0;
+static bool                               tracking = false;
+static unanswered_req_t                   unanswered[NB_OF_UNANSWERED];
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static double diff_sec (const struct timespec * const start, const struct timespec * const stop)
+{
+  return (double)(stop->tv_sec - start->tv_sec) + (double)(stop->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * UDP entity: records the sequence number of the datagram and the sends of the unanswered requests
+ */
+static nw_rc_t stub_udp_data_req (nw_gtpv2c_udp_handle_t hUdp, uint8_t * dataBuf, uint32_t dataSize, struct in_addr *peerIp, uint16_t peerPort)
+{
+  const uint8_t                          *seq = dataBuf + ((dataBuf[0] & 0x08) ? 8 : 4);
+  struct timespec                         now;
+  double                                  gap = 0;
+
+  nb_udp_sends++;
+  last_seq = ((uint32_t) seq[0] << 16) | ((uint32_t) seq[1] << 8) | seq[2];
+  if (tracking) {
+    for (int k = 0; k < NB_OF_UNANSWERED; k++) {
+      if ((unanswered[k].nb_sends) && (unanswered[k].seq == last_seq)) {
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        gap = diff_sec (&unanswered[k].last_send, &now);
+        unanswered[k].min_gap = (gap < unanswered[k].min_gap) ? gap : unanswered[k].min_gap;
+        unanswered[k].max_gap = (gap > unanswered[k].max_gap) ? gap : unanswered[k].max_gap;
+        unanswered[k].last_send = now;
+        unanswered[k].nb_sends++;
+        break;
+      }
+    }
+  }
+  return NW_OK;
+}
+
+/*
+ * Timer manager entity: the expired timers are given back to the stack by stub_tmr_run_next()
+ */
+static nw_rc_t stub_tmr_start (nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle, uint32_t timeoutSec, uint32_t timeoutUsec, uint32_t tmrType, void *tmrArg, nw_gtpv2c_timer_handle_t * tmrHandle)
+{
+  for (int i = 0; i < NB_OF_STUB_TIMERS; i++) {
+    if (!stub_timers[i].active) {
+      clock_gettime (CLOCK_MONOTONIC, &stub_timers[i].expiry);
+      stub_timers[i].expiry.tv_sec += timeoutSec + (stub_timers[i].expiry.tv_nsec + (long)timeoutUsec * 1000) / 1000000000;
+      stub_timers[i].expiry.tv_nsec = (stub_timers[i].expiry.tv_nsec + (long)timeoutUsec * 1000) % 1000000000;
+      stub_timers[i].arg = tmrArg;
+      stub_timers[i].active = true;
+      *tmrHandle = (nw_gtpv2c_timer_handle_t) (i + 1);
+      nb_tmr_starts++;
+      return NW_OK;
+    }
+  }
+  return NW_FAILURE;
+}
+
+static nw_rc_t stub_tmr_stop (nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle, nw_gtpv2c_timer_handle_t tmrHandle)
+{
+  if ((tmrHandle < 1) || (tmrHandle > NB_OF_STUB_TIMERS)) {
+    return NW_FAILURE;
+  }
+  stub_timers[tmrHandle - 1].active = false;
+  return NW_OK;
+}
+
+/*
+ * Waits for the first timer to expire and gives it back to the stack, false when no timer is running
+ */
+static bool stub_tmr_run_next (void)
+{
+  stub_timer_t                           *first = NULL;
+
+  for (int i = 0; i < NB_OF_STUB_TIMERS; i++) {
+    if ((stub_timers[i].active) && ((!first) || (diff_sec (&stub_timers[i].expiry, &first->expiry) > 0))) {
+      first = &stub_timers[i];
+    }
+  }
+  if (!first) {
+    return false;
+  }
+  while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &first->expiry, NULL));
+  first->active = false;
+  nwGtpv2cProcessTimeout (first->arg);
+  return true;
+}
+
+/*
+ * ULP entity: counts the indications and releases their message
+ */
+static nw_rc_t stub_ulp_req (nw_gtpv2c_ulp_handle_t hUlp, nw_gtpv2c_ulp_api_t * pUlpApi)
+{
+  struct timespec                         now;
+  int                                     k = 0;
+
+  switch (pUlpApi->apiType) {
+  case NW_GTPV2C_ULP_API_INITIAL_REQ_IND:
+    nb_req_inds++;
+    last_req_trxn = pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
+    break;
+
+  case NW_GTPV2C_ULP_API_TRIGGERED_RSP_IND:
+    nb_rsp_inds++;
+    break;
+
+  case NW_GTPV2C_ULP_API_RSP_FAILURE_IND:
+    nb_failure_inds++;
+    k = (int)pUlpApi->u_api_info.rspFailureInfo.hUlpTrxn - 1;
+    if ((k >= 0) && (k < NB_OF_UNANSWERED)) {
+      clock_gettime (CLOCK_MONOTONIC, &now);
+      unanswered[k].failure_delay = diff_sec (&unanswered[k].first_send, &now);
+      unanswered[k].nb_failures++;
+    }
+    break;
+
+  default:
+    break;
+  }
+  if (pUlpApi->hMsg) {
+    nwGtpv2cMsgDelete (hStack, pUlpApi->hMsg);
+  }
+  return NW_OK;
+}
+
+static nw_rc_t send_modify_bearer_request (const nw_gtpv2c_tunnel_handle_t hTunnel, const uint32_t teid_remote, const struct in_addr * const sgw,
+    const nw_gtpv2c_ulp_trxn_handle_t hUlpTrxn)
+{
+  nw_gtpv2c_ulp_api_t                     ulp_req;
+
+  memset (&ulp_req, 0, sizeof (ulp_req));
+  if (NW_OK != nwGtpv2cMsgNew (hStack, true, NW_GTP_MODIFY_BEARER_REQ, teid_remote, 0, &ulp_req.hMsg)) {
+    return NW_FAILURE;
+  }
+  nwGtpv2cMsgAddIeTV1 (ulp_req.hMsg, NW_GTPV2C_IE_EBI, NW_GTPV2C_IE_INSTANCE_ZERO, 5);
+  ulp_req.apiType = NW_GTPV2C_ULP_API_INITIAL_REQ;
+  ulp_req.u_api_info.initialReqInfo.hTunnel = hTunnel;
+  ulp_req.u_api_info.initialReqInfo.hUlpTrxn = hUlpTrxn;
+  ulp_req.u_api_info.initialReqInfo.peerIp = *sgw;
+  return nwGtpv2cProcessUlpReq (hStack, &ulp_req);
+}
+
+static nw_rc_t send_downlink_data_notification_ack (const uint32_t teid_remote)
+{
+  nw_gtpv2c_ulp_api_t                     ulp_req;
+
+  memset (&ulp_req, 0, sizeof (ulp_req));
+  if (NW_OK != nwGtpv2cMsgNew (hStack, true, NW_GTP_DOWNLINK_DATA_NOTIFICATION_ACK, teid_remote, 0, &ulp_req.hMsg)) {
+    return NW_FAILURE;
+  }
+  nwGtpv2cMsgAddIeCause (ulp_req.hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_CAUSE_REQUEST_ACCEPTED, 0, 0, 0);
+  ulp_req.apiType = NW_GTPV2C_ULP_API_TRIGGERED_RSP;
+  ulp_req.u_api_info.triggeredRspInfo.hTrxn = last_req_trxn;
+  return nwGtpv2cProcessUlpReq (hStack, &ulp_req);
+}
+
+static void set_header (uint8_t * const buf, const uint32_t teid, const uint32_t seq)
+{
+  buf[4] = (uint8_t)(teid >> 24);
+  buf[5] = (uint8_t)(teid >> 16);
+  buf[6] = (uint8_t)(teid >> 8);
+  buf[7] = (uint8_t)teid;
+  buf[8] = (uint8_t)(seq >> 16);
+  buf[9] = (uint8_t)(seq >> 8);
+  buf[10] = (uint8_t)seq;
+}
+
+#define CHECK(cOnD, ...) do { if (!(cOnD)) { fprintf (stderr, "FAILED line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); fprintf (stderr, "\n"); return 1; } } while (0)
+
+int main (int argc, char *argv[])
+{
+  const int                               nb_tunnels = (argc > 1) ? atoi (argv[1]) : NB_OF_TUNNELS;
+  const int                               nb_transactions = (argc > 2) ? atoi (argv[2]) : NB_OF_TRANSACTIONS;
+  const int                               window = (argc > 3) ? atoi (argv[3]) : WINDOW;
+  nw_gtpv2c_ulp_entity_t                  ulp = {0};
+  nw_gtpv2c_udp_entity_t                  udp = {0};
+  nw_gtpv2c_timer_mgr_entity_t            tmr_mgr = {0};
+  nw_gtpv2c_ulp_api_t                     ulp_req;
+  nw_gtpv2c_tunnel_handle_t              *tunnels = NULL;
+  uint32_t                               *window_seq = NULL;
+  struct in_addr                          sgw = {.s_addr = htonl (0xc0a80b12)};
+  uint8_t                                 rsp[sizeof (s11_modify_bearer_response)];
+  uint8_t                                 ddn[sizeof (s11_downlink_data_notification)];
+  struct timespec                         start;
+  double                                  t = 0;
+  uint64_t                                nb_sends = 0, nb_inds = 0, nb_starts = 0;
+
+  CHECK ((nb_tunnels > 0) && (nb_transactions > 0) && (window > 0), "usage: %s [nb_tunnels] [nb_transactions] [window]", argv[0]);
+  tunnels = calloc (nb_tunnels, sizeof (nw_gtpv2c_tunnel_handle_t));
+  window_seq = calloc (window, sizeof (uint32_t));
+  CHECK (tunnels && window_seq, "allocation");
+  CHECK (NW_OK == nwGtpv2cInitialize (&hStack), "stack init");
+  ulp.ulpReqCallback = stub_ulp_req;
+  udp.udpDataReqCallback = stub_udp_data_req;
+  tmr_mgr.tmrStartCallback = stub_tmr_start;
+  tmr_mgr.tmrStopCallback = stub_tmr_stop;
+  CHECK (NW_OK == nwGtpv2cSetUlpEntity (hStack, &ulp), "ULP entity");
+  CHECK (NW_OK == nwGtpv2cSetUdpEntity (hStack, &udp), "UDP entity");
+  CHECK (NW_OK == nwGtpv2cSetTimerMgrEntity (hStack, &tmr_mgr), "timer manager entity");
+
+  // local tunnels, one per UE
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < nb_tunnels; i++) {
+    memset (&ulp_req, 0, sizeof (ulp_req));
+    ulp_req.apiType = NW_GTPV2C_ULP_CREATE_LOCAL_TUNNEL;
+    ulp_req.u_api_info.createLocalTunnelInfo.teidLocal = LOCAL_TEID (i);
+    ulp_req.u_api_info.createLocalTunnelInfo.peerIp = sgw;
+    CHECK (NW_OK == nwGtpv2cProcessUlpReq (hStack, &ulp_req), "create tunnel %d", i);
+    tunnels[i] = ulp_req.u_api_info.createLocalTunnelInfo.hTunnel;
+    CHECK (tunnels[i], "create tunnel %d: no handle", i);
+  }
+  t = elapsed_sec (&start);
+  printf ("%-32s: %.0f ns/tunnel (%d tunnels)\n", "create local tunnel", t * 1e9 / nb_tunnels, nb_tunnels);
+
+  memset (&ulp_req, 0, sizeof (ulp_req));
+  ulp_req.apiType = NW_GTPV2C_ULP_CREATE_LOCAL_TUNNEL;
+  ulp_req.u_api_info.createLocalTunnelInfo.teidLocal = LOCAL_TEID (0);
+  ulp_req.u_api_info.createLocalTunnelInfo.peerIp = sgw;
+  CHECK (NW_FAILURE == nwGtpv2cProcessUlpReq (hStack, &ulp_req), "duplicate tunnel created");
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < nb_tunnels; i++) {
+    memset (&ulp_req, 0, sizeof (ulp_req));
+    ulp_req.apiType = NW_GTPV2C_ULP_FIND_LOCAL_TUNNEL;
+    ulp_req.u_api_info.findLocalTunnelInfo.teidLocal = LOCAL_TEID ((i * 7919) % nb_tunnels);
+    ulp_req.u_api_info.findLocalTunnelInfo.peerIp = sgw;
+    nwGtpv2cProcessUlpReq (hStack, &ulp_req);
+    CHECK (tunnels[(i * 7919) % nb_tunnels] == ulp_req.u_api_info.findLocalTunnelInfo.hTunnel, "find tunnel %d", (i * 7919) % nb_tunnels);
+  }
+  t = elapsed_sec (&start);
+  printf ("%-32s: %.0f ns/tunnel\n", "find local tunnel", t * 1e9 / nb_tunnels);
+
+  // MME initiated transactions, answered by the SGW when they leave the window
+  memcpy (rsp, s11_modify_bearer_response, sizeof (rsp));
+  nb_sends = nb_udp_sends;
+  nb_starts = nb_tmr_starts;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < nb_transactions + window; i++) {
+    if (i >= window) {
+      set_header (rsp, LOCAL_TEID ((i - window) % nb_tunnels), window_seq[i % window]);
+      nwGtpv2cProcessUdpReq (hStack, rsp, sizeof (rsp), GTPV2C_PORT, &sgw);
+    }
+    if (i < nb_transactions) {
+      send_modify_bearer_request (tunnels[i % nb_tunnels], REMOTE_TEID (i % nb_tunnels), &sgw, 0);
+      window_seq[i % window] = last_seq;
+    }
+  }
+  t = elapsed_sec (&start);
+  printf ("%-32s: %.0f ns/transaction (window %d), %.3f ULP timer starts/transaction\n", "Modify Bearer Request/Response", t * 1e9 / nb_transactions,
+      window, (double)(nb_tmr_starts - nb_starts) / nb_transactions);
+  CHECK ((uint64_t)nb_transactions == nb_udp_sends - nb_sends, "%" PRIu64 " requests sent instead of %d", nb_udp_sends - nb_sends, nb_transactions);
+  CHECK ((uint64_t)nb_transactions == nb_rsp_inds, "%" PRIu64 " responses indicated instead of %d", nb_rsp_inds, nb_transactions);
+  CHECK (0 == nb_failure_inds, "%" PRIu64 " response failures", nb_failure_inds);
+
+  // SGW initiated transactions, acknowledged by the ULP and held for duplicate detection
+  memcpy (ddn, s11_downlink_data_notification, sizeof (ddn));
+  nb_inds = nb_req_inds;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < window; i++) {
+    set_header (ddn, LOCAL_TEID (i % nb_tunnels), i);
+    nwGtpv2cProcessUdpReq (hStack, ddn, sizeof (ddn), GTPV2C_PORT, &sgw);
+    send_downlink_data_notification_ack (REMOTE_TEID (i % nb_tunnels));
+  }
+  t = elapsed_sec (&start);
+  printf ("%-32s: %.0f ns/transaction (%d held)\n", "Downlink Data Notification/Ack", t * 1e9 / window, window);
+  CHECK ((uint64_t)window == nb_req_inds - nb_inds, "%" PRIu64 " requests indicated instead of %d", nb_req_inds - nb_inds, window);
+
+  set_header (ddn, LOCAL_TEID (0), 0);
+  nb_sends = nb_udp_sends;
+  nb_inds = nb_req_inds;
+  nwGtpv2cProcessUdpReq (hStack, ddn, sizeof (ddn), GTPV2C_PORT, &sgw);
+  CHECK ((nb_inds == nb_req_inds) && (nb_sends + 1 == nb_udp_sends), "duplicate request: %" PRIu64 " indications, %" PRIu64 " sends",
+      nb_req_inds - nb_inds, nb_udp_sends - nb_sends);
+
+  // requests left unanswered, retransmitted on T3 expiry then reported as failed
+  tracking = true;
+  for (int k = 0; k < NB_OF_UNANSWERED; k++) {
+    CHECK (NW_OK == send_modify_bearer_request (tunnels[k % nb_tunnels], REMOTE_TEID (k % nb_tunnels), &sgw, k + 1), "unanswered request %d", k);
+    unanswered[k].seq = last_seq;
+    unanswered[k].nb_sends = 1;
+    unanswered[k].min_gap = 1e9;
+    clock_gettime (CLOCK_MONOTONIC, &unanswered[k].first_send);
+    unanswered[k].last_send = unanswered[k].first_send;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  while (stub_tmr_run_next ());
+  printf ("%-32s: all stack timers expired after %.3f s\n", "retransmissions", elapsed_sec (&start));
+  CHECK (NB_OF_UNANSWERED == nb_failure_inds, "%" PRIu64 " response failures instead of %d", nb_failure_inds, NB_OF_UNANSWERED);
+  for (int k = 0; k < NB_OF_UNANSWERED; k++) {
+    CHECK (1 + N3 == unanswered[k].nb_sends, "request %d sent %d times", k, unanswered[k].nb_sends);
+    CHECK ((unanswered[k].min_gap > T3_SEC - TIMING_TOLERANCE_SEC) && (unanswered[k].max_gap < T3_SEC + TIMING_TOLERANCE_SEC),
+        "request %d retransmitted after %.3f to %.3f s", k, unanswered[k].min_gap, unanswered[k].max_gap);
+    CHECK (1 == unanswered[k].nb_failures, "request %d: %d response failures", k, unanswered[k].nb_failures);
+    CHECK ((unanswered[k].failure_delay > T3_SEC * (N3 + 1) - TIMING_TOLERANCE_SEC) && (unanswered[k].failure_delay < T3_SEC * (N3 + 1) + TIMING_TOLERANCE_SEC),
+        "request %d failed after %.3f s", k, unanswered[k].failure_delay);
+  }
+
+  // the hold timer has expired, the same request is a new one
+  nb_inds = nb_req_inds;
+  nwGtpv2cProcessUdpReq (hStack, ddn, sizeof (ddn), GTPV2C_PORT, &sgw);
+  CHECK (nb_inds + 1 == nb_req_inds, "request after hold timer: %" PRIu64 " indications", nb_req_inds - nb_inds);
+
+  free (window_seq);
+  free (tunnels);
+  printf ("PASSED\n");
+  return 0;
+}
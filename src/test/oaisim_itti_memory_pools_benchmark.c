@@ -0,0 +1,240 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * ITTI message memory pools (memory_pools.c) with the default ITTI geometry, nb_threads threads allocating and
+ * freeing message sized items (mostly under 1000 bytes, a few big ones), without and with the per thread magazine
+ * caches:
+ *   - local: each thread frees what it allocated, by bursts of BURST items,
+ *   - handoff: each thread frees the burst allocated by the previous one (a task freeing the messages it receives),
+ * and reports allocations + frees per second. After the threads exit, checks that every item is back and can be
+ * allocated again, also those cached by a thread still running, and prints the per thread (info_0) statistics.
+ * Returns non zero if an allocation fails or items are lost.
+ *
+ * usage: oaisim_itti_memory_pools_benchmark [nb_threads [nb_bursts]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "memory_pools.h"
+#include "intertask_interface_conf.h"
+
+#define NB_OF_THREADS             8
+#define NB_OF_BURSTS              20000
+#define BURST                     64
+#define MAX_THREADS               64
+
+typedef struct bench_thread_s {
+  pthread_t                               thread;
+  uint16_t                                id;
+  void                                   *items[BURST];
+  int                                     failed;
+} bench_thread_t;
+
+static memory_pools_handle_t            pools;
+static bench_thread_t                   threads[MAX_THREADS];
+static int                              nb_threads = NB_OF_THREADS;
+static int                              nb_bursts = NB_OF_BURSTS;
+static bool                             handoff = false;
+static pthread_barrier_t                barrier;
+static char                             thread_names[MAX_THREADS][16];
+static pthread_barrier_t                holder_barrier;
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static const char *thread_name (uint16_t info_0)
+{
+  return thread_names[info_0];
+}
+
+// S1AP/NAS message sizes: mostly small, one in 16 around 1 Kbytes, one in 1024 big
+static uint32_t item_size (const uint32_t i)
+{
+  if (0 == (i % 1024)) {
+    return 20000;
+  }
+  if (0 == (i % 16)) {
+    return 800;
+  }
+  return 40 + (i % 3) * 30;
+}
+
+static void *bench_thread (void *arg)
+{
+  bench_thread_t                         *t = (bench_thread_t *)arg;
+  bench_thread_t                         *from = &threads[(t->id + nb_threads - 1) % nb_threads];
+  uint32_t                                n = t->id;
+
+  for (int burst = 0; (burst < nb_bursts) && (!t->failed); burst++) {
+    for (int i = 0; i < BURST; i++) {
+      t->items[i] = memory_pools_allocate (pools, item_size (n++), t->id, (t->id + 1) % nb_threads);
+      if (t->items[i] == NULL) {
+        fprintf (stderr, "FAILED thread %u burst %d: allocation %d\n", t->id, burst, i);
+        t->failed = 1;
+        // keep the barrier count right
+        for (; i < BURST; i++) {
+          t->items[i] = NULL;
+        }
+      }
+    }
+    if (handoff) {
+      pthread_barrier_wait (&barrier);
+    }
+    for (int i = 0; i < BURST; i++) {
+      void *item = handoff ? from->items[i] : t->items[i];
+
+      if (item) {
+        memory_pools_free (pools, item, t->id);
+      }
+    }
+    if (handoff) {
+      pthread_barrier_wait (&barrier);
+    }
+  }
+  return NULL;
+}
+
+static int run (const char * const name)
+{
+  struct timespec                         start;
+  double                                  sec = 0;
+  int                                     failed = 0;
+
+  pthread_barrier_init (&barrier, NULL, nb_threads);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < nb_threads; i++) {
+    threads[i].id = i;
+    threads[i].failed = 0;
+    pthread_create (&threads[i].thread, NULL, bench_thread, &threads[i]);
+  }
+  for (int i = 0; i < nb_threads; i++) {
+    pthread_join (threads[i].thread, NULL);
+    failed |= threads[i].failed;
+  }
+  sec = elapsed_sec (&start);
+  pthread_barrier_destroy (&barrier);
+  printf ("%-28s %d threads: %.3f s, %.0f alloc+free/s\n", name, nb_threads, sec, ((double)nb_threads * nb_bursts * BURST) / sec);
+  return failed;
+}
+
+// keeps the items it freed in its cache while the main thread checks that every item can be allocated
+static void *holder_thread (void *arg)
+{
+  void                                   *items[BURST];
+
+  for (uint32_t i = 0; i < BURST; i++) {
+    items[i] = memory_pools_allocate (pools, item_size (i), 0, 0);
+  }
+  for (uint32_t i = 0; i < BURST; i++) {
+    if (items[i]) {
+      memory_pools_free (pools, items[i], 0);
+    }
+  }
+  pthread_barrier_wait (&holder_barrier);
+  pthread_barrier_wait (&holder_barrier);
+  return NULL;
+}
+
+// every item of every pool is back: the allocations from this thread (a 1 byte item fits in any pool) get all of them
+static int check_all_free (const uint32_t total_items)
+{
+  void                                  **items = calloc (total_items + 1, sizeof (void *));
+  uint32_t                                n = 0;
+
+  while ((n <= total_items) && (NULL != (items[n] = memory_pools_allocate (pools, 1, 0, 0)))) {
+    n++;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    memory_pools_free (pools, items[i], 0);
+  }
+  free (items);
+  if (n != total_items) {
+    fprintf (stderr, "FAILED %u items allocated, %u expected\n", n, total_items);
+    return 1;
+  }
+  return 0;
+}
+
+int main (int argc, char *argv[])
+{
+  const memory_pools_config_t             config = ITTI_MEMORY_POOLS_DEFAULT_CONFIG;
+  uint32_t                                total_items = 0;
+  int                                     failed = 0;
+  char                                   *statistics = NULL;
+
+  nb_threads = (argc > 1) ? atoi (argv[1]) : NB_OF_THREADS;
+  nb_bursts = (argc > 2) ? atoi (argv[2]) : NB_OF_BURSTS;
+  if ((nb_threads < 1) || (nb_threads > MAX_THREADS)) {
+    fprintf (stderr, "FAILED bad number of threads %d\n", nb_threads);
+    return 1;
+  }
+  for (int i = 0; i < MAX_THREADS; i++) {
+    snprintf (thread_names[i], sizeof (thread_names[i]), "thread %d", i);
+  }
+  for (uint32_t pool = 0; pool < config.pools_number; pool++) {
+    total_items += config.pools[pool].items_number;
+  }
+
+  for (int magazines = 0; (magazines < 2) && (!failed); magazines++) {
+    pools = memory_pools_create (config.pools_number);
+    for (uint32_t pool = 0; pool < config.pools_number; pool++) {
+      memory_pools_add_pool (pools, config.pools[pool].items_number, config.pools[pool].item_size);
+    }
+    memory_pools_set_magazine_size (pools, magazines ? config.magazine_size : 0, nb_threads + 2);
+    memory_pools_set_info_statistics (pools, MAX_THREADS, thread_name);
+
+    handoff = false;
+    failed |= run (magazines ? "local, magazines:" : "local, shared rings:");
+    handoff = true;
+    failed |= run (magazines ? "handoff, magazines:" : "handoff, shared rings:");
+    {
+      pthread_t                               holder;
+
+      pthread_barrier_init (&holder_barrier, NULL, 2);
+      pthread_create (&holder, NULL, holder_thread, NULL);
+      pthread_barrier_wait (&holder_barrier);
+      failed |= check_all_free (total_items);
+      pthread_barrier_wait (&holder_barrier);
+      pthread_join (holder, NULL);
+      pthread_barrier_destroy (&holder_barrier);
+    }
+    if (magazines) {
+      statistics = memory_pools_statistics (pools);
+      printf ("%s", statistics);
+      free (statistics);
+    }
+    // no destroy in the memory pools API, the handle is leaked
+  }
+  printf ("%s\n", failed ? "FAILED" : "PASSED");
+  return failed;
+}
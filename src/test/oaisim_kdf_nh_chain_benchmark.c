@@ -0,0 +1,231 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * 3GPP KDF (TS 33.401 annex A) derivations from K ASME, for nb_ues UEs:
+ *   - attach: K NASint, K NASenc and KeNB,
+ *   - handover: a chain of nb_handovers NH derivations per UE (X2/S1 handovers and path switches),
+ * reported in derivations/s for
+ *   - the former kdf(): hmac_sha256_ctx calloc'ed and HMAC key set up at each derivation,
+ *   - derive_key_nas(), derive_keNB(), derive_nh(): HMAC key set up at each derivation,
+ *   - the *_with_context() functions: HMAC pad states of K ASME set up once per UE, batch derivation
+ *     at attach.
+ * The keys and the NH chains are checked to be the same for the three ways.
+ * Returns non zero if a key differs.
+ *
+ * usage: oaisim_kdf_nh_chain_benchmark [nb_ues] [nb_handovers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include <nettle/hmac.h>
+
+#include "secu_defs.h"
+
+#define NB_OF_UES                 10000
+#define NB_OF_HANDOVERS           32
+#define KEY_SIZE                  32
+#define UL_NAS_COUNT              0x0103
+#define EIA2                      2
+#define EEA2                      2
+
+#define CHECK(cOnD, ...) do { if (!(cOnD)) { fprintf (stderr, "FAILED line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); fprintf (stderr, "\n"); return 1; } } while (0)
+
+typedef struct ue_keys_s {
+  uint8_t                                 kasme[KEY_SIZE];
+  kdf_context_t                           kasme_context;
+  uint8_t                                 knas_int[16];
+  uint8_t                                 knas_enc[16];
+  uint8_t                                 kenb[KEY_SIZE];
+  uint8_t                                 nh[KEY_SIZE];
+} ue_keys_t;
+
+typedef enum {
+  MODE_FORMER = 0,
+  MODE_KEY_PER_DERIVATION,
+  MODE_CONTEXT,
+  MODE_MAX
+} bench_mode_t;
+
+static const char * const mode_names[MODE_MAX] = {
+  "former kdf",
+  "key per derivation",
+  "kasme context",
+};
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//------------------------------------------------------------------------------
+// kdf() and the derivations as they were before kdf_context_t
+static void former_kdf (const uint8_t * key, const unsigned key_len, uint8_t * s, const unsigned s_len, uint8_t * out, const unsigned out_len)
+{
+  struct hmac_sha256_ctx                 *ctx = calloc (1, sizeof (struct hmac_sha256_ctx));
+
+  hmac_sha256_set_key (ctx, key_len, key);
+  hmac_sha256_update (ctx, s_len, s);
+  hmac_sha256_digest (ctx, out_len, out);
+  free (ctx);
+}
+
+static void former_derive_key_nas (algorithm_type_dist_t nas_alg_type, uint8_t nas_alg_id, const uint8_t * kasme, uint8_t * knas)
+{
+  uint8_t                                 s[7] = {FC_ALG_KEY_DER, (uint8_t) nas_alg_type, 0x00, 0x01, nas_alg_id, 0x00, 0x01};
+  uint8_t                                 out[32] = {0};
+
+  former_kdf (kasme, 32, s, 7, out, 32);
+  memcpy (knas, &out[16], 16);
+}
+
+static void former_derive_kenb (const uint8_t * kasme, const uint32_t nas_count, uint8_t * kenb)
+{
+  uint8_t                                 s[7] = {FC_KENB, (uint8_t)(nas_count >> 24), (uint8_t)(nas_count >> 16), (uint8_t)(nas_count >> 8), (uint8_t) nas_count, 0x00, 0x04};
+
+  former_kdf (kasme, 32, s, 7, kenb, 32);
+}
+
+static void former_derive_nh (const uint8_t * kasme, uint8_t * nh)
+{
+  uint8_t                                 s[35] = {FC_NH};
+
+  memcpy (s + 1, nh, 32);
+  s[33] = 0x00;
+  s[34] = 0x20;
+  former_kdf (kasme, 32, s, 35, nh, 32);
+}
+
+//------------------------------------------------------------------------------
+static void attach (const bench_mode_t mode, ue_keys_t * const ue)
+{
+  switch (mode) {
+  case MODE_FORMER:
+    former_derive_key_nas (NAS_INT_ALG, EIA2, ue->kasme, ue->knas_int);
+    former_derive_key_nas (NAS_ENC_ALG, EEA2, ue->kasme, ue->knas_enc);
+    former_derive_kenb (ue->kasme, UL_NAS_COUNT, ue->kenb);
+    break;
+  case MODE_KEY_PER_DERIVATION:
+    derive_key_nas (NAS_INT_ALG, EIA2, ue->kasme, ue->knas_int);
+    derive_key_nas (NAS_ENC_ALG, EEA2, ue->kasme, ue->knas_enc);
+    derive_keNB (ue->kasme, UL_NAS_COUNT, ue->kenb);
+    break;
+  case MODE_CONTEXT:
+    kdf_context_init (&ue->kasme_context, ue->kasme, KEY_SIZE);
+    derive_keys_nas_enb_with_context (&ue->kasme_context, EIA2, EEA2, UL_NAS_COUNT, ue->knas_int, ue->knas_enc, ue->kenb);
+    break;
+  default:
+    break;
+  }
+  // NH0 is KeNB (initial context setup)
+  memcpy (ue->nh, ue->kenb, KEY_SIZE);
+}
+
+static void handover (const bench_mode_t mode, ue_keys_t * const ue)
+{
+  switch (mode) {
+  case MODE_FORMER:             former_derive_nh (ue->kasme, ue->nh); break;
+  case MODE_KEY_PER_DERIVATION: derive_nh (ue->kasme, ue->nh); break;
+  case MODE_CONTEXT:            derive_nh_with_context (&ue->kasme_context, ue->nh); break;
+  default: break;
+  }
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  const uint32_t                          nb_ues = (argc > 1) ? (uint32_t)atoi (argv[1]) : NB_OF_UES;
+  const uint32_t                          nb_handovers = (argc > 2) ? (uint32_t)atoi (argv[2]) : NB_OF_HANDOVERS;
+  ue_keys_t                              *ues[MODE_MAX] = {NULL};
+  struct timespec                         start;
+  double                                  t = 0;
+
+  if (0 == nb_ues) {
+    fprintf (stderr, "nb_ues must be > 0\n");
+    return 1;
+  }
+  srand (1);
+  for (bench_mode_t mode = MODE_FORMER; mode < MODE_MAX; mode++) {
+    ues[mode] = calloc (nb_ues, sizeof (ue_keys_t));
+  }
+  for (uint32_t u = 0; u < nb_ues; u++) {
+    for (int i = 0; i < KEY_SIZE; i++) {
+      ues[MODE_FORMER][u].kasme[i] = (uint8_t)(rand () >> 7);
+    }
+    memcpy (ues[MODE_KEY_PER_DERIVATION][u].kasme, ues[MODE_FORMER][u].kasme, KEY_SIZE);
+    memcpy (ues[MODE_CONTEXT][u].kasme, ues[MODE_FORMER][u].kasme, KEY_SIZE);
+  }
+
+  printf ("%u UEs, %u handovers per UE\n", nb_ues, nb_handovers);
+  for (bench_mode_t mode = MODE_FORMER; mode < MODE_MAX; mode++) {
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    for (uint32_t u = 0; u < nb_ues; u++) {
+      attach (mode, &ues[mode][u]);
+    }
+    t = elapsed_sec (&start);
+    printf ("%-20s attach:   %.3f s, %9.0f derivations/s\n", mode_names[mode], t, 3 * nb_ues / t);
+
+    // handovers interleaved between UEs, as they come
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    for (uint32_t h = 0; h < nb_handovers; h++) {
+      for (uint32_t u = 0; u < nb_ues; u++) {
+        handover (mode, &ues[mode][u]);
+      }
+    }
+    t = elapsed_sec (&start);
+    printf ("%-20s NH chain: %.3f s, %9.0f derivations/s\n", mode_names[mode], t, (double)nb_handovers * nb_ues / t);
+  }
+
+  for (uint32_t u = 0; u < nb_ues; u++) {
+    for (bench_mode_t mode = MODE_KEY_PER_DERIVATION; mode < MODE_MAX; mode++) {
+      const ue_keys_t * const                 ref = &ues[MODE_FORMER][u];
+      const ue_keys_t * const                 ue = &ues[mode][u];
+
+      CHECK (0 == memcmp (ue->knas_int, ref->knas_int, 16), "%s UE %u K NASint", mode_names[mode], u);
+      CHECK (0 == memcmp (ue->knas_enc, ref->knas_enc, 16), "%s UE %u K NASenc", mode_names[mode], u);
+      CHECK (0 == memcmp (ue->kenb, ref->kenb, KEY_SIZE), "%s UE %u KeNB", mode_names[mode], u);
+      CHECK (0 == memcmp (ue->nh, ref->nh, KEY_SIZE), "%s UE %u NH%u", mode_names[mode], u, nb_handovers);
+    }
+  }
+  // the context follows a new K ASME
+  {
+    ue_keys_t * const                       ue = &ues[MODE_CONTEXT][0];
+    uint8_t                                 kenb[KEY_SIZE];
+
+    ue->kasme[0] ^= 0xff;
+    former_derive_kenb (ue->kasme, UL_NAS_COUNT, kenb);
+    derive_keNB_with_context (kdf_context_for_key (&ue->kasme_context, ue->kasme, KEY_SIZE), UL_NAS_COUNT, ue->kenb);
+    CHECK (0 == memcmp (ue->kenb, kenb, KEY_SIZE), "KeNB after K ASME change");
+  }
+  for (bench_mode_t mode = MODE_FORMER; mode < MODE_MAX; mode++) {
+    free (ues[mode]);
+  }
+  printf ("PASSED\n");
+  return 0;
+}
@@ -0,0 +1,560 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Attach scenario played through the MME_APP worker shards (mme_app_shard.c): the coordinator
+ * receives the messages of the UEs, routes them by eNB S1AP key, IMSI, S11 TEID or mme_ue_s1ap_id
+ * through the multikey index and queues them to the shard owning the UE; the shard handles the
+ * message (index updates and a configurable amount of work) and the peer answer is sent back to
+ * the coordinator, like the S1AP, S6A and S11 tasks would do:
+ *
+ *   INITIAL_UE_MESSAGE -> S6A_UPDATE_LOCATION_ANS -> S11_CREATE_SESSION_RESPONSE
+ *   -> MME_APP_INITIAL_CONTEXT_SETUP_RSP -> S11_MODIFY_BEARER_RESPONSE -> S1AP_UE_CONTEXT_RELEASE_COMPLETE
+ *
+ * A statistics message handled by the coordinator after quiesce is injected every STATS_PERIOD
+ * messages. Every message checks that its UE is handled by the shard owning it and in scenario
+ * order. Attaches/s are reported for 0 shards (inline handling) and 1, 2, 4... shards, the scaling
+ * needs as many cores as shards.
+ * Returns non zero if a message is handled out of order or by the wrong shard.
+ *
+ * usage: oaisim_mme_app_shard_benchmark [nb_ues] [max_shards] [work_per_message] [ues_in_flight]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "hashtable.h"
+#include "multikey_index.h"
+
+#define NB_OF_UES               100000
+#define MAX_SHARDS              4
+#define WORK_PER_MESSAGE        2000       // xorshift rounds, ~2us
+#define UES_IN_FLIGHT           4096
+#define STATS_PERIOD            10000
+#define SHARD_QUEUE_INITIAL_SIZE 1024       // same as MME_APP_SHARD_QUEUE_INITIAL_SIZE
+#define SHARD_COORDINATOR       (-1)
+#define INVALID_UE_ID           0xFFFFFFFF
+
+// Same key spaces as mme_app_ue_context.h
+enum {
+  KEY_MME_UE_S1AP_ID = 1,
+  KEY_ENB_S1AP_ID,
+  KEY_IMSI,
+  KEY_S11_TEID,
+};
+
+typedef enum {
+  MSG_INITIAL_UE_MESSAGE = 0,
+  MSG_S6A_UPDATE_LOCATION_ANS,
+  MSG_S11_CREATE_SESSION_RESPONSE,
+  MSG_MME_APP_INITIAL_CONTEXT_SETUP_RSP,
+  MSG_S11_MODIFY_BEARER_RESPONSE,
+  MSG_S1AP_UE_CONTEXT_RELEASE_COMPLETE,
+  MSG_STATISTICS,
+  MSG_UE_DONE,                                // back to the coordinator only
+} msg_id_t;
+
+typedef struct bench_msg_s {
+  struct bench_msg_s                     *next;             // coordinator inbox
+  msg_id_t                                id;
+  uint32_t                                ue;               // scenario only, not used to route
+  uint64_t                                key;              // eNB S1AP key, IMSI, S11 TEID or mme_ue_s1ap_id
+} bench_msg_t;
+
+typedef struct bench_ue_context_s {
+  uint32_t                                mme_ue_s1ap_id;
+  uint64_t                                enb_s1ap_id_key;
+  uint64_t                                imsi;
+  uint32_t                                s11_teid;
+  int                                     owner;
+  uint32_t                                step;
+} bench_ue_context_t;
+
+// Same as mme_app_shard_t
+typedef struct bench_shard_s {
+  int                                     index;
+  pthread_t                               thread;
+  pthread_mutex_t                         mutex;
+  pthread_cond_t                          not_empty;
+  pthread_cond_t                          idle;
+  bench_msg_t                           **queue;
+  uint32_t                                queue_mask;
+  uint64_t                                head;
+  uint64_t                                tail;
+  bool                                    busy;
+  bool                                    terminate;
+  uint32_t                                next_ue_id_rank;
+  uint64_t                                messages_handled;
+} __attribute__((aligned(64))) bench_shard_t;
+
+static uint32_t                           nb_ues = NB_OF_UES;
+static uint32_t                           work_per_message = WORK_PER_MESSAGE;
+static uint32_t                           ues_in_flight = UES_IN_FLIGHT;
+static bench_ue_context_t                *contexts = NULL;
+static multikey_index_t                  *mki = NULL;
+static bench_shard_t                     *shards = NULL;
+static uint16_t                           nb_shards = 0;
+static uint32_t                           inline_ue_id_generator = 1;
+static __thread int                       shard_self = SHARD_COORDINATOR;
+static volatile uint64_t                  nb_errors = 0;
+static volatile uint64_t                  work_sink = 0;
+
+// coordinator inbox, the ITTI queue of TASK_MME_APP
+static pthread_mutex_t                    inbox_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t                     inbox_cond = PTHREAD_COND_INITIALIZER;
+static bench_msg_t                       *inbox_head = NULL;
+static bench_msg_t                       *inbox_tail = NULL;
+
+static double elapsed_ns (
+  const struct timespec * const start,
+  const struct timespec * const stop)
+{
+  return ((double)(stop->tv_sec - start->tv_sec) * 1e9) + (double)(stop->tv_nsec - start->tv_nsec);
+}
+
+static inline uint32_t scramble (uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x7feb352d;
+  x ^= x >> 15;
+  return x;
+}
+
+//------------------------------------------------------------------------------
+static void inbox_send (const msg_id_t id, const uint32_t ue, const uint64_t key)
+{
+  bench_msg_t                            *msg = calloc (1, sizeof (bench_msg_t));
+
+  msg->id = id;
+  msg->ue = ue;
+  msg->key = key;
+  pthread_mutex_lock (&inbox_mutex);
+  if (inbox_tail) {
+    inbox_tail->next = msg;
+  } else {
+    inbox_head = msg;
+  }
+  inbox_tail = msg;
+  pthread_cond_signal (&inbox_cond);
+  pthread_mutex_unlock (&inbox_mutex);
+}
+
+//------------------------------------------------------------------------------
+static bench_msg_t *inbox_receive (const bool wait)
+{
+  bench_msg_t                            *msg = NULL;
+
+  pthread_mutex_lock (&inbox_mutex);
+  while ((wait) && (!inbox_head)) {
+    pthread_cond_wait (&inbox_cond, &inbox_mutex);
+  }
+  if ((msg = inbox_head)) {
+    if (!(inbox_head = msg->next)) {
+      inbox_tail = NULL;
+    }
+  }
+  pthread_mutex_unlock (&inbox_mutex);
+  return msg;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t new_ue_id (void)
+{
+  bench_shard_t                          *shard = NULL;
+
+  if (!nb_shards) {
+    return __sync_fetch_and_add (&inline_ue_id_generator, 1);
+  }
+  shard = &shards[(SHARD_COORDINATOR == shard_self) ? 0 : shard_self];
+  return __sync_fetch_and_add (&shard->next_ue_id_rank, 1) * nb_shards + shard->index;
+}
+
+//------------------------------------------------------------------------------
+static bench_ue_context_t *lookup (const uint8_t key_space, const uint64_t key)
+{
+  void                                   *value = NULL;
+
+  if (HASH_TABLE_OK != multikey_index_get (mki, key_space, key, 0, &value)) {
+    return NULL;
+  }
+  return (bench_ue_context_t *)value;
+}
+
+//------------------------------------------------------------------------------
+static bool check (const bench_ue_context_t * const ctx, const bench_msg_t * const msg)
+{
+  if ((!ctx) || (ctx != &contexts[msg->ue]) || (ctx->step != (uint32_t)msg->id) ||
+      ((nb_shards) && (ctx->owner != shard_self))) {
+    __sync_fetch_and_add (&nb_errors, 1);
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void work (void)
+{
+  uint64_t                                x = work_sink | 1;
+
+  for (uint32_t i = 0; i < work_per_message; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  work_sink = x;
+}
+
+//------------------------------------------------------------------------------
+// mme_app_handle_message()
+static void handle_message (const bench_msg_t * const msg)
+{
+  bench_ue_context_t                     *ctx = NULL;
+
+  work ();
+  switch (msg->id) {
+  case MSG_INITIAL_UE_MESSAGE:
+    ctx = &contexts[msg->ue];
+    if (lookup (KEY_ENB_S1AP_ID, msg->key)) {
+      __sync_fetch_and_add (&nb_errors, 1);
+      return;
+    }
+    ctx->mme_ue_s1ap_id = new_ue_id ();
+    ctx->owner = shard_self;
+    ctx->enb_s1ap_id_key = msg->key;
+    ctx->imsi = 208950000000000ULL + scramble (msg->ue);
+    ctx->step = MSG_S6A_UPDATE_LOCATION_ANS;
+    multikey_index_insert (mki, KEY_MME_UE_S1AP_ID, ctx->mme_ue_s1ap_id, 0, ctx);
+    multikey_index_insert (mki, KEY_ENB_S1AP_ID, ctx->enb_s1ap_id_key, 0, ctx);
+    multikey_index_insert (mki, KEY_IMSI, ctx->imsi, 0, ctx);
+    inbox_send (MSG_S6A_UPDATE_LOCATION_ANS, msg->ue, ctx->imsi);
+    break;
+
+  case MSG_S6A_UPDATE_LOCATION_ANS:
+    if (check (ctx = lookup (KEY_IMSI, msg->key), msg)) {
+      // S11 MME TEID of the create session request
+      ctx->s11_teid = scramble (msg->ue + 0x40000000) | 1;
+      multikey_index_insert (mki, KEY_S11_TEID, ctx->s11_teid, 0, ctx);
+      ctx->step = MSG_S11_CREATE_SESSION_RESPONSE;
+      inbox_send (MSG_S11_CREATE_SESSION_RESPONSE, msg->ue, ctx->s11_teid);
+    }
+    break;
+
+  case MSG_S11_CREATE_SESSION_RESPONSE:
+    if (check (ctx = lookup (KEY_S11_TEID, msg->key), msg)) {
+      ctx->step = MSG_MME_APP_INITIAL_CONTEXT_SETUP_RSP;
+      inbox_send (MSG_MME_APP_INITIAL_CONTEXT_SETUP_RSP, msg->ue, ctx->mme_ue_s1ap_id);
+    }
+    break;
+
+  case MSG_MME_APP_INITIAL_CONTEXT_SETUP_RSP:
+    if (check (ctx = lookup (KEY_MME_UE_S1AP_ID, msg->key), msg)) {
+      ctx->step = MSG_S11_MODIFY_BEARER_RESPONSE;
+      inbox_send (MSG_S11_MODIFY_BEARER_RESPONSE, msg->ue, ctx->s11_teid);
+    }
+    break;
+
+  case MSG_S11_MODIFY_BEARER_RESPONSE:
+    if (check (ctx = lookup (KEY_S11_TEID, msg->key), msg)) {
+      ctx->step = MSG_S1AP_UE_CONTEXT_RELEASE_COMPLETE;
+      inbox_send (MSG_S1AP_UE_CONTEXT_RELEASE_COMPLETE, msg->ue, ctx->mme_ue_s1ap_id);
+    }
+    break;
+
+  case MSG_S1AP_UE_CONTEXT_RELEASE_COMPLETE:
+    if (check (ctx = lookup (KEY_MME_UE_S1AP_ID, msg->key), msg)) {
+      multikey_index_remove (mki, KEY_S11_TEID, ctx->s11_teid, 0, NULL);
+      multikey_index_remove (mki, KEY_IMSI, ctx->imsi, 0, NULL);
+      multikey_index_remove (mki, KEY_ENB_S1AP_ID, ctx->enb_s1ap_id_key, 0, NULL);
+      multikey_index_remove (mki, KEY_MME_UE_S1AP_ID, ctx->mme_ue_s1ap_id, 0, NULL);
+      ctx->step = MSG_UE_DONE;
+    }
+    inbox_send (MSG_UE_DONE, msg->ue, 0);
+    break;
+
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// mme_app_shard_of_message()
+static inline int shard_of_key (const uint64_t key)
+{
+  return (int)(((key * 0x9E3779B97F4A7C15ULL) >> 32) % nb_shards);
+}
+
+static int shard_of_context (const bench_ue_context_t * const ctx, const uint64_t key)
+{
+  if (ctx) {
+    const uint32_t                          id = __atomic_load_n (&ctx->mme_ue_s1ap_id, __ATOMIC_RELAXED);
+
+    if (INVALID_UE_ID != id) {
+      return (int)(id % nb_shards);
+    }
+  }
+  return shard_of_key (key);
+}
+
+static int shard_of_message (const bench_msg_t * const msg)
+{
+  if (!nb_shards) {
+    return SHARD_COORDINATOR;
+  }
+  switch (msg->id) {
+  case MSG_INITIAL_UE_MESSAGE:
+    return shard_of_context (lookup (KEY_ENB_S1AP_ID, msg->key), msg->key);
+  case MSG_S6A_UPDATE_LOCATION_ANS:
+    return shard_of_context (lookup (KEY_IMSI, msg->key), msg->key);
+  case MSG_S11_CREATE_SESSION_RESPONSE:
+  case MSG_S11_MODIFY_BEARER_RESPONSE:
+    return shard_of_context (lookup (KEY_S11_TEID, msg->key), msg->key);
+  case MSG_MME_APP_INITIAL_CONTEXT_SETUP_RSP:
+  case MSG_S1AP_UE_CONTEXT_RELEASE_COMPLETE:
+    return (int)(msg->key % nb_shards);
+  default:
+    return SHARD_COORDINATOR;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *shard_thread (void *args)
+{
+  bench_shard_t                          *shard = (bench_shard_t *)args;
+
+  shard_self = shard->index;
+  pthread_mutex_lock (&shard->mutex);
+  while (1) {
+    bench_msg_t                            *msg = NULL;
+
+    while ((shard->head == shard->tail) && (!shard->terminate)) {
+      pthread_cond_wait (&shard->not_empty, &shard->mutex);
+    }
+    if (shard->head == shard->tail) {
+      break;
+    }
+    msg = shard->queue[shard->tail & shard->queue_mask];
+    shard->tail += 1;
+    shard->busy = true;
+    pthread_mutex_unlock (&shard->mutex);
+
+    handle_message (msg);
+    free (msg);
+
+    pthread_mutex_lock (&shard->mutex);
+    shard->busy = false;
+    shard->messages_handled += 1;
+    if (shard->head == shard->tail) {
+      pthread_cond_broadcast (&shard->idle);
+    }
+  }
+  pthread_mutex_unlock (&shard->mutex);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void shard_dispatch (const int index, bench_msg_t * const msg)
+{
+  bench_shard_t                          *shard = &shards[index];
+
+  pthread_mutex_lock (&shard->mutex);
+  if ((shard->head - shard->tail) > shard->queue_mask) {
+    const uint32_t                          size = (shard->queue_mask + 1) << 1;
+    bench_msg_t                           **queue = calloc (size, sizeof (bench_msg_t *));
+
+    for (uint64_t i = shard->tail; i != shard->head; i++) {
+      queue[i & (size - 1)] = shard->queue[i & shard->queue_mask];
+    }
+    free (shard->queue);
+    shard->queue = queue;
+    shard->queue_mask = size - 1;
+  }
+  shard->queue[shard->head & shard->queue_mask] = msg;
+  shard->head += 1;
+  if ((shard->head - shard->tail) == 1) {
+    pthread_cond_signal (&shard->not_empty);
+  }
+  pthread_mutex_unlock (&shard->mutex);
+}
+
+//------------------------------------------------------------------------------
+static void shards_quiesce (void)
+{
+  for (int i = 0; i < nb_shards; i++) {
+    bench_shard_t                          *shard = &shards[i];
+
+    pthread_mutex_lock (&shard->mutex);
+    while ((shard->head != shard->tail) || (shard->busy)) {
+      pthread_cond_wait (&shard->idle, &shard->mutex);
+    }
+    pthread_mutex_unlock (&shard->mutex);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void shards_init (const uint16_t n)
+{
+  nb_shards = n;
+  inline_ue_id_generator = 1;
+  if (!n) {
+    return;
+  }
+  if (posix_memalign ((void **)&shards, 64, n * sizeof (bench_shard_t))) {
+    exit (EXIT_FAILURE);
+  }
+  memset (shards, 0, n * sizeof (bench_shard_t));
+  for (int i = 0; i < n; i++) {
+    bench_shard_t                          *shard = &shards[i];
+
+    shard->index = i;
+    shard->next_ue_id_rank = (i) ? 0 : 1;
+    shard->queue_mask = SHARD_QUEUE_INITIAL_SIZE - 1;
+    shard->queue = calloc (SHARD_QUEUE_INITIAL_SIZE, sizeof (bench_msg_t *));
+    pthread_mutex_init (&shard->mutex, NULL);
+    pthread_cond_init (&shard->not_empty, NULL);
+    pthread_cond_init (&shard->idle, NULL);
+    pthread_create (&shard->thread, NULL, &shard_thread, (void *)shard);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void shards_exit (void)
+{
+  for (int i = 0; i < nb_shards; i++) {
+    pthread_mutex_lock (&shards[i].mutex);
+    shards[i].terminate = true;
+    pthread_cond_signal (&shards[i].not_empty);
+    pthread_mutex_unlock (&shards[i].mutex);
+  }
+  for (int i = 0; i < nb_shards; i++) {
+    pthread_join (shards[i].thread, NULL);
+    pthread_cond_destroy (&shards[i].idle);
+    pthread_cond_destroy (&shards[i].not_empty);
+    pthread_mutex_destroy (&shards[i].mutex);
+    free (shards[i].queue);
+  }
+  free (shards);
+  shards = NULL;
+  nb_shards = 0;
+}
+
+//------------------------------------------------------------------------------
+// mme_app_thread(): routes the received messages, injects new attaches while fewer than ues_in_flight are running
+static double run (const uint16_t n)
+{
+  struct timespec                         start, stop;
+  uint32_t                                injected = 0;
+  uint32_t                                done = 0;
+  uint64_t                                received = 0;
+  uint64_t                                stats = 0;
+
+  memset (contexts, 0, nb_ues * sizeof (bench_ue_context_t));
+  shards_init (n);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  while (done < nb_ues) {
+    bench_msg_t                            *msg = NULL;
+    int                                     shard = SHARD_COORDINATOR;
+
+    if ((injected < nb_ues) && (injected - done < ues_in_flight)) {
+      msg = calloc (1, sizeof (bench_msg_t));
+      msg->id = MSG_INITIAL_UE_MESSAGE;
+      msg->ue = injected;
+      // eNB id << 24 | eNB UE S1AP ID, 1000 UEs per eNB
+      msg->key = ((uint64_t)(injected / 1000 + 1) << 24) | (injected % 1000);
+      injected++;
+    } else {
+      msg = inbox_receive (true);
+    }
+    if (MSG_UE_DONE == msg->id) {
+      done++;
+      free (msg);
+      continue;
+    }
+    if (0 == (++received % STATS_PERIOD)) {
+      bench_msg_t                          *stats_msg = calloc (1, sizeof (bench_msg_t));
+
+      stats_msg->id = MSG_STATISTICS;
+      shards_quiesce ();
+      handle_message (stats_msg);
+      free (stats_msg);
+      stats++;
+    }
+    shard = shard_of_message (msg);
+    if (SHARD_COORDINATOR != shard) {
+      shard_dispatch (shard, msg);
+      continue;
+    }
+    shards_quiesce ();
+    handle_message (msg);
+    free (msg);
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  shards_exit ();
+  return elapsed_ns (&start, &stop);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  uint16_t                                max_shards = MAX_SHARDS;
+  double                                  inline_rate = 0;
+  bstring                                 b = bfromcstr ("mme_app_ue_context_index");
+
+  if (argc > 1) {
+    nb_ues = atoi (argv[1]);
+  }
+  if (argc > 2) {
+    max_shards = atoi (argv[2]);
+  }
+  if (argc > 3) {
+    work_per_message = atoi (argv[3]);
+  }
+  if (argc > 4) {
+    ues_in_flight = atoi (argv[4]);
+  }
+  if ((!nb_ues) || (!ues_in_flight) || (!(contexts = calloc (nb_ues, sizeof (bench_ue_context_t))))) {
+    return EXIT_FAILURE;
+  }
+  mki = multikey_index_create (ues_in_flight * 4, b);
+  bdestroy (b);
+
+  fprintf (stdout, "%u attaches, 6 messages per UE, %u work rounds per message, %u UEs in flight\n", nb_ues, work_per_message, ues_in_flight);
+  for (uint16_t n = 0; n <= max_shards; n = (n) ? n << 1 : 1) {
+    const double                            ns = run (n);
+    const double                            rate = nb_ues * 1e9 / ns;
+
+    if (!n) {
+      inline_rate = rate;
+    }
+    fprintf (stdout, "%2u shards%s %10.1f ms %12.0f attaches/s %10.0f messages/s  x%.2f\n", n, (n) ? "" : " (inline)",
+             ns / 1e6, rate, rate * 6, rate / inline_rate);
+  }
+  multikey_index_destroy (mki);
+  free (contexts);
+  fprintf (stdout, "%s: %"PRIu64" messages out of order or on the wrong shard\n", (nb_errors) ? "FAILED" : "PASSED", nb_errors);
+  return (nb_errors) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
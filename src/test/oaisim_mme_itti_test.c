@@ -72,7 +72,7 @@ main (
    * Calling each layer init function
    */
   log_init (&mme_config);
-  itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, messages_definition_xml, NULL);
+  itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, messages_definition_xml, NULL, &mme_config.itti_config.memory_pools);
   sctp_init (&mme_config);
   udp_init (&mme_config);
   s1ap_mme_init (&mme_config);
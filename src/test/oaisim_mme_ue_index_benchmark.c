@@ -0,0 +1,410 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Compares the MME_APP UE context lookups done through the former six hash tables
+ * (secondary keys map to the MME UE S1AP ID, then a second lookup gives the context)
+ * with the single multikey index (any key gives the context in one probe sequence),
+ * on 1M UE contexts by default: insertion, single thread lookups by every key, and
+ * lookup throughput of several reader threads while a writer keeps rekeying S11 TEIDs.
+ *
+ * usage: oaisim_mme_ue_index_benchmark [nb_ues] [nb_reader_threads] [duration_s]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "hashtable.h"
+#include "obj_hashtable.h"
+#include "multikey_index.h"
+
+#define NB_OF_UES            1000000
+#define NB_OF_READERS        4
+#define DURATION_S           2
+
+enum {
+  KEY_MME_UE_S1AP_ID = 1,
+  KEY_ENB_S1AP_ID,
+  KEY_IMSI,
+  KEY_S11_TEID,
+  KEY_S10_TEID,
+  KEY_GUTI,
+};
+
+typedef struct bench_guti_s {
+  uint8_t                                 plmn[3];
+  uint8_t                                 mme_code;
+  uint16_t                                mme_gid;
+  uint32_t                                m_tmsi;
+} bench_guti_t;
+
+typedef struct bench_ue_s {
+  uint32_t                                mme_ue_s1ap_id;
+  uint64_t                                enb_s1ap_id_key;
+  uint64_t                                imsi;
+  uint32_t                                s11_teid;
+  uint32_t                                s10_teid;
+  bench_guti_t                            guti;
+} bench_ue_t;
+
+typedef struct legacy_tables_s {
+  hash_table_uint64_ts_t                 *imsi;
+  hash_table_uint64_ts_t                 *tun11;
+  hash_table_uint64_ts_t                 *tun10;
+  hash_table_uint64_ts_t                 *enb;
+  hash_table_ts_t                        *mme_ue_s1ap_id;
+  obj_hash_table_uint64_t                *guti;
+} legacy_tables_t;
+
+static bench_ue_t                        *ues = NULL;
+static uint32_t                           nb_ues = NB_OF_UES;
+static legacy_tables_t                    legacy;
+static multikey_index_t                  *mki = NULL;
+static volatile bool                      stop = false;
+
+static double elapsed_ns (
+  const struct timespec * const start,
+  const struct timespec * const stop)
+{
+  return ((double)(stop->tv_sec - start->tv_sec) * 1e9) + (double)(stop->tv_nsec - start->tv_nsec);
+}
+
+static void report (
+  const char *const label,
+  uint64_t nb_ops,
+  const struct timespec * const start,
+  const struct timespec * const stop)
+{
+  double ns = elapsed_ns (start, stop);
+
+  fprintf (stdout, "%-40s %10"PRIu64" ops %12.3f ms %10.1f ns/op %12.0f ops/s\n", label, nb_ops, ns / 1e6, ns / nb_ops, nb_ops * 1e9 / ns);
+}
+
+static inline uint32_t scramble (uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x7feb352d;
+  x ^= x >> 15;
+  return x;
+}
+
+static void guti_to_key (const bench_guti_t * const guti, uint64_t * const key, uint32_t * const key_ext)
+{
+  *key = ((uint64_t)guti->mme_gid << 40) | ((uint64_t)guti->mme_code << 32) | guti->m_tmsi;
+  *key_ext = ((uint32_t)guti->plmn[0] << 16) | ((uint32_t)guti->plmn[1] << 8) | guti->plmn[2];
+}
+
+//------------------------------------------------------------------------------
+static void init_ues (void)
+{
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    bench_ue_t                           *ue = &ues[i];
+
+    ue->mme_ue_s1ap_id = i + 1;
+    // eNB id << 24 | eNB UE S1AP ID, 1000 UEs per eNB numbered from 0 like eNBs do:
+    // with an identity hash modulo a power of two all keys would fall in 1000 chains
+    ue->enb_s1ap_id_key = ((uint64_t)(i / 1000 + 1) << 24) | (i % 1000);
+    ue->imsi = 208950000000000ULL + scramble (i);
+    ue->s11_teid = scramble (i + 0x40000000) | 1;
+    ue->s10_teid = scramble (i + 0x80000000) | 1;
+    ue->guti.plmn[0] = 0x02;
+    ue->guti.plmn[1] = 0xf8;
+    ue->guti.plmn[2] = 0x59;
+    ue->guti.mme_gid = 4;
+    ue->guti.mme_code = 1;
+    ue->guti.m_tmsi = scramble (i + 0xc0000000);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int legacy_insert (bench_ue_t * const ue)
+{
+  int                                     rc = 0;
+
+  rc |= hashtable_ts_insert (legacy.mme_ue_s1ap_id, ue->mme_ue_s1ap_id, ue);
+  rc |= hashtable_uint64_ts_insert (legacy.enb, ue->enb_s1ap_id_key, ue->mme_ue_s1ap_id);
+  rc |= hashtable_uint64_ts_insert (legacy.imsi, ue->imsi, ue->mme_ue_s1ap_id);
+  rc |= hashtable_uint64_ts_insert (legacy.tun11, ue->s11_teid, ue->mme_ue_s1ap_id);
+  rc |= hashtable_uint64_ts_insert (legacy.tun10, ue->s10_teid, ue->mme_ue_s1ap_id);
+  rc |= obj_hashtable_uint64_ts_insert (legacy.guti, &ue->guti, sizeof (ue->guti), ue->mme_ue_s1ap_id);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static bench_ue_t *legacy_get (const bench_ue_t * const ue, const int key)
+{
+  uint64_t                                mme_ue_s1ap_id = 0;
+  void                                   *found = NULL;
+  hashtable_rc_t                          rc = HASH_TABLE_OK;
+
+  switch (key) {
+  case KEY_MME_UE_S1AP_ID:
+    mme_ue_s1ap_id = ue->mme_ue_s1ap_id;
+    break;
+  case KEY_ENB_S1AP_ID:
+    rc = hashtable_uint64_ts_get (legacy.enb, ue->enb_s1ap_id_key, &mme_ue_s1ap_id);
+    break;
+  case KEY_IMSI:
+    rc = hashtable_uint64_ts_get (legacy.imsi, ue->imsi, &mme_ue_s1ap_id);
+    break;
+  case KEY_S11_TEID:
+    rc = hashtable_uint64_ts_get (legacy.tun11, ue->s11_teid, &mme_ue_s1ap_id);
+    break;
+  case KEY_S10_TEID:
+    rc = hashtable_uint64_ts_get (legacy.tun10, ue->s10_teid, &mme_ue_s1ap_id);
+    break;
+  default:
+    rc = obj_hashtable_uint64_ts_get (legacy.guti, &ue->guti, sizeof (ue->guti), &mme_ue_s1ap_id);
+  }
+  if (HASH_TABLE_OK != rc) {
+    return NULL;
+  }
+  hashtable_ts_get (legacy.mme_ue_s1ap_id, mme_ue_s1ap_id, &found);
+  return (bench_ue_t *)found;
+}
+
+//------------------------------------------------------------------------------
+static int index_insert (bench_ue_t * const ue)
+{
+  uint64_t                                key = 0;
+  uint32_t                                key_ext = 0;
+  int                                     rc = 0;
+
+  rc |= multikey_index_insert (mki, KEY_MME_UE_S1AP_ID, ue->mme_ue_s1ap_id, 0, ue);
+  rc |= multikey_index_insert (mki, KEY_ENB_S1AP_ID, ue->enb_s1ap_id_key, 0, ue);
+  rc |= multikey_index_insert (mki, KEY_IMSI, ue->imsi, 0, ue);
+  rc |= multikey_index_insert (mki, KEY_S11_TEID, ue->s11_teid, 0, ue);
+  rc |= multikey_index_insert (mki, KEY_S10_TEID, ue->s10_teid, 0, ue);
+  guti_to_key (&ue->guti, &key, &key_ext);
+  rc |= multikey_index_insert (mki, KEY_GUTI, key, key_ext, ue);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static bench_ue_t *index_get (const bench_ue_t * const ue, const int key_space)
+{
+  uint64_t                                key = 0;
+  uint32_t                                key_ext = 0;
+  void                                   *found = NULL;
+
+  switch (key_space) {
+  case KEY_MME_UE_S1AP_ID:
+    key = ue->mme_ue_s1ap_id;
+    break;
+  case KEY_ENB_S1AP_ID:
+    key = ue->enb_s1ap_id_key;
+    break;
+  case KEY_IMSI:
+    key = ue->imsi;
+    break;
+  case KEY_S11_TEID:
+    key = ue->s11_teid;
+    break;
+  case KEY_S10_TEID:
+    key = ue->s10_teid;
+    break;
+  default:
+    guti_to_key (&ue->guti, &key, &key_ext);
+  }
+  multikey_index_get (mki, key_space, key, key_ext, &found);
+  return (bench_ue_t *)found;
+}
+
+//------------------------------------------------------------------------------
+static int bench_lookups (const char * const name, bench_ue_t *(*get)(const bench_ue_t * const, const int))
+{
+  static const char * const               key_names[] = {"", "mme_ue_s1ap_id", "enb_s1ap_id_key", "imsi", "s11 teid", "s10 teid", "guti"};
+  uint32_t                               *order = calloc (nb_ues, sizeof (uint32_t));
+  struct timespec                         start, stop;
+  char                                    label[64];
+
+  if (!order) {
+    return -1;
+  }
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    order[i] = scramble (i) % nb_ues;
+  }
+  for (int key = KEY_MME_UE_S1AP_ID; key <= KEY_GUTI; key++) {
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < nb_ues; i++) {
+      if (get (&ues[order[i]], key) != &ues[order[i]]) {
+        fprintf (stderr, "%s lookup by %s failed for UE %u\n", name, key_names[key], order[i]);
+        free (order);
+        return -1;
+      }
+    }
+    clock_gettime (CLOCK_MONOTONIC, &stop);
+    snprintf (label, sizeof (label), "%s get by %s", name, key_names[key]);
+    report (label, nb_ues, &start, &stop);
+  }
+  free (order);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+typedef struct reader_arg_s {
+  bench_ue_t                           *(*get)(const bench_ue_t * const, const int);
+  uint32_t                                seed;
+  uint64_t                                nb_lookups;
+} reader_arg_t;
+
+static void *reader_thread (void *arg)
+{
+  reader_arg_t                           *reader = (reader_arg_t *)arg;
+  uint32_t                                seed = reader->seed;
+
+  while (!stop) {
+    for (int n = 0; n < 1024; n++) {
+      seed = scramble (seed + 1);
+      // S11 TEIDs are rekeyed by the writer, look the other keys up
+      int key = (seed >> 24) % 5;
+
+      reader->get (&ues[seed % nb_ues], (KEY_S11_TEID <= key) ? key + 2 : key + 1);
+    }
+    reader->nb_lookups += 1024;
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void legacy_rekey (bench_ue_t * const ue)
+{
+  hashtable_uint64_ts_remove (legacy.tun11, ue->s11_teid);
+  ue->s11_teid = scramble (ue->s11_teid) | 1;
+  hashtable_uint64_ts_insert (legacy.tun11, ue->s11_teid, ue->mme_ue_s1ap_id);
+}
+
+static void index_rekey (bench_ue_t * const ue)
+{
+  multikey_index_remove (mki, KEY_S11_TEID, ue->s11_teid, 0, NULL);
+  ue->s11_teid = scramble (ue->s11_teid) | 1;
+  multikey_index_insert (mki, KEY_S11_TEID, ue->s11_teid, 0, ue);
+}
+
+static void bench_concurrent (
+  const char * const name,
+  bench_ue_t *(*get)(const bench_ue_t * const, const int),
+  void (*rekey)(bench_ue_t * const),
+  const int nb_readers,
+  const int duration_s)
+{
+  pthread_t                              *threads = calloc (nb_readers, sizeof (pthread_t));
+  reader_arg_t                           *args = calloc (nb_readers, sizeof (reader_arg_t));
+  struct timespec                         start, now;
+  uint64_t                                nb_lookups = 0;
+  uint64_t                                nb_rekeys = 0;
+  char                                    label[64];
+
+  stop = false;
+  for (int t = 0; t < nb_readers; t++) {
+    args[t].get = get;
+    args[t].seed = t * 7919;
+    pthread_create (&threads[t], NULL, reader_thread, &args[t]);
+  }
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  do {
+    for (int n = 0; n < 256; n++) {
+      rekey (&ues[scramble (nb_rekeys++) % nb_ues]);
+    }
+    clock_gettime (CLOCK_MONOTONIC, &now);
+  } while (elapsed_ns (&start, &now) < duration_s * 1e9);
+  stop = true;
+  for (int t = 0; t < nb_readers; t++) {
+    pthread_join (threads[t], NULL);
+    nb_lookups += args[t].nb_lookups;
+  }
+  snprintf (label, sizeof (label), "%s %d readers get", name, nb_readers);
+  report (label, nb_lookups, &start, &now);
+  snprintf (label, sizeof (label), "%s 1 writer rekey", name);
+  report (label, nb_rekeys, &start, &now);
+  free (threads);
+  free (args);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     nb_readers = NB_OF_READERS;
+  int                                     duration_s = DURATION_S;
+  struct timespec                         start, stop;
+  bstring                                 name = bfromcstr ("bench");
+
+  if (argc > 1) {
+    nb_ues = atoi (argv[1]);
+  }
+  if (argc > 2) {
+    nb_readers = atoi (argv[2]);
+  }
+  if (argc > 3) {
+    duration_s = atoi (argv[3]);
+  }
+  if ((!nb_ues) || (!(ues = calloc (nb_ues, sizeof (bench_ue_t))))) {
+    return EXIT_FAILURE;
+  }
+  init_ues ();
+
+  // Sized like mme_app_init() does with max_ues
+  legacy.imsi = hashtable_uint64_ts_create (nb_ues, NULL, name);
+  legacy.tun11 = hashtable_uint64_ts_create (nb_ues, NULL, name);
+  legacy.tun10 = hashtable_uint64_ts_create (nb_ues, NULL, name);
+  legacy.enb = hashtable_uint64_ts_create (nb_ues, NULL, name);
+  legacy.mme_ue_s1ap_id = hashtable_ts_create (nb_ues, NULL, hash_free_int_func, name);
+  legacy.guti = obj_hashtable_uint64_ts_create (nb_ues, NULL, hash_free_int_func, name);
+  mki = multikey_index_create (nb_ues * 6, name);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    if (legacy_insert (&ues[i])) {
+      fprintf (stderr, "hash tables insert failed at %u\n", i);
+      return EXIT_FAILURE;
+    }
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("hash tables insert 6 keys", nb_ues, &start, &stop);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    if (index_insert (&ues[i])) {
+      fprintf (stderr, "multikey index insert failed at %u\n", i);
+      return EXIT_FAILURE;
+    }
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("multikey index insert 6 keys", nb_ues, &start, &stop);
+
+  if (bench_lookups ("hash tables", legacy_get) || bench_lookups ("multikey index", index_get)) {
+    return EXIT_FAILURE;
+  }
+  bench_concurrent ("hash tables", legacy_get, legacy_rekey, nb_readers, duration_s);
+  bench_concurrent ("multikey index", index_get, index_rekey, nb_readers, duration_s);
+
+  multikey_index_destroy (mki);
+  bdestroy (name);
+  free (ues);
+  return EXIT_SUCCESS;
+}
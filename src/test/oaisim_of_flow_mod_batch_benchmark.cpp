@@ -0,0 +1,472 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*
+ * Flow install rate of the openflow controller against a stub switch. The stub switch connects
+ * to a libfluid OFServer on the loopback, does the OpenFlow 1.3 handshake, counts flow mods,
+ * answers barrier requests and rejects (OFPET_FLOW_MOD_FAILED) the flow mods sent to a bad
+ * table. For each UE, the controller event loop sends the flow mods GTPApplication installs on a
+ * tunnel creation (uplink, paging removal, downlink, loop):
+ *   - one pack and one write per flow mod (DefaultMessenger::send_of_msg), one final barrier,
+ *   - one FlowModBatcher batch per UE: one write, terminated by a barrier,
+ * and reports the flows/s until the last barrier reply is received. In batch mode one UE out of
+ * 1000 gets an extra flow mod to a bad table, the switch error must map back to this UE.
+ * Returns non zero if the switch did not get all flow mods or if an error is not mapped to its UE.
+ *
+ * usage: oaisim_of_flow_mod_batch_benchmark [nb_ues]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "OpenflowMessenger.h"
+#include "FlowModBatcher.h"
+#include <fluid/of13/openflow-13.h>
+
+#define NB_OF_UES                 100000
+#define CONTROLLER_ADDR           "127.0.0.1"
+#define CONTROLLER_PORT           6699
+#define UE_NET                    "10.0.0.0"
+#define ENB                       "192.168.100.1"
+#define GTP_PORT                  32768
+#define EGRESS_PORT               1
+#define TABLE_UL_GTPU             0
+#define TABLE_LOOP                96
+#define TABLE_DL_GTPU             97
+#define BAD_TABLE                 0xfe        // rejected by the stub switch
+#define BAD_UE_PERIOD             1000
+
+using namespace fluid_msg;
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//------------------------------------------------------------------------------
+// stub switch
+//------------------------------------------------------------------------------
+class StubSwitch {
+public:
+  std::atomic<uint64_t> num_flow_mods;
+  std::atomic<uint64_t> num_barriers;
+  std::atomic<uint64_t> num_errors;
+
+  StubSwitch() : num_flow_mods(0), num_barriers(0), num_errors(0), fd_(-1), stop_(false) {}
+
+  bool connect_to(const char* addr, const int port) {
+    struct sockaddr_in sin;
+    int one = 1;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+    inet_aton(addr, &sin.sin_addr);
+    for (int retry = 0; retry < 100; retry++) {
+      fd_ = socket(AF_INET, SOCK_STREAM, 0);
+      if (0 == connect(fd_, (struct sockaddr*)&sin, sizeof(sin))) {
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        thread_ = std::thread(&StubSwitch::run, this);
+        return true;
+      }
+      close(fd_);
+      usleep(10000);
+    }
+    return false;
+  }
+
+  void stop() {
+    stop_ = true;
+    shutdown(fd_, SHUT_RDWR);
+    thread_.join();
+    close(fd_);
+  }
+
+private:
+  void send_msg(const void* data, const size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    size_t sent = 0;
+
+    while (sent < len) {
+      ssize_t n = write(fd_, p + sent, len - sent);
+      if (n <= 0) return;
+      sent += n;
+    }
+  }
+
+  void handle_msg(uint8_t* msg) {
+    struct ofp_header* header = (struct ofp_header*)msg;
+    const uint16_t len = ntohs(header->length);
+
+    switch (header->type) {
+    case of13::OFPT_FEATURES_REQUEST: {
+        struct of13::ofp_switch_features reply;
+        memset(&reply, 0, sizeof(reply));
+        reply.header = *header;
+        reply.header.type = of13::OFPT_FEATURES_REPLY;
+        reply.header.length = htons(sizeof(reply));
+        reply.datapath_id = 1;
+        reply.n_tables = 254;
+        send_msg(&reply, sizeof(reply));
+      }
+      break;
+    case of13::OFPT_ECHO_REQUEST:
+      header->type = of13::OFPT_ECHO_REPLY;
+      send_msg(msg, len);
+      break;
+    case of13::OFPT_FLOW_MOD:
+      num_flow_mods++;
+      if (BAD_TABLE == msg[offsetof(struct of13::ofp_flow_mod, table_id)]) {
+        uint8_t error[sizeof(struct ofp_error_msg) + 64];
+        struct ofp_error_msg* err = (struct ofp_error_msg*)error;
+        const size_t data_len = (len < 64) ? len : 64;
+
+        err->header = *header;
+        err->header.type = of13::OFPT_ERROR;
+        err->header.length = htons(sizeof(struct ofp_error_msg) + data_len);
+        err->type = htons(of13::OFPET_FLOW_MOD_FAILED);
+        err->code = htons(of13::OFPFMFC_BAD_TABLE_ID);
+        memcpy(err->data, msg, data_len);
+        num_errors++;
+        send_msg(error, sizeof(struct ofp_error_msg) + data_len);
+      }
+      break;
+    case of13::OFPT_BARRIER_REQUEST:
+      num_barriers++;
+      header->type = of13::OFPT_BARRIER_REPLY;
+      send_msg(msg, sizeof(struct ofp_header));
+      break;
+    default:;
+    }
+  }
+
+  void run() {
+    std::vector<uint8_t> buffer(1 << 20);
+    size_t filled = 0;
+    struct ofp_header hello;
+
+    hello.version = of13::OFP_VERSION;
+    hello.type = of13::OFPT_HELLO;
+    hello.length = htons(sizeof(hello));
+    hello.xid = 0;
+    send_msg(&hello, sizeof(hello));
+    while (!stop_) {
+      ssize_t n = read(fd_, &buffer[filled], buffer.size() - filled);
+      if (n <= 0) break;
+      filled += n;
+      size_t offset = 0;
+      while (filled - offset >= sizeof(struct ofp_header)) {
+        const uint16_t len = ntohs(((struct ofp_header*)&buffer[offset])->length);
+        if (filled - offset < len) break;
+        handle_msg(&buffer[offset]);
+        offset += len;
+      }
+      memmove(&buffer[0], &buffer[offset], filled - offset);
+      filled -= offset;
+    }
+  }
+
+  int fd_;
+  std::atomic<bool> stop_;
+  std::thread thread_;
+};
+
+//------------------------------------------------------------------------------
+// controller
+//------------------------------------------------------------------------------
+class BenchController : public fluid_base::OFServer {
+public:
+  openflow::DefaultMessenger messenger;
+  openflow::FlowModBatcher batcher;
+  std::atomic<fluid_base::OFConnection*> ofconn;
+  std::atomic<uint64_t> num_barrier_replies;
+  std::atomic<uint64_t> num_errors;
+  std::atomic<uint64_t> num_mapped_errors;
+  std::atomic<uint64_t> num_batch_errors;
+
+  BenchController() :
+    OFServer(CONTROLLER_ADDR, CONTROLLER_PORT, 1, false,
+      fluid_base::OFServerSettings()
+        .supported_version(of13::OFP_VERSION)
+        .use_hello_elements(true)
+        .keep_data_ownership(false)),
+    ofconn(NULL), num_barrier_replies(0), num_errors(0), num_mapped_errors(0), num_batch_errors(0) {}
+
+  void message_callback(fluid_base::OFConnection* conn, uint8_t type, void* data, size_t len) {
+    if (type == of13::OFPT_FEATURES_REPLY) {
+      ofconn = conn;
+    } else if (type == of13::OFPT_ERROR) {
+      struct ofp_error_msg* err = (struct ofp_error_msg*)data;
+      openflow::FlowModBatch batch;
+
+      num_errors++;
+      if (batcher.handle_error(conn, ntohl(err->header.xid), &batch) &&
+          (0 == (ntohl(batch.ue_ip.s_addr) - ntohl(ue_net_.s_addr)) % BAD_UE_PERIOD)) {
+        num_mapped_errors++;
+      }
+    } else if (type == of13::OFPT_BARRIER_REPLY) {
+      openflow::FlowModBatch batch;
+
+      if (batcher.handle_barrier_reply(conn, ntohl(((struct ofp_header*)data)->xid), &batch)) {
+        num_batch_errors += batch.num_errors;
+      }
+      num_barrier_replies++;
+    }
+  }
+
+  void set_ue_net(const struct in_addr ue_net) {
+    ue_net_ = ue_net;
+  }
+
+private:
+  struct in_addr ue_net_;
+};
+
+static BenchController* ctrl = NULL;
+
+struct ue_event_s {
+  int ue_index;
+  bool batch;
+};
+
+/*
+ * Same flow mods as GTPApplication::add_uplink_tunnel_flow() and add_downlink_tunnel_flow()
+ */
+static void ue_flow_mods(const int ue_index, std::vector<of13::FlowMod>& fms)
+{
+  struct in_addr ue_net, ue, enb;
+
+  inet_aton(UE_NET, &ue_net);
+  inet_aton(ENB, &enb);
+  ue.s_addr = htonl(ntohl(ue_net.s_addr) + ue_index);
+
+  of13::FlowMod ul = ctrl->messenger.create_default_flow_mod(TABLE_UL_GTPU, of13::OFPFC_ADD, 10);
+  of13::InPort gtp_port_match(GTP_PORT);
+  ul.add_oxm_field(gtp_port_match);
+  of13::TUNNELId in_tunnel_id(0x1000 + ue_index);
+  ul.add_oxm_field(in_tunnel_id);
+  of13::ApplyActions apply_ul_inst;
+  of13::SetFieldAction set_eth_src(new of13::EthSrc(EthAddress("02:00:00:00:00:01")));
+  apply_ul_inst.add_action(set_eth_src);
+  of13::SetFieldAction set_eth_dst(new of13::EthDst(EthAddress("02:00:00:00:00:02")));
+  apply_ul_inst.add_action(set_eth_dst);
+  of13::SetFieldAction set_metadata(new of13::Metadata(208930000000000ULL + ue_index));
+  apply_ul_inst.add_action(set_metadata);
+  ul.add_instruction(apply_ul_inst);
+  of13::GoToTable goto_loop(TABLE_LOOP);
+  ul.add_instruction(goto_loop);
+  fms.push_back(ul);
+
+  of13::FlowMod paging = ctrl->messenger.create_default_flow_mod(TABLE_DL_GTPU, of13::OFPFC_DELETE, 0);
+  paging.out_port(of13::OFPP_ANY);
+  paging.out_group(of13::OFPG_ANY);
+  of13::EthType type_match(0x0800);
+  paging.add_oxm_field(type_match);
+  of13::IPv4Dst ip_match(ue.s_addr);
+  paging.add_oxm_field(ip_match);
+  fms.push_back(paging);
+
+  of13::FlowMod dl = ctrl->messenger.create_default_flow_mod(TABLE_DL_GTPU, of13::OFPFC_ADD, 10 + 255);
+  of13::InPort egress_port_match(EGRESS_PORT);
+  dl.add_oxm_field(egress_port_match);
+  dl.add_oxm_field(type_match);
+  dl.add_oxm_field(ip_match);
+  of13::ApplyActions apply_dl_inst;
+  of13::SetFieldAction set_out_tunnel(new of13::TUNNELId(0x80000000 + ue_index));
+  apply_dl_inst.add_action(set_out_tunnel);
+  of13::SetFieldAction set_tunnel_dst(new of13::TunnelIPv4Dst(ENB));
+  apply_dl_inst.add_action(set_tunnel_dst);
+  of13::SetFieldAction set_dl_metadata(new of13::Metadata(208930000000000ULL + ue_index));
+  apply_dl_inst.add_action(set_dl_metadata);
+  of13::OutputAction output(GTP_PORT, 1024);
+  apply_dl_inst.add_action(output);
+  dl.add_instruction(apply_dl_inst);
+  fms.push_back(dl);
+
+  of13::FlowMod loop = ctrl->messenger.create_default_flow_mod(TABLE_LOOP, of13::OFPFC_ADD, 1);
+  loop.add_oxm_field(type_match);
+  loop.add_oxm_field(ip_match);
+  of13::ApplyActions apply_loop_inst;
+  of13::SetFieldAction set_loop_eth_src(new of13::EthSrc(EthAddress("02:00:00:00:00:01")));
+  apply_loop_inst.add_action(set_loop_eth_src);
+  loop.add_instruction(apply_loop_inst);
+  of13::GoToTable goto_dl(TABLE_DL_GTPU);
+  loop.add_instruction(goto_dl);
+  fms.push_back(loop);
+}
+
+/*
+ * Runs in the event loop of the connection, as the GTPApplication events
+ */
+static void* ue_event_callback(std::shared_ptr<void> data)
+{
+  auto ev = std::static_pointer_cast<struct ue_event_s>(data);
+  fluid_base::OFConnection* ofconn = ctrl->ofconn;
+  std::vector<of13::FlowMod> fms;
+
+  ue_flow_mods(ev->ue_index, fms);
+  if (ev->batch) {
+    struct in_addr ue_net, ue;
+
+    inet_aton(UE_NET, &ue_net);
+    ue.s_addr = htonl(ntohl(ue_net.s_addr) + ev->ue_index);
+    ctrl->batcher.begin(ofconn, ue, std::to_string(208930000000000ULL + ev->ue_index));
+    for (auto& fm : fms) {
+      ctrl->batcher.add(fm);
+    }
+    if (0 == (ev->ue_index % BAD_UE_PERIOD)) {
+      of13::FlowMod bad = ctrl->messenger.create_default_flow_mod(BAD_TABLE, of13::OFPFC_ADD, 1);
+      ctrl->batcher.add(bad);
+    }
+    ctrl->batcher.commit(ctrl->messenger);
+  } else {
+    for (auto& fm : fms) {
+      ctrl->messenger.send_of_msg(fm, ofconn);
+    }
+  }
+  return NULL;
+}
+
+static void* barrier_callback(std::shared_ptr<void> data)
+{
+  of13::BarrierRequest barrier(1);
+
+  ctrl->messenger.send_of_msg(barrier, ctrl->ofconn);
+  return NULL;
+}
+
+static bool wait_barrier_replies(const uint64_t expected)
+{
+  for (int i = 0; (i < 60000) && (ctrl->num_barrier_replies < expected); i++) {
+    usleep(1000);
+  }
+  return ctrl->num_barrier_replies >= expected;
+}
+
+static double run(const int nb_ues, const bool batch)
+{
+  const uint64_t barriers = ctrl->num_barrier_replies;
+  struct timespec start;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < nb_ues; i++) {
+    auto ev = std::make_shared<struct ue_event_s>();
+    ev->ue_index = i;
+    ev->batch = batch;
+    ctrl->ofconn.load()->add_immediate_event(ue_event_callback, ev);
+  }
+  if (!batch) {
+    ctrl->ofconn.load()->add_immediate_event(barrier_callback, NULL);
+  }
+  if (!wait_barrier_replies(barriers + (batch ? nb_ues : 1))) {
+    return -1;
+  }
+  return elapsed_sec(&start);
+}
+
+int main(int argc, char* argv[])
+{
+  const int nb_ues = (argc > 1) ? atoi(argv[1]) : NB_OF_UES;
+  const uint64_t nb_flows = (uint64_t)nb_ues * 4;
+  const uint64_t nb_bad = (nb_ues + BAD_UE_PERIOD - 1) / BAD_UE_PERIOD;
+  StubSwitch sw;
+  struct in_addr ue_net;
+  int failed = 0;
+  double t = 0;
+
+  ctrl = new BenchController();
+  inet_aton(UE_NET, &ue_net);
+  ctrl->set_ue_net(ue_net);
+  if (!ctrl->start(false)) {
+    printf("SKIPPED: cannot listen on port %d\n", CONTROLLER_PORT);
+    return 0;
+  }
+  if (!sw.connect_to(CONTROLLER_ADDR, CONTROLLER_PORT)) {
+    printf("SKIPPED: cannot connect to the controller\n");
+    return 0;
+  }
+  for (int i = 0; (i < 5000) && (NULL == ctrl->ofconn); i++) {
+    usleep(1000);
+  }
+  if (NULL == ctrl->ofconn) {
+    printf("FAILED: no OpenFlow handshake\n");
+    return 1;
+  }
+
+  t = run(nb_ues, false);
+  if (t < 0) {
+    failed = 1;
+  } else {
+    printf("send_of_msg:   %d UEs %llu flow mods in %.3f s, %.0f flows/s\n",
+        nb_ues, (unsigned long long)nb_flows, t, nb_flows / t);
+  }
+  if (!failed && (sw.num_flow_mods != nb_flows)) {
+    fprintf(stderr, "FAILED switch got %llu flow mods\n", (unsigned long long)sw.num_flow_mods.load());
+    failed = 1;
+  }
+
+  if (!failed) {
+    t = run(nb_ues, true);
+    if (t < 0) {
+      failed = 1;
+    } else {
+      printf("FlowModBatcher: %d UEs %llu flow mods in %.3f s, %.0f flows/s\n",
+          nb_ues, (unsigned long long)nb_flows, t, nb_flows / t);
+    }
+  }
+  if (!failed && (sw.num_flow_mods != 2 * nb_flows + nb_bad)) {
+    fprintf(stderr, "FAILED switch got %llu flow mods\n", (unsigned long long)sw.num_flow_mods.load());
+    failed = 1;
+  }
+  if (!failed && ((ctrl->num_mapped_errors != nb_bad) || (ctrl->num_batch_errors != nb_bad) ||
+      (ctrl->num_errors != nb_bad))) {
+    fprintf(stderr, "FAILED %llu errors, %llu mapped to their UE, %llu counted in batches, expected %llu\n",
+        (unsigned long long)ctrl->num_errors.load(), (unsigned long long)ctrl->num_mapped_errors.load(),
+        (unsigned long long)ctrl->num_batch_errors.load(), (unsigned long long)nb_bad);
+    failed = 1;
+  }
+  if (!failed && (0 != ctrl->batcher.num_pending())) {
+    fprintf(stderr, "FAILED %zu batches still pending\n", ctrl->batcher.num_pending());
+    failed = 1;
+  }
+
+  sw.stop();
+  ctrl->stop();
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed;
+}
@@ -0,0 +1,248 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * UE IPv4 address pool of the PGW (utils/ipv4_pool.c) on nb_addresses addresses split in two ranges:
+ *   - allocates every address, checks they are all different and that the pool is then exhausted,
+ *   - releases them in random order, each one on behalf of an IMSI,
+ *   - re-allocates for the same IMSIs in another random order, each IMSI must get its previous address back,
+ *   - random release/allocate churn at 90% occupancy,
+ * and reports the rates and the pool memory. For reference, the former free/allocated lists (one heap element
+ * per address, linear search on release) are run on BASELINE_ADDRESSES addresses with random releases.
+ * Returns non zero if an allocation or a release is wrong.
+ *
+ * usage: oaisim_pgw_ipv4_pool_benchmark [nb_addresses]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "queue.h"
+#include "common_defs.h"
+#include "ipv4_pool.h"
+
+#define NB_OF_ADDRESSES           (1 << 20)
+#define BASELINE_ADDRESSES        20000
+#define RANGE1_LOW                "10.0.0.1"
+#define RANGE2_LOW                "172.16.0.1"
+#define IMSI_BASE                 208930000000000ULL
+#define CHURN_OPS                 (4 * NB_OF_ADDRESSES)
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static uint64_t rand64 (uint64_t * const state)
+{
+  // xorshift64*
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ULL;
+}
+
+static void shuffle (uint32_t * const a, const uint32_t n, uint64_t * const state)
+{
+  for (uint32_t i = n - 1; i > 0; i--) {
+    const uint32_t                          j = rand64 (state) % (i + 1);
+    const uint32_t                          tmp = a[i];
+
+    a[i] = a[j];
+    a[j] = tmp;
+  }
+}
+
+//------------------------------------------------------------------------------
+// former pgw_lite_paa.c allocator
+struct ipv4_list_elm_s {
+  STAILQ_ENTRY (ipv4_list_elm_s) ipv4_entries;
+  struct in_addr                          addr;
+};
+STAILQ_HEAD (ipv4_list_head_s, ipv4_list_elm_s);
+
+static void baseline (const uint32_t nb_addresses, uint64_t * const state)
+{
+  struct ipv4_list_head_s                 list_free, list_allocated;
+  struct ipv4_list_elm_s                 *ipv4_p = NULL;
+  struct in_addr                          first, *addrs = calloc (nb_addresses, sizeof (struct in_addr));
+  uint32_t                               *order = calloc (nb_addresses, sizeof (uint32_t));
+  struct timespec                         start;
+  double                                  t = 0;
+
+  STAILQ_INIT (&list_free);
+  STAILQ_INIT (&list_allocated);
+  inet_aton (RANGE1_LOW, &first);
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    ipv4_p = calloc (1, sizeof (struct ipv4_list_elm_s));
+    ipv4_p->addr.s_addr = htonl (ntohl (first.s_addr) + i);
+    STAILQ_INSERT_TAIL (&list_free, ipv4_p, ipv4_entries);
+    order[i] = i;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    ipv4_p = STAILQ_FIRST (&list_free);
+    STAILQ_REMOVE (&list_free, ipv4_p, ipv4_list_elm_s, ipv4_entries);
+    STAILQ_INSERT_TAIL (&list_allocated, ipv4_p, ipv4_entries);
+    addrs[i] = ipv4_p->addr;
+  }
+  t = elapsed_sec (&start);
+  printf ("lists  alloc:   %u in %.3f s, %.0f /s\n", nb_addresses, t, nb_addresses / t);
+  shuffle (order, nb_addresses, state);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    STAILQ_FOREACH (ipv4_p, &list_allocated, ipv4_entries) {
+      if (ipv4_p->addr.s_addr == addrs[order[i]].s_addr) {
+        STAILQ_REMOVE (&list_allocated, ipv4_p, ipv4_list_elm_s, ipv4_entries);
+        STAILQ_INSERT_HEAD (&list_free, ipv4_p, ipv4_entries);
+        break;
+      }
+    }
+  }
+  t = elapsed_sec (&start);
+  printf ("lists  release: %u in %.3f s, %.0f /s, %zu bytes of list elements\n", nb_addresses, t, nb_addresses / t,
+      (size_t)nb_addresses * sizeof (struct ipv4_list_elm_s));
+  while ((ipv4_p = STAILQ_FIRST (&list_free))) {
+    STAILQ_REMOVE_HEAD (&list_free, ipv4_entries);
+    free (ipv4_p);
+  }
+  free (addrs);
+  free (order);
+}
+
+#define CHECK(cOnD, ...) do { if (!(cOnD)) { fprintf (stderr, "FAILED line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); fprintf (stderr, "\n"); return 1; } } while (0)
+
+int main (int argc, char *argv[])
+{
+  const uint32_t                          nb_addresses = (argc > 1) ? (uint32_t)atoi (argv[1]) : NB_OF_ADDRESSES;
+  const uint32_t                          nb_range1 = nb_addresses - nb_addresses / 16;
+  struct in_addr                          low[2], high[2], addr;
+  struct in_addr                         *addrs = calloc (nb_addresses, sizeof (struct in_addr));
+  uint32_t                               *order = calloc (nb_addresses, sizeof (uint32_t));
+  uint64_t                                state = 0x9E3779B97F4A7C15ULL;
+  ipv4_pool_t                            *pool = NULL;
+  struct timespec                         start;
+  double                                  t = 0;
+  uint32_t                                nb_allocated = 0;
+
+  CHECK (nb_addresses >= 32, "at least 32 addresses");
+  baseline ((nb_addresses < BASELINE_ADDRESSES) ? nb_addresses : BASELINE_ADDRESSES, &state);
+
+  inet_aton (RANGE1_LOW, &low[0]);
+  high[0].s_addr = htonl (ntohl (low[0].s_addr) + nb_range1 - 1);
+  inet_aton (RANGE2_LOW, &low[1]);
+  high[1].s_addr = htonl (ntohl (low[1].s_addr) + (nb_addresses - nb_range1) - 1);
+  // given in reverse order, the pool sorts them
+  {
+    struct in_addr                          r_low[2] = {low[1], low[0]}, r_high[2] = {high[1], high[0]};
+
+    pool = ipv4_pool_create (2, r_low, r_high, true);
+  }
+  CHECK (pool, "create");
+  {
+    struct in_addr                          o_low[2] = {low[0], high[0]}, o_high[2] = {high[0], high[0]};
+
+    CHECK (NULL == ipv4_pool_create (2, o_low, o_high, true), "overlapping ranges accepted");
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    CHECK (RETURNok == ipv4_pool_alloc (pool, 0, &addrs[i]), "alloc %u", i);
+  }
+  t = elapsed_sec (&start);
+  printf ("bitmap alloc:   %u in %.3f s, %.0f /s, %zu bytes of bitmaps\n", nb_addresses, t, nb_addresses / t, ipv4_pool_memory (pool));
+  CHECK (RETURNerror == ipv4_pool_alloc (pool, 0, &addr), "pool not exhausted");
+  CHECK (INADDR_ANY == addr.s_addr, "address set on exhaustion");
+  CHECK (0 == pool->num_free, "%"PRIu64" free", pool->num_free);
+  // in order and unique: range 1 then range 2
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    const uint32_t                          expected = (i < nb_range1) ? ntohl (low[0].s_addr) + i : ntohl (low[1].s_addr) + (i - nb_range1);
+
+    CHECK (ntohl (addrs[i].s_addr) == expected, "address %u is %s", i, inet_ntoa (addrs[i]));
+    order[i] = i;
+  }
+
+  // release in random order, on behalf of IMSI_BASE + i
+  shuffle (order, nb_addresses, &state);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    CHECK (RETURNok == ipv4_pool_release (pool, IMSI_BASE + order[i], addrs[order[i]]), "release %u", order[i]);
+  }
+  t = elapsed_sec (&start);
+  printf ("bitmap release: %u in %.3f s, %.0f /s\n", nb_addresses, t, nb_addresses / t);
+  CHECK (RETURNerror == ipv4_pool_release (pool, 0, addrs[0]), "double release");
+  addr.s_addr = htonl (ntohl (high[1].s_addr) + 1);
+  CHECK (RETURNerror == ipv4_pool_release (pool, 0, addr), "release out of pool");
+  CHECK (nb_addresses == pool->num_free, "%"PRIu64" free after release", pool->num_free);
+
+  // IMSI sticky re-allocation
+  shuffle (order, nb_addresses, &state);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    CHECK (RETURNok == ipv4_pool_alloc (pool, IMSI_BASE + order[i], &addr), "sticky alloc %u", order[i]);
+    CHECK (addr.s_addr == addrs[order[i]].s_addr, "IMSI %u got %s", order[i], inet_ntoa (addr));
+  }
+  t = elapsed_sec (&start);
+  printf ("sticky alloc:   %u in %.3f s, %.0f /s\n", nb_addresses, t, nb_addresses / t);
+
+  // churn at 90% occupancy: order[0..nb_allocated[ are the allocated addresses
+  for (uint32_t i = 0; i < nb_addresses; i++) {
+    order[i] = i;
+  }
+  nb_allocated = nb_addresses;
+  while (nb_allocated > nb_addresses - nb_addresses / 10) {
+    const uint32_t                          j = rand64 (&state) % nb_allocated;
+
+    CHECK (RETURNok == ipv4_pool_release (pool, 0, addrs[order[j]]), "churn release");
+    order[j] = order[--nb_allocated];
+  }
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t n = 0; n < CHURN_OPS; n++) {
+    const uint32_t                          j = rand64 (&state) % nb_allocated;
+    const uint32_t                          slot = order[j];
+
+    CHECK (RETURNok == ipv4_pool_release (pool, 0, addrs[slot]), "churn release %u", n);
+    CHECK (RETURNok == ipv4_pool_alloc (pool, 0, &addrs[slot]), "churn alloc %u", n);
+    CHECK (ipv4_pool_is_allocated (pool, addrs[slot]), "churn address not allocated");
+  }
+  t = elapsed_sec (&start);
+  printf ("churn:          %u release+alloc in %.3f s, %.0f /s\n", CHURN_OPS, t, CHURN_OPS / t);
+  CHECK (nb_addresses / 10 == pool->num_free, "%"PRIu64" free after churn", pool->num_free);
+  for (uint32_t j = 0; j < nb_allocated; j++) {
+    CHECK (RETURNok == ipv4_pool_release (pool, 0, addrs[order[j]]), "final release");
+  }
+  CHECK (nb_addresses == pool->num_free, "leak after churn");
+
+  ipv4_pool_destroy (pool);
+  free (addrs);
+  free (order);
+  printf ("PASSED\n");
+  return 0;
+}
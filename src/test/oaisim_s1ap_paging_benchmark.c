@@ -0,0 +1,365 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*
+ * Paging throughput of a tracking area served by 2,000 eNBs. The eNBs are laid out like in
+ * s1ap_mme.c (g_s1ap_enb_coll keyed by sctp_assoc_id), each paging carries the TAI list of the UE and
+ * must reach every eNB serving one of its TAIs, exactly once.
+ * - scan: every eNB of g_s1ap_enb_coll is checked against the TAI list, the PDU is encoded for each
+ *   matching eNB and sent in its own SCTP_DATA_REQ.
+ * - index: the pagings of a TAI list are grouped under s1ap_mme_paging_group_key(), the eNBs of a group
+ *   are taken from the TAI -> eNB index by s1ap_mme_paging_resolve_enbs() when the group is sent
+ *   (s1ap_mme_tai_index.c, linked), each PDU is encoded once and its payload shared by all the eNBs of
+ *   the group, the group goes in one SCTP_DATA_REQ_BATCH when it is full or when the coalescing window
+ *   expires, the window is modelled as a number of pagings.
+ * The encoder is a stand-in writing the same IEs without asn1c, so the scan figures are optimistic.
+ * Returns non zero if an eNB missed or got a duplicate paging record.
+ *
+ * usage: oaisim_s1ap_paging_benchmark [nb_enbs_in_ta] [nb_pagings] [pagings_per_window]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
+#include "queue.h"
+#include "common_defs.h"
+#include "common_types.h"
+#include "mme_default_values.h"
+#include "s1ap_mme_tai_index.h"
+
+#define NB_OF_ENBS_IN_TA        2000
+#define NB_OF_ENBS_ELSEWHERE    500      // eNBs of the neighbour TAs, not paged
+#define NB_OF_PAGINGS           2000
+#define PAGINGS_PER_WINDOW      16
+#define NB_OF_UE_TAI            3        // TAI list of the UE: the paged TA and two TAs without eNB
+#define BATCH_MAX               32       // SCTP_DATA_REQ_BATCH_MAX (sctp_messages_types.h)
+#define PAGED_TAC               0x0001
+
+// SCTP_DATA_REQ / SCTP_DATA_REQ_BATCH
+typedef struct bench_msg_s {
+  uint16_t                                nb_payloads;
+  bstring                                 payloads[BATCH_MAX];
+  uint32_t                                nb_assoc_ids;
+  sctp_assoc_id_t                        *assoc_ids;
+} bench_msg_t;
+
+// enb_description_t (s1ap_mme.h)
+typedef struct bench_enb_s {
+  s1ap_tai_index_enb_t                    tai_index;
+  uint64_t                                nb_records_received;
+} bench_enb_t;
+
+// s1ap_paging_group_t (s1ap_mme_paging.c), the ITTI message and its timer are left out
+typedef struct bench_group_s {
+  hash_key_t                              key;
+  uint8_t                                 nb_tai;
+  hash_key_t                              tai_keys[NB_OF_UE_TAI];
+  uint8_t                                 nb_tai_list;
+  tai_t                                   tai_list[NB_OF_UE_TAI];
+  uint32_t                                nb_enbs;
+  bench_msg_t                            *batch_p;
+  LIST_ENTRY(bench_group_s)               entries;
+} bench_group_t;
+
+static hash_table_ts_t                   *enb_coll = NULL;
+static bench_enb_t                       *enbs = NULL;
+static uint32_t                           nb_enbs = 0;
+static hash_table_ts_t                   *group_coll = NULL;
+static LIST_HEAD(bench_groups_s, bench_group_s) groups = LIST_HEAD_INITIALIZER(groups);
+static uint64_t                           nb_msgs_sent = 0;
+static uint64_t                           nb_encodings = 0;
+
+static double elapsed_ns (
+  const struct timespec * const start,
+  const struct timespec * const stop)
+{
+  return ((double)(stop->tv_sec - start->tv_sec) * 1e9) + (double)(stop->tv_nsec - start->tv_nsec);
+}
+
+//------------------------------------------------------------------------------
+static void set_tai (tai_t * const tai, const uint16_t tac)
+{
+  memset (tai, 0, sizeof (*tai));
+  tai->plmn.mcc_digit1 = 2; tai->plmn.mcc_digit2 = 0; tai->plmn.mcc_digit3 = 8;
+  tai->plmn.mnc_digit1 = 9; tai->plmn.mnc_digit2 = 3; tai->plmn.mnc_digit3 = 0xf;
+  tai->tac = tac;
+}
+
+//------------------------------------------------------------------------------
+// Stand-in of the S1AP Paging encoding: UE identity index, S-TMSI, CN domain, TAI list
+static bstring encode_paging (const uint32_t tmsi, const tai_t * const tai_list, const int nb_tai)
+{
+  uint8_t                                 buf[16 + 8 * NB_OF_UE_TAI];
+  int                                     len = 0;
+
+  nb_encodings++;
+  buf[len++] = 0x00; buf[len++] = 0x0a; buf[len++] = 0x40;
+  buf[len++] = (uint8_t)(tmsi % 1024 >> 2); buf[len++] = (uint8_t)(tmsi % 1024 << 6);
+  buf[len++] = 0x01;
+  buf[len++] = tmsi >> 24; buf[len++] = tmsi >> 16; buf[len++] = tmsi >> 8; buf[len++] = tmsi;
+  buf[len++] = 0x00;
+  for (int i = 0; i < nb_tai; i++) {
+    buf[len++] = (tai_list[i].plmn.mcc_digit2 << 4) | tai_list[i].plmn.mcc_digit1;
+    buf[len++] = (tai_list[i].plmn.mnc_digit3 << 4) | tai_list[i].plmn.mcc_digit3;
+    buf[len++] = (tai_list[i].plmn.mnc_digit2 << 4) | tai_list[i].plmn.mnc_digit1;
+    buf[len++] = tai_list[i].tac >> 8; buf[len++] = tai_list[i].tac;
+  }
+  return blk2bstr (buf, len);
+}
+
+//------------------------------------------------------------------------------
+// SCTP task side: the message is consumed, the payloads counted and freed
+static void send_msg (bench_msg_t * const msg)
+{
+  for (uint32_t a = 0; a < msg->nb_assoc_ids; a++) {
+    nb_msgs_sent++;
+    // the association id is the eNB rank + 1, no lookup in enb_coll that the scan holds locked
+    enbs[msg->assoc_ids[a] - 1].nb_records_received += msg->nb_payloads;
+  }
+  for (int i = 0; i < msg->nb_payloads; i++) {
+    bdestroy (msg->payloads[i]);
+  }
+  free (msg->assoc_ids);
+  free (msg);
+}
+
+//------------------------------------------------------------------------------
+// Former fan-out: scan of g_s1ap_enb_coll, one encoding and one SCTP_DATA_REQ per eNB
+//------------------------------------------------------------------------------
+typedef struct scan_arg_s {
+  uint32_t                                tmsi;
+  const tai_t                            *tai_list;
+  int                                     nb_tai;
+  uint32_t                                nb_paged_enbs;
+} scan_arg_t;
+
+static bool scan_page_enb_cb (__attribute__((unused)) const hash_key_t keyP, void * const elementP, void *parameterP, __attribute__((unused)) void **resultP)
+{
+  bench_enb_t                            *enb = (bench_enb_t *)elementP;
+  scan_arg_t                             *arg = (scan_arg_t *)parameterP;
+
+  for (int t = 0; t < enb->tai_index.nb_supported_tai; t++) {
+    for (int u = 0; u < arg->nb_tai; u++) {
+      if (s1ap_tai_key (&enb->tai_index.supported_tai[t]) == s1ap_tai_key (&arg->tai_list[u])) {
+        bench_msg_t                        *msg = calloc (1, sizeof (bench_msg_t));
+
+        msg->assoc_ids = malloc (sizeof (sctp_assoc_id_t));
+        msg->assoc_ids[msg->nb_assoc_ids++] = enb->tai_index.sctp_assoc_id;
+        msg->payloads[msg->nb_payloads++] = encode_paging (arg->tmsi, arg->tai_list, arg->nb_tai);
+        send_msg (msg);
+        arg->nb_paged_enbs++;
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
+static uint32_t scan_paging (const uint32_t tmsi, const tai_t * const tai_list, const int nb_tai)
+{
+  scan_arg_t                              arg = {.tmsi = tmsi, .tai_list = tai_list, .nb_tai = nb_tai, .nb_paged_enbs = 0};
+
+  hashtable_ts_apply_callback_on_elements (enb_coll, scan_page_enb_cb, &arg, NULL);
+  return arg.nb_paged_enbs;
+}
+
+//------------------------------------------------------------------------------
+// TAI index fan-out, as s1ap_mme_paging_send() does
+//------------------------------------------------------------------------------
+// s1ap_mme_paging_flush_group()
+static void flush_group (bench_group_t * const group)
+{
+  LIST_REMOVE (group, entries);
+  hashtable_ts_free (group_coll, group->key);
+  group->batch_p->nb_assoc_ids = s1ap_mme_paging_resolve_enbs (group->tai_list, group->nb_tai_list, &group->batch_p->assoc_ids);
+  send_msg (group->batch_p);
+  free (group);
+}
+
+static void flush_all (void)
+{
+  while (!LIST_EMPTY (&groups)) {
+    flush_group (LIST_FIRST (&groups));
+  }
+}
+
+static uint32_t index_paging (const uint32_t tmsi, const tai_t * const tai_list, const uint8_t nb_tai)
+{
+  bench_group_t                          *group = NULL;
+  hash_key_t                              tai_keys[NB_OF_UE_TAI];
+  uint8_t                                 nb_keys = 0;
+  hash_key_t                              key = s1ap_mme_paging_group_key (tai_list, nb_tai, tai_keys, &nb_keys);
+  uint32_t                                nb_paged_enbs = 0;
+
+  if (HASH_TABLE_OK == hashtable_ts_get (group_coll, key, (void **)&group)) {
+    if ((group->nb_tai != nb_keys) || (memcmp (group->tai_keys, tai_keys, nb_keys * sizeof (hash_key_t)))) {
+      flush_group (group);
+      group = NULL;
+    }
+  } else {
+    group = NULL;
+  }
+  if (!group) {
+    // s1ap_mme_paging_new_group()
+    group = calloc (1, sizeof (bench_group_t));
+    group->key = key;
+    group->nb_tai = nb_keys;
+    memcpy (group->tai_keys, tai_keys, nb_keys * sizeof (hash_key_t));
+    group->nb_tai_list = nb_tai;
+    memcpy (group->tai_list, tai_list, nb_tai * sizeof (tai_t));
+    group->nb_enbs = s1ap_mme_paging_resolve_enbs (tai_list, nb_tai, NULL);
+    group->batch_p = calloc (1, sizeof (bench_msg_t));
+    LIST_INSERT_HEAD (&groups, group, entries);
+    hashtable_ts_insert (group_coll, key, group);
+  }
+  group->batch_p->payloads[group->batch_p->nb_payloads++] = encode_paging (tmsi, tai_list, nb_tai);
+  nb_paged_enbs = group->nb_enbs;
+  if (BATCH_MAX == group->batch_p->nb_payloads) {
+    flush_group (group);
+  }
+  return nb_paged_enbs;
+}
+
+//------------------------------------------------------------------------------
+static int check_records (const char * const name, const uint32_t nb_enbs_in_ta, const uint32_t nb_pagings)
+{
+  int                                     nb_errors = 0;
+
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    const uint64_t                          expected = (e < nb_enbs_in_ta) ? nb_pagings : 0;
+
+    if (enbs[e].nb_records_received != expected) {
+      if (nb_errors < 5) {
+        fprintf (stderr, "%s: eNB %u received %"PRIu64" paging records, expected %"PRIu64"\n", name, e, enbs[e].nb_records_received, expected);
+      }
+      nb_errors++;
+    }
+    enbs[e].nb_records_received = 0;
+  }
+  return nb_errors;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  uint32_t                                nb_enbs_in_ta = NB_OF_ENBS_IN_TA;
+  uint32_t                                nb_pagings = NB_OF_PAGINGS;
+  uint32_t                                pagings_per_window = PAGINGS_PER_WINDOW;
+  tai_t                                   ue_tai_list[NB_OF_UE_TAI];
+  struct timespec                         start, stop;
+  double                                  scan_ns, index_ns;
+  uint64_t                                scan_msgs, scan_encodings;
+  bstring                                 bs = NULL;
+  int                                     nb_errors = 0;
+
+  if (argc > 1) {
+    nb_enbs_in_ta = atoi (argv[1]);
+  }
+  if (argc > 2) {
+    nb_pagings = atoi (argv[2]);
+  }
+  if (argc > 3) {
+    pagings_per_window = atoi (argv[3]);
+  }
+  if ((!nb_enbs_in_ta) || (!nb_pagings) || (!pagings_per_window)) {
+    return EXIT_FAILURE;
+  }
+  nb_enbs = nb_enbs_in_ta + NB_OF_ENBS_ELSEWHERE;
+  enbs = calloc (nb_enbs, sizeof (bench_enb_t));
+  bs = bfromcstr ("s1ap_eNB_coll");
+  enb_coll = hashtable_ts_create (nb_enbs, NULL, hash_free_int_func, bs);
+  bdestroy (bs);
+  if (s1ap_mme_tai_index_init (NULL) != RETURNok) {
+    return EXIT_FAILURE;
+  }
+  bs = bfromcstr ("s1ap_paging_group_coll");
+  group_coll = hashtable_ts_create (S1AP_PAGING_GROUP_COLL_SIZE, NULL, hash_free_int_func, bs);
+  bdestroy (bs);
+
+  // S1 Setup: the eNBs of the TA also broadcast a neighbour TAC, the others one of 10 neighbour TACs
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    tai_t                                   tai;
+
+    enbs[e].tai_index.sctp_assoc_id = e + 1;
+    if (e < nb_enbs_in_ta) {
+      set_tai (&tai, PAGED_TAC);
+      s1ap_mme_tai_index_add (&enbs[e].tai_index, &tai);
+    }
+    set_tai (&tai, 0x0100 + (e % 10));
+    s1ap_mme_tai_index_add (&enbs[e].tai_index, &tai);
+    hashtable_ts_insert (enb_coll, (const hash_key_t)enbs[e].tai_index.sctp_assoc_id, &enbs[e]);
+  }
+  set_tai (&ue_tai_list[0], PAGED_TAC);
+  set_tai (&ue_tai_list[1], 0x0200);
+  set_tai (&ue_tai_list[2], 0x0201);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t p = 0; p < nb_pagings; p++) {
+    if (scan_paging (0xC0000000 + p, ue_tai_list, NB_OF_UE_TAI) != nb_enbs_in_ta) {
+      nb_errors++;
+    }
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  scan_ns = elapsed_ns (&start, &stop);
+  scan_msgs = nb_msgs_sent;
+  scan_encodings = nb_encodings;
+  nb_errors += check_records ("scan", nb_enbs_in_ta, nb_pagings);
+
+  nb_msgs_sent = 0;
+  nb_encodings = 0;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t p = 0; p < nb_pagings; p++) {
+    if (index_paging (0xC0000000 + p, ue_tai_list, NB_OF_UE_TAI) != nb_enbs_in_ta) {
+      nb_errors++;
+    }
+    if (!((p + 1) % pagings_per_window)) {
+      // coalescing window expiry
+      flush_all ();
+    }
+  }
+  flush_all ();
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  index_ns = elapsed_ns (&start, &stop);
+  nb_errors += check_records ("index", nb_enbs_in_ta, nb_pagings);
+
+  fprintf (stdout, "%u pagings of a TA served by %u eNBs (%u eNBs in other TAs)\n", nb_pagings, nb_enbs_in_ta, NB_OF_ENBS_ELSEWHERE);
+  fprintf (stdout, "scan : %9.0f pagings/s %9.1f us/paging %8.0f encodings/paging %8.1f SCTP messages/paging\n",
+           nb_pagings * 1e9 / scan_ns, scan_ns / 1e3 / nb_pagings, (double)scan_encodings / nb_pagings, (double)scan_msgs / nb_pagings);
+  fprintf (stdout, "index: %9.0f pagings/s %9.1f us/paging %8.0f encodings/paging %8.1f SCTP messages/paging (window %u pagings)\n",
+           nb_pagings * 1e9 / index_ns, index_ns / 1e3 / nb_pagings, (double)nb_encodings / nb_pagings, (double)nb_msgs_sent / nb_pagings,
+           pagings_per_window);
+
+  hashtable_ts_destroy (group_coll);
+  s1ap_mme_tai_index_exit ();
+  hashtable_ts_destroy (enb_coll);
+  free (enbs);
+  fprintf (stdout, "%s\n", (nb_errors) ? "FAILED" : "PASSED");
+  return (nb_errors) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,288 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Downlink NAS transport latency of the S1AP UE lookup as the number of UEs grows.
+ * The eNB and UE collections are laid out like in s1ap_mme.c (g_s1ap_enb_coll holding
+ * one ue_coll per eNB keyed by enb_ue_s1ap_id); a downlink NAS message resolves its
+ * mme_ue_s1ap_id to the SCTP association and then to the UE description, either by
+ * scanning every ue_coll (former s1ap_is_ue_mme_id_in_list) or through the global
+ * mme_ue_s1ap_id index. A churn pass (release + new attach with the ids reused) checks
+ * that the index stays consistent.
+ *
+ * usage: oaisim_s1ap_ue_index_benchmark [max_nb_ues] [nb_ues_per_enb]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
+
+#define MAX_NB_OF_UES        500000
+#define NB_OF_UES_PER_ENB    250
+#define NB_OF_INDEX_LOOKUPS  1000000
+#define SCAN_VISITS_BUDGET   200000000ULL
+
+typedef struct bench_enb_s {
+  uint32_t                                sctp_assoc_id;
+  hash_table_ts_t                         ue_coll;
+} bench_enb_t;
+
+typedef struct bench_ue_s {
+  bench_enb_t                            *enb;
+  uint32_t                                enb_ue_s1ap_id;
+  uint32_t                                mme_ue_s1ap_id;
+} bench_ue_t;
+
+static const uint32_t                     sizes[] = {1000, 10000, 50000, 100000, 250000, 500000};
+
+static hash_table_ts_t                   *enb_coll = NULL;
+static hash_table_ts_t                   *mme_id2assoc_id_coll = NULL;
+static hash_table_ts_t                   *mme_ue_id2ue_coll = NULL;
+static bench_enb_t                       *enbs = NULL;
+static bench_ue_t                       **ues = NULL;
+static uint32_t                           nb_ues_per_enb = NB_OF_UES_PER_ENB;
+
+static double elapsed_ns (
+  const struct timespec * const start,
+  const struct timespec * const stop)
+{
+  return ((double)(stop->tv_sec - start->tv_sec) * 1e9) + (double)(stop->tv_nsec - start->tv_nsec);
+}
+
+static inline uint32_t scramble (uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x7feb352d;
+  x ^= x >> 15;
+  return x;
+}
+
+//------------------------------------------------------------------------------
+// Former lookup, same callbacks as s1ap_enb_find_ue_by_mme_ue_id_cb / s1ap_ue_compare_by_mme_ue_id_cb
+//------------------------------------------------------------------------------
+static bool ue_compare_by_mme_ue_id_cb (__attribute__((unused)) const hash_key_t keyP, void * const elementP, void *parameterP, void **resultP)
+{
+  if (*(uint32_t*)parameterP == ((bench_ue_t*)elementP)->mme_ue_s1ap_id) {
+    *resultP = elementP;
+    return true;
+  }
+  return false;
+}
+
+static bool enb_find_ue_by_mme_ue_id_cb (__attribute__((unused)) const hash_key_t keyP, void * const elementP, void *parameterP, void **resultP)
+{
+  hashtable_ts_apply_callback_on_elements (&((bench_enb_t*)elementP)->ue_coll, ue_compare_by_mme_ue_id_cb, parameterP, resultP);
+  return (*resultP != NULL);
+}
+
+static bench_ue_t *scan_get_by_mme_ue_id (uint32_t mme_ue_s1ap_id)
+{
+  bench_ue_t                             *ue = NULL;
+
+  hashtable_ts_apply_callback_on_elements (enb_coll, enb_find_ue_by_mme_ue_id_cb, &mme_ue_s1ap_id, (void **)&ue);
+  return ue;
+}
+
+//------------------------------------------------------------------------------
+// Indexed lookup, as s1ap_is_ue_mme_id_in_list now does
+//------------------------------------------------------------------------------
+static bench_ue_t *index_get_by_mme_ue_id (uint32_t mme_ue_s1ap_id)
+{
+  bench_ue_t                             *ue = NULL;
+
+  hashtable_ts_get (mme_ue_id2ue_coll, (const hash_key_t) mme_ue_s1ap_id, (void **)&ue);
+  return ue;
+}
+
+//------------------------------------------------------------------------------
+// Downlink NAS transport: mme_ue_s1ap_id -> sctp association -> UE description
+//------------------------------------------------------------------------------
+static bench_ue_t *downlink_nas_lookup (uint32_t mme_ue_s1ap_id, bench_ue_t *(*get) (uint32_t))
+{
+  void                                   *id = NULL;
+
+  if (HASH_TABLE_OK != hashtable_ts_get (mme_id2assoc_id_coll, (const hash_key_t) mme_ue_s1ap_id, &id)) {
+    return NULL;
+  }
+  return get (mme_ue_s1ap_id);
+}
+
+//------------------------------------------------------------------------------
+static void index_remove (hash_table_ts_t * const index, const hash_key_t key, const bench_ue_t * const ue)
+{
+  void                                   *indexed = NULL;
+
+  if ((HASH_TABLE_OK == hashtable_ts_get (index, key, &indexed)) && (indexed == ue)) {
+    hashtable_ts_remove (index, key, &indexed);
+  }
+}
+
+static bench_ue_t *new_ue (bench_enb_t * const enb, uint32_t enb_ue_s1ap_id, uint32_t mme_ue_s1ap_id)
+{
+  bench_ue_t                             *ue = calloc (1, sizeof (bench_ue_t));
+
+  ue->enb = enb;
+  ue->enb_ue_s1ap_id = enb_ue_s1ap_id;
+  ue->mme_ue_s1ap_id = mme_ue_s1ap_id;
+  hashtable_ts_insert (&enb->ue_coll, (const hash_key_t) enb_ue_s1ap_id, ue);
+  hashtable_ts_insert (mme_id2assoc_id_coll, (const hash_key_t) mme_ue_s1ap_id, (void *)(uintptr_t)enb->sctp_assoc_id);
+  hashtable_ts_insert (mme_ue_id2ue_coll, (const hash_key_t) mme_ue_s1ap_id, ue);
+  return ue;
+}
+
+static void remove_ue (bench_ue_t * const ue)
+{
+  uint32_t                                mme_ue_s1ap_id = ue->mme_ue_s1ap_id;
+
+  index_remove (mme_ue_id2ue_coll, (const hash_key_t) ue->mme_ue_s1ap_id, ue);
+  hashtable_ts_free (&ue->enb->ue_coll, (const hash_key_t) ue->enb_ue_s1ap_id);
+  hashtable_ts_free (mme_id2assoc_id_coll, (const hash_key_t) mme_ue_s1ap_id);
+}
+
+//------------------------------------------------------------------------------
+static void setup (uint32_t nb_ues)
+{
+  uint32_t                                nb_enbs = (nb_ues + nb_ues_per_enb - 1) / nb_ues_per_enb;
+  bstring                                 name = bfromcstr ("bench");
+
+  // Sized like s1ap_mme_init() / s1ap_new_enb() do with max_enbs and max_ues
+  enb_coll = hashtable_ts_create (nb_enbs, NULL, hash_free_int_func, name);
+  mme_id2assoc_id_coll = hashtable_ts_create (nb_ues, NULL, hash_free_int_func, name);
+  mme_ue_id2ue_coll = hashtable_ts_create (nb_ues, NULL, hash_free_int_func, name);
+  enbs = calloc (nb_enbs, sizeof (bench_enb_t));
+  ues = calloc (nb_ues, sizeof (bench_ue_t *));
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    enbs[e].sctp_assoc_id = e + 1;
+    hashtable_ts_init (&enbs[e].ue_coll, nb_ues_per_enb, NULL, free_wrapper, name);
+    hashtable_ts_insert (enb_coll, (const hash_key_t) enbs[e].sctp_assoc_id, &enbs[e]);
+  }
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    ues[i] = new_ue (&enbs[i / nb_ues_per_enb], i % nb_ues_per_enb, i + 1);
+  }
+  bdestroy (name);
+}
+
+static void teardown (uint32_t nb_ues)
+{
+  uint32_t                                nb_enbs = (nb_ues + nb_ues_per_enb - 1) / nb_ues_per_enb;
+
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    hashtable_ts_destroy (&enbs[e].ue_coll);
+  }
+  hashtable_ts_destroy (enb_coll);
+  hashtable_ts_destroy (mme_id2assoc_id_coll);
+  hashtable_ts_destroy (mme_ue_id2ue_coll);
+  free (enbs);
+  free (ues);
+}
+
+//------------------------------------------------------------------------------
+static double bench_lookups (uint32_t nb_ues, uint32_t nb_ops, bench_ue_t *(*get) (uint32_t))
+{
+  struct timespec                         start, stop;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ops; i++) {
+    bench_ue_t                           *expected = ues[scramble (i) % nb_ues];
+    bench_ue_t                           *ue = downlink_nas_lookup (expected->mme_ue_s1ap_id, get);
+
+    if (ue != expected) {
+      fprintf (stderr, "lookup %u returned %p instead of %p\n", i, (void *)ue, (void *)expected);
+      return -1;
+    }
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  return elapsed_ns (&start, &stop) / nb_ops;
+}
+
+//------------------------------------------------------------------------------
+static int churn (uint32_t nb_ues)
+{
+  // Release then re-attach every UE with a new enb_ue_s1ap_id, and the same mme_ue_s1ap_id
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    bench_ue_t                           *old = ues[i];
+    bench_enb_t                          *enb = old->enb;
+    uint32_t                              mme_ue_s1ap_id = old->mme_ue_s1ap_id;
+
+    remove_ue (old);
+    if (index_get_by_mme_ue_id (mme_ue_s1ap_id)) {
+      fprintf (stderr, "stale index entry after removal of UE %u\n", mme_ue_s1ap_id);
+      return -1;
+    }
+    ues[i] = new_ue (enb, nb_ues_per_enb + (i % nb_ues_per_enb), mme_ue_s1ap_id);
+  }
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    if (index_get_by_mme_ue_id (ues[i]->mme_ue_s1ap_id) != ues[i]) {
+      fprintf (stderr, "index inconsistent after churn for UE %u\n", ues[i]->mme_ue_s1ap_id);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  uint32_t                                max_nb_ues = MAX_NB_OF_UES;
+
+  if (argc > 1) {
+    max_nb_ues = atoi (argv[1]);
+  }
+  if (argc > 2) {
+    nb_ues_per_enb = atoi (argv[2]);
+  }
+  if ((!max_nb_ues) || (!nb_ues_per_enb)) {
+    return EXIT_FAILURE;
+  }
+
+  fprintf (stdout, "%10s %8s %16s %16s\n", "UEs", "eNBs", "dl NAS scan ns", "dl NAS index ns");
+  for (int s = 0; s < (int)(sizeof (sizes) / sizeof (sizes[0])); s++) {
+    uint32_t                              nb_ues = sizes[s];
+    uint32_t                              nb_scans = 0;
+    double                                scan_ns, index_ns;
+
+    if (nb_ues > max_nb_ues) {
+      break;
+    }
+    // A scan visits nb_ues / 2 UEs on average, bound the total work
+    nb_scans = (uint32_t)(SCAN_VISITS_BUDGET / nb_ues);
+    nb_scans = (nb_scans < 20) ? 20 : ((nb_scans > 100000) ? 100000 : nb_scans);
+
+    setup (nb_ues);
+    scan_ns = bench_lookups (nb_ues, nb_scans, scan_get_by_mme_ue_id);
+    index_ns = bench_lookups (nb_ues, NB_OF_INDEX_LOOKUPS, index_get_by_mme_ue_id);
+    if ((scan_ns < 0) || (index_ns < 0) || churn (nb_ues)) {
+      return EXIT_FAILURE;
+    }
+    fprintf (stdout, "%10u %8u %16.1f %16.1f\n", nb_ues, (nb_ues + nb_ues_per_enb - 1) / nb_ues_per_enb,
+             scan_ns, index_ns);
+    teardown (nb_ues);
+  }
+  return EXIT_SUCCESS;
+}
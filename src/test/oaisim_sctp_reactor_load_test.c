@@ -0,0 +1,333 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Loopback load test of the SCTP reactor: opens nb_associations one-to-one SCTP
+ * associations (simulated eNBs) on a reactor listener, each association sends
+ * nb_messages S1AP PPID messages echoed back by the reactor, then all
+ * associations are closed. Checks that every association is notified up and down
+ * exactly once, that every message is delivered and echoed, and reports the
+ * association setup rate, the echo throughput and the recvmmsg() batching.
+ *
+ * usage: oaisim_sctp_reactor_load_test [nb_associations] [nb_messages] [nb_workers] [nb_client_threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/sctp.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "common_types.h"
+#include "dynamic_memory_check.h"
+#include "mme_default_values.h"
+#include "sctp_common.h"
+#include "sctp_reactor.h"
+
+#define NB_OF_ASSOCIATIONS   5000
+#define NB_OF_MESSAGES       20
+#define NB_OF_WORKERS        4
+#define NB_OF_CLIENT_THREADS 4
+#define S1AP_PPID            18
+#define MESSAGE_SIZE         64
+#define WAIT_TIMEOUT_S       60
+
+static uint32_t                         nb_up = 0;
+static uint32_t                         nb_down = 0;
+static uint64_t                         nb_received = 0;
+static uint64_t                         nb_errors = 0;
+
+typedef struct client_thread_s {
+  pthread_t                               thread;
+  struct sockaddr_in                      server;
+  int                                    *sds;
+  int                                     nb_sds;
+  int                                     nb_messages;
+  uint64_t                                nb_echoes;
+  uint64_t                                nb_errors;
+} client_thread_t;
+
+//------------------------------------------------------------------------------
+static double now_s (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static int test_new_association (const sctp_assoc_id_t assoc_id, const sctp_stream_id_t instreams, const sctp_stream_id_t outstreams)
+{
+  __atomic_add_fetch (&nb_up, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int test_new_message_ind (STOLEN_REF bstring *payload, const sctp_assoc_id_t assoc_id, const sctp_stream_id_t stream,
+                                 const sctp_stream_id_t instreams, const sctp_stream_id_t outstreams)
+{
+  __atomic_add_fetch (&nb_received, 1, __ATOMIC_RELAXED);
+  // echo, as S1AP answers from its own task
+  if (sctp_reactor_send (assoc_id, stream, payload) < 0) {
+    __atomic_add_fetch (&nb_errors, 1, __ATOMIC_RELAXED);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int test_com_down_ind (const sctp_assoc_id_t assoc_id)
+{
+  __atomic_add_fetch (&nb_down, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static bool wait_for (uint32_t * const counter, const uint32_t target)
+{
+  double                                  deadline = now_s () + WAIT_TIMEOUT_S;
+
+  while (__atomic_load_n (counter, __ATOMIC_RELAXED) < target) {
+    if (now_s () > deadline) {
+      return false;
+    }
+    usleep (1000);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void *client_connect_thread (void *args)
+{
+  client_thread_t                        *client = (client_thread_t *)args;
+
+  for (int i = 0; i < client->nb_sds; i++) {
+    int                                     sd = socket (AF_INET, SOCK_STREAM, IPPROTO_SCTP);
+
+    if ((sd < 0) || (connect (sd, (struct sockaddr *)&client->server, sizeof (client->server)) < 0)) {
+      fprintf (stderr, "client connect %d: %s\n", i, strerror (errno));
+      client->nb_errors++;
+      if (sd >= 0) {
+        close (sd);
+      }
+      sd = -1;
+    }
+    client->sds[i] = sd;
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *client_echo_thread (void *args)
+{
+  client_thread_t                        *client = (client_thread_t *)args;
+  uint8_t                                 message[MESSAGE_SIZE];
+  uint8_t                                 buffer[SCTP_RECV_BUFFER_SIZE];
+
+  memset (message, 0x5A, sizeof (message));
+  // round robin on the associations, so that the workers always have many ready sockets
+  for (int m = 0; m < client->nb_messages; m++) {
+    for (int i = 0; i < client->nb_sds; i++) {
+      if (client->sds[i] < 0) {
+        continue;
+      }
+      if (sctp_sendmsg (client->sds[i], message, sizeof (message), NULL, 0, htonl (S1AP_PPID), 0, m & 1, 0, 0) < 0) {
+        client->nb_errors++;
+      }
+    }
+  }
+  for (int i = 0; i < client->nb_sds; i++) {
+    for (int m = 0; (client->sds[i] >= 0) && (m < client->nb_messages); m++) {
+      struct sctp_sndrcvinfo                  sinfo = {0};
+      int                                     flags = 0;
+      int                                     n = sctp_recvmsg (client->sds[i], buffer, sizeof (buffer), NULL, NULL, &sinfo, &flags);
+
+      if ((n != MESSAGE_SIZE) || memcmp (buffer, message, MESSAGE_SIZE)) {
+        client->nb_errors++;
+        break;
+      }
+      client->nb_echoes++;
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int create_listener (struct sockaddr_in * const server)
+{
+  struct sctp_event_subscribe             event = {0};
+  socklen_t                               len = sizeof (*server);
+  int                                     sd = socket (AF_INET, SOCK_STREAM, IPPROTO_SCTP);
+
+  if (sd < 0) {
+    fprintf (stderr, "socket: %s\n", strerror (errno));
+    return -1;
+  }
+  memset ((void *)&event, 1, sizeof (struct sctp_event_subscribe));
+  memset (server, 0, sizeof (*server));
+  server->sin_family = AF_INET;
+  server->sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  server->sin_port = 0;
+  if ((setsockopt (sd, IPPROTO_SCTP, SCTP_EVENTS, &event, sizeof (event)) < 0) ||
+      (sctp_set_init_opt (sd, SCTP_IN_STREAMS, SCTP_OUT_STREAMS, 0, 0) < 0) ||
+      (bind (sd, (struct sockaddr *)server, sizeof (*server)) < 0) ||
+      (getsockname (sd, (struct sockaddr *)server, &len) < 0) ||
+      (listen (sd, SCTP_LISTEN_BACKLOG) < 0)) {
+    fprintf (stderr, "listener setup: %s\n", strerror (errno));
+    close (sd);
+    return -1;
+  }
+  return sd;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  int                                     nb_associations = NB_OF_ASSOCIATIONS;
+  int                                     nb_messages = NB_OF_MESSAGES;
+  int                                     nb_workers = NB_OF_WORKERS;
+  int                                     nb_clients = NB_OF_CLIENT_THREADS;
+  struct sockaddr_in                      server;
+  struct rlimit                           rl;
+  sctp_reactor_callbacks_t                callbacks = {
+    .new_association = test_new_association,
+    .new_message_ind = test_new_message_ind,
+    .com_down_ind    = test_com_down_ind,
+  };
+  sctp_reactor_stats_t                    stats;
+  client_thread_t                        *clients = NULL;
+  int                                    *sds = NULL;
+  uint64_t                                nb_echoes = 0;
+  int                                     failures = 0;
+  double                                  t0, t1;
+
+  if (argc > 1) nb_associations = atoi (argv[1]);
+  if (argc > 2) nb_messages = atoi (argv[2]);
+  if (argc > 3) nb_workers = atoi (argv[3]);
+  if (argc > 4) nb_clients = atoi (argv[4]);
+  if ((nb_associations < 1) || (nb_messages < 0) || (nb_clients < 1)) {
+    fprintf (stderr, "usage: %s [nb_associations] [nb_messages] [nb_workers] [nb_client_threads]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (nb_clients > nb_associations) {
+    nb_clients = nb_associations;
+  }
+
+  // client and server side sockets of every association
+  if (getrlimit (RLIMIT_NOFILE, &rl) == 0) {
+    rlim_t                                  needed = 2 * (rlim_t)nb_associations + 64;
+
+    if (rl.rlim_cur < needed) {
+      rl.rlim_cur = (rl.rlim_max == RLIM_INFINITY) || (rl.rlim_max >= needed) ? needed : rl.rlim_max;
+      if (setrlimit (RLIMIT_NOFILE, &rl) < 0) {
+        fprintf (stderr, "setrlimit(RLIMIT_NOFILE, %lu): %s\n", (unsigned long)needed, strerror (errno));
+      }
+    }
+  }
+
+  if (sctp_reactor_init (nb_workers, &callbacks) < 0) {
+    fprintf (stderr, "sctp_reactor_init failed\n");
+    return EXIT_FAILURE;
+  }
+  int                                     listener_sd = create_listener (&server);
+
+  if ((listener_sd < 0) || (sctp_reactor_add_listener (listener_sd, S1AP_PPID) < 0)) {
+    sctp_reactor_exit ();
+    return EXIT_FAILURE;
+  }
+  fprintf (stdout, "%d associations, %d messages each, %d workers, %d client threads, port %u\n",
+      nb_associations, nb_messages, nb_workers, nb_clients, ntohs (server.sin_port));
+
+  sds = calloc (nb_associations, sizeof (int));
+  clients = calloc (nb_clients, sizeof (client_thread_t));
+  for (int c = 0, first = 0; c < nb_clients; c++) {
+    clients[c].server = server;
+    clients[c].sds = &sds[first];
+    clients[c].nb_sds = nb_associations / nb_clients + (c < nb_associations % nb_clients ? 1 : 0);
+    clients[c].nb_messages = nb_messages;
+    first += clients[c].nb_sds;
+  }
+
+  // associations setup
+  t0 = now_s ();
+  for (int c = 0; c < nb_clients; c++) pthread_create (&clients[c].thread, NULL, client_connect_thread, &clients[c]);
+  for (int c = 0; c < nb_clients; c++) pthread_join (clients[c].thread, NULL);
+  if (!wait_for (&nb_up, nb_associations)) {
+    fprintf (stderr, "only %u/%d associations up\n", nb_up, nb_associations);
+    failures++;
+  }
+  t1 = now_s ();
+  fprintf (stdout, "%-30s %10d in %8.3f s %12.0f assoc/s\n", "associations up", nb_associations, t1 - t0, nb_associations / (t1 - t0));
+
+  // echo of all messages
+  t0 = now_s ();
+  for (int c = 0; c < nb_clients; c++) pthread_create (&clients[c].thread, NULL, client_echo_thread, &clients[c]);
+  for (int c = 0; c < nb_clients; c++) pthread_join (clients[c].thread, NULL);
+  t1 = now_s ();
+  for (int c = 0; c < nb_clients; c++) {
+    nb_echoes += clients[c].nb_echoes;
+    failures += clients[c].nb_errors ? 1 : 0;
+  }
+  fprintf (stdout, "%-30s %10"PRIu64" in %8.3f s %12.0f msg/s\n", "messages echoed", nb_echoes, t1 - t0, nb_echoes / (t1 - t0));
+  if (nb_echoes != (uint64_t)nb_associations * nb_messages) {
+    fprintf (stderr, "echoed %"PRIu64" messages, expected %"PRIu64"\n", nb_echoes, (uint64_t)nb_associations * nb_messages);
+    failures++;
+  }
+
+  // associations shutdown
+  t0 = now_s ();
+  for (int i = 0; i < nb_associations; i++) {
+    if (sds[i] >= 0) close (sds[i]);
+  }
+  if (!wait_for (&nb_down, nb_associations)) {
+    fprintf (stderr, "only %u/%d associations down\n", nb_down, nb_associations);
+    failures++;
+  }
+  t1 = now_s ();
+  fprintf (stdout, "%-30s %10d in %8.3f s %12.0f assoc/s\n", "associations down", nb_associations, t1 - t0, nb_associations / (t1 - t0));
+
+  sctp_reactor_get_stats (&stats);
+  fprintf (stdout, "reactor: accepted %"PRIu64" closed %"PRIu64" open %u recv %"PRIu64" sent %"PRIu64" recv calls %"PRIu64" (%.2f msg/call)\n",
+      stats.accepted, stats.closed, stats.number_of_associations, stats.messages_recv, stats.messages_sent, stats.recv_calls,
+      stats.recv_calls ? (double)stats.messages_recv / stats.recv_calls : 0.0);
+  if ((stats.number_of_associations) || (stats.messages_recv != nb_received) || (nb_errors) ||
+      (nb_up != (uint32_t)nb_associations) || (nb_down != (uint32_t)nb_associations)) {
+    fprintf (stderr, "inconsistent reactor state, %"PRIu64" send errors\n", nb_errors);
+    failures++;
+  }
+
+  sctp_reactor_exit ();
+  free_wrapper ((void**)&clients);
+  free_wrapper ((void**)&sds);
+  fprintf (stdout, "%s\n", failures ? "FAILED" : "PASSED");
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
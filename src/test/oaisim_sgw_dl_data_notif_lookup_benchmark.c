@@ -0,0 +1,231 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Downlink data notification UE resolution of the S-GW (sgw_get_subscriber_id_from_ipv4()) with nb_ues attached UEs:
+ * UE IPv4 address -> local S11 teid -> S/P-GW bearer context information.
+ *   - index keyed by the address as an integer (sgw_app.ue_ipv4_to_s11teid, hash_table_ts_t),
+ *   - former index keyed by the address text (inet_ntop() then obj_hashtable_uint64_ts, strdup'ed keys) with the IMSI
+ *     strdup'ed for the caller, and the bearer context table walk that preceded every lookup, on SAMPLE_WALKS lookups,
+ * on nb_ues lookups of random attached UEs plus nb_ues / 10 lookups of unknown addresses, and reports lookups/s.
+ * Returns non zero if a UE is not resolved to its context or an unknown address is.
+ *
+ * usage: oaisim_sgw_dl_data_notif_lookup_benchmark [nb_ues]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "common_defs.h"
+#include "hashtable.h"
+#include "obj_hashtable.h"
+
+#define NB_OF_UES                 (1 << 16)      // the former index has 512 fixed buckets: quadratic beyond
+#define SAMPLE_WALKS              20
+#define UE_POOL_FIRST             "10.0.0.1"
+#define FIRST_S11_TEID            0x100
+
+typedef struct bench_context_s {
+  uint32_t                                s11_teid;
+  char                                    imsi[16];
+} bench_context_t;
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static uint64_t rand64 (uint64_t * const state)
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ULL;
+}
+
+static struct in_addr ue_addr (const uint32_t i)
+{
+  struct in_addr                          addr;
+
+  inet_aton (UE_POOL_FIRST, &addr);
+  addr.s_addr = htonl (ntohl (addr.s_addr) + i);
+  return addr;
+}
+
+static void free_nothing (void **p)
+{
+}
+
+// sgw_display_s11_bearer_context_information_mapping() callback with logs disabled
+static bool walk_cb (const hash_key_t key, void * const element, void *parameter, void **result)
+{
+  (*(uint64_t *)parameter) += ((bench_context_t *)element)->s11_teid;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// sgw_get_subscriber_id_from_ipv4() before: text key, IMSI strdup'ed for the caller
+static int lookup_text (obj_hash_table_uint64_t * const ip2s11teid, hash_table_ts_t * const contexts,
+                        const struct in_addr * const ue, const bool walk, bench_context_t ** const ctx)
+{
+  char                                    str[INET6_ADDRSTRLEN + 1] = {0};
+  uint64_t                                teid = 0;
+  uint64_t                                sum = 0;
+  char                                   *imsi = NULL;
+
+  if (inet_ntop (AF_INET, ue, str, INET_ADDRSTRLEN) == NULL) {
+    return RETURNerror;
+  }
+  if (walk) {
+    hashtable_ts_apply_callback_on_elements (contexts, walk_cb, &sum, NULL);
+  }
+  if (HASH_TABLE_OK != obj_hashtable_uint64_ts_get (ip2s11teid, str, strlen (str), &teid)) {
+    return RETURNerror;
+  }
+  if ((HASH_TABLE_OK != hashtable_ts_get (contexts, (hash_key_t)teid, (void **)ctx)) || (!*ctx)) {
+    return RETURNerror;
+  }
+  imsi = strdup ((*ctx)->imsi);
+  free (imsi);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+// sgw_get_subscriber_id_from_ipv4() now
+static int lookup_int (hash_table_ts_t * const ue_ipv4_to_s11teid, hash_table_ts_t * const contexts,
+                       const struct in_addr * const ue, bench_context_t ** const ctx)
+{
+  void                                   *teid = NULL;
+
+  if (HASH_TABLE_OK != hashtable_ts_get (ue_ipv4_to_s11teid, (hash_key_t)ue->s_addr, &teid)) {
+    return RETURNerror;
+  }
+  if ((HASH_TABLE_OK != hashtable_ts_get (contexts, (hash_key_t)(uintptr_t)teid, (void **)ctx)) || (!*ctx)) {
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+#define CHECK(cOnD, ...) do { if (!(cOnD)) { fprintf (stderr, "FAILED line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); fprintf (stderr, "\n"); return 1; } } while (0)
+
+int main (int argc, char *argv[])
+{
+  const uint32_t                          nb_ues = (argc > 1) ? (uint32_t)atoi (argv[1]) : NB_OF_UES;
+  bench_context_t                        *ctxs = calloc (nb_ues, sizeof (bench_context_t));
+  uint32_t                               *order = calloc (nb_ues, sizeof (uint32_t));
+  hash_table_ts_t                        *contexts = NULL;
+  hash_table_ts_t                        *ue_ipv4_to_s11teid = NULL;
+  obj_hash_table_uint64_t                *ip2s11teid = NULL;
+  bench_context_t                        *ctx = NULL;
+  struct in_addr                          ue;
+  char                                    str[INET6_ADDRSTRLEN + 1] = {0};
+  uint64_t                                state = 0x9E3779B97F4A7C15ULL;
+  struct timespec                         start;
+  double                                  t = 0;
+
+  contexts = hashtable_ts_create (512, NULL, free_nothing, bfromcstr ("s11_bearer_context_information"));
+  ue_ipv4_to_s11teid = hashtable_ts_create (nb_ues, NULL, hash_free_int_func, bfromcstr ("ue_ipv4_to_s11teid"));
+  ip2s11teid = obj_hashtable_uint64_ts_create (512, NULL, NULL, bfromcstr ("ip2s11teid"));
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    ctxs[i].s11_teid = FIRST_S11_TEID + i;
+    snprintf (ctxs[i].imsi, sizeof (ctxs[i].imsi), "20893%010u", i);
+    CHECK (HASH_TABLE_OK == hashtable_ts_insert (contexts, ctxs[i].s11_teid, &ctxs[i]), "context %u", i);
+    order[i] = (uint32_t)(rand64 (&state) % nb_ues);
+  }
+
+  // registration, sgw_register_paging_paa()
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    ue = ue_addr (i);
+    inet_ntop (AF_INET, &ue, str, INET_ADDRSTRLEN);
+    CHECK (HASH_TABLE_OK == obj_hashtable_uint64_ts_insert (ip2s11teid, strdup (str), strlen (str), ctxs[i].s11_teid), "text register %u", i);
+  }
+  t = elapsed_sec (&start);
+  printf ("text key register:    %u in %.3f s, %.0f /s\n", nb_ues, t, nb_ues / t);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    ue = ue_addr (i);
+    CHECK (HASH_TABLE_OK == hashtable_ts_insert (ue_ipv4_to_s11teid, (hash_key_t)ue.s_addr, (void *)(uintptr_t)ctxs[i].s11_teid), "int register %u", i);
+  }
+  t = elapsed_sec (&start);
+  printf ("int key register:     %u in %.3f s, %.0f /s\n", nb_ues, t, nb_ues / t);
+
+  // lookups of attached UEs
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < SAMPLE_WALKS; i++) {
+    ue = ue_addr (order[i]);
+    CHECK (RETURNok == lookup_text (ip2s11teid, contexts, &ue, true, &ctx), "text lookup %u", order[i]);
+  }
+  t = elapsed_sec (&start);
+  printf ("text key + walk:      %u in %.3f s, %.0f lookups/s\n", SAMPLE_WALKS, t, SAMPLE_WALKS / t);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    ue = ue_addr (order[i]);
+    CHECK (RETURNok == lookup_text (ip2s11teid, contexts, &ue, false, &ctx), "text lookup %u", order[i]);
+    CHECK (ctx == &ctxs[order[i]], "text lookup %u wrong context", order[i]);
+  }
+  t = elapsed_sec (&start);
+  printf ("text key:             %u in %.3f s, %.0f lookups/s\n", nb_ues, t, nb_ues / t);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    ue = ue_addr (order[i]);
+    CHECK (RETURNok == lookup_int (ue_ipv4_to_s11teid, contexts, &ue, &ctx), "int lookup %u", order[i]);
+    CHECK (ctx == &ctxs[order[i]], "int lookup %u wrong context", order[i]);
+  }
+  t = elapsed_sec (&start);
+  printf ("int key:              %u in %.3f s, %.0f lookups/s\n", nb_ues, t, nb_ues / t);
+
+  // unknown addresses, after the pool
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues / 10; i++) {
+    ue = ue_addr (nb_ues + i);
+    CHECK (RETURNerror == lookup_int (ue_ipv4_to_s11teid, contexts, &ue, &ctx), "unknown address %u resolved", nb_ues + i);
+  }
+  t = elapsed_sec (&start);
+  printf ("int key, unknown:     %u in %.3f s, %.0f lookups/s\n", nb_ues / 10, t, (nb_ues / 10) / t);
+
+  // deregistration, sgw_deregister_paging_paa(), then the UE is not resolved any more
+  for (uint32_t i = 0; i < nb_ues; i += 2) {
+    ue = ue_addr (i);
+    CHECK (HASH_TABLE_OK == hashtable_ts_free (ue_ipv4_to_s11teid, (hash_key_t)ue.s_addr), "deregister %u", i);
+  }
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    ue = ue_addr (i);
+    CHECK ((i & 1) == (RETURNok == lookup_int (ue_ipv4_to_s11teid, contexts, &ue, &ctx)), "UE %u after deregistration", i);
+  }
+
+  obj_hashtable_uint64_ts_destroy (ip2s11teid);
+  hashtable_ts_destroy (ue_ipv4_to_s11teid);
+  hashtable_ts_destroy (contexts);
+  free (ctxs);
+  free (order);
+  printf ("PASSED\n");
+  return 0;
+}
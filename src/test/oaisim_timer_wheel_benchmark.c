@@ -0,0 +1,228 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Arms and cancels a large number of ITTI timers (1M by default) in the timing wheel,
+ * then compares with the former implementation (one POSIX timer per request and
+ * a linear search in a STAILQ on cancel) on a smaller population.
+ *
+ * usage: oaisim_timer_wheel_benchmark [nb_timers] [nb_posix_timers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+
+#include "queue.h"
+#include "timer_wheel.h"
+
+#define NB_OF_TIMERS         1000000
+#define NB_OF_POSIX_TIMERS   10000
+// T3450 like guard timer range, with a 10 ms tick: 1 to 30 s
+#define MIN_DELAY_TICKS      100
+#define MAX_DELAY_TICKS      3000
+
+struct posix_timer_elm_s {
+  timer_t                                 timer;
+  STAILQ_ENTRY (posix_timer_elm_s)        entries;
+};
+
+static double elapsed_ns (
+  const struct timespec * const start,
+  const struct timespec * const stop)
+{
+  return ((double)(stop->tv_sec - start->tv_sec) * 1e9) + (double)(stop->tv_nsec - start->tv_nsec);
+}
+
+static void report (
+  const char *const label,
+  uint32_t nb_ops,
+  const struct timespec * const start,
+  const struct timespec * const stop)
+{
+  double ns = elapsed_ns (start, stop);
+
+  fprintf (stdout, "%-32s %10u ops %12.3f ms %10.1f ns/op %12.0f ops/s\n", label, nb_ops, ns / 1e6, ns / nb_ops, nb_ops * 1e9 / ns);
+}
+
+static void count_expired (
+  timer_wheel_id_t id,
+  uint64_t user_data,
+  void *arg,
+  void *cb_arg)
+{
+  (*(uint32_t *)cb_arg) += 1;
+}
+
+static int bench_timer_wheel (
+  uint32_t nb_timers)
+{
+  timer_wheel_t                           wheel;
+  timer_wheel_id_t                       *ids = calloc (nb_timers, sizeof (timer_wheel_id_t));
+  struct timespec                         start, stop;
+  uint32_t                                nb_expired = 0;
+  uint32_t                                i = 0;
+
+  if (!ids) {
+    return -1;
+  }
+  timer_wheel_init (&wheel);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (i = 0; i < nb_timers; i++) {
+    ids[i] = timer_wheel_arm (&wheel, MIN_DELAY_TICKS + (random () % (MAX_DELAY_TICKS - MIN_DELAY_TICKS)), 0, i, NULL);
+    if (TIMER_WHEEL_INVALID_ID == ids[i]) {
+      fprintf (stderr, "timer_wheel_arm failed at %u\n", i);
+      return -1;
+    }
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("timer wheel arm", nb_timers, &start, &stop);
+
+  // Cancel in random order, like guard timers stopped by procedures completion
+  for (i = nb_timers - 1; i > 0; i--) {
+    uint32_t                                j = random () % (i + 1);
+    timer_wheel_id_t                        tmp = ids[i];
+
+    ids[i] = ids[j];
+    ids[j] = tmp;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (i = 0; i < nb_timers / 2; i++) {
+    if (timer_wheel_cancel (&wheel, ids[i], NULL) < 0) {
+      fprintf (stderr, "timer_wheel_cancel failed at %u\n", i);
+      return -1;
+    }
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("timer wheel cancel", nb_timers / 2, &start, &stop);
+
+  // Stale ids must be rejected
+  if (0 == timer_wheel_cancel (&wheel, ids[0], NULL)) {
+    fprintf (stderr, "Cancel of an already cancelled timer succeeded\n");
+    return -1;
+  }
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  timer_wheel_advance (&wheel, MAX_DELAY_TICKS + 1, count_expired, &nb_expired);
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("timer wheel expiry", nb_expired, &start, &stop);
+  if ((nb_expired != nb_timers - nb_timers / 2) || (timer_wheel_num_armed (&wheel))) {
+    fprintf (stderr, "Expired %u timers, expected %u, still armed %u\n", nb_expired, nb_timers - nb_timers / 2, timer_wheel_num_armed (&wheel));
+    return -1;
+  }
+
+  // Re-arm on recycled entries
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (i = 0; i < nb_timers; i++) {
+    ids[i] = timer_wheel_arm (&wheel, MIN_DELAY_TICKS + (random () % (MAX_DELAY_TICKS - MIN_DELAY_TICKS)), 0, i, NULL);
+  }
+  for (i = 0; i < nb_timers; i++) {
+    timer_wheel_cancel (&wheel, ids[i], NULL);
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("timer wheel arm+cancel", nb_timers, &start, &stop);
+
+  timer_wheel_destroy (&wheel);
+  free (ids);
+  return 0;
+}
+
+static int bench_posix_timers (
+  uint32_t nb_timers)
+{
+  STAILQ_HEAD (posix_timer_list_head, posix_timer_elm_s) timer_queue;
+  struct posix_timer_elm_s              **elms = calloc (nb_timers, sizeof (struct posix_timer_elm_s *));
+  struct timespec                         start, stop;
+  uint32_t                                i = 0;
+
+  if (!elms) {
+    return -1;
+  }
+  STAILQ_INIT (&timer_queue);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (i = 0; i < nb_timers; i++) {
+    struct sigevent                         se;
+    struct itimerspec                       its;
+
+    elms[i] = calloc (1, sizeof (struct posix_timer_elm_s));
+    memset (&se, 0, sizeof (se));
+    se.sigev_notify = SIGEV_NONE;
+    if (timer_create (CLOCK_REALTIME, &se, &elms[i]->timer) < 0) {
+      perror ("timer_create");
+      return -1;
+    }
+    memset (&its, 0, sizeof (its));
+    its.it_value.tv_sec = 1 + (random () % 30);
+    timer_settime (elms[i]->timer, 0, &its, NULL);
+    STAILQ_INSERT_TAIL (&timer_queue, elms[i], entries);
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("posix timer arm", nb_timers, &start, &stop);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (i = nb_timers; i > 0; i--) {
+    struct posix_timer_elm_s               *elm = NULL;
+
+    // same search as the former timer_remove()
+    STAILQ_FOREACH (elm, &timer_queue, entries) {
+      if (elm->timer == elms[i - 1]->timer)
+        break;
+    }
+    STAILQ_REMOVE (&timer_queue, elm, posix_timer_elm_s, entries);
+    timer_delete (elm->timer);
+    free (elm);
+  }
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  report ("posix timer cancel", nb_timers, &start, &stop);
+  free (elms);
+  return 0;
+}
+
+int
+main (
+  int argc,
+  char *argv[])
+{
+  uint32_t                                nb_timers = NB_OF_TIMERS;
+  uint32_t                                nb_posix_timers = NB_OF_POSIX_TIMERS;
+
+  if (argc > 1) {
+    nb_timers = atoi (argv[1]);
+
+    if (argc > 2) {
+      nb_posix_timers = atoi (argv[2]);
+    }
+  }
+  srandom (1);
+
+  if (bench_timer_wheel (nb_timers) < 0) {
+    return EXIT_FAILURE;
+  }
+  if ((nb_posix_timers) && (bench_posix_timers (nb_posix_timers) < 0)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
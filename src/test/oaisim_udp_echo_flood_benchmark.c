@@ -0,0 +1,349 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Loopback GTPv2-C Echo flood: a client keeps a window of Echo Requests in flight
+ * towards a server socket answering Echo Responses, with the two receive/send
+ * paths of the UDP task:
+ *  - copy:   one recvfrom() per readiness event into the socket buffer, then
+ *            malloc() + memcpy() of the datagram (former UDP_DATA_IND), one sendto()
+ *            per response (former UDP_DATA_REQ);
+ *  - pooled: up to 4 recvmmsg() of 32 datagrams per readiness event directly in
+ *            pool buffers released by the consumer, one sendmmsg() per batch of
+ *            responses.
+ * Reports echoes per second, server system calls per echo and lost echoes.
+ *
+ * usage: oaisim_udp_echo_flood_benchmark [nb_echoes] [window]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "udp_buffer_pool.h"
+
+#define NB_OF_ECHOES         1000000
+#define WINDOW               128
+#define BUFFER_SIZE          4096
+#define POOL_SIZE            2048
+#define RECV_BATCH           32
+#define RECV_MAX_BATCHES     4
+#define CLIENT_BATCH         32
+#define CLIENT_TIMEOUT_MS    200
+
+#define GTPV2C_ECHO_REQUEST  1
+#define GTPV2C_ECHO_RESPONSE 2
+#define GTPV2C_IE_RECOVERY   3
+#define ECHO_LENGTH          13    /* 8 bytes header without TEID + Recovery IE */
+
+typedef struct server_s {
+  pthread_t                               thread;
+  int                                     sd;
+  bool                                    pooled;
+  volatile bool                           stop;
+  uint64_t                                nb_syscalls;
+  uint64_t                                nb_echoes;
+  uint64_t                                nb_recv_calls;
+  udp_buffer_pool_t                      *pool;
+} server_t;
+
+//------------------------------------------------------------------------------
+static double now_s (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//------------------------------------------------------------------------------
+static void encode_echo (uint8_t * const buffer, const uint8_t type, const uint32_t seq)
+{
+  buffer[0] = 0x40;                         // version 2, no piggybacking, no TEID
+  buffer[1] = type;
+  buffer[2] = 0;
+  buffer[3] = ECHO_LENGTH - 4;
+  buffer[4] = (seq >> 16) & 0xFF;
+  buffer[5] = (seq >> 8) & 0xFF;
+  buffer[6] = seq & 0xFF;
+  buffer[7] = 0;
+  buffer[8] = GTPV2C_IE_RECOVERY;
+  buffer[9] = 0;
+  buffer[10] = 1;
+  buffer[11] = 0;
+  buffer[12] = 7;                           // restart counter
+}
+
+//------------------------------------------------------------------------------
+// Consumer side of a UDP_DATA_IND: answers an Echo Request, returns false if the datagram is not one.
+static bool process_echo_request (const uint8_t * const buffer, const uint32_t length, uint8_t * const response)
+{
+  if ((length < ECHO_LENGTH) || ((buffer[0] >> 5) != 2) || (GTPV2C_ECHO_REQUEST != buffer[1])) {
+    return false;
+  }
+  encode_echo (response, GTPV2C_ECHO_RESPONSE, ((uint32_t)buffer[4] << 16) | ((uint32_t)buffer[5] << 8) | buffer[6]);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void server_copy_event (server_t * const server)
+{
+  static uint8_t                          socket_buffer[BUFFER_SIZE];
+  uint8_t                                 response[ECHO_LENGTH];
+  struct sockaddr_in                      addr;
+  socklen_t                               from_len = sizeof (addr);
+  int                                     bytes_received = recvfrom (server->sd, socket_buffer, sizeof (socket_buffer), 0, (struct sockaddr *)&addr, &from_len);
+
+  server->nb_syscalls++;
+  if (bytes_received <= 0) {
+    return;
+  }
+  server->nb_recv_calls++;
+  uint8_t                                *forwarded_buffer = malloc (bytes_received);
+
+  memcpy (forwarded_buffer, socket_buffer, bytes_received);
+  if (process_echo_request (forwarded_buffer, bytes_received, response)) {
+    sendto (server->sd, response, ECHO_LENGTH, 0, (struct sockaddr *)&addr, sizeof (addr));
+    server->nb_syscalls++;
+    server->nb_echoes++;
+  }
+  free (forwarded_buffer);
+}
+
+//------------------------------------------------------------------------------
+static void server_pooled_event (server_t * const server)
+{
+  static struct mmsghdr                   msgs[RECV_BATCH];
+  static struct iovec                     iovs[RECV_BATCH];
+  static struct sockaddr_in               addrs[RECV_BATCH];
+  static struct mmsghdr                   tx_msgs[RECV_BATCH];
+  static struct iovec                     tx_iovs[RECV_BATCH];
+  static uint8_t                          responses[RECV_BATCH][ECHO_LENGTH];
+
+  for (int batch = 0; batch < RECV_MAX_BATCHES; batch++) {
+    int                                     nb_responses = 0;
+
+    for (int i = 0; i < RECV_BATCH; i++) {
+      if (iovs[i].iov_base == NULL) {
+        iovs[i].iov_base = udp_buffer_alloc (server->pool);
+        iovs[i].iov_len = BUFFER_SIZE;
+      }
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof (addrs[i]);
+      msgs[i].msg_hdr.msg_flags = 0;
+    }
+
+    int                                     n = recvmmsg (server->sd, msgs, RECV_BATCH, MSG_DONTWAIT, NULL);
+
+    server->nb_syscalls++;
+    if (n <= 0) {
+      return;
+    }
+    server->nb_recv_calls++;
+    for (int i = 0; i < n; i++) {
+      // ownership of the buffer goes with the message
+      uint8_t                                *buffer = iovs[i].iov_base;
+
+      iovs[i].iov_base = NULL;
+      if (process_echo_request (buffer, msgs[i].msg_len, responses[nb_responses])) {
+        tx_iovs[nb_responses].iov_base = responses[nb_responses];
+        tx_iovs[nb_responses].iov_len = ECHO_LENGTH;
+        memset (&tx_msgs[nb_responses], 0, sizeof (struct mmsghdr));
+        tx_msgs[nb_responses].msg_hdr.msg_iov = &tx_iovs[nb_responses];
+        tx_msgs[nb_responses].msg_hdr.msg_iovlen = 1;
+        tx_msgs[nb_responses].msg_hdr.msg_name = &addrs[i];
+        tx_msgs[nb_responses].msg_hdr.msg_namelen = sizeof (addrs[i]);
+        nb_responses++;
+      }
+      udp_buffer_free (&buffer);
+    }
+    for (int sent = 0; sent < nb_responses; ) {
+      int                                     rc = sendmmsg (server->sd, &tx_msgs[sent], nb_responses - sent, 0);
+
+      server->nb_syscalls++;
+      sent += (rc > 0) ? rc : 1;
+    }
+    server->nb_echoes += nb_responses;
+    if (n < RECV_BATCH) {
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *server_thread (void *args)
+{
+  server_t                               *server = (server_t *)args;
+  struct epoll_event                      event = {.events = EPOLLIN};
+  int                                     epoll_fd = epoll_create1 (0);
+
+  epoll_ctl (epoll_fd, EPOLL_CTL_ADD, server->sd, &event);
+  while (!server->stop) {
+    struct epoll_event                      events[1];
+
+    if (epoll_wait (epoll_fd, events, 1, 50) <= 0) {
+      continue;
+    }
+    server->nb_syscalls++;
+    if (server->pooled) {
+      server_pooled_event (server);
+    } else {
+      server_copy_event (server);
+    }
+  }
+  close (epoll_fd);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int bind_loopback (struct sockaddr_in * const addr)
+{
+  socklen_t                               len = sizeof (*addr);
+  int                                     sd = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+  memset (addr, 0, sizeof (*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  if ((sd < 0) || (bind (sd, (struct sockaddr *)addr, sizeof (*addr)) < 0) || (getsockname (sd, (struct sockaddr *)addr, &len) < 0)) {
+    fprintf (stderr, "socket setup: %s\n", strerror (errno));
+    exit (EXIT_FAILURE);
+  }
+  return sd;
+}
+
+//------------------------------------------------------------------------------
+static int run (const bool pooled, const uint32_t nb_echoes, const int window)
+{
+  server_t                                server = {.pooled = pooled};
+  struct sockaddr_in                      server_addr, client_addr;
+  int                                     client_sd = -1;
+  uint32_t                                nb_sent = 0, nb_received = 0, nb_lost = 0, nb_errors = 0;
+  struct mmsghdr                          msgs[CLIENT_BATCH];
+  struct iovec                            iovs[CLIENT_BATCH];
+  uint8_t                                 buffers[CLIENT_BATCH][BUFFER_SIZE];
+  double                                  t0, t1;
+
+  server.sd = bind_loopback (&server_addr);
+  server.pool = udp_buffer_pool_create (POOL_SIZE, BUFFER_SIZE);
+  client_sd = bind_loopback (&client_addr);
+  connect (client_sd, (struct sockaddr *)&server_addr, sizeof (server_addr));
+  pthread_create (&server.thread, NULL, server_thread, &server);
+
+  t0 = now_s ();
+  while (nb_received + nb_lost < nb_echoes) {
+    // refill the window
+    while ((nb_sent < nb_echoes) && ((int)(nb_sent - nb_received - nb_lost) < window)) {
+      int                                     n = 0;
+
+      for (; (n < CLIENT_BATCH) && (nb_sent + n < nb_echoes) && ((int)(nb_sent + n - nb_received - nb_lost) < window); n++) {
+        encode_echo (buffers[n], GTPV2C_ECHO_REQUEST, (nb_sent + n) & 0xFFFFFF);
+        iovs[n].iov_base = buffers[n];
+        iovs[n].iov_len = ECHO_LENGTH;
+        memset (&msgs[n], 0, sizeof (msgs[n]));
+        msgs[n].msg_hdr.msg_iov = &iovs[n];
+        msgs[n].msg_hdr.msg_iovlen = 1;
+      }
+      int                                     rc = sendmmsg (client_sd, msgs, n, 0);
+
+      if (rc <= 0) {
+        break;
+      }
+      nb_sent += rc;
+    }
+
+    struct pollfd                           pfd = {.fd = client_sd,.events = POLLIN };
+
+    if (poll (&pfd, 1, CLIENT_TIMEOUT_MS) <= 0) {
+      // nothing came back in time, consider the window lost
+      nb_lost += nb_sent - nb_received - nb_lost;
+      continue;
+    }
+    for (int i = 0; i < CLIENT_BATCH; i++) {
+      iovs[i].iov_base = buffers[i];
+      iovs[i].iov_len = BUFFER_SIZE;
+      memset (&msgs[i], 0, sizeof (msgs[i]));
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int                                     n = recvmmsg (client_sd, msgs, CLIENT_BATCH, MSG_DONTWAIT, NULL);
+
+    for (int i = 0; i < n; i++) {
+      if ((msgs[i].msg_len != ECHO_LENGTH) || (GTPV2C_ECHO_RESPONSE != buffers[i][1])) {
+        nb_errors++;
+      }
+    }
+    nb_received += (n > 0) ? n : 0;
+  }
+  t1 = now_s ();
+
+  server.stop = true;
+  pthread_join (server.thread, NULL);
+
+  udp_buffer_pool_stats_t                 stats;
+
+  udp_buffer_pool_get_stats (server.pool, &stats);
+  fprintf (stdout, "%-8s %9u echoes %8.3f s %10.0f echo/s %6.2f server syscalls/echo %6.2f dgrams/recv, lost %u, errors %u",
+      pooled ? "pooled" : "copy", nb_received, t1 - t0, nb_received / (t1 - t0),
+      server.nb_echoes ? (double)server.nb_syscalls / server.nb_echoes : 0.0,
+      server.nb_recv_calls ? (double)server.nb_echoes / server.nb_recv_calls : 0.0, nb_lost, nb_errors);
+  if (pooled) {
+    fprintf (stdout, ", pool allocs %"PRIu64" heap %"PRIu64, stats.nb_allocs, stats.nb_heap_allocs);
+  }
+  fprintf (stdout, "\n");
+  close (client_sd);
+  close (server.sd);
+  udp_buffer_pool_destroy (&server.pool);
+  return nb_errors ? 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  uint32_t                                nb_echoes = NB_OF_ECHOES;
+  int                                     window = WINDOW;
+  int                                     failures = 0;
+
+  if (argc > 1) nb_echoes = strtoul (argv[1], NULL, 0);
+  if (argc > 2) window = atoi (argv[2]);
+  if ((nb_echoes == 0) || (window < 1)) {
+    fprintf (stderr, "usage: %s [nb_echoes] [window]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  fprintf (stdout, "%u GTPv2-C echoes, window %d\n", nb_echoes, window);
+  failures += run (false, nb_echoes, window);
+  failures += run (true, nb_echoes, window);
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
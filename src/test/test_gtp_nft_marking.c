@@ -0,0 +1,154 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * nftables bearer marking (gtp_nft_marking.c) played in a private network namespace, so that the
+ * host rules are not touched: creates the table, inserts the PCC rules of a default and a dedicated
+ * SDF in both chains, adds a bearer mark per UE, checks the map content, removes half of the
+ * bearers, re-adds a bearer on an address already in the map (UE IP address reuse) and removes the
+ * table. Bearer add and remove rates are reported, each one is one netlink transaction.
+ * Needs CAP_SYS_ADMIN (network namespace) and a kernel with nf_tables, prints SKIPPED otherwise.
+ * Returns non zero if the kernel rejects a transaction or the map content is wrong.
+ *
+ * usage: test_gtp_nft_marking [nb_ues]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "common_defs.h"
+#include "gtp_nft_marking.h"
+
+#define NB_OF_UES                 10000
+#define UE_POOL_FIRST             "10.0.0.1"
+#define SDF_ID_NGBR_DEFAULT       0x0001     // same values as in pgw_pcef_emulation.h
+#define SDF_ID_TEST_PING          0x0003
+#define DEFAULT_EBI               5
+#define DEDICATED_EBI             6
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static struct in_addr ue_addr (const uint32_t i)
+{
+  struct in_addr                          addr;
+
+  inet_aton (UE_POOL_FIRST, &addr);
+  addr.s_addr = htonl (ntohl (addr.s_addr) + i);
+  return addr;
+}
+
+#define CHECK(cOnD, ...) do { if (!(cOnD)) { fprintf (stderr, "FAILED line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); fprintf (stderr, "\n"); gtp_nft_marking_exit (); return 1; } } while (0)
+
+int main (int argc, char *argv[])
+{
+  uint32_t                                nb_ues = (argc > 1) ? (uint32_t)atoi (argv[1]) : NB_OF_UES;
+  gtp_nft_match_t                         match = {0};
+  struct timespec                         start;
+  double                                  t = 0;
+  int                                     count = 0;
+
+  if (unshare (CLONE_NEWNET)) {
+    printf ("SKIPPED: no network namespace (%s)\n", strerror (errno));
+    return 0;
+  }
+  if (RETURNok != gtp_nft_marking_init ("gtp0")) {
+    printf ("SKIPPED: no nf_tables\n");
+    return 0;
+  }
+  // init twice: the table is recreated from scratch
+  CHECK (RETURNok == gtp_nft_marking_init ("gtp0"), "re-init");
+
+  // default SDF: every packet to the UE pool
+  match.flags = GTP_NFT_MATCH_DADDR_RANGE;
+  match.daddr_low = ue_addr (0);
+  match.daddr_high = ue_addr (nb_ues);
+  CHECK (RETURNok == gtp_nft_marking_add_sdf_rule (GTP_NFT_CHAIN_POSTROUTING, &match, SDF_ID_NGBR_DEFAULT), "default SDF postrouting");
+  CHECK (RETURNok == gtp_nft_marking_add_sdf_rule (GTP_NFT_CHAIN_OUTPUT, &match, SDF_ID_NGBR_DEFAULT), "default SDF output");
+  // dedicated SDF: ICMP from a remote network, every field of the match
+  memset (&match, 0, sizeof (match));
+  match.flags = GTP_NFT_MATCH_DADDR_RANGE | GTP_NFT_MATCH_SADDR | GTP_NFT_MATCH_PROTOCOL | GTP_NFT_MATCH_TOS;
+  match.daddr_low = ue_addr (0);
+  match.daddr_high = ue_addr (nb_ues);
+  inet_aton ("192.168.12.0", &match.saddr);
+  inet_aton ("255.255.255.0", &match.saddr_mask);
+  match.protocol = 1;
+  match.tos = 0x20;
+  CHECK (RETURNok == gtp_nft_marking_add_sdf_rule (GTP_NFT_CHAIN_POSTROUTING, &match, SDF_ID_TEST_PING), "dedicated SDF postrouting");
+  memset (&match, 0, sizeof (match));
+  match.flags = GTP_NFT_MATCH_DADDR | GTP_NFT_MATCH_PROTOCOL | GTP_NFT_MATCH_DPORT | GTP_NFT_MATCH_SPORT;
+  inet_aton ("10.0.0.0", &match.daddr);
+  inet_aton ("255.0.0.0", &match.daddr_mask);
+  match.protocol = 17;
+  match.dport = 5001;
+  match.sport = 5002;
+  CHECK (RETURNok == gtp_nft_marking_add_sdf_rule (GTP_NFT_CHAIN_OUTPUT, &match, SDF_ID_TEST_PING), "dedicated SDF output");
+  memset (&match, 0, sizeof (match));
+  match.flags = GTP_NFT_MATCH_PROTOCOL | GTP_NFT_MATCH_SPI;
+  match.protocol = 50;
+  match.spi = 0x1234;
+  CHECK (RETURNok == gtp_nft_marking_add_sdf_rule (GTP_NFT_CHAIN_POSTROUTING, &match, SDF_ID_TEST_PING), "ESP SDF postrouting");
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    CHECK (RETURNok == gtp_nft_marking_add_bearer (ue_addr (i), SDF_ID_NGBR_DEFAULT, DEFAULT_EBI), "add bearer %u", i);
+  }
+  t = elapsed_sec (&start);
+  printf ("add bearer:    %u in %.3f s, %.0f /s\n", nb_ues, t, nb_ues / t);
+  for (uint32_t i = 0; i < nb_ues; i += 10) {
+    CHECK (RETURNok == gtp_nft_marking_add_bearer (ue_addr (i), SDF_ID_TEST_PING, DEDICATED_EBI), "add dedicated bearer %u", i);
+  }
+  count = gtp_nft_marking_bearer_count ();
+  CHECK ((nb_ues + (nb_ues + 9) / 10) == (uint32_t)count, "count %d after add", count);
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < nb_ues; i += 2) {
+    CHECK (RETURNok == gtp_nft_marking_del_bearer (ue_addr (i), SDF_ID_NGBR_DEFAULT), "del bearer %u", i);
+  }
+  t = elapsed_sec (&start);
+  printf ("del bearer:    %u in %.3f s, %.0f /s\n", (nb_ues + 1) / 2, t, ((nb_ues + 1) / 2) / t);
+  // missing element, UE IP address reused while the previous bearer is still there
+  CHECK (RETURNok == gtp_nft_marking_del_bearer (ue_addr (0), SDF_ID_NGBR_DEFAULT), "del missing bearer");
+  CHECK (RETURNok == gtp_nft_marking_add_bearer (ue_addr (1), SDF_ID_NGBR_DEFAULT, DEDICATED_EBI), "re-add bearer");
+  count = gtp_nft_marking_bearer_count ();
+  CHECK ((nb_ues / 2 + (nb_ues + 9) / 10) == (uint32_t)count, "count %d after del", count);
+
+  CHECK (RETURNok == gtp_nft_marking_init ("gtp0"), "re-init");
+  count = gtp_nft_marking_bearer_count ();
+  CHECK (0 == count, "count %d after re-init", count);
+  gtp_nft_marking_exit ();
+  CHECK (-1 == gtp_nft_marking_bearer_count (), "count after exit");
+  printf ("PASSED\n");
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Checks the incremental resizing of hash_table_t and hash_table_ts_t: tables created
+ * with a few buckets are filled far beyond their initial size with random inserts,
+ * removes and lookups compared against a reference bitmap, while (for the thread safe
+ * table) another thread keeps iterating over the elements and collecting statistics.
+ * Prints the statistics of both tables, returns non zero on any mismatch.
+ *
+ * usage: test_hashtable_resize [nb_keys] [nb_ops]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "hashtable.h"
+
+#define NB_OF_KEYS           200000
+#define NB_OF_OPS            2000000
+#define NB_OF_THREADS        4
+
+static uint32_t                           nb_keys = NB_OF_KEYS;
+static uint32_t                           nb_ops  = NB_OF_OPS;
+static hash_table_ts_t                   *ts_table = NULL;
+static volatile bool                      stop_iterating = false;
+static long                               nb_errors = 0;
+
+//------------------------------------------------------------------------------
+static void free_nothing (void **data)
+{
+}
+
+//------------------------------------------------------------------------------
+// eNB id << 24 | eNB UE S1AP ID like keys, the worst case of the former identity hash
+static hash_key_t make_key (const uint32_t owner, const uint32_t i)
+{
+  return ((uint64_t)owner << 40) | ((uint64_t)(i / 1000 + 1) << 24) | (i % 1000);
+}
+
+//------------------------------------------------------------------------------
+static bool check_stats (const char *name, hashtable_stats_t * const stats, const hash_size_t expected)
+{
+  bstring                                 b = bfromcstr ("");
+
+  hashtable_dump_stats (stats, b);
+  printf ("%s: %s", name, bdata (b));
+  bdestroy (b);
+  if (stats->num_elements != expected) {
+    printf ("%s: %zu elements, expected %zu\n", name, stats->num_elements, expected);
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool test_hashtable (void)
+{
+  hash_table_t                           *table = hashtable_create (16, NULL, free_nothing, NULL);
+  uint8_t                                *present = calloc (nb_keys, 1);
+  unsigned int                            seed = 1;
+  hash_size_t                             expected = 0;
+  hashtable_stats_t                       stats = {0};
+  void                                   *data = NULL;
+
+  for (uint32_t n = 0; n < nb_ops; n++) {
+    uint32_t                                i = rand_r (&seed) % nb_keys;
+    hash_key_t                              key = make_key (0, i);
+    hashtable_rc_t                          rc = HASH_TABLE_OK;
+
+    switch (rand_r (&seed) % 3) {
+    case 0:
+      hashtable_insert (table, key, (void *)(uintptr_t)(key + 1));
+      present[i] = 1;
+      break;
+    case 1:
+      rc = hashtable_remove (table, key, &data);
+      if ((HASH_TABLE_OK == rc) != present[i]) nb_errors++;
+      present[i] = 0;
+      break;
+    default:
+      rc = hashtable_get (table, key, &data);
+      if ((HASH_TABLE_OK == rc) != present[i]) nb_errors++;
+      if ((HASH_TABLE_OK == rc) && (data != (void *)(uintptr_t)(key + 1))) nb_errors++;
+    }
+  }
+  for (uint32_t i = 0; i < nb_keys; i++) {
+    expected += present[i];
+  }
+  hashtable_get_stats (table, &stats);
+  hashtable_destroy (table);
+  free (present);
+  return check_stats ("hash_table_t", &stats, expected) && (stats.num_resizes > 0);
+}
+
+//------------------------------------------------------------------------------
+static void *ts_worker (void *arg)
+{
+  uint32_t                                owner = (uint32_t)(uintptr_t)arg;
+  uint8_t                                *present = calloc (nb_keys, 1);
+  unsigned int                            seed = owner;
+  long                                    nb_present = 0;
+  void                                   *data = NULL;
+
+  for (uint32_t n = 0; n < nb_ops; n++) {
+    uint32_t                                i = rand_r (&seed) % nb_keys;
+    hash_key_t                              key = make_key (owner, i);
+    hashtable_rc_t                          rc = HASH_TABLE_OK;
+
+    switch (rand_r (&seed) % 3) {
+    case 0:
+      hashtable_ts_insert (ts_table, key, (void *)(uintptr_t)(key + 1));
+      present[i] = 1;
+      break;
+    case 1:
+      rc = hashtable_ts_remove (ts_table, key, &data);
+      if ((HASH_TABLE_OK == rc) != present[i]) __sync_fetch_and_add (&nb_errors, 1);
+      present[i] = 0;
+      break;
+    default:
+      rc = hashtable_ts_get (ts_table, key, &data);
+      if ((HASH_TABLE_OK == rc) != present[i]) __sync_fetch_and_add (&nb_errors, 1);
+      if ((HASH_TABLE_OK == rc) && (data != (void *)(uintptr_t)(key + 1))) __sync_fetch_and_add (&nb_errors, 1);
+    }
+  }
+  for (uint32_t i = 0; i < nb_keys; i++) {
+    nb_present += present[i];
+  }
+  free (present);
+  return (void *)nb_present;
+}
+
+//------------------------------------------------------------------------------
+static bool count_cb (const hash_key_t key, void * const data, void *parameter, void **result)
+{
+  *(long *)parameter += 1;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static void *ts_iterator (void *arg)
+{
+  hashtable_stats_t                       stats = {0};
+  long                                    nb_iterations = 0;
+  long                                    count = 0;
+
+  while (!stop_iterating) {
+    count = 0;
+    hashtable_ts_apply_callback_on_elements (ts_table, count_cb, &count, NULL);
+    hashtable_ts_get_stats (ts_table, &stats);
+    nb_iterations++;
+  }
+  return (void *)nb_iterations;
+}
+
+//------------------------------------------------------------------------------
+static bool test_hashtable_ts (void)
+{
+  pthread_t                               workers[NB_OF_THREADS];
+  pthread_t                               iterator;
+  hashtable_stats_t                       stats = {0};
+  hashtable_key_array_t                  *keys = NULL;
+  hash_size_t                             expected = 0;
+  void                                   *result = NULL;
+  bool                                    ok = true;
+
+  ts_table = hashtable_ts_create (64, NULL, free_nothing, NULL);
+  pthread_create (&iterator, NULL, ts_iterator, NULL);
+  for (int t = 0; t < NB_OF_THREADS; t++) {
+    pthread_create (&workers[t], NULL, ts_worker, (void *)(uintptr_t)(t + 1));
+  }
+  for (int t = 0; t < NB_OF_THREADS; t++) {
+    pthread_join (workers[t], &result);
+    expected += (hash_size_t)(uintptr_t)result;
+  }
+  stop_iterating = true;
+  pthread_join (iterator, &result);
+  printf ("hash_table_ts_t: %ld iterations done while resizing\n", (long)(uintptr_t)result);
+
+  hashtable_ts_get_stats (ts_table, &stats);
+  ok = check_stats ("hash_table_ts_t", &stats, expected) && (stats.num_resizes > 0);
+  if ((keys = hashtable_ts_get_keys (ts_table))) {
+    ok = ok && (keys->num_keys == expected);
+    free (keys->keys);
+    free (keys);
+  }
+  hashtable_ts_destroy (ts_table);
+  return ok;
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  bool                                    ok = true;
+
+  if (argc > 1) nb_keys = atoi (argv[1]);
+  if (argc > 2) nb_ops = atoi (argv[2]);
+
+  ok = test_hashtable () && ok;
+  ok = test_hashtable_ts () && ok;
+  printf ("%ld lookup errors\n", nb_errors);
+  if ((!ok) || (nb_errors)) {
+    printf ("FAILED\n");
+    return EXIT_FAILURE;
+  }
+  printf ("OK\n");
+  return EXIT_SUCCESS;
+}
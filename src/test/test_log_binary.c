@@ -0,0 +1,301 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * Checks the binary logging records: every supported conversion is recorded in a ring
+ * and formatted back by the consumer code, the result must be identical to the text
+ * path (vsnprintf). Then one producer thread fills a small ring while the main thread
+ * drains it concurrently, records must come out complete and in order, drops being
+ * accounted. Last, compares the producer cost of the text path (header and message
+ * formatted in a bstring, as log_message() does) with the binary path.
+ *
+ * usage: test_log_binary [nb_records]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "log_binary.h"
+
+#define NB_OF_RECORDS        1000000
+#define SMALL_RING_SIZE      4096
+
+static uint32_t                           nb_records = NB_OF_RECORDS;
+static long                               nb_errors = 0;
+static log_binary_ring_t                 *shared_ring = NULL;
+static volatile bool                      producer_done = false;
+
+//------------------------------------------------------------------------------
+static int record (log_binary_ring_t * const ring, log_format_site_t * const site, const uint64_t message_number, const char *format, ...)
+{
+  log_binary_record_header_t              header = {0};
+  va_list                                 args;
+  int                                     rc = 0;
+
+  if (LOG_FORMAT_SITE_BINARY != log_format_site_parse (site, format)) {
+    return -2;
+  }
+  header.message_number = message_number;
+  header.site_id        = (uint64_t)(uintptr_t)site;
+  va_start (args, format);
+  rc = log_binary_ring_write_message (ring, &header, site, args);
+  va_end (args);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static void check_roundtrip (log_binary_ring_t * const ring, const char *format, ...)
+{
+  log_format_site_t                       site = {.source_file = __FILE__, .line_num = __LINE__};
+  const log_binary_record_header_t       *header = NULL;
+  bstring                                 b = bfromcstr ("");
+  char                                    expected[2048];
+  log_binary_record_header_t              h = {0};
+  va_list                                 args;
+
+  va_start (args, format);
+  vsnprintf (expected, sizeof(expected), format, args);
+  va_end (args);
+
+  if (LOG_FORMAT_SITE_BINARY != log_format_site_parse (&site, format)) {
+    printf ("\"%s\": not recorded\n", format);
+    nb_errors++;
+    bdestroy (b);
+    return;
+  }
+  h.site_id = (uint64_t)(uintptr_t)&site;
+  va_start (args, format);
+  log_binary_ring_write_message (ring, &h, &site, args);
+  va_end (args);
+
+  header = log_binary_ring_peek (ring);
+  if ((!header) || (BSTR_OK != log_binary_format_args (b, format, header)) || (strcmp (expected, (const char *)b->data))) {
+    printf ("\"%s\": got \"%s\" expected \"%s\"\n", format, (const char *)b->data, expected);
+    nb_errors++;
+  }
+  if (header) {
+    log_binary_ring_release (ring, header);
+  }
+  bdestroy (b);
+}
+
+//------------------------------------------------------------------------------
+static void check_text_only (const char *format)
+{
+  log_format_site_t                       site = {.source_file = __FILE__, .line_num = __LINE__};
+
+  if (LOG_FORMAT_SITE_TEXT_ONLY != log_format_site_parse (&site, format)) {
+    printf ("\"%s\": should stay on the text path\n", format);
+    nb_errors++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void test_conversions (void)
+{
+  log_binary_ring_t                      *ring = log_binary_ring_create (SMALL_RING_SIZE);
+  char                                    not_terminated[4] = {'a', 'b', 'c', 'd'};
+  char                                    long_string[LOG_BINARY_MAX_STRING_LENGTH + 100];
+
+  memset (long_string, 'x', sizeof(long_string) - 1);
+  long_string[sizeof(long_string) - 1] = '\0';
+
+  check_roundtrip (ring, "no argument\n");
+  check_roundtrip (ring, "");
+  check_roundtrip (ring, "100%% %d%%\n", 42);
+  check_roundtrip (ring, "UE " "mme_ue_s1ap_id " "%06" PRIX32 " enb_ue_s1ap_id %06x\n", (uint32_t)0x123456, 0xABCDEF);
+  check_roundtrip (ring, "%d %i %u %o %x %X %c|%-5d|%05d|%+d|% d|%#x\n", -1, 2, 3u, 8, 255, 255, 'z', 7, 7, 7, 7, 255);
+  check_roundtrip (ring, "%hhx %hd %hu\n", 0x1ff, (short)-3, (unsigned short)65535);
+  check_roundtrip (ring, "%ld %lu %lx %lld %llu %llx %zu %zd %jd %td\n", -1L, 2UL, 0xdeadbeefUL, -3LL, 4ULL, 0x123456789abcULL,
+      (size_t)5, (ssize_t)-6, (intmax_t)7, (ptrdiff_t)-8);
+  check_roundtrip (ring, "%" PRIu64 " %" PRIx64 " %" PRId8 "\n", (uint64_t)UINT64_MAX, (uint64_t)0x1234, (int8_t)-8);
+  check_roundtrip (ring, "%f %.2f %e %g %10.3f %a %G\n", 1.5, 3.14159, 1e-10, 0.1, -2.5, 1.0, 1e20);
+  check_roundtrip (ring, "%*d|%-*d|%.*f|%*.*f\n", 6, 42, 6, 42, 3, 3.14159, 10, 2, 2.71828);
+  check_roundtrip (ring, "%s|%10s|%-10s|%.2s|%s\n", "abc", "right", "left", "truncated", (char *)NULL);
+  check_roundtrip (ring, "%.*s|%.4s|%*.*s\n", 2, not_terminated, not_terminated, 8, 3, not_terminated);
+  check_roundtrip (ring, "%p %p\n", (void *)ring, (void *)NULL);
+  check_roundtrip (ring, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+
+  {
+    // strings are truncated on the binary path
+    log_format_site_t                     site = {.source_file = __FILE__, .line_num = __LINE__};
+    const log_binary_record_header_t     *header = NULL;
+    bstring                               b = bfromcstr ("");
+
+    record (ring, &site, 0, "%s", long_string);
+    header = log_binary_ring_peek (ring);
+    if ((!header) || (BSTR_OK != log_binary_format_args (b, "%s", header)) || (LOG_BINARY_MAX_STRING_LENGTH != blength (b))) {
+      printf ("long string: got %d chars\n", blength (b));
+      nb_errors++;
+    }
+    if (header) log_binary_ring_release (ring, header);
+    bdestroy (b);
+  }
+
+  check_text_only ("%n");
+  check_text_only ("errno %m\n");
+  check_text_only ("%1$d %1$d\n");
+  check_text_only ("%Lf\n");
+  check_text_only ("%ls\n");
+  check_text_only ("%lc\n");
+  check_text_only ("trailing %");
+  check_text_only ("%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n");
+  log_binary_ring_free (ring);
+}
+
+//------------------------------------------------------------------------------
+static void * producer (void *args)
+{
+  log_format_site_t                      *site = (log_format_site_t *)args;
+  char                                    name[64];
+
+  for (uint32_t i = 0; i < nb_records; i++) {
+    snprintf (name, sizeof(name), "%.*s", (int)(i % 40), "0123456789012345678901234567890123456789");
+    record (shared_ring, site, i, "record %u name %s end %lu\n", i, name, (unsigned long)i * 3);
+    // let the consumer run on single core hosts
+    if (0 == (i & 63)) sched_yield ();
+  }
+  __atomic_store_n (&producer_done, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void test_concurrent_ring (void)
+{
+  log_format_site_t                       site = {.source_file = __FILE__, .line_num = __LINE__};
+  const log_binary_record_header_t       *header = NULL;
+  pthread_t                               thread;
+  bstring                                 b = bfromcstr ("");
+  char                                    expected[128];
+  uint64_t                                nb_read = 0;
+  int64_t                                 last = -1;
+  bool                                    done = false;
+
+  shared_ring = log_binary_ring_create (SMALL_RING_SIZE);
+  pthread_create (&thread, NULL, producer, &site);
+  while (!done) {
+    done = __atomic_load_n (&producer_done, __ATOMIC_ACQUIRE);
+    while ((header = log_binary_ring_peek (shared_ring))) {
+      uint64_t i = header->message_number;
+
+      btrunc (b, 0);
+      log_binary_format_args (b, site.format, header);
+      snprintf (expected, sizeof(expected), "record %u name %.*s end %lu\n", (uint32_t)i, (int)(i % 40),
+          "0123456789012345678901234567890123456789", (unsigned long)i * 3);
+      if (((int64_t)i <= last) || (strcmp (expected, (const char *)b->data))) {
+        if (nb_errors < 10) printf ("record %" PRIu64 " after %" PRId64 ": \"%s\"\n", i, last, bdata (b));
+        nb_errors++;
+      }
+      last = i;
+      nb_read++;
+      log_binary_ring_release (shared_ring, header);
+    }
+  }
+  pthread_join (thread, NULL);
+  printf ("concurrent ring: %" PRIu64 " records read, %" PRIu64 " dropped\n", nb_read, shared_ring->dropped);
+  if ((nb_read + shared_ring->dropped) != nb_records) {
+    printf ("concurrent ring: %" PRIu64 " records lost\n", nb_records - nb_read - shared_ring->dropped);
+    nb_errors++;
+  }
+  log_binary_ring_free (shared_ring);
+  bdestroy (b);
+}
+
+//------------------------------------------------------------------------------
+static double now_ns (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void text_message (bstring b, const uint64_t i, const char *format, ...)
+{
+  va_list                                 args;
+
+  log_format_header (b, i, 1, 2, 0x1234, "INFO", "S1AP", "/home/oai/openair-cn/src/s1ap/s1ap_mme_handlers.c", 1234, 0);
+  va_start (args, format);
+  bvcformata (b, 4096, format, args);
+  va_end (args);
+}
+
+//------------------------------------------------------------------------------
+static void benchmark (void)
+{
+  log_format_site_t                       site = {.source_file = __FILE__, .line_num = __LINE__};
+  log_binary_ring_t                      *ring = log_binary_ring_create (LOG_BINARY_RING_SIZE);
+  const log_binary_record_header_t       *header = NULL;
+  bstring                                 b = bfromcstralloc (256, "");
+  const char                             *format = "Received S1AP message for MME_UE_S1AP_ID " "%06" PRIX32 " eNB %s cause %d\n";
+  double                                  t0, text_ns, binary_ns;
+
+  t0 = now_ns ();
+  for (uint32_t i = 0; i < nb_records; i++) {
+    btrunc (b, 0);
+    text_message (b, i, format, i, "enb_name_0001", (int)(i & 7));
+  }
+  text_ns = (now_ns () - t0) / nb_records;
+
+  binary_ns = 0;
+  for (uint32_t i = 0; i < nb_records; i++) {
+    // drain out of the measured time, only the producer cost is of interest here
+    if (0 == (i & 1023)) {
+      binary_ns += now_ns ();
+      while ((header = log_binary_ring_peek (ring))) log_binary_ring_release (ring, header);
+      binary_ns -= now_ns ();
+    }
+    if (0 == i) binary_ns -= now_ns ();
+    record (ring, &site, i, format, i, "enb_name_0001", (int)(i & 7));
+  }
+  binary_ns = (binary_ns + now_ns ()) / nb_records;
+  printf ("producer cost: text %.1f ns/message, binary %.1f ns/message, %" PRIu64 " dropped\n", text_ns, binary_ns, ring->dropped);
+  log_binary_ring_free (ring);
+  bdestroy (b);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  if (argc > 1) nb_records = atoi (argv[1]);
+
+  test_conversions ();
+  test_concurrent_ring ();
+  benchmark ();
+  printf ("%ld errors\n", nb_errors);
+  if (nb_errors) {
+    printf ("FAILED\n");
+    return EXIT_FAILURE;
+  }
+  printf ("OK\n");
+  return EXIT_SUCCESS;
+}
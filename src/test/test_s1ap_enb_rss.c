@@ -0,0 +1,231 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * RSS regression test of the S1AP eNB setup: 10k eNB descriptions are set up the way
+ * s1ap_new_enb() does (ue_coll of S1AP_ENB_UE_COLL_INITIAL_SIZE buckets, UE descriptions
+ * in a shared obj_slab_t), the resident memory growth per idle eNB must stay under
+ * MAX_BYTES_PER_IDLE_ENB. UEs are then attached to every eNB so that the UE tables grow,
+ * looked up, released, and the slab must give its chunks back. For comparison the former
+ * ue_coll sized for max_ues is measured on a few eNBs.
+ * Returns non zero on failure.
+ *
+ * usage: test_s1ap_enb_rss [nb_enbs] [nb_ues_per_enb] [max_ues]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bstrlib.h"
+#include "hashtable.h"
+#include "obj_slab.h"
+#include "mme_default_values.h"
+#include "s1ap_mme_tai_index.h"
+
+#define NB_OF_ENBS               10000
+#define NB_OF_UES_PER_ENB        40
+#define MAX_UES                  8192        // a small MME, the former per eNB ue_coll size
+#define NB_OF_LEGACY_ENBS        100
+#define MAX_BYTES_PER_IDLE_ENB   1024
+
+// Same sizes as enb_description_t / ue_description_t (s1ap_mme.h)
+typedef struct test_enb_s {
+  int                                     s1_state;
+  char                                    enb_name[150];
+  uint32_t                                enb_id;
+  uint8_t                                 default_paging_drx;
+  uint32_t                                nb_ue_associated;
+  hash_table_ts_t                         ue_coll;
+  uint32_t                                sctp_assoc_id;
+  uint16_t                                next_sctp_stream;
+  uint16_t                                instreams;
+  uint16_t                                outstreams;
+  s1ap_tai_index_enb_t                    tai_index;
+} test_enb_t;
+
+typedef struct test_ue_s {
+  test_enb_t                             *enb;
+  int                                     s1_ue_state;
+  int                                     s1_release_cause;
+  uint32_t                                enb_ue_s1ap_id:24;
+  uint32_t                                mme_ue_s1ap_id;
+  uint16_t                                sctp_stream_recv;
+  uint16_t                                sctp_stream_send;
+  uint32_t                                s11_sgw_teid;
+  long                                    outcome_response_timer_id;
+  long                                    timers[4];
+} test_ue_t;
+
+static obj_slab_t                        *ue_slab = NULL;
+
+//------------------------------------------------------------------------------
+static long rss_bytes (void)
+{
+  FILE                                   *f = fopen ("/proc/self/statm", "r");
+  long                                    size = 0, resident = 0;
+
+  if (!f) {
+    return -1;
+  }
+  if (2 != fscanf (f, "%ld %ld", &size, &resident)) {
+    resident = -1;
+  }
+  fclose (f);
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+//------------------------------------------------------------------------------
+static void free_ue (void **ue)
+{
+  obj_slab_free (ue_slab, *ue);
+  *ue = NULL;
+}
+
+//------------------------------------------------------------------------------
+static test_enb_t *new_enb (const uint32_t assoc_id, const hash_size_t ue_coll_size)
+{
+  test_enb_t                             *enb = calloc (1, sizeof (test_enb_t));
+  bstring                                 bs = bfromcstr ("s1ap_ue_coll");
+
+  enb->sctp_assoc_id = assoc_id;
+  hashtable_ts_init (&enb->ue_coll, ue_coll_size, NULL, free_ue, bs);
+  bdestroy (bs);
+  return enb;
+}
+
+//------------------------------------------------------------------------------
+static void remove_enb (test_enb_t * const enb)
+{
+  hashtable_ts_destroy (&enb->ue_coll);
+  free (enb);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  uint32_t                                nb_enbs = NB_OF_ENBS;
+  uint32_t                                nb_ues_per_enb = NB_OF_UES_PER_ENB;
+  uint32_t                                max_ues = MAX_UES;
+  test_enb_t                            **enbs = NULL;
+  long                                    rss_start, rss_idle, rss_legacy;
+  double                                  per_idle_enb, per_legacy_enb;
+  bstring                                 bs = bfromcstr ("s1ap_ue_slab");
+  int                                     nb_errors = 0;
+
+  if (argc > 1) {
+    nb_enbs = atoi (argv[1]);
+  }
+  if (argc > 2) {
+    nb_ues_per_enb = atoi (argv[2]);
+  }
+  if (argc > 3) {
+    max_ues = atoi (argv[3]);
+  }
+  if ((!nb_enbs) || (!(enbs = calloc (nb_enbs, sizeof (test_enb_t *))))) {
+    return EXIT_FAILURE;
+  }
+  ue_slab = obj_slab_create (sizeof (test_ue_t), S1AP_UE_SLAB_CHUNK_UES, bs);
+  bdestroy (bs);
+
+  // Idle eNBs
+  rss_start = rss_bytes ();
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    enbs[e] = new_enb (e + 1, S1AP_ENB_UE_COLL_INITIAL_SIZE);
+  }
+  rss_idle = rss_bytes ();
+  per_idle_enb = (double)(rss_idle - rss_start) / nb_enbs;
+  fprintf (stdout, "%u idle eNBs: RSS +%ld kB, %.0f bytes per eNB (limit %d)\n", nb_enbs, (rss_idle - rss_start) / 1024, per_idle_enb, MAX_BYTES_PER_IDLE_ENB);
+  if (per_idle_enb > MAX_BYTES_PER_IDLE_ENB) {
+    fprintf (stderr, "RSS per idle eNB %.0f bytes exceeds %d bytes\n", per_idle_enb, MAX_BYTES_PER_IDLE_ENB);
+    nb_errors++;
+  }
+
+  // UEs attach, the UE tables grow with the UE count of their eNB
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    for (uint32_t u = 0; u < nb_ues_per_enb; u++) {
+      test_ue_t                          *ue = obj_slab_alloc (ue_slab);
+
+      ue->enb = enbs[e];
+      ue->enb_ue_s1ap_id = u;
+      ue->mme_ue_s1ap_id = e * nb_ues_per_enb + u;
+      if (HASH_TABLE_OK != hashtable_ts_insert (&enbs[e]->ue_coll, (const hash_key_t) u, ue)) {
+        nb_errors++;
+      }
+      enbs[e]->nb_ue_associated++;
+    }
+  }
+  fprintf (stdout, "%u UEs attached: RSS +%ld kB, UE slab %zu kB in chunks of %zu bytes\n",
+           nb_enbs * nb_ues_per_enb, (rss_bytes () - rss_start) / 1024, obj_slab_memory (ue_slab) / 1024, ue_slab->chunk_size);
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    for (uint32_t u = 0; u < nb_ues_per_enb; u++) {
+      test_ue_t                          *ue = NULL;
+
+      if ((HASH_TABLE_OK != hashtable_ts_get (&enbs[e]->ue_coll, (const hash_key_t) u, (void **)&ue)) ||
+          (ue->enb != enbs[e]) || (ue->mme_ue_s1ap_id != e * nb_ues_per_enb + u)) {
+        fprintf (stderr, "UE %u of eNB %u not found\n", u, e);
+        nb_errors++;
+      }
+    }
+    if ((nb_ues_per_enb > S1AP_ENB_UE_COLL_INITIAL_SIZE * HASHTABLE_MAX_LOAD_FACTOR) && (enbs[e]->ue_coll.size <= S1AP_ENB_UE_COLL_INITIAL_SIZE)) {
+      fprintf (stderr, "UE table of eNB %u did not grow\n", e);
+      nb_errors++;
+    }
+  }
+
+  // UEs release, the slab keeps at most one spare chunk
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    for (uint32_t u = 0; u < nb_ues_per_enb; u++) {
+      hashtable_ts_free (&enbs[e]->ue_coll, (const hash_key_t) u);
+      enbs[e]->nb_ue_associated--;
+    }
+  }
+  fprintf (stdout, "UEs released: UE slab %zu kB, %"PRIu64" objects\n", obj_slab_memory (ue_slab) / 1024, ue_slab->num_objs);
+  if ((ue_slab->num_objs) || (ue_slab->num_chunks > 1)) {
+    fprintf (stderr, "UE slab holds %"PRIu64" objects in %"PRIu64" chunks after release\n", ue_slab->num_objs, ue_slab->num_chunks);
+    nb_errors++;
+  }
+  for (uint32_t e = 0; e < nb_enbs; e++) {
+    remove_enb (enbs[e]);
+  }
+
+  // Former sizing, a few eNBs are enough
+  rss_start = rss_bytes ();
+  for (uint32_t e = 0; e < NB_OF_LEGACY_ENBS; e++) {
+    enbs[e] = new_enb (e + 1, max_ues);
+  }
+  rss_legacy = rss_bytes ();
+  per_legacy_enb = (double)(rss_legacy - rss_start) / NB_OF_LEGACY_ENBS;
+  fprintf (stdout, "%d eNBs with ue_coll sized for max_ues %u: %.0f bytes per eNB, %.1f MB for %u eNBs\n",
+           NB_OF_LEGACY_ENBS, max_ues, per_legacy_enb, per_legacy_enb * nb_enbs / (1024 * 1024), nb_enbs);
+  for (uint32_t e = 0; e < NB_OF_LEGACY_ENBS; e++) {
+    remove_enb (enbs[e]);
+  }
+
+  obj_slab_destroy (ue_slab);
+  free (enbs);
+  fprintf (stdout, "%s\n", (nb_errors) ? "FAILED" : "PASSED");
+  return (nb_errors) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,261 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*
+ * TEID pool (utils/teid_pool.c):
+ *   - TEID layout: node id in the MSB, never 0, foreign, unknown or already released TEIDs are rejected,
+ *   - quarantine: a released TEID is not reused before quarantine_ms, then it is,
+ *   - exhaustion of a pool with 8 node id bits and 64 shards (2^24 - 64 TEIDs),
+ *   - nb_threads threads allocating and releasing at random, each one keeping up to MAX_HELD TEIDs, with and
+ *     without quarantine: a TEID is never held by two threads at once and is never reused before its quarantine.
+ * Allocation + release rates are reported for the concurrent part.
+ * Returns non zero on the first violation.
+ *
+ * usage: test_teid_pool_stress [nb_threads [ops_per_thread]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common_defs.h"
+#include "teid_pool.h"
+
+#define NB_OF_THREADS             8
+#define OPS_PER_THREAD            1000000
+#define MAX_HELD                  1024
+#define NB_OF_SHARDS              4
+#define STRESS_QUARANTINE_MS      5
+#define SLOT_INDEX_BITS           20     // TEID index bound in the stress part: threads * MAX_HELD + TEIDs in quarantine
+
+typedef struct stress_s {
+  teid_pool_t                            *pool;
+  uint8_t                                *held;            // per TEID, 1 while held by a thread
+  uint64_t                               *released_ms;     // per TEID, date of its last release
+  uint32_t                                ops;
+  uint32_t                                quarantine_ms;
+  uint64_t                                seed;
+  volatile int                           *failed;
+} stress_t;
+
+static uint64_t clock_ms (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static double elapsed_sec (const struct timespec * const start)
+{
+  struct timespec                         now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static uint64_t rand64 (uint64_t * const state)
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ULL;
+}
+
+// slot of a TEID of a pool without node id: shard in the 2 MSB, index in the LSB
+static int64_t teid2slot (const uint32_t teid)
+{
+  const uint32_t                          index = teid & ((1U << 30) - 1);
+
+  if (index >= (1U << SLOT_INDEX_BITS)) {
+    return -1;
+  }
+  return ((int64_t)(teid >> 30) << SLOT_INDEX_BITS) | index;
+}
+
+#define STRESS_FAIL(...) do { fprintf (stderr, "FAILED: " __VA_ARGS__); fprintf (stderr, "\n"); *s->failed = 1; return NULL; } while (0)
+
+static void *stress_thread (void *arg)
+{
+  stress_t                               *s = (stress_t *)arg;
+  uint32_t                                held[MAX_HELD];
+  int                                     nb_held = 0;
+
+  for (uint32_t n = 0; (n < s->ops) && (!*s->failed); n++) {
+    const uint64_t                          r = rand64 (&s->seed);
+
+    if ((nb_held < MAX_HELD) && ((0 == nb_held) || (r & 1))) {
+      const uint32_t                          teid = teid_pool_alloc (s->pool, TEID_POOL_ANY_SHARD);
+      const int64_t                           slot = teid2slot (teid);
+
+      if ((TEID_POOL_INVALID_TEID == teid) || (0 > slot)) {
+        STRESS_FAIL ("alloc returned 0x%08x", teid);
+      }
+      if (__sync_lock_test_and_set (&s->held[slot], 1)) {
+        STRESS_FAIL ("TEID 0x%08x allocated twice", teid);
+      }
+      if (s->quarantine_ms) {
+        const uint64_t                          released_ms = __atomic_load_n (&s->released_ms[slot], __ATOMIC_ACQUIRE);
+
+        // the pool counts whole ms
+        if ((released_ms) && (clock_ms () - released_ms + 1 < s->quarantine_ms)) {
+          STRESS_FAIL ("TEID 0x%08x reused %"PRIu64" ms after its release", teid, clock_ms () - released_ms);
+        }
+      }
+      held[nb_held++] = teid;
+    } else {
+      const int                               i = (int)((r >> 1) % nb_held);
+      const uint32_t                          teid = held[i];
+      const int64_t                           slot = teid2slot (teid);
+
+      held[i] = held[--nb_held];
+      // before the release, the TEID may be allocated by another thread right after it
+      __atomic_store_n (&s->released_ms[slot], clock_ms (), __ATOMIC_RELEASE);
+      __sync_lock_release (&s->held[slot]);
+      if (RETURNok != teid_pool_release (s->pool, teid)) {
+        STRESS_FAIL ("release 0x%08x", teid);
+      }
+    }
+  }
+  while (nb_held) {
+    const uint32_t                          teid = held[--nb_held];
+
+    __sync_lock_release (&s->held[teid2slot (teid)]);
+    if (RETURNok != teid_pool_release (s->pool, teid)) {
+      STRESS_FAIL ("final release 0x%08x", teid);
+    }
+  }
+  return NULL;
+}
+
+static int stress (const int nb_threads, const uint32_t ops, const uint32_t quarantine_ms)
+{
+  const size_t                            nb_slots = (size_t)NB_OF_SHARDS << SLOT_INDEX_BITS;
+  pthread_t                              *threads = calloc (nb_threads, sizeof (pthread_t));
+  stress_t                               *args = calloc (nb_threads, sizeof (stress_t));
+  uint8_t                                *held = calloc (nb_slots, sizeof (uint8_t));
+  uint64_t                               *released_ms = calloc (nb_slots, sizeof (uint64_t));
+  teid_pool_t                            *pool = teid_pool_create (NB_OF_SHARDS, 0, 0, quarantine_ms);
+  volatile int                            failed = 0;
+  struct timespec                         start;
+  double                                  t = 0;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < nb_threads; i++) {
+    args[i].pool = pool;
+    args[i].held = held;
+    args[i].released_ms = released_ms;
+    args[i].ops = ops;
+    args[i].quarantine_ms = quarantine_ms;
+    args[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+    args[i].failed = &failed;
+    pthread_create (&threads[i], NULL, stress_thread, &args[i]);
+  }
+  for (int i = 0; i < nb_threads; i++) {
+    pthread_join (threads[i], NULL);
+  }
+  t = elapsed_sec (&start);
+  printf ("stress:        %d threads, quarantine %u ms, %u ops in %.3f s, %.0f ops/s\n",
+      nb_threads, quarantine_ms, nb_threads * ops, t, nb_threads * ops / t);
+  if ((!failed) && (teid_pool_num_allocated (pool))) {
+    fprintf (stderr, "FAILED: %u TEIDs still allocated\n", teid_pool_num_allocated (pool));
+    failed = 1;
+  }
+  teid_pool_destroy (pool);
+  free (threads);
+  free (args);
+  free (held);
+  free (released_ms);
+  return failed;
+}
+
+#define CHECK(cOnD, ...) do { if (!(cOnD)) { fprintf (stderr, "FAILED line %d: ", __LINE__); fprintf (stderr, __VA_ARGS__); fprintf (stderr, "\n"); return 1; } } while (0)
+
+int main (int argc, char *argv[])
+{
+  const int                               nb_threads = (argc > 1) ? atoi (argv[1]) : NB_OF_THREADS;
+  const uint32_t                          ops = (argc > 2) ? (uint32_t)atoi (argv[2]) : OPS_PER_THREAD;
+  teid_pool_t                            *pool = NULL;
+  uint32_t                                teid = 0, teid2 = 0;
+  uint32_t                                n = 0;
+  struct timespec                         start;
+
+  // bad parameters
+  CHECK (NULL == teid_pool_create (0, 0, 0, 0), "0 shard");
+  CHECK (NULL == teid_pool_create (65, 0, 0, 0), "65 shards");
+  CHECK (NULL == teid_pool_create (1, 16, 4, 0), "node id wider than its bits");
+  CHECK (NULL == teid_pool_create (1, 0, 9, 0), "9 node id bits");
+
+  // layout
+  pool = teid_pool_create (3, 5, 4, 0);
+  CHECK (pool, "create");
+  CHECK (4 == pool->num_shards, "%d shards", pool->num_shards);
+  for (int i = 0; i < 1000; i++) {
+    teid = teid_pool_alloc (pool, i);
+    CHECK ((teid) && (5 == teid >> 28), "TEID 0x%08x", teid);
+    CHECK (((uint32_t)(i % 4)) == ((teid >> 26) & 3), "TEID 0x%08x not in shard %d", teid, i % 4);
+    CHECK (teid_pool_is_allocated (pool, teid), "not allocated");
+  }
+  CHECK (1000 == teid_pool_num_allocated (pool), "count");
+  CHECK (RETURNok == teid_pool_release (pool, teid), "release");
+  CHECK (RETURNerror == teid_pool_release (pool, teid), "double release");
+  CHECK (RETURNerror == teid_pool_release (pool, teid ^ 0x10000000), "foreign node id");
+  CHECK (RETURNerror == teid_pool_release (pool, 0), "TEID 0");
+  CHECK (RETURNerror == teid_pool_release (pool, (5U << 28) | 0x3ffffff), "never allocated");
+  teid_pool_destroy (pool);
+
+  // quarantine
+  pool = teid_pool_create (1, 0, 0, 200);
+  teid = teid_pool_alloc (pool, 0);
+  CHECK (RETURNok == teid_pool_release (pool, teid), "release");
+  teid2 = teid_pool_alloc (pool, 0);
+  CHECK (teid2 != teid, "reused during quarantine");
+  usleep (250000);
+  teid2 = teid_pool_alloc (pool, 0);
+  CHECK (teid2 == teid, "0x%08x not reused after quarantine, got 0x%08x", teid, teid2);
+  teid_pool_destroy (pool);
+
+  // exhaustion: 64 shards of 2^18 - 1 TEIDs
+  pool = teid_pool_create (64, 255, 8, 0);
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  while (TEID_POOL_INVALID_TEID != (teid = teid_pool_alloc (pool, (int)n))) {
+    n++;
+    teid2 = teid;
+  }
+  printf ("exhaustion:    %u TEIDs in %.3f s\n", n, elapsed_sec (&start));
+  CHECK (64 * ((1U << 18) - 1) == n, "%u TEIDs", n);
+  CHECK (RETURNok == teid_pool_release (pool, teid2), "release");
+  CHECK (teid2 == teid_pool_alloc (pool, 7), "not reused from another shard");
+  CHECK (TEID_POOL_INVALID_TEID == teid_pool_alloc (pool, TEID_POOL_ANY_SHARD), "not exhausted");
+  teid_pool_destroy (pool);
+
+  if (stress (nb_threads, ops, 0) || stress (nb_threads, ops, STRESS_QUARANTINE_MS)) {
+    return 1;
+  }
+  printf ("PASSED\n");
+  return 0;
+}
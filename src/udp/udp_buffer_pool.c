@@ -0,0 +1,132 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_buffer_pool.c
+  \brief Pool of fixed size receive buffers handed over with UDP_DATA_IND messages.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "bstrlib.h"
+
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "udp_buffer_pool.h"
+
+// keeps the payload 16 bytes aligned
+#define UDP_BUFFER_HEADER_SIZE  ((sizeof (udp_buffer_header_t) + 15) & ~((size_t)15))
+
+//------------------------------------------------------------------------------
+static inline udp_buffer_header_t *udp_buffer_get_header (uint8_t * const buffer)
+{
+  return (udp_buffer_header_t *)(buffer - UDP_BUFFER_HEADER_SIZE);
+}
+
+//------------------------------------------------------------------------------
+udp_buffer_pool_t *udp_buffer_pool_create (const uint32_t nb_buffers, const uint32_t buffer_size)
+{
+  udp_buffer_pool_t                      *pool = NULL;
+  const size_t                            stride = UDP_BUFFER_HEADER_SIZE + ((buffer_size + 15) & ~((size_t)15));
+
+  if ((pool = calloc (1, sizeof (udp_buffer_pool_t))) == NULL) {
+    return NULL;
+  }
+  pool->buffer_size = buffer_size;
+  pool->nb_buffers = nb_buffers;
+  if ((nb_buffers) && (posix_memalign ((void **)&pool->memory, 64, stride * nb_buffers))) {
+    free_wrapper ((void**)&pool);
+    return NULL;
+  }
+  // first buffers on top of the free list
+  for (uint32_t i = nb_buffers; i > 0; i--) {
+    udp_buffer_header_t                    *header = (udp_buffer_header_t *)&pool->memory[stride * (i - 1)];
+
+    header->pool = pool;
+    header->next = pool->local_free;
+    pool->local_free = header;
+  }
+  return pool;
+}
+
+//------------------------------------------------------------------------------
+void udp_buffer_pool_destroy (udp_buffer_pool_t ** const pool)
+{
+  if ((pool) && (*pool)) {
+    free_wrapper ((void**)&(*pool)->memory);
+    free_wrapper ((void**)pool);
+  }
+}
+
+//------------------------------------------------------------------------------
+uint8_t *udp_buffer_alloc (udp_buffer_pool_t * const pool)
+{
+  udp_buffer_header_t                    *header = pool->local_free;
+
+  if (header == NULL) {
+    // take back all the buffers released since the last time
+    header = __atomic_exchange_n (&pool->returned, NULL, __ATOMIC_ACQUIRE);
+  }
+  if (header) {
+    pool->local_free = header->next;
+    __atomic_store_n (&pool->nb_allocs, pool->nb_allocs + 1, __ATOMIC_RELAXED);
+    return (uint8_t *)header + UDP_BUFFER_HEADER_SIZE;
+  }
+
+  header = malloc (UDP_BUFFER_HEADER_SIZE + pool->buffer_size);
+  AssertFatal (header != NULL, "Memory allocation of %u bytes failed\n", pool->buffer_size);
+  header->pool = NULL;
+  __atomic_store_n (&pool->nb_heap_allocs, pool->nb_heap_allocs + 1, __ATOMIC_RELAXED);
+  return (uint8_t *)header + UDP_BUFFER_HEADER_SIZE;
+}
+
+//------------------------------------------------------------------------------
+void udp_buffer_free (uint8_t ** const buffer)
+{
+  if ((buffer) && (*buffer)) {
+    udp_buffer_header_t                    *header = udp_buffer_get_header (*buffer);
+    udp_buffer_pool_t                      *pool = header->pool;
+
+    *buffer = NULL;
+    if (pool == NULL) {
+      free_wrapper ((void**)&header);
+      return;
+    }
+    // push only: no ABA, the single consumer takes the whole stack
+    header->next = __atomic_load_n (&pool->returned, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n (&pool->returned, &header->next, header, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_add_fetch (&pool->nb_frees, 1, __ATOMIC_RELAXED);
+  }
+}
+
+//------------------------------------------------------------------------------
+void udp_buffer_pool_get_stats (udp_buffer_pool_t * const pool, udp_buffer_pool_stats_t * const stats)
+{
+  memset (stats, 0, sizeof (*stats));
+  if (pool) {
+    stats->nb_buffers = pool->nb_buffers;
+    stats->nb_allocs = __atomic_load_n (&pool->nb_allocs, __ATOMIC_RELAXED);
+    stats->nb_heap_allocs = __atomic_load_n (&pool->nb_heap_allocs, __ATOMIC_RELAXED);
+    stats->nb_frees = __atomic_load_n (&pool->nb_frees, __ATOMIC_RELAXED);
+  }
+}
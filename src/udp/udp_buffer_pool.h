@@ -0,0 +1,76 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file udp_buffer_pool.h
+  \brief Pool of fixed size receive buffers handed over with UDP_DATA_IND messages.
+
+  Buffers are allocated by a single thread (the UDP task) and released by any
+  thread (the task consuming the UDP_DATA_IND). Released buffers are pushed on a
+  lock-free stack, the allocating thread takes the whole stack back at once when
+  its private free list is empty, so neither side ever locks. When the pool is
+  exhausted buffers are taken from the heap, udp_buffer_free() handles both.
+*/
+
+#ifndef FILE_UDP_BUFFER_POOL_SEEN
+#define FILE_UDP_BUFFER_POOL_SEEN
+
+#include <stdint.h>
+
+typedef struct udp_buffer_header_s {
+  struct udp_buffer_header_s   *next;
+  struct udp_buffer_pool_s     *pool;     // NULL for a heap buffer
+} udp_buffer_header_t;
+
+typedef struct udp_buffer_pool_s {
+  uint32_t                      buffer_size;
+  uint32_t                      nb_buffers;
+  uint8_t                      *memory;
+  udp_buffer_header_t          *local_free;   // allocating thread only
+  uint64_t                      nb_allocs;
+  uint64_t                      nb_heap_allocs;
+  udp_buffer_header_t          *returned __attribute__((aligned(64)));  // pushed by any thread
+  uint64_t                      nb_frees;
+} udp_buffer_pool_t;
+
+typedef struct udp_buffer_pool_stats_s {
+  uint32_t                      nb_buffers;
+  uint64_t                      nb_allocs;       // from the pool
+  uint64_t                      nb_heap_allocs;  // pool exhausted
+  uint64_t                      nb_frees;        // back to the pool
+} udp_buffer_pool_stats_t;
+
+/** \brief Creates a pool of nb_buffers buffers of buffer_size bytes, allocated in one block.
+ * @returns The pool or NULL.
+ **/
+udp_buffer_pool_t *udp_buffer_pool_create (const uint32_t nb_buffers, const uint32_t buffer_size);
+
+/** \brief Frees the pool, no buffer of the pool may be in use anymore. **/
+void               udp_buffer_pool_destroy (udp_buffer_pool_t ** const pool);
+
+/** \brief Returns a buffer of the pool buffer size, never NULL. Must always be called by the same thread. **/
+uint8_t           *udp_buffer_alloc (udp_buffer_pool_t * const pool) __attribute__ ((hot));
+
+/** \brief Releases a buffer returned by udp_buffer_alloc(), from any thread, and sets *buffer to NULL. **/
+void               udp_buffer_free (uint8_t ** const buffer) __attribute__ ((hot));
+
+void               udp_buffer_pool_get_stats (udp_buffer_pool_t * const pool, udp_buffer_pool_stats_t * const stats);
+
+#endif /* FILE_UDP_BUFFER_POOL_SEEN */
@@ -26,6 +26,7 @@
   \email: lionel.gauthier@eurecom.fr
 */
 
+#define _GNU_SOURCE             // required for recvmmsg(), sendmmsg()
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -49,13 +50,24 @@
 #include "conversions.h"
 #include "intertask_interface.h"
 #include "udp_primitives_server.h"
+#include "udp_buffer_pool.h"
 #include "itti_free_defined_msg.h"
 
+#define UDP_BUFFER_SIZE                  4096   /* max datagram size, larger ones are dropped */
+#define UDP_BUFFER_POOL_SIZE             2048   /* receive buffers in flight before falling back on the heap */
+#define UDP_RECV_BATCH                   32     /* datagrams per recvmmsg() */
+#define UDP_RECV_MAX_BATCHES_PER_EVENT   4      /* then serve the ITTI queue again */
+#define UDP_SEND_BATCH                   32     /* UDP_DATA_REQ per sendmmsg() */
+#define UDP_MAX_QUEUED_MSGS_PER_WAKEUP   64     /* then read the sockets again */
 
 struct udp_socket_desc_s {
-  uint8_t                                 buffer[4096];
   int                                     sd;   /* Socket descriptor to use */
 
+  /* recvmmsg() vectors, iov_base are pool buffers owned by the socket until a datagram is received in them */
+  struct mmsghdr                          msgs[UDP_RECV_BATCH];
+  struct iovec                            iovs[UDP_RECV_BATCH];
+  struct sockaddr_in                      addrs[UDP_RECV_BATCH];
+
   pthread_t                               listener_thread;      /* Thread affected to recv */
 
   struct in_addr                          local_address;        /* Local ipv4 address to use */
@@ -73,6 +85,20 @@ STAILQ_HEAD (
   udp_socket_desc_s) udp_socket_list;
      static pthread_mutex_t                  udp_socket_list_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Receive buffers, allocated by TASK_UDP only, released by the tasks consuming UDP_DATA_IND */
+static udp_buffer_pool_t               *udp_buffer_pool = NULL;
+static bool                             udp_use_mmsg = true;
+
+/* UDP_DATA_REQ messages waiting for sendmmsg(), their buffers are referenced until sent */
+typedef struct udp_send_batch_s {
+  int                                     sd;
+  int                                     nb_msgs;
+  MessageDef                             *messages[UDP_SEND_BATCH];
+  struct mmsghdr                          msgs[UDP_SEND_BATCH];
+  struct iovec                            iovs[UDP_SEND_BATCH];
+  struct sockaddr_in                      addrs[UDP_SEND_BATCH];
+} udp_send_batch_t;
+
 
 static void                             udp_server_receive_and_process (
   struct udp_socket_desc_s *udp_sock_pP);
@@ -173,6 +199,13 @@ udp_server_create_socket (
   socket_desc_p->local_address.s_addr = address->s_addr;
   socket_desc_p->local_port = port;
   socket_desc_p->task_id = task_id;
+  for (int i = 0; i < UDP_RECV_BATCH; i++) {
+    socket_desc_p->iovs[i].iov_base = NULL;
+    socket_desc_p->iovs[i].iov_len = UDP_BUFFER_SIZE;
+    socket_desc_p->msgs[i].msg_hdr.msg_iov = &socket_desc_p->iovs[i];
+    socket_desc_p->msgs[i].msg_hdr.msg_iovlen = 1;
+    socket_desc_p->msgs[i].msg_hdr.msg_name = &socket_desc_p->addrs[i];
+  }
   OAILOG_DEBUG (LOG_UDP, "Inserting new descriptor for task %d, sd %d\n", socket_desc_p->task_id, socket_desc_p->sd);
   pthread_mutex_lock (&udp_socket_list_mutex);
   STAILQ_INSERT_TAIL (&udp_socket_list, socket_desc_p, entries);
@@ -210,51 +243,192 @@ udp_server_flush_sockets (
   }
 }
 
+//------------------------------------------------------------------------------
+// Reads all the sockets without waiting for their events, the ITTI queue was not drained.
+static void
+udp_server_receive_all_sockets (
+  void)
+{
+  struct udp_socket_desc_s               *udp_sock_p = NULL;
+
+  pthread_mutex_lock (&udp_socket_list_mutex);
+  STAILQ_FOREACH (udp_sock_p, &udp_socket_list, entries) {
+    udp_server_receive_and_process (udp_sock_p);
+  }
+  pthread_mutex_unlock (&udp_socket_list_mutex);
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of datagrams received in the socket vectors, or -1 (errno set).
+static int
+udp_server_recv_batch (
+  struct udp_socket_desc_s *udp_sock_pP)
+{
+  for (int i = 0; i < UDP_RECV_BATCH; i++) {
+    if (udp_sock_pP->iovs[i].iov_base == NULL) {
+      udp_sock_pP->iovs[i].iov_base = udp_buffer_alloc (udp_buffer_pool);
+    }
+    udp_sock_pP->msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+    udp_sock_pP->msgs[i].msg_hdr.msg_flags = 0;
+    udp_sock_pP->msgs[i].msg_len = 0;
+  }
+
+  if (udp_use_mmsg) {
+    int                                     n = recvmmsg (udp_sock_pP->sd, udp_sock_pP->msgs, UDP_RECV_BATCH, MSG_DONTWAIT, NULL);
+
+    if ((0 <= n) || (ENOSYS != errno)) {
+      return n;
+    }
+    OAILOG_WARNING (LOG_UDP, "recvmmsg()/sendmmsg() not supported, falling back on recvfrom()/sendto()\n");
+    udp_use_mmsg = false;
+  }
+
+  ssize_t                                 bytes_received = recvmsg (udp_sock_pP->sd, &udp_sock_pP->msgs[0].msg_hdr, MSG_DONTWAIT);
+
+  if (bytes_received < 0) {
+    return -1;
+  }
+  udp_sock_pP->msgs[0].msg_len = (unsigned int)bytes_received;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
 static void
 udp_server_receive_and_process (
   struct udp_socket_desc_s *udp_sock_pP)
 {
-  OAILOG_DEBUG (LOG_UDP, "Inserting new descriptor for task %d, sd %d\n", udp_sock_pP->task_id, udp_sock_pP->sd);
-  {
-    int                                     bytes_received = 0;
-    socklen_t                               from_len;
-    struct sockaddr_in                      addr;
+  OAILOG_DEBUG (LOG_UDP, "Receiving on descriptor for task %d, sd %d\n", udp_sock_pP->task_id, udp_sock_pP->sd);
 
-    from_len = (socklen_t) sizeof (struct sockaddr_in);
+  for (int batch = 0; batch < UDP_RECV_MAX_BATCHES_PER_EVENT; batch++) {
+    int                                     nb_msgs = udp_server_recv_batch (udp_sock_pP);
 
-    if ((bytes_received = recvfrom (udp_sock_pP->sd, udp_sock_pP->buffer, sizeof (udp_sock_pP->buffer), 0, (struct sockaddr *)&addr, &from_len)) <= 0) {
-      OAILOG_ERROR (LOG_UDP, "Recvfrom failed %s\n", strerror (errno));
-      //break;
-    } else {
+    if (nb_msgs < 0) {
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)) {
+        OAILOG_ERROR (LOG_UDP, "Recvfrom failed %s\n", strerror (errno));
+      }
+      return;
+    }
+
+    for (int i = 0; i < nb_msgs; i++) {
       MessageDef                             *message_p = NULL;
       udp_data_ind_t                         *udp_data_ind_p;
-      uint8_t                                *forwarded_buffer = NULL;
+      struct sockaddr_in                     *addr = &udp_sock_pP->addrs[i];
 
-      AssertFatal (sizeof (udp_sock_pP->buffer) >= bytes_received, "UDP BUFFER OVERFLOW");
-      forwarded_buffer = itti_malloc (TASK_UDP, udp_sock_pP->task_id, bytes_received);
-      DevAssert (forwarded_buffer != NULL);
-      memcpy (forwarded_buffer, udp_sock_pP->buffer, bytes_received);
+      if (udp_sock_pP->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+        OAILOG_ERROR (LOG_UDP, "UDP BUFFER OVERFLOW, datagram from %s:%u dropped\n", inet_ntoa (addr->sin_addr), ntohs (addr->sin_port));
+        continue;
+      }
       message_p = itti_alloc_new_message (TASK_UDP, UDP_DATA_IND);
       DevAssert (message_p != NULL);
       udp_data_ind_p = &message_p->ittiMsg.udp_data_ind;
-      udp_data_ind_p->buffer = forwarded_buffer;
-      udp_data_ind_p->buffer_length = bytes_received;
-      udp_data_ind_p->peer_port = htons (addr.sin_port);
-      udp_data_ind_p->peer_address = addr.sin_addr;
-      OAILOG_DEBUG (LOG_UDP, "Msg of length %d received from %s:%u\n", bytes_received, inet_ntoa (addr.sin_addr), ntohs (addr.sin_port));
+      // no copy: the pool buffer goes with the message, released by itti_free_msg_content()
+      udp_data_ind_p->buffer = udp_sock_pP->iovs[i].iov_base;
+      udp_sock_pP->iovs[i].iov_base = NULL;
+      udp_data_ind_p->buffer_length = udp_sock_pP->msgs[i].msg_len;
+      udp_data_ind_p->peer_port = htons (addr->sin_port);
+      udp_data_ind_p->peer_address = addr->sin_addr;
+      OAILOG_DEBUG (LOG_UDP, "Msg of length %d received from %s:%u\n", udp_data_ind_p->buffer_length, inet_ntoa (addr->sin_addr), ntohs (addr->sin_port));
 
       if (itti_send_msg_to_task (udp_sock_pP->task_id, INSTANCE_DEFAULT, message_p) < 0) {
         OAILOG_DEBUG (LOG_UDP, "Failed to send message %d to task %d\n", UDP_DATA_IND, udp_sock_pP->task_id);
-        //break;
       }
     }
+
+    if (nb_msgs < UDP_RECV_BATCH) {
+      return;
+    }
   }
-  //close(udp_sock_pP->sd);
-  //udp_sock_pP->sd = -1;
-  //pthread_mutex_lock(&udp_socket_list_mutex);
-  //STAILQ_REMOVE(&udp_socket_list, udp_sock_pP, udp_socket_desc_s, entries);
-  //pthread_mutex_unlock(&udp_socket_list_mutex);
-  //return NULL;
+  // still readable, will be reported again by the next itti_get_events()
+}
+
+//------------------------------------------------------------------------------
+static void
+udp_server_flush_send_batch (
+  udp_send_batch_t * const batch)
+{
+  int                                     sent = 0;
+
+  while (sent < batch->nb_msgs) {
+    int                                     n = 0;
+
+    if (udp_use_mmsg) {
+      n = sendmmsg (batch->sd, &batch->msgs[sent], batch->nb_msgs - sent, 0);
+    } else {
+      n = (sendmsg (batch->sd, &batch->msgs[sent].msg_hdr, 0) < 0) ? -1 : 1;
+    }
+
+    if (n < 0) {
+      if ((ENOSYS == errno) && (udp_use_mmsg)) {
+        udp_use_mmsg = false;
+        continue;
+      }
+      // this datagram is lost, go on with the next ones
+      OAILOG_ERROR (LOG_UDP, "There was an error while writing to socket " "(%d:%s)\n", errno, strerror (errno));
+      n = 1;
+    }
+    sent += n;
+  }
+
+  // no free udp_data_req_p->buffer, statically allocated
+  for (int i = 0; i < batch->nb_msgs; i++) {
+    int                                     rc = 0;
+
+    itti_free_msg_content (batch->messages[i]);
+    rc = itti_free (ITTI_MSG_ORIGIN_ID (batch->messages[i]), batch->messages[i]);
+    AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
+    batch->messages[i] = NULL;
+  }
+  batch->nb_msgs = 0;
+}
+
+//------------------------------------------------------------------------------
+// Queues the message for sendmmsg(), returns false if it cannot be sent (message not consumed).
+static bool
+udp_server_queue_data_req (
+  udp_send_batch_t * const batch,
+  MessageDef * const received_message_p)
+{
+  struct udp_socket_desc_s               *udp_sock_p = NULL;
+  udp_data_req_t                         *udp_data_req_p = &received_message_p->ittiMsg.udp_data_req;
+  int                                     udp_sd = -1;
+  int                                     i = 0;
+
+  pthread_mutex_lock (&udp_socket_list_mutex);
+  udp_sock_p = udp_server_get_socket_desc (ITTI_MSG_ORIGIN_ID (received_message_p));
+
+  if (udp_sock_p == NULL) {
+    OAILOG_ERROR (LOG_UDP, "Failed to retrieve the udp socket descriptor " "associated with task %d\n", ITTI_MSG_ORIGIN_ID (received_message_p));
+    pthread_mutex_unlock (&udp_socket_list_mutex);
+    return false;
+  }
+  udp_sd = udp_sock_p->sd;
+  pthread_mutex_unlock (&udp_socket_list_mutex);
+
+  // a batch goes through one socket
+  if ((batch->nb_msgs) && (batch->sd != udp_sd)) {
+    udp_server_flush_send_batch (batch);
+  }
+  OAILOG_DEBUG (LOG_UDP, "[%d] Sending message of size %u to " IN_ADDR_FMT " and port %u\n",
+      udp_sd, udp_data_req_p->buffer_length, PRI_IN_ADDR (udp_data_req_p->peer_address), udp_data_req_p->peer_port);
+  i = batch->nb_msgs++;
+  batch->sd = udp_sd;
+  batch->messages[i] = received_message_p;
+  memset (&batch->addrs[i], 0, sizeof (struct sockaddr_in));
+  batch->addrs[i].sin_family = AF_INET;
+  batch->addrs[i].sin_port = htons (udp_data_req_p->peer_port);
+  batch->addrs[i].sin_addr = udp_data_req_p->peer_address;
+  batch->iovs[i].iov_base = &udp_data_req_p->buffer[udp_data_req_p->buffer_offset];
+  batch->iovs[i].iov_len = udp_data_req_p->buffer_length;
+  memset (&batch->msgs[i], 0, sizeof (struct mmsghdr));
+  batch->msgs[i].msg_hdr.msg_name = &batch->addrs[i];
+  batch->msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+  batch->msgs[i].msg_hdr.msg_iov = &batch->iovs[i];
+  batch->msgs[i].msg_hdr.msg_iovlen = 1;
+
+  if (batch->nb_msgs == UDP_SEND_BATCH) {
+    udp_server_flush_send_batch (batch);
+  }
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -263,15 +437,29 @@ static void *udp_intertask_interface (void *args_p)
   int                                     rc = 0;
   int                                     nb_events = 0;
   struct epoll_event                     *events = NULL;
+  udp_send_batch_t                       *send_batch = calloc (1, sizeof (udp_send_batch_t));
 
+  DevAssert (send_batch != NULL);
   itti_mark_task_ready (TASK_UDP);
 
   while (1) {
     MessageDef                             *received_message_p = NULL;
+    int                                     nb_msgs = 0;
 
     itti_receive_msg (TASK_UDP, &received_message_p);
 
-    if (received_message_p != NULL) {
+    /*
+     * Serve the messages already queued, so that consecutive UDP_DATA_REQ go out with one sendmmsg(),
+     * * * up to UDP_MAX_QUEUED_MSGS_PER_WAKEUP not to starve the sockets.
+     */
+    while (received_message_p != NULL) {
+      /*
+       * Queued datagrams are sent before any other message is handled
+       */
+      if (UDP_DATA_REQ != ITTI_MSG_ID (received_message_p)) {
+        udp_server_flush_send_batch (send_batch);
+      }
+
       switch (ITTI_MSG_ID (received_message_p)) {
       case MESSAGE_TEST:{
           OAI_FPRINTF_INFO("TASK_UDP received MESSAGE_TEST\n");
@@ -280,6 +468,8 @@ static void *udp_intertask_interface (void *args_p)
 
 
       case TERMINATE_MESSAGE:{
+          udp_server_flush_send_batch (send_batch);
+          free_wrapper ((void**)&send_batch);
           udp_exit();
           itti_free_msg_content(received_message_p);
           itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
@@ -295,40 +485,9 @@ static void *udp_intertask_interface (void *args_p)
         break;
 
       case UDP_DATA_REQ:{
-          int                                     udp_sd = -1;
-          ssize_t                                 bytes_written;
-          struct udp_socket_desc_s               *udp_sock_p = NULL;
-          udp_data_req_t                         *udp_data_req_p;
-          struct sockaddr_in                      peer_addr;
-
-          udp_data_req_p = &received_message_p->ittiMsg.udp_data_req;
-          //UDP_DEBUG("-- UDP_DATA_REQ -----------------------------------------------------\n%s :\n",
-          //        __FUNCTION__);
-          //udp_print_hex_octets(&udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
-          //        udp_data_req_p->buffer_length);
-          memset (&peer_addr, 0, sizeof (struct sockaddr_in));
-          peer_addr.sin_family = AF_INET;
-          peer_addr.sin_port = htons (udp_data_req_p->peer_port);
-          peer_addr.sin_addr = udp_data_req_p->peer_address;
-          pthread_mutex_lock (&udp_socket_list_mutex);
-          udp_sock_p = udp_server_get_socket_desc (ITTI_MSG_ORIGIN_ID (received_message_p));
-
-          if (udp_sock_p == NULL) {
-            OAILOG_ERROR (LOG_UDP, "Failed to retrieve the udp socket descriptor " "associated with task %d\n", ITTI_MSG_ORIGIN_ID (received_message_p));
-            pthread_mutex_unlock (&udp_socket_list_mutex);
-            // no free udp_data_req_p->buffer, statically allocated
-            goto on_error;
-          }
-
-          udp_sd = udp_sock_p->sd;
-          pthread_mutex_unlock (&udp_socket_list_mutex);
-          OAILOG_DEBUG (LOG_UDP, "[%d] Sending message of size %u to " IN_ADDR_FMT " and port %u\n",
-              udp_sd, udp_data_req_p->buffer_length, PRI_IN_ADDR (udp_data_req_p->peer_address), udp_data_req_p->peer_port);
-          bytes_written = sendto (udp_sd, &udp_data_req_p->buffer[udp_data_req_p->buffer_offset], udp_data_req_p->buffer_length, 0, (struct sockaddr *)&peer_addr, sizeof (struct sockaddr_in));
-          // no free udp_data_req_p->buffer, statically allocated
-
-          if (bytes_written != udp_data_req_p->buffer_length) {
-            OAILOG_ERROR (LOG_UDP, "There was an error while writing to socket " "(%d:%s)\n", errno, strerror (errno));
+          if (udp_server_queue_data_req (send_batch, received_message_p)) {
+            // freed once sent
+            received_message_p = NULL;
           }
         }
         break;
@@ -339,11 +498,24 @@ static void *udp_intertask_interface (void *args_p)
         break;
       }
 
-    on_error:
-      itti_free_msg_content(received_message_p);
-      rc = itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
-      AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
-      received_message_p = NULL;
+      if (received_message_p) {
+        itti_free_msg_content(received_message_p);
+        rc = itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+        AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
+        received_message_p = NULL;
+      }
+      if (++nb_msgs < UDP_MAX_QUEUED_MSGS_PER_WAKEUP) {
+        itti_poll_msg (TASK_UDP, &received_message_p);
+      }
+    }
+    udp_server_flush_send_batch (send_batch);
+
+    if (nb_msgs >= UDP_MAX_QUEUED_MSGS_PER_WAKEUP) {
+      /*
+       * Messages are still queued, socket events would only be reported once they are all served
+       */
+      udp_server_receive_all_sockets ();
+      continue;
     }
 
     nb_events = itti_get_events (TASK_UDP, &events);
@@ -365,6 +537,11 @@ int udp_init (void)
   OAILOG_DEBUG (LOG_UDP, "Initializing UDP task interface\n");
   STAILQ_INIT (&udp_socket_list);
 
+  if ((udp_buffer_pool = udp_buffer_pool_create (UDP_BUFFER_POOL_SIZE, UDP_BUFFER_SIZE)) == NULL) {
+    OAILOG_ERROR (LOG_UDP, "udp buffer pool creation failed\n");
+    return -1;
+  }
+
   if (itti_create_task (TASK_UDP, &udp_intertask_interface, NULL) < 0) {
     OAILOG_ERROR (LOG_UDP, "udp pthread_create (%s)\n", strerror (errno));
     return -1;
@@ -381,8 +558,12 @@ void udp_exit (void)
   while ((socket_desc_p = STAILQ_FIRST (&udp_socket_list))) {
     itti_unsubscribe_event_fd(TASK_UDP, socket_desc_p->sd);
     close(socket_desc_p->sd);
+    for (int i = 0; i < UDP_RECV_BATCH; i++) {
+      udp_buffer_free ((uint8_t **)&socket_desc_p->iovs[i].iov_base);
+    }
     pthread_mutex_destroy(&udp_socket_list_mutex);
     STAILQ_REMOVE_HEAD (&udp_socket_list, entries);
     free_wrapper ((void**)&socket_desc_p);
   }
+  // the pool is not freed, UDP_DATA_IND messages still in flight reference its buffers
 }
@@ -70,6 +70,10 @@ hashtable_rc_code2string (
     return "HASH_TABLE_BAD_PARAMETER_HASHTABLE";
     break;
 
+  case HASH_TABLE_SYSTEM_ERROR:
+    return "HASH_TABLE_SYSTEM_ERROR";
+    break;
+
   default:
     return "UNKNOWN hashtable_rc_t";
   }
@@ -83,30 +87,22 @@ hashtable_rc_code2string (
 
 void hash_free_int_func (void **memoryP) {}
 
+
 //------------------------------------------------------------------------------
 /*
    Default hash function
    def_hashfunc() is the default used by hashtable_create() when the user didn't specify one.
-   This is a simple/naive hash function which adds the key's ASCII char values. It will probably generate lots of collisions on large hash tables.
+   The key is passed through a 64 bits finalizer so that structured keys (identifiers concatenated in bit fields,
+   sequential values in the low bits) are spread over all the buckets of the power of two sized table.
 */
 
 static inline hash_size_t def_hashfunc (const uint64_t keyP)
 {
-  return (hash_size_t) keyP;
+  return hashtable_mix64 (keyP);
 }
 
 //------------------------------------------------------------------------------
-/*
-   Initialization
-   hashtable_init() set up the initial structure of the hash table. The user specified size will be allocated and initialized to NULL.
-   The user can also specify a hash function. If the hashfunc argument is NULL, a default hash function is used.
-   If an error occurred, NULL is returned. All other values in the returned hash_table_t pointer should be released with hashtable_destroy().
-*/
-hash_table_t * hashtable_init (hash_table_t * const hashtblP,
-    const hash_size_t sizeP,
-    hash_size_t (*hashfuncP) (const hash_key_t),
-    void (*freefuncP) (void **),
-    bstring display_name_pP)
+static hash_size_t hashtable_size_roundup (const hash_size_t sizeP)
 {
   hash_size_t size = sizeP;
   // upper power of two: http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2Float
@@ -125,7 +121,271 @@ hash_table_t * hashtable_init (hash_table_t * const hashtblP,
   size |= size >> 4;
   size |= size >> 8;
   size |= size >> 16;
+  size |= (uint64_t)size >> 32;
   size++;
+  return (size) ? size:1;
+}
+
+//------------------------------------------------------------------------------
+/*
+   Incremental resizing
+   When the number of elements exceeds HASHTABLE_MAX_LOAD_FACTOR times the number of buckets, the bucket array is doubled
+   but the nodes are not moved at once: the previous array is kept in old_nodes and each following insert/get/free/remove
+   migrates HASHTABLE_REHASH_STEP of its buckets, so that no single operation pays for rehashing the whole table.
+   Until the migration is complete a key is searched in the new array then in its bucket of old_nodes (empty once migrated).
+*/
+
+// Search a key in one bucket array, return the link pointing to the node holding the key.
+static inline hash_node_t ** hashtable_lookup (hash_node_t ** const nodesP, const hash_size_t sizeP, const hash_size_t hashP, const hash_key_t keyP)
+{
+  hash_node_t                           **link = &nodesP[hashP % sizeP];
+
+  while (*link) {
+    if ((*link)->key == keyP) {
+      return link;
+    }
+    link = &(*link)->next;
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static inline hash_node_t ** hashtable_find (hash_node_t ** const nodesP, const hash_size_t sizeP,
+                                             hash_node_t ** const old_nodesP, const hash_size_t old_sizeP,
+                                             const hash_size_t hashP, const hash_key_t keyP)
+{
+  hash_node_t                           **link = hashtable_lookup (nodesP, sizeP, hashP, keyP);
+
+  if ((!link) && (old_nodesP)) {
+    link = hashtable_lookup (old_nodesP, old_sizeP, hashP, keyP);
+  }
+  return link;
+}
+
+//------------------------------------------------------------------------------
+// Move all nodes of a chain to their bucket in nodesP.
+static inline void hashtable_move_chain (hash_node_t * nodeP, hash_node_t ** const nodesP, const hash_size_t sizeP, hash_size_t (*hashfuncP) (const hash_key_t))
+{
+  hash_node_t                            *next = NULL;
+  hash_size_t                             hash = 0;
+
+  while (nodeP) {
+    next = nodeP->next;
+    hash = hashfuncP (nodeP->key) % sizeP;
+    nodeP->next = nodesP[hash];
+    nodesP[hash] = nodeP;
+    nodeP = next;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void hashtable_rehash_step (hash_table_t * const hashtblP)
+{
+  int                                     steps = HASHTABLE_REHASH_STEP;
+  int                                     empty_visits = HASHTABLE_REHASH_STEP * 10;
+
+  if (!hashtblP->old_nodes) {
+    return;
+  }
+  while ((steps > 0) && (hashtblP->rehash_index < hashtblP->old_size)) {
+    if (hashtblP->old_nodes[hashtblP->rehash_index]) {
+      hashtable_move_chain (hashtblP->old_nodes[hashtblP->rehash_index], hashtblP->nodes, hashtblP->size, hashtblP->hashfunc);
+      hashtblP->old_nodes[hashtblP->rehash_index] = NULL;
+      steps--;
+    } else if (--empty_visits == 0) {
+      hashtblP->rehash_index++;
+      break;
+    }
+    hashtblP->rehash_index++;
+  }
+  if (hashtblP->rehash_index >= hashtblP->old_size) {
+    PRINT_HASHTABLE (hashtblP, "%s(%s) resize to %zu buckets done\n", __FUNCTION__, bdata(hashtblP->name), hashtblP->size);
+    free_wrapper ((void**)&hashtblP->old_nodes);
+    hashtblP->old_size = 0;
+    hashtblP->rehash_index = 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void hashtable_grow (hash_table_t * const hashtblP)
+{
+  hash_node_t                           **nodes = NULL;
+
+  if ((hashtblP->old_nodes) || (hashtblP->num_elements <= (hashtblP->size * HASHTABLE_MAX_LOAD_FACTOR))) {
+    return;
+  }
+  // on allocation failure keep on working with the current buckets, will retry on next insert
+  if (!(nodes = calloc (hashtblP->size * 2, sizeof (hash_node_t *)))) {
+    return;
+  }
+  hashtblP->old_nodes = hashtblP->nodes;
+  hashtblP->old_size = hashtblP->size;
+  hashtblP->rehash_index = 0;
+  hashtblP->nodes = nodes;
+  hashtblP->size = hashtblP->size * 2;
+  hashtblP->num_resizes += 1;
+  PRINT_HASHTABLE (hashtblP, "%s(%s) %zu elements, resizing to %zu buckets\n", __FUNCTION__, bdata(hashtblP->name), hashtblP->num_elements, hashtblP->size);
+}
+
+//------------------------------------------------------------------------------
+/*
+   Thread safe tables
+   The number of bucket locks (num_lock_nodes) is fixed at creation and the bucket array only grows by powers of two, so the
+   bucket (hash % size) of a key and its bucket in old_nodes (hash % old_size) are both protected by lock_nodes[hash % num_lock_nodes].
+   Each operation migrates old buckets of its own lock stripe and, once its stripe is done, tries to help another stripe.
+   Replacing or releasing the bucket arrays requires the table mutex and all the bucket locks.
+*/
+
+//------------------------------------------------------------------------------
+static inline pthread_mutex_t * hashtable_ts_lock_of (const hash_table_ts_t * const hashtblP, const hash_size_t hashP)
+{
+  return &hashtblP->lock_nodes[hashP % hashtblP->num_lock_nodes];
+}
+
+//------------------------------------------------------------------------------
+static void hashtable_ts_lock_all (hash_table_ts_t * const hashtblP)
+{
+  for (hash_size_t n = 0; n < hashtblP->num_lock_nodes; n++) {
+    pthread_mutex_lock (&hashtblP->lock_nodes[n]);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void hashtable_ts_unlock_all (hash_table_ts_t * const hashtblP)
+{
+  for (hash_size_t n = 0; n < hashtblP->num_lock_nodes; n++) {
+    pthread_mutex_unlock (&hashtblP->lock_nodes[n]);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Number of iterations (hashtable_ts_visit) in progress in this thread.
+static __thread int                     hashtable_ts_visit_depth = 0;
+
+// Take the table mutex before replacing the bucket arrays, called without any bucket lock held.
+// From an iteration callback the mutex of this table (or of another table iterated by another thread) may not be
+// released before this thread returns: do not wait for it, another operation will retry.
+static bool hashtable_ts_lock_table (hash_table_ts_t * const hashtblP)
+{
+  if (hashtable_ts_visit_depth) {
+    return (0 == pthread_mutex_trylock (&hashtblP->mutex));
+  }
+  pthread_mutex_lock (&hashtblP->mutex);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Called with lock_nodes[stripe] held, return true if all stripes are migrated.
+static bool hashtable_ts_rehash_stripe (hash_table_ts_t * const hashtblP, const hash_size_t stripeP)
+{
+  hash_size_t                            *index = &hashtblP->stripe_rehash_index[stripeP];
+  int                                     steps = HASHTABLE_REHASH_STEP;
+  int                                     empty_visits = HASHTABLE_REHASH_STEP * 10;
+
+  if (*index >= hashtblP->old_size) {
+    return (__atomic_load_n (&hashtblP->num_rehashed_stripes, __ATOMIC_SEQ_CST) == hashtblP->num_lock_nodes);
+  }
+  while ((steps > 0) && (empty_visits > 0) && (*index < hashtblP->old_size)) {
+    if (hashtblP->old_nodes[*index]) {
+      hashtable_move_chain (hashtblP->old_nodes[*index], hashtblP->nodes, hashtblP->size, hashtblP->hashfunc);
+      hashtblP->old_nodes[*index] = NULL;
+      steps--;
+    } else {
+      empty_visits--;
+    }
+    *index += hashtblP->num_lock_nodes;
+  }
+  if (*index >= hashtblP->old_size) {
+    return (__sync_add_and_fetch (&hashtblP->num_rehashed_stripes, 1) == hashtblP->num_lock_nodes);
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Called with lock_nodes[stripe] held, return true if all stripes are migrated.
+static bool hashtable_ts_rehash_step (hash_table_ts_t * const hashtblP, const hash_size_t stripeP)
+{
+  hash_size_t                             other = 0;
+  bool                                    done = false;
+
+  if (!hashtblP->old_nodes) {
+    return false;
+  }
+  if (hashtblP->stripe_rehash_index[stripeP] < hashtblP->old_size) {
+    return hashtable_ts_rehash_stripe (hashtblP, stripeP);
+  }
+  // own stripe migrated, help another one, trylock does not impose any lock ordering
+  other = __sync_fetch_and_add (&hashtblP->rehash_cursor, 1) % hashtblP->num_lock_nodes;
+  if (other == stripeP) {
+    return hashtable_ts_rehash_stripe (hashtblP, stripeP);
+  }
+  if (0 == pthread_mutex_trylock (&hashtblP->lock_nodes[other])) {
+    done = hashtable_ts_rehash_stripe (hashtblP, other);
+    pthread_mutex_unlock (&hashtblP->lock_nodes[other]);
+  }
+  return done;
+}
+
+//------------------------------------------------------------------------------
+// Called without any bucket lock held.
+static void hashtable_ts_rehash_end (hash_table_ts_t * const hashtblP)
+{
+  if (!hashtable_ts_lock_table (hashtblP)) {
+    return;
+  }
+  hashtable_ts_lock_all (hashtblP);
+  if ((hashtblP->old_nodes) && (hashtblP->num_rehashed_stripes == hashtblP->num_lock_nodes)) {
+    PRINT_HASHTABLE (hashtblP, "%s(%s) resize to %zu buckets done\n", __FUNCTION__, bdata(hashtblP->name), hashtblP->size);
+    free_wrapper ((void**)&hashtblP->old_nodes);
+    hashtblP->old_size = 0;
+  }
+  hashtable_ts_unlock_all (hashtblP);
+  pthread_mutex_unlock (&hashtblP->mutex);
+}
+
+//------------------------------------------------------------------------------
+// Called without any bucket lock held.
+static void hashtable_ts_grow (hash_table_ts_t * const hashtblP)
+{
+  hash_node_t                           **nodes = NULL;
+
+  if (!hashtable_ts_lock_table (hashtblP)) {
+    return;
+  }
+  hashtable_ts_lock_all (hashtblP);
+  if ((!hashtblP->old_nodes) && (hashtblP->num_elements > (hashtblP->size * HASHTABLE_MAX_LOAD_FACTOR))) {
+    // on allocation failure keep on working with the current buckets, will retry on next insert
+    if ((nodes = calloc (hashtblP->size * 2, sizeof (hash_node_t *)))) {
+      hashtblP->old_nodes = hashtblP->nodes;
+      hashtblP->old_size = hashtblP->size;
+      hashtblP->nodes = nodes;
+      hashtblP->size = hashtblP->size * 2;
+      for (hash_size_t n = 0; n < hashtblP->num_lock_nodes; n++) {
+        hashtblP->stripe_rehash_index[n] = n;
+      }
+      hashtblP->num_rehashed_stripes = 0;
+      hashtblP->num_resizes += 1;
+      PRINT_HASHTABLE (hashtblP, "%s(%s) %zu elements, resizing to %zu buckets\n", __FUNCTION__, bdata(hashtblP->name), hashtblP->num_elements, hashtblP->size);
+    }
+  }
+  hashtable_ts_unlock_all (hashtblP);
+  pthread_mutex_unlock (&hashtblP->mutex);
+}
+
+//------------------------------------------------------------------------------
+/*
+   Initialization
+   hashtable_init() set up the initial structure of the hash table. The user specified size will be allocated and initialized to NULL.
+   The user can also specify a hash function. If the hashfunc argument is NULL, a default hash function is used.
+   If an error occurred, NULL is returned. All other values in the returned hash_table_t pointer should be released with hashtable_destroy().
+*/
+hash_table_t * hashtable_init (hash_table_t * const hashtblP,
+    const hash_size_t sizeP,
+    hash_size_t (*hashfuncP) (const hash_key_t),
+    void (*freefuncP) (void **),
+    bstring display_name_pP)
+{
+  hash_size_t size = hashtable_size_roundup (sizeP);
 
   if (!(hashtblP->nodes = calloc (size, sizeof (hash_node_t *)))) {
     free_wrapper ((void**)&hashtblP);
@@ -135,6 +395,11 @@ hash_table_t * hashtable_init (hash_table_t * const hashtblP,
 
   PRINT_HASHTABLE (hashtblP, "allocated nodes\n");
   hashtblP->size = size;
+  hashtblP->num_elements = 0;
+  hashtblP->old_nodes = NULL;
+  hashtblP->old_size = 0;
+  hashtblP->rehash_index = 0;
+  hashtblP->num_resizes = 0;
 
   if (hashfuncP)
     hashtblP->hashfunc = hashfuncP;
@@ -147,7 +412,7 @@ hash_table_t * hashtable_init (hash_table_t * const hashtblP,
     hashtblP->freefunc = free_wrapper;
 
   if (display_name_pP) {
-    bassign(hashtblP->name, display_name_pP);
+    hashtblP->name = bstrcpy(display_name_pP);
   } else {
     hashtblP->name = bformat("hashtable%u@%p", size, hashtblP);
   }
@@ -192,24 +457,7 @@ hash_table_ts_t * hashtable_ts_init (hash_table_ts_t * const hashtblP,
     void (*freefuncP) (void **),
     bstring display_name_pP)
 {
-  hash_size_t size = sizeP;
-  // upper power of two: http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2Float
-  //  By Sean Eron Anderson
-  // seander@cs.stanford.edu
-  // Individually, the code snippets here are in the public domain (unless otherwise noted) — feel free to use them however you please.
-  // The aggregate collection and descriptions are © 1997-2005 Sean Eron Anderson. The code and descriptions are distributed in the hope
-  // that they will be useful, but WITHOUT ANY WARRANTY and without even the implied warranty of merchantability or fitness for a particular
-  // purpose. As of May 5, 2005, all the code has been tested thoroughly. Thousands of people have read it. Moreover, Professor Randal Bryant,
-  // the Dean of Computer Science at Carnegie Mellon University, has personally tested almost everything with his Uclid code verification system.
-  // What he hasn't tested, I have checked against all possible inputs on a 32-bit machine. To the first person to inform me of a legitimate bug
-  // in the code, I'll pay a bounty of US$10 (by check or Paypal). If directed to a charity, I'll pay US$20.
-  size--;
-  size |= size >> 1;
-  size |= size >> 2;
-  size |= size >> 4;
-  size |= size >> 8;
-  size |= size >> 16;
-  size++;
+  hash_size_t size = hashtable_size_roundup (sizeP);
 
   memset(hashtblP, 0, sizeof(*hashtblP));
 
@@ -220,17 +468,24 @@ hash_table_ts_t * hashtable_ts_init (hash_table_ts_t * const hashtblP,
 
   if (!(hashtblP->lock_nodes = calloc (size, sizeof (pthread_mutex_t)))) {
     free_wrapper ((void**)&hashtblP->nodes);
-    free_wrapper ((void**)&hashtblP->name);
+    free_wrapper ((void**)&hashtblP);
+    return NULL;
+  }
+
+  if (!(hashtblP->stripe_rehash_index = calloc (size, sizeof (hash_size_t)))) {
+    free_wrapper ((void**)&hashtblP->lock_nodes);
+    free_wrapper ((void**)&hashtblP->nodes);
     free_wrapper ((void**)&hashtblP);
     return NULL;
   }
 
   pthread_mutex_init(&hashtblP->mutex, NULL);
-  for (int i = 0; i < size; i++) {
+  for (hash_size_t i = 0; i < size; i++) {
     pthread_mutex_init(&hashtblP->lock_nodes[i], NULL);
   }
 
   hashtblP->size = size;
+  hashtblP->num_lock_nodes = size;
 
   if (hashfuncP)
     hashtblP->hashfunc = hashfuncP;
@@ -276,35 +531,45 @@ hashtable_ts_create (
 }
 
 //------------------------------------------------------------------------------
-/*
-   Cleanup
-   The hashtable_destroy() walks through the linked lists for each possible hash value, and releases the elements. It also releases the nodes array and the hash_table_t.
-*/
-hashtable_rc_t
-hashtable_destroy (
-  hash_table_t * hashtblP)
+static void hashtable_free_chains (hash_node_t ** const nodesP, const hash_size_t sizeP, void (*freefuncP) (void **))
 {
-  hash_size_t                             n = 0;
   hash_node_t                            *node = NULL,
                                          *oldnode = NULL;
 
-  if (!hashtblP) {
-    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
-  }
-
-  for (n = 0; n < hashtblP->size; ++n) {
-    node = hashtblP->nodes[n];
+  for (hash_size_t n = 0; n < sizeP; ++n) {
+    node = nodesP[n];
 
     while (node) {
       oldnode = node;
       node = node->next;
 
       if (oldnode->data) {
-        hashtblP->freefunc (&oldnode->data);
+        freefuncP (&oldnode->data);
       }
 
       free_wrapper ((void**)&oldnode);
     }
+    nodesP[n] = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+   Cleanup
+   The hashtable_destroy() walks through the linked lists for each possible hash value, and releases the elements. It also releases the nodes array and the hash_table_t.
+*/
+hashtable_rc_t
+hashtable_destroy (
+  hash_table_t * hashtblP)
+{
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  hashtable_free_chains (hashtblP->nodes, hashtblP->size, hashtblP->freefunc);
+  if (hashtblP->old_nodes) {
+    hashtable_free_chains (hashtblP->old_nodes, hashtblP->old_size, hashtblP->freefunc);
+    free_wrapper ((void**)&hashtblP->old_nodes);
   }
 
   free_wrapper ((void**)&hashtblP->nodes);
@@ -324,36 +589,28 @@ hashtable_rc_t
 hashtable_ts_destroy (
   hash_table_ts_t * hashtblP)
 {
-  hash_size_t                             n = 0;
-  hash_node_t                            *node = NULL,
-                                         *oldnode = NULL;
-
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  for (n = 0; n < hashtblP->size; ++n) {
-    pthread_mutex_lock (&hashtblP->lock_nodes[n]);
-    node = hashtblP->nodes[n];
-
-    while (node) {
-      oldnode = node;
-      node = node->next;
-
-      if (oldnode->data) {
-        hashtblP->freefunc (&oldnode->data);
-      }
-
-      free_wrapper ((void**)&oldnode);
-    }
-
-    pthread_mutex_unlock (&hashtblP->lock_nodes[n]);
+  pthread_mutex_lock (&hashtblP->mutex);
+  hashtable_ts_lock_all (hashtblP);
+  hashtable_free_chains (hashtblP->nodes, hashtblP->size, hashtblP->freefunc);
+  if (hashtblP->old_nodes) {
+    hashtable_free_chains (hashtblP->old_nodes, hashtblP->old_size, hashtblP->freefunc);
+    free_wrapper ((void**)&hashtblP->old_nodes);
+  }
+  hashtable_ts_unlock_all (hashtblP);
+  for (hash_size_t n = 0; n < hashtblP->num_lock_nodes; ++n) {
     pthread_mutex_destroy (&hashtblP->lock_nodes[n]);
   }
+  pthread_mutex_unlock (&hashtblP->mutex);
+  pthread_mutex_destroy (&hashtblP->mutex);
 
   free_wrapper ((void**)&hashtblP->nodes);
   bdestroy_wrapper (&hashtblP->name);
   free_wrapper((void**)&hashtblP->lock_nodes);
+  free_wrapper((void**)&hashtblP->stripe_rehash_index);
   if (hashtblP->is_allocated_by_malloc) {
     free_wrapper ((void**)&hashtblP);
   }
@@ -368,23 +625,16 @@ hashtable_is_key_exists (
   const hash_table_t * const hashtblP,
   const hash_key_t keyP)
 {
-  hash_node_t                            *node = NULL;
   hash_size_t                             hash = 0;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
-    }
-
-    node = node->next;
+  hash = hashtblP->hashfunc (keyP);
+  if (hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hash, keyP)) {
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_OK;
   }
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
   return HASH_TABLE_KEY_NOT_EXISTS;
@@ -398,27 +648,23 @@ hashtable_ts_is_key_exists (
   const hash_table_ts_t * const hashtblP,
   const hash_key_t keyP)
 {
-  hash_node_t                            *node = NULL;
   hash_size_t                             hash = 0;
+  pthread_mutex_t                        *lock = NULL;
+  bool                                    found = false;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock (&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      pthread_mutex_unlock (&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
-    }
-
-    node = node->next;
+  hash = hashtblP->hashfunc (keyP);
+  lock = hashtable_ts_lock_of (hashtblP, hash);
+  pthread_mutex_lock (lock);
+  found = (NULL != hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hash, keyP));
+  pthread_mutex_unlock (lock);
+  if (found) {
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_OK;
   }
-  pthread_mutex_unlock (&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
@@ -440,91 +686,150 @@ hashtable_apply_callback_on_elements (
   void **resultP)
 {
   hash_node_t                            *node = NULL;
-  unsigned int                            i = 0;
+  hash_node_t                           **nodes = NULL;
+  hash_size_t                             size = 0;
+  hash_size_t                             i = 0;
   unsigned int                            num_elements = 0;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  while ((num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-
-      while (node) {
-        num_elements++;
-        if (funct_cb (node->key, node->data, parameterP, resultP)) {
-          return HASH_TABLE_OK;
+  // buckets in use, then buckets not yet migrated if a resize is in progress
+  nodes = hashtblP->nodes;
+  size = hashtblP->size;
+  while (nodes) {
+    i = 0;
+    while ((num_elements < hashtblP->num_elements) && (i < size)) {
+      if (nodes[i] != NULL) {
+        node = nodes[i];
+
+        while (node) {
+          num_elements++;
+          if (funct_cb (node->key, node->data, parameterP, resultP)) {
+            return HASH_TABLE_OK;
+          }
+          node = node->next;
         }
-        node = node->next;
       }
+      i++;
     }
-    i++;
+    nodes = (nodes == hashtblP->old_nodes) ? NULL:hashtblP->old_nodes;
+    size = hashtblP->old_size;
   }
 
   return HASH_TABLE_OK;
 }
 
+//------------------------------------------------------------------------------
+/*
+   Iteration over a thread safe table
+   Nodes are visited lock stripe by lock stripe, in both bucket arrays, so that a concurrent migration of old buckets
+   can neither hide nor duplicate a node. The table mutex must be held by the caller, it prevents the start or the end of a resize.
+*/
+static bool hashtable_ts_visit (
+  hash_table_ts_t * const hashtblP,
+  bool visit_cb (hash_node_t * const nodeP, void *argP),
+  void *argP)
+{
+  hash_node_t                            *node = NULL;
+  hash_node_t                           **nodes = NULL;
+  hash_size_t                             size = 0;
+  bool                                    found = false;
+
+  hashtable_ts_visit_depth++;
+  for (hash_size_t stripe = 0; (stripe < hashtblP->num_lock_nodes) && (!found); stripe++) {
+    pthread_mutex_lock (&hashtblP->lock_nodes[stripe]);
+    nodes = hashtblP->nodes;
+    size = hashtblP->size;
+    while (nodes) {
+      for (hash_size_t i = stripe; i < size; i += hashtblP->num_lock_nodes) {
+        node = nodes[i];
+        while ((node) && (!found)) {
+          found = visit_cb (node, argP);
+          node = node->next;
+        }
+      }
+      nodes = ((found) || (nodes == hashtblP->old_nodes)) ? NULL:hashtblP->old_nodes;
+      size = hashtblP->old_size;
+    }
+    pthread_mutex_unlock (&hashtblP->lock_nodes[stripe]);
+  }
+  hashtable_ts_visit_depth--;
+  return found;
+}
+
+//------------------------------------------------------------------------------
+static bool hashtable_ts_get_key_cb (hash_node_t * const nodeP, void *argP)
+{
+  hashtable_key_array_t                  *ka = (hashtable_key_array_t *)argP;
+
+  ka->keys[ka->num_keys++] = nodeP->key;
+  // elements inserted since the array was allocated are not reported
+  return (ka->num_keys == ka->capacity);
+}
+
 //------------------------------------------------------------------------------
 // may cost a lot CPU...
 hashtable_key_array_t * hashtable_ts_get_keys (hash_table_ts_t * const hashtblP)
 {
-  hash_node_t                            *node = NULL;
-  unsigned int                            i = 0;
   hashtable_key_array_t                  *ka = NULL;
 
   if ((!hashtblP) || !(hashtblP->num_elements)){
     return NULL;
   }
 
+  pthread_mutex_lock (&hashtblP->mutex);
   ka = calloc(1, sizeof(hashtable_key_array_t));
-  ka->keys = calloc(hashtblP->num_elements, sizeof(hash_key_t*));
-
-  while ((ka->num_keys < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-      while (node) {
-        ka->keys[ka->num_keys++] = node->key;
-        node = node->next;
-      }
-    }
-    pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    i++;
-  }
+  ka->capacity = hashtblP->num_elements;
+  ka->keys = calloc(ka->capacity, sizeof(hash_key_t));
+  hashtable_ts_visit (hashtblP, hashtable_ts_get_key_cb, ka);
+  pthread_mutex_unlock (&hashtblP->mutex);
   return ka;
 }
 
+//------------------------------------------------------------------------------
+static bool hashtable_ts_get_element_cb (hash_node_t * const nodeP, void *argP)
+{
+  hashtable_element_array_t              *ea = (hashtable_element_array_t *)argP;
+
+  ea->elements[ea->num_elements++] = nodeP->data;
+  return (ea->num_elements == ea->capacity);
+}
+
 //------------------------------------------------------------------------------
 // may cost a lot CPU...
 hashtable_element_array_t * hashtable_ts_get_elements (hash_table_ts_t * const hashtblP)
 {
-  hash_node_t                            *node = NULL;
-  unsigned int                            i = 0;
   hashtable_element_array_t              *ea = NULL;
 
   if ((!hashtblP) || !(hashtblP->num_elements)){
     return NULL;
   }
+  pthread_mutex_lock (&hashtblP->mutex);
   ea = calloc(1, sizeof(hashtable_element_array_t));
-  ea->elements = calloc(hashtblP->num_elements, sizeof(hash_key_t*));
-
-  while ((ea->num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-      while (node) {
-        ea->elements[ea->num_elements++] = node->data;
-        node = node->next;
-      }
-    }
-    pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    i++;
-  }
+  ea->capacity = hashtblP->num_elements;
+  ea->elements = calloc(ea->capacity, sizeof(void*));
+  hashtable_ts_visit (hashtblP, hashtable_ts_get_element_cb, ea);
+  pthread_mutex_unlock (&hashtblP->mutex);
   return ea;
 }
 
 
+//------------------------------------------------------------------------------
+typedef struct hashtable_ts_callback_arg_s {
+  bool                                  (*funct_cb) (const hash_key_t keyP, void * const dataP, void *parameterP, void ** resultP);
+  void                                   *parameter;
+  void                                  **result;
+} hashtable_ts_callback_arg_t;
+
+static bool hashtable_ts_callback_cb (hash_node_t * const nodeP, void *argP)
+{
+  hashtable_ts_callback_arg_t            *arg = (hashtable_ts_callback_arg_t *)argP;
+
+  return arg->funct_cb (nodeP->key, nodeP->data, arg->parameter, arg->result);
+}
+
 //------------------------------------------------------------------------------
 // may cost a lot CPU...
 // Also useful if we want to find an element in the collection based on compare criteria different than the single key
@@ -539,32 +844,15 @@ hashtable_ts_apply_callback_on_elements (
   void *parameterP,
   void** resultP)
 {
-  hash_node_t                            *node = NULL;
-  unsigned int                            i = 0;
-  unsigned int                            num_elements = 0;
+  hashtable_ts_callback_arg_t             arg = {.funct_cb = funct_cb, .parameter = parameterP, .result = resultP};
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  while ((num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-
-      while (node) {
-        num_elements++;
-        if (funct_cb (node->key, node->data, parameterP, resultP)) {
-          pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-          return HASH_TABLE_OK;
-        }
-        node = node->next;
-      }
-    }
-    pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    i++;
-  }
-
+  pthread_mutex_lock (&hashtblP->mutex);
+  hashtable_ts_visit (hashtblP, hashtable_ts_callback_cb, &arg);
+  pthread_mutex_unlock (&hashtblP->mutex);
   return HASH_TABLE_OK;
 }
 
@@ -576,68 +864,70 @@ hashtable_dump_content (
   bstring str)
 {
   hash_node_t                            *node = NULL;
-  unsigned int                            i = 0;
+  hash_node_t                           **nodes = NULL;
+  hash_size_t                             size = 0;
+  hash_size_t                             i = 0;
 
   if (!hashtblP) {
     bcatcstr(str, "HASH_TABLE_BAD_PARAMETER_HASHTABLE");
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  while (i < hashtblP->size) {
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
+  nodes = hashtblP->nodes;
+  size = hashtblP->size;
+  while (nodes) {
+    i = 0;
+    while (i < size) {
+      if (nodes[i] != NULL) {
+        node = nodes[i];
+
+        while (node) {
+          bstring b0 = bformat("Key 0x%"PRIx64" Element %p Node %p\n", node->key, node->data, node);
+          if (!b0) {
+            PRINT_HASHTABLE (hashtblP, "Error while dumping hashtable content");
+          } else {
+            bconcat(str, b0);
+            bdestroy_wrapper (&b0);
+          }
+          node = node->next;
 
-      while (node) {
-        bstring b0 = bformat("Key 0x%"PRIx64" Element %p Node %p\n", node->key, node->data, node);
-        if (!b0) {
-          PRINT_HASHTABLE (hashtblP, "Error while dumping hashtable content");
-        } else {
-          bconcat(str, b0);
-          bdestroy_wrapper (&b0);
         }
-        node = node->next;
-
       }
+      i += 1;
     }
-    i += 1;
+    nodes = (nodes == hashtblP->old_nodes) ? NULL:hashtblP->old_nodes;
+    size = hashtblP->old_size;
   }
   return HASH_TABLE_OK;
 }
 
+//------------------------------------------------------------------------------
+static bool hashtable_ts_dump_cb (hash_node_t * const nodeP, void *argP)
+{
+  bstring                                 str = (bstring)argP;
+  bstring                                 b0 = bformat ("Key 0x%"PRIx64" Element %p Node %p Next %p\n", nodeP->key, nodeP->data, nodeP, nodeP->next);
+
+  if (b0) {
+    bconcat(str, b0);
+    bdestroy_wrapper (&b0);
+  }
+  return false;
+}
+
 //------------------------------------------------------------------------------
 hashtable_rc_t
 hashtable_ts_dump_content (
   const hash_table_ts_t * const hashtblP,
   bstring str)
 {
-  hash_node_t                            *node = NULL;
-  unsigned int                            i = 0;
-
   if (!hashtblP) {
     bcatcstr(str, "HASH_TABLE_BAD_PARAMETER_HASHTABLE");
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  while (i < hashtblP->size) {
-    if (hashtblP->nodes[i] != NULL) {
-      pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-      node = hashtblP->nodes[i];
-
-      while (node) {
-        bstring b0 = bformat ("Key 0x%"PRIx64" Element %p Node %p Next %p\n", node->key, node->data, node, node->next);
-        if (!b0) {
-          PRINT_HASHTABLE (hashtblP, "Error while dumping hashtable content");
-        } else {
-          bconcat(str, b0);
-          bdestroy_wrapper (&b0);
-        }
-        node = node->next;
-
-      }
-      pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    }
-    i += 1;
-  }
+  pthread_mutex_lock ((pthread_mutex_t *)&hashtblP->mutex);
+  hashtable_ts_visit ((hash_table_ts_t *)hashtblP, hashtable_ts_dump_cb, str);
+  pthread_mutex_unlock ((pthread_mutex_t *)&hashtblP->mutex);
   return HASH_TABLE_OK;
 }
 
@@ -647,6 +937,7 @@ hashtable_ts_dump_content (
 /*
    Adding a new element
    To make sure the hash value is not bigger than size, the result of the user provided hash function is used modulo size.
+   The table grows once its load factor exceeds HASHTABLE_MAX_LOAD_FACTOR.
 */
 hashtable_rc_t
 hashtable_insert (
@@ -655,45 +946,41 @@ hashtable_insert (
   void *dataP)
 {
   hash_node_t                            *node = NULL;
+  hash_node_t                           **link = NULL;
   hash_size_t                             hash = 0;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  node = hashtblP->nodes[hash];
+  hashtable_rehash_step (hashtblP);
+  hash = hashtblP->hashfunc (keyP);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hash, keyP);
 
-  while (node) {
-    if (node->key == keyP) {
-      if ((node->data) && (node->data != dataP)) {
-        hashtblP->freefunc (&node->data);
-        node->data = dataP;
-        PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return INSERT_OVERWRITTEN_DATA\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
-        return HASH_TABLE_INSERT_OVERWRITTEN_DATA;
-      }
+  if (link) {
+    node = *link;
+    if ((node->data) && (node->data != dataP)) {
+      hashtblP->freefunc (&node->data);
       node->data = dataP;
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
-      return HASH_TABLE_OK;
+      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return INSERT_OVERWRITTEN_DATA\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
+      return HASH_TABLE_INSERT_OVERWRITTEN_DATA;
     }
-
-    node = node->next;
+    node->data = dataP;
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
+    return HASH_TABLE_OK;
   }
 
   if (!(node = malloc (sizeof (hash_node_t))))
-    return -1;
+    return HASH_TABLE_SYSTEM_ERROR;
 
   node->key = keyP;
   node->data = dataP;
 
-  if (hashtblP->nodes[hash]) {
-    node->next = hashtblP->nodes[hash];
-  } else {
-    node->next = NULL;
-  }
-
+  hash = hash % hashtblP->size;
+  node->next = hashtblP->nodes[hash];
   hashtblP->nodes[hash] = node;
   hashtblP->num_elements += 1;
+  hashtable_grow (hashtblP);
 
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
   return HASH_TABLE_OK;
@@ -704,6 +991,7 @@ hashtable_insert (
 /*
    Adding a new element
    To make sure the hash value is not bigger than size, the result of the user provided hash function is used modulo size.
+   The table grows once its load factor exceeds HASHTABLE_MAX_LOAD_FACTOR.
 */
 hashtable_rc_t
 hashtable_ts_insert (
@@ -712,51 +1000,51 @@ hashtable_ts_insert (
   void *dataP)
 {
   hash_node_t                            *node = NULL;
+  hash_node_t                           **link = NULL;
   hash_size_t                             hash = 0;
+  hash_size_t                             num_elements = 0;
+  pthread_mutex_t                        *lock = NULL;
+  bool                                    rehashed = false;
+  bool                                    grow = false;
+  hashtable_rc_t                          rc = HASH_TABLE_OK;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      if ((node->data) && (node->data != dataP)) {
-        hashtblP->freefunc (&node->data);
-        node->data = dataP;
-        pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-        PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return INSERT_OVERWRITTEN_DATA\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
-        return HASH_TABLE_INSERT_OVERWRITTEN_DATA;
-      }
-      node->data = dataP;
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
-      return HASH_TABLE_OK;
+  hash = hashtblP->hashfunc (keyP);
+  lock = hashtable_ts_lock_of (hashtblP, hash);
+  pthread_mutex_lock(lock);
+  rehashed = hashtable_ts_rehash_step (hashtblP, hash % hashtblP->num_lock_nodes);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hash, keyP);
+
+  if (link) {
+    node = *link;
+    if ((node->data) && (node->data != dataP)) {
+      hashtblP->freefunc (&node->data);
+      rc = HASH_TABLE_INSERT_OVERWRITTEN_DATA;
     }
-
-    node = node->next;
-  }
-
-  if (!(node = malloc (sizeof (hash_node_t))))
-    return -1;
-
-  node->key = keyP;
-  node->data = dataP;
-
-  if (hashtblP->nodes[hash]) {
-    node->next = hashtblP->nodes[hash];
+    node->data = dataP;
+  } else if ((node = malloc (sizeof (hash_node_t)))) {
+    node->key = keyP;
+    node->data = dataP;
+    node->next = hashtblP->nodes[hash % hashtblP->size];
+    hashtblP->nodes[hash % hashtblP->size] = node;
+    num_elements = __sync_add_and_fetch (&hashtblP->num_elements, 1);
+    grow = (!hashtblP->old_nodes) && (num_elements > (hashtblP->size * HASHTABLE_MAX_LOAD_FACTOR));
   } else {
-    node->next = NULL;
+    rc = HASH_TABLE_SYSTEM_ERROR;
   }
+  pthread_mutex_unlock(lock);
 
-  hashtblP->nodes[hash] = node;
-  __sync_fetch_and_add (&hashtblP->num_elements, 1);
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-  PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) next %p return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP, node->next);
-  return HASH_TABLE_OK;
+  if (rehashed) {
+    hashtable_ts_rehash_end (hashtblP);
+  }
+  if (grow) {
+    hashtable_ts_grow (hashtblP);
+  }
+  PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return %s\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP, hashtable_rc_code2string(rc));
+  return rc;
 }
 
 
@@ -771,36 +1059,28 @@ hashtable_free (
   hash_table_t * const hashtblP,
   const hash_key_t keyP)
 {
-  hash_node_t                            *node,
-                                         *prevnode = NULL;
-  hash_size_t                             hash = 0;
+  hash_node_t                            *node = NULL;
+  hash_node_t                           **link = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  node = hashtblP->nodes[hash];
+  hashtable_rehash_step (hashtblP);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hashtblP->hashfunc (keyP), keyP);
 
-  while (node) {
-    if (node->key == keyP) {
-      if (prevnode)
-        prevnode->next = node->next;
-      else
-        hashtblP->nodes[hash] = node->next;
-
-      if (node->data) {
-        hashtblP->freefunc (&node->data);
-      }
+  if (link) {
+    node = *link;
+    *link = node->next;
 
-      free_wrapper ((void**)&node);
-      __sync_fetch_and_sub (&hashtblP->num_elements, 1);
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
+    if (node->data) {
+      hashtblP->freefunc (&node->data);
     }
 
-    prevnode = node;
-    node = node->next;
+    free_wrapper ((void**)&node);
+    hashtblP->num_elements -= 1;
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_OK;
   }
 
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
@@ -818,42 +1098,43 @@ hashtable_ts_free (
   hash_table_ts_t * const hashtblP,
   const hash_key_t keyP)
 {
-  hash_node_t                            *node,
-                                         *prevnode = NULL;
+  hash_node_t                            *node = NULL;
+  hash_node_t                           **link = NULL;
   hash_size_t                             hash = 0;
+  pthread_mutex_t                        *lock = NULL;
+  bool                                    rehashed = false;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      if (prevnode)
-        prevnode->next = node->next;
-      else
-        hashtblP->nodes[hash] = node->next;
+  hash = hashtblP->hashfunc (keyP);
+  lock = hashtable_ts_lock_of (hashtblP, hash);
+  pthread_mutex_lock(lock);
+  rehashed = hashtable_ts_rehash_step (hashtblP, hash % hashtblP->num_lock_nodes);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hash, keyP);
 
-      if (node->data) {
-        hashtblP->freefunc (&node->data);
-      }
+  if (link) {
+    node = *link;
+    *link = node->next;
 
-      free_wrapper ((void**)&node);
-      __sync_fetch_and_sub (&hashtblP->num_elements, 1);
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
+    if (node->data) {
+      hashtblP->freefunc (&node->data);
     }
 
-    prevnode = node;
-    node = node->next;
+    free_wrapper ((void**)&node);
+    __sync_fetch_and_sub (&hashtblP->num_elements, 1);
   }
+  pthread_mutex_unlock(lock);
 
-   pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+  if (rehashed) {
+    hashtable_ts_rehash_end (hashtblP);
+  }
+  if (link) {
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_OK;
+  }
+  PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
 
@@ -870,33 +1151,24 @@ hashtable_remove (
   const hash_key_t keyP,
   void **dataP)
 {
-  hash_node_t                            *node,
-                                         *prevnode = NULL;
-  hash_size_t                             hash = 0;
+  hash_node_t                            *node = NULL;
+  hash_node_t                           **link = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      if (prevnode)
-        prevnode->next = node->next;
-      else
-        hashtblP->nodes[hash] = node->next;
-
-      *dataP = node->data;
-      free_wrapper ((void**)&node);
-      __sync_fetch_and_sub (&hashtblP->num_elements, 1);
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
-    }
-
-    prevnode = node;
-    node = node->next;
+  hashtable_rehash_step (hashtblP);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hashtblP->hashfunc (keyP), keyP);
+
+  if (link) {
+    node = *link;
+    *link = node->next;
+    *dataP = node->data;
+    free_wrapper ((void**)&node);
+    hashtblP->num_elements -= 1;
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_OK;
   }
 
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
@@ -915,38 +1187,38 @@ hashtable_ts_remove (
   const hash_key_t keyP,
   void **dataP)
 {
-  hash_node_t                            *node,
-                                         *prevnode = NULL;
+  hash_node_t                            *node = NULL;
+  hash_node_t                           **link = NULL;
   hash_size_t                             hash = 0;
+  pthread_mutex_t                        *lock = NULL;
+  bool                                    rehashed = false;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      if (prevnode)
-        prevnode->next = node->next;
-      else
-        hashtblP->nodes[hash] = node->next;
-
-      *dataP = node->data;
-      free_wrapper ((void**)&node);
-      __sync_fetch_and_sub (&hashtblP->num_elements, 1);
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
-    }
-
-    prevnode = node;
-    node = node->next;
+  hash = hashtblP->hashfunc (keyP);
+  lock = hashtable_ts_lock_of (hashtblP, hash);
+  pthread_mutex_lock(lock);
+  rehashed = hashtable_ts_rehash_step (hashtblP, hash % hashtblP->num_lock_nodes);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hash, keyP);
+
+  if (link) {
+    node = *link;
+    *link = node->next;
+    *dataP = node->data;
+    free_wrapper ((void**)&node);
+    __sync_fetch_and_sub (&hashtblP->num_elements, 1);
   }
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
+  pthread_mutex_unlock(lock);
 
+  if (rehashed) {
+    hashtable_ts_rehash_end (hashtblP);
+  }
+  if (link) {
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_OK;
+  }
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
@@ -956,6 +1228,7 @@ hashtable_ts_remove (
 /*
    Searching for an element is easy. We just search through the linked list for the corresponding hash value.
    NULL is returned if we didn't find it.
+   A resize in progress is advanced by lookups too, the table is not modified from the caller's point of view.
 */
 hashtable_rc_t
 hashtable_get (
@@ -963,25 +1236,20 @@ hashtable_get (
   const hash_key_t keyP,
   void **dataP)
 {
-  hash_node_t                            *node = NULL;
-  hash_size_t                             hash = 0;
+  hash_node_t                           **link = NULL;
 
   *dataP = NULL;
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  node = hashtblP->nodes[hash];
+  hashtable_rehash_step ((hash_table_t *)hashtblP);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hashtblP->hashfunc (keyP), keyP);
 
-  while (node) {
-    if (node->key == keyP) {
-      *dataP = node->data;
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, *dataP);
-      return HASH_TABLE_OK;
-    }
-
-    node = node->next;
+  if (link) {
+    *dataP = (*link)->data;
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, *dataP);
+    return HASH_TABLE_OK;
   }
 
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
@@ -993,6 +1261,7 @@ hashtable_get (
 /*
    Searching for an element is easy. We just search through the linked list for the corresponding hash value.
    NULL is returned if we didn't find it.
+   A resize in progress is advanced by lookups too, the table is not modified from the caller's point of view.
 */
 hashtable_rc_t
 hashtable_ts_get (
@@ -1000,30 +1269,34 @@ hashtable_ts_get (
   const hash_key_t keyP,
   void **dataP)
 {
-  hash_node_t                            *node = NULL;
+  hash_node_t                           **link = NULL;
   hash_size_t                             hash = 0;
+  pthread_mutex_t                        *lock = NULL;
+  bool                                    rehashed = false;
 
   *dataP = NULL;
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
+  hash = hashtblP->hashfunc (keyP);
+  lock = hashtable_ts_lock_of (hashtblP, hash);
 
-  while (node) {
-    if (node->key == keyP) {
-      *dataP = node->data;
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, *dataP);
-      return HASH_TABLE_OK;
-    }
+  pthread_mutex_lock(lock);
+  rehashed = hashtable_ts_rehash_step ((hash_table_ts_t *)hashtblP, hash % hashtblP->num_lock_nodes);
+  link = hashtable_find (hashtblP->nodes, hashtblP->size, hashtblP->old_nodes, hashtblP->old_size, hash, keyP);
+  if (link) {
+    *dataP = (*link)->data;
+  }
+  pthread_mutex_unlock(lock);
 
-    node = node->next;
+  if (rehashed) {
+    hashtable_ts_rehash_end ((hash_table_ts_t *)hashtblP);
+  }
+  if (link) {
+    PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, *dataP);
+    return HASH_TABLE_OK;
   }
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
@@ -1032,12 +1305,10 @@ hashtable_ts_get (
 /*
    Resizing
    The number of elements in a hash table is not always known when creating the table.
-   If the number of elements grows too large, it will seriously reduce the performance of most hash table operations.
-   If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
+   Tables grow incrementally when their load factor exceeds HASHTABLE_MAX_LOAD_FACTOR, but if the number of elements
+   is reduced the hash table will waste memory, or the final size may be known in advance. That is why we provide a function for resizing the table.
    Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
-   We create a temporary hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
+   All nodes (including those of a pending incremental resize) are moved at once to the new bucket array.
 */
 
 hashtable_rc_t
@@ -1045,52 +1316,33 @@ hashtable_resize (
   hash_table_t * const hashtblP,
   const hash_size_t sizeP)
 {
-  hash_table_t                            newtbl;
-  hash_size_t                             n;
-  hash_node_t                            *node,
-                                         *next;
-  void                                   *dummy = NULL;
+  hash_node_t                           **nodes = NULL;
+  hash_size_t                             size = 0;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
-  hash_size_t size = sizeP;
-  // upper power of two: http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2Float
-  //  By Sean Eron Anderson
-  // seander@cs.stanford.edu
-  // Individually, the code snippets here are in the public domain (unless otherwise noted) — feel free to use them however you please.
-  // The aggregate collection and descriptions are © 1997-2005 Sean Eron Anderson. The code and descriptions are distributed in the hope
-  // that they will be useful, but WITHOUT ANY WARRANTY and without even the implied warranty of merchantability or fitness for a particular
-  // purpose. As of May 5, 2005, all the code has been tested thoroughly. Thousands of people have read it. Moreover, Professor Randal Bryant,
-  // the Dean of Computer Science at Carnegie Mellon University, has personally tested almost everything with his Uclid code verification system.
-  // What he hasn't tested, I have checked against all possible inputs on a 32-bit machine. To the first person to inform me of a legitimate bug
-  // in the code, I'll pay a bounty of US$10 (by check or Paypal). If directed to a charity, I'll pay US$20.
-  size--;
-  size |= size >> 1;
-  size |= size >> 2;
-  size |= size >> 4;
-  size |= size >> 8;
-  size |= size >> 16;
-  size++;
-
-  newtbl.size = size;
-  newtbl.hashfunc = hashtblP->hashfunc;
-
-  if (!(newtbl.nodes = calloc (size, sizeof (hash_node_t *))))
-    return -1;
+  size = hashtable_size_roundup (sizeP);
 
+  if (!(nodes = calloc (size, sizeof (hash_node_t *))))
+    return HASH_TABLE_SYSTEM_ERROR;
 
-  for (n = 0; n < hashtblP->size; ++n) {
-    for (node = hashtblP->nodes[n]; node; node = next) {
-      next = node->next;
-      hashtable_remove (hashtblP, node->key, &dummy);
-      hashtable_insert (&newtbl, node->key, node->data);
+  for (hash_size_t n = 0; n < hashtblP->size; ++n) {
+    hashtable_move_chain (hashtblP->nodes[n], nodes, size, hashtblP->hashfunc);
+  }
+  if (hashtblP->old_nodes) {
+    for (hash_size_t n = 0; n < hashtblP->old_size; ++n) {
+      hashtable_move_chain (hashtblP->old_nodes[n], nodes, size, hashtblP->hashfunc);
     }
+    free_wrapper ((void**)&hashtblP->old_nodes);
+    hashtblP->old_size = 0;
+    hashtblP->rehash_index = 0;
   }
 
   free_wrapper ((void**)&hashtblP->nodes);
-  hashtblP->nodes = newtbl.nodes;
-  hashtblP->size = newtbl.size;
+  hashtblP->nodes = nodes;
+  hashtblP->size = size;
+  hashtblP->num_resizes += 1;
   return HASH_TABLE_OK;
 }
 
@@ -1099,13 +1351,9 @@ hashtable_resize (
 /*
    Resizing
    The number of elements in a hash table is not always known when creating the table.
-   If the number of elements grows too large, it will seriously reduce the performance of most hash table operations.
-   If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
-   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
-   We create a temporary hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
-   Dangerous not really thread safe.
+   Tables grow incrementally when their load factor exceeds HASHTABLE_MAX_LOAD_FACTOR, but if the number of elements
+   is reduced the hash table will waste memory, or the final size may be known in advance. That is why we provide a function for resizing the table.
+   The table is locked during the whole operation. The number of buckets cannot go below the number of bucket locks.
 */
 
 hashtable_rc_t
@@ -1113,62 +1361,133 @@ hashtable_ts_resize (
   hash_table_ts_t * const hashtblP,
   const hash_size_t sizeP)
 {
-  hash_table_ts_t                         newtbl = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0};
-  hash_size_t                             n      = 0;
-  hash_node_t                            *node   = NULL,
-                                         *next   = NULL;
-  void                                   *dummy  = NULL;
+  hash_node_t                           **nodes = NULL;
+  hash_size_t                             size = 0;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
-  hash_size_t size = sizeP;
-  // upper power of two: http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2Float
-  //  By Sean Eron Anderson
-  // seander@cs.stanford.edu
-  // Individually, the code snippets here are in the public domain (unless otherwise noted) — feel free to use them however you please.
-  // The aggregate collection and descriptions are © 1997-2005 Sean Eron Anderson. The code and descriptions are distributed in the hope
-  // that they will be useful, but WITHOUT ANY WARRANTY and without even the implied warranty of merchantability or fitness for a particular
-  // purpose. As of May 5, 2005, all the code has been tested thoroughly. Thousands of people have read it. Moreover, Professor Randal Bryant,
-  // the Dean of Computer Science at Carnegie Mellon University, has personally tested almost everything with his Uclid code verification system.
-  // What he hasn't tested, I have checked against all possible inputs on a 32-bit machine. To the first person to inform me of a legitimate bug
-  // in the code, I'll pay a bounty of US$10 (by check or Paypal). If directed to a charity, I'll pay US$20.
-  size--;
-  size |= size >> 1;
-  size |= size >> 2;
-  size |= size >> 4;
-  size |= size >> 8;
-  size |= size >> 16;
-  size++;
-
-  newtbl.size = size;
-  newtbl.hashfunc = hashtblP->hashfunc;
-
-  if (!(newtbl.nodes = calloc (size, sizeof (hash_node_t *))))
-    return HASH_TABLE_SYSTEM_ERROR;
+  size = hashtable_size_roundup (sizeP);
+  if (size < hashtblP->num_lock_nodes) {
+    size = hashtblP->num_lock_nodes;
+  }
 
-  if (!(newtbl.lock_nodes = calloc (size, sizeof (pthread_mutex_t)))) {
-    free_wrapper ((void**)&newtbl.nodes);
+  if (!(nodes = calloc (size, sizeof (hash_node_t *))))
     return HASH_TABLE_SYSTEM_ERROR;
-  }
-  for (n = 0; n < hashtblP->size; ++n) {
-    pthread_mutex_init(&newtbl.lock_nodes[n], NULL);
-  }
 
   pthread_mutex_lock(&hashtblP->mutex);
-  for (n = 0; n < hashtblP->size; ++n) {
-    for (node = hashtblP->nodes[n]; node; node = next) {
-      next = node->next;
-      hashtable_ts_remove (hashtblP, node->key, &dummy);
-      hashtable_ts_insert (&newtbl, node->key, node->data);
+  hashtable_ts_lock_all (hashtblP);
+  for (hash_size_t n = 0; n < hashtblP->size; ++n) {
+    hashtable_move_chain (hashtblP->nodes[n], nodes, size, hashtblP->hashfunc);
+  }
+  if (hashtblP->old_nodes) {
+    for (hash_size_t n = 0; n < hashtblP->old_size; ++n) {
+      hashtable_move_chain (hashtblP->old_nodes[n], nodes, size, hashtblP->hashfunc);
     }
+    free_wrapper ((void**)&hashtblP->old_nodes);
+    hashtblP->old_size = 0;
   }
 
   free_wrapper ((void**)&hashtblP->nodes);
-  free_wrapper ((void**)&hashtblP->lock_nodes);
-  hashtblP->size = newtbl.size;
-  hashtblP->nodes = newtbl.nodes;
-  hashtblP->lock_nodes = newtbl.lock_nodes;
+  hashtblP->nodes = nodes;
+  hashtblP->size = size;
+  hashtblP->num_resizes += 1;
+  hashtable_ts_unlock_all (hashtblP);
   pthread_mutex_unlock(&hashtblP->mutex);
   return HASH_TABLE_OK;
 }
+
+//------------------------------------------------------------------------------
+static void hashtable_stats_add_buckets (hash_node_t ** const nodesP, const hash_size_t fromP, const hash_size_t toP, const hash_size_t strideP, hashtable_stats_t * const statsP)
+{
+  hash_node_t                            *node = NULL;
+  hash_size_t                             length = 0;
+
+  for (hash_size_t n = fromP; n < toP; n += strideP) {
+    length = 0;
+    for (node = nodesP[n]; node; node = node->next) {
+      length++;
+    }
+    if (length) {
+      statsP->num_used_buckets += 1;
+      statsP->num_elements += length;
+      if (length > statsP->max_chain_length) {
+        statsP->max_chain_length = length;
+      }
+    }
+    statsP->chain_length_histogram[(length < HASHTABLE_STATS_CHAIN_LENGTH_MAX) ? length:HASHTABLE_STATS_CHAIN_LENGTH_MAX] += 1;
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+   Statistics
+   hashtable_get_stats() walks through all buckets to report the occupancy and the chain length distribution of the table.
+   The cost is linear in the number of buckets, it is intended for monitoring, not for the data path.
+*/
+hashtable_rc_t
+hashtable_get_stats (
+  const hash_table_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  memset (statsP, 0, sizeof (*statsP));
+  statsP->size = hashtblP->size;
+  statsP->num_resizes = hashtblP->num_resizes;
+  statsP->is_resizing = (hashtblP->old_nodes != NULL);
+  hashtable_stats_add_buckets (hashtblP->nodes, 0, hashtblP->size, 1, statsP);
+  if (hashtblP->old_nodes) {
+    hashtable_stats_add_buckets (hashtblP->old_nodes, 0, hashtblP->old_size, 1, statsP);
+  }
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t
+hashtable_ts_get_stats (
+  hash_table_ts_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  memset (statsP, 0, sizeof (*statsP));
+  pthread_mutex_lock (&hashtblP->mutex);
+  statsP->size = hashtblP->size;
+  statsP->num_resizes = hashtblP->num_resizes;
+  statsP->is_resizing = (hashtblP->old_nodes != NULL);
+  for (hash_size_t stripe = 0; stripe < hashtblP->num_lock_nodes; stripe++) {
+    pthread_mutex_lock (&hashtblP->lock_nodes[stripe]);
+    hashtable_stats_add_buckets (hashtblP->nodes, stripe, hashtblP->size, hashtblP->num_lock_nodes, statsP);
+    if (hashtblP->old_nodes) {
+      hashtable_stats_add_buckets (hashtblP->old_nodes, stripe, hashtblP->old_size, hashtblP->num_lock_nodes, statsP);
+    }
+    pthread_mutex_unlock (&hashtblP->lock_nodes[stripe]);
+  }
+  pthread_mutex_unlock (&hashtblP->mutex);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t
+hashtable_dump_stats (
+  const hashtable_stats_t * const statsP,
+  bstring str)
+{
+  if (!statsP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  bformata (str, "elements %zu buckets %zu load %.2f used buckets %zu avg chain %.2f max chain %zu resizes %zu%s\nchain lengths:",
+      statsP->num_elements, statsP->size,
+      (statsP->size) ? (double)statsP->num_elements / (double)statsP->size : 0.0,
+      statsP->num_used_buckets,
+      (statsP->num_used_buckets) ? (double)statsP->num_elements / (double)statsP->num_used_buckets : 0.0,
+      statsP->max_chain_length, statsP->num_resizes, (statsP->is_resizing) ? " (resizing)":"");
+  for (int i = 0; i <= HASHTABLE_STATS_CHAIN_LENGTH_MAX; i++) {
+    bformata (str, " [%d%s]=%zu", i, (i == HASHTABLE_STATS_CHAIN_LENGTH_MAX) ? "+":"", statsP->chain_length_histogram[i]);
+  }
+  bcatcstr (str, "\n");
+  return HASH_TABLE_OK;
+}
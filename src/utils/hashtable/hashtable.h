@@ -49,6 +49,25 @@ typedef enum hashtable_return_code_e {
 #define HASH_TABLE_DEFAULT_HASH_FUNC NULL
 #define HASH_TABLE_DEFAULT_free_wrapper_FUNC NULL
 
+// hash_table_t and hash_table_ts_t double their number of buckets when num_elements exceeds HASHTABLE_MAX_LOAD_FACTOR * size,
+// the buckets of the previous array are then migrated HASHTABLE_REHASH_STEP at a time by the following operations.
+#define HASHTABLE_MAX_LOAD_FACTOR        1
+#define HASHTABLE_REHASH_STEP            4
+// chain lengths >= HASHTABLE_STATS_CHAIN_LENGTH_MAX are accounted in the last entry of the histogram
+#define HASHTABLE_STATS_CHAIN_LENGTH_MAX 8
+
+//------------------------------------------------------------------------------
+// 64 bits finalizer of MurmurHash3, every bit of the key affects every bit of the hash.
+static inline hash_size_t hashtable_mix64 (uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return (hash_size_t)key;
+}
+
 
 typedef struct hash_node_s {
     hash_key_t          key;
@@ -71,6 +90,10 @@ typedef struct hash_table_s {
     bstring             name;
     bool                is_allocated_by_malloc;
     bool                log_enabled;
+    struct hash_node_s **old_nodes;            // previous buckets while an incremental resize is in progress
+    hash_size_t         old_size;
+    hash_size_t         rehash_index;          // next bucket of old_nodes to migrate
+    hash_size_t         num_resizes;
 } hash_table_t;
 
 typedef struct hash_table_ts_s {
@@ -84,6 +107,13 @@ typedef struct hash_table_ts_s {
     bstring             name;
     bool                is_allocated_by_malloc;
     bool                log_enabled;
+    hash_size_t         num_lock_nodes;        // fixed at init, bucket n is protected by lock_nodes[n % num_lock_nodes]
+    struct hash_node_s **old_nodes;            // previous buckets while an incremental resize is in progress
+    hash_size_t         old_size;
+    hash_size_t        *stripe_rehash_index;   // per lock, next bucket of old_nodes to migrate
+    hash_size_t         num_rehashed_stripes;
+    hash_size_t         rehash_cursor;
+    hash_size_t         num_resizes;
 } hash_table_ts_t;
 
 typedef struct hash_table_uint64_s {
@@ -111,13 +141,25 @@ typedef struct hash_table_uint64_ts_s {
 typedef struct hashtable_key_array_s {
     int                 num_keys;
     hash_key_t         *keys;
+    int                 capacity;
 } hashtable_key_array_t;
 
 typedef struct hashtable_element_array_s {
     int                 num_elements;
     void              **elements;
+    int                 capacity;
 } hashtable_element_array_t;
 
+typedef struct hashtable_stats_s {
+    hash_size_t         size;
+    hash_size_t         num_elements;
+    hash_size_t         num_used_buckets;
+    hash_size_t         max_chain_length;
+    hash_size_t         chain_length_histogram[HASHTABLE_STATS_CHAIN_LENGTH_MAX + 1]; // number of buckets per chain length
+    hash_size_t         num_resizes;
+    bool                is_resizing;
+} hashtable_stats_t;
+
 typedef struct hashtable_uint64_element_array_s {
     int                 num_elements;
     uint64_t           *elements;
@@ -139,6 +181,8 @@ hashtable_rc_t  hashtable_free (hash_table_t * const hashtbl, const hash_key_t k
 hashtable_rc_t  hashtable_remove(hash_table_t * const hashtbl, const hash_key_t key, void** element);
 hashtable_rc_t  hashtable_get    (const hash_table_t * const hashtbl, const hash_key_t key, void **element) __attribute__ ((hot));
 hashtable_rc_t  hashtable_resize (hash_table_t * const hashtbl, const hash_size_t size);
+hashtable_rc_t  hashtable_get_stats (const hash_table_t * const hashtbl, hashtable_stats_t * const stats);
+hashtable_rc_t  hashtable_dump_stats (const hashtable_stats_t * const stats, bstring str);
 
 // Thread-safe functions
 hash_table_ts_t * hashtable_ts_init (hash_table_ts_t * const hashtbl,const hash_size_t size,hash_size_t (*hashfunc) (const hash_key_t),void (*freefunc) (void **),bstring display_name_p);
@@ -157,6 +201,7 @@ hashtable_rc_t  hashtable_ts_free (hash_table_ts_t * const hashtbl, const hash_k
 hashtable_rc_t  hashtable_ts_remove(hash_table_ts_t * const hashtbl, const hash_key_t key, void** element);
 hashtable_rc_t  hashtable_ts_get    (const hash_table_ts_t * const hashtbl, const hash_key_t key, void **element) __attribute__ ((hot));
 hashtable_rc_t  hashtable_ts_resize (hash_table_ts_t * const hashtbl, const hash_size_t size);
+hashtable_rc_t  hashtable_ts_get_stats (hash_table_ts_t * const hashtbl, hashtable_stats_t * const stats);
 
 hash_table_uint64_ts_t * hashtable_uint64_ts_init (hash_table_uint64_ts_t * const hashtbl, const hash_size_t size, hash_size_t (*hashfunc) (const hash_key_t),bstring display_name_p);
 __attribute__ ((malloc)) hash_table_uint64_ts_t   *hashtable_uint64_ts_create (const hash_size_t   size, hash_size_t (*hashfunc)(const hash_key_t ), bstring name_p);
@@ -50,12 +50,12 @@
 /*
    Default hash function
    def_hashfunc() is the default used by hashtable_uint64_create() when the user didn't specify one.
-   This is a simple/naive hash function which adds the key's ASCII char values. It will probably generate lots of collisions on large hash tables.
+   The key is passed through a 64 bits finalizer so that structured keys are spread over all the buckets.
 */
 
 static inline hash_size_t def_hashfunc (const uint64_t keyP)
 {
-  return (hash_size_t) keyP;
+  return hashtable_mix64 (keyP);
 }
 
 //------------------------------------------------------------------------------
@@ -181,7 +181,7 @@ hash_table_uint64_ts_t * hashtable_uint64_ts_init (hash_table_uint64_ts_t * cons
   }
 
   pthread_mutex_init(&hashtblP->mutex, NULL);
-  for (int i = 0; i < size; i++) {
+  for (hash_size_t i = 0; i < size; i++) {
     pthread_mutex_init(&hashtblP->lock_nodes[i], NULL);
   }
 
@@ -418,7 +418,7 @@ hashtable_key_array_t * hashtable_uint64_ts_get_keys (hash_table_uint64_ts_t * c
   ka = calloc(1, sizeof(hashtable_key_array_t));
   ka->keys = calloc(hashtblP->num_elements, sizeof(hash_key_t*));
 
-  while ((ka->num_keys < hashtblP->num_elements) && (i < hashtblP->size)) {
+  while (((hash_size_t)ka->num_keys < hashtblP->num_elements) && (i < hashtblP->size)) {
     pthread_mutex_lock(&hashtblP->lock_nodes[i]);
     if (hashtblP->nodes[i] != NULL) {
       node = hashtblP->nodes[i];
@@ -448,7 +448,7 @@ hashtable_uint64_element_array_t * hashtable_uint64_ts_get_elements (hash_table_
   ea = calloc(1, sizeof(hashtable_uint64_element_array_t));
   ea->elements = calloc(hashtblP->num_elements, sizeof(uint64_t*));
 
-  while ((ea->num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
+  while (((hash_size_t)ea->num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
     pthread_mutex_lock(&hashtblP->lock_nodes[i]);
     if (hashtblP->nodes[i] != NULL) {
       node = hashtblP->nodes[i];
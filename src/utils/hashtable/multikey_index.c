@@ -0,0 +1,494 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file multikey_index.c
+  \brief Concurrent open addressing index holding several key spaces in one table.
+*/
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "bstrlib.h"
+
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
+#include "multikey_index.h"
+#include "assertions.h"
+#include "log.h"
+
+/* Resize (or purge deleted slots) when used plus deleted slots exceed 3/4 of the
+ * slots, rebuild for live keys at 1/2 of the slots. */
+#define MKI_MAX_LOAD_NUM     3
+#define MKI_MAX_LOAD_DEN     4
+#define MKI_SLOT_EXT(kEySpAcE, kEyExT) (((uint32_t)(kEySpAcE) << 24) | ((kEyExT) & MULTIKEY_INDEX_KEY_EXT_MASK))
+
+static int                              mki_nb_readers = 0;
+static __thread int                     mki_reader_id = -1;
+
+//------------------------------------------------------------------------------
+static inline uint64_t mki_hash (const uint64_t key, const uint32_t slot_ext)
+{
+  // splitmix64 finalizer, keys of different spaces are spread independently
+  uint64_t x = key + (uint64_t)slot_ext * 0x9E3779B97F4A7C15ULL;
+
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return x;
+}
+
+//------------------------------------------------------------------------------
+static inline void mki_cpu_relax (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause ();
+#else
+  sched_yield ();
+#endif
+}
+
+//------------------------------------------------------------------------------
+static multikey_index_reader_t *mki_read_lock (multikey_index_t * const mki)
+{
+  multikey_index_reader_t                *reader = NULL;
+
+  if (0 > mki_reader_id) {
+    mki_reader_id = __sync_fetch_and_add (&mki_nb_readers, 1);
+  }
+  if (MULTIKEY_INDEX_MAX_READERS <= mki_reader_id) {
+    pthread_mutex_lock (&mki->mutex);
+    return NULL;
+  }
+  reader = &mki->readers[mki_reader_id];
+  // Publish the epoch before loading the table pointer, see mki_synchronize()
+  __atomic_store_n (&reader->epoch, __atomic_load_n (&mki->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+  return reader;
+}
+
+//------------------------------------------------------------------------------
+static void mki_read_unlock (multikey_index_t * const mki, multikey_index_reader_t * const reader)
+{
+  if (reader) {
+    __atomic_store_n (&reader->epoch, 0, __ATOMIC_RELEASE);
+  } else {
+    pthread_mutex_unlock (&mki->mutex);
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+   Waits for a grace period: every reader that may still use a table unpublished
+   before this call has left its read section. Called with the writer lock held.
+*/
+static void mki_synchronize (multikey_index_t * const mki)
+{
+  uint64_t                                epoch = __atomic_add_fetch (&mki->epoch, 1, __ATOMIC_SEQ_CST);
+
+  for (int i = 0; i < MULTIKEY_INDEX_MAX_READERS; i++) {
+    uint64_t                              reader_epoch = 0;
+
+    while ((reader_epoch = __atomic_load_n (&mki->readers[i].epoch, __ATOMIC_SEQ_CST)) && (reader_epoch < epoch)) {
+      mki_cpu_relax ();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static multikey_index_table_t *mki_table_create (const hash_size_t nb_buckets)
+{
+  multikey_index_table_t                 *table = calloc (1, sizeof (multikey_index_table_t));
+
+  if (!table) {
+    return NULL;
+  }
+  if (posix_memalign ((void **)&table->buckets, 64, nb_buckets * sizeof (multikey_index_bucket_t))) {
+    free_wrapper ((void **)&table);
+    return NULL;
+  }
+  memset (table->buckets, 0, nb_buckets * sizeof (multikey_index_bucket_t));
+  table->nb_buckets = nb_buckets;
+  table->mask = nb_buckets - 1;
+  return table;
+}
+
+//------------------------------------------------------------------------------
+static void mki_table_destroy (multikey_index_table_t * table)
+{
+  if (table) {
+    free (table->buckets);
+    free_wrapper ((void **)&table);
+  }
+}
+
+//------------------------------------------------------------------------------
+static hash_size_t mki_nb_buckets_for (const hash_size_t nb_keys)
+{
+  hash_size_t                             nb_buckets = 1;
+
+  // Live keys at most at half of the slots
+  while ((nb_buckets * MULTIKEY_INDEX_SLOTS_PER_BUCKET) < (2 * nb_keys)) {
+    nb_buckets <<= 1;
+  }
+  return nb_buckets;
+}
+
+//------------------------------------------------------------------------------
+static inline void mki_bucket_write_begin (multikey_index_bucket_t * const bucket)
+{
+  __atomic_store_n (&bucket->version, bucket->version + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+static inline void mki_bucket_write_end (multikey_index_bucket_t * const bucket)
+{
+  __atomic_store_n (&bucket->version, bucket->version + 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+/*
+   Writer side probe (writer lock held): returns the bucket holding the live key
+   and its slot, or NULL and the first reusable slot of the probe sequence.
+*/
+static multikey_index_bucket_t *mki_find (
+  const multikey_index_table_t * const table,
+  const uint64_t key,
+  const uint32_t slot_ext,
+  int * const slot,
+  multikey_index_bucket_t ** const free_bucket,
+  int * const free_slot)
+{
+  hash_size_t                             b = mki_hash (key, slot_ext) & table->mask;
+
+  *free_bucket = NULL;
+  for (hash_size_t probe = 0; probe < table->nb_buckets; probe++, b = (b + 1) & table->mask) {
+    multikey_index_bucket_t              *bucket = &table->buckets[b];
+
+    for (int i = 0; i < MULTIKEY_INDEX_SLOTS_PER_BUCKET; i++) {
+      if (!bucket->key_ext[i]) {
+        if (!*free_bucket) {
+          *free_bucket = bucket;
+          *free_slot = i;
+        }
+        return NULL;
+      }
+      if (!bucket->value[i]) {
+        if (!*free_bucket) {
+          *free_bucket = bucket;
+          *free_slot = i;
+        }
+      } else if ((bucket->key_ext[i] == slot_ext) && (bucket->key[i] == key)) {
+        *slot = i;
+        return bucket;
+      }
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+/*
+   Rebuilds the table for the current number of live keys, which also drops the
+   deleted slots, then publishes it and frees the old one after a grace period.
+*/
+static hashtable_rc_t mki_resize (multikey_index_t * const mki)
+{
+  multikey_index_table_t                 *old_table = mki->table;
+  multikey_index_table_t                 *new_table = NULL;
+  const hash_size_t                       old_nb_buckets = old_table->nb_buckets;
+  hash_size_t                             nb_buckets = mki_nb_buckets_for (mki->num_elements + 1);
+
+  if (nb_buckets < mki->min_buckets) {
+    nb_buckets = mki->min_buckets;
+  }
+  if (!(new_table = mki_table_create (nb_buckets))) {
+    return HASH_TABLE_SYSTEM_ERROR;
+  }
+
+  for (hash_size_t b = 0; b < old_table->nb_buckets; b++) {
+    const multikey_index_bucket_t        *bucket = &old_table->buckets[b];
+
+    for (int i = 0; i < MULTIKEY_INDEX_SLOTS_PER_BUCKET; i++) {
+      if (bucket->value[i]) {
+        multikey_index_bucket_t          *free_bucket = NULL;
+        int                               free_slot = 0;
+        int                               slot = 0;
+
+        mki_find (new_table, bucket->key[i], bucket->key_ext[i], &slot, &free_bucket, &free_slot);
+        free_bucket->key_ext[free_slot] = bucket->key_ext[i];
+        free_bucket->key[free_slot] = bucket->key[i];
+        free_bucket->value[free_slot] = bucket->value[i];
+      }
+    }
+  }
+
+  __atomic_store_n (&mki->table, new_table, __ATOMIC_SEQ_CST);
+  mki->num_deleted = 0;
+  mki->num_resizes += 1;
+  mki_synchronize (mki);
+  mki_table_destroy (old_table);
+  OAILOG_DEBUG (LOG_UTIL, "%s: rebuilt from %zu to %zu buckets for %zu keys\n",
+      bdata (mki->name), old_nb_buckets, nb_buckets, mki->num_elements);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+multikey_index_t *multikey_index_create (const hash_size_t size, bstring name_p)
+{
+  multikey_index_t                       *mki = NULL;
+
+  if (posix_memalign ((void **)&mki, 64, sizeof (multikey_index_t))) {
+    return NULL;
+  }
+  memset (mki, 0, sizeof (*mki));
+  mki->min_buckets = mki_nb_buckets_for (size ? size : 1);
+  if (!(mki->table = mki_table_create (mki->min_buckets))) {
+    free (mki);
+    return NULL;
+  }
+  pthread_mutex_init (&mki->mutex, NULL);
+  mki->epoch = 1;
+  if (name_p) {
+    mki->name = bstrcpy (name_p);
+  } else {
+    mki->name = bformat ("multikey_index@%p", mki);
+  }
+  return mki;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t multikey_index_destroy (multikey_index_t * const mki)
+{
+  if (!mki) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  pthread_mutex_lock (&mki->mutex);
+  mki_synchronize (mki);
+  mki_table_destroy (mki->table);
+  mki->table = NULL;
+  bdestroy_wrapper (&mki->name);
+  pthread_mutex_unlock (&mki->mutex);
+  pthread_mutex_destroy (&mki->mutex);
+  free (mki);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t multikey_index_insert (
+  multikey_index_t * const mki,
+  const uint8_t key_space,
+  const uint64_t key,
+  const uint32_t key_ext,
+  void *value)
+{
+  const uint32_t                          slot_ext = MKI_SLOT_EXT (key_space, key_ext);
+  multikey_index_bucket_t                *bucket = NULL;
+  multikey_index_bucket_t                *free_bucket = NULL;
+  int                                     slot = 0;
+  int                                     free_slot = 0;
+  hashtable_rc_t                          rc = HASH_TABLE_OK;
+
+  if (!mki) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  if ((!key_space) || (!value)) {
+    return HASH_TABLE_BAD_PARAMETER_KEY;
+  }
+  pthread_mutex_lock (&mki->mutex);
+  if (((mki->num_elements + mki->num_deleted + 1) * MKI_MAX_LOAD_DEN) >
+      (mki->table->nb_buckets * MULTIKEY_INDEX_SLOTS_PER_BUCKET * MKI_MAX_LOAD_NUM)) {
+    if (HASH_TABLE_OK != (rc = mki_resize (mki))) {
+      pthread_mutex_unlock (&mki->mutex);
+      return rc;
+    }
+  }
+
+  if ((bucket = mki_find (mki->table, key, slot_ext, &slot, &free_bucket, &free_slot))) {
+    mki_bucket_write_begin (bucket);
+    __atomic_store_n (&bucket->value[slot], value, __ATOMIC_RELAXED);
+    mki_bucket_write_end (bucket);
+    rc = HASH_TABLE_INSERT_OVERWRITTEN_DATA;
+  } else {
+    if (free_bucket->key_ext[free_slot]) {
+      mki->num_deleted -= 1;
+    }
+    mki_bucket_write_begin (free_bucket);
+    __atomic_store_n (&free_bucket->key_ext[free_slot], slot_ext, __ATOMIC_RELAXED);
+    __atomic_store_n (&free_bucket->key[free_slot], key, __ATOMIC_RELAXED);
+    __atomic_store_n (&free_bucket->value[free_slot], value, __ATOMIC_RELAXED);
+    mki_bucket_write_end (free_bucket);
+    mki->num_elements += 1;
+  }
+  pthread_mutex_unlock (&mki->mutex);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t multikey_index_remove (
+  multikey_index_t * const mki,
+  const uint8_t key_space,
+  const uint64_t key,
+  const uint32_t key_ext,
+  void **value)
+{
+  const uint32_t                          slot_ext = MKI_SLOT_EXT (key_space, key_ext);
+  multikey_index_bucket_t                *bucket = NULL;
+  multikey_index_bucket_t                *free_bucket = NULL;
+  int                                     slot = 0;
+  int                                     free_slot = 0;
+
+  if (!mki) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  pthread_mutex_lock (&mki->mutex);
+  if (!(bucket = mki_find (mki->table, key, slot_ext, &slot, &free_bucket, &free_slot))) {
+    pthread_mutex_unlock (&mki->mutex);
+    return HASH_TABLE_KEY_NOT_EXISTS;
+  }
+  if (value) {
+    *value = bucket->value[slot];
+  }
+  // The key stays in place as a deleted slot so that probe sequences are not cut
+  mki_bucket_write_begin (bucket);
+  __atomic_store_n (&bucket->value[slot], NULL, __ATOMIC_RELAXED);
+  mki_bucket_write_end (bucket);
+  mki->num_elements -= 1;
+  mki->num_deleted += 1;
+  pthread_mutex_unlock (&mki->mutex);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t multikey_index_get (
+  multikey_index_t * const mki,
+  const uint8_t key_space,
+  const uint64_t key,
+  const uint32_t key_ext,
+  void **value)
+{
+  const uint32_t                          slot_ext = MKI_SLOT_EXT (key_space, key_ext);
+  multikey_index_reader_t                *reader = NULL;
+  const multikey_index_table_t           *table = NULL;
+  void                                   *found = NULL;
+  bool                                    end = false;
+  hash_size_t                             b = 0;
+
+  if (!mki) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  reader = mki_read_lock (mki);
+  table = __atomic_load_n (&mki->table, __ATOMIC_SEQ_CST);
+  b = mki_hash (key, slot_ext) & table->mask;
+
+  for (hash_size_t probe = 0; (probe < table->nb_buckets) && (!found) && (!end); probe++, b = (b + 1) & table->mask) {
+    const multikey_index_bucket_t        *bucket = &table->buckets[b];
+    uint32_t                              version = 0;
+
+    do {
+      while ((version = __atomic_load_n (&bucket->version, __ATOMIC_ACQUIRE)) & 1) {
+        mki_cpu_relax ();
+      }
+      found = NULL;
+      end = false;
+      for (int i = 0; i < MULTIKEY_INDEX_SLOTS_PER_BUCKET; i++) {
+        uint32_t                          ext = __atomic_load_n (&bucket->key_ext[i], __ATOMIC_RELAXED);
+
+        if (!ext) {
+          end = true;
+          break;
+        }
+        if ((ext == slot_ext) && (__atomic_load_n (&bucket->key[i], __ATOMIC_RELAXED) == key)) {
+          if ((found = __atomic_load_n (&bucket->value[i], __ATOMIC_RELAXED))) {
+            break;
+          }
+        }
+      }
+      __atomic_thread_fence (__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n (&bucket->version, __ATOMIC_RELAXED) != version);
+  }
+  mki_read_unlock (mki, reader);
+
+  if (value) {
+    *value = found;
+  }
+  return (found) ? HASH_TABLE_OK : HASH_TABLE_KEY_NOT_EXISTS;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t multikey_index_apply_callback_on_elements (
+  multikey_index_t * const mki,
+  const uint8_t key_space,
+  bool funct_cb (const hash_key_t keyP,
+               void * const dataP,
+               void *parameterP,
+               void ** resultP),
+  void *parameterP,
+  void **resultP)
+{
+  if (!mki) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  pthread_mutex_lock (&mki->mutex);
+  for (hash_size_t b = 0; b < mki->table->nb_buckets; b++) {
+    const multikey_index_bucket_t        *bucket = &mki->table->buckets[b];
+
+    for (int i = 0; i < MULTIKEY_INDEX_SLOTS_PER_BUCKET; i++) {
+      if ((bucket->value[i]) && ((!key_space) || ((bucket->key_ext[i] >> 24) == key_space))) {
+        if (funct_cb (bucket->key[i], bucket->value[i], parameterP, resultP)) {
+          pthread_mutex_unlock (&mki->mutex);
+          return HASH_TABLE_OK;
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock (&mki->mutex);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+hashtable_rc_t multikey_index_dump_content (multikey_index_t * const mki, bstring str)
+{
+  if (!mki) {
+    bcatcstr (str, "HASH_TABLE_BAD_PARAMETER_HASHTABLE");
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+  pthread_mutex_lock (&mki->mutex);
+  bformata (str, "%s: %zu keys, %zu deleted, %zu buckets, %zu resizes\n", bdata (mki->name),
+      mki->num_elements, mki->num_deleted, mki->table->nb_buckets, mki->num_resizes);
+  for (hash_size_t b = 0; b < mki->table->nb_buckets; b++) {
+    const multikey_index_bucket_t        *bucket = &mki->table->buckets[b];
+
+    for (int i = 0; i < MULTIKEY_INDEX_SLOTS_PER_BUCKET; i++) {
+      if (bucket->value[i]) {
+        bformata (str, "Bucket %zu: space %u key 0x%" PRIx64 " ext 0x%06x -> %p\n", b,
+            bucket->key_ext[i] >> 24, bucket->key[i], bucket->key_ext[i] & MULTIKEY_INDEX_KEY_EXT_MASK, bucket->value[i]);
+      }
+    }
+  }
+  pthread_mutex_unlock (&mki->mutex);
+  return HASH_TABLE_OK;
+}
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file multikey_index.h
+  \brief Concurrent open addressing index holding several key spaces in one table.
+
+  Keys of different kinds (IMSI, TEIDs, S1AP ids, GUTI, ...) share a single
+  table of cache line sized buckets, so that any lookup touches O(1) cache
+  lines. Writers are serialized by a mutex; readers never lock: each bucket is
+  protected by a sequence counter and the bucket array is reclaimed only after
+  a grace period (epoch based), so a reader may always run concurrently with
+  inserts, removals and resizes.
+  The index does not own the values it stores.
+*/
+
+#ifndef FILE_MULTIKEY_INDEX_SEEN
+#define FILE_MULTIKEY_INDEX_SEEN
+
+#include "hashtable.h"
+
+#define MULTIKEY_INDEX_SLOTS_PER_BUCKET  3
+#define MULTIKEY_INDEX_MAX_READERS       64       /*!< \brief Threads beyond this number read under the writer lock */
+#define MULTIKEY_INDEX_KEY_EXT_MASK      0x00FFFFFF /*!< \brief Extra key bits available per key space */
+
+/*! \brief One cache line: sequence counter, then key spaces, keys and values of 3 slots.
+ *  A slot with key_ext 0 was never used (ends a probe sequence), a slot with
+ *  a non zero key_ext and a NULL value is a deleted slot.
+ */
+typedef struct multikey_index_bucket_s {
+  uint32_t                     version;
+  uint32_t                     key_ext[MULTIKEY_INDEX_SLOTS_PER_BUCKET];  // key space << 24 | extra key bits
+  uint64_t                     key[MULTIKEY_INDEX_SLOTS_PER_BUCKET];
+  void                        *value[MULTIKEY_INDEX_SLOTS_PER_BUCKET];
+} __attribute__((aligned(64))) multikey_index_bucket_t;
+
+typedef struct multikey_index_table_s {
+  hash_size_t                  nb_buckets;  // power of 2
+  hash_size_t                  mask;
+  multikey_index_bucket_t     *buckets;
+} multikey_index_table_t;
+
+typedef struct multikey_index_reader_s {
+  uint64_t                     epoch;       // 0 outside of a read section
+} __attribute__((aligned(64))) multikey_index_reader_t;
+
+typedef struct multikey_index_s {
+  pthread_mutex_t              mutex;       // serializes writers
+  multikey_index_table_t      *table;
+  uint64_t                     epoch;
+  hash_size_t                  num_elements;
+  hash_size_t                  num_deleted;
+  hash_size_t                  num_resizes;
+  hash_size_t                  min_buckets;
+  bstring                      name;
+  multikey_index_reader_t      readers[MULTIKEY_INDEX_MAX_READERS];
+} multikey_index_t;
+
+/** \brief Creates an index sized for size keys without resizing.
+ * \param size      Expected number of keys, all key spaces together.
+ * \param name_p    Display name, copied.
+ * @returns The index or NULL.
+ **/
+multikey_index_t *multikey_index_create (const hash_size_t size, bstring name_p);
+
+/** \brief Destroys the index, the values are left untouched.
+ **/
+hashtable_rc_t multikey_index_destroy (multikey_index_t * const mki);
+
+/** \brief Inserts or overwrites a key.
+ * \param key_space Non zero key space identifier (< 256).
+ * \param key_ext   Extra key bits (MULTIKEY_INDEX_KEY_EXT_MASK), 0 if unused.
+ * \param value     Non NULL value.
+ * @returns HASH_TABLE_OK or HASH_TABLE_INSERT_OVERWRITTEN_DATA.
+ **/
+hashtable_rc_t multikey_index_insert (multikey_index_t * const mki, const uint8_t key_space, const uint64_t key, const uint32_t key_ext, void *value);
+
+/** \brief Removes a key, returning its value in value if not NULL.
+ **/
+hashtable_rc_t multikey_index_remove (multikey_index_t * const mki, const uint8_t key_space, const uint64_t key, const uint32_t key_ext, void **value);
+
+/** \brief Lock-free lookup, may be called from any thread.
+ * @returns HASH_TABLE_OK and the value, or HASH_TABLE_KEY_NOT_EXISTS.
+ **/
+hashtable_rc_t multikey_index_get (multikey_index_t * const mki, const uint8_t key_space, const uint64_t key, const uint32_t key_ext, void **value) __attribute__ ((hot));
+
+/** \brief Calls funct_cb on every value of a key space (0 for all) under the writer lock,
+ *  stops when funct_cb returns true. funct_cb must not modify the index.
+ **/
+hashtable_rc_t multikey_index_apply_callback_on_elements (multikey_index_t * const mki,
+                                                          const uint8_t key_space,
+                                                          bool funct_cb (const hash_key_t keyP, void * const dataP, void *parameterP, void ** resultP),
+                                                          void *parameterP,
+                                                          void **resultP);
+
+hashtable_rc_t multikey_index_dump_content (multikey_index_t * const mki, bstring str);
+
+#endif /* FILE_MULTIKEY_INDEX_SEEN */
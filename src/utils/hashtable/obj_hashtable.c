@@ -58,7 +58,7 @@ obj_hashtable_no_free_key_callback (
 /*
    Default hash function
    def_hashfunc() is the default used by hashtable_create() when the user didn't specify one.
-   This is a simple/naive hash function which adds the key's ASCII char values. It will probably generate lots of collisions on large hash tables.
+   The key is read 8 bytes at a time, each word is folded in the running hash with a 64 bits finalizer.
 */
 
 static                                  hash_size_t
@@ -66,12 +66,11 @@ def_hashfunc (
   const void *const keyP,
   const int key_sizeP)
 {
-  hash_size_t                             hash = 0;
+  hash_size_t                             hash = (hash_size_t)key_sizeP;
   int                                     key_size = key_sizeP;
 
-  // may use MD4 ?
   while (key_size > 0) {
-    uint32_t val = 0;
+    uint64_t val = 0;
     int      size = sizeof(val);
     while ((size > 0) && (key_size > 0)) {
       val = val << 8;
@@ -79,7 +78,7 @@ def_hashfunc (
       size--;
       key_size--;
     }
-    hash ^= val;
+    hash = hashtable_mix64 (hash ^ val);
   }
 
   return hash;
@@ -221,7 +220,7 @@ obj_hashtable_ts_init (
   }
 
   pthread_mutex_init(&hashtblP->mutex, NULL);
-  for (int i = 0; i < size; i++) {
+  for (hash_size_t i = 0; i < size; i++) {
     pthread_mutex_init(&hashtblP->lock_nodes[i], NULL);
   }
 
@@ -0,0 +1,356 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file ipv4_pool.c
+   \brief Pool of IPv4 addresses made of address ranges, one bit per address, summarized by upper levels of bitmaps.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "common_defs.h"
+#include "hashtable.h"
+#include "ipv4_pool.h"
+
+#define IPV4_POOL_WORD_BITS               64
+#define IPV4_POOL_WORD_SHIFT              6
+#define IPV4_POOL_WORD_MASK               (IPV4_POOL_WORD_BITS - 1)
+#define IPV4_POOL_IMSI_HTBL_SIZE_MIN      256
+#define IPV4_POOL_IMSI_HTBL_SIZE_MAX      (1 << 18)
+
+//------------------------------------------------------------------------------
+static int ipv4_pool_range_cmp (const void *a, const void *b)
+{
+  const ipv4_pool_range_t                *ra = (const ipv4_pool_range_t *)a;
+  const ipv4_pool_range_t                *rb = (const ipv4_pool_range_t *)b;
+
+  return (ra->first > rb->first) - (ra->first < rb->first);
+}
+
+//------------------------------------------------------------------------------
+// bit of an address, -1 if not in the pool
+static int64_t ipv4_pool_addr2bit (const ipv4_pool_t * const pool, const struct in_addr addr)
+{
+  const uint32_t                          a = ntohl (addr.s_addr);
+  int                                     low = 0;
+  int                                     high = pool->num_ranges - 1;
+
+  while (low <= high) {
+    const int                               mid = (low + high) / 2;
+    const ipv4_pool_range_t                *r = &pool->ranges[mid];
+
+    if (a < r->first) {
+      high = mid - 1;
+    } else if (a > r->last) {
+      low = mid + 1;
+    } else {
+      return (int64_t)(r->offset + (a - r->first));
+    }
+  }
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+static struct in_addr ipv4_pool_bit2addr (const ipv4_pool_t * const pool, const uint64_t bit)
+{
+  int                                     low = 0;
+  int                                     high = pool->num_ranges - 1;
+  struct in_addr                          addr = {.s_addr = INADDR_ANY};
+
+  // last range whose offset is <= bit
+  while (low < high) {
+    const int                               mid = (low + high + 1) / 2;
+
+    if (pool->ranges[mid].offset <= bit) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  addr.s_addr = htonl (pool->ranges[low].first + (uint32_t)(bit - pool->ranges[low].offset));
+  return addr;
+}
+
+//------------------------------------------------------------------------------
+static inline bool ipv4_pool_bit_is_free (const ipv4_pool_t * const pool, const uint64_t bit)
+{
+  return (pool->levels[0][bit >> IPV4_POOL_WORD_SHIFT] >> (bit & IPV4_POOL_WORD_MASK)) & 1;
+}
+
+//------------------------------------------------------------------------------
+// the summary bit of a word is cleared only when the word becomes empty
+static inline void ipv4_pool_set_used (ipv4_pool_t * const pool, uint64_t bit)
+{
+  for (int l = 0; l < pool->num_levels; l++) {
+    uint64_t                               *word = &pool->levels[l][bit >> IPV4_POOL_WORD_SHIFT];
+
+    *word &= ~(UINT64_C(1) << (bit & IPV4_POOL_WORD_MASK));
+    if (*word) {
+      break;
+    }
+    bit >>= IPV4_POOL_WORD_SHIFT;
+  }
+}
+
+//------------------------------------------------------------------------------
+// the summary bit of a word is set only when the word was empty
+static inline void ipv4_pool_set_free (ipv4_pool_t * const pool, uint64_t bit)
+{
+  for (int l = 0; l < pool->num_levels; l++) {
+    uint64_t                               *word = &pool->levels[l][bit >> IPV4_POOL_WORD_SHIFT];
+    const bool                              was_empty = (0 == *word);
+
+    *word |= UINT64_C(1) << (bit & IPV4_POOL_WORD_MASK);
+    if (!was_empty) {
+      break;
+    }
+    bit >>= IPV4_POOL_WORD_SHIFT;
+  }
+}
+
+//------------------------------------------------------------------------------
+// first free bit >= from, -1 if none: climb the levels until a word has a set bit at or after the position, then
+// descend taking the first set bit of each word
+static int64_t ipv4_pool_find_free (const ipv4_pool_t * const pool, const uint64_t from)
+{
+  uint64_t                                pos = from;
+  int                                     l = 0;
+
+  for (;;) {
+    const uint64_t                          w = pos >> IPV4_POOL_WORD_SHIFT;
+    uint64_t                                word = 0;
+
+    if (w >= pool->num_words[l]) {
+      return -1;
+    }
+    word = pool->levels[l][w] & (UINT64_MAX << (pos & IPV4_POOL_WORD_MASK));
+    if (word) {
+      pos = (w << IPV4_POOL_WORD_SHIFT) + __builtin_ctzll (word);
+      break;
+    }
+    if ((l + 1) == pool->num_levels) {
+      return -1;
+    }
+    // next word of this level is the next bit of the level above
+    pos = w + 1;
+    l++;
+  }
+  while (l > 0) {
+    l--;
+    pos = (pos << IPV4_POOL_WORD_SHIFT) + __builtin_ctzll (pool->levels[l][pos]);
+  }
+  return (int64_t)pos;
+}
+
+//------------------------------------------------------------------------------
+// the address is handed out, the IMSI that released it last does not get it back: the IMSI tables only hold
+// free addresses
+static void ipv4_pool_forget_imsi (ipv4_pool_t * const pool, const uint64_t bit)
+{
+  uint64_t                                imsi64 = 0;
+  uint64_t                                sticky = 0;
+
+  if ((pool->addr2imsi) && (HASH_TABLE_OK == hashtable_uint64_ts_get (pool->addr2imsi, (const hash_key_t)bit, &imsi64))) {
+    hashtable_uint64_ts_remove (pool->addr2imsi, (const hash_key_t)bit);
+    if ((HASH_TABLE_OK == hashtable_uint64_ts_get (pool->imsi2addr, (const hash_key_t)imsi64, &sticky)) && (sticky == bit)) {
+      hashtable_uint64_ts_remove (pool->imsi2addr, (const hash_key_t)imsi64);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void ipv4_pool_take (ipv4_pool_t * const pool, const uint64_t bit, struct in_addr * const addr)
+{
+  ipv4_pool_forget_imsi (pool, bit);
+  ipv4_pool_set_used (pool, bit);
+  pool->num_free--;
+  if (addr) {
+    *addr = ipv4_pool_bit2addr (pool, bit);
+  }
+}
+
+//------------------------------------------------------------------------------
+ipv4_pool_t *ipv4_pool_create (const int num_ranges, const struct in_addr * const range_low,
+                               const struct in_addr * const range_high, const bool imsi_sticky)
+{
+  ipv4_pool_t                            *pool = NULL;
+  uint64_t                                num_bits = 0;
+
+  if (num_ranges <= 0) {
+    return NULL;
+  }
+  pool = calloc (1, sizeof (*pool));
+  pool->ranges = calloc (num_ranges, sizeof (ipv4_pool_range_t));
+  pool->num_ranges = num_ranges;
+  for (int i = 0; i < num_ranges; i++) {
+    pool->ranges[i].first = ntohl (range_low[i].s_addr);
+    pool->ranges[i].last = ntohl (range_high[i].s_addr);
+    if (pool->ranges[i].first > pool->ranges[i].last) {
+      ipv4_pool_destroy (pool);
+      return NULL;
+    }
+  }
+  qsort (pool->ranges, num_ranges, sizeof (ipv4_pool_range_t), ipv4_pool_range_cmp);
+  for (int i = 0; i < num_ranges; i++) {
+    if ((i > 0) && (pool->ranges[i].first <= pool->ranges[i - 1].last)) {
+      ipv4_pool_destroy (pool);
+      return NULL;
+    }
+    pool->ranges[i].offset = pool->num_addresses;
+    pool->num_addresses += (uint64_t)(pool->ranges[i].last - pool->ranges[i].first) + 1;
+  }
+
+  // level 0 has every address free, the bits past the last address stay 0, so do the summary bits of the words
+  // past the last word of the level below
+  num_bits = pool->num_addresses;
+  do {
+    const int                               l = pool->num_levels++;
+
+    pool->num_words[l] = (num_bits + IPV4_POOL_WORD_MASK) >> IPV4_POOL_WORD_SHIFT;
+    pool->levels[l] = calloc (pool->num_words[l], sizeof (uint64_t));
+    memset (pool->levels[l], 0xff, (num_bits >> IPV4_POOL_WORD_SHIFT) * sizeof (uint64_t));
+    if (num_bits & IPV4_POOL_WORD_MASK) {
+      pool->levels[l][pool->num_words[l] - 1] = (UINT64_C(1) << (num_bits & IPV4_POOL_WORD_MASK)) - 1;
+    }
+    num_bits = pool->num_words[l];
+  } while (num_bits > 1);
+  pool->num_free = pool->num_addresses;
+
+  if (imsi_sticky) {
+    uint64_t                                size = pool->num_addresses / 4;
+
+    size = (size < IPV4_POOL_IMSI_HTBL_SIZE_MIN) ? IPV4_POOL_IMSI_HTBL_SIZE_MIN : size;
+    size = (size > IPV4_POOL_IMSI_HTBL_SIZE_MAX) ? IPV4_POOL_IMSI_HTBL_SIZE_MAX : size;
+    bstring                                 bs = bfromcstr ("ipv4_pool_imsi2addr");
+
+    pool->imsi2addr = hashtable_uint64_ts_create ((hash_size_t)size, NULL, bs);
+    bdestroy_wrapper (&bs);
+    bs = bfromcstr ("ipv4_pool_addr2imsi");
+    pool->addr2imsi = hashtable_uint64_ts_create ((hash_size_t)size, NULL, bs);
+    bdestroy_wrapper (&bs);
+  }
+  return pool;
+}
+
+//------------------------------------------------------------------------------
+void ipv4_pool_destroy (ipv4_pool_t * const pool)
+{
+  if (pool) {
+    for (int l = 0; l < pool->num_levels; l++) {
+      free_wrapper ((void **)&pool->levels[l]);
+    }
+    if (pool->imsi2addr) {
+      hashtable_uint64_ts_destroy (pool->imsi2addr);
+    }
+    if (pool->addr2imsi) {
+      hashtable_uint64_ts_destroy (pool->addr2imsi);
+    }
+    free_wrapper ((void **)&pool->ranges);
+    free_wrapper ((void **)&pool);
+  }
+}
+
+//------------------------------------------------------------------------------
+int ipv4_pool_alloc (ipv4_pool_t * const pool, const uint64_t imsi64, struct in_addr * const addr)
+{
+  int64_t                                 bit = -1;
+  uint64_t                                sticky = 0;
+
+  if ((imsi64) && (pool->imsi2addr) &&
+      (HASH_TABLE_OK == hashtable_uint64_ts_get (pool->imsi2addr, (const hash_key_t)imsi64, &sticky))) {
+    hashtable_uint64_ts_remove (pool->imsi2addr, (const hash_key_t)imsi64);
+    if (ipv4_pool_bit_is_free (pool, sticky)) {
+      ipv4_pool_take (pool, sticky, addr);
+      return RETURNok;
+    }
+  }
+
+  bit = ipv4_pool_find_free (pool, pool->cursor);
+  if ((0 > bit) && (pool->cursor)) {
+    bit = ipv4_pool_find_free (pool, 0);
+  }
+  if (0 > bit) {
+    addr->s_addr = INADDR_ANY;
+    return RETURNerror;
+  }
+  ipv4_pool_take (pool, (uint64_t)bit, addr);
+  pool->cursor = ((uint64_t)bit + 1 < pool->num_addresses) ? (uint64_t)bit + 1 : 0;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int ipv4_pool_alloc_addr (ipv4_pool_t * const pool, const struct in_addr addr)
+{
+  const int64_t                           bit = ipv4_pool_addr2bit (pool, addr);
+
+  if ((0 > bit) || (!ipv4_pool_bit_is_free (pool, (uint64_t)bit))) {
+    return RETURNerror;
+  }
+  ipv4_pool_take (pool, (uint64_t)bit, NULL);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int ipv4_pool_release (ipv4_pool_t * const pool, const uint64_t imsi64, const struct in_addr addr)
+{
+  const int64_t                           bit = ipv4_pool_addr2bit (pool, addr);
+
+  if ((0 > bit) || (ipv4_pool_bit_is_free (pool, (uint64_t)bit))) {
+    return RETURNerror;
+  }
+  ipv4_pool_set_free (pool, (uint64_t)bit);
+  pool->num_free++;
+  if ((imsi64) && (pool->imsi2addr)) {
+    uint64_t                                previous = 0;
+
+    // only the last address released by the IMSI is remembered
+    if ((HASH_TABLE_OK == hashtable_uint64_ts_get (pool->imsi2addr, (const hash_key_t)imsi64, &previous)) && (previous != (uint64_t)bit)) {
+      hashtable_uint64_ts_remove (pool->addr2imsi, (const hash_key_t)previous);
+    }
+    hashtable_uint64_ts_insert (pool->imsi2addr, (const hash_key_t)imsi64, (uint64_t)bit);
+    hashtable_uint64_ts_insert (pool->addr2imsi, (const hash_key_t)bit, imsi64);
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+bool ipv4_pool_is_allocated (const ipv4_pool_t * const pool, const struct in_addr addr)
+{
+  const int64_t                           bit = ipv4_pool_addr2bit (pool, addr);
+
+  return (0 <= bit) && (!ipv4_pool_bit_is_free (pool, (uint64_t)bit));
+}
+
+//------------------------------------------------------------------------------
+size_t ipv4_pool_memory (const ipv4_pool_t * const pool)
+{
+  size_t                                  bytes = pool->num_ranges * sizeof (ipv4_pool_range_t);
+
+  for (int l = 0; l < pool->num_levels; l++) {
+    bytes += pool->num_words[l] * sizeof (uint64_t);
+  }
+  return bytes;
+}
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file ipv4_pool.h
+   \brief Pool of IPv4 addresses made of address ranges, one bit per address. The address bitmap is
+          summarized by upper levels of bitmaps (one bit per non empty word of the level below), allocation
+          is a next fit walk in these levels with find first set, release is a bit set: both are bounded by
+          the number of levels (at most 6 for the whole IPv4 space).
+          An IMSI can get back the last address it released, as long as this address is still free.
+*/
+
+#ifndef FILE_IPV4_POOL_SEEN
+#define FILE_IPV4_POOL_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <netinet/in.h>
+
+#include "bstrlib.h"
+#include "hashtable.h"
+
+#define IPV4_POOL_MAX_LEVELS              6             /*!< \brief 2^32 addresses, 64 bits per word */
+
+/*! \struct  ipv4_pool_range_t
+* \brief Range of addresses of the pool, host byte order, bits [offset, offset + last - first] of the pool.
+*/
+typedef struct ipv4_pool_range_s {
+  uint32_t                        first;
+  uint32_t                        last;
+  uint64_t                        offset;
+} ipv4_pool_range_t;
+
+/*! \struct  ipv4_pool_t
+* \brief Ranges sorted by address. Level 0 holds one bit per address (1 = free), level n+1 one bit per word of
+* level n (1 = the word has a free address), the top level is one word.
+*/
+typedef struct ipv4_pool_s {
+  int                             num_ranges;
+  ipv4_pool_range_t              *ranges;
+  uint64_t                        num_addresses;
+  uint64_t                        num_free;
+  int                             num_levels;
+  uint64_t                       *levels[IPV4_POOL_MAX_LEVELS];
+  uint64_t                        num_words[IPV4_POOL_MAX_LEVELS];
+  uint64_t                        cursor;             /*!< \brief next fit: released addresses are reused last */
+  hash_table_uint64_ts_t         *imsi2addr;          /*!< \brief IMSI -> bit of the last address it released */
+  hash_table_uint64_ts_t         *addr2imsi;          /*!< \brief bit -> IMSI that released it, the entries of both tables
+                                                           are dropped when the address is allocated again */
+} ipv4_pool_t;
+
+/** \brief Creates a pool with every address of the ranges free, NULL if the ranges overlap or are empty.
+ * \param range_low First addresses of the ranges, network byte order.
+ * \param range_high Last addresses of the ranges, network byte order.
+ * \param imsi_sticky Remember the last address released by an IMSI.
+ **/
+ipv4_pool_t *ipv4_pool_create (const int num_ranges, const struct in_addr * const range_low,
+                               const struct in_addr * const range_high, const bool imsi_sticky);
+void         ipv4_pool_destroy (ipv4_pool_t * const pool);
+
+/** \brief Allocates the last address released by imsi64 if still free, else the next free address.
+ * \param imsi64 0 if unknown.
+ * @returns RETURNok or RETURNerror if the pool is exhausted (addr set to INADDR_ANY).
+ **/
+int          ipv4_pool_alloc (ipv4_pool_t * const pool, const uint64_t imsi64, struct in_addr * const addr) __attribute__ ((hot));
+
+/** \brief Allocates a given address (static UE address).
+ * @returns RETURNok or RETURNerror if the address is not in the pool or already allocated.
+ **/
+int          ipv4_pool_alloc_addr (ipv4_pool_t * const pool, const struct in_addr addr);
+
+/** \brief Releases an address and remembers it for imsi64 (if not 0 and the pool is IMSI sticky).
+ * @returns RETURNok or RETURNerror if the address is not in the pool or not allocated.
+ **/
+int          ipv4_pool_release (ipv4_pool_t * const pool, const uint64_t imsi64, const struct in_addr addr) __attribute__ ((hot));
+
+bool         ipv4_pool_is_allocated (const ipv4_pool_t * const pool, const struct in_addr addr);
+size_t       ipv4_pool_memory (const ipv4_pool_t * const pool);                  /*!< \brief bytes held by the bitmaps */
+
+#endif /* FILE_IPV4_POOL_SEEN */
@@ -112,10 +112,29 @@ typedef struct oai_log_s {
 
   log_message_number_t                    log_message_number;                                          /*!< \brief Counter of log message        */
   hash_table_ts_t                           *thread_context_htbl;                                         /*!< \brief Container for log_thread_ctxt_t */
+
+  bool                                    is_binary;                                                   /*!< \brief Deferred formatting of OAILOG_* call sites */
+  FILE                                   *binary_fd;                                                   /*!< \brief Raw records output, NULL if records are formatted by the consumer */
+  log_binary_ring_t                      *binary_rings;                                                /*!< \brief List of the per thread rings */
+  pthread_mutex_t                         binary_rings_mutex;                                          /*!< \brief Protects the list of rings */
+  pthread_mutex_t                         binary_consumer_mutex;                                       /*!< \brief Only one consumer drains the rings */
+  pthread_key_t                           binary_ring_key;                                             /*!< \brief Marks the ring of an exiting thread as orphan */
+  bstring                                 binary_bstr;                                                 /*!< \brief Consumer formatting buffer */
 } oai_log_t;
 
 static oai_log_t g_oai_log={0};    /*!< \brief  logging utility internal variables global var definition*/
 
+static __thread log_binary_ring_t *t_log_binary_ring = NULL;   /*!< \brief binary records ring of the current thread */
+
+static void log_message_v (
+  log_thread_ctxt_t * thread_ctxtP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  const char *const source_fileP,
+  const unsigned int line_numP,
+  const char *format,
+  va_list args);
+
 //------------------------------------------------------------------------------
 void* log_task (__attribute__ ((unused)) void *args_p)
 {
@@ -268,6 +287,21 @@ void log_set_config(const log_config_t * const config)
 
     g_oai_log.is_ansi_codes = config->color;
 
+    if ((config->is_binary) && (config->binary_output) && (NULL == g_oai_log.binary_fd)) {
+      const char  *level_names[MAX_LOG_LEVEL];
+      const char  *proto_names[MAX_LOG_PROTOS];
+
+      for (int i = MIN_LOG_LEVEL; i < MAX_LOG_LEVEL; i++) level_names[i] = &g_oai_log.log_level2str[i][0];
+      for (int i = MIN_LOG_PROTOS; i < MAX_LOG_PROTOS; i++) proto_names[i] = &g_oai_log.log_proto2str[i][0];
+      g_oai_log.binary_fd = fopen (bdata(config->binary_output), "w");
+      AssertFatal (NULL != g_oai_log.binary_fd, "Could not open binary log file %s : %s", bdata(config->binary_output), strerror (errno));
+      AssertFatal (0 == log_binary_file_write_header (g_oai_log.binary_fd, g_oai_log.log_start_time_second),
+          "Could not write binary log file %s : %s", bdata(config->binary_output), strerror (errno));
+      AssertFatal (0 == log_binary_file_write_names (g_oai_log.binary_fd, level_names, MAX_LOG_LEVEL, proto_names, MAX_LOG_PROTOS),
+          "Could not write binary log file %s : %s", bdata(config->binary_output), strerror (errno));
+    }
+    g_oai_log.is_binary = config->is_binary;
+
     if (config->output) {
       g_oai_log.log_fd = NULL;
       g_oai_log.is_output_is_fd = false;
@@ -342,6 +376,151 @@ void log_signal_callback_handler(int signum){
   }
 }
 
+//------------------------------------------------------------------------------
+static log_thread_ctxt_t * log_get_thread_ctxt (void)
+{
+  log_thread_ctxt_t                      *thread_ctxt = NULL;
+  pthread_t                               p           = pthread_self();
+  hashtable_rc_t                          hash_rc     = HASH_TABLE_OK;
+
+  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
+  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
+    // make the thread safe LFDS collections usable by this thread
+    log_start_use();
+    hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
+    AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
+  }
+  return thread_ctxt;
+}
+
+//------------------------------------------------------------------------------
+// Same header for text messages, multi-part messages and binary records formatted by the consumer.
+static int log_message_header (
+  bstring bstr,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  const uint64_t message_numberP,
+  const long elapsed_secP,
+  const long elapsed_usecP,
+  const unsigned long tidP,
+  const int indentP,
+  const char *const source_fileP,
+  const unsigned int line_numP)
+{
+  if (g_oai_log.is_ansi_codes) {
+    bformata (bstr, "%s", &g_oai_log.log_level2ansi[log_levelP][0]);
+  }
+  return log_format_header (bstr, message_numberP, elapsed_secP, elapsed_usecP, tidP,
+      &g_oai_log.log_level2str[log_levelP][0], &g_oai_log.log_proto2str[protoP][0],
+      source_fileP, line_numP, indentP);
+}
+
+//------------------------------------------------------------------------------
+// pthread key destructor, called when a producer thread exits.
+static void log_binary_ring_orphan (void *ring)
+{
+  __atomic_store_n (&((log_binary_ring_t *)ring)->is_orphan, 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+static log_binary_ring_t * log_binary_get_thread_ring (void)
+{
+  log_binary_ring_t                      *ring = t_log_binary_ring;
+
+  if (!ring) {
+    ring = log_binary_ring_create (LOG_BINARY_RING_SIZE);
+    if (!ring) {
+      return NULL;
+    }
+    ring->thread_ctxt = log_get_thread_ctxt ();
+    pthread_mutex_lock (&g_oai_log.binary_rings_mutex);
+    ring->next             = g_oai_log.binary_rings;
+    g_oai_log.binary_rings = ring;
+    pthread_mutex_unlock (&g_oai_log.binary_rings_mutex);
+    pthread_setspecific (g_oai_log.binary_ring_key, ring);
+    t_log_binary_ring = ring;
+  }
+  return ring;
+}
+
+//------------------------------------------------------------------------------
+static void log_binary_output_record (const log_binary_record_header_t * const header)
+{
+  log_format_site_t                      *site = (log_format_site_t *)(uintptr_t)header->site_id;
+  shared_log_queue_item_t                 item = {.app_id = SH_TS_LOG_TXT};
+
+  if (g_oai_log.binary_fd) {
+    if (!site->is_defined) {
+      log_binary_file_write_format (g_oai_log.binary_fd, site);
+      site->is_defined = true;
+    }
+    log_binary_file_write_record (g_oai_log.binary_fd, header);
+    return;
+  }
+
+  btrunc (g_oai_log.binary_bstr, 0);
+  log_message_header (g_oai_log.binary_bstr, header->log_level, header->proto, header->message_number,
+      header->tv_sec, header->tv_usec, header->tid, header->indent, site->source_file, site->line_num);
+  if (BSTR_ERR == log_binary_format_args (g_oai_log.binary_bstr, site->format, header)) {
+    bcatcstr (g_oai_log.binary_bstr, " <undecodable binary log record>\n");
+  }
+  if (g_oai_log.is_ansi_codes) {
+    bcatcstr (g_oai_log.binary_bstr, ANSI_COLOR_RESET);
+  }
+  item.bstr = g_oai_log.binary_bstr;
+  item.u_app_log.log.log_level = header->log_level;
+  log_flush_message (&item);
+}
+
+//------------------------------------------------------------------------------
+// Called with binary_consumer_mutex held.
+static void log_binary_drain_rings (void)
+{
+  log_binary_ring_t                     **prev = NULL;
+  log_binary_ring_t                      *ring = NULL;
+  const log_binary_record_header_t       *header = NULL;
+
+  pthread_mutex_lock (&g_oai_log.binary_rings_mutex);
+  prev = &g_oai_log.binary_rings;
+  while ((ring = *prev)) {
+    // read before draining, records written before the owner thread exited are then seen
+    int       is_orphan = __atomic_load_n (&ring->is_orphan, __ATOMIC_ACQUIRE);
+    uint64_t  dropped   = 0;
+
+    while ((header = log_binary_ring_peek (ring))) {
+      log_binary_output_record (header);
+      log_binary_ring_release (ring, header);
+    }
+    dropped = __atomic_load_n (&ring->dropped, __ATOMIC_RELAXED);
+    if (dropped != ring->reported_dropped) {
+      log_message (NULL, OAILOG_LEVEL_WARNING, LOG_UTIL, __FILE__, __LINE__, "Binary log ring of thread %08lX full, %" PRIu64 " records dropped\n",
+          ((log_thread_ctxt_t *)ring->thread_ctxt)->tid, dropped - ring->reported_dropped);
+      ring->reported_dropped = dropped;
+    }
+    if (is_orphan) {
+      *prev = ring->next;
+      log_binary_ring_free (ring);
+    } else {
+      prev = &ring->next;
+    }
+  }
+  pthread_mutex_unlock (&g_oai_log.binary_rings_mutex);
+  if (g_oai_log.binary_fd) {
+    fflush (g_oai_log.binary_fd);
+  }
+}
+
+//------------------------------------------------------------------------------
+void log_binary_flush_messages (void)
+{
+  if (g_oai_log.is_binary) {
+    if (0 == pthread_mutex_trylock (&g_oai_log.binary_consumer_mutex)) {
+      log_binary_drain_rings ();
+      pthread_mutex_unlock (&g_oai_log.binary_consumer_mutex);
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 int
 log_init (
@@ -365,6 +544,11 @@ log_init (
   AssertFatal (NULL != g_oai_log.thread_context_htbl, "Could not create hashtable for Log!\n");
   g_oai_log.thread_context_htbl->log_enabled = false;
 
+  pthread_mutex_init (&g_oai_log.binary_rings_mutex, NULL);
+  pthread_mutex_init (&g_oai_log.binary_consumer_mutex, NULL);
+  AssertFatal (0 == pthread_key_create (&g_oai_log.binary_ring_key, log_binary_ring_orphan), "Could not create binary log ring key\n");
+  g_oai_log.binary_bstr = bfromcstralloc(LOG_MESSAGE_MIN_ALLOC_SIZE, "");
+
 
   log_thread_ctxt_t *thread_ctxt = calloc(1, sizeof(log_thread_ctxt_t));
   AssertFatal(NULL != thread_ctxt, "Error Could not create log thread context\n");
@@ -500,8 +684,30 @@ void log_flush_message (struct shared_log_queue_item_s *item_p)
 void log_exit (void)
 {
   int                                     rv = 0;
+  log_binary_ring_t                      *ring = NULL;
 
   OAI_FPRINTF_INFO("[TRACE] Entering %s\n", __FUNCTION__);
+  if (g_oai_log.is_binary) {
+    // last drain
+    pthread_mutex_lock (&g_oai_log.binary_consumer_mutex);
+    log_binary_drain_rings ();
+    g_oai_log.is_binary = false;
+    if (g_oai_log.binary_fd) {
+      fclose (g_oai_log.binary_fd);
+      g_oai_log.binary_fd = NULL;
+    }
+    pthread_mutex_unlock (&g_oai_log.binary_consumer_mutex);
+  }
+  // producer threads have ended, threads exiting later must not mark a freed ring as orphan
+  pthread_key_delete (g_oai_log.binary_ring_key);
+  pthread_mutex_lock (&g_oai_log.binary_rings_mutex);
+  while ((ring = g_oai_log.binary_rings)) {
+    g_oai_log.binary_rings = ring->next;
+    log_binary_ring_free (ring);
+  }
+  pthread_mutex_unlock (&g_oai_log.binary_rings_mutex);
+  t_log_binary_ring = NULL;
+  bdestroy_wrapper (&g_oai_log.binary_bstr);
   if (g_oai_log.log_fd) {
     rv = fflush (g_oai_log.log_fd);
 
@@ -686,9 +892,7 @@ void log_message_start (
 {
   va_list                                 args;
   int                                     rv              = 0;
-  int                                     filename_length = 0;
   log_thread_ctxt_t                      *thread_ctxt     = thread_ctxtP;
-  hashtable_rc_t                          hash_rc         = HASH_TABLE_OK;
 
   if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
     return;
@@ -701,14 +905,7 @@ void log_message_start (
   }
 
   if (NULL == thread_ctxt){
-    pthread_t             p           = pthread_self();
-    hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-    if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-      // make the thread safe LFDS collections usable by this thread
-      log_start_use();
-      hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-      AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
-    }
+    thread_ctxt = log_get_thread_ctxt ();
   }
 
   if (! *messageP) {
@@ -719,27 +916,8 @@ void log_message_start (
     (*messageP)->u_app_log.log.log_level = log_levelP;
     shared_log_get_elapsed_time_since_start(&elapsed_time);
 
-    filename_length = strlen(source_fileP);
-    if (g_oai_log.is_ansi_codes) {
-      rv = bformata ((*messageP)->bstr, "%s", &g_oai_log.log_level2ansi[log_levelP][0]);
-    }
-    if (filename_length > LOG_DISPLAYED_FILENAME_MAX_LENGTH) {
-      rv = bformata ((*messageP)->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-          __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-          thread_ctxt->tid,
-          LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-          LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-          LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, &source_fileP[filename_length-LOG_DISPLAYED_FILENAME_MAX_LENGTH], line_numP,
-          thread_ctxt->indent, " ");
-    } else {
-      rv = bformata ((*messageP)->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-          __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-          thread_ctxt->tid,
-          LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-          LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-          LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, source_fileP, line_numP,
-          thread_ctxt->indent, " ");
-    }
+    rv = log_message_header ((*messageP)->bstr, log_levelP, protoP, __sync_fetch_and_add (&g_oai_log.log_message_number, 1),
+        elapsed_time.tv_sec, elapsed_time.tv_usec, thread_ctxt->tid, thread_ctxt->indent, source_fileP, line_numP);
 
     if (BSTR_ERR == rv) {
       OAI_FPRINTF_ERR("Error while logging message : %s", &g_oai_log.log_proto2str[protoP][0]);
@@ -747,7 +925,7 @@ void log_message_start (
     }
 
     va_start (args, format);
-    rv = bformata ((*messageP)->bstr, format, args);
+    rv = bvcformata ((*messageP)->bstr, 4096, format, args); // big number, see bvcformata
     va_end (args);
 
     if (BSTR_ERR == rv) {
@@ -830,11 +1008,27 @@ log_message (
   ...)
 {
   va_list                                 args;
+
+  va_start (args, format);
+  log_message_v (thread_ctxtP, log_levelP, protoP, source_fileP, line_numP, format, args);
+  va_end (args);
+}
+
+//------------------------------------------------------------------------------
+// Text path: the message is formatted by the calling thread.
+static void
+log_message_v (
+  log_thread_ctxt_t * thread_ctxtP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  const char *const source_fileP,
+  const unsigned int line_numP,
+  const char *format,
+  va_list args)
+{
   int                                     rv              = 0;
-  int                                     filename_length = 0;
   struct shared_log_queue_item_s         *new_item_p      = NULL;
   log_thread_ctxt_t                      *thread_ctxt     = thread_ctxtP;
-  hashtable_rc_t                          hash_rc         = HASH_TABLE_OK;
 
   if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
     return;
@@ -846,50 +1040,23 @@ log_message (
     return;
   }
   if (NULL == thread_ctxt){
-    pthread_t             p           = pthread_self();
-    hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-    if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-      // make the thread safe LFDS collections usable by this thread
-      log_start_use();
-      hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-      AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
-    }
+    thread_ctxt = log_get_thread_ctxt ();
   }
 
   new_item_p = get_new_log_queue_item(SH_TS_LOG_TXT);
 
   if (new_item_p) {
-    if (g_oai_log.is_ansi_codes) {
-      rv = bformata (new_item_p->bstr, "%s", &g_oai_log.log_level2ansi[log_levelP][0]);
-    }
     struct timeval elapsed_time;
+    new_item_p->u_app_log.log.log_level = log_levelP;
     shared_log_get_elapsed_time_since_start(&elapsed_time);
-    filename_length = strlen(source_fileP);
-    if (filename_length > LOG_DISPLAYED_FILENAME_MAX_LENGTH) {
-      rv = bformata (new_item_p->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-          __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-          thread_ctxt->tid,
-          LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-          LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-          LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, &source_fileP[filename_length-LOG_DISPLAYED_FILENAME_MAX_LENGTH], line_numP,
-          thread_ctxt->indent, " ");
-    } else {
-      rv = bformata (new_item_p->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-          __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-          thread_ctxt->tid,
-          LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-          LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-          LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, source_fileP, line_numP,
-          thread_ctxt->indent, " ");
-    }
+    rv = log_message_header (new_item_p->bstr, log_levelP, protoP, __sync_fetch_and_add (&g_oai_log.log_message_number, 1),
+        elapsed_time.tv_sec, elapsed_time.tv_usec, thread_ctxt->tid, thread_ctxt->indent, source_fileP, line_numP);
 
     if (BSTR_ERR == rv) {
       OAI_FPRINTF_ERR("Error while logging LOG message : %s", &g_oai_log.log_proto2str[protoP][0]);
       goto error_event;
     }
-    va_start (args, format);
     rv = bvcformata (new_item_p->bstr, 4096, format, args); // big number
-    va_end (args);
 
     if (BSTR_ERR == rv) {
       OAI_FPRINTF_ERR("Error while logging LOG message : %s", &g_oai_log.log_proto2str[protoP][0]);
@@ -917,3 +1084,54 @@ error_event:
   shared_log_reuse_item(new_item_p);
 }
 
+//------------------------------------------------------------------------------
+// Entry point of the OAILOG_* macros. In binary mode the call site format id and the raw arguments are recorded
+// in the ring of the calling thread, formatting is deferred to the shared log task (or to an offline decoder).
+void
+log_message_site (
+  log_format_site_t * const siteP,
+  const bool is_literal_formatP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  const char *format,
+  ...)
+{
+  va_list                                 args;
+
+  if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
+    return;
+  }
+  if ((MIN_LOG_LEVEL > log_levelP) || (MAX_LOG_LEVEL <= log_levelP)) {
+    return;
+  }
+  if (log_levelP > g_oai_log.log_level[protoP]) {
+    return;
+  }
+  // a format not known at compile time has no stable identifier
+  if ((g_oai_log.is_binary) && (is_literal_formatP) && (LOG_FORMAT_SITE_BINARY == log_format_site_parse (siteP, format))) {
+    log_binary_ring_t *ring = log_binary_get_thread_ring ();
+
+    if (ring) {
+      log_binary_record_header_t  header      = {0};
+      log_thread_ctxt_t          *thread_ctxt = (log_thread_ctxt_t *)ring->thread_ctxt;
+      struct timeval              elapsed_time;
+
+      shared_log_get_elapsed_time_since_start(&elapsed_time);
+      header.log_level      = log_levelP;
+      header.proto          = protoP;
+      header.site_id        = (uint64_t)(uintptr_t)siteP;
+      header.message_number = __sync_fetch_and_add (&g_oai_log.log_message_number, 1);
+      header.tv_sec         = elapsed_time.tv_sec;
+      header.tv_usec        = elapsed_time.tv_usec;
+      header.tid            = thread_ctxt->tid;
+      header.indent         = thread_ctxt->indent;
+      va_start (args, format);
+      log_binary_ring_write_message (ring, &header, siteP, args);
+      va_end (args);
+      return;
+    }
+  }
+  va_start (args, format);
+  log_message_v (NULL, log_levelP, protoP, siteP->source_file, siteP->line_num, format, args);
+  va_end (args);
+}
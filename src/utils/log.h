@@ -82,6 +82,8 @@ extern int fd_g_debug_lvl;
 #define ANSI_COLOR_CONCEALED_ON "\x1b[8m"
 
 #define LOG_CONFIG_STRING_ASYNC_SYSTEM_LOG_LEVEL         "ASYNC_SYSTEM"
+#define LOG_CONFIG_STRING_BINARY                         "BINARY"
+#define LOG_CONFIG_STRING_BINARY_FILE                    "BINARY_FILE"
 #define LOG_CONFIG_STRING_COLOR                          "COLOR"
 #define LOG_CONFIG_STRING_OUTPUT_CONSOLE                 "CONSOLE"
 #define LOG_CONFIG_STRING_GTPV1U_LOG_LEVEL               "GTPV1U_LOG_LEVEL"
@@ -180,6 +182,8 @@ typedef struct log_private_s {
 typedef struct log_config_s {
   bstring       output;             /*!< \brief Where logs go, choice in { "CONSOLE", "`path to file`", "`IPv4@`:`TCP port num`"} . */
   bool          is_output_thread_safe; /*!< \brief Is final string goes in a thread safe buffer of is flushed without care . */
+  bool          is_binary;          /*!< \brief Producers record format id and raw arguments in per thread rings, the shared log task formats them. */
+  bstring       binary_output;      /*!< \brief If set with is_binary, path of the file where the raw records are dumped instead of being formatted (decoded offline). */
   log_level_t   udp_log_level;      /*!< \brief UDP ITTI task log level starting from OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
   log_level_t   gtpv1u_log_level;   /*!< \brief GTPv1-U ITTI task log level starting from OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
   log_level_t   gtpv2c_log_level;   /*!< \brief GTPv2-C ITTI task log level starting from OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
@@ -203,6 +207,7 @@ typedef struct log_config_s {
 } log_config_t;
 
 # if LOG_OAI
+#    include "log_binary.h"
 
 void log_connect_to_server(void);
 void log_set_config(const log_config_t * const config);
@@ -282,22 +287,39 @@ void log_message (
       char *format,
       ...) __attribute__ ((format (printf, 6, 7)));
 
+void log_message_site (
+      log_format_site_t * const siteP,
+      const bool is_literal_formatP,
+      const log_level_t log_levelP,
+      const log_proto_t protoP,
+      const char *format,
+      ...) __attribute__ ((format (printf, 5, 6)));
+
+void log_binary_flush_messages (void);
+
 int log_get_start_time_sec (void);
 
+// Each call site owns a static descriptor of its format string, used as format identifier by the binary logging path.
+#    define OAILOG_FORMAT_FIRST_ARG(fOrMaT, ...)                        fOrMaT
+#    define OAILOG_SITE(lOgLeVeL, pRoTo, ...)                           do { \
+                                                                   static log_format_site_t sItE = {.source_file = __FILE__, .line_num = __LINE__}; \
+                                                                   log_message_site(&sItE, __builtin_constant_p(OAILOG_FORMAT_FIRST_ARG(__VA_ARGS__, 0)), lOgLeVeL, pRoTo, ##__VA_ARGS__); \
+                                                                 } while(0)
+
 #    define OAILOG_SET_CONFIG                                           log_set_config
 #    define OAILOG_LEVEL_STR2INT                                        log_level_str2int
 #    define OAILOG_LEVEL_INT2STR                                        log_level_int2str
 #    define OAILOG_INIT                                                 log_init
 #    define OAILOG_ITTI_CONNECT                                         log_itti_connect
 #    define OAILOG_EXIT()                                               log_exit()
-#    define OAILOG_SPEC(pRoTo, ...)                                     do { log_message(NULL, OAILOG_LEVEL_NOTICE,   pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0)/*!< \brief 3GPP trace on specifications */
-#    define OAILOG_EMERGENCY(pRoTo, ...)                                do { log_message(NULL, OAILOG_LEVEL_EMERGENCY,pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0)/*!< \brief system is unusable */
-#    define OAILOG_ALERT(pRoTo, ...)                                    do { log_message(NULL, OAILOG_LEVEL_ALERT,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief action must be taken immediately */
-#    define OAILOG_CRITICAL(pRoTo, ...)                                 do { log_message(NULL, OAILOG_LEVEL_CRITICAL, pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief critical conditions */
-#    define OAILOG_ERROR(pRoTo, ...)                                    do { log_message(NULL, OAILOG_LEVEL_ERROR,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief error conditions */
-#    define OAILOG_WARNING(pRoTo, ...)                                  do { log_message(NULL, OAILOG_LEVEL_WARNING,  pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief warning conditions */
-#    define OAILOG_NOTICE(pRoTo, ...)                                   do { log_message(NULL, OAILOG_LEVEL_NOTICE,   pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief normal but significant condition */
-#    define OAILOG_INFO(pRoTo, ...)                                     do { log_message(NULL, OAILOG_LEVEL_INFO,     pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief informational */
+#    define OAILOG_SPEC(pRoTo, ...)                                     OAILOG_SITE(OAILOG_LEVEL_NOTICE, pRoTo, ##__VA_ARGS__)/*!< \brief 3GPP trace on specifications */
+#    define OAILOG_EMERGENCY(pRoTo, ...)                                OAILOG_SITE(OAILOG_LEVEL_EMERGENCY, pRoTo, ##__VA_ARGS__)/*!< \brief system is unusable */
+#    define OAILOG_ALERT(pRoTo, ...)                                    OAILOG_SITE(OAILOG_LEVEL_ALERT, pRoTo, ##__VA_ARGS__) /*!< \brief action must be taken immediately */
+#    define OAILOG_CRITICAL(pRoTo, ...)                                 OAILOG_SITE(OAILOG_LEVEL_CRITICAL, pRoTo, ##__VA_ARGS__) /*!< \brief critical conditions */
+#    define OAILOG_ERROR(pRoTo, ...)                                    OAILOG_SITE(OAILOG_LEVEL_ERROR, pRoTo, ##__VA_ARGS__) /*!< \brief error conditions */
+#    define OAILOG_WARNING(pRoTo, ...)                                  OAILOG_SITE(OAILOG_LEVEL_WARNING, pRoTo, ##__VA_ARGS__) /*!< \brief warning conditions */
+#    define OAILOG_NOTICE(pRoTo, ...)                                   OAILOG_SITE(OAILOG_LEVEL_NOTICE, pRoTo, ##__VA_ARGS__) /*!< \brief normal but significant condition */
+#    define OAILOG_INFO(pRoTo, ...)                                     OAILOG_SITE(OAILOG_LEVEL_INFO, pRoTo, ##__VA_ARGS__) /*!< \brief informational */
 #    define OAILOG_MESSAGE_START(lOgLeVeL, pRoTo, cOnTeXt, ...)         do { log_message_start(NULL, lOgLeVeL, pRoTo, cOnTeXt, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief when need to log only 1 message with many char messages, ex formating a dumped struct */
 #    define OAILOG_MESSAGE_ADD(cOnTeXt, ...)                            do { log_message_add(cOnTeXt, ##__VA_ARGS__); } while(0) /*!< \brief can be called as many times as needed after OAILOG_MESSAGE_START() */
 #    define OAILOG_MESSAGE_FINISH(cOnTeXt)                              do { log_message_finish(cOnTeXt); } while(0) /*!< \brief Send the message built by OAILOG_MESSAGE_START() n*LOG_MESSAGE_ADD() (n=0..N) */
@@ -307,10 +329,10 @@ int log_get_start_time_sec (void);
                                                                    OAI_GCC_DIAG_ON(pointer-sign); \
                                                                  } while(0); /*!< \brief trace buffer content */
 #    if DEBUG_IS_ON
-#      define OAILOG_DEBUG(pRoTo, ...)                                  do { log_message(NULL, OAILOG_LEVEL_DEBUG,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief debug informations */
+#      define OAILOG_DEBUG(pRoTo, ...)                                  OAILOG_SITE(OAILOG_LEVEL_DEBUG, pRoTo, ##__VA_ARGS__) /*!< \brief debug informations */
 #      if TRACE_IS_ON
-#        define OAILOG_EXTERNAL(lOgLeVeL, pRoTo, ...)                   do { log_message(NULL, lOgLeVeL       ,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0)
-#        define OAILOG_TRACE(pRoTo, ...)                                do { log_message(NULL, OAILOG_LEVEL_TRACE,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief most detailled informations, struct dumps */
+#        define OAILOG_EXTERNAL(lOgLeVeL, pRoTo, ...)                   OAILOG_SITE(lOgLeVeL, pRoTo, ##__VA_ARGS__)
+#        define OAILOG_TRACE(pRoTo, ...)                                OAILOG_SITE(OAILOG_LEVEL_TRACE, pRoTo, ##__VA_ARGS__) /*!< \brief most detailled informations, struct dumps */
 #        define OAILOG_FUNC_IN(pRoTo)                                   do { log_func(true, pRoTo, __FILE__, __LINE__, __FUNCTION__); } while(0) /*!< \brief informational */
 #        define OAILOG_FUNC_OUT(pRoTo)                                  do { log_func(false, pRoTo, __FILE__, __LINE__, __FUNCTION__); return;} while(0) /*!< \brief informational */
 #        define OAILOG_FUNC_RETURN(pRoTo, rEtUrNcOdE)                   do { log_func_return(pRoTo, __FILE__, __LINE__, __FUNCTION__, (long)rEtUrNcOdE); return rEtUrNcOdE;} while(0) /*!< \brief informational */
@@ -0,0 +1,540 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file log_binary.c
+   \brief Binary log records: per call site format descriptors, per thread SPSC byte rings,
+          deferred formatting of the raw arguments by the log consumer or by an offline decoder.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <inttypes.h>
+
+#include "bstrlib.h"
+#include "log_binary.h"
+
+#define LOG_DISPLAYED_FILENAME_MAX_LENGTH       32
+#define LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH  5
+#define LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH      6
+
+//------------------------------------------------------------------------------
+// Splits the next literal text and the next conversion specification out of *format, *format is advanced past them.
+// Return 1 if something was read, 0 at the end of the format, -1 if the specification is not supported by the binary path.
+int log_binary_next_spec (const char ** const format, log_binary_spec_t * const spec)
+{
+  const char                             *p = *format;
+  bool                                    is_long = false;
+  bool                                    is_long_long = false;
+  bool                                    is_long_double = false;
+
+  memset(spec, 0, sizeof(*spec));
+  spec->precision = -1;
+  spec->literal = p;
+  while ((*p) && ('%' != *p)) p++;
+  spec->literal_length = p - spec->literal;
+  if (!(*p)) {
+    *format = p;
+    return (spec->literal_length) ? 1:0;
+  }
+
+  spec->spec = p++;
+  if ('%' == *p) {
+    spec->type = LOG_BINARY_ARG_NONE;
+    spec->spec_length = 2;
+    *format = p + 1;
+    return 1;
+  }
+  // flags
+  while ((*p) && (strchr("-+ #0'", *p))) p++;
+  // width
+  if ('*' == *p) {
+    spec->num_stars++;
+    p++;
+  } else {
+    while ((*p >= '0') && (*p <= '9')) p++;
+  }
+  if ('$' == *p) return -1; // positional arguments
+  // precision
+  if ('.' == *p) {
+    p++;
+    if ('*' == *p) {
+      spec->num_stars++;
+      spec->is_star_precision = true;
+      p++;
+    } else {
+      spec->precision = 0;
+      while ((*p >= '0') && (*p <= '9')) {
+        spec->precision = spec->precision * 10 + (*p - '0');
+        if (spec->precision > LOG_BINARY_MAX_STRING_LENGTH) spec->precision = LOG_BINARY_MAX_STRING_LENGTH;
+        p++;
+      }
+    }
+  }
+  if ('$' == *p) return -1;
+  // length modifier
+  switch (*p) {
+  case 'h':
+    p++;
+    if ('h' == *p) p++;
+    break;
+  case 'l':
+    p++;
+    is_long = true;
+    if ('l' == *p) {
+      p++;
+      is_long_long = true;
+    }
+    break;
+  case 'q':
+    p++;
+    is_long_long = true;
+    break;
+  case 'L':
+    p++;
+    is_long_double = true;
+    break;
+  case 'j':
+  case 'z':
+  case 't':
+    // intmax_t, size_t, ptrdiff_t have the size of a long on the LP64 targets we run on
+    p++;
+    is_long = true;
+    break;
+  default:;
+  }
+  // conversion
+  switch (*p) {
+  case 'd':
+  case 'i':
+  case 'o':
+  case 'u':
+  case 'x':
+  case 'X':
+    if (is_long_double) return -1;
+    spec->type = (is_long_long) ? LOG_BINARY_ARG_LLONG : (is_long) ? LOG_BINARY_ARG_LONG : LOG_BINARY_ARG_INT;
+    break;
+  case 'c':
+    if ((is_long) || (is_long_long) || (is_long_double)) return -1; // wide char
+    spec->type = LOG_BINARY_ARG_INT;
+    break;
+  case 's':
+    if ((is_long) || (is_long_long) || (is_long_double)) return -1; // wide string
+    spec->type = LOG_BINARY_ARG_STRING;
+    break;
+  case 'p':
+    spec->type = LOG_BINARY_ARG_POINTER;
+    break;
+  case 'e':
+  case 'E':
+  case 'f':
+  case 'F':
+  case 'g':
+  case 'G':
+  case 'a':
+  case 'A':
+    if ((is_long_double) || (is_long_long)) return -1;
+    spec->type = LOG_BINARY_ARG_DOUBLE;
+    break;
+  default:
+    // %n, %m, %S, %C, truncated specification
+    return -1;
+  }
+  p++;
+  spec->spec_length = p - spec->spec;
+  if (spec->spec_length >= LOG_BINARY_MAX_SPEC_LENGTH) return -1;
+  *format = p;
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+// Called by every log of the call site. The first caller parses the format, concurrent callers go on the text path
+// until the result is published.
+log_format_site_state_t log_format_site_parse (log_format_site_t * const site, const char * const format)
+{
+  log_binary_spec_t                       spec = {0};
+  const char                             *p = format;
+  int                                     num_args = 0;
+  int                                     rc = 0;
+  log_format_site_state_t                 state = __atomic_load_n (&site->state, __ATOMIC_ACQUIRE);
+
+  if (LOG_FORMAT_SITE_BINARY == state) {
+    return (format == site->format) ? LOG_FORMAT_SITE_BINARY : LOG_FORMAT_SITE_TEXT_ONLY;
+  }
+  if (LOG_FORMAT_SITE_UNKNOWN != state) {
+    return LOG_FORMAT_SITE_TEXT_ONLY;
+  }
+  if (!__sync_bool_compare_and_swap (&site->state, LOG_FORMAT_SITE_UNKNOWN, LOG_FORMAT_SITE_PARSING)) {
+    return LOG_FORMAT_SITE_TEXT_ONLY;
+  }
+
+  state = LOG_FORMAT_SITE_BINARY;
+  while ((rc = log_binary_next_spec (&p, &spec)) > 0) {
+    if ((!spec.spec) || (LOG_BINARY_ARG_NONE == spec.type)) continue;
+    if ((num_args + spec.num_stars + 1) > LOG_BINARY_MAX_ARGS) {
+      state = LOG_FORMAT_SITE_TEXT_ONLY;
+      break;
+    }
+    for (int i = 0; i < spec.num_stars; i++) {
+      site->arg_types[num_args]      = LOG_BINARY_ARG_INT;
+      site->arg_max_length[num_args] = -1;
+      num_args++;
+    }
+    site->arg_types[num_args]      = spec.type;
+    site->arg_max_length[num_args] = -1;
+    if (LOG_BINARY_ARG_STRING == spec.type) {
+      if (spec.is_star_precision) {
+        site->arg_max_length[num_args] = -2;
+      } else if (0 <= spec.precision) {
+        site->arg_max_length[num_args] = spec.precision;
+      }
+    }
+    num_args++;
+  }
+  if (0 > rc) {
+    state = LOG_FORMAT_SITE_TEXT_ONLY;
+  }
+  site->num_args = num_args;
+  site->format   = format;
+  __atomic_store_n (&site->state, state, __ATOMIC_RELEASE);
+  return state;
+}
+
+//------------------------------------------------------------------------------
+log_binary_ring_t * log_binary_ring_create (const size_t size)
+{
+  log_binary_ring_t                      *ring = NULL;
+
+  if ((size < 1024) || (size & (size - 1))) {
+    return NULL;
+  }
+  if (posix_memalign ((void **)&ring, 64, sizeof(*ring))) {
+    return NULL;
+  }
+  memset(ring, 0, sizeof(*ring));
+  if (posix_memalign ((void **)&ring->buffer, 64, size)) {
+    free(ring);
+    return NULL;
+  }
+  ring->mask = size - 1;
+  return ring;
+}
+
+//------------------------------------------------------------------------------
+void log_binary_ring_free (log_binary_ring_t * ring)
+{
+  if (ring) {
+    free(ring->buffer);
+    free(ring);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Producer side, the arguments are fetched in one pass, then the record is copied in the ring and published.
+// Return 0 if the record was written, -1 if it was dropped.
+int log_binary_ring_write_message (log_binary_ring_t * const ring, log_binary_record_header_t * const header,
+                                   const log_format_site_t * const site, va_list args)
+{
+  uint64_t                                values[LOG_BINARY_MAX_ARGS];
+  const char                             *strings[LOG_BINARY_MAX_ARGS];
+  int64_t                                 last_int = -1;
+  size_t                                  size = sizeof(*header) + site->num_args * sizeof(uint64_t);
+  const uint64_t                          ring_size = ring->mask + 1;
+  uint64_t                                head = ring->head;
+  uint64_t                                tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+  uint64_t                                pos = 0;
+  uint64_t                                pad = 0;
+  uint8_t                                *p = NULL;
+
+  for (int i = 0; i < site->num_args; i++) {
+    strings[i] = NULL;
+    switch (site->arg_types[i]) {
+    case LOG_BINARY_ARG_INT:
+      last_int  = va_arg (args, int);
+      values[i] = (uint64_t)last_int;
+      break;
+    case LOG_BINARY_ARG_LONG:
+      values[i] = (uint64_t)va_arg (args, long);
+      break;
+    case LOG_BINARY_ARG_LLONG:
+      values[i] = (uint64_t)va_arg (args, long long);
+      break;
+    case LOG_BINARY_ARG_DOUBLE: {
+        double d = va_arg (args, double);
+        memcpy(&values[i], &d, sizeof(d));
+      }
+      break;
+    case LOG_BINARY_ARG_POINTER:
+      values[i] = (uint64_t)(uintptr_t)va_arg (args, void *);
+      break;
+    case LOG_BINARY_ARG_STRING: {
+        const char *s = va_arg (args, const char *);
+        size_t      max_length = LOG_BINARY_MAX_STRING_LENGTH;
+
+        if (-2 == site->arg_max_length[i]) {
+          if ((0 <= last_int) && (LOG_BINARY_MAX_STRING_LENGTH > last_int)) max_length = last_int;
+        } else if (0 <= site->arg_max_length[i]) {
+          max_length = site->arg_max_length[i];
+        }
+        if (s) {
+          strings[i] = s;
+          values[i]  = strnlen (s, max_length);
+          size      += LOG_BINARY_ALIGN(values[i] + 1);
+        } else {
+          values[i]  = LOG_BINARY_NULL_STRING;
+        }
+      }
+      break;
+    default:
+      values[i] = 0;
+    }
+  }
+
+  pos = head & ring->mask;
+  if ((pos + size) > ring_size) {
+    pad = ring_size - pos;
+  }
+  if ((ring_size - (head - tail)) < (pad + size)) {
+    __atomic_fetch_add (&ring->dropped, 1, __ATOMIC_RELAXED);
+    return -1;
+  }
+  if (pad) {
+    log_binary_record_header_t *padding = (log_binary_record_header_t *)&ring->buffer[pos];
+    padding->size = pad;
+    padding->type = LOG_BINARY_RECORD_PADDING;
+    head += pad;
+    pos   = 0;
+  }
+
+  header->size     = size;
+  header->type     = LOG_BINARY_RECORD_MESSAGE;
+  header->num_args = site->num_args;
+  p = &ring->buffer[pos];
+  memcpy(p, header, sizeof(*header));
+  p += sizeof(*header);
+  memcpy(p, values, site->num_args * sizeof(uint64_t));
+  p += site->num_args * sizeof(uint64_t);
+  for (int i = 0; i < site->num_args; i++) {
+    if (strings[i]) {
+      memcpy(p, strings[i], values[i]);
+      p[values[i]] = '\0';
+      p += LOG_BINARY_ALIGN(values[i] + 1);
+    }
+  }
+  __atomic_store_n (&ring->head, head + size, __ATOMIC_RELEASE);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Consumer side, return the oldest record of the ring or NULL if the ring is empty.
+const log_binary_record_header_t * log_binary_ring_peek (log_binary_ring_t * const ring)
+{
+  uint64_t                                tail = ring->tail;
+  uint64_t                                head = __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE);
+
+  while (tail != head) {
+    const log_binary_record_header_t *header = (const log_binary_record_header_t *)&ring->buffer[tail & ring->mask];
+    if (LOG_BINARY_RECORD_PADDING != header->type) {
+      return header;
+    }
+    tail += header->size;
+    __atomic_store_n (&ring->tail, tail, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+void log_binary_ring_release (log_binary_ring_t * const ring, const log_binary_record_header_t * const header)
+{
+  __atomic_store_n (&ring->tail, ring->tail + header->size, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+int log_format_header (bstring b, const uint64_t message_number, const long tv_sec, const long tv_usec,
+                       const unsigned long tid, const char * const level_name, const char * const proto_name,
+                       const char * const source_file, const unsigned int line_num, const int indent)
+{
+  int                                     filename_length = strlen(source_file);
+  const char                             *filename = source_file;
+
+  if (filename_length > LOG_DISPLAYED_FILENAME_MAX_LENGTH) {
+    filename = &source_file[filename_length-LOG_DISPLAYED_FILENAME_MAX_LENGTH];
+  }
+  return bformata (b, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
+      message_number, tv_sec, tv_usec, tid,
+      LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, level_name,
+      LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, proto_name,
+      LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, filename, line_num,
+      indent, " ");
+}
+
+//------------------------------------------------------------------------------
+#define LOG_BINARY_FORMAT_VALUE(vAlUe) \
+  ((0 == spec.num_stars) ? bformata (b, spec_str, vAlUe) : \
+   (1 == spec.num_stars) ? bformata (b, spec_str, stars[0], vAlUe) : bformata (b, spec_str, stars[0], stars[1], vAlUe))
+
+// Consumer side: walk the format again and format the recorded arguments one specification at a time.
+// The record may come from a file, every slot access is bounded by the record size.
+int log_binary_format_args (bstring b, const char * const format, const log_binary_record_header_t * const header)
+{
+  log_binary_spec_t                       spec = {0};
+  const char                             *p = format;
+  const uint8_t                          *end = (const uint8_t *)header + header->size;
+  const uint8_t                          *slot = (const uint8_t *)(header + 1);
+  const uint8_t                          *string = slot + header->num_args * sizeof(uint64_t);
+  int                                     arg = 0;
+  int                                     rc = 0;
+  char                                    spec_str[LOG_BINARY_MAX_SPEC_LENGTH];
+
+  if (string > end) {
+    return BSTR_ERR;
+  }
+  while ((rc = log_binary_next_spec (&p, &spec)) > 0) {
+    int       stars[2] = {0, 0};
+    uint64_t  value = 0;
+
+    if (spec.literal_length) {
+      bcatblk (b, spec.literal, spec.literal_length);
+    }
+    if (!spec.spec) continue;
+    if (LOG_BINARY_ARG_NONE == spec.type) {
+      bconchar (b, '%');
+      continue;
+    }
+    if ((arg + spec.num_stars + 1) > header->num_args) {
+      return BSTR_ERR;
+    }
+    for (int i = 0; i < spec.num_stars; i++) {
+      memcpy(&value, slot + (arg++) * sizeof(uint64_t), sizeof(value));
+      stars[i] = (int)(int64_t)value;
+    }
+    memcpy(&value, slot + (arg++) * sizeof(uint64_t), sizeof(value));
+    memcpy(spec_str, spec.spec, spec.spec_length);
+    spec_str[spec.spec_length] = '\0';
+
+    switch (spec.type) {
+    case LOG_BINARY_ARG_INT:
+      rc = LOG_BINARY_FORMAT_VALUE((int)(int64_t)value);
+      break;
+    case LOG_BINARY_ARG_LONG:
+      rc = LOG_BINARY_FORMAT_VALUE((long)value);
+      break;
+    case LOG_BINARY_ARG_LLONG:
+      rc = LOG_BINARY_FORMAT_VALUE((long long)value);
+      break;
+    case LOG_BINARY_ARG_DOUBLE: {
+        double d = 0;
+        memcpy(&d, &value, sizeof(d));
+        rc = LOG_BINARY_FORMAT_VALUE(d);
+      }
+      break;
+    case LOG_BINARY_ARG_POINTER:
+      rc = LOG_BINARY_FORMAT_VALUE((void *)(uintptr_t)value);
+      break;
+    case LOG_BINARY_ARG_STRING:
+      if (LOG_BINARY_NULL_STRING == value) {
+        rc = LOG_BINARY_FORMAT_VALUE((char *)NULL);
+      } else {
+        if ((value >= (uint64_t)(end - string)) || (string[value])) {
+          return BSTR_ERR;
+        }
+        rc = LOG_BINARY_FORMAT_VALUE((const char *)string);
+        string += LOG_BINARY_ALIGN(value + 1);
+      }
+      break;
+    default:
+      return BSTR_ERR;
+    }
+    if (BSTR_ERR == rc) {
+      return BSTR_ERR;
+    }
+  }
+  return (0 > rc) ? BSTR_ERR : BSTR_OK;
+}
+
+//------------------------------------------------------------------------------
+int log_binary_file_write_header (FILE * const fd, const uint32_t start_time_sec)
+{
+  uint32_t                                version_and_time[2] = {LOG_BINARY_FILE_VERSION, start_time_sec};
+
+  if (1 != fwrite (LOG_BINARY_FILE_MAGIC, 8, 1, fd)) return -1;
+  if (1 != fwrite (version_and_time, sizeof(version_and_time), 1, fd)) return -1;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Payload: uint32_t num_levels, uint32_t num_protos, then num_levels + num_protos names of LOG_BINARY_NAME_LENGTH bytes.
+int log_binary_file_write_names (FILE * const fd, const char * const * const level_names, const int num_levels,
+                                 const char * const * const proto_names, const int num_protos)
+{
+  log_binary_record_header_t              header = {0};
+  uint32_t                                counts[2] = {num_levels, num_protos};
+  char                                    name[LOG_BINARY_NAME_LENGTH];
+  size_t                                  size = sizeof(header) + sizeof(counts) + (num_levels + num_protos) * LOG_BINARY_NAME_LENGTH;
+  static const uint8_t                    zeroes[8] = {0};
+
+  header.size = LOG_BINARY_ALIGN(size);
+  header.type = LOG_BINARY_RECORD_NAMES;
+  if (1 != fwrite (&header, sizeof(header), 1, fd)) return -1;
+  if (1 != fwrite (counts, sizeof(counts), 1, fd)) return -1;
+  for (int i = 0; i < num_levels + num_protos; i++) {
+    memset(name, 0, sizeof(name));
+    strncpy(name, (i < num_levels) ? level_names[i] : proto_names[i - num_levels], LOG_BINARY_NAME_LENGTH - 1);
+    if (1 != fwrite (name, sizeof(name), 1, fd)) return -1;
+  }
+  if (header.size > size) {
+    if (1 != fwrite (zeroes, header.size - size, 1, fd)) return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Payload: uint32_t line_num, uint32_t file name length, uint32_t format length, uint32_t num_args,
+// then the NUL terminated file name and format.
+int log_binary_file_write_format (FILE * const fd, const log_format_site_t * const site)
+{
+  log_binary_record_header_t              header = {0};
+  uint32_t                                lengths[4] = {site->line_num, strlen(site->source_file), strlen(site->format), site->num_args};
+  size_t                                  size = sizeof(header) + sizeof(lengths) + lengths[1] + 1 + lengths[2] + 1;
+  static const uint8_t                    zeroes[8] = {0};
+
+  header.size     = LOG_BINARY_ALIGN(size);
+  header.type     = LOG_BINARY_RECORD_FORMAT;
+  header.site_id  = (uint64_t)(uintptr_t)site;
+  header.num_args = site->num_args;
+  if (1 != fwrite (&header, sizeof(header), 1, fd)) return -1;
+  if (1 != fwrite (lengths, sizeof(lengths), 1, fd)) return -1;
+  if (1 != fwrite (site->source_file, lengths[1] + 1, 1, fd)) return -1;
+  if (1 != fwrite (site->format, lengths[2] + 1, 1, fd)) return -1;
+  if (header.size > size) {
+    if (1 != fwrite (zeroes, header.size - size, 1, fd)) return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int log_binary_file_write_record (FILE * const fd, const log_binary_record_header_t * const header)
+{
+  return (1 == fwrite (header, header->size, 1, fd)) ? 0 : -1;
+}
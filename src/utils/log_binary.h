@@ -0,0 +1,160 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file log_binary.h
+   \brief Binary log records: per call site format descriptors, per thread SPSC byte rings,
+          deferred formatting of the raw arguments by the log consumer or by an offline decoder.
+*/
+
+#ifndef FILE_LOG_BINARY_SEEN
+#define FILE_LOG_BINARY_SEEN
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#include "bstrlib.h"
+
+#define LOG_BINARY_MAX_ARGS                 16         /*!< \brief a format with more arguments is logged on the text path */
+#define LOG_BINARY_MAX_STRING_LENGTH      1024         /*!< \brief %s arguments are truncated to this length */
+#define LOG_BINARY_MAX_SPEC_LENGTH          32         /*!< \brief max length of one conversion specification "%-*.*lx" */
+#define LOG_BINARY_RING_SIZE            524288         /*!< \brief per thread ring size in bytes, power of 2 */
+#define LOG_BINARY_NULL_STRING      0xFFFFFFFF         /*!< \brief length coding a NULL %s argument */
+
+#define LOG_BINARY_FILE_MAGIC       "OAILOGB1"
+#define LOG_BINARY_FILE_VERSION              1
+#define LOG_BINARY_NAME_LENGTH              16         /*!< \brief length of level and proto names in a names record */
+
+// Record alignment, every record (and every argument slot inside a record) starts on a 8 bytes boundary.
+#define LOG_BINARY_ALIGN(x)         (((x) + 7) & ~((size_t)7))
+
+typedef enum {
+  LOG_BINARY_ARG_NONE = 0,
+  LOG_BINARY_ARG_INT,
+  LOG_BINARY_ARG_LONG,
+  LOG_BINARY_ARG_LLONG,
+  LOG_BINARY_ARG_DOUBLE,
+  LOG_BINARY_ARG_STRING,
+  LOG_BINARY_ARG_POINTER,
+} log_binary_arg_type_t;
+
+typedef enum {
+  LOG_FORMAT_SITE_UNKNOWN   = 0,
+  LOG_FORMAT_SITE_PARSING   = 1,
+  LOG_FORMAT_SITE_BINARY    = 2,                       /*!< \brief arguments can be recorded raw */
+  LOG_FORMAT_SITE_TEXT_ONLY = 3,                       /*!< \brief format not supported by the binary path (%n, %m, positional args, ...) */
+} log_format_site_state_t;
+
+/*! \struct  log_format_site_t
+* \brief One static descriptor per OAILOG_* call site, its address is the format identifier of the binary records.
+* The argument types are deduced from the format string the first time the call site logs a message.
+*/
+typedef struct log_format_site_s {
+  const char                 *source_file;
+  unsigned int                line_num;
+  const char                 *format;                              /*!< \brief format string seen when the site was parsed */
+  volatile int                state;                               /*!< \brief log_format_site_state_t */
+  uint8_t                     num_args;
+  uint8_t                     arg_types[LOG_BINARY_MAX_ARGS];      /*!< \brief log_binary_arg_type_t, '*' width and precision are LOG_BINARY_ARG_INT */
+  int16_t                     arg_max_length[LOG_BINARY_MAX_ARGS]; /*!< \brief for %s: static precision, -1 none, -2 previous argument is the precision */
+  bool                        is_defined;                          /*!< \brief consumer side: definition already written in binary output file */
+} log_format_site_t;
+
+/*! \struct  log_binary_spec_t
+* \brief One conversion specification of a printf format, as seen by both producer and consumer of binary records.
+*/
+typedef struct log_binary_spec_s {
+  const char                 *literal;         /*!< \brief text preceding the specification */
+  size_t                      literal_length;
+  const char                 *spec;            /*!< \brief specification starting with '%', NULL if end of format */
+  size_t                      spec_length;
+  log_binary_arg_type_t       type;
+  int                         num_stars;       /*!< \brief number of '*' int arguments preceding the value */
+  bool                        is_star_precision;
+  int                         precision;       /*!< \brief static precision, -1 if none */
+} log_binary_spec_t;
+
+typedef enum {
+  LOG_BINARY_RECORD_PADDING = 0,                     /*!< \brief filler up to the end of the ring */
+  LOG_BINARY_RECORD_MESSAGE,
+  LOG_BINARY_RECORD_FORMAT,                          /*!< \brief binary output file only: definition of a call site */
+  LOG_BINARY_RECORD_NAMES,                           /*!< \brief binary output file only: level and proto names */
+} log_binary_record_type_t;
+
+/*! \struct  log_binary_record_header_t
+* \brief Header of every binary record, followed by the 8 bytes aligned argument slots.
+* A padding record only uses the size and type fields.
+*/
+typedef struct log_binary_record_header_s {
+  uint32_t                    size;            /*!< \brief total size of the record, header included, multiple of 8 */
+  uint8_t                     type;            /*!< \brief log_binary_record_type_t */
+  uint8_t                     log_level;
+  uint8_t                     proto;
+  uint8_t                     num_args;
+  uint64_t                    site_id;         /*!< \brief address of the log_format_site_t */
+  uint64_t                    message_number;
+  uint32_t                    tv_sec;          /*!< \brief elapsed time since logging start */
+  uint32_t                    tv_usec;
+  uint64_t                    tid;
+  int32_t                     indent;
+  uint32_t                    reserved;
+} log_binary_record_header_t;
+
+/*! \struct  log_binary_ring_t
+* \brief Single producer (the owner thread) single consumer (the log consumer) byte ring of binary records.
+* The producer never blocks: a record that does not fit is dropped and accounted.
+*/
+typedef struct log_binary_ring_s {
+  volatile uint64_t           head __attribute__((aligned(64)));  /*!< \brief written by the producer only */
+  volatile uint64_t           tail __attribute__((aligned(64)));  /*!< \brief written by the consumer only */
+  volatile uint64_t           dropped;                            /*!< \brief records dropped because the ring was full */
+  uint64_t                    reported_dropped;                   /*!< \brief consumer side */
+  uint64_t                    mask;
+  uint8_t                    *buffer;
+  void                       *thread_ctxt;                        /*!< \brief log_thread_ctxt_t of the owner thread */
+  volatile int                is_orphan;                          /*!< \brief owner thread exited, free once drained */
+  struct log_binary_ring_s   *next;
+} log_binary_ring_t;
+
+//------------------------------------------------------------------------------
+int log_binary_next_spec (const char ** const format, log_binary_spec_t * const spec);
+log_format_site_state_t log_format_site_parse (log_format_site_t * const site, const char * const format);
+
+log_binary_ring_t * log_binary_ring_create (const size_t size);
+void log_binary_ring_free (log_binary_ring_t * ring);
+int log_binary_ring_write_message (log_binary_ring_t * const ring, log_binary_record_header_t * const header,
+                                   const log_format_site_t * const site, va_list args);
+const log_binary_record_header_t * log_binary_ring_peek (log_binary_ring_t * const ring);
+void log_binary_ring_release (log_binary_ring_t * const ring, const log_binary_record_header_t * const header);
+
+int log_format_header (bstring b, const uint64_t message_number, const long tv_sec, const long tv_usec,
+                       const unsigned long tid, const char * const level_name, const char * const proto_name,
+                       const char * const source_file, const unsigned int line_num, const int indent);
+int log_binary_format_args (bstring b, const char * const format, const log_binary_record_header_t * const header);
+
+int log_binary_file_write_header (FILE * const fd, const uint32_t start_time_sec);
+int log_binary_file_write_names (FILE * const fd, const char * const * const level_names, const int num_levels,
+                                 const char * const * const proto_names, const int num_protos);
+int log_binary_file_write_format (FILE * const fd, const log_format_site_t * const site);
+int log_binary_file_write_record (FILE * const fd, const log_binary_record_header_t * const header);
+
+#endif /* FILE_LOG_BINARY_SEEN */
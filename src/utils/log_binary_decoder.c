@@ -0,0 +1,252 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file log_binary_decoder.c
+   \brief Offline decoder of the binary log files written when LOGGING.BINARY = "yes" and LOGGING.BINARY_FILE is set.
+          Usage: oai_log_decoder binary_log_file [text_output_file]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include "bstrlib.h"
+#include "log_binary.h"
+
+#define LOG_DECODER_MAX_RECORD_SIZE   (1024 * 1024)
+#define LOG_DECODER_MAX_NAMES          256
+
+typedef struct log_decoder_site_s {
+  uint64_t                    site_id;
+  unsigned int                line_num;
+  char                       *source_file;
+  char                       *format;
+} log_decoder_site_t;
+
+typedef struct log_decoder_s {
+  log_decoder_site_t         *sites;           /*!< \brief open addressing table of the call sites, key site_id */
+  size_t                      size;            /*!< \brief power of 2 */
+  size_t                      num_sites;
+  char                       *level_names[LOG_DECODER_MAX_NAMES];
+  int                         num_levels;
+  char                       *proto_names[LOG_DECODER_MAX_NAMES];
+  int                         num_protos;
+} log_decoder_t;
+
+//------------------------------------------------------------------------------
+static log_decoder_site_t * log_decoder_find (log_decoder_t * const decoder, const uint64_t site_id)
+{
+  size_t                                  i = (site_id >> 3) & (decoder->size - 1);
+
+  while (decoder->sites[i].format) {
+    if (decoder->sites[i].site_id == site_id) {
+      return &decoder->sites[i];
+    }
+    i = (i + 1) & (decoder->size - 1);
+  }
+  return &decoder->sites[i];
+}
+
+//------------------------------------------------------------------------------
+static void log_decoder_grow (log_decoder_t * const decoder)
+{
+  log_decoder_site_t                     *old_sites = decoder->sites;
+  size_t                                  old_size = decoder->size;
+
+  decoder->size  = (old_size) ? old_size * 2 : 1024;
+  decoder->sites = calloc (decoder->size, sizeof(log_decoder_site_t));
+  if (!decoder->sites) {
+    fprintf (stderr, "Out of memory\n");
+    exit (EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < old_size; i++) {
+    if (old_sites[i].format) {
+      *log_decoder_find (decoder, old_sites[i].site_id) = old_sites[i];
+    }
+  }
+  free (old_sites);
+}
+
+//------------------------------------------------------------------------------
+static int log_decoder_add_format (log_decoder_t * const decoder, const log_binary_record_header_t * const header)
+{
+  const uint8_t                          *payload = (const uint8_t *)(header + 1);
+  uint32_t                                lengths[4];
+  size_t                                  payload_size = header->size - sizeof(*header);
+  log_decoder_site_t                     *site = NULL;
+
+  if (payload_size < sizeof(lengths)) return -1;
+  memcpy (lengths, payload, sizeof(lengths));
+  if (((size_t)lengths[1] + lengths[2] + 2) > (payload_size - sizeof(lengths))) return -1;
+  payload += sizeof(lengths);
+  if ((payload[lengths[1]]) || (payload[lengths[1] + 1 + lengths[2]])) return -1;
+
+  if ((decoder->num_sites + 1) * 2 > decoder->size) {
+    log_decoder_grow (decoder);
+  }
+  site = log_decoder_find (decoder, header->site_id);
+  if (!site->format) {
+    decoder->num_sites++;
+  } else {
+    free (site->source_file);
+    free (site->format);
+  }
+  site->site_id     = header->site_id;
+  site->line_num    = lengths[0];
+  site->source_file = strdup ((const char *)payload);
+  site->format      = strdup ((const char *)&payload[lengths[1] + 1]);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int log_decoder_set_names (log_decoder_t * const decoder, const log_binary_record_header_t * const header)
+{
+  const uint8_t                          *payload = (const uint8_t *)(header + 1);
+  uint32_t                                counts[2];
+  size_t                                  payload_size = header->size - sizeof(*header);
+
+  if (payload_size < sizeof(counts)) return -1;
+  memcpy (counts, payload, sizeof(counts));
+  if ((counts[0] > LOG_DECODER_MAX_NAMES) || (counts[1] > LOG_DECODER_MAX_NAMES)) return -1;
+  if (((size_t)counts[0] + counts[1]) * LOG_BINARY_NAME_LENGTH > (payload_size - sizeof(counts))) return -1;
+  payload += sizeof(counts);
+  for (uint32_t i = 0; i < counts[0] + counts[1]; i++) {
+    char *name = strndup ((const char *)&payload[i * LOG_BINARY_NAME_LENGTH], LOG_BINARY_NAME_LENGTH - 1);
+    if (i < counts[0]) {
+      free (decoder->level_names[i]);
+      decoder->level_names[i] = name;
+    } else {
+      free (decoder->proto_names[i - counts[0]]);
+      decoder->proto_names[i - counts[0]] = name;
+    }
+  }
+  decoder->num_levels = counts[0];
+  decoder->num_protos = counts[1];
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static void log_decoder_output_message (log_decoder_t * const decoder, const log_binary_record_header_t * const header,
+                                        bstring b, FILE * const out)
+{
+  log_decoder_site_t                     *site = NULL;
+
+  btrunc (b, 0);
+  if (decoder->size) {
+    site = log_decoder_find (decoder, header->site_id);
+  }
+  if ((!site) || (!site->format)) {
+    bformata (b, "%06" PRIu64 " <unknown log format %016" PRIx64 ">\n", header->message_number, header->site_id);
+  } else {
+    log_format_header (b, header->message_number, header->tv_sec, header->tv_usec, header->tid,
+        (header->log_level < decoder->num_levels) ? decoder->level_names[header->log_level] : "?",
+        (header->proto < decoder->num_protos) ? decoder->proto_names[header->proto] : "?",
+        site->source_file, site->line_num, header->indent);
+    if (BSTR_ERR == log_binary_format_args (b, site->format, header)) {
+      bcatcstr (b, " <undecodable binary log record>\n");
+    }
+  }
+  fwrite (b->data, b->slen, 1, out);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char *argv[])
+{
+  FILE                                   *in = NULL;
+  FILE                                   *out = stdout;
+  char                                    magic[8];
+  uint32_t                                version_and_time[2];
+  log_binary_record_header_t             *header = NULL;
+  log_decoder_t                           decoder = {0};
+  bstring                                 b = bfromcstralloc (256, "");
+  uint64_t                                num_records = 0;
+  int                                     rc = EXIT_SUCCESS;
+
+  if ((argc < 2) || (argc > 3)) {
+    fprintf (stderr, "Usage: %s binary_log_file [text_output_file]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  in = fopen (argv[1], "r");
+  if (!in) {
+    fprintf (stderr, "Could not open %s: %s\n", argv[1], strerror (errno));
+    return EXIT_FAILURE;
+  }
+  if (3 == argc) {
+    out = fopen (argv[2], "w");
+    if (!out) {
+      fprintf (stderr, "Could not open %s: %s\n", argv[2], strerror (errno));
+      return EXIT_FAILURE;
+    }
+  }
+  if ((1 != fread (magic, sizeof(magic), 1, in)) || (memcmp (magic, LOG_BINARY_FILE_MAGIC, sizeof(magic))) ||
+      (1 != fread (version_and_time, sizeof(version_and_time), 1, in)) || (LOG_BINARY_FILE_VERSION != version_and_time[0])) {
+    fprintf (stderr, "%s is not a binary log file\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  header = malloc (LOG_DECODER_MAX_RECORD_SIZE);
+  if ((!header) || (!b)) {
+    fprintf (stderr, "Out of memory\n");
+    return EXIT_FAILURE;
+  }
+
+  while (1 == fread (header, sizeof(*header), 1, in)) {
+    if ((header->size < sizeof(*header)) || (header->size > LOG_DECODER_MAX_RECORD_SIZE) || (header->size & 7)) {
+      fprintf (stderr, "Bad record size %u after %" PRIu64 " records\n", header->size, num_records);
+      rc = EXIT_FAILURE;
+      break;
+    }
+    if ((header->size > sizeof(*header)) && (1 != fread (header + 1, header->size - sizeof(*header), 1, in))) {
+      fprintf (stderr, "Truncated record after %" PRIu64 " records\n", num_records);
+      rc = EXIT_FAILURE;
+      break;
+    }
+    num_records++;
+    switch (header->type) {
+    case LOG_BINARY_RECORD_MESSAGE:
+      log_decoder_output_message (&decoder, header, b, out);
+      break;
+    case LOG_BINARY_RECORD_FORMAT:
+      if (log_decoder_add_format (&decoder, header)) {
+        fprintf (stderr, "Bad format record %" PRIu64 "\n", num_records);
+      }
+      break;
+    case LOG_BINARY_RECORD_NAMES:
+      if (log_decoder_set_names (&decoder, header)) {
+        fprintf (stderr, "Bad names record %" PRIu64 "\n", num_records);
+      }
+      break;
+    default:;
+    }
+  }
+
+  free (header);
+  bdestroy (b);
+  fclose (in);
+  if (stdout != out) {
+    fclose (out);
+  }
+  return rc;
+}
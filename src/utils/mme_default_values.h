@@ -43,6 +43,13 @@
 
 #define S1AP_OUTCOME_TIMER_DEFAULT (5)     ///< S1AP Outcome drop timer (s)
 
+#define S1AP_ENB_UE_COLL_INITIAL_SIZE (4)  ///< Initial buckets (and lock stripes) of the UE table of an eNB, it doubles with the UE count
+#define S1AP_UE_SLAB_CHUNK_UES        (512) ///< ue_description_t per chunk of the S1AP UE slab
+#define S1AP_ENB_MAX_SUPPORTED_TAI    (16)  ///< TAIs of an eNB (TAC x broadcast PLMN) entered in the TAI->eNB paging index
+#define S1AP_TAI_INDEX_INITIAL_SIZE   (64)  ///< Initial buckets of the TAI->eNB paging index
+#define S1AP_PAGING_COALESCE_WINDOW_US (10000) ///< Pagings of a TAI list are sent together at most this late (us), 0 disables coalescing
+#define S1AP_PAGING_GROUP_COLL_SIZE   (64)  ///< Buckets of the TAI lists being paged within the coalescing window
+
 /*******************************************************************************
  * S6A Constants
  ******************************************************************************/
@@ -57,6 +64,19 @@
 #define SCTP_OUT_STREAMS      (32)
 #define SCTP_IN_STREAMS       (32)
 #define SCTP_MAX_ATTEMPTS     (5)
+#define SCTP_WORKERS          (2)
+#define SCTP_MAX_WORKERS      (64)
+#define SCTP_RECV_BATCH       (16)    /* messages read per recvmmsg() call */
+#define SCTP_EPOLL_MAX_EVENTS (64)
+#define SCTP_LISTEN_BACKLOG   (128)
+
+/*******************************************************************************
+ * MME_APP Constants
+ ******************************************************************************/
+
+#define MME_APP_SHARDS                   (1)     /* worker threads handling the UE related messages, 0: handled by the MME_APP task */
+#define MME_APP_MAX_SHARDS               (64)
+#define MME_APP_SHARD_QUEUE_INITIAL_SIZE (1024)  /* messages, power of 2, the queue of a shard doubles when full */
 
 /*******************************************************************************
  * MME global definitions
@@ -0,0 +1,238 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file obj_slab.c
+   \brief Slab of fixed size objects: objects are packed in aligned chunks without any per object
+          allocator header, chunks are allocated on demand and released once empty.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "obj_slab.h"
+
+// Chunk header, followed by the objects. Objects are handed out first from the free list, then from the never used
+// tail of the chunk (num_carved), so the pages of a fresh chunk are only touched when the objects are used.
+typedef struct obj_slab_chunk_s {
+  struct obj_slab_chunk_s        *prev;               // partial_chunks list
+  struct obj_slab_chunk_s        *next;
+  struct obj_slab_chunk_s        *all_prev;           // every chunk of the slab, for obj_slab_destroy()
+  struct obj_slab_chunk_s        *all_next;
+  void                           *free_list;          // freed objects, the link is stored in the object
+  uint32_t                        num_free;
+  uint32_t                        num_carved;
+} obj_slab_chunk_t;
+
+#define OBJ_SLAB_CHUNK_HEADER_SIZE     ((sizeof (obj_slab_chunk_t) + 15) & ~((size_t)15))
+
+// slab and the list of all its chunks
+typedef struct obj_slab_impl_s {
+  obj_slab_t                      slab;
+  obj_slab_chunk_t               *all_chunks;
+} obj_slab_impl_t;
+
+//------------------------------------------------------------------------------
+static inline obj_slab_chunk_t *obj_slab_chunk_of (const obj_slab_t * const slab, const void * const obj)
+{
+  return (obj_slab_chunk_t *)((uintptr_t)obj & ~((uintptr_t)slab->chunk_size - 1));
+}
+
+//------------------------------------------------------------------------------
+static inline void obj_slab_partial_link (obj_slab_t * const slab, obj_slab_chunk_t * const chunk)
+{
+  chunk->prev = NULL;
+  chunk->next = slab->partial_chunks;
+  if (slab->partial_chunks) {
+    slab->partial_chunks->prev = chunk;
+  }
+  slab->partial_chunks = chunk;
+}
+
+//------------------------------------------------------------------------------
+static inline void obj_slab_partial_unlink (obj_slab_t * const slab, obj_slab_chunk_t * const chunk)
+{
+  if (chunk->prev) {
+    chunk->prev->next = chunk->next;
+  } else {
+    slab->partial_chunks = chunk->next;
+  }
+  if (chunk->next) {
+    chunk->next->prev = chunk->prev;
+  }
+  chunk->prev = NULL;
+  chunk->next = NULL;
+}
+
+//------------------------------------------------------------------------------
+static obj_slab_chunk_t *obj_slab_chunk_new (obj_slab_impl_t * const impl)
+{
+  obj_slab_t                             *slab = &impl->slab;
+  obj_slab_chunk_t                       *chunk = NULL;
+
+  if (posix_memalign ((void **)&chunk, slab->chunk_size, slab->chunk_size)) {
+    return NULL;
+  }
+  memset (chunk, 0, sizeof (*chunk));
+  chunk->num_free = slab->objs_per_chunk;
+  chunk->all_next = impl->all_chunks;
+  if (impl->all_chunks) {
+    impl->all_chunks->all_prev = chunk;
+  }
+  impl->all_chunks = chunk;
+  slab->num_chunks += 1;
+  return chunk;
+}
+
+//------------------------------------------------------------------------------
+static void obj_slab_chunk_release (obj_slab_impl_t * const impl, obj_slab_chunk_t * const chunk)
+{
+  if (chunk->all_prev) {
+    chunk->all_prev->all_next = chunk->all_next;
+  } else {
+    impl->all_chunks = chunk->all_next;
+  }
+  if (chunk->all_next) {
+    chunk->all_next->all_prev = chunk->all_prev;
+  }
+  impl->slab.num_chunks -= 1;
+  free (chunk);
+}
+
+//------------------------------------------------------------------------------
+obj_slab_t *obj_slab_create (const size_t obj_size, const uint32_t objs_per_chunk, bstring name)
+{
+  obj_slab_impl_t                        *impl = NULL;
+  obj_slab_t                             *slab = NULL;
+  size_t                                  size = 0;
+
+  if ((!obj_size) || (!objs_per_chunk)) {
+    return NULL;
+  }
+  if (!(impl = calloc (1, sizeof (obj_slab_impl_t)))) {
+    return NULL;
+  }
+  slab = &impl->slab;
+  // an object must be able to hold the free list link
+  slab->obj_size = (obj_size < sizeof (void *)) ? sizeof (void *) : ((obj_size + 7) & ~((size_t)7));
+  size = OBJ_SLAB_CHUNK_HEADER_SIZE + slab->obj_size * objs_per_chunk;
+  slab->chunk_size = OBJ_SLAB_MIN_CHUNK_SIZE;
+  while (slab->chunk_size < size) {
+    slab->chunk_size <<= 1;
+  }
+  // fill the rounded up chunk
+  slab->objs_per_chunk = (uint32_t)((slab->chunk_size - OBJ_SLAB_CHUNK_HEADER_SIZE) / slab->obj_size);
+  pthread_mutex_init (&slab->mutex, NULL);
+  slab->name = (name) ? bstrcpy (name) : bformat ("obj_slab@%p", slab);
+  return slab;
+}
+
+//------------------------------------------------------------------------------
+void obj_slab_destroy (obj_slab_t * const slab)
+{
+  obj_slab_impl_t                        *impl = (obj_slab_impl_t *)slab;
+
+  if (!slab) {
+    return;
+  }
+  while (impl->all_chunks) {
+    obj_slab_chunk_release (impl, impl->all_chunks);
+  }
+  pthread_mutex_destroy (&slab->mutex);
+  bdestroy_wrapper (&slab->name);
+  free (impl);
+}
+
+//------------------------------------------------------------------------------
+void *obj_slab_alloc (obj_slab_t * const slab)
+{
+  obj_slab_impl_t                        *impl = (obj_slab_impl_t *)slab;
+  obj_slab_chunk_t                       *chunk = NULL;
+  void                                   *obj = NULL;
+
+  pthread_mutex_lock (&slab->mutex);
+  if (!(chunk = slab->partial_chunks)) {
+    if ((chunk = slab->spare_chunk)) {
+      slab->spare_chunk = NULL;
+    } else if (!(chunk = obj_slab_chunk_new (impl))) {
+      pthread_mutex_unlock (&slab->mutex);
+      return NULL;
+    }
+    obj_slab_partial_link (slab, chunk);
+  }
+  if (chunk->free_list) {
+    obj = chunk->free_list;
+    chunk->free_list = *(void **)obj;
+  } else {
+    obj = (uint8_t *)chunk + OBJ_SLAB_CHUNK_HEADER_SIZE + (size_t)chunk->num_carved * slab->obj_size;
+    chunk->num_carved += 1;
+  }
+  chunk->num_free -= 1;
+  if (!chunk->num_free) {
+    obj_slab_partial_unlink (slab, chunk);
+  }
+  slab->num_objs += 1;
+  pthread_mutex_unlock (&slab->mutex);
+  memset (obj, 0, slab->obj_size);
+  return obj;
+}
+
+//------------------------------------------------------------------------------
+void obj_slab_free (obj_slab_t * const slab, void * const obj)
+{
+  obj_slab_impl_t                        *impl = (obj_slab_impl_t *)slab;
+  obj_slab_chunk_t                       *chunk = NULL;
+
+  if (!obj) {
+    return;
+  }
+  chunk = obj_slab_chunk_of (slab, obj);
+  pthread_mutex_lock (&slab->mutex);
+  *(void **)obj = chunk->free_list;
+  chunk->free_list = obj;
+  chunk->num_free += 1;
+  slab->num_objs -= 1;
+  if (1 == chunk->num_free) {
+    obj_slab_partial_link (slab, chunk);
+  }
+  if (chunk->num_free == slab->objs_per_chunk) {
+    obj_slab_partial_unlink (slab, chunk);
+    if (slab->spare_chunk) {
+      obj_slab_chunk_release (impl, chunk);
+    } else {
+      // recarve from the start, the free list order does not matter any more
+      chunk->free_list = NULL;
+      chunk->num_carved = 0;
+      slab->spare_chunk = chunk;
+    }
+  }
+  pthread_mutex_unlock (&slab->mutex);
+}
+
+//------------------------------------------------------------------------------
+size_t obj_slab_memory (const obj_slab_t * const slab)
+{
+  return (size_t)slab->num_chunks * slab->chunk_size;
+}
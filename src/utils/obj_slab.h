@@ -0,0 +1,62 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file obj_slab.h
+   \brief Slab of fixed size objects: objects are packed in aligned chunks without any per object
+          allocator header, chunks are allocated on demand and released once empty.
+*/
+
+#ifndef FILE_OBJ_SLAB_SEEN
+#define FILE_OBJ_SLAB_SEEN
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+
+#define OBJ_SLAB_MIN_CHUNK_SIZE          4096          /*!< \brief chunk size in bytes is a power of 2, at least this value */
+
+struct obj_slab_chunk_s;
+
+/*! \struct  obj_slab_t
+* \brief Objects of one size. The chunk of an object is found by masking its address with the chunk size,
+* chunks having free objects are linked in a list, at most one empty chunk is kept as a spare.
+*/
+typedef struct obj_slab_s {
+  pthread_mutex_t                 mutex;
+  size_t                          obj_size;           /*!< \brief rounded up to a multiple of 8 bytes */
+  size_t                          chunk_size;         /*!< \brief bytes, power of 2, chunks are aligned on this size */
+  uint32_t                        objs_per_chunk;
+  struct obj_slab_chunk_s        *partial_chunks;     /*!< \brief chunks with at least one free object */
+  struct obj_slab_chunk_s        *spare_chunk;        /*!< \brief empty chunk kept to avoid alloc/free ping-pong */
+  uint64_t                        num_objs;           /*!< \brief objects in use */
+  uint64_t                        num_chunks;         /*!< \brief chunks allocated, spare included */
+  bstring                         name;
+} obj_slab_t;
+
+obj_slab_t *obj_slab_create (const size_t obj_size, const uint32_t objs_per_chunk, bstring name);
+void        obj_slab_destroy (obj_slab_t * const slab);
+void       *obj_slab_alloc (obj_slab_t * const slab) __attribute__ ((hot));   /*!< \brief zeroed object, NULL if out of memory */
+void        obj_slab_free (obj_slab_t * const slab, void * const obj) __attribute__ ((hot));
+size_t      obj_slab_memory (const obj_slab_t * const slab);                  /*!< \brief bytes held by the slab chunks */
+
+#endif /* FILE_OBJ_SLAB_SEEN */
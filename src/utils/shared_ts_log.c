@@ -186,6 +186,7 @@ void* shared_log_task (__attribute__ ((unused)) void *args_p)
       switch (ITTI_MSG_ID (received_message_p)) {
       case TIMER_HAS_EXPIRED:{
 //    todo:    shared_log_flush_messages ();
+        log_binary_flush_messages ();
         timer_setup (LOG_FLUSH_PERIOD_SEC,
             LOG_FLUSH_PERIOD_MICRO_SEC,
             TASK_SHARED_TS_LOG, INSTANCE_DEFAULT, TIMER_ONE_SHOT, NULL, &timer_id);
@@ -200,6 +201,7 @@ void* shared_log_task (__attribute__ ((unused)) void *args_p)
               timer_remove (timer_id, NULL);
               timer_id = -1;
             }
+            log_binary_flush_messages ();
             shared_log_exit ();
             itti_exit_task ();
           }
@@ -0,0 +1,300 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file teid_pool.c
+   \brief Sharded pool of unique TEIDs with a quarantine before reuse.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "common_defs.h"
+#include "teid_pool.h"
+
+#define TEID_POOL_WORD_SHIFT              6
+#define TEID_POOL_WORD_MASK               63
+#define TEID_POOL_MIN_WORDS               16
+#define TEID_POOL_MIN_RELEASED            64
+
+static __thread int                     teid_pool_thread_shard = -1;
+static int                              teid_pool_next_thread_shard = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t teid_pool_clock_ms (void)
+{
+  struct timespec                         ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t teid_pool_now_ms (const teid_pool_t * const pool)
+{
+  return (uint32_t)(teid_pool_clock_ms () - pool->epoch_ms);
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t teid_pool_make_teid (const teid_pool_t * const pool, const int shard, const uint32_t index)
+{
+  uint64_t                                teid = index;
+
+  teid |= (uint64_t)shard << pool->index_bits;
+  teid |= (uint64_t)pool->node_id << (pool->index_bits + pool->shard_bits);
+  return (uint32_t)teid;
+}
+
+//------------------------------------------------------------------------------
+// shard and index of a TEID, false if it does not belong to the pool
+static inline bool teid_pool_split_teid (const teid_pool_t * const pool, const uint32_t teid, int * const shard, uint32_t * const index)
+{
+  const uint64_t                          t = teid;
+
+  if ((t >> (pool->index_bits + pool->shard_bits)) != pool->node_id) {
+    return false;
+  }
+  *shard = (int)((t >> pool->index_bits) & ((1ULL << pool->shard_bits) - 1));
+  *index = (uint32_t)(t & ((1ULL << pool->index_bits) - 1));
+  return (0 != *index);
+}
+
+//------------------------------------------------------------------------------
+static inline bool teid_pool_test_bit (const teid_pool_shard_t * const s, const uint32_t index)
+{
+  return ((index >> TEID_POOL_WORD_SHIFT) < s->num_words) &&
+         (s->allocated[index >> TEID_POOL_WORD_SHIFT] & (1ULL << (index & TEID_POOL_WORD_MASK)));
+}
+
+//------------------------------------------------------------------------------
+// bitmap large enough for index
+static int teid_pool_grow_bitmap (const teid_pool_t * const pool, teid_pool_shard_t * const s, const uint32_t index)
+{
+  const uint64_t                          max_words = (((uint64_t)pool->last_index) >> TEID_POOL_WORD_SHIFT) + 1;
+  uint64_t                                num_words = (s->num_words) ? s->num_words : TEID_POOL_MIN_WORDS;
+  uint64_t                               *allocated = NULL;
+
+  while (num_words <= (index >> TEID_POOL_WORD_SHIFT)) {
+    num_words *= 2;
+  }
+  if (num_words > max_words) {
+    num_words = max_words;
+  }
+  allocated = realloc (s->allocated, num_words * sizeof (uint64_t));
+  if (!allocated) {
+    return RETURNerror;
+  }
+  memset (&allocated[s->num_words], 0, (num_words - s->num_words) * sizeof (uint64_t));
+  s->allocated = allocated;
+  s->num_words = (uint32_t)num_words;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+// room for one more released index, the FIFO is unwrapped in the new ring
+static int teid_pool_grow_released (teid_pool_shard_t * const s)
+{
+  const uint32_t                          size = (s->released_size) ? s->released_size * 2 : TEID_POOL_MIN_RELEASED;
+  teid_pool_released_t                   *released = calloc (size, sizeof (teid_pool_released_t));
+
+  if (!released) {
+    return RETURNerror;
+  }
+  for (uint32_t i = 0; i < s->num_released; i++) {
+    released[i] = s->released[(s->released_head + i) & (s->released_size - 1)];
+  }
+  if (s->released) {
+    free_wrapper ((void **)&s->released);
+  }
+  s->released = released;
+  s->released_size = size;
+  s->released_head = 0;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+teid_pool_t *teid_pool_create (const int num_shards, const uint32_t node_id, const int node_id_bits, const uint32_t quarantine_ms)
+{
+  teid_pool_t                            *pool = NULL;
+  int                                     shard_bits = 0;
+
+  if ((num_shards < 1) || (num_shards > (1 << TEID_POOL_MAX_SHARD_BITS)) ||
+      (node_id_bits < 0) || (node_id_bits > TEID_POOL_MAX_NODE_ID_BITS) || (((uint64_t)node_id >> node_id_bits) != 0)) {
+    return NULL;
+  }
+  while ((1 << shard_bits) < num_shards) {
+    shard_bits++;
+  }
+  pool = calloc (1, sizeof (*pool));
+  if (!pool) {
+    return NULL;
+  }
+  pool->node_id = node_id;
+  pool->node_id_bits = node_id_bits;
+  pool->shard_bits = shard_bits;
+  pool->index_bits = 32 - node_id_bits - shard_bits;
+  pool->last_index = (uint32_t)((1ULL << pool->index_bits) - 1);
+  pool->quarantine_ms = quarantine_ms;
+  pool->epoch_ms = teid_pool_clock_ms ();
+  pool->num_shards = 1 << shard_bits;
+  if (posix_memalign ((void **)&pool->shards, 64, pool->num_shards * sizeof (teid_pool_shard_t))) {
+    free_wrapper ((void **)&pool);
+    return NULL;
+  }
+  memset (pool->shards, 0, pool->num_shards * sizeof (teid_pool_shard_t));
+  for (int i = 0; i < pool->num_shards; i++) {
+    pthread_mutex_init (&pool->shards[i].lock, NULL);
+    pool->shards[i].next_fresh = 1;
+  }
+  return pool;
+}
+
+//------------------------------------------------------------------------------
+void teid_pool_destroy (teid_pool_t * const pool)
+{
+  teid_pool_t                            *p = pool;
+
+  if (p) {
+    for (int i = 0; i < pool->num_shards; i++) {
+      pthread_mutex_destroy (&pool->shards[i].lock);
+      if (pool->shards[i].allocated) {
+        free_wrapper ((void **)&pool->shards[i].allocated);
+      }
+      if (pool->shards[i].released) {
+        free_wrapper ((void **)&pool->shards[i].released);
+      }
+    }
+    free_wrapper ((void **)&p->shards);
+    free_wrapper ((void **)&p);
+  }
+}
+
+//------------------------------------------------------------------------------
+// index 0 if the shard has no TEID available
+static uint32_t teid_pool_alloc_in_shard (teid_pool_t * const pool, const int shard)
+{
+  teid_pool_shard_t                      *s = &pool->shards[shard];
+  uint32_t                                index = 0;
+
+  pthread_mutex_lock (&s->lock);
+  if ((s->num_released) &&
+      ((0 == pool->quarantine_ms) || ((uint32_t)(teid_pool_now_ms (pool) - s->released[s->released_head].date_ms) >= pool->quarantine_ms))) {
+    index = s->released[s->released_head].index;
+    s->released_head = (s->released_head + 1) & (s->released_size - 1);
+    s->num_released--;
+  } else if (s->next_fresh <= pool->last_index) {
+    if (((s->next_fresh >> TEID_POOL_WORD_SHIFT) >= s->num_words) && (RETURNok != teid_pool_grow_bitmap (pool, s, (uint32_t)s->next_fresh))) {
+      pthread_mutex_unlock (&s->lock);
+      return 0;
+    }
+    index = (uint32_t)s->next_fresh++;
+  }
+  if (index) {
+    s->allocated[index >> TEID_POOL_WORD_SHIFT] |= 1ULL << (index & TEID_POOL_WORD_MASK);
+    s->num_allocated++;
+  }
+  pthread_mutex_unlock (&s->lock);
+  return index;
+}
+
+//------------------------------------------------------------------------------
+uint32_t teid_pool_alloc (teid_pool_t * const pool, const int shard)
+{
+  int                                     first = shard;
+
+  if (TEID_POOL_ANY_SHARD == first) {
+    if (0 > teid_pool_thread_shard) {
+      teid_pool_thread_shard = __sync_fetch_and_add (&teid_pool_next_thread_shard, 1) & ((1 << TEID_POOL_MAX_SHARD_BITS) - 1);
+    }
+    first = teid_pool_thread_shard;
+  }
+  first &= pool->num_shards - 1;
+  for (int i = 0; i < pool->num_shards; i++) {
+    const int                               s = (first + i) & (pool->num_shards - 1);
+    const uint32_t                          index = teid_pool_alloc_in_shard (pool, s);
+
+    if (index) {
+      return teid_pool_make_teid (pool, s, index);
+    }
+  }
+  return TEID_POOL_INVALID_TEID;
+}
+
+//------------------------------------------------------------------------------
+int teid_pool_release (teid_pool_t * const pool, const uint32_t teid)
+{
+  teid_pool_shard_t                      *s = NULL;
+  teid_pool_released_t                   *r = NULL;
+  int                                     shard = 0;
+  uint32_t                                index = 0;
+
+  if (!teid_pool_split_teid (pool, teid, &shard, &index)) {
+    return RETURNerror;
+  }
+  s = &pool->shards[shard];
+  pthread_mutex_lock (&s->lock);
+  if ((!teid_pool_test_bit (s, index)) ||
+      ((s->num_released == s->released_size) && (RETURNok != teid_pool_grow_released (s)))) {
+    pthread_mutex_unlock (&s->lock);
+    return RETURNerror;
+  }
+  s->allocated[index >> TEID_POOL_WORD_SHIFT] &= ~(1ULL << (index & TEID_POOL_WORD_MASK));
+  s->num_allocated--;
+  r = &s->released[(s->released_head + s->num_released) & (s->released_size - 1)];
+  r->index = index;
+  r->date_ms = (pool->quarantine_ms) ? teid_pool_now_ms (pool) : 0;
+  s->num_released++;
+  pthread_mutex_unlock (&s->lock);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+bool teid_pool_is_allocated (teid_pool_t * const pool, const uint32_t teid)
+{
+  int                                     shard = 0;
+  uint32_t                                index = 0;
+  bool                                    allocated = false;
+
+  if (teid_pool_split_teid (pool, teid, &shard, &index)) {
+    pthread_mutex_lock (&pool->shards[shard].lock);
+    allocated = teid_pool_test_bit (&pool->shards[shard], index);
+    pthread_mutex_unlock (&pool->shards[shard].lock);
+  }
+  return allocated;
+}
+
+//------------------------------------------------------------------------------
+uint32_t teid_pool_num_allocated (teid_pool_t * const pool)
+{
+  uint32_t                                n = 0;
+
+  for (int i = 0; i < pool->num_shards; i++) {
+    pthread_mutex_lock (&pool->shards[i].lock);
+    n += pool->shards[i].num_allocated;
+    pthread_mutex_unlock (&pool->shards[i].lock);
+  }
+  return n;
+}
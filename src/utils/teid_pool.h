@@ -0,0 +1,100 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file teid_pool.h
+   \brief Pool of locally unique tunnel endpoint identifiers (S11, S1-U).
+          TEID = node id (node_id_bits MSB) | shard | index, index 0 is never allocated so TEID 0 is never returned.
+          Each shard has its own lock, a bitmap of its allocated indexes and a FIFO of released indexes: a released
+          TEID is reused only once it reached the head of the FIFO and stayed there quarantine_ms, so late packets or
+          retransmissions for an old session do not hit a new one. Never used indexes are taken only when no
+          released one is out of quarantine, so the memory follows the peak number of TEIDs, not the TEID space.
+*/
+
+#ifndef FILE_TEID_POOL_SEEN
+#define FILE_TEID_POOL_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define TEID_POOL_MAX_SHARD_BITS          6
+#define TEID_POOL_MAX_NODE_ID_BITS        8
+#define TEID_POOL_ANY_SHARD               (-1)          /*!< \brief shard of the calling thread, assigned on first use */
+#define TEID_POOL_INVALID_TEID            0
+
+/*! \struct  teid_pool_released_t
+* \brief Released index and its release date (ms since the pool creation, wraps after 49 days).
+*/
+typedef struct teid_pool_released_s {
+  uint32_t                        index;
+  uint32_t                        date_ms;
+} teid_pool_released_t;
+
+typedef struct teid_pool_shard_s {
+  pthread_mutex_t                 lock;
+  uint64_t                        next_fresh;         /*!< \brief indexes [1, next_fresh[ have been allocated at least once */
+  uint32_t                        num_allocated;
+  uint64_t                       *allocated;          /*!< \brief bitmap of indexes [0, num_words * 64[ */
+  uint32_t                        num_words;
+  teid_pool_released_t           *released;           /*!< \brief FIFO ring, ordered by release date */
+  uint32_t                        released_size;      /*!< \brief capacity, power of 2 */
+  uint32_t                        released_head;
+  uint32_t                        num_released;
+} __attribute__ ((aligned (64))) teid_pool_shard_t;
+
+typedef struct teid_pool_s {
+  uint32_t                        node_id;
+  int                             node_id_bits;
+  int                             shard_bits;
+  int                             index_bits;
+  uint32_t                        last_index;         /*!< \brief last index of a shard */
+  uint32_t                        quarantine_ms;
+  uint64_t                        epoch_ms;           /*!< \brief CLOCK_MONOTONIC at creation */
+  int                             num_shards;
+  teid_pool_shard_t              *shards;
+} teid_pool_t;
+
+/** \brief Creates an empty pool.
+ * \param num_shards Rounded up to a power of 2, at most 1 << TEID_POOL_MAX_SHARD_BITS, typically the number of
+ *        threads allocating TEIDs.
+ * \param node_id Written in the node_id_bits most significant bits of every TEID, distinguishes the instances of
+ *        a multi-instance gateway sharing the same addresses. Must fit in node_id_bits.
+ * \param quarantine_ms Minimum time between the release of a TEID and its reuse.
+ * @returns NULL on bad parameters.
+ **/
+teid_pool_t *teid_pool_create (const int num_shards, const uint32_t node_id, const int node_id_bits, const uint32_t quarantine_ms);
+void         teid_pool_destroy (teid_pool_t * const pool);
+
+/** \brief Allocates a TEID from a shard, then from the other shards if this one has none available.
+ * \param shard Index of the shard (modulo the number of shards) or TEID_POOL_ANY_SHARD.
+ * @returns the TEID or TEID_POOL_INVALID_TEID if the pool is exhausted.
+ **/
+uint32_t     teid_pool_alloc (teid_pool_t * const pool, const int shard) __attribute__ ((hot));
+
+/** \brief Releases a TEID, from any thread. It starts its quarantine.
+ * @returns RETURNok or RETURNerror if the TEID does not belong to the pool or is not allocated.
+ **/
+int          teid_pool_release (teid_pool_t * const pool, const uint32_t teid) __attribute__ ((hot));
+
+bool         teid_pool_is_allocated (teid_pool_t * const pool, const uint32_t teid);
+uint32_t     teid_pool_num_allocated (teid_pool_t * const pool);
+
+#endif /* FILE_TEID_POOL_SEEN */